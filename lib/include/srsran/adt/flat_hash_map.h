@@ -0,0 +1,277 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_FLAT_HASH_MAP_H
+#define SRSRAN_FLAT_HASH_MAP_H
+
+#include "srsran/support/srsran_assert.h"
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace srsran {
+
+/**
+ * Hash map with integer keys, stored in a single contiguous array of slots.
+ * Collisions are resolved with linear probing, and erasures use backward-shift deletion, so no tombstones are left
+ * behind. The table doubles its capacity whenever the load factor exceeds 1/2, which keeps the average number of
+ * probes per lookup close to one.
+ * Any insertion or erasure invalidates iterators and references to the stored values.
+ * @tparam K unsigned integer key type
+ * @tparam T mapped type. Must be default constructible and movable
+ */
+template <typename K, typename T>
+class flat_hash_map
+{
+  static_assert(std::is_integral<K>::value and std::is_unsigned<K>::value, "Map key must be an unsigned integer");
+
+  struct slot_t {
+    std::pair<K, T> obj;
+    bool            used = false;
+  };
+
+  template <typename MapPtr, typename Obj>
+  class iter_impl
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::pair<K, T>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = Obj*;
+    using reference         = Obj&;
+
+    iter_impl() = default;
+    iter_impl(MapPtr map, size_t idx_) : ptr(map), idx(idx_)
+    {
+      if (idx < ptr->capacity() and not ptr->slots[idx].used) {
+        ++(*this);
+      }
+    }
+
+    iter_impl& operator++()
+    {
+      while (++idx < ptr->capacity() and not ptr->slots[idx].used) {
+      }
+      return *this;
+    }
+
+    reference operator*() const
+    {
+      srsran_assert(idx < ptr->capacity(), "Iterator out-of-bounds (%zd >= %zd)", idx, ptr->capacity());
+      return ptr->slots[idx].obj;
+    }
+    pointer operator->() const
+    {
+      srsran_assert(idx < ptr->capacity(), "Iterator out-of-bounds (%zd >= %zd)", idx, ptr->capacity());
+      return &ptr->slots[idx].obj;
+    }
+
+    bool operator==(const iter_impl& other) const { return ptr == other.ptr and idx == other.idx; }
+    bool operator!=(const iter_impl& other) const { return not(*this == other); }
+
+  private:
+    MapPtr ptr = nullptr;
+    size_t idx = 0;
+  };
+
+public:
+  using key_type        = K;
+  using mapped_type     = T;
+  using value_type      = std::pair<K, T>;
+  using difference_type = std::ptrdiff_t;
+  using iterator        = iter_impl<flat_hash_map<K, T>*, value_type>;
+  using const_iterator  = iter_impl<const flat_hash_map<K, T>*, const value_type>;
+
+  explicit flat_hash_map(size_t nof_elems_hint = 16) { reserve(nof_elems_hint); }
+
+  size_t size() const { return nof_elems; }
+  bool   empty() const { return nof_elems == 0; }
+  size_t capacity() const { return slots.size(); }
+
+  /// Resizes the table so that nof_elems_ can be stored without further rehashing.
+  void reserve(size_t nof_elems_)
+  {
+    size_t new_cap = 8;
+    while (new_cap < 2 * nof_elems_) {
+      new_cap *= 2;
+    }
+    if (new_cap > slots.size()) {
+      rehash(new_cap);
+    }
+  }
+
+  bool   contains(K key) const { return find_idx(key) < capacity(); }
+  size_t count(K key) const { return contains(key) ? 1 : 0; }
+
+  iterator find(K key)
+  {
+    size_t idx = find_idx(key);
+    return idx < capacity() ? iterator(this, idx) : end();
+  }
+  const_iterator find(K key) const
+  {
+    size_t idx = find_idx(key);
+    return idx < capacity() ? const_iterator(this, idx) : end();
+  }
+
+  /// Finds the mapped value of a key. Returns nullptr if the key is not present.
+  T* find_value(K key)
+  {
+    size_t idx = find_idx(key);
+    return idx < capacity() ? &slots[idx].obj.second : nullptr;
+  }
+  const T* find_value(K key) const
+  {
+    size_t idx = find_idx(key);
+    return idx < capacity() ? &slots[idx].obj.second : nullptr;
+  }
+
+  /// Inserts a new element. If the key is already present, the map is left unchanged.
+  template <typename U>
+  std::pair<iterator, bool> insert(K key, U&& obj)
+  {
+    size_t idx = find_idx(key);
+    if (idx < capacity()) {
+      return std::make_pair(iterator(this, idx), false);
+    }
+    idx = emplace_new(key);
+    slots[idx].obj.second = std::forward<U>(obj);
+    return std::make_pair(iterator(this, idx), true);
+  }
+  std::pair<iterator, bool> insert(const value_type& obj) { return insert(obj.first, obj.second); }
+
+  /// Returns the mapped value of a key, inserting a default constructed value if the key is not present.
+  T& operator[](K key)
+  {
+    size_t idx = find_idx(key);
+    if (idx >= capacity()) {
+      idx = emplace_new(key);
+    }
+    return slots[idx].obj.second;
+  }
+
+  size_t erase(K key)
+  {
+    size_t idx = find_idx(key);
+    if (idx >= capacity()) {
+      return 0;
+    }
+    erase_idx(idx);
+    return 1;
+  }
+
+  void clear()
+  {
+    for (slot_t& s : slots) {
+      if (s.used) {
+        s.obj  = value_type{};
+        s.used = false;
+      }
+    }
+    nof_elems = 0;
+  }
+
+  iterator       begin() { return iterator(this, 0); }
+  iterator       end() { return iterator(this, capacity()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, capacity()); }
+
+private:
+  static size_t hash(K key)
+  {
+    // 64-bit finalizer of MurmurHash3. Spreads sequential keys (e.g. TEIDs, IPs) across the table
+    uint64_t x = key;
+    x ^= x >> 33U;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33U;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33U;
+    return static_cast<size_t>(x);
+  }
+
+  size_t find_idx(K key) const
+  {
+    for (size_t idx = hash(key) & mask;; idx = (idx + 1) & mask) {
+      const slot_t& s = slots[idx];
+      if (not s.used) {
+        return capacity();
+      }
+      if (s.obj.first == key) {
+        return idx;
+      }
+    }
+  }
+
+  /// Reserves a free slot for a key known not to be present.
+  size_t emplace_new(K key)
+  {
+    if (2 * (nof_elems + 1) > capacity()) {
+      rehash(2 * capacity());
+    }
+    size_t idx = hash(key) & mask;
+    while (slots[idx].used) {
+      idx = (idx + 1) & mask;
+    }
+    slots[idx].used      = true;
+    slots[idx].obj.first = key;
+    nof_elems++;
+    return idx;
+  }
+
+  void erase_idx(size_t hole)
+  {
+    // Shift back the following elements of the probe sequence whose home slot does not lie in (hole, idx]
+    for (size_t idx = (hole + 1) & mask; slots[idx].used; idx = (idx + 1) & mask) {
+      size_t home = hash(slots[idx].obj.first) & mask;
+      if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+        slots[hole].obj = std::move(slots[idx].obj);
+        hole            = idx;
+      }
+    }
+    slots[hole].obj  = value_type{};
+    slots[hole].used = false;
+    nof_elems--;
+  }
+
+  void rehash(size_t new_cap)
+  {
+    srsran_assert((new_cap & (new_cap - 1)) == 0, "Capacity must be a power of 2");
+    std::vector<slot_t> old_slots(new_cap);
+    std::swap(slots, old_slots);
+    mask      = new_cap - 1;
+    nof_elems = 0;
+    for (slot_t& s : old_slots) {
+      if (s.used) {
+        size_t idx            = emplace_new(s.obj.first);
+        slots[idx].obj.second = std::move(s.obj.second);
+      }
+    }
+  }
+
+  std::vector<slot_t> slots;
+  size_t              mask      = 0;
+  size_t              nof_elems = 0;
+};
+
+} // namespace srsran
+
+#endif // SRSRAN_FLAT_HASH_MAP_H
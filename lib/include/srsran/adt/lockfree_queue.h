@@ -0,0 +1,221 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_LOCKFREE_QUEUE_H
+#define SRSRAN_LOCKFREE_QUEUE_H
+
+#include "srsran/adt/detail/type_storage.h"
+#include <atomic>
+#include <memory>
+
+namespace srsran {
+
+namespace detail {
+
+/**
+ * Ring of slots shared by the bounded lock-free queues below.
+ * Each slot of the ring has a sequence number, that tells producers and consumers whether the slot is free or holds a
+ * value for the current lap of the ring. Producers only contend on the CAS of the write index, and consumers never
+ * block producers.
+ * - no allocations after construction
+ * - try_push() can be called concurrently from several threads
+ * @tparam T type of the stored objects. It must be move-constructible
+ */
+template <typename T>
+class bounded_queue_ring
+{
+  // The queues are embedded in objects allocated with plain new, so they cannot be over-aligned. Instead, cells and
+  // indexes are separated by a full cache line of padding, so that producers and consumers never share a line
+  struct cell_t {
+    std::atomic<size_t>     seq;
+    detail::type_storage<T> val;
+    uint8_t                 padding[64];
+  };
+
+public:
+  bounded_queue_ring(const bounded_queue_ring&) = delete;
+  bounded_queue_ring& operator=(const bounded_queue_ring&) = delete;
+
+  /// Pushes a new element. Thread-safe w.r.t. other producers and the consumers
+  /// @return false if the queue is full. In that case, the object is not moved
+  template <typename U>
+  bool try_push(U&& u)
+  {
+    size_t  pos = write_pos.load(std::memory_order_relaxed);
+    cell_t* cell;
+    while (true) {
+      cell           = &cells[pos & mask];
+      size_t    seq  = cell->seq.load(std::memory_order_acquire);
+      ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // The slot still holds a value of the previous lap of the ring
+        return false;
+      } else {
+        pos = write_pos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->val.emplace(std::forward<U>(u));
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+protected:
+  /// @param capacity_ number of slots, rounded up to a power of 2
+  explicit bounded_queue_ring(size_t capacity_) : mask(round_up_pow2(capacity_) - 1), cells(new cell_t[mask + 1])
+  {
+    for (size_t i = 0; i <= mask; ++i) {
+      cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  ~bounded_queue_ring() = default;
+
+  /// Compares the lap of the slot at the given read index with the one of a pushed value
+  /// @return 0 if the slot holds a value, negative if it was not written in this lap yet
+  ptrdiff_t pending_value(size_t pos) const
+  {
+    size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+    return static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1);
+  }
+
+  /// Moves out the value at the given read index, which the caller owns, and frees its slot for the next lap
+  void pop_value(size_t pos, T& t)
+  {
+    cell_t& cell = cells[pos & mask];
+    t            = std::move(cell.val.get());
+    cell.val.destroy();
+    cell.seq.store(pos + mask + 1, std::memory_order_release);
+  }
+
+  /// Destroys the values left in the ring, starting at the given read index
+  void destroy_values(size_t pos)
+  {
+    for (; pending_value(pos) == 0; ++pos) {
+      cells[pos & mask].val.destroy();
+    }
+  }
+
+  size_t get_write_pos() const { return write_pos.load(std::memory_order_relaxed); }
+
+private:
+  static size_t round_up_pow2(size_t n)
+  {
+    size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  const size_t              mask;
+  std::unique_ptr<cell_t[]> cells;
+  uint8_t                   padding0[64];
+  std::atomic<size_t>       write_pos{0};
+  uint8_t                   padding1[64];
+};
+
+} // namespace detail
+
+/**
+ * Bounded lock-free queue with multiple producers and a single consumer.
+ * - try_push() can be called concurrently from several threads. try_pop() must always be called from the same thread
+ * @tparam T type of the stored objects. It must be move-constructible and move-assignable
+ */
+template <typename T>
+class bounded_mpsc_queue : public detail::bounded_queue_ring<T>
+{
+public:
+  /// @param capacity_ number of slots, rounded up to a power of 2
+  explicit bounded_mpsc_queue(size_t capacity_) : detail::bounded_queue_ring<T>(capacity_) {}
+  ~bounded_mpsc_queue() { this->destroy_values(read_pos); }
+
+  /// Pops the oldest element. Must only be called from the consumer thread
+  /// @return false if the queue is empty
+  bool try_pop(T& t)
+  {
+    if (this->pending_value(read_pos) != 0) {
+      return false;
+    }
+    this->pop_value(read_pos, t);
+    read_pos++;
+    return true;
+  }
+
+private:
+  size_t read_pos = 0;
+};
+
+/**
+ * Bounded lock-free queue with multiple producers and multiple consumers.
+ * - try_push() and try_pop() can be called concurrently from several threads. Consumers only contend on the CAS of
+ * the read index
+ * @tparam T type of the stored objects. It must be move-constructible and move-assignable
+ */
+template <typename T>
+class bounded_mpmc_queue : public detail::bounded_queue_ring<T>
+{
+public:
+  /// @param capacity_ number of slots, rounded up to a power of 2
+  explicit bounded_mpmc_queue(size_t capacity_) : detail::bounded_queue_ring<T>(capacity_) {}
+  ~bounded_mpmc_queue() { this->destroy_values(read_pos.load(std::memory_order_relaxed)); }
+
+  /// Pops the oldest element. Thread-safe w.r.t. other consumers and the producers
+  /// @return false if the queue is empty
+  bool try_pop(T& t)
+  {
+    size_t pos = read_pos.load(std::memory_order_relaxed);
+    while (true) {
+      ptrdiff_t diff = this->pending_value(pos);
+      if (diff == 0) {
+        if (read_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // The slot was not written in this lap yet
+        return false;
+      } else {
+        pos = read_pos.load(std::memory_order_relaxed);
+      }
+    }
+    this->pop_value(pos, t);
+    return true;
+  }
+
+  /// Approximate number of elements in the queue
+  size_t size() const
+  {
+    size_t rpos = read_pos.load(std::memory_order_relaxed);
+    size_t wpos = this->get_write_pos();
+    return (wpos > rpos) ? wpos - rpos : 0;
+  }
+
+private:
+  std::atomic<size_t> read_pos{0};
+};
+
+} // namespace srsran
+
+#endif // SRSRAN_LOCKFREE_QUEUE_H
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_LIBLTE_UTILS_H
+#define SRSRAN_LIBLTE_UTILS_H
+
+#include "srsran/asn1/liblte_common.h"
+#include "srsran/common/byte_buffer.h"
+#include <cstring>
+
+namespace srsran {
+
+/**
+ * Byte buffers seen as LIBLTE messages, for the LIBLTE pack/unpack functions.
+ *
+ * Byte buffers keep their payload out of line, so they can no longer be cast to LIBLTE_BYTE_MSG_STRUCT. Both classes
+ * are meant to be used as temporaries in the call, e.g. liblte_mme_unpack_xxx_msg(liblte_unpack_msg(pdu.get()).get(),
+ * &msg), so that the LIBLTE message only lives on the stack for the duration of the call.
+ */
+
+/// Copies the payload of the buffer into the message and never writes back. get() returns nullptr, which the LIBLTE
+/// functions reject, if the payload does not fit a LIBLTE message
+class liblte_unpack_msg
+{
+public:
+  explicit liblte_unpack_msg(const byte_buffer_t* buf)
+  {
+    if (buf->N_bytes <= LIBLTE_MAX_MSG_SIZE_BYTES) {
+      msg.N_bytes = buf->N_bytes;
+      memcpy(msg.msg, buf->msg, msg.N_bytes);
+      valid = true;
+    }
+  }
+  liblte_unpack_msg(const liblte_unpack_msg&) = delete;
+  liblte_unpack_msg& operator=(const liblte_unpack_msg&) = delete;
+
+  LIBLTE_BYTE_MSG_STRUCT* get() { return valid ? &msg : nullptr; }
+
+private:
+  bool                   valid = false;
+  LIBLTE_BYTE_MSG_STRUCT msg;
+};
+
+/// Message for a LIBLTE pack function. The packed message replaces the payload of the buffer on destruction, i.e.
+/// once the full expression of the call is evaluated
+class liblte_pack_msg
+{
+public:
+  explicit liblte_pack_msg(byte_buffer_t* buf_) : buf(buf_) { msg.N_bytes = 0; }
+  liblte_pack_msg(const liblte_pack_msg&) = delete;
+  liblte_pack_msg& operator=(const liblte_pack_msg&) = delete;
+  ~liblte_pack_msg()
+  {
+    buf->N_bytes = 0;
+    buf->append_bytes(msg.msg, msg.N_bytes);
+  }
+
+  LIBLTE_BYTE_MSG_STRUCT* get() { return &msg; }
+
+private:
+  byte_buffer_t*         buf;
+  LIBLTE_BYTE_MSG_STRUCT msg;
+};
+
+} // namespace srsran
+
+#endif // SRSRAN_LIBLTE_UTILS_H
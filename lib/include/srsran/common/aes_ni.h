@@ -0,0 +1,99 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * AES-128 encryption using the AES-NI instructions, and the VAES/AVX512 instructions where available. The
+ * implementation is selected at runtime from the CPUID feature flags, so binaries built for a generic x86-64 target
+ * still use the AES instructions of the host. The counter mode pipelines several counter blocks per iteration.
+ */
+
+#ifndef SRSRAN_AES_NI_H
+#define SRSRAN_AES_NI_H
+
+#include <stdint.h>
+
+typedef enum {
+  AES_NI_IMPL_NONE = 0, // AES instructions not available, the portable implementation has to be used instead
+  AES_NI_IMPL_AESNI,    // AES-NI, 8 blocks in flight
+  AES_NI_IMPL_VAES,     // VAES with 512-bit registers, 16 blocks in flight
+} aes_ni_impl_t;
+
+/* Expanded AES-128 encryption key */
+typedef struct {
+  uint8_t       rk[11][16];
+  aes_ni_impl_t impl;
+} aes_ni_key_t;
+
+/* Fastest implementation supported by the CPU. The CPU features are only queried once. */
+aes_ni_impl_t aes_ni_get_impl(void);
+
+/* Whether the CPU and the compiler support the given implementation */
+int aes_ni_is_supported(aes_ni_impl_t impl);
+
+const char* aes_ni_impl_to_string(aes_ni_impl_t impl);
+
+/* Key expansion.
+ * Returns 0 on success, or -1 if impl is not supported, in which case key->impl is set to AES_NI_IMPL_NONE.
+ */
+int aes_ni_setkey_enc(aes_ni_key_t* key, const uint8_t k[16], aes_ni_impl_t impl);
+
+/* Encrypts a single 16-byte block */
+void aes_ni_encrypt_block(const aes_ni_key_t* key, const uint8_t in[16], uint8_t out[16]);
+
+/* Counter mode encryption/decryption of len bytes.
+ * nonce_counter is a 128-bit big endian counter, incremented once per (possibly partial) block as done by
+ * mbedtls_aes_crypt_ctr starting from a block offset of 0.
+ */
+void aes_ni_crypt_ctr(const aes_ni_key_t* key,
+                      uint8_t             nonce_counter[16],
+                      const uint8_t*      in,
+                      uint8_t*            out,
+                      uint32_t            len);
+
+/* Message of a counter mode batch */
+typedef struct {
+  uint8_t        nonce_counter[16];
+  const uint8_t* in;
+  uint8_t*       out;
+  uint32_t       len;
+} aes_ni_ctr_msg_t;
+
+/* Counter mode encryption/decryption of several messages, each with its own counter. The blocks of the different
+ * messages are interleaved, so that short messages also keep all the lanes of the pipeline busy. Each nonce_counter
+ * is updated as done by aes_ni_crypt_ctr.
+ */
+void aes_ni_crypt_ctr_batch(const aes_ni_key_t* key, aes_ni_ctr_msg_t* msgs, uint32_t nof_msgs);
+
+/* CBC-MAC chaining of nof_blocks 16-byte blocks, as used by CMAC. state is updated in place with
+ * state = E(state ^ block) for each block.
+ */
+void aes_ni_cbc_mac(const aes_ni_key_t* key, uint8_t state[16], const uint8_t* in, uint32_t nof_blocks);
+
+/* Encrypts nof_blocks consecutive 16-byte blocks, block i with keys[i]. The blocks are pipelined as in counter mode,
+ * so that small independent encryptions under different keys, such as the Milenage functions of several
+ * subscribers, keep the AES unit busy. All the keys must have been expanded with an AES-NI implementation.
+ */
+void aes_ni_encrypt_blocks_multikey(const aes_ni_key_t* const* keys,
+                                    const uint8_t*             in,
+                                    uint8_t*                   out,
+                                    uint32_t                   nof_blocks);
+
+#endif // SRSRAN_AES_NI_H
@@ -25,10 +25,17 @@
 #include "byte_buffer.h"
 #include "srsran/adt/bounded_vector.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
 #include <map>
-#include <pthread.h>
-#include <stack>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "srsran/adt/pool/fixed_size_pool.h"
@@ -37,59 +44,105 @@
 
 namespace srsran {
 
+struct buffer_pool_metrics_t {
+  uint32_t capacity;
+  uint32_t nof_in_use;
+  uint32_t high_watermark;
+};
+
+namespace detail {
+
+/// Returns a small integer identifying the calling thread, used to pick its buffer pool thread cache.
+inline uint32_t buffer_pool_thread_index()
+{
+  static std::atomic<uint32_t> next_index{0};
+  thread_local uint32_t        index = next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+/// Maps zero-filled pages for the pool storage. If numa_node >= 0, the pages are preferably placed in that node.
+void* buffer_pool_alloc_pages(size_t sz, int numa_node);
+void  buffer_pool_free_pages(void* ptr, size_t sz);
+
+} // namespace detail
+
 /******************************************************************************
  * Buffer pool
  *
- * Preallocates a large number of buffer_t and provides allocate and
- * deallocate functions. Provides quick object creation and deletion as well
- * as object reuse.
+ * Preallocates a large number of buffer_t in a contiguous memory region and
+ * provides allocate and deallocate functions. Provides quick object creation
+ * and deletion as well as object reuse.
+ * Free buffers are kept in a lock-free stack of indexes. On top of it, each
+ * thread owns a small cache of free buffers that it can access with a single
+ * uncontended atomic flag. Buffers are moved between the thread cache and the
+ * shared stack in batches. When both are depleted, buffers are taken from the
+ * caches of other threads before the allocation fails.
+ * The ownership of a buffer is checked in O(1) from its address.
  * Singleton class of byte_buffer_t (but other pools of different type can be created)
  *****************************************************************************/
 
 template <class buffer_t>
 class buffer_pool
 {
+  static const int      POOL_SIZE           = 4096;
+  static const uint32_t NOF_THREAD_CACHES   = 16;
+  static const uint32_t MAX_THREAD_CACHE_SZ = 30;
+  static const uint32_t NULL_IDX            = std::numeric_limits<uint32_t>::max();
+
+  // The pool is embedded in objects allocated with plain new, so it cannot be over-aligned. Instead, each cache is
+  // followed by a full cache line of padding, so that caches of different threads never share a line
+  struct thread_cache_t {
+    std::atomic<bool>                         busy{false};
+    uint32_t                                  count = 0;
+    std::array<uint32_t, MAX_THREAD_CACHE_SZ> idxs;
+    uint8_t                                   padding[64];
+  };
+  static_assert(sizeof(thread_cache_t) % 64 == 0, "Thread cache must be a multiple of the cache line size");
+
 public:
-  // non-static methods
-  buffer_pool(int capacity_ = -1)
-  {
-    uint32_t nof_buffers = POOL_SIZE;
-    if (capacity_ > 0) {
-      nof_buffers = (uint32_t)capacity_;
-    }
-    pool.reserve(nof_buffers);
-    free_list.reserve(nof_buffers);
-    pthread_mutex_init(&mutex, nullptr);
-    pthread_cond_init(&cv_not_empty, nullptr);
-    for (uint32_t i = 0; i < nof_buffers; i++) {
-      buffer_t* b = new (std::nothrow) buffer_t;
-      if (!b) {
-        perror("Error allocating memory. Exiting...\n");
-        exit(-1);
-      }
-      pool.push_back(b);
-      free_list.push_back(b);
+  /// @param capacity_ number of buffers of the pool. If <= 0, the default pool size is used
+  /// @param numa_node_ NUMA node where the buffers are preferably allocated. -1 for no preference
+  explicit buffer_pool(int capacity_ = -1, int numa_node_ = -1) :
+    capacity(capacity_ > 0 ? (uint32_t)capacity_ : (uint32_t)POOL_SIZE),
+    cache_limit(std::min(MAX_THREAD_CACHE_SZ, capacity / (2 * NOF_THREAD_CACHES))),
+    next_free(new std::atomic<uint32_t>[capacity])
+  {
+    storage = static_cast<buffer_t*>(detail::buffer_pool_alloc_pages(capacity * sizeof(buffer_t), numa_node_));
+    if (storage == nullptr) {
+      perror("Error allocating memory. Exiting...\n");
+      exit(-1);
+    }
+    for (uint32_t i = 0; i < capacity; i++) {
+      new (&storage[i]) buffer_t;
+      next_free[i].store(i + 1 < capacity ? i + 1 : NULL_IDX, std::memory_order_relaxed);
     }
-    capacity = nof_buffers;
+    free_head.store(0, std::memory_order_release);
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+    in_use.reset(new std::atomic<bool>[capacity]);
+    for (uint32_t i = 0; i < capacity; i++) {
+      in_use[i].store(false, std::memory_order_relaxed);
+    }
+#endif
   }
+  buffer_pool(const buffer_pool&) = delete;
+  buffer_pool& operator=(const buffer_pool&) = delete;
 
   ~buffer_pool()
   {
-    for (auto* p : pool) {
-      delete p;
+    for (uint32_t i = 0; i < capacity; i++) {
+      storage[i].~buffer_t();
     }
-    pthread_cond_destroy(&cv_not_empty);
-    pthread_mutex_destroy(&mutex);
+    detail::buffer_pool_free_pages(storage, capacity * sizeof(buffer_t));
   }
 
   void print_all_buffers()
   {
-    printf("%d buffers in queue\n", static_cast<int>(pool.size() - free_list.size()));
+    printf("%d buffers in queue\n", static_cast<int>(nof_in_use.load(std::memory_order_relaxed)));
 #ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
     std::map<std::string, uint32_t> buffer_cnt;
-    for (uint32_t i = 0; i < pool.size(); i++) {
-      if (std::find(free_list.cbegin(), free_list.cend(), pool[i]) == free_list.cend()) {
-        buffer_cnt[strlen(pool[i]->debug_name) ? pool[i]->debug_name : "Undefined"]++;
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (in_use[i].load(std::memory_order_relaxed)) {
+        buffer_cnt[strlen(storage[i].debug_name) ? storage[i].debug_name : "Undefined"]++;
       }
     }
     std::map<std::string, uint32_t>::iterator it;
@@ -99,74 +152,308 @@ public:
 #endif
   }
 
-  uint32_t nof_available_pdus() { return free_list.size(); }
+  uint32_t size() const { return capacity; }
 
-  bool is_almost_empty() { return free_list.size() < capacity / 20; }
+  uint32_t nof_available_pdus() const { return capacity - nof_buffers_in_use(); }
 
-  buffer_t* allocate(const char* debug_name = nullptr, bool blocking = false)
+  bool is_almost_empty() const { return nof_available_pdus() < capacity / 20; }
+
+  /// Number of buffers currently allocated.
+  uint32_t nof_buffers_in_use() const
   {
-    pthread_mutex_lock(&mutex);
-    buffer_t* b = nullptr;
+    // A buffer is accounted as allocated before its release is, so the count can briefly exceed the capacity
+    return std::min(nof_in_use.load(std::memory_order_relaxed), capacity);
+  }
 
-    if (!free_list.empty()) {
-      b = free_list.back();
-      free_list.pop_back();
+  /// Maximum number of buffers that were allocated at the same time since the pool creation.
+  uint32_t high_watermark() const { return max_in_use.load(std::memory_order_relaxed); }
 
-      if (is_almost_empty()) {
-        printf("Warning buffer pool capacity is %f %%\n", (float)100 * free_list.size() / capacity);
-      }
+  buffer_pool_metrics_t get_metrics() const
+  {
+    buffer_pool_metrics_t metrics = {};
+    metrics.capacity              = capacity;
+    metrics.nof_in_use            = nof_buffers_in_use();
+    metrics.high_watermark        = high_watermark();
+    return metrics;
+  }
+
+  /// Checks whether the buffer belongs to this pool.
+  bool owns(const buffer_t* b) const
+  {
+    uintptr_t offset = reinterpret_cast<uintptr_t>(b) - reinterpret_cast<uintptr_t>(storage);
+    return offset < capacity * sizeof(buffer_t) and offset % sizeof(buffer_t) == 0;
+  }
+
+  buffer_t* allocate(const char* debug_name = nullptr, bool blocking = false)
+  {
+    uint32_t idx = try_allocate();
+    if (idx == NULL_IDX) {
+      if (not blocking) {
+        printf("Error - buffer pool is empty\n");
 #ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
-      if (debug_name) {
-        strncpy(b->debug_name, debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
-        b->debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
-      }
+        print_all_buffers();
 #endif
-    } else if (blocking) {
-      // blocking allocation
-      while (free_list.empty()) {
-        pthread_cond_wait(&cv_not_empty, &mutex);
+        return nullptr;
       }
+      // blocking allocation. Deallocations notify the waiters, and the timeout covers a buffer that was being pushed
+      // to a thread cache while the waiter was registering
+      std::unique_lock<std::mutex> lock(wait_mutex);
+      nof_waiters++;
+      while ((idx = try_allocate()) == NULL_IDX) {
+        cv_not_empty.wait_for(lock, std::chrono::milliseconds(1));
+      }
+      nof_waiters--;
+    } else if (is_almost_empty()) {
+      printf("Warning buffer pool capacity is %f %%\n", (float)100 * nof_available_pdus() / capacity);
+    }
 
-      // retrieve the new buffer
-      b = free_list.back();
-      free_list.pop_back();
-
-      // do not print any warning
-    } else {
-      printf("Error - buffer pool is empty\n");
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+    in_use[idx].store(true, std::memory_order_relaxed);
+    if (debug_name) {
+      strncpy(storage[idx].debug_name, debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
+      storage[idx].debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
+    }
+#endif
+    return &storage[idx];
+  }
 
+  bool deallocate(buffer_t* b)
+  {
+    if (not owns(b)) {
+      return false;
+    }
+    uint32_t idx = static_cast<uint32_t>(b - storage);
 #ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
-      print_all_buffers();
+    in_use[idx].store(false, std::memory_order_relaxed);
 #endif
+    // With blocked allocators, skip the thread cache so that the buffer reaches them through the shared stack
+    if (nof_waiters.load() > 0 or not push_thread_cache(idx)) {
+      push_free(idx);
+    }
+    // Only accounted as free once it can be found, see try_allocate()
+    nof_in_use.fetch_sub(1, std::memory_order_release);
+    if (nof_waiters.load() > 0) {
+      std::lock_guard<std::mutex> lock(wait_mutex);
+      cv_not_empty.notify_one();
     }
+    return true;
+  }
 
-    pthread_mutex_unlock(&mutex);
-    return b;
+private:
+  uint32_t try_allocate()
+  {
+    uint32_t idx = pop_thread_cache();
+    if (idx == NULL_IDX) {
+      idx = pop_free();
+    }
+    if (idx == NULL_IDX) {
+      idx = steal_from_thread_caches(false);
+    }
+    // Free buffers may sit in a cache that another thread is holding. Unlike a mutex pool, only report exhaustion
+    // once every buffer is accounted as in use
+    while (idx == NULL_IDX and nof_in_use.load(std::memory_order_acquire) < capacity) {
+      idx = pop_free();
+      if (idx == NULL_IDX) {
+        idx = steal_from_thread_caches(true);
+      }
+      if (idx == NULL_IDX) {
+        // The buffer left is being allocated by another thread, which did not account it yet
+        std::this_thread::yield();
+      }
+    }
+    if (idx != NULL_IDX) {
+      uint32_t n   = std::min(nof_in_use.fetch_add(1, std::memory_order_relaxed) + 1, capacity);
+      uint32_t max = max_in_use.load(std::memory_order_relaxed);
+      while (n > max and not max_in_use.compare_exchange_weak(max, n, std::memory_order_relaxed)) {
+      }
+    }
+    return idx;
   }
 
-  bool deallocate(buffer_t* b)
+  thread_cache_t* try_lock_cache(uint32_t cache_idx)
   {
-    bool ret = false;
-    pthread_mutex_lock(&mutex);
-    if (std::find(pool.cbegin(), pool.cend(), b) != pool.cend()) {
-      free_list.push_back(b);
-      ret = true;
+    thread_cache_t& cache = thread_caches[cache_idx % NOF_THREAD_CACHES];
+    if (cache.busy.exchange(true, std::memory_order_acquire)) {
+      // shared with another thread, which is currently using it
+      return nullptr;
     }
-    pthread_cond_signal(&cv_not_empty);
-    pthread_mutex_unlock(&mutex);
-    return ret;
+    return &cache;
   }
+  thread_cache_t* lock_cache(uint32_t cache_idx)
+  {
+    thread_cache_t* cache;
+    while ((cache = try_lock_cache(cache_idx)) == nullptr) {
+      // caches are only held for a few pushes or pops
+      std::this_thread::yield();
+    }
+    return cache;
+  }
+  void unlock_cache(thread_cache_t* cache) { cache->busy.store(false, std::memory_order_release); }
 
-private:
-  static const int       POOL_SIZE = 4096;
-  std::vector<buffer_t*> pool;
-  std::vector<buffer_t*> free_list;
-  pthread_mutex_t        mutex;
-  pthread_cond_t         cv_not_empty;
-  uint32_t               capacity;
+  uint32_t pop_thread_cache()
+  {
+    thread_cache_t* cache = cache_limit > 0 ? try_lock_cache(detail::buffer_pool_thread_index()) : nullptr;
+    if (cache == nullptr) {
+      return NULL_IDX;
+    }
+    if (cache->count == 0) {
+      // refill half of the cache from the shared stack
+      uint32_t idx;
+      while (cache->count < std::max(cache_limit / 2, 1U) and (idx = pop_free()) != NULL_IDX) {
+        cache->idxs[cache->count++] = idx;
+      }
+    }
+    uint32_t idx = cache->count > 0 ? cache->idxs[--cache->count] : NULL_IDX;
+    unlock_cache(cache);
+    return idx;
+  }
+
+  bool push_thread_cache(uint32_t idx)
+  {
+    thread_cache_t* cache = cache_limit > 0 ? try_lock_cache(detail::buffer_pool_thread_index()) : nullptr;
+    if (cache == nullptr) {
+      return false;
+    }
+    if (cache->count >= cache_limit) {
+      // return half of the cache to the shared stack
+      while (cache->count > cache_limit / 2) {
+        push_free(cache->idxs[--cache->count]);
+      }
+    }
+    cache->idxs[cache->count++] = idx;
+    unlock_cache(cache);
+    return true;
+  }
+
+  uint32_t steal_from_thread_caches(bool wait_busy_caches)
+  {
+    for (uint32_t i = 0; i < NOF_THREAD_CACHES and cache_limit > 0; ++i) {
+      thread_cache_t* cache = wait_busy_caches ? lock_cache(i) : try_lock_cache(i);
+      if (cache != nullptr) {
+        uint32_t idx = cache->count > 0 ? cache->idxs[--cache->count] : NULL_IDX;
+        unlock_cache(cache);
+        if (idx != NULL_IDX) {
+          return idx;
+        }
+      }
+    }
+    return NULL_IDX;
+  }
+
+  // The head of the shared stack packs a modification tag in the upper 32 bits to avoid the ABA problem
+  void push_free(uint32_t idx)
+  {
+    uint64_t old_head = free_head.load(std::memory_order_relaxed);
+    uint64_t new_head;
+    do {
+      next_free[idx].store(static_cast<uint32_t>(old_head), std::memory_order_relaxed);
+      new_head = (((old_head >> 32U) + 1) << 32U) | idx;
+    } while (not free_head.compare_exchange_weak(old_head, new_head));
+  }
+
+  uint32_t pop_free()
+  {
+    uint64_t old_head = free_head.load(std::memory_order_acquire);
+    uint64_t new_head;
+    do {
+      uint32_t idx = static_cast<uint32_t>(old_head);
+      if (idx == NULL_IDX) {
+        return NULL_IDX;
+      }
+      new_head = (((old_head >> 32U) + 1) << 32U) | next_free[idx].load(std::memory_order_relaxed);
+    } while (not free_head.compare_exchange_weak(old_head, new_head));
+    return static_cast<uint32_t>(old_head);
+  }
+
+  const uint32_t                                capacity;
+  const uint32_t                                cache_limit;
+  buffer_t*                                     storage = nullptr;
+  std::unique_ptr<std::atomic<uint32_t>[]>      next_free;
+  std::atomic<uint64_t>                         free_head{NULL_IDX};
+  std::array<thread_cache_t, NOF_THREAD_CACHES> thread_caches;
+
+  std::atomic<uint32_t> nof_in_use{0};
+  std::atomic<uint32_t> max_in_use{0};
+
+  std::atomic<uint32_t>   nof_waiters{0};
+  std::mutex              wait_mutex;
+  std::condition_variable cv_not_empty;
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+  std::unique_ptr<std::atomic<bool>[]> in_use;
+#endif
 };
 
-using byte_buffer_pool = concurrent_fixed_memory_pool<sizeof(byte_buffer_t)>;
+/******************************************************************************
+ * Byte buffer pool
+ *
+ * Keeps one buffer_pool of blocks per byte buffer size class. Each block holds
+ * a byte_buffer_t followed by the storage of its class. Blocks of the large
+ * class are also handed out as raw memory nodes for other pooled objects (see
+ * byte_buffer_pool_ptr). Storage segments taken by growing buffers come from
+ * the same blocks.
+ * Singleton class.
+ *****************************************************************************/
+class byte_buffer_pool
+{
+  template <uint32_t StorageSize>
+  struct block_t {
+    // Set when the block holds a byte_buffer_t, so that its constructor can pick the block storage
+    bool                                                                              is_byte_buffer;
+    typename std::aligned_storage<sizeof(byte_buffer_t), alignof(byte_buffer_t)>::type header;
+    uint8_t                                                                           data[StorageSize];
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+    char debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN];
+#endif
+  };
+  using small_block_t  = block_t<byte_buffer_class_size(byte_buffer_class_t::small)>;
+  using medium_block_t = block_t<byte_buffer_class_size(byte_buffer_class_t::medium)>;
+  using large_block_t  = block_t<byte_buffer_class_size(byte_buffer_class_t::large)>;
+
+  byte_buffer_pool();
+
+public:
+  /// Size of the memory nodes returned by allocate_node()
+  const static size_t BLOCK_SIZE = sizeof(large_block_t) - offsetof(large_block_t, header);
+
+  static const uint32_t SMALL_POOL_SIZE  = 16384;
+  static const uint32_t MEDIUM_POOL_SIZE = 8192;
+  static const uint32_t LARGE_POOL_SIZE  = 1024;
+
+  byte_buffer_pool(const byte_buffer_pool&) = delete;
+  byte_buffer_pool& operator=(const byte_buffer_pool&) = delete;
+
+  static byte_buffer_pool* get_instance();
+
+  /// Returns the location of a byte_buffer_t in a block of the given class, or of a larger one if that class is
+  /// depleted. Returns nullptr if no block fits
+  void* allocate_buffer(byte_buffer_class_t size_class, const char* debug_name = nullptr);
+  void  deallocate_buffer(void* ptr);
+
+  /// Returns the block storage of a byte_buffer_t located at ptr, or nullptr if it was not allocated in this pool
+  uint8_t* get_buffer_storage(void* ptr, uint32_t* storage_size);
+
+  /// Storage segment of the given class, used by buffers that outgrow their own storage
+  uint8_t* allocate_segment(byte_buffer_class_t size_class);
+  void     deallocate_segment(uint8_t* segment);
+
+  /// Raw memory nodes of up to BLOCK_SIZE bytes
+  void* allocate_node(size_t sz);
+  void  deallocate_node(void* ptr);
+
+  buffer_pool_metrics_t get_metrics(byte_buffer_class_t size_class) const;
+
+  void enable_logger(bool enabled);
+  void print_all_buffers();
+
+private:
+  template <typename Block>
+  static Block* block_of(buffer_pool<Block>& pool, void* ptr, size_t offset);
+
+  srslog::basic_logger*       logger = nullptr;
+  buffer_pool<small_block_t>  small_pool;
+  buffer_pool<medium_block_t> medium_pool;
+  buffer_pool<large_block_t>  large_pool;
+};
 
 inline unique_byte_buffer_t make_byte_buffer() noexcept
 {
@@ -175,7 +462,7 @@ inline unique_byte_buffer_t make_byte_buffer() noexcept
 
 inline unique_byte_buffer_t make_byte_buffer(uint32_t size, uint8_t value) noexcept
 {
-  return std::unique_ptr<byte_buffer_t>(new (std::nothrow) byte_buffer_t(size, value));
+  return std::unique_ptr<byte_buffer_t>(new (byte_buffer_class_for(size), std::nothrow) byte_buffer_t(size, value));
 }
 
 inline unique_byte_buffer_t make_byte_buffer(const char* debug_ctxt) noexcept
@@ -187,10 +474,27 @@ inline unique_byte_buffer_t make_byte_buffer(const char* debug_ctxt) noexcept
   return buffer;
 }
 
+/// Allocates a buffer of the smallest size class that fits the expected payload after the default headroom.
+/// The buffer grows if more bytes are appended, but writes through msg must stay within get_tailroom()
+inline unique_byte_buffer_t make_sized_byte_buffer(uint32_t expected_size, const char* debug_ctxt = nullptr) noexcept
+{
+  std::unique_ptr<byte_buffer_t> buffer(new (byte_buffer_class_for(expected_size), std::nothrow) byte_buffer_t());
+  if (buffer == nullptr and debug_ctxt != nullptr) {
+    srslog::fetch_basic_logger("POOL").error("Failed to allocate byte buffer in %s", debug_ctxt);
+  }
+  return buffer;
+}
+
 namespace detail {
 
+template <typename T>
 struct byte_buffer_pool_deleter {
-  void operator()(void* ptr) { byte_buffer_pool::get_instance()->deallocate_node(ptr); }
+  void operator()(T* ptr)
+  {
+    // Members such as byte buffers own storage outside of the node
+    ptr->~T();
+    byte_buffer_pool::get_instance()->deallocate_node(ptr);
+  }
 };
 
 } // namespace detail
@@ -228,13 +532,13 @@ public:
     }
     new (memblock) T(std::forward<CtorArgs>(args)...);
     byte_buffer_pool_ptr<T> ret;
-    ret.ptr = std::unique_ptr<T, detail::byte_buffer_pool_deleter>(static_cast<T*>(memblock),
-                                                                   detail::byte_buffer_pool_deleter());
+    ret.ptr = std::unique_ptr<T, detail::byte_buffer_pool_deleter<T> >(static_cast<T*>(memblock),
+                                                                      detail::byte_buffer_pool_deleter<T>());
     return ret;
   };
 
 private:
-  std::unique_ptr<T, detail::byte_buffer_pool_deleter> ptr;
+  std::unique_ptr<T, detail::byte_buffer_pool_deleter<T> > ptr;
 };
 
 } // namespace srsran
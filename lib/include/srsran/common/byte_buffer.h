@@ -24,6 +24,7 @@
 
 #include "common.h"
 #include "srsran/adt/span.h"
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 
@@ -79,12 +80,63 @@ private:
 #endif
 };
 
+/******************************************************************************
+ * Byte buffer size classes
+ *
+ * Pooled byte buffers keep their storage in one of a few size classes, so that
+ * small PDUs do not hold a full transport block worth of memory. Each class
+ * reserves part of its storage as headroom for header prepending.
+ *****************************************************************************/
+enum class byte_buffer_class_t : uint8_t { small, medium, large, nof_classes };
+
+constexpr uint32_t byte_buffer_class_size(byte_buffer_class_t c)
+{
+  // The large class keeps the size of the original byte buffers, i.e. a transport block plus headroom
+  return c == byte_buffer_class_t::small ? 256 : (c == byte_buffer_class_t::medium ? 2048 : SRSRAN_MAX_BUFFER_SIZE_BYTES);
+}
+
+/// Headroom left before the payload of a storage of the given size
+constexpr uint32_t byte_buffer_headroom(uint32_t storage_size)
+{
+  return storage_size / 4 < SRSRAN_BUFFER_HEADER_OFFSET ? storage_size / 4 : SRSRAN_BUFFER_HEADER_OFFSET;
+}
+
+/// Maximum payload of a buffer of the given class, without growing it
+constexpr uint32_t byte_buffer_class_payload(byte_buffer_class_t c)
+{
+  return byte_buffer_class_size(c) - byte_buffer_headroom(byte_buffer_class_size(c));
+}
+
+/// Smallest class that fits the expected payload. Larger payloads get the large class, which grows on demand
+constexpr byte_buffer_class_t byte_buffer_class_for(uint32_t payload_size)
+{
+  return payload_size <= byte_buffer_class_payload(byte_buffer_class_t::small)
+             ? byte_buffer_class_t::small
+             : (payload_size <= byte_buffer_class_payload(byte_buffer_class_t::medium) ? byte_buffer_class_t::medium
+                                                                                        : byte_buffer_class_t::large);
+}
+
+inline const char* to_string(byte_buffer_class_t c)
+{
+  static const char* names[] = {"small", "medium", "large"};
+  return c < byte_buffer_class_t::nof_classes ? names[(size_t)c] : "invalid";
+}
+
+static_assert(byte_buffer_class_payload(byte_buffer_class_t::large) >= SRSRAN_MAX_TBSIZE_BITS / 8,
+              "The large class must fit the largest transport block");
+
 /******************************************************************************
  * Byte buffer
  *
  * Generic byte buffer with headroom to accommodate packet headers and custom
  * copy constructors & assignment operators for quick copying. Byte buffer
  * holds a next pointer to support linked lists.
+ * Buffers allocated with new are placed in a block of the byte_buffer_pool,
+ * followed by the storage of their size class. Buffers living elsewhere (stack,
+ * class members) take a storage segment from the pool, or from the heap if the
+ * pool is depleted. The segment fits the size given at construction, or is of
+ * the large class for default constructed buffers. When the payload outgrows
+ * the storage, it is moved to a larger one.
  *****************************************************************************/
 class byte_buffer_t
 {
@@ -93,8 +145,7 @@ public:
   using const_iterator = const uint8_t*;
 
   uint32_t N_bytes = 0;
-  uint8_t  buffer[SRSRAN_MAX_BUFFER_SIZE_BYTES];
-  uint8_t* msg = nullptr;
+  uint8_t* msg     = nullptr;
 #ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
   char debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN];
 #endif
@@ -104,31 +155,24 @@ public:
     buffer_latency_calc tp;
   } md;
 
-  byte_buffer_t() : msg(&buffer[SRSRAN_BUFFER_HEADER_OFFSET])
-  {
-#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
-    bzero(debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
-#endif
-  }
-  explicit byte_buffer_t(uint32_t size) : msg(&buffer[SRSRAN_BUFFER_HEADER_OFFSET]), N_bytes(size)
-  {
-#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
-    bzero(debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
-#endif
-  }
+  byte_buffer_t() { init_storage(0); }
+  explicit byte_buffer_t(uint32_t size) : N_bytes(size) { init_storage(size); }
   byte_buffer_t(uint32_t size, uint8_t val) : byte_buffer_t(size) { std::fill(msg, msg + N_bytes, val); }
-  byte_buffer_t(const byte_buffer_t& buf) : msg(&buffer[SRSRAN_BUFFER_HEADER_OFFSET]), md(buf.md), N_bytes(buf.N_bytes)
+  byte_buffer_t(const byte_buffer_t& buf) : N_bytes(buf.N_bytes), md(buf.md)
   {
+    init_storage(buf.N_bytes);
     // copy actual contents
     memcpy(msg, buf.msg, N_bytes);
   }
+  ~byte_buffer_t() { release_storage(); }
 
   byte_buffer_t& operator=(const byte_buffer_t& buf)
   {
     // avoid self assignment
     if (&buf == this)
       return *this;
-    msg     = &buffer[SRSRAN_BUFFER_HEADER_OFFSET];
+    clear();
+    reserve(buf.N_bytes);
     N_bytes = buf.N_bytes;
     md      = buf.md;
     memcpy(msg, buf.msg, N_bytes);
@@ -137,13 +181,15 @@ public:
 
   void clear()
   {
-    msg     = &buffer[SRSRAN_BUFFER_HEADER_OFFSET];
+    msg     = buffer + byte_buffer_headroom(storage_size);
     N_bytes = 0;
     md      = {};
   }
-  uint32_t get_headroom() { return msg - buffer; }
+  uint32_t get_headroom() const { return msg - buffer; }
   // Returns the remaining space from what is reported to be the length of msg
-  uint32_t                  get_tailroom() const { return (sizeof(buffer) - (msg - buffer) - N_bytes); }
+  uint32_t get_tailroom() const { return (storage_size - (msg - buffer) - N_bytes); }
+  /// Size of the storage currently used by the buffer, including headroom
+  uint32_t                  get_storage_size() const { return storage_size; }
   std::chrono::microseconds get_latency_us() const { return md.tp.get_latency_us(); }
 
   std::chrono::high_resolution_clock::time_point get_timestamp() const { return md.tp.get_timestamp(); }
@@ -152,14 +198,29 @@ public:
 
   void set_timestamp(std::chrono::high_resolution_clock::time_point tp_) { md.tp.set_timestamp(tp_); }
 
+  /// Ensures that at least nof_bytes can be appended, moving the payload to a larger storage if needed
+  void reserve(uint32_t nof_bytes)
+  {
+    if (nof_bytes > get_tailroom()) {
+      grow(nof_bytes);
+    }
+  }
+
   void append_bytes(uint8_t* buf, uint32_t size)
   {
+    reserve(size);
     memcpy(&msg[N_bytes], buf, size);
     N_bytes += size;
   }
 
   // vector-like interface
-  void           resize(size_t size) { N_bytes = size; }
+  void resize(size_t size)
+  {
+    if (size > N_bytes) {
+      reserve(size - N_bytes);
+    }
+    N_bytes = size;
+  }
   size_t         capacity() const { return get_tailroom(); }
   uint8_t*       data() { return msg; }
   const uint8_t* data() const { return msg; }
@@ -171,9 +232,27 @@ public:
 
   void* operator new(size_t sz);
   void* operator new(size_t sz, const std::nothrow_t& nothrow_value) noexcept;
+  /// Allocates the buffer in a pool block of the given size class, or of a larger one if that class is depleted
+  void* operator new(size_t sz, byte_buffer_class_t size_class, const std::nothrow_t& nothrow_value) noexcept;
   void* operator new[](size_t sz) = delete;
   void  operator delete(void* ptr);
+  void  operator delete(void* ptr, byte_buffer_class_t size_class, const std::nothrow_t& nothrow_value) noexcept;
   void  operator delete[](void* ptr) = delete;
+
+private:
+  friend class shared_byte_buffer_t;
+  enum class storage_t : uint8_t { pool_block, pool_segment, heap };
+
+  void init_storage(uint32_t min_payload);
+  void grow(uint32_t min_tailroom);
+  void release_storage();
+
+  uint8_t*  buffer       = nullptr;
+  uint32_t  storage_size = 0;
+  storage_t storage      = storage_t::heap;
+
+  // Number of shared_byte_buffer_t handles that own the buffer
+  std::atomic<uint32_t> nof_refs{0};
 };
 
 struct bit_buffer_t {
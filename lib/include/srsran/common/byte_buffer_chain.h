@@ -0,0 +1,298 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_BYTE_BUFFER_CHAIN_H
+#define SRSRAN_BYTE_BUFFER_CHAIN_H
+
+#include "buffer_pool.h"
+#include "byte_buffer.h"
+#include "srsran/support/srsran_assert.h"
+#include <array>
+
+namespace srsran {
+
+/******************************************************************************
+ * Shared byte buffer
+ *
+ * Reference counted handle to a byte buffer allocated with new (e.g. with
+ * make_byte_buffer). The buffer is deleted together with its last handle.
+ * Handles may be copied and released from different threads.
+ *****************************************************************************/
+class shared_byte_buffer_t
+{
+public:
+  shared_byte_buffer_t() = default;
+  explicit shared_byte_buffer_t(unique_byte_buffer_t buf) : ptr(buf.release())
+  {
+    if (ptr != nullptr) {
+      ptr->nof_refs.store(1, std::memory_order_relaxed);
+    }
+  }
+  shared_byte_buffer_t(const shared_byte_buffer_t& other) : ptr(other.ptr)
+  {
+    if (ptr != nullptr) {
+      ptr->nof_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  shared_byte_buffer_t(shared_byte_buffer_t&& other) noexcept : ptr(other.ptr) { other.ptr = nullptr; }
+  ~shared_byte_buffer_t() { reset(); }
+
+  shared_byte_buffer_t& operator=(const shared_byte_buffer_t& other)
+  {
+    if (this != &other) {
+      shared_byte_buffer_t tmp(other);
+      std::swap(ptr, tmp.ptr);
+    }
+    return *this;
+  }
+  shared_byte_buffer_t& operator=(shared_byte_buffer_t&& other) noexcept
+  {
+    std::swap(ptr, other.ptr);
+    return *this;
+  }
+  shared_byte_buffer_t& operator=(std::nullptr_t)
+  {
+    reset();
+    return *this;
+  }
+
+  void reset()
+  {
+    if (ptr != nullptr and ptr->nof_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete ptr;
+    }
+    ptr = nullptr;
+  }
+
+  byte_buffer_t*       get() { return ptr; }
+  const byte_buffer_t* get() const { return ptr; }
+  byte_buffer_t*       operator->() { return ptr; }
+  const byte_buffer_t* operator->() const { return ptr; }
+  byte_buffer_t&       operator*() { return *ptr; }
+  const byte_buffer_t& operator*() const { return *ptr; }
+  bool                 operator==(std::nullptr_t) const { return ptr == nullptr; }
+  bool                 operator!=(std::nullptr_t) const { return ptr != nullptr; }
+  explicit operator bool() const { return ptr != nullptr; }
+
+  uint32_t use_count() const { return ptr != nullptr ? ptr->nof_refs.load(std::memory_order_relaxed) : 0; }
+
+private:
+  byte_buffer_t* ptr = nullptr;
+};
+
+/// Read-only view of a range of bytes of a shared byte buffer, which is kept alive while the slice exists
+class byte_buffer_slice
+{
+public:
+  byte_buffer_slice() = default;
+  byte_buffer_slice(shared_byte_buffer_t buf_, const uint8_t* ptr_, uint32_t len_) :
+    buf(std::move(buf_)), ptr(ptr_), len(len_)
+  {}
+
+  const uint8_t* data() const { return ptr; }
+  uint32_t       size() const { return len; }
+
+private:
+  shared_byte_buffer_t buf;
+  const uint8_t*       ptr = nullptr;
+  uint32_t             len = 0;
+};
+
+/******************************************************************************
+ * Byte buffer chain
+ *
+ * Sequence of slices that represents a PDU without copying its payload, e.g.
+ * an RLC PDU made of segments of PDCP PDUs. The bytes are copied once, when
+ * the chain is gathered into contiguous memory (the MAC TB).
+ * The first slices are stored inline. Chains with more slices continue in
+ * chunks taken from the small class of the byte buffer pool, so that building
+ * a PDU does not touch the heap unless the pool is depleted.
+ *****************************************************************************/
+class byte_buffer_chain
+{
+  struct slice_chunk {
+    constexpr static uint32_t nof_slices =
+        (byte_buffer_class_size(byte_buffer_class_t::small) - 2 * sizeof(void*)) / sizeof(byte_buffer_slice);
+
+    slice_chunk*      next      = nullptr;
+    bool              from_pool = false;
+    byte_buffer_slice slices[nof_slices];
+  };
+  static_assert(sizeof(slice_chunk) <= byte_buffer_class_size(byte_buffer_class_t::small),
+                "Chunk of slices does not fit a small pool segment");
+
+public:
+  /// Number of slices stored without allocation, enough for PDUs carrying a few SDUs
+  constexpr static uint32_t nof_inline_slices = 4;
+
+  byte_buffer_chain() = default;
+  byte_buffer_chain(const byte_buffer_chain& other) { append(other); }
+  byte_buffer_chain(byte_buffer_chain&& other) noexcept { swap(other); }
+  ~byte_buffer_chain() { clear(); }
+
+  byte_buffer_chain& operator=(const byte_buffer_chain& other)
+  {
+    if (this != &other) {
+      clear();
+      append(other);
+    }
+    return *this;
+  }
+  byte_buffer_chain& operator=(byte_buffer_chain&& other) noexcept
+  {
+    swap(other);
+    return *this;
+  }
+
+  /// Appends len bytes of buf, starting at ptr
+  void append(const shared_byte_buffer_t& buf, const uint8_t* ptr, uint32_t len)
+  {
+    if (len > 0) {
+      push_back(byte_buffer_slice(buf, ptr, len));
+      nof_bytes += len;
+    }
+  }
+
+  /// Appends the slices of another chain
+  void append(const byte_buffer_chain& other)
+  {
+    other.for_each_slice([this](const byte_buffer_slice& s) { push_back(s); });
+    nof_bytes += other.nof_bytes;
+  }
+
+  void clear()
+  {
+    for (uint32_t i = 0; i < std::min(count, nof_inline_slices); ++i) {
+      inline_slices[i] = byte_buffer_slice();
+    }
+    while (head != nullptr) {
+      slice_chunk* next = head->next;
+      delete_chunk(head);
+      head = next;
+    }
+    tail      = nullptr;
+    count     = 0;
+    nof_bytes = 0;
+  }
+
+  void swap(byte_buffer_chain& other) noexcept
+  {
+    std::swap(inline_slices, other.inline_slices);
+    std::swap(head, other.head);
+    std::swap(tail, other.tail);
+    std::swap(count, other.count);
+    std::swap(nof_bytes, other.nof_bytes);
+  }
+
+  uint32_t length() const { return nof_bytes; }
+  bool     empty() const { return nof_bytes == 0; }
+  size_t   nof_slices() const { return count; }
+
+  /// Calls f for each slice, in order
+  template <typename F>
+  void for_each_slice(F&& f) const
+  {
+    for (uint32_t i = 0; i < std::min(count, nof_inline_slices); ++i) {
+      f(inline_slices[i]);
+    }
+    uint32_t remaining = count > nof_inline_slices ? count - nof_inline_slices : 0;
+    for (const slice_chunk* chunk = head; chunk != nullptr; chunk = chunk->next) {
+      for (uint32_t i = 0; i < std::min(remaining, slice_chunk::nof_slices); ++i) {
+        f(chunk->slices[i]);
+      }
+      remaining -= std::min(remaining, slice_chunk::nof_slices);
+    }
+  }
+
+  /// Gathers len bytes of the chain, starting at offset, into dst. Returns the number of copied bytes
+  uint32_t copy_to(uint8_t* dst, uint32_t offset, uint32_t len) const
+  {
+    srsran_assert(offset + len <= nof_bytes, "Chain of %d B cannot provide %d B at offset %d", nof_bytes, len, offset);
+    uint32_t copied = 0;
+    for_each_slice([dst, &offset, len, &copied](const byte_buffer_slice& s) {
+      if (copied == len) {
+        return;
+      }
+      if (offset >= s.size()) {
+        offset -= s.size();
+        return;
+      }
+      uint32_t n = std::min(s.size() - offset, len - copied);
+      memcpy(dst + copied, s.data() + offset, n);
+      copied += n;
+      offset = 0;
+    });
+    return copied;
+  }
+  uint32_t copy_to(uint8_t* dst) const { return copy_to(dst, 0, nof_bytes); }
+
+private:
+  void push_back(byte_buffer_slice s)
+  {
+    if (count < nof_inline_slices) {
+      inline_slices[count++] = std::move(s);
+      return;
+    }
+    uint32_t idx = (count - nof_inline_slices) % slice_chunk::nof_slices;
+    if (idx == 0) {
+      slice_chunk* chunk = new_chunk();
+      if (tail == nullptr) {
+        head = chunk;
+      } else {
+        tail->next = chunk;
+      }
+      tail = chunk;
+    }
+    tail->slices[idx] = std::move(s);
+    count++;
+  }
+
+  static slice_chunk* new_chunk()
+  {
+    void* mem = byte_buffer_pool::get_instance()->allocate_segment(byte_buffer_class_t::small);
+    if (mem == nullptr) {
+      // Depleted pool
+      return new slice_chunk();
+    }
+    slice_chunk* chunk = new (mem) slice_chunk();
+    chunk->from_pool   = true;
+    return chunk;
+  }
+  static void delete_chunk(slice_chunk* chunk)
+  {
+    if (not chunk->from_pool) {
+      delete chunk;
+      return;
+    }
+    chunk->~slice_chunk();
+    byte_buffer_pool::get_instance()->deallocate_segment(reinterpret_cast<uint8_t*>(chunk));
+  }
+
+  std::array<byte_buffer_slice, nof_inline_slices> inline_slices;
+  slice_chunk*                                     head      = nullptr;
+  slice_chunk*                                     tail      = nullptr;
+  uint32_t                                         count     = 0;
+  uint32_t                                         nof_bytes = 0;
+};
+
+} // namespace srsran
+
+#endif // SRSRAN_BYTE_BUFFER_CHAIN_H
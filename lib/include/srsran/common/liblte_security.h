@@ -19,6 +19,8 @@
 *******************************************************************************/
 
 #include "srsran/asn1/liblte_common.h"
+#include "srsran/common/aes_ni.h"
+#include "srsran/common/ssl.h"
 
 /*******************************************************************************
                               DEFINES
@@ -279,6 +281,118 @@ LIBLTE_ERROR_ENUM liblte_security_decryption_eea3(uint8* key,
                                                   uint32 msg_len,
                                                   uint8* out);
 
+/*********************************************************************
+    Name: LIBLTE_SECURITY_AES_STRUCT
+
+    Description: Expanded AES-128 key of EEA2 and EIA2. The AES-NI
+                 key schedule is used when the CPU supports the AES
+                 instructions, and the portable one otherwise.
+
+    Document Reference: 33.401 v13.1.0 Annex B.1.3 and B.2.3
+*********************************************************************/
+// Defines
+// Enums
+// Structs
+typedef struct {
+  aes_context  ctx;
+  aes_ni_key_t ni;
+} LIBLTE_SECURITY_AES_STRUCT;
+// Functions
+
+/*********************************************************************
+    Name: LIBLTE_SECURITY_KEY_CTX_STRUCT
+
+    Description: Key-dependent state of the 128-bit ciphering and
+                 integrity algorithms. It is computed once per key
+                 with liblte_security_init_key_ctx, so that the AES
+                 key expansion, the EIA2 subkeys and the SNOW 3G key
+                 words are not derived again for every message. The
+                 *_ctx variants of the algorithms produce the same
+                 output as the ones taking the key.
+
+    Document Reference: 33.401 v13.1.0 Annex B
+*********************************************************************/
+// Defines
+// Enums
+// Structs
+typedef struct {
+  uint8                      key[16];
+  LIBLTE_SECURITY_AES_STRUCT aes;
+  uint8                      eia2_k1[16];
+  uint8                      eia2_k2[16];
+  uint32                     s3g_key[4];
+} LIBLTE_SECURITY_KEY_CTX_STRUCT;
+// Functions
+LIBLTE_ERROR_ENUM liblte_security_init_key_ctx(const uint8* key, LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx);
+LIBLTE_ERROR_ENUM liblte_security_128_eia1_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                               uint32                          count,
+                                               uint8                           bearer,
+                                               uint8                           direction,
+                                               uint8*                          msg,
+                                               uint32                          msg_len,
+                                               uint8*                          mac);
+LIBLTE_ERROR_ENUM liblte_security_128_eia2_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                               uint32                          count,
+                                               uint8                           bearer,
+                                               uint8                           direction,
+                                               uint8*                          msg,
+                                               uint32                          msg_len,
+                                               uint8*                          mac);
+LIBLTE_ERROR_ENUM liblte_security_128_eia3_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                               uint32                          count,
+                                               uint8                           bearer,
+                                               uint8                           direction,
+                                               uint8*                          msg,
+                                               uint32                          msg_len,
+                                               uint8*                          mac);
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea1_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                                      uint32                          count,
+                                                      uint8                           bearer,
+                                                      uint8                           direction,
+                                                      uint8*                          msg,
+                                                      uint32                          msg_len,
+                                                      uint8*                          out);
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea2_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                                      uint32                          count,
+                                                      uint8                           bearer,
+                                                      uint8                           direction,
+                                                      uint8*                          msg,
+                                                      uint32                          msg_len,
+                                                      uint8*                          out);
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea3_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                                      uint32                          count,
+                                                      uint8                           bearer,
+                                                      uint8                           direction,
+                                                      uint8*                          msg,
+                                                      uint32                          msg_len,
+                                                      uint8*                          out);
+
+/*********************************************************************
+    Name: liblte_security_encryption_eea2_ctx_batch
+
+    Description: 128-bit encryption algorithm EEA2 applied to several
+                 messages with the same key, bearer and direction.
+                 With the AES instructions, the counter blocks of all
+                 the messages are encrypted in one pass.
+
+    Document Reference: 33.401 v13.1.0 Annex B.1.3
+*********************************************************************/
+// Defines
+// Enums
+// Structs
+typedef struct {
+  uint32 count;
+  uint8* msg;
+  uint32 msg_len; // in bits
+  uint8* out;
+} LIBLTE_SECURITY_CIPHER_MSG_STRUCT;
+// Functions
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea2_ctx_batch(LIBLTE_SECURITY_KEY_CTX_STRUCT*    ctx,
+                                                            uint8                              bearer,
+                                                            uint8                              direction,
+                                                            LIBLTE_SECURITY_CIPHER_MSG_STRUCT* msgs,
+                                                            uint32                             nof_msgs);
+
 /*********************************************************************
     Name: liblte_security_milenage_f1
 
@@ -344,6 +458,43 @@ liblte_security_milenage_f2345(uint8* k, uint8* op, uint8* rand, uint8* res, uin
 // Functions
 LIBLTE_ERROR_ENUM liblte_security_milenage_f5_star(uint8* k, uint8* op, uint8* rand, uint8* ak);
 
+/*********************************************************************
+    Name: liblte_security_milenage_batch
+
+    Description: Milenage security functions F1, F1*, F2, F3, F4,
+                 F5 and F5* for several subscribers at once. The key
+                 of each subscriber is expanded beforehand with
+                 liblte_security_milenage_init_key, and TEMP is only
+                 computed once per vector. The AES blocks of all the
+                 vectors are encrypted together, so that the AES-NI
+                 pipeline is kept full even though every vector is
+                 under a different key. Outputs set to NULL are not
+                 computed, and SQN and AMF are only needed for
+                 MAC-A and MAC-S.
+
+    Document Reference: 35.206 v10.0.0 Annex 3
+*********************************************************************/
+// Defines
+// Enums
+// Structs
+typedef struct {
+  LIBLTE_SECURITY_AES_STRUCT* k;
+  uint8*                      op_c;
+  uint8*                      rand;
+  uint8*                      sqn;
+  uint8*                      amf;
+  uint8*                      mac_a;
+  uint8*                      mac_s;
+  uint8*                      res;
+  uint8*                      ck;
+  uint8*                      ik;
+  uint8*                      ak;
+  uint8*                      ak_star;
+} LIBLTE_SECURITY_MILENAGE_STRUCT;
+// Functions
+LIBLTE_ERROR_ENUM liblte_security_milenage_init_key(const uint8* k, LIBLTE_SECURITY_AES_STRUCT* aes);
+LIBLTE_ERROR_ENUM liblte_security_milenage_batch(LIBLTE_SECURITY_MILENAGE_STRUCT* vecs, uint32 nof_vecs);
+
 LIBLTE_ERROR_ENUM liblte_security_generate_k_nr_rrc(uint8*                                      k_gnb,
                                                     LIBLTE_SECURITY_CIPHERING_ALGORITHM_ID_ENUM enc_alg_id,
                                                     LIBLTE_SECURITY_INTEGRITY_ALGORITHM_ID_ENUM int_alg_id,
@@ -35,6 +35,7 @@
 #include <netinet/udp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <vector>
 
 namespace srsran {
 
@@ -176,6 +177,15 @@ using sctp_recv_callback_t =
 /// Function signature for SDU byte buffers received from any sockaddr_in-based socket
 using recvfrom_callback_t = srsran::move_callback<void(srsran::unique_byte_buffer_t, const sockaddr_in&)>;
 
+/// Datagram received from a sockaddr_in-based socket
+struct rx_datagram_t {
+  srsran::unique_byte_buffer_t pdu;
+  sockaddr_in                  from;
+};
+
+/// Function signature for a burst of datagrams drained from a sockaddr_in-based socket in one go
+using recvfrom_burst_callback_t = srsran::move_callback<void(std::vector<rx_datagram_t>&)>;
+
 /**
  * Helper function that creates a callback that is called when a SCTP socket has data, and does the following tasks:
  * 1. receive SDU byte buffer from SCTP socket and associated metadata - sockaddr_in, sctp_sndrcvinfo, flags
@@ -196,6 +206,15 @@ make_sctp_sdu_handler(srslog::basic_logger& logger, srsran::task_queue_handle& q
 socket_manager_itf::recv_callback_t
 make_sdu_handler(srslog::basic_logger& logger, srsran::task_queue_handle& queue, recvfrom_callback_t rx_callback);
 
+/**
+ * Similar to make_sdu_handler, but each time the socket has data it is drained with non-blocking reads, up to
+ * "max_burst" datagrams, and the whole burst is dispatched into the "queue" as a single task
+ */
+socket_manager_itf::recv_callback_t make_sdu_burst_handler(srslog::basic_logger&      logger,
+                                                           srsran::task_queue_handle& queue,
+                                                           recvfrom_burst_callback_t  rx_callback,
+                                                           uint32_t                   max_burst = 32);
+
 } // namespace srsran
 
 #endif // SRSRAN_RX_SOCKET_HANDLER_H
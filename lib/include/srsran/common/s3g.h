@@ -39,8 +39,8 @@
 #include <string.h>
 
 typedef struct {
-  uint32_t* lfsr;
-  uint32_t* fsm;
+  uint32_t lfsr[16];
+  uint32_t fsm[3];
 } S3G_STATE;
 
 /* Initialization.
@@ -50,7 +50,7 @@ typedef struct {
  * See Section 4.1.
  */
 
-void s3g_initialize(S3G_STATE* state, uint32_t k[4], uint32_t iv[4]);
+void s3g_initialize(S3G_STATE* state, const uint32_t k[4], const uint32_t iv[4]);
 
 /*********************************************************************
     Name: s3g_deinitialize
@@ -101,4 +101,17 @@ void s3g_generate_keystream(S3G_STATE* state, uint32_t n, uint32_t* ks);
 
 uint8_t* s3g_f9(const uint8_t* key, uint32_t count, uint32_t fresh, uint32_t dir, uint8_t* data, uint64_t length);
 
+/* f9 with the Integrity Key already loaded into four 32-bit words, as done
+ * by s3g_f9 (K[3] holds the first key bytes).
+ * Output MAC_I: 32 bit block used as MAC, written to caller memory.
+ */
+
+void s3g_f9_k(const uint32_t K[4],
+              uint32_t       count,
+              uint32_t       fresh,
+              uint32_t       dir,
+              uint8_t*       data,
+              uint64_t       length,
+              uint8_t        MAC_I[4]);
+
 #endif // SRSRAN_S3G_H
\ No newline at end of file
@@ -266,6 +266,97 @@ uint8_t security_128_eea3(uint8_t* key,
                           uint32_t msg_len,
                           uint8_t* msg_out);
 
+/******************************************************************************
+ * Encryption / Integrity Protection with precomputed key state
+ *****************************************************************************/
+
+struct security_key_sched_t;
+
+/// 128-bit ciphering or integrity key together with the state derived from it that does not depend on the message
+/// (AES key expansion, EIA2 subkeys and SNOW 3G key words). It is computed once by set_key() and reused until the key
+/// changes. The key-based functions above derive this state again for every message.
+class security_key_ctx
+{
+public:
+  security_key_ctx();
+  ~security_key_ctx();
+  security_key_ctx(const security_key_ctx&) = delete;
+  security_key_ctx& operator=(const security_key_ctx&) = delete;
+
+  void set_key(const uint8_t* key);
+  void reset();
+  bool is_set() const { return sched != nullptr; }
+
+  security_key_sched_t* get() const { return sched.get(); }
+
+private:
+  std::unique_ptr<security_key_sched_t> sched;
+};
+
+uint8_t security_128_eia1(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac);
+
+uint8_t security_128_eia2(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac);
+
+uint8_t security_128_eia3(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac);
+
+uint8_t security_128_eea1(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out);
+
+uint8_t security_128_eea2(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out);
+
+uint8_t security_128_eea3(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out);
+
+/// Message of a burst ciphered by security_128_eea2_batch(). msg_len is in bytes, and out may alias msg.
+struct security_cipher_msg_t {
+  uint32_t count;
+  uint8_t* msg;
+  uint32_t msg_len;
+  uint8_t* out;
+};
+
+/// Ciphers a burst of messages of the same bearer and direction with 128-EEA2. The keystream of all the messages is
+/// generated in one pass, which keeps the AES pipeline busy also for short messages.
+uint8_t security_128_eea2_batch(const security_key_ctx& key_ctx,
+                                uint8_t                 bearer,
+                                uint8_t                 direction,
+                                security_cipher_msg_t*  msgs,
+                                uint32_t                nof_msgs);
+
 /******************************************************************************
  * Authentication
  *****************************************************************************/
@@ -280,6 +371,50 @@ security_milenage_f2345(uint8_t* k, uint8_t* op, uint8_t* rand, uint8_t* res, ui
 
 uint8_t security_milenage_f5_star(uint8_t* k, uint8_t* op, uint8_t* rand, uint8_t* ak);
 
+struct security_milenage_sched_t;
+
+/// Expanded subscriber key K of the batched Milenage functions. Like security_key_ctx, it is computed once by
+/// set_key() and can be kept for as long as the subscriber is known.
+class security_milenage_key
+{
+public:
+  security_milenage_key();
+  ~security_milenage_key();
+  security_milenage_key(const security_milenage_key&) = delete;
+  security_milenage_key& operator=(const security_milenage_key&) = delete;
+
+  void set_key(const uint8_t* k);
+  void reset();
+  bool is_set() const { return sched != nullptr; }
+
+  security_milenage_sched_t* get() const { return sched.get(); }
+
+private:
+  std::unique_ptr<security_milenage_sched_t> sched;
+};
+
+/// Authentication vector computed by security_milenage_batch(). sqn and amf are only read for mac_a and mac_s. Outputs
+/// left as nullptr are not computed.
+struct security_milenage_vec_t {
+  const security_milenage_key* k;
+  uint8_t*                     opc;
+  uint8_t*                     rand;
+  uint8_t*                     sqn;
+  uint8_t*                     amf;
+  uint8_t*                     mac_a;
+  uint8_t*                     mac_s;
+  uint8_t*                     res;
+  uint8_t*                     ck;
+  uint8_t*                     ik;
+  uint8_t*                     ak;
+  uint8_t*                     ak_star;
+};
+
+/// Milenage f1, f1*, f2, f3, f4, f5 and f5* of several subscribers at once. The outputs are the same as those of the
+/// security_milenage_* functions above, but TEMP is only computed once per vector and the AES blocks of all the
+/// vectors are pipelined together.
+uint8_t security_milenage_batch(security_milenage_vec_t* vecs, uint32_t nof_vecs);
+
 int security_xor_f2345(uint8_t* k, uint8_t* rand, uint8_t* res, uint8_t* ck, uint8_t* ik, uint8_t* ak);
 int security_xor_f1(uint8_t* k, uint8_t* rand, uint8_t* sqn, uint8_t* amf, uint8_t* mac_a);
 
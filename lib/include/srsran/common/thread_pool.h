@@ -153,6 +153,13 @@ private:
   bool                                    running = false;
 };
 
+/**
+ * Runs func(idx) for every idx in [0, nof_items) using the workers of the pool and the calling thread, and returns
+ * once all the calls have completed. The calling thread keeps taking items too, so the call progresses even if all
+ * the pool workers are busy. This makes it safe to nest calls from tasks running in the same pool.
+ */
+void parallel_for(task_thread_pool& pool, uint32_t nof_items, const std::function<void(uint32_t)>& func);
+
 /// Class used to create a single worker with an input task queue with a single reader
 class task_worker : public thread
 {
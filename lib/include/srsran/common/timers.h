@@ -32,11 +32,14 @@
 #include "srsran/adt/intrusive_list.h"
 #include "srsran/adt/move_callback.h"
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <inttypes.h>
 #include <limits>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace srsran {
 
@@ -50,32 +53,54 @@ public:
  * Class that manages stack timers. It allows creation of unique_timers with different ids. Each unique_timer duration,
  * and callback can be set via the set(...) method. A timer can be started/stopped via run()/stop() methods.
  * The timers access/alteration is thread-safe. Just beware non-atomic uses of its getters.
+ *
+ * Timer domains:
+ * Each timer_handler is a timer domain owned by the thread that calls step_all(). The owner thread starts, stops and
+ * sets timers without taking any lock. Other threads update the timer state atomically, so that the getters reflect
+ * their requests right away, but do not touch the wheel. Instead, the timer is pushed to a lock-free queue that the
+ * owner drains at the start of the next step_all(), placing the timer in the wheel (or removing it) according to its
+ * latest state. A new callback set by another thread also takes effect in the next step_all().
+ * Until the first step_all(), the domain has no owner and all requests are applied under a mutex.
+ * The ownership moves to another thread if it starts calling step_all(), which is only safe if the previous owner
+ * stopped using the timers.
+ *
  * Internal Data structures:
  * - timer_list - std::deque that stores timer objects via push_back() to keep pointer/reference validity.
  *   The timer index in the timer_list matches the timer object id field.
  *   This deque will only grow in size. Erased timers are just tagged in the deque as empty, and can be reused for the
  *   creation of new timers. To avoid unnecessary runtime allocations, the user can set an initial capacity.
+ *   Its growth and the free list are protected by alloc_mutex, which is only taken on timer creation and deletion.
  * - free_list - intrusive forward linked list to keep track of the empty timers and speed up new timer creation.
- * - A large circular vector of size WHEEL_SIZE which works as a time wheel, storing and circularly indexing the
- *   currently running timers by their respective timeout value.
- *   For a number of running timers N, and uniform distribution of timeout values, the step_all() complexity
- *   should be O(N/WHEEL_SIZE). Thus, the performance should improve with a larger WHEEL_SIZE, at the expense of more
- *   used memory.
+ * - A hierarchical time wheel with NOF_LEVELS levels of LEVEL_SIZE slots each. Level 0 stores the timers expiring
+ *   within the next LEVEL_SIZE tics, indexed by their exact timeout. Level n stores the timers expiring within the next
+ *   LEVEL_SIZE^(n+1) tics, indexed by bits [n*LEVEL_SHIFT, (n+1)*LEVEL_SHIFT) of their timeout. Every LEVEL_SIZE^n
+ *   tics, the timers of the current slot of level n are cascaded to the lower levels. Each timer is cascaded at most
+ *   NOF_LEVELS-1 times, while the wheel only needs NOF_LEVELS*LEVEL_SIZE list heads to cover the full 32-bit range.
  */
 class timer_handler
 {
-  using tic_diff_t                      = uint32_t;
-  using tic_t                           = uint32_t;
-  constexpr static uint32_t INVALID_ID  = std::numeric_limits<uint32_t>::max();
-  constexpr static size_t   WHEEL_SHIFT = 16U;
-  constexpr static size_t   WHEEL_SIZE  = 1U << WHEEL_SHIFT;
-  constexpr static size_t   WHEEL_MASK  = WHEEL_SIZE - 1U;
+  using tic_diff_t                       = uint32_t;
+  using tic_t                            = uint32_t;
+  constexpr static uint32_t INVALID_ID   = std::numeric_limits<uint32_t>::max();
+  constexpr static size_t   LEVEL_SHIFT  = 8U;
+  constexpr static size_t   LEVEL_SIZE   = 1U << LEVEL_SHIFT;
+  constexpr static size_t   LEVEL_MASK   = LEVEL_SIZE - 1U;
+  constexpr static size_t   NOF_LEVELS   = 32U / LEVEL_SHIFT;
+  constexpr static uint32_t INVALID_POS  = NOF_LEVELS * LEVEL_SIZE;
 
   constexpr static uint64_t   STOPPED_FLAG       = 0U;
   constexpr static uint64_t   RUNNING_FLAG       = static_cast<uint64_t>(1U) << 63U;
   constexpr static uint64_t   EXPIRED_FLAG       = static_cast<uint64_t>(1U) << 62U;
   constexpr static tic_diff_t MAX_TIMER_DURATION = 0x3FFFFFFFU;
 
+  // Requests posted to a timer by threads other than the domain owner
+  constexpr static uint64_t NO_REQUEST      = 0U;
+  constexpr static uint64_t SET_REQUEST     = static_cast<uint64_t>(1U) << 32U;
+  constexpr static uint64_t RUN_REQUEST     = static_cast<uint64_t>(1U) << 33U;
+  constexpr static uint64_t STOP_REQUEST    = static_cast<uint64_t>(1U) << 34U;
+  constexpr static uint64_t DEALLOC_REQUEST = static_cast<uint64_t>(1U) << 35U;
+  constexpr static uint64_t QUEUED_FLAG     = static_cast<uint64_t>(1U) << 36U; ///< timer wheel position to be updated
+
   static bool       decode_is_running(uint64_t value) { return (value & RUNNING_FLAG) != 0; }
   static bool       decode_is_expired(uint64_t value) { return (value & EXPIRED_FLAG) != 0; }
   static tic_diff_t decode_duration(uint64_t value) { return (value >> 32U) & MAX_TIMER_DURATION; }
@@ -85,20 +110,28 @@ class timer_handler
     return mode_flag + (static_cast<uint64_t>(duration) << 32U) + timeout;
   }
 
+  using callback_t = srsran::move_callback<void(uint32_t)>;
+
   struct timer_impl : public intrusive_double_linked_list_element<>, public intrusive_forward_list_element<> {
     // const
     const uint32_t id;
     timer_handler& parent;
-    // writes protected by backend lock
-    bool                                  allocated = false;
-    std::atomic<uint64_t>                 state{0}; ///< read can be without lock, thus writes must be atomic
-    srsran::move_callback<void(uint32_t)> callback;
+    // writes protected by domain ownership
+    bool                  allocated = false;
+    uint32_t              wheel_pos = INVALID_POS; ///< wheel list holding the timer, or INVALID_POS if not in the wheel
+    std::atomic<uint64_t> state{0}; ///< read without lock and updated by any thread, thus writes must be atomic CAS
+    callback_t            callback;
+    // requests from other threads
+    std::atomic<uint64_t>    request{NO_REQUEST};
+    std::atomic<callback_t*> request_callback{nullptr};
+    timer_impl*              next_request = nullptr;
 
     explicit timer_impl(timer_handler& parent_, uint32_t id_) : parent(parent_), id(id_) {}
     timer_impl(const timer_impl&) = delete;
     timer_impl(timer_impl&&)      = delete;
     timer_impl& operator=(const timer_impl&) = delete;
     timer_impl& operator=(timer_impl&&) = delete;
+    ~timer_impl() { delete request_callback.exchange(nullptr, std::memory_order_relaxed); }
 
     // unprotected
     bool       is_running_() const { return decode_is_running(state.load(std::memory_order_relaxed)); }
@@ -110,7 +143,12 @@ class timer_handler
       uint64_t state_snapshot = state.load(std::memory_order_relaxed);
       bool     running = decode_is_running(state_snapshot), expired = decode_is_expired(state_snapshot);
       uint32_t duration = decode_duration(state_snapshot), timeout = decode_timeout(state_snapshot);
-      return running ? duration - (timeout - parent.cur_time) : (expired ? duration : 0);
+      if (not running) {
+        return expired ? duration : 0;
+      }
+      // a timer run by another thread may be one tic overdue until its wheel position is updated
+      tic_diff_t remaining = timeout - parent.cur_time.load(std::memory_order_relaxed);
+      return static_cast<int32_t>(remaining) < 0 ? duration : duration - remaining;
     }
 
     void set(uint32_t duration_)
@@ -119,53 +157,24 @@ class timer_handler
                     "Invalid timer duration=%" PRIu32 ">%" PRIu32,
                     duration_,
                     MAX_TIMER_DURATION);
-      std::lock_guard<std::mutex> lock(parent.mutex);
-      set_(duration_);
+      parent.request_(*this, SET_REQUEST + duration_, nullptr);
     }
 
-    void set(uint32_t duration_, srsran::move_callback<void(uint32_t)> callback_)
+    void set(uint32_t duration_, callback_t callback_)
     {
       srsran_assert(duration_ <= MAX_TIMER_DURATION,
                     "Invalid timer duration=%" PRIu32 ">%" PRIu32,
                     duration_,
                     MAX_TIMER_DURATION);
-      std::lock_guard<std::mutex> lock(parent.mutex);
-      set_(duration_);
-      callback = std::move(callback_);
+      parent.request_(*this, SET_REQUEST + duration_, &callback_);
     }
 
-    void run()
-    {
-      std::lock_guard<std::mutex> lock(parent.mutex);
-      parent.start_run_(*this);
-    }
-
-    void stop()
-    {
-      std::lock_guard<std::mutex> lock(parent.mutex);
-      // does not call callback
-      parent.stop_timer_(*this, false);
-    }
+    void run() { parent.request_(*this, RUN_REQUEST, nullptr); }
 
-    void deallocate()
-    {
-      std::lock_guard<std::mutex> lock(parent.mutex);
-      parent.dealloc_timer_(*this);
-    }
+    // does not call callback
+    void stop() { parent.request_(*this, STOP_REQUEST, nullptr); }
 
-  private:
-    void set_(uint32_t duration_)
-    {
-      duration_ = std::max(duration_, 1U); // the next step will be one place ahead of current one
-      // called in locked context
-      uint64_t old_state = state.load(std::memory_order_relaxed);
-      if (decode_is_running(old_state)) {
-        // if already running, just extends timer lifetime
-        parent.start_run_(*this, duration_);
-      } else {
-        state.store(encode_state(STOPPED_FLAG, duration_, 0), std::memory_order_relaxed);
-      }
-    }
+    void deallocate() { parent.request_(*this, DEALLOC_REQUEST, nullptr); }
   };
 
 public:
@@ -234,7 +243,7 @@ public:
 
   explicit timer_handler(uint32_t capacity = 64)
   {
-    time_wheel.resize(WHEEL_SIZE);
+    time_wheel.resize(NOF_LEVELS * LEVEL_SIZE);
     // Pre-reserve timers
     while (timer_list.size() < capacity) {
       timer_list.emplace_back(*this, timer_list.size());
@@ -248,39 +257,57 @@ public:
 
   void step_all()
   {
-    std::unique_lock<std::mutex> lock(mutex);
-    uint32_t                     cur_time_local = cur_time.load(std::memory_order_relaxed) + 1;
-    auto&                        wheel_list     = time_wheel[cur_time_local & WHEEL_MASK];
-
-    for (auto it = wheel_list.begin(); it != wheel_list.end();) {
-      timer_impl& timer = timer_list[it->id];
-      ++it;
-      if (decode_timeout(timer.state.load(std::memory_order_relaxed)) == cur_time_local) {
-        // stop timer (callback has to see the timer has already expired)
-        stop_timer_(timer, true);
-
-        // Call callback if configured
-        if (not timer.callback.is_empty()) {
-          // unlock mutex. It can happen that the callback tries to run a timer too
-          lock.unlock();
-
-          timer.callback(timer.id);
-
-          // Lock again to keep protecting the wheel
-          lock.lock();
-        }
+    bind_owner_thread_();
+    process_requests_();
+
+    tic_t cur_time_local = wheel_time;
+
+    // Cascade the timers of the upper levels whose slot is reached
+    for (size_t level = NOF_LEVELS - 1; level > 0; --level) {
+      if ((cur_time_local & ((static_cast<tic_t>(1U) << (level * LEVEL_SHIFT)) - 1U)) == 0) {
+        cascade_(level * LEVEL_SIZE + ((cur_time_local >> (level * LEVEL_SHIFT)) & LEVEL_MASK));
       }
     }
 
+    // The timers run by the callbacks expire at the earliest in the next tic, so they never land in this slot
+    auto& expiring_list = time_wheel[cur_time_local & LEVEL_MASK];
+    min_timeout         = cur_time_local + 1;
+
+    while (not expiring_list.empty()) {
+      timer_impl& timer = expiring_list.front();
+      expiring_list.pop_front();
+      timer.wheel_pos = INVALID_POS;
+
+      // stop timer (callback has to see the timer has already expired). Timers that another thread has just updated
+      // are left to the update of their wheel position
+      if (not expire_timer_(timer, cur_time_local)) {
+        continue;
+      }
+
+      // Call callback if configured. It may run, stop or deallocate this or other timers
+      if (not timer.callback.is_empty()) {
+        timer.callback(timer.id);
+      }
+    }
+
+    wheel_time = cur_time_local + 1;
     cur_time.fetch_add(1, std::memory_order_relaxed);
   }
 
   void stop_all()
   {
-    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<timer_impl*> allocated_timers;
+    {
+      std::lock_guard<std::mutex> lock(alloc_mutex);
+      for (timer_impl& timer : timer_list) {
+        if (timer.allocated) {
+          allocated_timers.push_back(&timer);
+        }
+      }
+    }
     // does not call callback
-    for (timer_impl& timer : timer_list) {
-      stop_timer_(timer, false);
+    for (timer_impl* timer : allocated_timers) {
+      request_(*timer, STOP_REQUEST, nullptr);
     }
   }
 
@@ -288,23 +315,19 @@ public:
 
   uint32_t nof_timers() const
   {
-    std::lock_guard<std::mutex> lock(mutex);
+    std::lock_guard<std::mutex> lock(alloc_mutex);
     return timer_list.size() - nof_free_timers;
   }
 
-  uint32_t nof_running_timers() const
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    return nof_timers_running_;
-  }
+  uint32_t nof_running_timers() const { return nof_timers_running_.load(std::memory_order_relaxed); }
 
   constexpr static uint32_t max_timer_duration() { return MAX_TIMER_DURATION; }
 
   template <typename F>
   void defer_callback(uint32_t duration, const F& func)
   {
-    timer_impl&                           timer = alloc_timer();
-    srsran::move_callback<void(uint32_t)> c     = [func, &timer](uint32_t tid) {
+    timer_impl& timer = alloc_timer();
+    callback_t  c     = [func, &timer](uint32_t tid) {
       func();
       // auto-deletes timer
       timer.deallocate();
@@ -314,12 +337,12 @@ public:
   }
 
   // useful for testing
-  static size_t get_wheel_size() { return WHEEL_SIZE; }
+  static size_t get_wheel_size() { return LEVEL_SIZE; }
 
 private:
   timer_impl& alloc_timer()
   {
-    std::lock_guard<std::mutex> lock(mutex);
+    std::lock_guard<std::mutex> lock(alloc_mutex);
     timer_impl*                 t;
     if (not free_list.empty()) {
       t = &free_list.front();
@@ -341,66 +364,234 @@ private:
       // already deallocated
       return;
     }
-    stop_timer_(timer, false);
+    // discard requests that other threads may have posted before the deallocation. The timer may stay in the queue
+    timer.request.fetch_and(QUEUED_FLAG, std::memory_order_relaxed);
+    delete timer.request_callback.exchange(nullptr, std::memory_order_acquire);
+    update_state_(timer, [](uint64_t old_state) { return encode_state(STOPPED_FLAG, 0, 0); });
+    remove_from_wheel_(timer);
+    timer.callback = callback_t();
+
+    std::lock_guard<std::mutex> lock(alloc_mutex);
     timer.allocated = false;
-    timer.state.store(encode_state(STOPPED_FLAG, 0, 0), std::memory_order_relaxed);
-    timer.callback = srsran::move_callback<void(uint32_t)>();
     free_list.push_front(&timer);
     nof_free_timers++;
     // leave id unchanged.
   }
 
-  void start_run_(timer_impl& timer, uint32_t duration_ = 0)
+  /// Applies the request directly if called from the domain owner, or posts it to the owner otherwise
+  void request_(timer_impl& timer, uint64_t req, callback_t* callback_)
   {
-    uint64_t timer_old_state = timer.state.load(std::memory_order_relaxed);
-    duration_                = duration_ == 0 ? decode_duration(timer_old_state) : duration_;
-    uint32_t new_timeout     = cur_time.load(std::memory_order_relaxed) + duration_;
-    size_t   new_wheel_pos   = new_timeout & WHEEL_MASK;
-
-    uint32_t old_timeout = decode_timeout(timer_old_state);
-    bool     was_running = decode_is_running(timer_old_state);
-    if (was_running and (old_timeout & WHEEL_MASK) == new_wheel_pos) {
-      // If no change in timer wheel position. Just update absolute timeout
-      timer.state.store(encode_state(RUNNING_FLAG, duration_, new_timeout), std::memory_order_relaxed);
+    std::thread::id this_thread = std::this_thread::get_id();
+    std::thread::id owner       = owner_thread.load(std::memory_order_acquire);
+    if (owner == this_thread) {
+      apply_request_(timer, req, callback_);
       return;
     }
+    if (owner == std::thread::id()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (owner_thread.load(std::memory_order_relaxed) == std::thread::id()) {
+        apply_request_(timer, req, callback_);
+        return;
+      }
+    }
+    post_request_(timer, req, callback_);
+  }
 
-    // Stop timer if it was running, removing it from wheel in the process
-    if (was_running) {
-      time_wheel[old_timeout & WHEEL_MASK].pop(&timer);
-      nof_timers_running_--;
+  void apply_request_(timer_impl& timer, uint64_t req, callback_t* callback_)
+  {
+    if ((req & DEALLOC_REQUEST) != 0) {
+      dealloc_timer_(timer);
+      return;
+    }
+    if (callback_ != nullptr) {
+      timer.callback = std::move(*callback_);
     }
+    update_wheel_pos_(timer, apply_state_request_(timer, req));
+  }
 
-    // Insert timer in wheel
-    time_wheel[new_wheel_pos].push_front(&timer);
-    timer.state.store(encode_state(RUNNING_FLAG, duration_, new_timeout), std::memory_order_relaxed);
-    nof_timers_running_++;
+  /// Updates the timer state, which is visible to all threads, according to a set/run/stop request
+  uint64_t apply_state_request_(timer_impl& timer, uint64_t req)
+  {
+    uint64_t new_state = timer.state.load(std::memory_order_relaxed);
+    if ((req & SET_REQUEST) != 0) {
+      // if already running, just extends timer lifetime
+      uint32_t duration_ = std::max(decode_timeout(req), 1U); // the next step will be one place ahead of current one
+      new_state          = update_state_(timer, [this, duration_](uint64_t old_state) {
+        return decode_is_running(old_state) ? run_state_(duration_) : encode_state(STOPPED_FLAG, duration_, 0);
+      });
+    }
+    if ((req & RUN_REQUEST) != 0) {
+      new_state = update_state_(timer, [this](uint64_t old_state) { return run_state_(decode_duration(old_state)); });
+    } else if ((req & STOP_REQUEST) != 0) {
+      new_state = update_state_(timer, [](uint64_t old_state) {
+        return decode_is_running(old_state)
+                   ? encode_state(STOPPED_FLAG, decode_duration(old_state), decode_timeout(old_state))
+                   : old_state;
+      });
+    }
+    return new_state;
   }
 
-  /// called when user manually stops timer (as an alternative to expiry)
-  void stop_timer_(timer_impl& timer, bool expiry)
+  /// Applies the request to the timer state and queues the timer for the owner to update its wheel position. The
+  /// callback and the deallocation are left to the owner
+  void post_request_(timer_impl& timer, uint64_t req, callback_t* callback_)
   {
-    uint64_t timer_old_state = timer.state.load(std::memory_order_relaxed);
-    if (not decode_is_running(timer_old_state)) {
+    if (callback_ != nullptr) {
+      delete timer.request_callback.exchange(new callback_t(std::move(*callback_)), std::memory_order_acq_rel);
+    }
+    if ((req & DEALLOC_REQUEST) == 0) {
+      apply_state_request_(timer, req);
+    }
+    uint64_t old_req = timer.request.fetch_or(QUEUED_FLAG | (req & DEALLOC_REQUEST), std::memory_order_acq_rel);
+
+    if ((old_req & QUEUED_FLAG) == 0) {
+      timer_impl* head = request_queue.load(std::memory_order_relaxed);
+      do {
+        timer.next_request = head;
+      } while (not request_queue.compare_exchange_weak(head, &timer, std::memory_order_release));
+    }
+  }
+
+  /// Called by the domain owner to apply the requests posted by other threads
+  void process_requests_()
+  {
+    timer_impl* timer = request_queue.exchange(nullptr, std::memory_order_acquire);
+    while (timer != nullptr) {
+      timer_impl* next = timer->next_request;
+      uint64_t    req  = timer->request.exchange(NO_REQUEST, std::memory_order_acq_rel);
+      if ((req & DEALLOC_REQUEST) != 0) {
+        dealloc_timer_(*timer);
+      } else {
+        callback_t* c = timer->request_callback.exchange(nullptr, std::memory_order_acquire);
+        if (c != nullptr) {
+          timer->callback = std::move(*c);
+          delete c;
+        }
+        update_wheel_pos_(*timer, timer->state.load(std::memory_order_relaxed));
+      }
+      timer = next;
+    }
+  }
+
+  void bind_owner_thread_()
+  {
+    std::thread::id this_thread = std::this_thread::get_id();
+    if (owner_thread.load(std::memory_order_relaxed) != this_thread) {
+      std::lock_guard<std::mutex> lock(mutex);
+      owner_thread.store(this_thread, std::memory_order_release);
+    }
+  }
+
+  uint64_t run_state_(uint32_t duration_) const
+  {
+    return encode_state(RUNNING_FLAG, duration_, cur_time.load(std::memory_order_relaxed) + duration_);
+  }
+
+  /// Atomically replaces the timer state by new_state_func(old_state), and counts the timers started or stopped
+  template <typename StateFunc>
+  uint64_t update_state_(timer_impl& timer, const StateFunc& new_state_func)
+  {
+    uint64_t old_state = timer.state.load(std::memory_order_relaxed);
+    uint64_t new_state;
+    do {
+      new_state = new_state_func(old_state);
+    } while (not timer.state.compare_exchange_weak(old_state, new_state, std::memory_order_acq_rel));
+    count_running_(old_state, new_state);
+    return new_state;
+  }
+
+  void count_running_(uint64_t old_state, uint64_t new_state)
+  {
+    if (decode_is_running(old_state) != decode_is_running(new_state)) {
+      if (decode_is_running(new_state)) {
+        nof_timers_running_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        nof_timers_running_.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Called by the owner for a timer of the expiring wheel list. Returns false if the timer state was updated by
+  /// another thread, which has queued the timer to update its wheel position
+  bool expire_timer_(timer_impl& timer, tic_t tic)
+  {
+    uint64_t old_state = timer.state.load(std::memory_order_acquire);
+    if (not decode_is_running(old_state) or static_cast<int32_t>(decode_timeout(old_state) - tic) > 0 or
+        timer.request_callback.load(std::memory_order_relaxed) != nullptr) {
+      return false;
+    }
+    uint64_t new_state = encode_state(EXPIRED_FLAG, decode_duration(old_state), decode_timeout(old_state));
+    if (not timer.state.compare_exchange_strong(old_state, new_state, std::memory_order_acq_rel)) {
+      return false;
+    }
+    nof_timers_running_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// Wheel list where a timer expiring at the given timeout has to be placed
+  uint32_t get_wheel_pos_(tic_t timeout) const
+  {
+    // timers that should have already expired, expire in the next tic
+    if (static_cast<int32_t>(timeout - min_timeout) < 0) {
+      timeout = min_timeout;
+    }
+    tic_diff_t delta = timeout - wheel_time;
+    size_t level = 0;
+    while (level < NOF_LEVELS - 1 and (delta >> ((level + 1) * LEVEL_SHIFT)) != 0) {
+      level++;
+    }
+    return level * LEVEL_SIZE + ((timeout >> (level * LEVEL_SHIFT)) & LEVEL_MASK);
+  }
+
+  /// Moves the timers of an upper level slot to the lower levels
+  void cascade_(uint32_t pos)
+  {
+    srsran::intrusive_double_linked_list<timer_impl> cascaded = std::move(time_wheel[pos]);
+    while (not cascaded.empty()) {
+      timer_impl& timer = cascaded.front();
+      cascaded.pop_front();
+      timer.wheel_pos = INVALID_POS;
+      update_wheel_pos_(timer, timer.state.load(std::memory_order_relaxed));
+    }
+  }
+
+  /// Places the timer in the wheel list of its timeout if running, or removes it from the wheel otherwise
+  void update_wheel_pos_(timer_impl& timer, uint64_t state_)
+  {
+    if (not decode_is_running(state_)) {
+      remove_from_wheel_(timer);
       return;
     }
+    uint32_t new_wheel_pos = get_wheel_pos_(decode_timeout(state_));
+    if (timer.wheel_pos == new_wheel_pos) {
+      return;
+    }
+    remove_from_wheel_(timer);
+    time_wheel[new_wheel_pos].push_front(&timer);
+    timer.wheel_pos = new_wheel_pos;
+  }
 
-    // If already running, need to disconnect it from previous wheel
-    uint32_t old_timeout = decode_timeout(timer_old_state);
-    time_wheel[old_timeout & WHEEL_MASK].pop(&timer);
-    uint64_t new_state =
-        encode_state(expiry ? EXPIRED_FLAG : STOPPED_FLAG, decode_duration(timer_old_state), old_timeout);
-    timer.state.store(new_state, std::memory_order_relaxed);
-    nof_timers_running_--;
+  void remove_from_wheel_(timer_impl& timer)
+  {
+    if (timer.wheel_pos != INVALID_POS) {
+      time_wheel[timer.wheel_pos].pop(&timer);
+      timer.wheel_pos = INVALID_POS;
+    }
   }
 
-  std::atomic<tic_t> cur_time{0};
-  size_t             nof_timers_running_ = 0, nof_free_timers = 0;
+  std::atomic<tic_t>    cur_time{0};
+  tic_t                 wheel_time  = 1; ///< tic being processed, or next tic to be processed by the wheel
+  tic_t                 min_timeout = 1; ///< earliest timeout of the timers inserted in the wheel
+  std::atomic<uint32_t> nof_timers_running_{0};
+  size_t                nof_free_timers = 0;
   // using a deque to maintain reference validity on emplace_back. Also, this deque will only grow.
-  std::deque<timer_impl>                                         timer_list;
-  srsran::intrusive_forward_list<timer_impl>                     free_list;
-  std::vector<srsran::intrusive_double_linked_list<timer_impl> > time_wheel;
-  mutable std::mutex                                             mutex; // Protect priority queue
+  std::deque<timer_impl>                                          timer_list;
+  srsran::intrusive_forward_list<timer_impl>                      free_list;
+  std::vector<srsran::intrusive_double_linked_list<timer_impl> >  time_wheel;
+  mutable std::mutex                                              alloc_mutex; // Protect timer_list and free_list
+  std::mutex                                                      mutex;       // Protect domain without owner
+  std::atomic<std::thread::id>                                    owner_thread{std::thread::id()};
+  std::atomic<timer_impl*>                                        request_queue{nullptr};
 };
 
 using unique_timer = timer_handler::unique_timer;
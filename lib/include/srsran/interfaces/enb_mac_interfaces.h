@@ -34,6 +34,8 @@ struct mac_args_t {
   uint32_t                      nof_prealloc_ues; ///< Number of UE resources to pre-allocate at eNB startup
   uint32_t                      max_nof_kos;
   int                           rlf_min_ul_snr_estim;
+  bool                          pusch_8bit_decoder;    ///< UL softbuffers hold the LLRs of the PUSCH 8-bit decoder
+  uint32_t                      max_softbuffer_mem_mb; ///< Memory limit of the HARQ softbuffer pool, 0 for none
 };
 
 /* Interface PHY -> MAC */
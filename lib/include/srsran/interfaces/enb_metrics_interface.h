@@ -29,6 +29,7 @@
 #include "srsenb/hdr/stack/mac/common/mac_metrics.h"
 #include "srsenb/hdr/stack/rrc/rrc_metrics.h"
 #include "srsenb/hdr/stack/s1ap/s1ap_metrics.h"
+#include "srsran/common/buffer_pool.h"
 #include "srsran/common/metrics_hub.h"
 #include "srsran/radio/radio_metrics.h"
 #include "srsran/rlc/rlc_metrics.h"
@@ -46,17 +47,23 @@ struct pdcp_metrics_t {
   std::vector<srsran::pdcp_metrics_t> ues;
 };
 
+/// Occupancy of the byte buffer pool, per size class
+using byte_buffer_pool_metrics_t =
+    std::array<srsran::buffer_pool_metrics_t, (size_t)srsran::byte_buffer_class_t::nof_classes>;
+
 struct stack_metrics_t {
-  mac_metrics_t  mac;
-  rrc_metrics_t  rrc;
-  rlc_metrics_t  rlc;
-  pdcp_metrics_t pdcp;
-  s1ap_metrics_t s1ap;
+  mac_metrics_t              mac;
+  rrc_metrics_t              rrc;
+  rlc_metrics_t              rlc;
+  pdcp_metrics_t             pdcp;
+  s1ap_metrics_t             s1ap;
+  byte_buffer_pool_metrics_t byte_buffer_pool;
 };
 
 struct enb_metrics_t {
   srsran::rf_metrics_t       rf;
   std::vector<phy_metrics_t> phy;
+  phy_timing_metrics_t       phy_timing;
   stack_metrics_t            stack;
   stack_metrics_t            nr_stack;
   srsran::sys_metrics_t      sys;
@@ -19,6 +19,7 @@
  *
  */
 
+#include "srsran/adt/span.h"
 #include "srsran/common/byte_buffer.h"
 #include "srsran/interfaces/pdcp_interface_types.h"
 #include <map>
@@ -34,6 +35,14 @@ class pdcp_interface_gtpu
 public:
   virtual void write_sdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t sdu, int pdcp_sn = -1) = 0;
   virtual std::map<uint32_t, srsran::unique_byte_buffer_t> get_buffered_pdus(uint16_t rnti, uint32_t lcid) = 0;
+
+  /// Writes a burst of SDUs of the same bearer, which take consecutive PDCP SNs
+  virtual void write_sdus(uint16_t rnti, uint32_t lcid, srsran::span<srsran::unique_byte_buffer_t> sdus)
+  {
+    for (srsran::unique_byte_buffer_t& sdu : sdus) {
+      write_sdu(rnti, lcid, std::move(sdu));
+    }
+  }
 };
 
 // PDCP interface for RRC
@@ -22,8 +22,11 @@
 #ifndef SRSRAN_EPC_INTERFACES_H
 #define SRSRAN_EPC_INTERFACES_H
 
+#include "srsran/adt/move_callback.h"
 #include "srsran/asn1/gtpc_ies.h"
+#include "srsran/common/byte_buffer.h"
 #include "srsran/common/common.h"
+#include <map>
 #include <netinet/sctp.h>
 #include <queue>
 
@@ -66,6 +69,7 @@ public:
   virtual bool     delete_ue_ctx(uint64_t imsi)                                              = 0;
   virtual uint64_t find_imsi_from_m_tmsi(uint32_t m_tmsi)                                    = 0;
   virtual nas*     find_nas_ctx_from_imsi(uint64_t imsi)                                     = 0;
+  virtual nas*     find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id)                 = 0;
   virtual bool     send_initial_context_setup_request(uint64_t imsi, uint16_t erab_to_setup) = 0;
   virtual bool     send_ue_context_release_command(uint32_t mme_ue_s1ap_id)                  = 0;
   virtual bool     send_erab_release_command(uint32_t               enb_ue_s1ap_id,
@@ -83,20 +87,37 @@ public:
                                                struct sctp_sndrcvinfo enb_sri)               = 0;
 };
 
+// Authentication vector of an Authentication Information Request
+struct hss_auth_info_t {
+  uint64_t imsi;
+  bool     user_found;
+  uint8_t  k_asme[32];
+  uint8_t  autn[16];
+  uint8_t  rand[16];
+  uint8_t  xres[16];
+};
+typedef srsran::move_callback<void(const hss_auth_info_t&)> hss_auth_info_callback_t;
+
 class hss_interface_nas // NAS -> HSS
 {
 public:
   virtual bool gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres) = 0;
   virtual bool gen_update_loc_answer(uint64_t imsi, uint8_t* qci)                                                = 0;
   virtual bool resync_sqn(uint64_t imsi, uint8_t* auts)                                                          = 0;
+  // Vectors of several requests at once, for the IMSI of each. Returns the number of users found
+  virtual uint32_t gen_auth_info_answers(hss_auth_info_t* infos, uint32_t nof_infos) = 0;
 };
 
 class mme_interface_nas // NAS -> MME
 {
 public:
-  virtual bool add_nas_timer(int timer_fd, enum nas_timer_type type, uint64_t imsi) = 0;
-  virtual bool is_nas_timer_running(enum nas_timer_type type, uint64_t imsi)        = 0;
-  virtual bool remove_nas_timer(enum nas_timer_type type, uint64_t imsi)            = 0;
+  virtual bool add_nas_timer(uint32_t duration_ms, enum nas_timer_type type, uint64_t imsi) = 0;
+  virtual bool is_nas_timer_running(enum nas_timer_type type, uint64_t imsi)               = 0;
+  virtual bool remove_nas_timer(enum nas_timer_type type, uint64_t imsi)                   = 0;
+  // Runs an HSS request, possibly on another thread, and then its response on the calling UE's thread
+  virtual void defer_hss_request(srsran::move_task_t request, srsran::move_task_t response) = 0;
+  // Same for an Authentication Information Request, which may be generated together with those of other UEs
+  virtual void defer_auth_info_request(uint64_t imsi, hss_auth_info_callback_t response) = 0;
 };
 
 class s1ap_interface_mme // MME -> S1AP
@@ -113,11 +134,14 @@ class gtpu_interface_gtpc // GTP-C -> GTP-U
 public:
   virtual in_addr_t get_s1u_addr() = 0;
 
-  virtual bool modify_gtpu_tunnel(in_addr_t ue_ipv4, srsran::gtpc_f_teid_ie dw_user_fteid, uint32_t up_ctrl_teid) = 0;
-  virtual bool delete_gtpu_tunnel(in_addr_t ue_ipv4)                                                              = 0;
-  virtual bool delete_gtpc_tunnel(in_addr_t ue_ipv4)                                                              = 0;
+  virtual bool modify_gtpu_tunnel(in_addr_t              ue_ipv4,
+                                  srsran::gtpc_f_teid_ie dw_user_fteid,
+                                  uint32_t               up_user_teid,
+                                  uint32_t               up_ctrl_teid)                       = 0;
+  virtual bool delete_gtpu_tunnel(in_addr_t ue_ipv4)                                           = 0;
+  virtual bool delete_gtpc_tunnel(in_addr_t ue_ipv4)                                           = 0;
   virtual void send_all_queued_packets(srsran::gtp_fteid_t                       dw_user_fteid,
-                                       std::queue<srsran::unique_byte_buffer_t>& pkt_queue)                       = 0;
+                                       std::queue<srsran::unique_byte_buffer_t>& pkt_queue) = 0;
 };
 
 class gtpc_interface_gtpu // GTP-U -> GTP-C
@@ -115,6 +115,13 @@ SRSRAN_API int srsran_enb_dl_put_pdcch_ul(srsran_enb_dl_t* q, srsran_dci_cfg_t*
 SRSRAN_API int
 srsran_enb_dl_put_pdsch(srsran_enb_dl_t* q, srsran_pdsch_cfg_t* pdsch, uint8_t* data[SRSRAN_MAX_CODEWORDS]);
 
+/* Encodes a PDSCH into the resource grid of the eNb DL object using an external PDSCH encoder, so that PDSCH of
+ * different users can be encoded concurrently. The PDSCH object must have been initialised for the same cell. */
+SRSRAN_API int srsran_enb_dl_put_pdsch_lane(srsran_enb_dl_t*    q,
+                                            srsran_pdsch_t*     pdsch,
+                                            srsran_pdsch_cfg_t* pdsch_cfg,
+                                            uint8_t*            data[SRSRAN_MAX_CODEWORDS]);
+
 SRSRAN_API int srsran_enb_dl_put_pmch(srsran_enb_dl_t* q, srsran_pmch_cfg_t* pmch_cfg, uint8_t* data);
 
 SRSRAN_API void srsran_enb_dl_gen_signal(srsran_enb_dl_t* q);
@@ -63,6 +63,14 @@ typedef struct SRSRAN_API {
 
 } srsran_enb_ul_t;
 
+/* Channel estimator and PUSCH decoder able to decode PUSCH transmissions of the same subframe concurrently with the
+ * srsran_enb_ul_t object and other lanes. The received subframe is only read, from the srsran_enb_ul_t object. */
+typedef struct SRSRAN_API {
+  srsran_chest_ul_res_t chest_res;
+  srsran_chest_ul_t     chest;
+  srsran_pusch_t        pusch;
+} srsran_enb_ul_pusch_lane_t;
+
 /* This function shall be called just after the initial synchronization */
 SRSRAN_API int srsran_enb_ul_init(srsran_enb_ul_t* q, cf_t* in_buffer, uint32_t max_prb);
 
@@ -85,4 +93,19 @@ SRSRAN_API int srsran_enb_ul_get_pusch(srsran_enb_ul_t*    q,
                                        srsran_pusch_cfg_t* cfg,
                                        srsran_pusch_res_t* res);
 
+SRSRAN_API int srsran_enb_ul_pusch_lane_init(srsran_enb_ul_pusch_lane_t* q, uint32_t max_prb);
+
+SRSRAN_API void srsran_enb_ul_pusch_lane_free(srsran_enb_ul_pusch_lane_t* q);
+
+SRSRAN_API int srsran_enb_ul_pusch_lane_set_cell(srsran_enb_ul_pusch_lane_t*        q,
+                                                 srsran_cell_t                      cell,
+                                                 srsran_refsignal_dmrs_pusch_cfg_t* pusch_cfg,
+                                                 srsran_refsignal_srs_cfg_t*        srs_cfg);
+
+SRSRAN_API int srsran_enb_ul_get_pusch_lane(srsran_enb_ul_t*            q,
+                                            srsran_enb_ul_pusch_lane_t* lane,
+                                            srsran_ul_sf_cfg_t*         ul_sf,
+                                            srsran_pusch_cfg_t*         cfg,
+                                            srsran_pusch_res_t*         res);
+
 #endif // SRSRAN_ENB_UL_H
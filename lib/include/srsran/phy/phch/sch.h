@@ -38,6 +38,7 @@
 #include "srsran/phy/fec/turbo/turbodecoder.h"
 #include "srsran/phy/phch/pdsch_cfg.h"
 #include "srsran/phy/phch/pusch_cfg.h"
+#include "srsran/phy/phch/sch_decoder_pool.h"
 #include "srsran/phy/phch/uci.h"
 
 #ifndef SRSRAN_RX_NULL
@@ -71,6 +72,10 @@ typedef struct SRSRAN_API {
 
   srsran_uci_cqi_pusch_t uci_cqi;
 
+  /* Optional pool decoding the code blocks in parallel, and the decoding resources of the calling thread */
+  srsran_sch_decoder_pool_t* decoder_pool;
+  srsran_sch_cb_decoder_t*   pool_caller_dec;
+
 } srsran_sch_t;
 
 SRSRAN_API int srsran_sch_init(srsran_sch_t* q);
@@ -81,6 +86,10 @@ SRSRAN_API void srsran_sch_set_max_noi(srsran_sch_t* q, uint32_t max_iterations)
 
 SRSRAN_API float srsran_sch_last_noi(srsran_sch_t* q);
 
+/* Decodes the code blocks of the transport blocks in the given pool, which may be shared with other SCH objects.
+ * A NULL pool decodes them serially in the calling thread. */
+SRSRAN_API int srsran_sch_set_decoder_pool(srsran_sch_t* q, srsran_sch_decoder_pool_t* pool);
+
 SRSRAN_API int srsran_dlsch_encode(srsran_sch_t* q, srsran_pdsch_cfg_t* cfg, uint8_t* data, uint8_t* e_bits);
 
 SRSRAN_API int srsran_dlsch_encode2(srsran_sch_t*       q,
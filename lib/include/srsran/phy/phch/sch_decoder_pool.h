@@ -0,0 +1,86 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         sch_decoder_pool.h
+ *
+ *  Description:  Pool of threads shared by several SCH decoders, which turbo
+ *                decode the code blocks of the transport blocks in parallel.
+ *                Each thread owns its decoder and CRC instances.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_SCH_DECODER_POOL_H
+#define SRSRAN_SCH_DECODER_POOL_H
+
+#include "srsran/config.h"
+#include "srsran/phy/fec/crc.h"
+#include "srsran/phy/fec/turbo/turbodecoder.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Decoding resources of one thread */
+typedef struct SRSRAN_API {
+  srsran_tdec_t decoder;
+  srsran_crc_t  crc_tb;
+  srsran_crc_t  crc_cb;
+  uint8_t*      cb_data; // Decoded code block, including its CRC
+} srsran_sch_cb_decoder_t;
+
+/* Decodes task task_idx of a job. When aborted is set, a previous task of the same job has failed and the task
+ * only needs to keep its soft bits. Returns false if the task failed, which aborts the remaining tasks of the job. */
+typedef bool (*srsran_sch_decoder_pool_fn_t)(void* arg, uint32_t task_idx, srsran_sch_cb_decoder_t* dec, bool aborted);
+
+/* Group of tasks, typically the code blocks of a transport block, run by srsran_sch_decoder_pool_run() */
+typedef struct SRSRAN_API {
+  srsran_sch_decoder_pool_fn_t fn;
+  void*                        arg;
+  uint32_t                     nof_tasks;
+
+  /* Private, protected by the pool lock */
+  uint32_t next_task;
+  uint32_t nof_done;
+  bool     aborted;
+  void*    next_job;
+} srsran_sch_decoder_pool_job_t;
+
+typedef struct SRSRAN_API {
+  uint32_t nof_threads;
+  void*    impl;
+} srsran_sch_decoder_pool_t;
+
+SRSRAN_API int srsran_sch_decoder_pool_init(srsran_sch_decoder_pool_t* q, uint32_t nof_threads);
+
+SRSRAN_API void srsran_sch_decoder_pool_free(srsran_sch_decoder_pool_t* q);
+
+SRSRAN_API int srsran_sch_cb_decoder_init(srsran_sch_cb_decoder_t* dec);
+
+SRSRAN_API void srsran_sch_cb_decoder_free(srsran_sch_cb_decoder_t* dec);
+
+/* Runs all the tasks of a job in the pool and returns once they are done. The calling thread also runs tasks of the
+ * job with its own decoding resources, so that the job completes even if all the pool threads are busy.
+ * Several threads may run jobs in the same pool concurrently. Returns false if any task failed. */
+SRSRAN_API bool srsran_sch_decoder_pool_run(srsran_sch_decoder_pool_t*     q,
+                                            srsran_sch_decoder_pool_job_t* job,
+                                            srsran_sch_cb_decoder_t*       caller_dec);
+
+#endif // SRSRAN_SCH_DECODER_POOL_H
@@ -27,9 +27,35 @@ extern "C" {
 #endif
 
 #include "srsran/config.h"
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
+/* SIMD instruction set used by the vector kernels */
+typedef enum {
+  SRSRAN_SIMD_ISA_GENERIC = 0,
+  SRSRAN_SIMD_ISA_SSE,
+  SRSRAN_SIMD_ISA_AVX,
+  SRSRAN_SIMD_ISA_AVX2,
+  SRSRAN_SIMD_ISA_AVX512,
+  SRSRAN_SIMD_ISA_NEON,
+  SRSRAN_SIMD_ISA_COUNT
+} srsran_simd_isa_t;
+
+SRSRAN_API const char* srsran_simd_isa_string(srsran_simd_isa_t isa);
+
+/* Returns the ISA of the vector SIMD kernels in use. Without runtime dispatch (ENABLE_SIMD_DISPATCH) it is the ISA
+ * selected at compile time, otherwise the best ISA supported by the CPU, detected at startup. The environment variable
+ * SRSRAN_SIMD_ISA (generic, sse, avx, avx2 or avx512) lowers the ISA selected at startup. */
+SRSRAN_API srsran_simd_isa_t srsran_vec_simd_get_isa(void);
+
+/* Returns true if the vector SIMD kernels can run with the given ISA in this build and CPU */
+SRSRAN_API bool srsran_vec_simd_isa_available(srsran_simd_isa_t isa);
+
+/* Switches the vector SIMD kernels to the given ISA. It is not thread-safe, so it must be called before starting the
+ * processing threads. Returns SRSRAN_ERROR if the ISA is not available */
+SRSRAN_API int srsran_vec_simd_set_isa(srsran_simd_isa_t isa);
+
 /*SIMD Logical operations*/
 SRSRAN_API void srsran_vec_xor_bbb_simd(const uint8_t* x, const uint8_t* y, uint8_t* z, int len);
 
@@ -27,6 +27,7 @@
 #include "srsran/adt/circular_map.h"
 #include "srsran/adt/intrusive_list.h"
 #include "srsran/common/buffer_pool.h"
+#include "srsran/common/byte_buffer_chain.h"
 #include "srsran/common/common.h"
 #include "srsran/common/task_scheduler.h"
 #include "srsran/common/timeout.h"
@@ -117,7 +118,7 @@ public:
   const uint32_t       rlc_sn     = invalid_rlc_sn;
   uint32_t             retx_count = 0;
   rlc_amd_pdu_header_t header;
-  unique_byte_buffer_t buf;
+  byte_buffer_chain    buf; ///< Slices of the SDUs carried by the PDU, kept for retransmissions
 
   explicit rlc_amd_tx_pdu(uint32_t rlc_sn_) : rlc_sn(rlc_sn_) {}
   rlc_amd_tx_pdu(const rlc_amd_tx_pdu&)           = delete;
@@ -431,7 +432,7 @@ private:
 
     // TX SDU buffers
     byte_buffer_queue    tx_sdu_queue;
-    unique_byte_buffer_t tx_sdu;
+    shared_byte_buffer_t tx_sdu; ///< SDU being segmented, shared with the PDUs that carry its segments
 
     bool tx_enabled = false;
 
@@ -38,6 +38,8 @@ namespace srsran {
 #define RLC_AM_WINDOW_SIZE 512
 #define RLC_MAX_SDU_SIZE ((1 << 11) - 1) // Length of LI field is 11bits
 #define RLC_AM_MIN_DATA_PDU_SIZE (3)     // AMD PDU with 10 bit SN (length of LI field is 11 bits) (No LI)
+#define RLC_RX_SDU_BUFFER_SIZE (1500)    // Buffer size of SDUs being reassembled, which grow if the SDU is larger
+#define RLC_MAX_RX_SDU_SIZE (SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET) // Largest reassembled SDU
 
 typedef enum {
   RLC_FI_FIELD_START_AND_END_ALIGNED = 0,
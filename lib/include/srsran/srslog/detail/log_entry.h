@@ -24,6 +24,7 @@
 
 #include "srsran/srslog/detail/log_entry_metadata.h"
 #include "srsran/srslog/detail/support/thread_utils.h"
+#include <atomic>
 
 namespace srslog {
 
@@ -35,6 +36,9 @@ namespace detail {
 struct flush_backend_cmd {
   shared_variable<bool>& completion_flag;
   std::vector<sink*>     sinks;
+  /// Number of backend workers that still have to complete the command when
+  /// it is split among several workers. Empty when a single worker runs it.
+  std::shared_ptr<std::atomic<unsigned> > pending_workers;
 };
 
 /// This structure packs all the required data required to create a log entry in
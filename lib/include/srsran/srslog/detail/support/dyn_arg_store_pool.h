@@ -24,6 +24,7 @@
 
 #include "srsran/srslog/bundled/fmt/printf.h"
 #include "srsran/srslog/detail/support/backend_capacity.h"
+#include "srsran/srslog/detail/support/work_queue.h"
 
 namespace srslog {
 
@@ -32,6 +33,8 @@ namespace detail {
 /// Keeps a pool of dynamic_format_arg_store objects. The main reason for this class is that the arg store objects are
 /// implemented with std::vectors, so we want to avoid allocating memory each time we create a new object. Instead,
 /// reserve memory for each vector during initialization and recycle the objects.
+/// The free objects are kept in a lock-free queue, so that allocations from the logging threads and deallocations
+/// from the backend workers do not block each other.
 class dyn_arg_store_pool
 {
 public:
@@ -42,24 +45,16 @@ public:
       // Reserve for 10 normal and 2 named arguments.
       elem.reserve(10, 2);
     }
-    free_list.reserve(SRSLOG_QUEUE_CAPACITY);
     for (auto& elem : pool) {
-      free_list.push_back(&elem);
+      free_list.push(&elem);
     }
   }
 
   /// Returns a pointer to a free dyn arg store object, otherwise returns nullptr.
   fmt::dynamic_format_arg_store<fmt::printf_context>* alloc()
   {
-    scoped_lock lock(m);
-    if (free_list.empty()) {
-      return nullptr;
-    }
-
-    auto* p = free_list.back();
-    free_list.pop_back();
-
-    return p;
+    auto item = free_list.try_pop();
+    return item.first ? item.second : nullptr;
   }
 
   /// Deallocate the given dyn arg store object returning it to the pool.
@@ -70,14 +65,13 @@ public:
     }
 
     p->clear();
-    scoped_lock lock(m);
-    free_list.push_back(p);
+    // The free list has room for all the objects of the pool, so this never fails.
+    free_list.push(p);
   }
 
 private:
   std::vector<fmt::dynamic_format_arg_store<fmt::printf_context> > pool;
-  std::vector<fmt::dynamic_format_arg_store<fmt::printf_context>*> free_list;
-  mutable mutex                                                    m;
+  work_queue<fmt::dynamic_format_arg_store<fmt::printf_context>*>  free_list;
 };
 
 } // namespace detail
@@ -22,92 +22,56 @@
 #ifndef SRSLOG_DETAIL_SUPPORT_WORK_QUEUE_H
 #define SRSLOG_DETAIL_SUPPORT_WORK_QUEUE_H
 
-#include "srsran/adt/circular_buffer.h"
+#include "srsran/adt/lockfree_queue.h"
 #include "srsran/srslog/detail/support/backend_capacity.h"
-#include "srsran/srslog/detail/support/thread_utils.h"
 
 namespace srslog {
 
 namespace detail {
 
-//: TODO: this is a temp work queue.
-
 /// Thread safe generic data type work queue.
-template <typename T, size_t capacity = SRSLOG_QUEUE_CAPACITY>
+/// Lock-free bounded queue that supports several concurrent producers and consumers, so that threads never block each
+/// other.
+template <typename T>
 class work_queue
 {
-  srsran::dyn_circular_buffer<T> queue;
-  mutable mutex                  m;
-  static constexpr size_t        threshold = capacity * 0.98;
+  srsran::bounded_mpmc_queue<T> queue;
+  const size_t                  threshold;
 
 public:
-  work_queue() : queue(capacity) {}
+  /// The capacity is rounded up to a power of 2.
+  explicit work_queue(size_t capacity = SRSLOG_QUEUE_CAPACITY) : queue(capacity), threshold(queue.capacity() * 0.98)
+  {}
 
   work_queue(const work_queue&) = delete;
   work_queue& operator=(const work_queue&) = delete;
 
   /// Inserts a new element into the back of the queue. Returns false when the
   /// queue is full, otherwise true.
-  bool push(const T& value)
-  {
-    m.lock();
-    // Discard the new element if we reach the maximum capacity.
-    if (queue.full()) {
-      m.unlock();
-      return false;
-    }
-    queue.push(value);
-    m.unlock();
-
-    return true;
-  }
+  bool push(const T& value) { return queue.try_push(value); }
 
   /// Inserts a new element into the back of the queue. Returns false when the
-  /// queue is full, otherwise true.
-  bool push(T&& value)
-  {
-    m.lock();
-    // Discard the new element if we reach the maximum capacity.
-    if (queue.full()) {
-      m.unlock();
-      return false;
-    }
-    queue.push(std::move(value));
-    m.unlock();
-
-    return true;
-  }
+  /// queue is full, otherwise true. The element is not moved when the queue is
+  /// full.
+  bool push(T&& value) { return queue.try_push(std::move(value)); }
 
   /// Extracts the top most element from the queue if it exists.
   /// Returns a pair with a bool indicating if the pop has been successful.
   std::pair<bool, T> try_pop()
   {
-    m.lock();
-
-    if (queue.empty()) {
-      m.unlock();
-      return {false, T()};
-    }
-
-    // Here we have been woken up normally.
-    T Item = std::move(queue.top());
-    queue.pop();
-
-    m.unlock();
-
-    return {true, std::move(Item)};
+    std::pair<bool, T> item{false, T()};
+    item.first = queue.try_pop(item.second);
+    return item;
   }
 
   /// Capacity of the queue.
-  size_t get_capacity() const { return capacity; }
+  size_t get_capacity() const { return queue.capacity(); }
 
-  /// Returns true when the queue is almost full, otherwise returns false.
-  bool is_almost_full() const
-  {
-    scoped_lock lock(m);
+  /// Returns the approximate number of elements in the queue.
+  size_t size() const { return queue.size(); }
 
-    return queue.size() > threshold;
-  }
+  /// Returns true when the queue is almost full, otherwise returns false.
+  bool is_almost_full() const { return size() > threshold; }
 };
 
 } // namespace detail
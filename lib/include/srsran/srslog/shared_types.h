@@ -40,6 +40,15 @@ enum class backend_priority {
   very_high
 };
 
+/// Policies applied when a log entry is generated and the backend queue is full.
+enum class backend_overflow_policy {
+  /// The new log entry is discarded and accounted as dropped.
+  discard,
+  /// The logging thread waits until the backend makes room for the new entry.
+  /// No entries are lost, but logging threads stall while the backend is behind.
+  block
+};
+
 /// syslog log local types
 enum class syslog_local_type {
   local0,
@@ -156,6 +156,12 @@ std::unique_ptr<log_formatter> create_text_formatter();
 /// Creates a new instance of a JSON formatter.
 std::unique_ptr<log_formatter> create_json_formatter();
 
+/// Creates a new instance of a binary formatter. Instead of text, it writes compact records holding the raw arguments
+/// of each log entry, which can be rendered to text offline with the srslog_decoder tool.
+/// NOTE: The output of this formatter can only be decoded from the beginning of the stream, use it with sinks that
+/// do not rotate or split their output, like the one returned by fetch_binary_file_sink.
+std::unique_ptr<log_formatter> create_binary_formatter();
+
 ///
 /// Sink management functions.
 ///
@@ -195,6 +201,13 @@ sink& fetch_file_sink(const std::string&             path,
                       bool                           force_flush = false,
                       std::unique_ptr<log_formatter> f           = get_default_log_formatter());
 
+/// Returns an instance of a sink that writes into a file in the specified path
+/// using the binary formatter. File rotation is not supported since the
+/// contents of a binary log can only be decoded from the beginning of the file.
+/// Setting force_flush to true will flush the sink after every write.
+/// NOTE: Any '#' characters in the path will get removed.
+sink& fetch_binary_file_sink(const std::string& path, bool force_flush = false);
+
 /// Returns an instance of a sink that writes into syslog
 /// preamble: The string  prepended to every message, If ident is "", the program name is used.
 /// log_local: custom unused facilities that syslog provides which can be used by the user
@@ -254,6 +267,22 @@ void flush();
 /// NOTE: This function should be called before init() and is NOT thread safe.
 void set_error_handler(error_handler handler);
 
+/// Sets the policy applied when a log entry is generated while the backend
+/// queue is full. By default new entries are discarded.
+/// NOTE: This function should be called before init() and is NOT thread safe.
+void set_backend_overflow_policy(backend_overflow_policy policy);
+
+/// Sets the number of backend threads that process log entries. Each sink is
+/// assigned to a single thread, so entries of the same sink are written in
+/// order. Using several threads only helps when log entries are written into
+/// several sinks. The default is a single thread.
+/// NOTE: This function should be called before init() and is NOT thread safe.
+void set_nof_backend_workers(unsigned nof_workers);
+
+/// Returns the number of log entries that have been discarded because the
+/// backend was full.
+uint64_t get_nof_dropped_entries();
+
 } // namespace srslog
 
 #endif // SRSLOG_SRSLOG_H
@@ -47,6 +47,7 @@ public:
   void reset() override;
   void set_enabled(uint32_t lcid, bool enabled) override;
   void write_sdu(uint32_t lcid, unique_byte_buffer_t sdu, int sn = -1) override;
+  void write_sdus(uint32_t lcid, span<unique_byte_buffer_t> sdus);
   void write_sdu_mch(uint32_t lcid, unique_byte_buffer_t sdu);
   int  add_bearer(uint32_t lcid, const pdcp_config_t& cnfg) override;
   void add_bearer_mrb(uint32_t lcid, const pdcp_config_t& cnfg);
@@ -23,6 +23,7 @@
 #define SRSRAN_PDCP_ENTITY_BASE_H
 
 #include "srsran/adt/accumulators.h"
+#include "srsran/adt/span.h"
 #include "srsran/common/buffer_pool.h"
 #include "srsran/common/common.h"
 #include "srsran/common/interfaces_common.h"
@@ -120,6 +121,8 @@ public:
 
   // GW/SDAP/RRC interface
   virtual void write_sdu(unique_byte_buffer_t sdu, int sn = -1) = 0;
+  // Writes a burst of SDUs, which take consecutive COUNTs. By default, each SDU is written separately
+  virtual void write_sdus(span<unique_byte_buffer_t> sdus);
 
   // RLC interface
   virtual void write_pdu(unique_byte_buffer_t pdu)               = 0;
@@ -169,11 +172,16 @@ protected:
 
   srsran::as_security_config_t sec_cfg = {};
 
+  // Key schedules of the ciphering and integrity keys of this bearer, precomputed in config_security()
+  srsran::security_key_ctx k_enc_ctx;
+  srsran::security_key_ctx k_int_ctx;
+
   // Security functions
   void integrity_generate(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac);
   bool integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac);
   void cipher_encrypt(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* ct);
   void cipher_decrypt(uint8_t* ct, uint32_t ct_len, uint32_t count, uint8_t* msg);
+  void cipher_encrypt_batch(span<security_cipher_msg_t> msgs);
 
   // Common packing functions
   bool            is_control_pdu(const unique_byte_buffer_t& pdu);
@@ -125,6 +125,7 @@ public:
 
   // GW/RRC interface
   void write_sdu(unique_byte_buffer_t sdu, int sn = -1) override;
+  void write_sdus(span<unique_byte_buffer_t> sdus) override;
 
   // RLC interface
   void write_pdu(unique_byte_buffer_t pdu) override;
@@ -165,6 +166,15 @@ private:
   uint32_t reordering_window = 0;
   uint32_t maximum_pdcp_sn   = 0;
 
+  // TX helpers, shared by write_sdu() and write_sdus()
+  bool prepare_tx_pdu(unique_byte_buffer_t& sdu, int upper_sn, uint32_t& tx_count);
+  void send_tx_pdu(unique_byte_buffer_t pdu);
+  bool tx_encryption_enabled() const
+  {
+    return encryption_direction == DIRECTION_TX || encryption_direction == DIRECTION_TXRX;
+  }
+  std::vector<security_cipher_msg_t> tx_burst_cipher_msgs;
+
   // PDU handlers
   void handle_control_pdu(srsran::unique_byte_buffer_t pdu);
   void handle_srb_pdu(srsran::unique_byte_buffer_t pdu);
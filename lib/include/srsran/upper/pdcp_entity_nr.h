@@ -56,6 +56,7 @@ public:
 
   // RRC interface
   void write_sdu(unique_byte_buffer_t sdu, int sn = -1) final;
+  void write_sdus(span<unique_byte_buffer_t> sdus) final;
 
   // RLC interface
   void write_pdu(unique_byte_buffer_t pdu) final;
@@ -98,6 +99,12 @@ private:
   std::map<uint32_t, unique_byte_buffer_t> reorder_queue;
   timer_handler::unique_timer              reordering_timer;
 
+  // TX helpers, shared by write_sdu() and write_sdus()
+  bool prepare_tx_sdu(const unique_byte_buffer_t& sdu, uint32_t& tx_count, uint8_t* mac);
+  void send_tx_pdu(unique_byte_buffer_t pdu, uint32_t tx_count, uint8_t* mac);
+  std::vector<security_cipher_msg_t>   tx_burst_cipher_msgs;
+  std::vector<std::array<uint8_t, 4> > tx_burst_macs;
+
   // Pass to Upper Layers Helper function
   void deliver_all_consecutive_counts();
   void pass_to_upper_layers(unique_byte_buffer_t pdu);
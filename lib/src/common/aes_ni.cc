@@ -0,0 +1,577 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/aes_ni.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AES_NI_X86
+#include <cpuid.h>
+#include <immintrin.h>
+
+// The VAES intrinsics are only available from GCC 8 and clang 6 on
+#if defined(__clang__)
+#if __clang_major__ >= 6
+#define AES_NI_HAVE_VAES
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define AES_NI_HAVE_VAES
+#endif
+#endif
+
+#define AES_NI_NOF_ROUNDS 10
+#define AES_NI_BLOCK_LEN 16
+
+#ifdef AES_NI_X86
+
+#define X86_CPUID_BASIC_LEAF 1
+#define X86_CPUID_ADVANCED_LEAF 7
+#define X86_CPUID_AES_BIT (1U << 25)      // leaf 1, ECX
+#define X86_CPUID_SSE41_BIT (1U << 19)    // leaf 1, ECX
+#define X86_CPUID_OSXSAVE_BIT (1U << 27)  // leaf 1, ECX
+#define X86_CPUID_AVX512F_BIT (1U << 16)  // leaf 7, EBX
+#define X86_CPUID_VAES_BIT (1U << 9)      // leaf 7, ECX
+#define X86_XCR0_AVX512_STATE (0xe6U)     // SSE, AVX, opmask and ZMM registers enabled by the OS
+
+// The functions using the AES instructions are compiled for the required ISA regardless of the build flags, and are
+// only called after checking the CPU features
+#define AES_NI_TARGET __attribute__((target("aes,sse4.1")))
+#define AES_NI_VAES_TARGET __attribute__((target("aes,sse4.1,avx2,avx512f,vaes")))
+
+static aes_ni_impl_t aes_ni_detect_impl()
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if (!__get_cpuid(X86_CPUID_BASIC_LEAF, &eax, &ebx, &ecx, &edx)) {
+    return AES_NI_IMPL_NONE;
+  }
+  if ((ecx & X86_CPUID_AES_BIT) == 0 || (ecx & X86_CPUID_SSE41_BIT) == 0) {
+    return AES_NI_IMPL_NONE;
+  }
+
+#ifdef AES_NI_HAVE_VAES
+  bool osxsave = (ecx & X86_CPUID_OSXSAVE_BIT) != 0;
+  if (osxsave && __get_cpuid_max(0, nullptr) >= X86_CPUID_ADVANCED_LEAF) {
+    __cpuid_count(X86_CPUID_ADVANCED_LEAF, 0, eax, ebx, ecx, edx);
+    uint32_t xcr0_lo = 0, xcr0_hi = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((ebx & X86_CPUID_AVX512F_BIT) != 0 && (ecx & X86_CPUID_VAES_BIT) != 0 &&
+        (xcr0_lo & X86_XCR0_AVX512_STATE) == X86_XCR0_AVX512_STATE) {
+      return AES_NI_IMPL_VAES;
+    }
+  }
+#endif // AES_NI_HAVE_VAES
+
+  return AES_NI_IMPL_AESNI;
+}
+
+static inline uint64_t aes_ni_load_be64(const uint8_t* ptr)
+{
+  uint64_t v;
+  memcpy(&v, ptr, sizeof(v));
+  return __builtin_bswap64(v);
+}
+
+static inline void aes_ni_store_be64(uint8_t* ptr, uint64_t v)
+{
+  v = __builtin_bswap64(v);
+  memcpy(ptr, &v, sizeof(v));
+}
+
+/* 128-bit big endian counter, split in two host order words */
+typedef struct {
+  uint64_t hi;
+  uint64_t lo;
+} aes_ni_counter_t;
+
+static inline void aes_ni_counter_next(aes_ni_counter_t* ctr)
+{
+  if (++ctr->lo == 0) {
+    ctr->hi++;
+  }
+}
+
+AES_NI_TARGET static inline __m128i aes_ni_counter_block(aes_ni_counter_t* ctr)
+{
+  __m128i b = _mm_set_epi64x((long long)__builtin_bswap64(ctr->lo), (long long)__builtin_bswap64(ctr->hi));
+  aes_ni_counter_next(ctr);
+  return b;
+}
+
+AES_NI_TARGET static inline __m128i aes_ni_expand_step(__m128i key, __m128i assist)
+{
+  assist = _mm_shuffle_epi32(assist, 0xff);
+  key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+// The round constant of aeskeygenassist must be an immediate
+#define AES_NI_EXPAND(rk, i, rcon) rk[i] = aes_ni_expand_step(rk[i - 1], _mm_aeskeygenassist_si128(rk[i - 1], rcon))
+
+AES_NI_TARGET static void aes_ni_expand_key(const uint8_t k[16], uint8_t out[AES_NI_NOF_ROUNDS + 1][16])
+{
+  __m128i rk[AES_NI_NOF_ROUNDS + 1];
+
+  rk[0] = _mm_loadu_si128((const __m128i*)k);
+  AES_NI_EXPAND(rk, 1, 0x01);
+  AES_NI_EXPAND(rk, 2, 0x02);
+  AES_NI_EXPAND(rk, 3, 0x04);
+  AES_NI_EXPAND(rk, 4, 0x08);
+  AES_NI_EXPAND(rk, 5, 0x10);
+  AES_NI_EXPAND(rk, 6, 0x20);
+  AES_NI_EXPAND(rk, 7, 0x40);
+  AES_NI_EXPAND(rk, 8, 0x80);
+  AES_NI_EXPAND(rk, 9, 0x1b);
+  AES_NI_EXPAND(rk, 10, 0x36);
+
+  for (int i = 0; i < AES_NI_NOF_ROUNDS + 1; i++) {
+    _mm_storeu_si128((__m128i*)out[i], rk[i]);
+  }
+}
+
+AES_NI_TARGET static inline void aes_ni_load_key(const aes_ni_key_t* key, __m128i rk[AES_NI_NOF_ROUNDS + 1])
+{
+  for (int i = 0; i < AES_NI_NOF_ROUNDS + 1; i++) {
+    rk[i] = _mm_loadu_si128((const __m128i*)key->rk[i]);
+  }
+}
+
+AES_NI_TARGET static inline __m128i aes_ni_encrypt(const __m128i rk[AES_NI_NOF_ROUNDS + 1], __m128i b)
+{
+  b = _mm_xor_si128(b, rk[0]);
+  for (int r = 1; r < AES_NI_NOF_ROUNDS; r++) {
+    b = _mm_aesenc_si128(b, rk[r]);
+  }
+  return _mm_aesenclast_si128(b, rk[AES_NI_NOF_ROUNDS]);
+}
+
+/* Encrypts the counter blocks of the remaining len bytes, 8 blocks at a time so that the latency of aesenc is
+ * hidden by the independent blocks in flight */
+AES_NI_TARGET static void
+aes_ni_ctr_aesni(const aes_ni_key_t* key, aes_ni_counter_t* ctr, const uint8_t* in, uint8_t* out, uint32_t len)
+{
+  const uint32_t nof_lanes = 8;
+  __m128i        rk[AES_NI_NOF_ROUNDS + 1];
+  uint32_t       i = 0;
+
+  aes_ni_load_key(key, rk);
+
+  for (; i + nof_lanes * AES_NI_BLOCK_LEN <= len; i += nof_lanes * AES_NI_BLOCK_LEN) {
+    __m128i b[nof_lanes];
+    for (uint32_t j = 0; j < nof_lanes; j++) {
+      b[j] = _mm_xor_si128(aes_ni_counter_block(ctr), rk[0]);
+    }
+    for (int r = 1; r < AES_NI_NOF_ROUNDS; r++) {
+      for (uint32_t j = 0; j < nof_lanes; j++) {
+        b[j] = _mm_aesenc_si128(b[j], rk[r]);
+      }
+    }
+    for (uint32_t j = 0; j < nof_lanes; j++) {
+      b[j]      = _mm_aesenclast_si128(b[j], rk[AES_NI_NOF_ROUNDS]);
+      __m128i m = _mm_loadu_si128((const __m128i*)(in + i + j * AES_NI_BLOCK_LEN));
+      _mm_storeu_si128((__m128i*)(out + i + j * AES_NI_BLOCK_LEN), _mm_xor_si128(m, b[j]));
+    }
+  }
+
+  for (; i + AES_NI_BLOCK_LEN <= len; i += AES_NI_BLOCK_LEN) {
+    __m128i ks = aes_ni_encrypt(rk, aes_ni_counter_block(ctr));
+    __m128i m  = _mm_loadu_si128((const __m128i*)(in + i));
+    _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(m, ks));
+  }
+
+  if (i < len) {
+    uint8_t ks[AES_NI_BLOCK_LEN];
+    _mm_storeu_si128((__m128i*)ks, aes_ni_encrypt(rk, aes_ni_counter_block(ctr)));
+    for (uint32_t j = 0; i + j < len; j++) {
+      out[i + j] = in[i + j] ^ ks[j];
+    }
+  }
+}
+
+/* Block of a message of a counter mode batch, assigned to one lane of the pipeline */
+typedef struct {
+  const uint8_t* in;
+  uint8_t*       out;
+  uint32_t       len;
+} aes_ni_lane_t;
+
+AES_NI_TARGET static inline void aes_ni_xor_lane(const aes_ni_lane_t* lane, __m128i ks)
+{
+  if (lane->len == AES_NI_BLOCK_LEN) {
+    __m128i m = _mm_loadu_si128((const __m128i*)lane->in);
+    _mm_storeu_si128((__m128i*)lane->out, _mm_xor_si128(m, ks));
+  } else {
+    uint8_t ks_bytes[AES_NI_BLOCK_LEN];
+    _mm_storeu_si128((__m128i*)ks_bytes, ks);
+    for (uint32_t j = 0; j < lane->len; j++) {
+      lane->out[j] = lane->in[j] ^ ks_bytes[j];
+    }
+  }
+}
+
+AES_NI_TARGET static inline void aes_ni_ctr_lanes(const __m128i       rk[AES_NI_NOF_ROUNDS + 1],
+                                                  __m128i*            b,
+                                                  const aes_ni_lane_t* lanes,
+                                                  uint32_t            nof_lanes)
+{
+  for (uint32_t j = 0; j < nof_lanes; j++) {
+    b[j] = _mm_xor_si128(b[j], rk[0]);
+  }
+  for (int r = 1; r < AES_NI_NOF_ROUNDS; r++) {
+    for (uint32_t j = 0; j < nof_lanes; j++) {
+      b[j] = _mm_aesenc_si128(b[j], rk[r]);
+    }
+  }
+  for (uint32_t j = 0; j < nof_lanes; j++) {
+    aes_ni_xor_lane(&lanes[j], _mm_aesenclast_si128(b[j], rk[AES_NI_NOF_ROUNDS]));
+  }
+}
+
+AES_NI_TARGET static void aes_ni_ctr_batch_aesni(const aes_ni_key_t* key, aes_ni_ctr_msg_t* msgs, uint32_t nof_msgs)
+{
+  const uint32_t nof_lanes = 8;
+  __m128i        rk[AES_NI_NOF_ROUNDS + 1];
+  __m128i        b[nof_lanes];
+  aes_ni_lane_t  lanes[nof_lanes];
+  uint32_t       n = 0;
+
+  aes_ni_load_key(key, rk);
+
+  for (uint32_t m = 0; m < nof_msgs; m++) {
+    aes_ni_ctr_msg_t* msg = &msgs[m];
+    aes_ni_counter_t  ctr;
+    ctr.hi = aes_ni_load_be64(msg->nonce_counter);
+    ctr.lo = aes_ni_load_be64(msg->nonce_counter + 8);
+
+    for (uint32_t i = 0; i < msg->len; i += AES_NI_BLOCK_LEN) {
+      b[n]         = aes_ni_counter_block(&ctr);
+      lanes[n].in  = msg->in + i;
+      lanes[n].out = msg->out + i;
+      lanes[n].len = msg->len - i < AES_NI_BLOCK_LEN ? msg->len - i : AES_NI_BLOCK_LEN;
+      if (++n == nof_lanes) {
+        aes_ni_ctr_lanes(rk, b, lanes, nof_lanes);
+        n = 0;
+      }
+    }
+
+    aes_ni_store_be64(msg->nonce_counter, ctr.hi);
+    aes_ni_store_be64(msg->nonce_counter + 8, ctr.lo);
+  }
+
+  if (n > 0) {
+    aes_ni_ctr_lanes(rk, b, lanes, n);
+  }
+}
+
+#ifdef AES_NI_HAVE_VAES
+
+AES_NI_VAES_TARGET static inline __m512i aes_ni_counter_block_x4(aes_ni_counter_t* ctr)
+{
+  uint64_t w[8];
+  for (uint32_t k = 0; k < 4; k++) {
+    w[2 * k]     = __builtin_bswap64(ctr->hi);
+    w[2 * k + 1] = __builtin_bswap64(ctr->lo);
+    aes_ni_counter_next(ctr);
+  }
+  return _mm512_loadu_si512(w);
+}
+
+/* Same as aes_ni_ctr_aesni, with four blocks per 512-bit register and 16 blocks in flight. The tail that does not
+ * fill all the registers is left to the AES-NI implementation */
+AES_NI_VAES_TARGET static void
+aes_ni_ctr_vaes(const aes_ni_key_t* key, aes_ni_counter_t* ctr, const uint8_t* in, uint8_t* out, uint32_t len)
+{
+  const uint32_t nof_regs  = 4;
+  const uint32_t blk_bytes = nof_regs * 4 * AES_NI_BLOCK_LEN;
+  __m512i        rk[AES_NI_NOF_ROUNDS + 1];
+  uint32_t       i = 0;
+
+  if (len < blk_bytes) {
+    aes_ni_ctr_aesni(key, ctr, in, out, len);
+    return;
+  }
+
+  for (int r = 0; r < AES_NI_NOF_ROUNDS + 1; r++) {
+    uint8_t rk_x4[4 * AES_NI_BLOCK_LEN];
+    for (uint32_t k = 0; k < 4; k++) {
+      memcpy(rk_x4 + k * AES_NI_BLOCK_LEN, key->rk[r], AES_NI_BLOCK_LEN);
+    }
+    rk[r] = _mm512_loadu_si512(rk_x4);
+  }
+
+  for (; i + blk_bytes <= len; i += blk_bytes) {
+    __m512i b[nof_regs];
+    for (uint32_t j = 0; j < nof_regs; j++) {
+      b[j] = _mm512_xor_si512(aes_ni_counter_block_x4(ctr), rk[0]);
+    }
+    for (int r = 1; r < AES_NI_NOF_ROUNDS; r++) {
+      for (uint32_t j = 0; j < nof_regs; j++) {
+        b[j] = _mm512_aesenc_epi128(b[j], rk[r]);
+      }
+    }
+    for (uint32_t j = 0; j < nof_regs; j++) {
+      b[j]      = _mm512_aesenclast_epi128(b[j], rk[AES_NI_NOF_ROUNDS]);
+      __m512i m = _mm512_loadu_si512((const void*)(in + i + j * 4 * AES_NI_BLOCK_LEN));
+      _mm512_storeu_si512((void*)(out + i + j * 4 * AES_NI_BLOCK_LEN), _mm512_xor_si512(m, b[j]));
+    }
+  }
+
+  if (i < len) {
+    aes_ni_ctr_aesni(key, ctr, in + i, out + i, len - i);
+  }
+}
+
+/* Encrypts the 16 counter blocks gathered in ctr_blocks and XORs the keystream into the used lanes. Unused lanes of
+ * the last call of a batch are encrypted but not written back */
+AES_NI_VAES_TARGET static void aes_ni_ctr_lanes_vaes(const __m512i        rk[AES_NI_NOF_ROUNDS + 1],
+                                                     uint8_t*             ctr_blocks,
+                                                     const aes_ni_lane_t* lanes,
+                                                     uint32_t             nof_lanes)
+{
+  const uint32_t nof_regs = 4;
+  __m512i        b[nof_regs];
+
+  for (uint32_t j = 0; j < nof_regs; j++) {
+    b[j] = _mm512_xor_si512(_mm512_loadu_si512(ctr_blocks + j * 4 * AES_NI_BLOCK_LEN), rk[0]);
+  }
+  for (int r = 1; r < AES_NI_NOF_ROUNDS; r++) {
+    for (uint32_t j = 0; j < nof_regs; j++) {
+      b[j] = _mm512_aesenc_epi128(b[j], rk[r]);
+    }
+  }
+  for (uint32_t j = 0; j < nof_regs; j++) {
+    _mm512_storeu_si512(ctr_blocks + j * 4 * AES_NI_BLOCK_LEN, _mm512_aesenclast_epi128(b[j], rk[AES_NI_NOF_ROUNDS]));
+  }
+  for (uint32_t j = 0; j < nof_lanes; j++) {
+    aes_ni_xor_lane(&lanes[j], _mm_loadu_si128((const __m128i*)(ctr_blocks + j * AES_NI_BLOCK_LEN)));
+  }
+}
+
+/* Same as aes_ni_ctr_batch_aesni, with 16 lanes in four 512-bit registers. The counter blocks are gathered in memory
+ * and the keystream is scattered back to the lanes, since consecutive lanes may belong to different messages */
+AES_NI_VAES_TARGET static void aes_ni_ctr_batch_vaes(const aes_ni_key_t* key, aes_ni_ctr_msg_t* msgs, uint32_t nof_msgs)
+{
+  const uint32_t nof_regs  = 4;
+  const uint32_t nof_lanes = nof_regs * 4;
+  __m512i        rk[AES_NI_NOF_ROUNDS + 1];
+  uint8_t        ctr_blocks[nof_lanes * AES_NI_BLOCK_LEN] = {};
+  aes_ni_lane_t  lanes[nof_lanes];
+  uint32_t       n = 0;
+
+  for (int r = 0; r < AES_NI_NOF_ROUNDS + 1; r++) {
+    uint8_t rk_x4[4 * AES_NI_BLOCK_LEN];
+    for (uint32_t k = 0; k < 4; k++) {
+      memcpy(rk_x4 + k * AES_NI_BLOCK_LEN, key->rk[r], AES_NI_BLOCK_LEN);
+    }
+    rk[r] = _mm512_loadu_si512(rk_x4);
+  }
+
+  for (uint32_t m = 0; m < nof_msgs; m++) {
+    aes_ni_ctr_msg_t* msg = &msgs[m];
+    aes_ni_counter_t  ctr;
+    ctr.hi = aes_ni_load_be64(msg->nonce_counter);
+    ctr.lo = aes_ni_load_be64(msg->nonce_counter + 8);
+
+    for (uint32_t i = 0; i < msg->len; i += AES_NI_BLOCK_LEN) {
+      aes_ni_store_be64(ctr_blocks + n * AES_NI_BLOCK_LEN, ctr.hi);
+      aes_ni_store_be64(ctr_blocks + n * AES_NI_BLOCK_LEN + 8, ctr.lo);
+      aes_ni_counter_next(&ctr);
+      lanes[n].in  = msg->in + i;
+      lanes[n].out = msg->out + i;
+      lanes[n].len = msg->len - i < AES_NI_BLOCK_LEN ? msg->len - i : AES_NI_BLOCK_LEN;
+      if (++n == nof_lanes) {
+        aes_ni_ctr_lanes_vaes(rk, ctr_blocks, lanes, nof_lanes);
+        n = 0;
+      }
+    }
+
+    aes_ni_store_be64(msg->nonce_counter, ctr.hi);
+    aes_ni_store_be64(msg->nonce_counter + 8, ctr.lo);
+  }
+
+  if (n > 0) {
+    aes_ni_ctr_lanes_vaes(rk, ctr_blocks, lanes, n);
+  }
+}
+
+#endif // AES_NI_HAVE_VAES
+
+AES_NI_TARGET static void aes_ni_encrypt_block_aesni(const aes_ni_key_t* key, const uint8_t in[16], uint8_t out[16])
+{
+  __m128i rk[AES_NI_NOF_ROUNDS + 1];
+  aes_ni_load_key(key, rk);
+  _mm_storeu_si128((__m128i*)out, aes_ni_encrypt(rk, _mm_loadu_si128((const __m128i*)in)));
+}
+
+/* Each block depends on the previous one, so there is no parallelism to exploit beyond keeping the round keys in
+ * registers */
+AES_NI_TARGET static void
+aes_ni_cbc_mac_aesni(const aes_ni_key_t* key, uint8_t state[16], const uint8_t* in, uint32_t nof_blocks)
+{
+  __m128i rk[AES_NI_NOF_ROUNDS + 1];
+  aes_ni_load_key(key, rk);
+
+  __m128i t = _mm_loadu_si128((const __m128i*)state);
+  for (uint32_t i = 0; i < nof_blocks; i++) {
+    t = aes_ni_encrypt(rk, _mm_xor_si128(t, _mm_loadu_si128((const __m128i*)(in + i * AES_NI_BLOCK_LEN))));
+  }
+  _mm_storeu_si128((__m128i*)state, t);
+}
+
+/* Encrypts 8 blocks at a time, each with its own key. The round keys are loaded from memory at every round, which
+ * the pipeline hides behind the aesenc latency of the other lanes */
+AES_NI_TARGET static void aes_ni_encrypt_blocks_multikey_aesni(const aes_ni_key_t* const* keys,
+                                                               const uint8_t*             in,
+                                                               uint8_t*                   out,
+                                                               uint32_t                   nof_blocks)
+{
+  const uint32_t nof_lanes = 8;
+  uint32_t       i         = 0;
+
+  for (; i + nof_lanes <= nof_blocks; i += nof_lanes) {
+    __m128i b[nof_lanes];
+    for (uint32_t j = 0; j < nof_lanes; j++) {
+      __m128i m = _mm_loadu_si128((const __m128i*)(in + (i + j) * AES_NI_BLOCK_LEN));
+      b[j]      = _mm_xor_si128(m, _mm_loadu_si128((const __m128i*)keys[i + j]->rk[0]));
+    }
+    for (int r = 1; r < AES_NI_NOF_ROUNDS; r++) {
+      for (uint32_t j = 0; j < nof_lanes; j++) {
+        b[j] = _mm_aesenc_si128(b[j], _mm_loadu_si128((const __m128i*)keys[i + j]->rk[r]));
+      }
+    }
+    for (uint32_t j = 0; j < nof_lanes; j++) {
+      b[j] = _mm_aesenclast_si128(b[j], _mm_loadu_si128((const __m128i*)keys[i + j]->rk[AES_NI_NOF_ROUNDS]));
+      _mm_storeu_si128((__m128i*)(out + (i + j) * AES_NI_BLOCK_LEN), b[j]);
+    }
+  }
+
+  for (; i < nof_blocks; i++) {
+    aes_ni_encrypt_block_aesni(keys[i], in + i * AES_NI_BLOCK_LEN, out + i * AES_NI_BLOCK_LEN);
+  }
+}
+
+#endif // AES_NI_X86
+
+aes_ni_impl_t aes_ni_get_impl(void)
+{
+#ifdef AES_NI_X86
+  static const aes_ni_impl_t impl = aes_ni_detect_impl();
+  return impl;
+#else
+  return AES_NI_IMPL_NONE;
+#endif
+}
+
+int aes_ni_is_supported(aes_ni_impl_t impl)
+{
+  // Every CPU with VAES also has AES-NI
+  return impl != AES_NI_IMPL_NONE && impl <= aes_ni_get_impl();
+}
+
+const char* aes_ni_impl_to_string(aes_ni_impl_t impl)
+{
+  switch (impl) {
+    case AES_NI_IMPL_AESNI:
+      return "aesni";
+    case AES_NI_IMPL_VAES:
+      return "vaes";
+    default:
+      return "none";
+  }
+}
+
+int aes_ni_setkey_enc(aes_ni_key_t* key, const uint8_t k[16], aes_ni_impl_t impl)
+{
+  if (!aes_ni_is_supported(impl)) {
+    key->impl = AES_NI_IMPL_NONE;
+    return -1;
+  }
+#ifdef AES_NI_X86
+  aes_ni_expand_key(k, key->rk);
+#endif
+  key->impl = impl;
+  return 0;
+}
+
+void aes_ni_encrypt_block(const aes_ni_key_t* key, const uint8_t in[16], uint8_t out[16])
+{
+#ifdef AES_NI_X86
+  aes_ni_encrypt_block_aesni(key, in, out);
+#endif
+}
+
+void aes_ni_crypt_ctr(const aes_ni_key_t* key,
+                      uint8_t             nonce_counter[16],
+                      const uint8_t*      in,
+                      uint8_t*            out,
+                      uint32_t            len)
+{
+#ifdef AES_NI_X86
+  aes_ni_counter_t ctr;
+  ctr.hi = aes_ni_load_be64(nonce_counter);
+  ctr.lo = aes_ni_load_be64(nonce_counter + 8);
+
+#ifdef AES_NI_HAVE_VAES
+  if (key->impl == AES_NI_IMPL_VAES) {
+    aes_ni_ctr_vaes(key, &ctr, in, out, len);
+  } else {
+    aes_ni_ctr_aesni(key, &ctr, in, out, len);
+  }
+#else
+  aes_ni_ctr_aesni(key, &ctr, in, out, len);
+#endif // AES_NI_HAVE_VAES
+
+  aes_ni_store_be64(nonce_counter, ctr.hi);
+  aes_ni_store_be64(nonce_counter + 8, ctr.lo);
+#endif // AES_NI_X86
+}
+
+void aes_ni_crypt_ctr_batch(const aes_ni_key_t* key, aes_ni_ctr_msg_t* msgs, uint32_t nof_msgs)
+{
+#ifdef AES_NI_X86
+#ifdef AES_NI_HAVE_VAES
+  if (key->impl == AES_NI_IMPL_VAES) {
+    aes_ni_ctr_batch_vaes(key, msgs, nof_msgs);
+    return;
+  }
+#endif // AES_NI_HAVE_VAES
+  aes_ni_ctr_batch_aesni(key, msgs, nof_msgs);
+#endif // AES_NI_X86
+}
+
+void aes_ni_cbc_mac(const aes_ni_key_t* key, uint8_t state[16], const uint8_t* in, uint32_t nof_blocks)
+{
+#ifdef AES_NI_X86
+  aes_ni_cbc_mac_aesni(key, state, in, nof_blocks);
+#endif
+}
+
+void aes_ni_encrypt_blocks_multikey(const aes_ni_key_t* const* keys,
+                                    const uint8_t*             in,
+                                    uint8_t*                   out,
+                                    uint32_t                   nof_blocks)
+{
+#ifdef AES_NI_X86
+  aes_ni_encrypt_blocks_multikey_aesni(keys, in, out, nof_blocks);
+#endif
+}
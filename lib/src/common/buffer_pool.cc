@@ -20,8 +20,48 @@
  */
 
 #include "srsran/common/buffer_pool.h"
+#include <errno.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
-namespace srsran {} // namespace srsran
+namespace srsran {
+
+namespace detail {
+
+// Memory policy of mbind(2). Defined here to avoid depending on libnuma headers
+static const int BUFFER_POOL_MPOL_PREFERRED = 1;
+
+void* buffer_pool_alloc_pages(size_t sz, int numa_node)
+{
+  void* ptr = mmap(nullptr, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+  if (numa_node >= 0) {
+    // The policy is set before the pages are first touched, so that they are faulted in the requested node
+    const size_t               bits_per_word = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> nodemask(numa_node / bits_per_word + 1, 0);
+    nodemask[numa_node / bits_per_word] = 1UL << (numa_node % bits_per_word);
+    unsigned long maxnode               = nodemask.size() * bits_per_word + 1;
+    if (syscall(SYS_mbind, ptr, sz, BUFFER_POOL_MPOL_PREFERRED, nodemask.data(), maxnode, 0) < 0) {
+      srslog::fetch_basic_logger("POOL").warning(
+          "Failed to set the buffer pool memory policy to NUMA node %d (%s)", numa_node, strerror(errno));
+    }
+  }
+  return ptr;
+}
+
+void buffer_pool_free_pages(void* ptr, size_t sz)
+{
+  if (ptr != nullptr) {
+    munmap(ptr, sz);
+  }
+}
+
+} // namespace detail
+
+} // namespace srsran
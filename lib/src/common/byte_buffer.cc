@@ -24,16 +24,95 @@
 
 namespace srsran {
 
+/******************************************************************************
+ * byte_buffer_t
+ *****************************************************************************/
+
+void byte_buffer_t::init_storage(uint32_t min_payload)
+{
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+  bzero(debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
+#endif
+  byte_buffer_pool* pool = byte_buffer_pool::get_instance();
+  buffer                 = pool->get_buffer_storage(this, &storage_size);
+  if (buffer != nullptr) {
+    storage = storage_t::pool_block;
+  } else {
+    // Buffers outside the pool are sized for their initial payload. Default constructed ones keep the full transport
+    // block capacity, as callers may write through msg without reserving
+    byte_buffer_class_t size_class = min_payload > 0 ? byte_buffer_class_for(min_payload) : byte_buffer_class_t::large;
+    storage_size                   = byte_buffer_class_size(size_class);
+    buffer                         = pool->allocate_segment(size_class);
+    storage                        = storage_t::pool_segment;
+    if (buffer == nullptr) {
+      buffer  = new uint8_t[storage_size];
+      storage = storage_t::heap;
+    }
+  }
+  msg = buffer + byte_buffer_headroom(storage_size);
+  if (min_payload > storage_size - byte_buffer_headroom(storage_size)) {
+    uint32_t nof_bytes = N_bytes;
+    N_bytes            = 0;
+    grow(min_payload);
+    N_bytes = nof_bytes;
+  }
+}
+
+void byte_buffer_t::grow(uint32_t min_tailroom)
+{
+  uint32_t            payload    = N_bytes + min_tailroom;
+  byte_buffer_class_t size_class = byte_buffer_class_for(payload);
+  uint32_t            new_size   = byte_buffer_class_size(size_class);
+  uint8_t*            new_buffer = nullptr;
+  storage_t           new_type   = storage_t::heap;
+  if (payload <= byte_buffer_class_payload(size_class)) {
+    new_buffer = byte_buffer_pool::get_instance()->allocate_segment(size_class);
+    new_type   = storage_t::pool_segment;
+  }
+  if (new_buffer == nullptr) {
+    // Payloads above the large class, or depleted pool
+    new_size   = std::max(payload + SRSRAN_BUFFER_HEADER_OFFSET, byte_buffer_class_size(byte_buffer_class_t::large));
+    new_buffer = new uint8_t[new_size];
+    new_type   = storage_t::heap;
+  }
+
+  uint8_t* new_msg = new_buffer + byte_buffer_headroom(new_size);
+  memcpy(new_msg, msg, N_bytes);
+  release_storage();
+  buffer       = new_buffer;
+  storage_size = new_size;
+  storage      = new_type;
+  msg          = new_msg;
+}
+
+void byte_buffer_t::release_storage()
+{
+  if (storage == storage_t::heap) {
+    delete[] buffer;
+  } else if (storage == storage_t::pool_segment) {
+    byte_buffer_pool::get_instance()->deallocate_segment(buffer);
+  }
+  buffer = nullptr;
+}
+
 void* byte_buffer_t::operator new(size_t sz, const std::nothrow_t& nothrow_value) noexcept
 {
   assert(sz == sizeof(byte_buffer_t));
-  return byte_buffer_pool::get_instance()->allocate_node(sz);
+  return byte_buffer_pool::get_instance()->allocate_buffer(byte_buffer_class_t::large);
+}
+
+void* byte_buffer_t::operator new(size_t                sz,
+                                  byte_buffer_class_t   size_class,
+                                  const std::nothrow_t& nothrow_value) noexcept
+{
+  assert(sz == sizeof(byte_buffer_t));
+  return byte_buffer_pool::get_instance()->allocate_buffer(size_class);
 }
 
 void* byte_buffer_t::operator new(size_t sz)
 {
   assert(sz == sizeof(byte_buffer_t));
-  void* ptr = byte_buffer_pool::get_instance()->allocate_node(sz);
+  void* ptr = byte_buffer_pool::get_instance()->allocate_buffer(byte_buffer_class_t::large);
   if (ptr == nullptr) {
     throw std::bad_alloc();
   }
@@ -42,7 +121,176 @@ void* byte_buffer_t::operator new(size_t sz)
 
 void byte_buffer_t::operator delete(void* ptr)
 {
-  byte_buffer_pool::get_instance()->deallocate_node(ptr);
+  byte_buffer_pool::get_instance()->deallocate_buffer(ptr);
+}
+
+void byte_buffer_t::operator delete(void*                 ptr,
+                                    byte_buffer_class_t   size_class,
+                                    const std::nothrow_t& nothrow_value) noexcept
+{
+  byte_buffer_pool::get_instance()->deallocate_buffer(ptr);
+}
+
+/******************************************************************************
+ * byte_buffer_pool
+ *****************************************************************************/
+
+byte_buffer_pool::byte_buffer_pool() :
+  small_pool(SMALL_POOL_SIZE), medium_pool(MEDIUM_POOL_SIZE), large_pool(LARGE_POOL_SIZE)
+{}
+
+byte_buffer_pool* byte_buffer_pool::get_instance()
+{
+  static byte_buffer_pool pool;
+  return &pool;
+}
+
+template <typename Block>
+Block* byte_buffer_pool::block_of(buffer_pool<Block>& pool, void* ptr, size_t offset)
+{
+  Block* block = reinterpret_cast<Block*>(static_cast<uint8_t*>(ptr) - offset);
+  return pool.owns(block) ? block : nullptr;
+}
+
+void* byte_buffer_pool::allocate_buffer(byte_buffer_class_t size_class, const char* debug_name)
+{
+  // A depleted class borrows a block of the next larger one
+  switch (size_class) {
+    case byte_buffer_class_t::small: {
+      small_block_t* b = small_pool.allocate(debug_name);
+      if (b == nullptr) {
+        return allocate_buffer(byte_buffer_class_t::medium, debug_name);
+      }
+      b->is_byte_buffer = true;
+      return &b->header;
+    }
+    case byte_buffer_class_t::medium: {
+      medium_block_t* b = medium_pool.allocate(debug_name);
+      if (b == nullptr) {
+        return allocate_buffer(byte_buffer_class_t::large, debug_name);
+      }
+      b->is_byte_buffer = true;
+      return &b->header;
+    }
+    default: {
+      large_block_t* b = large_pool.allocate(debug_name);
+      if (b == nullptr) {
+        return nullptr;
+      }
+      b->is_byte_buffer = true;
+      return &b->header;
+    }
+  }
+}
+
+void byte_buffer_pool::deallocate_buffer(void* ptr)
+{
+  if (small_pool.deallocate(block_of(small_pool, ptr, offsetof(small_block_t, header))) or
+      medium_pool.deallocate(block_of(medium_pool, ptr, offsetof(medium_block_t, header))) or
+      large_pool.deallocate(block_of(large_pool, ptr, offsetof(large_block_t, header)))) {
+    return;
+  }
+  if (logger != nullptr) {
+    logger->error("Deallocated byte buffer 0x%lx does not belong to the pool", (long unsigned)ptr);
+  }
+}
+
+uint8_t* byte_buffer_pool::get_buffer_storage(void* ptr, uint32_t* storage_size)
+{
+  // The flag tells byte buffers apart from objects placed in raw memory nodes
+  if (small_block_t* b = block_of(small_pool, ptr, offsetof(small_block_t, header))) {
+    *storage_size = sizeof(b->data);
+    return b->is_byte_buffer ? b->data : nullptr;
+  }
+  if (medium_block_t* b = block_of(medium_pool, ptr, offsetof(medium_block_t, header))) {
+    *storage_size = sizeof(b->data);
+    return b->is_byte_buffer ? b->data : nullptr;
+  }
+  if (large_block_t* b = block_of(large_pool, ptr, offsetof(large_block_t, header))) {
+    *storage_size = sizeof(b->data);
+    return b->is_byte_buffer ? b->data : nullptr;
+  }
+  return nullptr;
+}
+
+uint8_t* byte_buffer_pool::allocate_segment(byte_buffer_class_t size_class)
+{
+  switch (size_class) {
+    case byte_buffer_class_t::small: {
+      small_block_t* b = small_pool.allocate();
+      return b != nullptr ? b->data : nullptr;
+    }
+    case byte_buffer_class_t::medium: {
+      medium_block_t* b = medium_pool.allocate();
+      return b != nullptr ? b->data : nullptr;
+    }
+    default: {
+      large_block_t* b = large_pool.allocate();
+      return b != nullptr ? b->data : nullptr;
+    }
+  }
+}
+
+void byte_buffer_pool::deallocate_segment(uint8_t* segment)
+{
+  if (not small_pool.deallocate(block_of(small_pool, segment, offsetof(small_block_t, data))) and
+      not medium_pool.deallocate(block_of(medium_pool, segment, offsetof(medium_block_t, data))) and
+      not large_pool.deallocate(block_of(large_pool, segment, offsetof(large_block_t, data))) and logger != nullptr) {
+    logger->error("Deallocated byte buffer segment 0x%lx does not belong to the pool", (long unsigned)segment);
+  }
+}
+
+void* byte_buffer_pool::allocate_node(size_t sz)
+{
+  srsran_assert(sz <= BLOCK_SIZE, "Allocated node size=%zd exceeds max object size=%zd", sz, BLOCK_SIZE);
+  large_block_t* b = large_pool.allocate();
+  if (b == nullptr) {
+    return nullptr;
+  }
+  b->is_byte_buffer = false;
+  return &b->header;
+}
+
+void byte_buffer_pool::deallocate_node(void* ptr)
+{
+  srsran_assert(ptr != nullptr, "Deallocated nodes must have valid address");
+  large_pool.deallocate(block_of(large_pool, ptr, offsetof(large_block_t, header)));
+}
+
+buffer_pool_metrics_t byte_buffer_pool::get_metrics(byte_buffer_class_t size_class) const
+{
+  switch (size_class) {
+    case byte_buffer_class_t::small:
+      return small_pool.get_metrics();
+    case byte_buffer_class_t::medium:
+      return medium_pool.get_metrics();
+    default:
+      return large_pool.get_metrics();
+  }
+}
+
+void byte_buffer_pool::enable_logger(bool enabled)
+{
+  if (enabled) {
+    logger = &srslog::fetch_basic_logger("POOL");
+    logger->set_level(srslog::basic_levels::debug);
+  } else {
+    logger = nullptr;
+  }
+}
+
+void byte_buffer_pool::print_all_buffers()
+{
+  for (uint32_t i = 0; i < (uint32_t)byte_buffer_class_t::nof_classes; ++i) {
+    byte_buffer_class_t   c       = (byte_buffer_class_t)i;
+    buffer_pool_metrics_t metrics = get_metrics(c);
+    printf("%s byte buffers (%d B): %d/%d in use, high watermark %d\n",
+           to_string(c),
+           byte_buffer_class_size(c),
+           metrics.nof_in_use,
+           metrics.capacity,
+           metrics.high_watermark);
+  }
 }
 
 } // namespace srsran
@@ -17,6 +17,7 @@
 
 #include "srsran/common/liblte_security.h"
 #include "math.h"
+#include "srsran/common/aes_ni.h"
 #include "srsran/common/s3g.h"
 #include "srsran/common/ssl.h"
 #include "srsran/common/zuc.h"
@@ -520,132 +521,99 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia1(const uint8* key,
 }
 
 /*********************************************************************
-    Name: liblte_security_128_eia2
+    Name: aes128_setkey
 
-    Description: 128-bit integrity algorithm EIA2.
+    Description: Expands an AES-128 key. The AES instructions of the
+                 CPU are used when available.
 
-    Document Reference: 33.401 v10.0.0 Annex B.2.3
-                        33.102 v10.0.0 Section 6.5.4
-                        RFC4493
+    Document Reference: N/A
 *********************************************************************/
-LIBLTE_ERROR_ENUM liblte_security_128_eia2(const uint8* key,
-                                           uint32       count,
-                                           uint8        bearer,
-                                           uint8        direction,
-                                           uint8*       msg,
-                                           uint32       msg_len,
-                                           uint8*       mac)
+static int aes128_setkey(LIBLTE_SECURITY_AES_STRUCT* aes, const uint8* key)
 {
-  LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
-  uint8             M[msg_len + 8 + 16];
-  aes_context       ctx;
-  uint32            i;
-  uint32            j;
-  uint32            n;
-  uint32            pad_bits;
-  uint8             const_zero[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  uint8             L[16];
-  uint8             K1[16];
-  uint8             K2[16];
-  uint8             T[16];
-  uint8             tmp[16];
+  if (aes_ni_setkey_enc(&aes->ni, key, aes_ni_get_impl()) == 0) {
+    return 0;
+  }
+  return aes_setkey_enc(&aes->ctx, key, 128);
+}
 
-  if (key != NULL && msg != NULL && mac != NULL) {
-    // Subkey L generation
-    aes_setkey_enc(&ctx, key, 128);
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, const_zero, L);
+/*********************************************************************
+    Name: aes128_encrypt_block
 
-    // Subkey K1 generation
-    for (i = 0; i < 15; i++) {
-      K1[i] = (L[i] << 1) | ((L[i + 1] >> 7) & 0x01);
-    }
-    K1[15] = L[15] << 1;
-    if (L[0] & 0x80) {
-      K1[15] ^= 0x87;
-    }
+    Description: Encrypts a single 16-byte block.
 
-    // Subkey K2 generation
-    for (i = 0; i < 15; i++) {
-      K2[i] = (K1[i] << 1) | ((K1[i + 1] >> 7) & 0x01);
-    }
-    K2[15] = K1[15] << 1;
-    if (K1[0] & 0x80) {
-      K2[15] ^= 0x87;
-    }
+    Document Reference: N/A
+*********************************************************************/
+static void aes128_encrypt_block(LIBLTE_SECURITY_AES_STRUCT* aes, uint8* in, uint8* out)
+{
+  if (aes->ni.impl != AES_NI_IMPL_NONE) {
+    aes_ni_encrypt_block(&aes->ni, in, out);
+  } else {
+    aes_crypt_ecb(&aes->ctx, AES_ENCRYPT, in, out);
+  }
+}
 
-    // Construct M
-    memset(M, 0, msg_len + 8 + 16);
-    M[0] = (count >> 24) & 0xFF;
-    M[1] = (count >> 16) & 0xFF;
-    M[2] = (count >> 8) & 0xFF;
-    M[3] = count & 0xFF;
-    M[4] = (bearer << 3) | (direction << 2);
-    for (i = 0; i < msg_len; i++) {
-      M[8 + i] = msg[i];
-    }
+/*********************************************************************
+    Name: aes128_cbc_mac
 
-    // MAC generation
-    n = (uint32)(ceilf((float)(msg_len + 8) / (float)(16)));
-    for (i = 0; i < 16; i++) {
-      T[i] = 0;
-    }
-    for (i = 0; i < n - 1; i++) {
-      for (j = 0; j < 16; j++) {
-        tmp[j] = T[j] ^ M[i * 16 + j];
-      }
-      aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
-    }
-    pad_bits = ((msg_len * 8) + 64) % 128;
-    if (pad_bits == 0) {
-      for (j = 0; j < 16; j++) {
-        tmp[j] = T[j] ^ K1[j] ^ M[i * 16 + j];
-      }
-      aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
-    } else {
-      pad_bits = (128 - pad_bits) - 1;
-      M[i * 16 + (15 - (pad_bits / 8))] |= 0x1 << (pad_bits % 8);
-      for (j = 0; j < 16; j++) {
-        tmp[j] = T[j] ^ K2[j] ^ M[i * 16 + j];
-      }
-      aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
-    }
+    Description: Chains nof_blocks 16-byte blocks into T, with
+                 T = E(T ^ block) for each block.
 
-    for (i = 0; i < 4; i++) {
-      mac[i] = T[i];
-    }
+    Document Reference: RFC4493 Section 2.4
+*********************************************************************/
+static void aes128_cbc_mac(LIBLTE_SECURITY_AES_STRUCT* aes, uint8* T, uint8* M, uint32 nof_blocks)
+{
+  uint8  tmp[16];
+  uint32 i;
+  uint32 j;
 
-    err = LIBLTE_SUCCESS;
+  if (aes->ni.impl != AES_NI_IMPL_NONE) {
+    aes_ni_cbc_mac(&aes->ni, T, M, nof_blocks);
+    return;
+  }
+  for (i = 0; i < nof_blocks; i++) {
+    for (j = 0; j < 16; j++) {
+      tmp[j] = T[j] ^ M[i * 16 + j];
+    }
+    aes_crypt_ecb(&aes->ctx, AES_ENCRYPT, tmp, T);
   }
-
-  return (err);
 }
-LIBLTE_ERROR_ENUM liblte_security_128_eia2(const uint8*           key,
-                                           uint32                 count,
-                                           uint8                  bearer,
-                                           uint8                  direction,
-                                           LIBLTE_BIT_MSG_STRUCT* msg,
-                                           uint8*                 mac)
+
+/*********************************************************************
+    Name: aes128_crypt_ctr
+
+    Description: AES-CTR ciphering of len bytes, starting at the
+                 beginning of the counter block nonce_cnt.
+
+    Document Reference: N/A
+*********************************************************************/
+static int aes128_crypt_ctr(LIBLTE_SECURITY_AES_STRUCT* aes, uint8* nonce_cnt, uint8* in, uint8* out, uint32 len)
 {
-  if (!key || !msg || !mac) {
-    return LIBLTE_ERROR_INVALID_INPUTS;
+  unsigned char stream_blk[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  size_t        nc_off         = 0;
+
+  if (aes->ni.impl != AES_NI_IMPL_NONE) {
+    aes_ni_crypt_ctr(&aes->ni, nonce_cnt, in, out, len);
+    return 0;
   }
+  return aes_crypt_ctr(&aes->ctx, len, &nc_off, nonce_cnt, stream_blk, in, out);
+}
+
+/*********************************************************************
+    Name: eia2_generate_subkeys
 
-  uint8       M[msg->N_bits * 8 + 8 + 16];
-  aes_context ctx;
-  uint32      i;
-  uint32      j;
-  uint32      n;
-  uint32      pad_bits;
-  uint8       const_zero[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  uint8       L[16];
-  uint8       K1[16];
-  uint8       K2[16];
-  uint8       T[16];
-  uint8       tmp[16];
+    Description: Generates the CMAC subkeys K1 and K2 of EIA2 from
+                 the expanded AES key.
+
+    Document Reference: RFC4493 Section 2.3
+*********************************************************************/
+static void eia2_generate_subkeys(LIBLTE_SECURITY_AES_STRUCT* aes, uint8* K1, uint8* K2)
+{
+  uint8  const_zero[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  uint8  L[16];
+  uint32 i;
 
   // Subkey L generation
-  aes_setkey_enc(&ctx, key, 128);
-  aes_crypt_ecb(&ctx, AES_ENCRYPT, const_zero, L);
+  aes128_encrypt_block(aes, const_zero, L);
 
   // Subkey K1 generation
   for (i = 0; i < 15; i++) {
@@ -664,56 +632,138 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia2(const uint8*           key,
   if (K1[0] & 0x80) {
     K2[15] ^= 0x87;
   }
+}
+
+/*********************************************************************
+    Name: eia2_generate_mac
+
+    Description: Computes the EIA2 MAC of a message of msg_len_bits
+                 bits, packed MSB first, with an expanded AES key and
+                 its CMAC subkeys.
+
+    Document Reference: 33.401 v10.0.0 Annex B.2.3
+                        RFC4493 Section 2.4
+*********************************************************************/
+static void eia2_generate_mac(LIBLTE_SECURITY_AES_STRUCT* aes,
+                              const uint8*                K1,
+                              const uint8*                K2,
+                              uint32                      count,
+                              uint8                       bearer,
+                              uint8                       direction,
+                              uint8*                      msg,
+                              uint32                      msg_len_bits,
+                              uint8*                      mac)
+{
+  uint32       msg_len = (msg_len_bits + 7) / 8;
+  uint8        M[msg_len + 8 + 16];
+  uint32       i;
+  uint32       j;
+  uint32       n;
+  uint32       pad_bits;
+  const uint8* K;
+  uint8        T[16];
 
   // Construct M
-  memset(M, 0, msg->N_bits * 8 + 8 + 16);
+  memset(M, 0, msg_len + 8 + 16);
   M[0] = (count >> 24) & 0xFF;
   M[1] = (count >> 16) & 0xFF;
   M[2] = (count >> 8) & 0xFF;
   M[3] = count & 0xFF;
   M[4] = (bearer << 3) | (direction << 2);
-  for (i = 0; i < msg->N_bits / 8; i++) {
-    M[8 + i] = 0;
-    for (j = 0; j < 8; j++) {
-      M[8 + i] |= msg->msg[i * 8 + j] << (7 - j);
-    }
+  for (i = 0; i < msg_len; i++) {
+    M[8 + i] = msg[i];
   }
-  if ((msg->N_bits % 8) != 0) {
-    M[8 + i] = 0;
-    for (j = 0; j < msg->N_bits % 8; j++) {
-      M[8 + i] |= msg->msg[i * 8 + j] << (7 - j);
-    }
+  if ((msg_len_bits % 8) != 0) {
+    M[8 + msg_len - 1] &= 0xFF << (8 - (msg_len_bits % 8));
   }
 
-  // MAC generation
-  n = (uint32)(ceilf((float)(msg->N_bits + 64) / (float)(128)));
-  for (i = 0; i < 16; i++) {
-    T[i] = 0;
-  }
-  for (i = 0; i < n - 1; i++) {
-    for (j = 0; j < 16; j++) {
-      tmp[j] = T[j] ^ M[i * 16 + j];
-    }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
-  }
-  pad_bits = (msg->N_bits + 64) % 128;
+  // Padding and subkey of the last block
+  n        = (msg_len_bits + 64 + 127) / 128;
+  i        = n - 1;
+  pad_bits = (msg_len_bits + 64) % 128;
   if (pad_bits == 0) {
-    for (j = 0; j < 16; j++) {
-      tmp[j] = T[j] ^ K1[j] ^ M[i * 16 + j];
-    }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
+    K = K1;
   } else {
     pad_bits = (128 - pad_bits) - 1;
     M[i * 16 + (15 - (pad_bits / 8))] |= 0x1 << (pad_bits % 8);
-    for (j = 0; j < 16; j++) {
-      tmp[j] = T[j] ^ K2[j] ^ M[i * 16 + j];
-    }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
+    K = K2;
+  }
+  for (j = 0; j < 16; j++) {
+    M[i * 16 + j] ^= K[j];
   }
 
+  // MAC generation
+  memset(T, 0, sizeof(T));
+  aes128_cbc_mac(aes, T, M, n);
+
   for (i = 0; i < 4; i++) {
     mac[i] = T[i];
   }
+}
+
+/*********************************************************************
+    Name: liblte_security_128_eia2
+
+    Description: 128-bit integrity algorithm EIA2.
+
+    Document Reference: 33.401 v10.0.0 Annex B.2.3
+                        33.102 v10.0.0 Section 6.5.4
+                        RFC4493
+*********************************************************************/
+LIBLTE_ERROR_ENUM liblte_security_128_eia2(const uint8* key,
+                                           uint32       count,
+                                           uint8        bearer,
+                                           uint8        direction,
+                                           uint8*       msg,
+                                           uint32       msg_len,
+                                           uint8*       mac)
+{
+  LIBLTE_ERROR_ENUM          err = LIBLTE_ERROR_INVALID_INPUTS;
+  LIBLTE_SECURITY_AES_STRUCT aes;
+  uint8                      K1[16];
+  uint8                      K2[16];
+
+  if (key != NULL && msg != NULL && mac != NULL) {
+    aes128_setkey(&aes, key);
+    eia2_generate_subkeys(&aes, K1, K2);
+    eia2_generate_mac(&aes, K1, K2, count, bearer, direction, msg, msg_len * 8, mac);
+    err = LIBLTE_SUCCESS;
+  }
+
+  return (err);
+}
+LIBLTE_ERROR_ENUM liblte_security_128_eia2(const uint8*           key,
+                                           uint32                 count,
+                                           uint8                  bearer,
+                                           uint8                  direction,
+                                           LIBLTE_BIT_MSG_STRUCT* msg,
+                                           uint8*                 mac)
+{
+  if (!key || !msg || !mac) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+
+  LIBLTE_SECURITY_AES_STRUCT aes;
+  uint8                      msg_bytes[(msg->N_bits + 7) / 8 + 1];
+  uint32                     i;
+  uint32                     j;
+  uint8                      K1[16];
+  uint8                      K2[16];
+
+  // Pack the message MSB first
+  memset(msg_bytes, 0, sizeof(msg_bytes));
+  for (i = 0; i < msg->N_bits / 8; i++) {
+    for (j = 0; j < 8; j++) {
+      msg_bytes[i] |= msg->msg[i * 8 + j] << (7 - j);
+    }
+  }
+  for (j = 0; j < msg->N_bits % 8; j++) {
+    msg_bytes[i] |= msg->msg[i * 8 + j] << (7 - j);
+  }
+
+  aes128_setkey(&aes, key);
+  eia2_generate_subkeys(&aes, K1, K2);
+  eia2_generate_mac(&aes, K1, K2, count, bearer, direction, msg_bytes, msg->N_bits, mac);
 
   return LIBLTE_SUCCESS;
 }
@@ -805,6 +855,77 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia3(const uint8* key,
   return (err);
 }
 
+/*********************************************************************
+    Name: eea1_transform_key
+
+    Description: Loads the 128-bit key into the four SNOW 3G key words.
+
+    Document Reference: 33.401 v13.1.0 Annex B.1.2
+*********************************************************************/
+static void eea1_transform_key(const uint8* key, uint32* k)
+{
+  for (int32 i = 3; i >= 0; i--) {
+    k[i] = (key[4 * (3 - i) + 0] << 24) | (key[4 * (3 - i) + 1] << 16) | (key[4 * (3 - i) + 2] << 8) |
+           (key[4 * (3 - i) + 3]);
+  }
+}
+
+/*********************************************************************
+    Name: eea1_crypt
+
+    Description: EEA1 keystream generation and ciphering with the
+                 SNOW 3G key words.
+
+    Document Reference: 33.401 v13.1.0 Annex B.1.2
+*********************************************************************/
+static void
+eea1_crypt(const uint32* k, uint32 count, uint8 bearer, uint8 direction, uint8* msg, uint32 msg_len, uint8* out)
+{
+  S3G_STATE state, *state_ptr;
+  uint32    iv[] = {0, 0, 0, 0};
+  uint32*   ks;
+  int32     i;
+  uint32    msg_len_block_8, msg_len_block_32;
+
+  state_ptr        = &state;
+  msg_len_block_8  = (msg_len + 7) / 8;
+  msg_len_block_32 = (msg_len + 31) / 32;
+
+  // Construct iv
+  iv[3] = count;
+  iv[2] = ((bearer & 0x1F) << 27) | ((direction & 0x01) << 26);
+  iv[1] = iv[3];
+  iv[0] = iv[2];
+
+  // Initialize keystream
+  s3g_initialize(state_ptr, k, iv);
+
+  // Generate keystream
+
+  ks = (uint32*)calloc(msg_len_block_32, sizeof(uint32));
+  s3g_generate_keystream(state_ptr, msg_len_block_32, ks);
+
+  // Generate output except last block
+  for (i = 0; i < (int32_t)msg_len_block_32 - 1; i++) {
+    out[4 * i + 0] = msg[4 * i + 0] ^ ((ks[i] >> 24) & 0xFF);
+    out[4 * i + 1] = msg[4 * i + 1] ^ ((ks[i] >> 16) & 0xFF);
+    out[4 * i + 2] = msg[4 * i + 2] ^ ((ks[i] >> 8) & 0xFF);
+    out[4 * i + 3] = msg[4 * i + 3] ^ ((ks[i] & 0xFF));
+  }
+
+  // Process last bytes
+  for (i = (msg_len_block_32 - 1) * 4; i < (int32_t)msg_len_block_8; i++) {
+    out[i] = msg[i] ^ ((ks[i / 4] >> ((3 - (i % 4)) * 8)) & 0xFF);
+  }
+
+  // Zero tailing bits
+  zero_tailing_bits(out, msg_len);
+
+  // Clean up
+  free(ks);
+  s3g_deinitialize(state_ptr);
+}
+
 /*********************************************************************
     Name: liblte_security_encryption_eea1
 
@@ -824,58 +945,11 @@ LIBLTE_ERROR_ENUM liblte_security_encryption_eea1(uint8* key,
                                                   uint8* out)
 {
   LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
-  S3G_STATE         state, *state_ptr;
-  uint32            k[]  = {0, 0, 0, 0};
-  uint32            iv[] = {0, 0, 0, 0};
-  uint32*           ks;
-  int32             i;
-  uint32            msg_len_block_8, msg_len_block_32, m;
+  uint32            k[] = {0, 0, 0, 0};
 
   if (key != NULL && msg != NULL && out != NULL) {
-    state_ptr        = &state;
-    msg_len_block_8  = (msg_len + 7) / 8;
-    msg_len_block_32 = (msg_len + 31) / 32;
-
-    // Transform key
-    for (i = 3; i >= 0; i--) {
-      k[i] = (key[4 * (3 - i) + 0] << 24) | (key[4 * (3 - i) + 1] << 16) | (key[4 * (3 - i) + 2] << 8) |
-             (key[4 * (3 - i) + 3]);
-    }
-
-    // Construct iv
-    iv[3] = count;
-    iv[2] = ((bearer & 0x1F) << 27) | ((direction & 0x01) << 26);
-    iv[1] = iv[3];
-    iv[0] = iv[2];
-
-    // Initialize keystream
-    s3g_initialize(state_ptr, k, iv);
-
-    // Generate keystream
-
-    ks = (uint32*)calloc(msg_len_block_32, sizeof(uint32));
-    s3g_generate_keystream(state_ptr, msg_len_block_32, ks);
-
-    // Generate output except last block
-    for (i = 0; i < (int32_t)msg_len_block_32 - 1; i++) {
-      out[4 * i + 0] = msg[4 * i + 0] ^ ((ks[i] >> 24) & 0xFF);
-      out[4 * i + 1] = msg[4 * i + 1] ^ ((ks[i] >> 16) & 0xFF);
-      out[4 * i + 2] = msg[4 * i + 2] ^ ((ks[i] >> 8) & 0xFF);
-      out[4 * i + 3] = msg[4 * i + 3] ^ ((ks[i] & 0xFF));
-    }
-
-    // Process last bytes
-    for (i = (msg_len_block_32 - 1) * 4; i < (int32_t)msg_len_block_8; i++) {
-      out[i] = msg[i] ^ ((ks[i / 4] >> ((3 - (i % 4)) * 8)) & 0xFF);
-    }
-
-    // Zero tailing bits
-    zero_tailing_bits(out, msg_len);
-
-    // Clean up
-    free(ks);
-    s3g_deinitialize(state_ptr);
-
+    eea1_transform_key(key, k);
+    eea1_crypt(k, count, bearer, direction, msg, msg_len, out);
     err = LIBLTE_SUCCESS;
   }
 
@@ -903,6 +977,54 @@ LIBLTE_ERROR_ENUM liblte_security_decryption_eea1(uint8* key,
   return liblte_security_encryption_eea1(key, count, bearer, direction, ct, ct_len, out);
 }
 
+/*********************************************************************
+    Name: eea2_generate_nonce
+
+    Description: Initial counter block of EEA2.
+
+    Document Reference: 33.401 v13.1.0 Annex B.1.3
+*********************************************************************/
+static void eea2_generate_nonce(uint32 count, uint8 bearer, uint8 direction, uint8* nonce_cnt)
+{
+  memset(nonce_cnt, 0, 16);
+  nonce_cnt[0] = (count >> 24) & 0xFF;
+  nonce_cnt[1] = (count >> 16) & 0xFF;
+  nonce_cnt[2] = (count >> 8) & 0xFF;
+  nonce_cnt[3] = (count)&0xFF;
+  nonce_cnt[4] = ((bearer & 0x1F) << 3) | ((direction & 0x01) << 2);
+}
+
+/*********************************************************************
+    Name: eea2_crypt
+
+    Description: EEA2 ciphering (AES-CTR) with an expanded AES key.
+
+    Document Reference: 33.401 v13.1.0 Annex B.1.3
+*********************************************************************/
+static int eea2_crypt(LIBLTE_SECURITY_AES_STRUCT* aes,
+                      uint32                      count,
+                      uint8                       bearer,
+                      uint8                       direction,
+                      uint8*                      msg,
+                      uint32                      msg_len,
+                      uint8*                      out)
+{
+  unsigned char nonce_cnt[16];
+  int           ret;
+
+  // Construct nonce
+  eea2_generate_nonce(count, bearer, direction, nonce_cnt);
+
+  // Encryption
+  ret = aes128_crypt_ctr(aes, nonce_cnt, msg, out, (msg_len + 7) / 8);
+
+  if (ret == 0) {
+    // Zero tailing bits
+    zero_tailing_bits(out, msg_len);
+  }
+  return ret;
+}
+
 /*********************************************************************
     Name: liblte_security_encryption_eea2
 
@@ -918,32 +1040,11 @@ LIBLTE_ERROR_ENUM liblte_security_encryption_eea2(uint8* key,
                                                   uint32 msg_len,
                                                   uint8* out)
 {
-  LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
-  aes_context       ctx;
-  unsigned char     stream_blk[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  unsigned char     nonce_cnt[16]  = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  int32             i;
-  int               ret;
-  size_t            nc_off = 0;
+  LIBLTE_ERROR_ENUM          err = LIBLTE_ERROR_INVALID_INPUTS;
+  LIBLTE_SECURITY_AES_STRUCT aes;
 
   if (key != NULL && msg != NULL && out != NULL) {
-    ret = aes_setkey_enc(&ctx, key, 128);
-
-    if (ret == 0) {
-      // Construct nonce
-      nonce_cnt[0] = (count >> 24) & 0xFF;
-      nonce_cnt[1] = (count >> 16) & 0xFF;
-      nonce_cnt[2] = (count >> 8) & 0xFF;
-      nonce_cnt[3] = (count)&0xFF;
-      nonce_cnt[4] = ((bearer & 0x1F) << 3) | ((direction & 0x01) << 2);
-
-      // Encryption
-      ret = aes_crypt_ctr(&ctx, (msg_len + 7) / 8, &nc_off, nonce_cnt, stream_blk, msg, out);
-    }
-
-    if (ret == 0) {
-      // Zero tailing bits
-      zero_tailing_bits(out, msg_len);
+    if (aes128_setkey(&aes, key) == 0 && eea2_crypt(&aes, count, bearer, direction, msg, msg_len, out) == 0) {
       err = LIBLTE_SUCCESS;
     }
   }
@@ -1062,6 +1163,168 @@ LIBLTE_ERROR_ENUM liblte_security_decryption_eea3(uint8* key,
   return liblte_security_encryption_eea3(key, count, bearer, direction, msg, msg_len, out);
 }
 
+/*********************************************************************
+    Name: liblte_security_init_key_ctx
+
+    Description: Precomputes the key-dependent state of the 128-bit
+                 ciphering and integrity algorithms.
+
+    Document Reference: 33.401 v13.1.0 Annex B
+*********************************************************************/
+LIBLTE_ERROR_ENUM liblte_security_init_key_ctx(const uint8* key, LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx)
+{
+  if (key == NULL || ctx == NULL) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+
+  memcpy(ctx->key, key, 16);
+  if (aes128_setkey(&ctx->aes, key) != 0) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  eia2_generate_subkeys(&ctx->aes, ctx->eia2_k1, ctx->eia2_k2);
+  eea1_transform_key(key, ctx->s3g_key);
+
+  return LIBLTE_SUCCESS;
+}
+
+LIBLTE_ERROR_ENUM liblte_security_128_eia1_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                               uint32                          count,
+                                               uint8                           bearer,
+                                               uint8                           direction,
+                                               uint8*                          msg,
+                                               uint32                          msg_len,
+                                               uint8*                          mac)
+{
+  if (ctx == NULL || msg == NULL || mac == NULL) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  // The SNOW 3G key words are the same for EEA1 and EIA1
+  s3g_f9_k(ctx->s3g_key, count, bearer << 27, direction, msg, msg_len * 8, mac);
+  return LIBLTE_SUCCESS;
+}
+
+LIBLTE_ERROR_ENUM liblte_security_128_eia2_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                               uint32                          count,
+                                               uint8                           bearer,
+                                               uint8                           direction,
+                                               uint8*                          msg,
+                                               uint32                          msg_len,
+                                               uint8*                          mac)
+{
+  if (ctx == NULL || msg == NULL || mac == NULL) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  eia2_generate_mac(&ctx->aes, ctx->eia2_k1, ctx->eia2_k2, count, bearer, direction, msg, msg_len * 8, mac);
+  return LIBLTE_SUCCESS;
+}
+
+LIBLTE_ERROR_ENUM liblte_security_128_eia3_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                               uint32                          count,
+                                               uint8                           bearer,
+                                               uint8                           direction,
+                                               uint8*                          msg,
+                                               uint32                          msg_len,
+                                               uint8*                          mac)
+{
+  if (ctx == NULL) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  // The ZUC initialisation mixes the key with the COUNT-dependent IV, so it has to run for every message
+  return liblte_security_128_eia3(ctx->key, count, bearer, direction, msg, msg_len, mac);
+}
+
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea1_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                                      uint32                          count,
+                                                      uint8                           bearer,
+                                                      uint8                           direction,
+                                                      uint8*                          msg,
+                                                      uint32                          msg_len,
+                                                      uint8*                          out)
+{
+  if (ctx == NULL || msg == NULL || out == NULL) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  eea1_crypt(ctx->s3g_key, count, bearer, direction, msg, msg_len, out);
+  return LIBLTE_SUCCESS;
+}
+
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea2_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                                      uint32                          count,
+                                                      uint8                           bearer,
+                                                      uint8                           direction,
+                                                      uint8*                          msg,
+                                                      uint32                          msg_len,
+                                                      uint8*                          out)
+{
+  if (ctx == NULL || msg == NULL || out == NULL) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  if (eea2_crypt(&ctx->aes, count, bearer, direction, msg, msg_len, out) != 0) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  return LIBLTE_SUCCESS;
+}
+
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea3_ctx(LIBLTE_SECURITY_KEY_CTX_STRUCT* ctx,
+                                                      uint32                          count,
+                                                      uint8                           bearer,
+                                                      uint8                           direction,
+                                                      uint8*                          msg,
+                                                      uint32                          msg_len,
+                                                      uint8*                          out)
+{
+  if (ctx == NULL) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  return liblte_security_encryption_eea3(ctx->key, count, bearer, direction, msg, msg_len, out);
+}
+
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea2_ctx_batch(LIBLTE_SECURITY_KEY_CTX_STRUCT*    ctx,
+                                                            uint8                              bearer,
+                                                            uint8                              direction,
+                                                            LIBLTE_SECURITY_CIPHER_MSG_STRUCT* msgs,
+                                                            uint32                             nof_msgs)
+{
+  const uint32     max_chunk = 32;
+  aes_ni_ctr_msg_t ni_msgs[max_chunk];
+  uint32           i;
+  uint32           j;
+
+  if (ctx == NULL || (msgs == NULL && nof_msgs > 0)) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  for (i = 0; i < nof_msgs; i++) {
+    if (msgs[i].msg == NULL || msgs[i].out == NULL) {
+      return LIBLTE_ERROR_INVALID_INPUTS;
+    }
+  }
+
+  if (ctx->aes.ni.impl == AES_NI_IMPL_NONE) {
+    for (i = 0; i < nof_msgs; i++) {
+      if (eea2_crypt(&ctx->aes, msgs[i].count, bearer, direction, msgs[i].msg, msgs[i].msg_len, msgs[i].out) != 0) {
+        return LIBLTE_ERROR_INVALID_INPUTS;
+      }
+    }
+    return LIBLTE_SUCCESS;
+  }
+
+  for (i = 0; i < nof_msgs; i += max_chunk) {
+    uint32 nof_chunk = (nof_msgs - i < max_chunk) ? nof_msgs - i : max_chunk;
+    for (j = 0; j < nof_chunk; j++) {
+      eea2_generate_nonce(msgs[i + j].count, bearer, direction, ni_msgs[j].nonce_counter);
+      ni_msgs[j].in  = msgs[i + j].msg;
+      ni_msgs[j].out = msgs[i + j].out;
+      ni_msgs[j].len = (msgs[i + j].msg_len + 7) / 8;
+    }
+    aes_ni_crypt_ctr_batch(&ctx->aes.ni, ni_msgs, nof_chunk);
+    for (j = 0; j < nof_chunk; j++) {
+      zero_tailing_bits(msgs[i + j].out, msgs[i + j].msg_len);
+    }
+  }
+
+  return LIBLTE_SUCCESS;
+}
+
 /*********************************************************************
     Name: liblte_security_milenage_f1
 
@@ -1318,6 +1581,229 @@ LIBLTE_ERROR_ENUM liblte_security_milenage_f5_star(uint8* k, uint8* op_c, uint8*
   return (err);
 }
 
+/*********************************************************************
+    Name: liblte_security_milenage_init_key
+
+    Description: Expands the subscriber key K for
+                 liblte_security_milenage_batch.
+
+    Document Reference: 35.206 v10.0.0 Annex 3
+*********************************************************************/
+LIBLTE_ERROR_ENUM liblte_security_milenage_init_key(const uint8* k, LIBLTE_SECURITY_AES_STRUCT* aes)
+{
+  if (k == NULL || aes == NULL || aes128_setkey(aes, k) != 0) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  return LIBLTE_SUCCESS;
+}
+
+/*********************************************************************
+    Name: milenage_encrypt_blocks
+
+    Description: Encrypts nof_blocks 16-byte blocks, block i with
+                 keys[i]. The blocks are pipelined with AES-NI when
+                 all the keys have been expanded for it.
+
+    Document Reference: N/A
+*********************************************************************/
+#define MILENAGE_BATCH_LEN 16 // vectors encrypted together
+#define MILENAGE_MAX_BLOCKS 5 // OUT1 to OUT5
+
+static void milenage_encrypt_blocks(LIBLTE_SECURITY_AES_STRUCT** keys, uint8* in, uint8* out, uint32 nof_blocks)
+{
+  const aes_ni_key_t* ni_keys[MILENAGE_BATCH_LEN * MILENAGE_MAX_BLOCKS];
+  uint32              i;
+
+  for (i = 0; i < nof_blocks && keys[i]->ni.impl != AES_NI_IMPL_NONE; i++) {
+    ni_keys[i] = &keys[i]->ni;
+  }
+  if (i == nof_blocks) {
+    aes_ni_encrypt_blocks_multikey(ni_keys, in, out, nof_blocks);
+    return;
+  }
+  for (i = 0; i < nof_blocks; i++) {
+    aes128_encrypt_block(keys[i], &in[i * 16], &out[i * 16]);
+  }
+}
+
+/*********************************************************************
+    Name: milenage_xor_block
+
+    Description: out = a ^ b for 16-byte blocks, one word at a time.
+                 out may alias a or b.
+
+    Document Reference: N/A
+*********************************************************************/
+static inline void milenage_xor_block(const uint8* a, const uint8* b, uint8* out)
+{
+  uint64 a_w[2];
+  uint64 b_w[2];
+  memcpy(a_w, a, 16);
+  memcpy(b_w, b, 16);
+  a_w[0] ^= b_w[0];
+  a_w[1] ^= b_w[1];
+  memcpy(out, a_w, 16);
+}
+
+/*********************************************************************
+    Name: milenage_rot_block
+
+    Description: Cyclic rotation of a 16-byte block by r bytes
+                 towards the most significant byte, i.e.
+                 out[(i + r) % 16] = in[i]. All the Milenage
+                 rotations are multiples of 32 bits.
+
+    Document Reference: 35.206 v10.0.0 Annex 3
+*********************************************************************/
+static inline void milenage_rot_block(const uint8* in, uint32 r, uint8* out)
+{
+  uint32 w[4];
+  uint32 i;
+  memcpy(w, in, 16);
+  for (i = 0; i < 4; i++) {
+    memcpy(&out[(i * 4 + r) % 16], &w[i], 4);
+  }
+}
+
+/*********************************************************************
+    Name: milenage_out_needed
+
+    Description: Whether OUT1 to OUT5 (out_idx 0 to 4) of a vector
+                 has to be computed for the requested outputs.
+
+    Document Reference: N/A
+*********************************************************************/
+static bool milenage_out_needed(const LIBLTE_SECURITY_MILENAGE_STRUCT* vec, uint32 out_idx)
+{
+  switch (out_idx) {
+    case 0:
+      return vec->mac_a != NULL || vec->mac_s != NULL;
+    case 1:
+      return vec->res != NULL || vec->ak != NULL;
+    case 2:
+      return vec->ck != NULL;
+    case 3:
+      return vec->ik != NULL;
+    default:
+      return vec->ak_star != NULL;
+  }
+}
+
+/*********************************************************************
+    Name: liblte_security_milenage_batch
+
+    Description: Milenage security functions F1, F1*, F2, F3, F4,
+                 F5 and F5* for several subscribers at once.
+
+    Document Reference: 35.206 v10.0.0 Annex 3
+*********************************************************************/
+LIBLTE_ERROR_ENUM liblte_security_milenage_batch(LIBLTE_SECURITY_MILENAGE_STRUCT* vecs, uint32 nof_vecs)
+{
+  // Rotation in bytes and constant of OUT1 to OUT5
+  static const uint32         r[MILENAGE_MAX_BLOCKS] = {8, 0, 12, 8, 4};
+  static const uint8          c[MILENAGE_MAX_BLOCKS] = {0, 1, 2, 4, 8};
+  LIBLTE_SECURITY_AES_STRUCT* keys[MILENAGE_BATCH_LEN * MILENAGE_MAX_BLOCKS];
+  uint8                       temp[MILENAGE_BATCH_LEN][16];
+  uint8                       input[MILENAGE_BATCH_LEN * MILENAGE_MAX_BLOCKS][16];
+  uint8                       out[MILENAGE_BATCH_LEN * MILENAGE_MAX_BLOCKS][16];
+  uint8                       out_idx[MILENAGE_BATCH_LEN * MILENAGE_MAX_BLOCKS];
+  uint32                      j;
+  uint32                      v;
+  uint32                      n;
+
+  if (vecs == NULL && nof_vecs > 0) {
+    return LIBLTE_ERROR_INVALID_INPUTS;
+  }
+  for (v = 0; v < nof_vecs; v++) {
+    LIBLTE_SECURITY_MILENAGE_STRUCT* vec = &vecs[v];
+    if (vec->k == NULL || vec->op_c == NULL || vec->rand == NULL ||
+        ((vec->mac_a != NULL || vec->mac_s != NULL) && (vec->sqn == NULL || vec->amf == NULL))) {
+      return LIBLTE_ERROR_INVALID_INPUTS;
+    }
+  }
+
+  for (uint32 first = 0; first < nof_vecs; first += MILENAGE_BATCH_LEN) {
+    LIBLTE_SECURITY_MILENAGE_STRUCT* chunk     = &vecs[first];
+    uint32                           chunk_len = nof_vecs - first;
+    if (chunk_len > MILENAGE_BATCH_LEN) {
+      chunk_len = MILENAGE_BATCH_LEN;
+    }
+
+    // Compute temp
+    for (v = 0; v < chunk_len; v++) {
+      milenage_xor_block(chunk[v].rand, chunk[v].op_c, input[v]);
+      keys[v] = chunk[v].k;
+    }
+    milenage_encrypt_blocks(keys, input[0], temp[0], chunk_len);
+
+    // Build the inputs of the requested outputs of every vector
+    n = 0;
+    for (v = 0; v < chunk_len; v++) {
+      LIBLTE_SECURITY_MILENAGE_STRUCT* vec = &chunk[v];
+      uint8                            temp_op_c[16];
+      milenage_xor_block(temp[v], vec->op_c, temp_op_c);
+      for (j = 0; j < MILENAGE_MAX_BLOCKS; j++) {
+        if (!milenage_out_needed(vec, j)) {
+          continue;
+        }
+        if (j == 0) {
+          // OUT1 = E[TEMP ^ rot(IN1 ^ OPc, r1) ^ c1] ^ OPc, with IN1 = SQN || AMF || SQN || AMF
+          uint8 in1[16];
+          memcpy(&in1[0], vec->sqn, 6);
+          memcpy(&in1[6], vec->amf, 2);
+          memcpy(&in1[8], &in1[0], 8);
+          milenage_xor_block(in1, vec->op_c, in1);
+          milenage_rot_block(in1, r[j], input[n]);
+          milenage_xor_block(input[n], temp[v], input[n]);
+        } else {
+          // OUTj = E[rot(TEMP ^ OPc, rj) ^ cj] ^ OPc
+          milenage_rot_block(temp_op_c, r[j], input[n]);
+          input[n][15] ^= c[j];
+        }
+        keys[n]    = vec->k;
+        out_idx[n] = (uint8)(v * MILENAGE_MAX_BLOCKS + j);
+        n++;
+      }
+    }
+    milenage_encrypt_blocks(keys, input[0], out[0], n);
+
+    // Return the outputs
+    for (j = 0; j < n; j++) {
+      LIBLTE_SECURITY_MILENAGE_STRUCT* vec = &chunk[out_idx[j] / MILENAGE_MAX_BLOCKS];
+      milenage_xor_block(out[j], vec->op_c, out[j]);
+      switch (out_idx[j] % MILENAGE_MAX_BLOCKS) {
+        case 0:
+          if (vec->mac_a != NULL) {
+            memcpy(vec->mac_a, &out[j][0], 8);
+          }
+          if (vec->mac_s != NULL) {
+            memcpy(vec->mac_s, &out[j][8], 8);
+          }
+          break;
+        case 1:
+          if (vec->res != NULL) {
+            memcpy(vec->res, &out[j][8], 8);
+          }
+          if (vec->ak != NULL) {
+            memcpy(vec->ak, &out[j][0], 6);
+          }
+          break;
+        case 2:
+          memcpy(vec->ck, out[j], 16);
+          break;
+        case 3:
+          memcpy(vec->ik, out[j], 16);
+          break;
+        default:
+          memcpy(vec->ak_star, out[j], 6);
+          break;
+      }
+    }
+  }
+
+  return LIBLTE_SUCCESS;
+}
+
 /*********************************************************************
     Name: liblte_compute_opc
 
@@ -550,6 +550,38 @@ void socket_manager::run_thread()
  *                 Rx Multisocket Task Types
  **************************************************************/
 
+/// Datagrams are read into a medium class buffer, which fits a full MTU. Anything longer spills into the scratch
+/// area and is appended to the buffer, which then grows, so that no datagram is truncated
+static const uint32_t expected_datagram_size = byte_buffer_class_payload(byte_buffer_class_t::medium);
+static const uint32_t max_datagram_size      = 65536;
+
+static ssize_t recv_datagram(int fd, byte_buffer_t& pdu, int flags, sockaddr_in* from, std::vector<uint8_t>& scratch)
+{
+  iovec iov[2];
+  iov[0].iov_base = pdu.msg;
+  iov[0].iov_len  = pdu.get_tailroom();
+  iov[1].iov_base = scratch.data();
+  iov[1].iov_len  = scratch.size();
+
+  msghdr hdr      = {};
+  hdr.msg_name    = from;
+  hdr.msg_namelen = sizeof(*from);
+  hdr.msg_iov     = iov;
+  hdr.msg_iovlen  = 2;
+
+  ssize_t n_recv = recvmsg(fd, &hdr, flags);
+  if (n_recv <= 0) {
+    return n_recv;
+  }
+  if ((size_t)n_recv <= iov[0].iov_len) {
+    pdu.N_bytes = static_cast<uint32_t>(n_recv);
+  } else {
+    pdu.N_bytes = static_cast<uint32_t>(iov[0].iov_len);
+    pdu.append_bytes(scratch.data(), static_cast<uint32_t>(n_recv - iov[0].iov_len));
+  }
+  return n_recv;
+}
+
 class sctp_recvmsg_pdu_task
 {
 public:
@@ -613,20 +645,19 @@ class recvfrom_pdu_task
 public:
   using callback_t = recvfrom_callback_t;
   explicit recvfrom_pdu_task(srslog::basic_logger& logger, srsran::task_queue_handle& queue_, callback_t func_) :
-    logger(logger), queue(queue_), func(std::move(func_))
+    logger(logger), queue(queue_), func(std::move(func_)), scratch(max_datagram_size)
   {}
 
   bool operator()(int fd)
   {
-    srsran::unique_byte_buffer_t pdu = srsran::make_byte_buffer();
+    srsran::unique_byte_buffer_t pdu = srsran::make_sized_byte_buffer(expected_datagram_size);
     if (pdu == nullptr) {
       logger.error("Unable to allocate byte buffer");
       return true;
     }
-    sockaddr_in from    = {};
-    socklen_t   fromlen = sizeof(from);
+    sockaddr_in from = {};
 
-    ssize_t n_recv = recvfrom(fd, pdu->msg, pdu->get_tailroom(), 0, (struct sockaddr*)&from, &fromlen);
+    ssize_t n_recv = recv_datagram(fd, *pdu, 0, &from, scratch);
     if (n_recv == -1 and errno != EAGAIN) {
       logger.error("Error reading from socket: %s", strerror(errno));
       return true;
@@ -636,8 +667,6 @@ public:
       return true;
     }
 
-    pdu->N_bytes = static_cast<uint32_t>(n_recv);
-
     // Defer handling of received packet to provided queue
     queue.push(
         std::bind([this, from](srsran::unique_byte_buffer_t& sdu) { func(std::move(sdu), from); }, std::move(pdu)));
@@ -649,6 +678,7 @@ private:
   srslog::basic_logger&      logger;
   srsran::task_queue_handle& queue;
   callback_t                 func;
+  std::vector<uint8_t>       scratch;
 };
 
 socket_manager_itf::recv_callback_t
@@ -657,4 +687,76 @@ make_sdu_handler(srslog::basic_logger& logger, srsran::task_queue_handle& queue,
   return socket_manager_itf::recv_callback_t(recvfrom_pdu_task(logger, queue, std::move(rx_callback)));
 }
 
+/**
+ * Description: Functor for the case the received data is a burst of unique_byte_buffers, read with recvfrom(...) until
+ * the socket has no more data or the burst is full
+ */
+class recvfrom_burst_task
+{
+public:
+  using callback_t = recvfrom_burst_callback_t;
+  explicit recvfrom_burst_task(srslog::basic_logger&      logger,
+                               srsran::task_queue_handle& queue_,
+                               callback_t                 func_,
+                               uint32_t                   max_burst_) :
+    logger(logger),
+    queue(queue_),
+    func(std::move(func_)),
+    max_burst(std::max(max_burst_, 1U)),
+    scratch(max_datagram_size)
+  {}
+
+  bool operator()(int fd)
+  {
+    std::vector<rx_datagram_t> burst;
+    burst.reserve(max_burst);
+    while (burst.size() < max_burst) {
+      srsran::unique_byte_buffer_t pdu = srsran::make_sized_byte_buffer(expected_datagram_size);
+      if (pdu == nullptr) {
+        logger.error("Unable to allocate byte buffer");
+        break;
+      }
+      sockaddr_in from = {};
+
+      // The first read is the one select() woke us up for, the following ones only drain what is already queued
+      int     flags  = burst.empty() ? 0 : MSG_DONTWAIT;
+      ssize_t n_recv = recv_datagram(fd, *pdu, flags, &from, scratch);
+      if (n_recv == -1) {
+        if (errno == EAGAIN or errno == EWOULDBLOCK) {
+          if (burst.empty()) {
+            logger.debug("Socket timeout reached");
+          }
+        } else {
+          logger.error("Error reading from socket: %s", strerror(errno));
+        }
+        break;
+      }
+      burst.push_back(rx_datagram_t{std::move(pdu), from});
+    }
+    if (burst.empty()) {
+      return true;
+    }
+
+    // Defer handling of the received burst to provided queue
+    queue.push(std::bind([this](std::vector<rx_datagram_t>& b) { func(b); }, std::move(burst)));
+
+    return true;
+  }
+
+private:
+  srslog::basic_logger&      logger;
+  srsran::task_queue_handle& queue;
+  callback_t                 func;
+  uint32_t                   max_burst;
+  std::vector<uint8_t>       scratch;
+};
+
+socket_manager_itf::recv_callback_t make_sdu_burst_handler(srslog::basic_logger&      logger,
+                                                           srsran::task_queue_handle& queue,
+                                                           recvfrom_burst_callback_t  rx_callback,
+                                                           uint32_t                   max_burst)
+{
+  return socket_manager_itf::recv_callback_t(recvfrom_burst_task(logger, queue, std::move(rx_callback), max_burst));
+}
+
 } // namespace srsran
@@ -224,6 +224,36 @@ uint32_t s3g_div_alpha(uint8_t c)
           (((uint32_t)s3g_mul_x_pow(c, 6, 0xa9)) << 8) | (((uint32_t)s3g_mul_x_pow(c, 64, 0xa9))));
 }
 
+/*********************************************************************
+    Name: s3g_get_alpha_tables
+
+    Description: Lookup tables of the multiplication with and the
+                 division by alpha. They do not depend on the key, so
+                 they are computed once instead of on every LFSR clock.
+
+    Document Reference: Specification of the 3GPP Confidentiality and
+                            Integrity Algorithms UEA2 & UIA2 D2 v1.1
+                            Section 3.4.2 and Section 3.4.3
+*********************************************************************/
+struct s3g_alpha_tables_t {
+  uint32_t mul[256];
+  uint32_t div[256];
+
+  s3g_alpha_tables_t()
+  {
+    for (uint32_t c = 0; c < 256; c++) {
+      mul[c] = s3g_mul_alpha((uint8_t)c);
+      div[c] = s3g_div_alpha((uint8_t)c);
+    }
+  }
+};
+
+static const s3g_alpha_tables_t& s3g_get_alpha_tables()
+{
+  static const s3g_alpha_tables_t tables;
+  return tables;
+}
+
 /*********************************************************************
     Name: s3g_s1
 
@@ -291,9 +321,11 @@ uint32_t s3g_s2(uint32_t w)
 *********************************************************************/
 void s3g_clock_lfsr(S3G_STATE* state, uint32_t f)
 {
-  uint32_t v = (((state->lfsr[0] << 8) & 0xffffff00) ^ (s3g_mul_alpha((uint8_t)((state->lfsr[0] >> 24) & 0xff))) ^
+  const s3g_alpha_tables_t& alpha = s3g_get_alpha_tables();
+
+  uint32_t v = (((state->lfsr[0] << 8) & 0xffffff00) ^ (alpha.mul[(uint8_t)((state->lfsr[0] >> 24) & 0xff)]) ^
                 (state->lfsr[2]) ^ ((state->lfsr[11] >> 8) & 0x00ffffff) ^
-                (s3g_div_alpha((uint8_t)((state->lfsr[11]) & 0xff))) ^ (f));
+                (alpha.div[(uint8_t)((state->lfsr[11]) & 0xff)]) ^ (f));
   uint8_t  i;
 
   for (i = 0; i < 15; i++) {
@@ -332,14 +364,11 @@ uint32_t s3g_clock_fsm(S3G_STATE* state)
                             Integrity Algorithms UEA2 & UIA2 D2 v1.1
                             Section 4.1
 *********************************************************************/
-void s3g_initialize(S3G_STATE* state, uint32_t k[4], uint32_t iv[4])
+void s3g_initialize(S3G_STATE* state, const uint32_t k[4], const uint32_t iv[4])
 {
   uint8_t  i = 0;
   uint32_t f = 0x0;
 
-  state->lfsr = (uint32_t*)calloc(16, sizeof(uint32_t));
-  state->fsm  = (uint32_t*)calloc(3, sizeof(uint32_t));
-
   state->lfsr[15] = k[3] ^ iv[0];
   state->lfsr[14] = k[2];
   state->lfsr[13] = k[1];
@@ -377,8 +406,8 @@ void s3g_initialize(S3G_STATE* state, uint32_t k[4], uint32_t iv[4])
 *********************************************************************/
 void s3g_deinitialize(S3G_STATE* state)
 {
-  free(state->lfsr);
-  free(state->fsm);
+  // The state is stored inline, only the key-dependent registers need to be cleared
+  memset(state, 0, sizeof(S3G_STATE));
 }
 
 /*********************************************************************
@@ -483,23 +512,39 @@ uint8_t mask8bit(int n)
  */
 uint8_t* s3g_f9(const uint8_t* key, uint32_t count, uint32_t fresh, uint32_t dir, uint8_t* data, uint64_t length)
 {
-  uint32_t       K[4], IV[4], z[5];
-  uint32_t       i        = 0, D;
+  uint32_t       K[4];
+  uint32_t       i        = 0;
   static uint8_t MAC_I[4] = {0, 0, 0, 0}; /* static memory for the result */
-  uint64_t       EVAL;
-  uint64_t       V;
-  uint64_t       P;
-  uint64_t       Q;
-  uint64_t       c;
-  S3G_STATE      state, *state_ptr;
 
-  uint64_t M_D_2;
-  int      rem_bits = 0;
-  state_ptr         = &state;
   /* Load the Integrity Key for SNOW3G initialization as in section 4.4. */
   for (i = 0; i < 4; i++)
     K[3 - i] = (key[4 * i] << 24) ^ (key[4 * i + 1] << 16) ^ (key[4 * i + 2] << 8) ^ (key[4 * i + 3]);
 
+  s3g_f9_k(K, count, fresh, dir, data, length, MAC_I);
+  return MAC_I;
+}
+
+void s3g_f9_k(const uint32_t K[4],
+              uint32_t       count,
+              uint32_t       fresh,
+              uint32_t       dir,
+              uint8_t*       data,
+              uint64_t       length,
+              uint8_t        MAC_I[4])
+{
+  uint32_t  IV[4], z[5];
+  uint32_t  i = 0, D;
+  uint64_t  EVAL;
+  uint64_t  V;
+  uint64_t  P;
+  uint64_t  Q;
+  uint64_t  c;
+  S3G_STATE state, *state_ptr;
+
+  uint64_t M_D_2;
+  int      rem_bits = 0;
+  state_ptr         = &state;
+
   /* Prepare the Initialization Vector (IV) for SNOW3G initialization as
      in section 4.4. */
   IV[3] = count;
@@ -564,5 +609,4 @@ uint8_t* s3g_f9(const uint8_t* key, uint32_t count, uint32_t fresh, uint32_t dir
     */
     MAC_I[i] = ((EVAL >> (56 - (i * 8))) ^ (z[4] >> (24 - (i * 8)))) & 0xff;
 
-  return MAC_I;
 }
\ No newline at end of file
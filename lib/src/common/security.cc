@@ -25,6 +25,7 @@
 #include "srsran/common/ssl.h"
 #include "srsran/config.h"
 
+#include <algorithm>
 #include <arpa/inet.h>
 
 #ifdef HAVE_MBEDTLS
@@ -844,6 +845,127 @@ uint8_t security_128_eea3(uint8_t* key,
   return liblte_security_encryption_eea3(key, count, bearer, direction, msg, msg_len * 8, msg_out);
 }
 
+/******************************************************************************
+ * Encryption / Integrity Protection with precomputed key state
+ *****************************************************************************/
+
+struct security_key_sched_t : public LIBLTE_SECURITY_KEY_CTX_STRUCT {};
+
+security_key_ctx::security_key_ctx() = default;
+
+security_key_ctx::~security_key_ctx()
+{
+  reset();
+}
+
+void security_key_ctx::set_key(const uint8_t* key)
+{
+  if (sched == nullptr) {
+    sched.reset(new security_key_sched_t());
+  }
+  liblte_security_init_key_ctx(key, sched.get());
+}
+
+void security_key_ctx::reset()
+{
+  if (sched != nullptr) {
+    // Do not leave key material behind in freed memory
+    memset(static_cast<LIBLTE_SECURITY_KEY_CTX_STRUCT*>(sched.get()), 0, sizeof(LIBLTE_SECURITY_KEY_CTX_STRUCT));
+    sched.reset();
+  }
+}
+
+uint8_t security_128_eia1(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac)
+{
+  return liblte_security_128_eia1_ctx(key_ctx.get(), count, bearer, direction, msg, msg_len, mac);
+}
+
+uint8_t security_128_eia2(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac)
+{
+  return liblte_security_128_eia2_ctx(key_ctx.get(), count, bearer, direction, msg, msg_len, mac);
+}
+
+uint8_t security_128_eia3(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac)
+{
+  return liblte_security_128_eia3_ctx(key_ctx.get(), count, bearer, direction, msg, msg_len * 8, mac);
+}
+
+uint8_t security_128_eea1(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out)
+{
+  return liblte_security_encryption_eea1_ctx(key_ctx.get(), count, bearer, direction, msg, msg_len * 8, msg_out);
+}
+
+uint8_t security_128_eea2(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out)
+{
+  return liblte_security_encryption_eea2_ctx(key_ctx.get(), count, bearer, direction, msg, msg_len * 8, msg_out);
+}
+
+uint8_t security_128_eea3(const security_key_ctx& key_ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out)
+{
+  return liblte_security_encryption_eea3_ctx(key_ctx.get(), count, bearer, direction, msg, msg_len * 8, msg_out);
+}
+
+uint8_t security_128_eea2_batch(const security_key_ctx& key_ctx,
+                                uint8_t                 bearer,
+                                uint8_t                 direction,
+                                security_cipher_msg_t*  msgs,
+                                uint32_t                nof_msgs)
+{
+  const uint32_t                    max_chunk = 32;
+  LIBLTE_SECURITY_CIPHER_MSG_STRUCT lte_msgs[max_chunk];
+
+  for (uint32_t i = 0; i < nof_msgs; i += max_chunk) {
+    uint32_t nof_chunk = std::min(nof_msgs - i, max_chunk);
+    for (uint32_t j = 0; j < nof_chunk; j++) {
+      lte_msgs[j].count   = msgs[i + j].count;
+      lte_msgs[j].msg     = msgs[i + j].msg;
+      lte_msgs[j].msg_len = msgs[i + j].msg_len * 8;
+      lte_msgs[j].out     = msgs[i + j].out;
+    }
+    uint8_t ret = liblte_security_encryption_eea2_ctx_batch(key_ctx.get(), bearer, direction, lte_msgs, nof_chunk);
+    if (ret != LIBLTE_SUCCESS) {
+      return ret;
+    }
+  }
+  return LIBLTE_SUCCESS;
+}
+
 /******************************************************************************
  * Authentication
  *****************************************************************************/
@@ -873,6 +995,65 @@ uint8_t security_milenage_f5_star(uint8_t* k, uint8_t* op, uint8_t* rand, uint8_
   return liblte_security_milenage_f5_star(k, op, rand, ak);
 }
 
+struct security_milenage_sched_t : public LIBLTE_SECURITY_AES_STRUCT {};
+
+security_milenage_key::security_milenage_key() = default;
+
+security_milenage_key::~security_milenage_key()
+{
+  reset();
+}
+
+void security_milenage_key::set_key(const uint8_t* k)
+{
+  if (sched == nullptr) {
+    sched.reset(new security_milenage_sched_t());
+  }
+  liblte_security_milenage_init_key(k, sched.get());
+}
+
+void security_milenage_key::reset()
+{
+  if (sched != nullptr) {
+    // Do not leave key material behind in freed memory
+    memset(static_cast<LIBLTE_SECURITY_AES_STRUCT*>(sched.get()), 0, sizeof(LIBLTE_SECURITY_AES_STRUCT));
+    sched.reset();
+  }
+}
+
+uint8_t security_milenage_batch(security_milenage_vec_t* vecs, uint32_t nof_vecs)
+{
+  const uint32_t                  max_chunk = 32;
+  LIBLTE_SECURITY_MILENAGE_STRUCT lte_vecs[max_chunk];
+
+  for (uint32_t i = 0; i < nof_vecs; i += max_chunk) {
+    uint32_t nof_chunk = std::min(nof_vecs - i, max_chunk);
+    for (uint32_t j = 0; j < nof_chunk; j++) {
+      const security_milenage_vec_t& vec = vecs[i + j];
+      if (vec.k == nullptr) {
+        return LIBLTE_ERROR_INVALID_INPUTS;
+      }
+      lte_vecs[j].k       = vec.k->get();
+      lte_vecs[j].op_c    = vec.opc;
+      lte_vecs[j].rand    = vec.rand;
+      lte_vecs[j].sqn     = vec.sqn;
+      lte_vecs[j].amf     = vec.amf;
+      lte_vecs[j].mac_a   = vec.mac_a;
+      lte_vecs[j].mac_s   = vec.mac_s;
+      lte_vecs[j].res     = vec.res;
+      lte_vecs[j].ck      = vec.ck;
+      lte_vecs[j].ik      = vec.ik;
+      lte_vecs[j].ak      = vec.ak;
+      lte_vecs[j].ak_star = vec.ak_star;
+    }
+    uint8_t ret = liblte_security_milenage_batch(lte_vecs, nof_chunk);
+    if (ret != LIBLTE_SUCCESS) {
+      return ret;
+    }
+  }
+  return LIBLTE_SUCCESS;
+}
+
 int security_xor_f2345(uint8_t* k, uint8_t* rand, uint8_t* res, uint8_t* ck, uint8_t* ik, uint8_t* ak)
 {
   uint8_t xdout[16];
@@ -21,6 +21,7 @@
 
 #include "srsran/common/thread_pool.h"
 #include "srsran/srslog/srslog.h"
+#include <algorithm>
 #include <assert.h>
 #include <chrono>
 #include <stdio.h>
@@ -401,6 +402,68 @@ void task_thread_pool::worker_t::run_thread()
   running = false;
 }
 
+namespace {
+
+/// Shared between the caller of parallel_for() and its helper tasks, which may outlive the call
+struct parallel_for_state {
+  const std::function<void(uint32_t)>* func      = nullptr;
+  uint32_t                             nof_items = 0;
+  std::atomic<uint32_t>                next_item = {0};
+  std::atomic<uint32_t>                nof_done  = {0};
+  std::mutex                           mutex;
+  std::condition_variable              cvar;
+
+  /// Runs the next pending item, returns false when there are none left
+  bool run_next()
+  {
+    uint32_t idx = next_item.fetch_add(1, std::memory_order_relaxed);
+    if (idx >= nof_items) {
+      return false;
+    }
+    (*func)(idx);
+    if (nof_done.fetch_add(1, std::memory_order_acq_rel) + 1 == nof_items) {
+      std::lock_guard<std::mutex> lock(mutex);
+      cvar.notify_all();
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+void parallel_for(task_thread_pool& pool, uint32_t nof_items, const std::function<void(uint32_t)>& func)
+{
+  if (nof_items <= 1) {
+    if (nof_items == 1) {
+      func(0);
+    }
+    return;
+  }
+
+  std::shared_ptr<parallel_for_state> state = std::make_shared<parallel_for_state>();
+  state->func                               = &func;
+  state->nof_items                          = nof_items;
+
+  // Helpers that start after all the items have been taken return without touching func
+  uint32_t nof_helpers = std::min(nof_items - 1, static_cast<uint32_t>(pool.nof_workers()));
+  for (uint32_t i = 0; i < nof_helpers; ++i) {
+    pool.push_task([state]() {
+      while (state->run_next()) {
+        // Keep taking items
+      }
+    });
+  }
+
+  while (state->run_next()) {
+    // Keep taking items
+  }
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  while (state->nof_done.load(std::memory_order_acquire) < nof_items) {
+    state->cvar.wait(lock);
+  }
+}
+
 task_worker::task_worker(std::string thread_name_,
                          uint32_t    queue_size,
                          bool        start_deferred,
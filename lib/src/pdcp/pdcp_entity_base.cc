@@ -44,6 +44,23 @@ void pdcp_entity_base::config_security(const as_security_config_t& sec_cfg_)
   logger.debug(sec_cfg.k_up_enc.data(), 32, "K_up_enc");
   logger.debug(sec_cfg.k_rrc_int.data(), 32, "K_rrc_int");
   logger.debug(sec_cfg.k_up_int.data(), 32, "K_up_int");
+
+  // Expand the keys used by this bearer once, instead of on every PDU. As in the other security functions, the
+  // 128-bit keys are the least significant half of the derived 256-bit keys
+  if (is_srb()) {
+    k_enc_ctx.set_key(&sec_cfg.k_rrc_enc[16]);
+    k_int_ctx.set_key(&sec_cfg.k_rrc_int[16]);
+  } else {
+    k_enc_ctx.set_key(&sec_cfg.k_up_enc[16]);
+    k_int_ctx.set_key(&sec_cfg.k_up_int[16]);
+  }
+}
+
+void pdcp_entity_base::write_sdus(span<unique_byte_buffer_t> sdus)
+{
+  for (unique_byte_buffer_t& sdu : sdus) {
+    write_sdu(std::move(sdu));
+  }
 }
 
 /****************************************************************************
@@ -64,13 +81,13 @@ void pdcp_entity_base::integrity_generate(uint8_t* msg, uint32_t msg_len, uint32
     case INTEGRITY_ALGORITHM_ID_EIA0:
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA1:
-      security_128_eia1(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
+      security_128_eia1(k_int_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA2:
-      security_128_eia2(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
+      security_128_eia2(k_int_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA3:
-      security_128_eia3(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
+      security_128_eia3(k_int_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
       break;
     default:
       break;
@@ -102,13 +119,13 @@ bool pdcp_entity_base::integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t
     case INTEGRITY_ALGORITHM_ID_EIA0:
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA1:
-      security_128_eia1(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
+      security_128_eia1(k_int_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA2:
-      security_128_eia2(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
+      security_128_eia2(k_int_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA3:
-      security_128_eia3(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
+      security_128_eia3(k_int_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
       break;
     default:
       break;
@@ -158,15 +175,15 @@ void pdcp_entity_base::cipher_encrypt(uint8_t* msg, uint32_t msg_len, uint32_t c
     case CIPHERING_ALGORITHM_ID_EEA0:
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA1:
-      security_128_eea1(&(k_enc[16]), count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
+      security_128_eea1(k_enc_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
       memcpy(ct, ct_tmp, msg_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA2:
-      security_128_eea2(&(k_enc[16]), count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
+      security_128_eea2(k_enc_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
       memcpy(ct, ct_tmp, msg_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA3:
-      security_128_eea3(&(k_enc[16]), count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
+      security_128_eea3(k_enc_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
       memcpy(ct, ct_tmp, msg_len);
       break;
     default:
@@ -198,15 +215,15 @@ void pdcp_entity_base::cipher_decrypt(uint8_t* ct, uint32_t ct_len, uint32_t cou
     case CIPHERING_ALGORITHM_ID_EEA0:
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA1:
-      security_128_eea1(&k_enc[16], count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
+      security_128_eea1(k_enc_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
       memcpy(msg, msg_tmp, ct_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA2:
-      security_128_eea2(&k_enc[16], count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
+      security_128_eea2(k_enc_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
       memcpy(msg, msg_tmp, ct_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA3:
-      security_128_eea3(&k_enc[16], count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
+      security_128_eea3(k_enc_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
       memcpy(msg, msg_tmp, ct_len);
       break;
     default:
@@ -215,6 +232,35 @@ void pdcp_entity_base::cipher_decrypt(uint8_t* ct, uint32_t ct_len, uint32_t cou
   logger.debug(msg, ct_len, "Cipher decrypt output msg");
 }
 
+void pdcp_entity_base::cipher_encrypt_batch(span<security_cipher_msg_t> msgs)
+{
+  if (sec_cfg.cipher_algo != CIPHERING_ALGORITHM_ID_128_EEA2) {
+    // The keystreams of EEA1 and EEA3 are generated message by message
+    for (security_cipher_msg_t& m : msgs) {
+      cipher_encrypt(m.msg, m.msg_len, m.count, m.out);
+    }
+    return;
+  }
+
+  if (logger.debug.enabled()) {
+    for (const security_cipher_msg_t& m : msgs) {
+      logger.debug("Cipher encrypt input: COUNT: %" PRIu32 ", Bearer ID: %d, Direction %s",
+                   m.count,
+                   cfg.bearer_id,
+                   cfg.tx_direction == SECURITY_DIRECTION_DOWNLINK ? "Downlink" : "Uplink");
+      logger.debug(m.msg, m.msg_len, "Cipher encrypt input msg");
+    }
+  }
+
+  security_128_eea2_batch(k_enc_ctx, cfg.bearer_id - 1, cfg.tx_direction, msgs.data(), msgs.size());
+
+  if (logger.debug.enabled()) {
+    for (const security_cipher_msg_t& m : msgs) {
+      logger.debug(m.out, m.msg_len, "Cipher encrypt output msg");
+    }
+  }
+}
+
 /****************************************************************************
  * Common pack functions
  ***************************************************************************/
@@ -144,20 +144,67 @@ void pdcp_entity_lte::reset()
 
 // GW/RRC interface
 void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, int upper_sn)
+{
+  uint32_t tx_count;
+  if (not prepare_tx_pdu(sdu, upper_sn, tx_count)) {
+    return;
+  }
+
+  if (tx_encryption_enabled()) {
+    cipher_encrypt(
+        &sdu->msg[cfg.hdr_len_bytes], sdu->N_bytes - cfg.hdr_len_bytes, tx_count, &sdu->msg[cfg.hdr_len_bytes]);
+  }
+
+  send_tx_pdu(std::move(sdu));
+}
+
+void pdcp_entity_lte::write_sdus(span<unique_byte_buffer_t> sdus)
+{
+  // Assign COUNTs, headers and MACs in order, then cipher the payloads of the whole burst in one pass
+  tx_burst_cipher_msgs.clear();
+  for (unique_byte_buffer_t& sdu : sdus) {
+    uint32_t tx_count;
+    if (not prepare_tx_pdu(sdu, -1, tx_count)) {
+      sdu.reset();
+      continue;
+    }
+    if (tx_encryption_enabled()) {
+      security_cipher_msg_t msg;
+      msg.count   = tx_count;
+      msg.msg     = &sdu->msg[cfg.hdr_len_bytes];
+      msg.msg_len = sdu->N_bytes - cfg.hdr_len_bytes;
+      msg.out     = msg.msg;
+      tx_burst_cipher_msgs.push_back(msg);
+    }
+  }
+
+  cipher_encrypt_batch(tx_burst_cipher_msgs);
+
+  for (unique_byte_buffer_t& sdu : sdus) {
+    if (sdu != nullptr) {
+      send_tx_pdu(std::move(sdu));
+    }
+  }
+}
+
+/// Assigns the COUNT of the SDU, writes the PDCP header and the MAC-I and advances the TX state. Returns false if the
+/// SDU has to be dropped. The RLC queue occupancy is checked before the PDUs of a burst are written to RLC, so RLC may
+/// still drop some of them if the queue fills up in the middle of a burst.
+bool pdcp_entity_lte::prepare_tx_pdu(unique_byte_buffer_t& sdu, int upper_sn, uint32_t& tx_count)
 {
   if (!active) {
     logger.warning("Dropping %s SDU due to inactive bearer", rb_name.c_str());
-    return;
+    return false;
   }
 
   if (rlc->is_suspended(lcid)) {
     logger.warning("Trying to send SDU while re-establishment is in progress. Dropping SDU. LCID=%d", lcid);
-    return;
+    return false;
   }
 
   if (rlc->sdu_queue_is_full(lcid)) {
     logger.info(sdu->msg, sdu->N_bytes, "Dropping %s SDU due to full queue", rb_name.c_str());
-    return;
+    return false;
   }
 
   // Get COUNT to be used with this packet
@@ -168,7 +215,7 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, int upper_sn)
     used_sn = upper_sn; // SN provided by the upper layers, due to handover.
   }
 
-  uint32_t tx_count = COUNT(st.tx_hfn, used_sn); // Normal scenario
+  tx_count = COUNT(st.tx_hfn, used_sn); // Normal scenario
 
   // If the bearer is mapped to RLC AM, save TX_COUNT and a copy of the PDU.
   // This will be used for reestablishment, where unack'ed PDUs will be re-transmitted.
@@ -179,7 +226,7 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, int upper_sn)
     if (not store_sdu(used_sn, sdu)) {
       // Could not store the SDU, discarding
       logger.warning("Could not store SDU. Discarding SN=%d", used_sn);
-      return;
+      return false;
     }
   }
   // check for pending security config in transmit direction
@@ -202,19 +249,6 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, int upper_sn)
     append_mac(sdu, mac);
   }
 
-  if (encryption_direction == DIRECTION_TX || encryption_direction == DIRECTION_TXRX) {
-    cipher_encrypt(
-        &sdu->msg[cfg.hdr_len_bytes], sdu->N_bytes - cfg.hdr_len_bytes, tx_count, &sdu->msg[cfg.hdr_len_bytes]);
-  }
-
-  logger.info(sdu->msg,
-              sdu->N_bytes,
-              "TX %s PDU, SN=%d, integrity=%s, encryption=%s",
-              rb_name.c_str(),
-              used_sn,
-              srsran_direction_text[integrity_direction],
-              srsran_direction_text[encryption_direction]);
-
   // Set SDU metadata for RLC AM
   sdu->md.pdcp_sn = used_sn;
 
@@ -226,11 +260,23 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, int upper_sn)
       st.next_pdcp_tx_sn = 0;
     }
   }
+  return true;
+}
+
+void pdcp_entity_lte::send_tx_pdu(unique_byte_buffer_t pdu)
+{
+  logger.info(pdu->msg,
+              pdu->N_bytes,
+              "TX %s PDU, SN=%d, integrity=%s, encryption=%s",
+              rb_name.c_str(),
+              pdu->md.pdcp_sn,
+              srsran_direction_text[integrity_direction],
+              srsran_direction_text[encryption_direction]);
 
   // Pass PDU to lower layers
   metrics.num_tx_pdus++;
-  metrics.num_tx_pdu_bytes += sdu->N_bytes;
-  rlc->write_sdu(lcid, std::move(sdu));
+  metrics.num_tx_pdu_bytes += pdu->N_bytes;
+  rlc->write_sdu(lcid, std::move(pdu));
 }
 
 // RLC interface
@@ -538,8 +584,8 @@ void pdcp_entity_lte::send_status_report()
   // Get Last Missing Segment
   uint32_t nof_sns_in_bitmap = rx_counts_info.size();
 
-  // Allocate Status Report PDU
-  unique_byte_buffer_t pdu = make_byte_buffer();
+  // Allocate Status Report PDU. The header fits a small buffer, which grows if a large bitmap is needed
+  unique_byte_buffer_t pdu = make_sized_byte_buffer(3);
   if (pdu == nullptr) {
     logger.error("Error allocating buffer for status report");
     return;
@@ -579,6 +625,7 @@ void pdcp_entity_lte::send_status_report()
       return;
     }
     uint32_t bitmap_sz = std::ceil((float)(diff) / 8);
+    pdu->reserve(bitmap_sz);
     memset(&pdu->msg[pdu->N_bytes], 0, bitmap_sz);
     logger.debug(
         "Setting status report bitmap. Last missing SN=%d, Last SN acked in sequence=%d, Bitmap size in bytes=%d",
@@ -901,7 +948,7 @@ bool undelivered_sdus_queue::add_sdu(uint32_t                              sn,
   }
 
   // Allocate buffer and exit on error
-  srsran::unique_byte_buffer_t tmp = make_byte_buffer();
+  srsran::unique_byte_buffer_t tmp = make_sized_byte_buffer(sdu->N_bytes);
   if (tmp == nullptr) {
     return false;
   }
@@ -1001,7 +1048,7 @@ std::map<uint32_t, srsran::unique_byte_buffer_t> undelivered_sdus_queue::get_buf
   for (auto& sdu : sdus) {
     if (sdu.sdu != nullptr) {
       // TODO: Find ways to avoid deep copy
-      srsran::unique_byte_buffer_t fwd_sdu = make_byte_buffer();
+      srsran::unique_byte_buffer_t fwd_sdu = make_sized_byte_buffer(sdu.sdu->N_bytes);
       if (fwd_sdu != nullptr) {
         *fwd_sdu = *sdu.sdu;
         fwd_sdus.emplace(sdu.sdu->md.pdcp_sn, std::move(fwd_sdu));
@@ -85,6 +85,54 @@ void pdcp_entity_nr::reset()
 
 // SDAP/RRC interface
 void pdcp_entity_nr::write_sdu(unique_byte_buffer_t sdu, int sn)
+{
+  uint32_t tx_count;
+  uint8_t  mac[4];
+  if (not prepare_tx_sdu(sdu, tx_count, mac)) {
+    return;
+  }
+
+  // Ciphering
+  cipher_encrypt(sdu->msg, sdu->N_bytes, tx_count, sdu->msg);
+
+  send_tx_pdu(std::move(sdu), tx_count, mac);
+}
+
+void pdcp_entity_nr::write_sdus(span<unique_byte_buffer_t> sdus)
+{
+  // Assign COUNTs and MACs in order, then cipher the whole burst in one pass
+  tx_burst_cipher_msgs.clear();
+  tx_burst_macs.clear();
+  for (unique_byte_buffer_t& sdu : sdus) {
+    uint32_t                tx_count;
+    std::array<uint8_t, 4> mac;
+    if (not prepare_tx_sdu(sdu, tx_count, mac.data())) {
+      sdu.reset();
+      continue;
+    }
+    security_cipher_msg_t msg;
+    msg.count   = tx_count;
+    msg.msg     = sdu->msg;
+    msg.msg_len = sdu->N_bytes;
+    msg.out     = sdu->msg;
+    tx_burst_cipher_msgs.push_back(msg);
+    tx_burst_macs.push_back(mac);
+  }
+
+  cipher_encrypt_batch(tx_burst_cipher_msgs);
+
+  uint32_t idx = 0;
+  for (unique_byte_buffer_t& sdu : sdus) {
+    if (sdu != nullptr) {
+      send_tx_pdu(std::move(sdu), tx_burst_cipher_msgs[idx].count, tx_burst_macs[idx].data());
+      idx++;
+    }
+  }
+}
+
+/// Assigns TX_NEXT to the SDU, starts its discard timer and computes its MAC-I. Returns false if the SDU has to be
+/// dropped.
+bool pdcp_entity_nr::prepare_tx_sdu(const unique_byte_buffer_t& sdu, uint32_t& tx_count, uint8_t* mac)
 {
   // Log SDU
   logger.info(sdu->msg,
@@ -97,7 +145,7 @@ void pdcp_entity_nr::write_sdu(unique_byte_buffer_t sdu, int sn)
   // Check for COUNT overflow
   if (tx_overflow) {
     logger.warning("TX_NEXT has overflowed. Dropping packet");
-    return;
+    return false;
   }
   if (tx_next + 1 == 0) {
     tx_overflow = true;
@@ -116,27 +164,27 @@ void pdcp_entity_nr::write_sdu(unique_byte_buffer_t sdu, int sn)
   // Perform header compression TODO
 
   // Integrity protection
-  uint8_t mac[4];
   integrity_generate(sdu->msg, sdu->N_bytes, tx_next, mac);
 
-  // Ciphering
-  cipher_encrypt(sdu->msg, sdu->N_bytes, tx_next, sdu->msg);
+  // Increment TX_NEXT
+  tx_count = tx_next++;
+  return true;
+}
 
+void pdcp_entity_nr::send_tx_pdu(unique_byte_buffer_t pdu, uint32_t tx_count, uint8_t* mac)
+{
   // Write PDCP header info
-  write_data_header(sdu, tx_next);
+  write_data_header(pdu, tx_count);
 
   // Append MAC-I
-  append_mac(sdu, mac);
+  append_mac(pdu, mac);
 
   // Set meta-data for RLC AM
-  sdu->md.pdcp_sn = tx_next;
+  pdu->md.pdcp_sn = tx_count;
 
   // Check if PDCP is associated with more than on RLC entity TODO
   // Write to lower layers
-  rlc->write_sdu(lcid, std::move(sdu));
-
-  // Increment TX_NEXT
-  tx_next++;
+  rlc->write_sdu(lcid, std::move(pdu));
 }
 
 // RLC interface
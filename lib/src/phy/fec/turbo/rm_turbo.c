@@ -83,8 +83,13 @@ static bool                     rm_turbo_tables_generated = false;
 // Store deinterleaver version for sub-block turbo decoder
 #if SRSRAN_TDEC_EXPECT_INPUT_SB == 1
 // Prepare bit for sub-block decoder processing. These are the nof subblock sizes
+#ifdef LV_HAVE_AVX512
+#define NOF_DEINTER_TABLE_SB_IDX 4
+const static int deinter_table_sb_idx[NOF_DEINTER_TABLE_SB_IDX] = {8, 16, 32, 64};
+#else
 #define NOF_DEINTER_TABLE_SB_IDX 3
 const static int deinter_table_sb_idx[NOF_DEINTER_TABLE_SB_IDX] = {8, 16, 32};
+#endif
 int              deinter_table_idx_from_sb_len(uint32_t nof_subblocks)
 {
   for (int i = 0; i < NOF_DEINTER_TABLE_SB_IDX; i++) {
@@ -307,6 +312,11 @@ void srsran_rm_turbo_gentables()
 
 #if SRSRAN_TDEC_EXPECT_INPUT_SB == 1
         for (uint32_t s = 0; s < NOF_DEINTER_TABLE_SB_IDX; s++) {
+          // The sub-block decoders are only used when the CB length is a multiple of the number of sub-blocks. Skip
+          // the rest, so that their pages in the (large) static table are never touched
+          if (cb_len % deinter_table_sb_idx[s]) {
+            continue;
+          }
           interleave_table_sb(
               deinterleaver[cb_idx][i], deinterleaver_sb[s][cb_idx][i], cb_idx, deinter_table_sb_idx[s]);
         }
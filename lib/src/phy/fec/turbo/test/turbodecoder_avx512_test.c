@@ -0,0 +1,311 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/*
+ * Checks the AVX512 window turbo decoders (16-bit and 8-bit) for every CB length where they are selected by the
+ * automatic mode:
+ *  - The sub-block rate-matching tables for the AVX512 number of sub-blocks match the natural order ones.
+ *  - The sub-block input path (used after rate-matching) and the natural input path produce bit-exact soft outputs.
+ *  - The decoded data matches the AVX2 window decoder of the same LLR width and, for 16-bit, the transmitted data.
+ *    The 8-bit decoders are not checked against the transmitted data, as they have an error floor of a few bits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "srsran/srsran.h"
+
+#define TDEC_SB_OFFSET 32 // Same alignment as in rm_turbo.c
+
+static uint32_t nof_iterations = 8;
+static uint32_t seed           = 0x1234;
+static float    noise_std      = 0.1f;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [insv]\n", prog);
+  printf("\t-i nof_iterations [Default %d]\n", nof_iterations);
+  printf("\t-n noise standard deviation [Default %.2f]\n", noise_std);
+  printf("\t-s seed [Default 0x%x]\n", seed);
+  printf("\t-v [set srsran_verbose to debug, default none]\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "i:n:s:v")) != -1) {
+    switch (opt) {
+      case 'i':
+        nof_iterations = (uint32_t)strtol(optarg, NULL, 10);
+        break;
+      case 'n':
+        noise_std = strtof(optarg, NULL);
+        break;
+      case 's':
+        seed = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'v':
+        increase_srsran_verbose_level();
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+/* Rearranges natural order LLRs into the sub-block layout produced by the rate-matching (see interleave_table_sb()) */
+static void input_to_sb(const int16_t* input, int16_t* output, uint32_t long_cb, uint32_t nof_sb)
+{
+  uint32_t long_sb = long_cb / nof_sb;
+  for (uint32_t i = 0; i < 3 * long_cb; i++) {
+    uint32_t k = i / 3;
+    output[(i % 3) * (long_cb + TDEC_SB_OFFSET) + (k % long_sb) * nof_sb + k / long_sb] = input[i];
+  }
+  for (uint32_t i = 0; i < SRSRAN_TCOD_TOTALTAIL; i++) {
+    output[3 * (long_cb + TDEC_SB_OFFSET) + i] = input[3 * long_cb + i];
+  }
+}
+
+static void convert_16_to_8(const int16_t* input, int8_t* output, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; i++) {
+    output[i] = (int8_t)SRSRAN_MAX(-127, SRSRAN_MIN(127, input[i]));
+  }
+}
+
+/* Returns the soft output used by the last decision */
+static void* tdec_soft_output(srsran_tdec_t* tdec)
+{
+  return (tdec->n_iter % 2) ? tdec->ext1 : tdec->app1;
+}
+
+static int test_rm_turbo(srsran_random_t random_gen, uint32_t cb_idx, bool is_8bit, uint32_t nof_sb)
+{
+  uint32_t long_cb = srsran_cbsegm_cbsize(cb_idx);
+  uint32_t in_len  = 3 * long_cb + SRSRAN_TCOD_TOTALTAIL;
+  uint32_t sb_len  = 3 * (long_cb + TDEC_SB_OFFSET) + SRSRAN_TCOD_TOTALTAIL;
+  int16_t* e       = srsran_vec_i16_malloc(in_len);
+  int8_t*  e8      = srsran_vec_i8_malloc(in_len);
+  int16_t* natural = srsran_vec_i16_malloc(in_len);
+  int16_t* sb_ref  = srsran_vec_i16_malloc(sb_len);
+  int16_t* sb      = srsran_vec_i16_malloc(sb_len);
+  int8_t*  sb_ref8 = srsran_vec_i8_malloc(sb_len);
+  int8_t*  sb8     = srsran_vec_i8_malloc(sb_len);
+  int      ret     = SRSRAN_ERROR;
+
+  for (uint32_t i = 0; i < in_len; i++) {
+    e[i] = (int16_t)srsran_random_uniform_int_dist(random_gen, -5, 5);
+  }
+  convert_16_to_8(e, e8, in_len);
+
+  srsran_vec_i16_zero(natural, in_len);
+  srsran_vec_i16_zero(sb_ref, sb_len);
+  srsran_vec_i16_zero(sb, sb_len);
+  srsran_rm_turbo_rx_lut_(e, natural, in_len, cb_idx, 0, false);
+  input_to_sb(natural, sb_ref, long_cb, nof_sb);
+
+  if (is_8bit) {
+    srsran_vec_i8_zero(sb8, sb_len);
+    convert_16_to_8(sb_ref, sb_ref8, sb_len);
+    srsran_rm_turbo_rx_lut_8bit(e8, sb8, in_len, cb_idx, 0);
+    if (memcmp(sb_ref8, sb8, sb_len) != 0) {
+      ERROR("8-bit sub-block rate-matching mismatch for long_cb=%d", long_cb);
+      goto clean_exit;
+    }
+  } else {
+    srsran_rm_turbo_rx_lut_(e, sb, in_len, cb_idx, 0, true);
+    if (memcmp(sb_ref, sb, sb_len * sizeof(int16_t)) != 0) {
+      ERROR("16-bit sub-block rate-matching mismatch for long_cb=%d", long_cb);
+      goto clean_exit;
+    }
+  }
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  free(e);
+  free(e8);
+  free(natural);
+  free(sb_ref);
+  free(sb);
+  free(sb_ref8);
+  free(sb8);
+  return ret;
+}
+
+static int test_tdec(srsran_random_t random_gen,
+                     srsran_tcod_t*  tcod,
+                     srsran_tdec_t*  tdec_auto,
+                     srsran_tdec_t*  tdec_avx512,
+                     srsran_tdec_t*  tdec_avx2,
+                     uint32_t        long_cb,
+                     bool            is_8bit,
+                     uint32_t        nof_sb)
+{
+  uint32_t coded_len  = 3 * long_cb + SRSRAN_TCOD_TOTALTAIL;
+  uint32_t sb_len     = 3 * (long_cb + TDEC_SB_OFFSET) + SRSRAN_TCOD_TOTALTAIL;
+  uint8_t* data_tx    = srsran_vec_u8_malloc(long_cb);
+  uint8_t* data_bytes = srsran_vec_u8_malloc(long_cb / 8);
+  uint8_t* symbols    = srsran_vec_u8_malloc(coded_len);
+  int16_t* llr        = srsran_vec_i16_malloc(coded_len);
+  int16_t* llr_sb     = srsran_vec_i16_malloc(sb_len);
+  int8_t*  llr8       = srsran_vec_i8_malloc(coded_len);
+  int8_t*  llr8_sb    = srsran_vec_i8_malloc(sb_len);
+  uint8_t* out_auto   = srsran_vec_u8_malloc(long_cb / 8);
+  uint8_t* out_avx512 = srsran_vec_u8_malloc(long_cb / 8);
+  uint8_t* out_avx2   = srsran_vec_u8_malloc(long_cb / 8);
+  size_t   soft_size  = long_cb * (is_8bit ? sizeof(int8_t) : sizeof(int16_t));
+  int      ret        = SRSRAN_ERROR;
+
+  srsran_random_bit_vector(random_gen, data_tx, long_cb);
+  srsran_bit_pack_vector(data_tx, data_bytes, long_cb);
+  srsran_tcod_encode(tcod, data_tx, symbols, long_cb);
+
+  // 8-bit LLRs use a smaller amplitude, as the 8-bit decoders saturate
+  float amplitude = is_8bit ? 8.0f : 100.0f;
+  for (uint32_t i = 0; i < coded_len; i++) {
+    float x = (symbols[i] ? 1.0f : -1.0f) + srsran_random_gauss_dist(random_gen, noise_std);
+    llr[i]  = (int16_t)(amplitude * x);
+  }
+  srsran_vec_i16_zero(llr_sb, sb_len);
+  input_to_sb(llr, llr_sb, long_cb, nof_sb);
+
+  // Automatic mode takes the sub-block layout, the manual decoder takes the natural order
+  if (is_8bit) {
+    convert_16_to_8(llr, llr8, coded_len);
+    convert_16_to_8(llr_sb, llr8_sb, sb_len);
+    srsran_tdec_run_all_8bit(tdec_auto, llr8_sb, out_auto, nof_iterations, long_cb);
+    srsran_tdec_run_all_8bit(tdec_avx512, llr8, out_avx512, nof_iterations, long_cb);
+    srsran_tdec_run_all_8bit(tdec_avx2, llr8, out_avx2, nof_iterations, long_cb);
+  } else {
+    srsran_tdec_run_all(tdec_auto, llr_sb, out_auto, nof_iterations, long_cb);
+    srsran_tdec_run_all(tdec_avx512, llr, out_avx512, nof_iterations, long_cb);
+    srsran_tdec_run_all(tdec_avx2, llr, out_avx2, nof_iterations, long_cb);
+  }
+
+  if (memcmp(tdec_soft_output(tdec_auto), tdec_soft_output(tdec_avx512), soft_size) != 0) {
+    ERROR("%d-bit soft output mismatch for long_cb=%d", is_8bit ? 8 : 16, long_cb);
+    goto clean_exit;
+  }
+  if (memcmp(out_auto, out_avx512, long_cb / 8) != 0) {
+    ERROR("%d-bit decoded data mismatch for long_cb=%d", is_8bit ? 8 : 16, long_cb);
+    goto clean_exit;
+  }
+  if (memcmp(out_avx2, out_avx512, long_cb / 8) != 0) {
+    ERROR("%d-bit decoded data does not match the AVX2 decoder for long_cb=%d", is_8bit ? 8 : 16, long_cb);
+    goto clean_exit;
+  }
+  if (!is_8bit && memcmp(data_bytes, out_avx512, long_cb / 8) != 0) {
+    ERROR("%d-bit decoded data does not match transmitted data for long_cb=%d", is_8bit ? 8 : 16, long_cb);
+    goto clean_exit;
+  }
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  free(data_tx);
+  free(data_bytes);
+  free(symbols);
+  free(llr);
+  free(llr_sb);
+  free(llr8);
+  free(llr8_sb);
+  free(out_auto);
+  free(out_avx512);
+  free(out_avx2);
+  return ret;
+}
+
+int main(int argc, char** argv)
+{
+  int             ret        = SRSRAN_ERROR;
+  srsran_random_t random_gen = NULL;
+  srsran_tcod_t   tcod       = {};
+  srsran_tdec_t   tdec_auto  = {};
+  srsran_tdec_t   tdec16     = {};
+  srsran_tdec_t   tdec8      = {};
+  srsran_tdec_t   tdec16_ref = {};
+  srsran_tdec_t   tdec8_ref  = {};
+  uint32_t        nof_cb16   = 0;
+  uint32_t        nof_cb8    = 0;
+
+  parse_args(argc, argv);
+  random_gen = srsran_random_init(seed);
+
+  srsran_rm_turbo_gentables();
+
+  if (srsran_tcod_init(&tcod, SRSRAN_TCOD_MAX_LEN_CB) || srsran_tdec_init(&tdec_auto, SRSRAN_TCOD_MAX_LEN_CB) ||
+      srsran_tdec_init_manual(&tdec16, SRSRAN_TCOD_MAX_LEN_CB, SRSRAN_TDEC_AVX512_WINDOW) ||
+      srsran_tdec_init_manual(&tdec8, SRSRAN_TCOD_MAX_LEN_CB, SRSRAN_TDEC_AVX512_8_WINDOW) ||
+      srsran_tdec_init_manual(&tdec16_ref, SRSRAN_TCOD_MAX_LEN_CB, SRSRAN_TDEC_AVX_WINDOW) ||
+      srsran_tdec_init_manual(&tdec8_ref, SRSRAN_TCOD_MAX_LEN_CB, SRSRAN_TDEC_AVX8_WINDOW)) {
+    ERROR("Error initiating turbo coder/decoders");
+    goto clean_exit;
+  }
+  srsran_tdec_force_not_sb(&tdec16);
+  srsran_tdec_force_not_sb(&tdec8);
+  srsran_tdec_force_not_sb(&tdec16_ref);
+  srsran_tdec_force_not_sb(&tdec8_ref);
+
+  for (uint32_t cb_idx = 0; cb_idx < SRSRAN_NOF_TC_CB_SIZES; cb_idx++) {
+    uint32_t long_cb = srsran_cbsegm_cbsize(cb_idx);
+
+    uint32_t nof_sb16 = srsran_tdec_autoimp_get_subblocks(long_cb);
+    if (nof_sb16 == tdec16.nof_blocks16[0]) {
+      if (test_rm_turbo(random_gen, cb_idx, false, nof_sb16) ||
+          test_tdec(random_gen, &tcod, &tdec_auto, &tdec16, &tdec16_ref, long_cb, false, nof_sb16)) {
+        goto clean_exit;
+      }
+      nof_cb16++;
+    }
+
+    uint32_t nof_sb8 = srsran_tdec_autoimp_get_subblocks_8bit(long_cb);
+    if (nof_sb8 == tdec8.nof_blocks8[0]) {
+      if (test_rm_turbo(random_gen, cb_idx, true, nof_sb8) ||
+          test_tdec(random_gen, &tcod, &tdec_auto, &tdec8, &tdec8_ref, long_cb, true, nof_sb8)) {
+        goto clean_exit;
+      }
+      nof_cb8++;
+    }
+  }
+
+  if (nof_cb16 == 0 || nof_cb8 == 0) {
+    ERROR("No CB length selects the AVX512 decoders in automatic mode");
+    goto clean_exit;
+  }
+  printf("Checked %d CB lengths with the 16-bit decoder and %d with the 8-bit decoder\n", nof_cb16, nof_cb8);
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_tcod_free(&tcod);
+  srsran_tdec_free(&tdec_auto);
+  srsran_tdec_free(&tdec16);
+  srsran_tdec_free(&tdec8);
+  srsran_tdec_free(&tdec16_ref);
+  srsran_tdec_free(&tdec8_ref);
+  srsran_rm_turbo_free_tables();
+  srsran_random_free(random_gen);
+
+  printf("%s\n", ret == SRSRAN_SUCCESS ? "Ok" : "Error");
+  return ret;
+}
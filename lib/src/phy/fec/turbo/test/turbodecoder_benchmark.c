@@ -0,0 +1,244 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/*
+ * Measures the throughput of every turbo decoder implementation compiled in, in decoder iterations per second, for a
+ * given CB length. Windowed implementations are skipped when the CB length is not a multiple of their number of
+ * sub-blocks. 8-bit decoders take the sub-block input layout produced by the rate-matching, as in the PDSCH/PUSCH
+ * decoding chain.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/srsran.h"
+
+#define TDEC_SB_OFFSET 32 // Same alignment as in rm_turbo.c
+#define TDEC_WIN_OVERLAP 40
+
+static uint32_t long_cb         = 6144;
+static uint32_t nof_iterations  = 8;
+static uint32_t nof_repetitions = 200;
+static float    noise_std       = 0.1f;
+
+typedef struct {
+  srsran_tdec_impl_type_t type;
+  const char*             name;
+  bool                    is_8bit;
+} tdec_bench_impl_t;
+
+static const tdec_bench_impl_t impl_list[] = {
+#ifndef HAVE_NEON
+    {SRSRAN_TDEC_GENERIC, "generic", false},
+#endif /* HAVE_NEON */
+#ifdef LV_HAVE_SSE
+    {SRSRAN_TDEC_SSE, "sse", false},
+    {SRSRAN_TDEC_SSE_WINDOW, "sse-win", false},
+    {SRSRAN_TDEC_SSE8_WINDOW, "sse8-win", true},
+#endif /* LV_HAVE_SSE */
+#ifdef HAVE_NEON
+    {SRSRAN_TDEC_NEON_WINDOW, "neon-win", false},
+#endif /* HAVE_NEON */
+#ifdef LV_HAVE_AVX2
+    {SRSRAN_TDEC_AVX_WINDOW, "avx2-win", false},
+    {SRSRAN_TDEC_AVX8_WINDOW, "avx2-8-win", true},
+#endif /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_AVX512
+    {SRSRAN_TDEC_AVX512_WINDOW, "avx512-win", false},
+    {SRSRAN_TDEC_AVX512_8_WINDOW, "avx512-8-win", true},
+#endif /* LV_HAVE_AVX512 */
+};
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [linRv]\n", prog);
+  printf("\t-l CB length [Default %d]\n", long_cb);
+  printf("\t-i nof_iterations [Default %d]\n", nof_iterations);
+  printf("\t-n noise standard deviation [Default %.2f]\n", noise_std);
+  printf("\t-R nof_repetitions [Default %d]\n", nof_repetitions);
+  printf("\t-v [set srsran_verbose to debug, default none]\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "l:i:n:R:v")) != -1) {
+    switch (opt) {
+      case 'l':
+        long_cb = (uint32_t)strtol(optarg, NULL, 10);
+        break;
+      case 'i':
+        nof_iterations = (uint32_t)strtol(optarg, NULL, 10);
+        break;
+      case 'n':
+        noise_std = strtof(optarg, NULL);
+        break;
+      case 'R':
+        nof_repetitions = (uint32_t)strtol(optarg, NULL, 10);
+        break;
+      case 'v':
+        increase_srsran_verbose_level();
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+/* Rearranges natural order LLRs into the sub-block layout produced by the rate-matching (see interleave_table_sb()) */
+static void input_to_sb(const int8_t* input, int8_t* output, uint32_t nof_sb)
+{
+  uint32_t long_sb = long_cb / nof_sb;
+  for (uint32_t i = 0; i < 3 * long_cb; i++) {
+    uint32_t k = i / 3;
+    output[(i % 3) * (long_cb + TDEC_SB_OFFSET) + (k % long_sb) * nof_sb + k / long_sb] = input[i];
+  }
+  for (uint32_t i = 0; i < SRSRAN_TCOD_TOTALTAIL; i++) {
+    output[3 * (long_cb + TDEC_SB_OFFSET) + i] = input[3 * long_cb + i];
+  }
+}
+
+/* Runs nof_repetitions decodings and returns the elapsed time in microseconds, or a negative value on error */
+static double run_impl(const tdec_bench_impl_t* impl,
+                       int16_t*                 llr,
+                       int8_t*                  llr8,
+                       int8_t*                  llr8_sb,
+                       uint8_t*                 data_bytes,
+                       uint8_t*                 output,
+                       uint32_t*                nof_errors)
+{
+  srsran_tdec_t  tdec = {};
+  struct timeval t[3] = {};
+
+  if (srsran_tdec_init_manual(&tdec, long_cb, impl->type)) {
+    return -1.0;
+  }
+
+  uint32_t nof_sb = impl->is_8bit ? tdec.nof_blocks8[0] : tdec.nof_blocks16[0];
+  if (nof_sb > 1 && (long_cb % nof_sb || long_cb / nof_sb < TDEC_WIN_OVERLAP)) {
+    srsran_tdec_free(&tdec);
+    return 0.0;
+  }
+  if (impl->is_8bit) {
+    input_to_sb(llr8, llr8_sb, nof_sb);
+  } else {
+    srsran_tdec_force_not_sb(&tdec);
+  }
+
+  *nof_errors = 0;
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_repetitions; i++) {
+    if (impl->is_8bit) {
+      srsran_tdec_run_all_8bit(&tdec, llr8_sb, output, nof_iterations, long_cb);
+    } else {
+      srsran_tdec_run_all(&tdec, llr, output, nof_iterations, long_cb);
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  for (uint32_t i = 0; i < long_cb / 8; i++) {
+    *nof_errors += __builtin_popcount(output[i] ^ data_bytes[i]);
+  }
+
+  srsran_tdec_free(&tdec);
+  return t[0].tv_sec * 1e6 + t[0].tv_usec;
+}
+
+int main(int argc, char** argv)
+{
+  int             ret        = SRSRAN_ERROR;
+  srsran_random_t random_gen = srsran_random_init(0x1234);
+  srsran_tcod_t   tcod       = {};
+
+  parse_args(argc, argv);
+
+  int cb_idx = srsran_cbsegm_cbindex(long_cb);
+  if (cb_idx < 0) {
+    ERROR("Invalid CB length %d", long_cb);
+    srsran_random_free(random_gen);
+    return SRSRAN_ERROR;
+  }
+
+  uint32_t coded_len  = 3 * long_cb + SRSRAN_TCOD_TOTALTAIL;
+  uint32_t sb_len     = 3 * (long_cb + TDEC_SB_OFFSET) + SRSRAN_TCOD_TOTALTAIL;
+  uint8_t* data_tx    = srsran_vec_u8_malloc(long_cb);
+  uint8_t* data_bytes = srsran_vec_u8_malloc(long_cb / 8);
+  uint8_t* output     = srsran_vec_u8_malloc(long_cb / 8);
+  uint8_t* symbols    = srsran_vec_u8_malloc(coded_len);
+  int16_t* llr        = srsran_vec_i16_malloc(coded_len);
+  int8_t*  llr8       = srsran_vec_i8_malloc(coded_len);
+  int8_t*  llr8_sb    = srsran_vec_i8_malloc(sb_len);
+
+  if (srsran_tcod_init(&tcod, long_cb)) {
+    ERROR("Error initiating turbo coder");
+    goto clean_exit;
+  }
+
+  srsran_random_bit_vector(random_gen, data_tx, long_cb);
+  srsran_bit_pack_vector(data_tx, data_bytes, long_cb);
+  srsran_tcod_encode(&tcod, data_tx, symbols, long_cb);
+  for (uint32_t i = 0; i < coded_len; i++) {
+    float x = (symbols[i] ? 1.0f : -1.0f) + srsran_random_gauss_dist(random_gen, noise_std);
+    llr[i]  = (int16_t)(100.0f * x);
+    llr8[i] = (int8_t)(8.0f * x);
+  }
+  srsran_vec_i8_zero(llr8_sb, sb_len);
+
+  printf("CB length %d, %d iterations, %d repetitions\n", long_cb, nof_iterations, nof_repetitions);
+  printf("%14s %5s %12s %10s %8s\n", "decoder", "llr", "iter/s", "Mbps", "errors");
+  for (uint32_t i = 0; i < sizeof(impl_list) / sizeof(impl_list[0]); i++) {
+    uint32_t nof_errors = 0;
+    double   usec       = run_impl(&impl_list[i], llr, llr8, llr8_sb, data_bytes, output, &nof_errors);
+    if (usec < 0) {
+      ERROR("Error running decoder %s", impl_list[i].name);
+      goto clean_exit;
+    }
+    if (usec == 0) {
+      printf("%14s %5s %12s\n", impl_list[i].name, impl_list[i].is_8bit ? "8" : "16", "n/a");
+      continue;
+    }
+    printf("%14s %5s %12.0f %10.1f %8d\n",
+           impl_list[i].name,
+           impl_list[i].is_8bit ? "8" : "16",
+           (double)nof_repetitions * nof_iterations * 1e6 / usec,
+           (double)nof_repetitions * long_cb / usec,
+           nof_errors);
+  }
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_tcod_free(&tcod);
+  srsran_random_free(random_gen);
+  free(data_tx);
+  free(data_bytes);
+  free(output);
+  free(symbols);
+  free(llr);
+  free(llr8);
+  free(llr8_sb);
+  return ret;
+}
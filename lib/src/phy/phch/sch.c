@@ -217,9 +217,31 @@ void srsran_sch_free(srsran_sch_t* q)
   srsran_tdec_free(&q->decoder);
   srsran_tcod_free(&q->encoder);
   srsran_uci_cqi_free(&q->uci_cqi);
+  srsran_sch_set_decoder_pool(q, NULL);
   bzero(q, sizeof(srsran_sch_t));
 }
 
+int srsran_sch_set_decoder_pool(srsran_sch_t* q, srsran_sch_decoder_pool_t* pool)
+{
+  if (q == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  if (pool != NULL && q->pool_caller_dec == NULL) {
+    q->pool_caller_dec = calloc(1, sizeof(srsran_sch_cb_decoder_t));
+    if (q->pool_caller_dec == NULL || srsran_sch_cb_decoder_init(q->pool_caller_dec)) {
+      ERROR("Error initiating SCH decoder for the pool");
+      srsran_sch_set_decoder_pool(q, NULL);
+      return SRSRAN_ERROR;
+    }
+  } else if (pool == NULL && q->pool_caller_dec != NULL) {
+    srsran_sch_cb_decoder_free(q->pool_caller_dec);
+    free(q->pool_caller_dec);
+    q->pool_caller_dec = NULL;
+  }
+  q->decoder_pool = pool;
+  return SRSRAN_SUCCESS;
+}
+
 void srsran_sch_set_max_noi(srsran_sch_t* q, uint32_t max_iterations)
 {
   if (max_iterations == 0) {
@@ -368,6 +390,152 @@ static int encode_tb(srsran_sch_t*           q,
   return encode_tb_off(q, soft_buffer, cb_segm, Qm, rv, nof_e_bits, data, e_bits, 0);
 }
 
+/* Parameters of the transport block whose code blocks are being decoded */
+typedef struct {
+  srsran_sch_t*           q;
+  srsran_softbuffer_rx_t* softbuffer;
+  srsran_cbsegm_t*        cb_segm;
+  uint32_t                Qm;
+  uint32_t                rv;
+  uint32_t                nof_e_bits;
+  void*                   e_bits;
+  uint8_t*                data;
+  uint32_t                cb_noi[SRSRAN_MAX_CODEBLOCKS];
+} sch_decode_tb_t;
+
+/* Rate dematches code block cb_idx into the softbuffer and, if decode is set, runs the turbo decoder iterations until
+ * the CRC is OK. The decoded code block is written in cb_data, including its CRC */
+static int decode_cb(sch_decode_tb_t* tb,
+                     srsran_tdec_t*   decoder,
+                     srsran_crc_t*    crc_cb,
+                     srsran_crc_t*    crc_tb,
+                     uint32_t         cb_idx,
+                     bool             decode,
+                     uint8_t*         cb_data)
+{
+  srsran_sch_t*           q          = tb->q;
+  srsran_softbuffer_rx_t* softbuffer = tb->softbuffer;
+  srsran_cbsegm_t*        cb_segm    = tb->cb_segm;
+  uint32_t                Qm         = tb->Qm;
+  int8_t*                 e_bits_b   = tb->e_bits;
+  int16_t*                e_bits_s   = tb->e_bits;
+
+  uint32_t cb_len     = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+  uint32_t cb_len_idx = cb_idx < cb_segm->C1 ? cb_segm->K1_idx : cb_segm->K2_idx;
+
+  uint32_t rlen  = cb_segm->C == 1 ? cb_len : (cb_len - 24);
+  uint32_t Gp    = tb->nof_e_bits / Qm;
+  uint32_t gamma = cb_segm->C > 0 ? Gp % cb_segm->C : Gp;
+  uint32_t n_e   = Qm * (Gp / cb_segm->C);
+
+  uint32_t rp   = cb_idx * n_e;
+  uint32_t n_e2 = n_e;
+
+  if (cb_idx > cb_segm->C - gamma) {
+    n_e2 = n_e + Qm;
+    rp   = (cb_segm->C - gamma) * n_e + (cb_idx - (cb_segm->C - gamma)) * n_e2;
+  }
+
+  if (q->llr_is_8bit) {
+    if (srsran_rm_turbo_rx_lut_8bit(&e_bits_b[rp], (int8_t*)softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, tb->rv)) {
+      ERROR("Error in rate matching");
+      return SRSRAN_ERROR;
+    }
+  } else {
+    if (srsran_rm_turbo_rx_lut(&e_bits_s[rp], softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, tb->rv)) {
+      ERROR("Error in rate matching");
+      return SRSRAN_ERROR;
+    }
+  }
+
+  tb->cb_noi[cb_idx] = 0;
+  if (!decode) {
+    return SRSRAN_SUCCESS;
+  }
+
+  srsran_tdec_new_cb(decoder, cb_len);
+
+  // Run iterations and use CRC for early stopping
+  bool     early_stop = false;
+  uint32_t cb_noi     = 0;
+  do {
+    if (q->llr_is_8bit) {
+      srsran_tdec_iteration_8bit(decoder, (int8_t*)softbuffer->buffer_f[cb_idx], cb_data);
+    } else {
+      srsran_tdec_iteration(decoder, softbuffer->buffer_f[cb_idx], cb_data);
+    }
+    cb_noi++;
+
+    uint32_t      len_crc;
+    srsran_crc_t* crc_ptr;
+
+    if (cb_segm->C > 1) {
+      len_crc = cb_len;
+      crc_ptr = crc_cb;
+    } else {
+      len_crc = cb_segm->tbs + 24;
+      crc_ptr = crc_tb;
+    }
+
+    // CRC is OK and ran the minimum number of iterations
+    if (!srsran_crc_checksum_byte(crc_ptr, cb_data, len_crc) && (cb_noi >= SRSRAN_PDSCH_MIN_TDEC_ITERS)) {
+      softbuffer->cb_crc[cb_idx] = true;
+      early_stop                 = true;
+
+      // CRC is error and exceeded maximum iterations for this CB.
+      // Early stop the whole transport block.
+    }
+
+  } while (cb_noi < q->max_iterations && !early_stop);
+  tb->cb_noi[cb_idx] = cb_noi;
+
+  INFO("CB %d: rp=%d, n_e=%d, cb_len=%d, CRC=%s, rlen=%d, iterations=%d/%d",
+       cb_idx,
+       rp,
+       n_e2,
+       cb_len,
+       early_stop ? "OK" : "KO",
+       rlen,
+       cb_noi,
+       q->max_iterations);
+
+  return SRSRAN_SUCCESS;
+}
+
+/* Copies the decoded data of a code block from previous transmissions */
+static void decode_cb_copy_previous(sch_decode_tb_t* tb, uint32_t cb_idx)
+{
+  srsran_cbsegm_t* cb_segm = tb->cb_segm;
+  uint32_t         cb_len  = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+  uint32_t         rlen    = cb_segm->C == 1 ? cb_len : (cb_len - 24);
+  memcpy(&tb->data[cb_idx * rlen / 8], tb->softbuffer->data[cb_idx], rlen / 8 * sizeof(uint8_t));
+  tb->cb_noi[cb_idx] = 0;
+}
+
+/* Decodes one code block in a thread of the decoder pool, or in the calling thread */
+static bool decode_cb_pool_task(void* arg, uint32_t cb_idx, srsran_sch_cb_decoder_t* dec, bool aborted)
+{
+  sch_decode_tb_t* tb = (sch_decode_tb_t*)arg;
+
+  /* Do not process blocks with CRC Ok */
+  if (tb->softbuffer->cb_crc[cb_idx]) {
+    decode_cb_copy_previous(tb, cb_idx);
+    return true;
+  }
+
+  // Once a code block failed, the TB CRC fails as well. The remaining ones are only soft combined for retransmissions
+  if (decode_cb(tb, &dec->decoder, &dec->crc_cb, &dec->crc_tb, cb_idx, !aborted, dec->cb_data)) {
+    return false;
+  }
+  if (!aborted) {
+    // The decoded code blocks may overlap by the CRC length, so only their data is copied into the TB
+    uint32_t cb_len = cb_idx < tb->cb_segm->C1 ? tb->cb_segm->K1 : tb->cb_segm->K2;
+    uint32_t rlen   = tb->cb_segm->C == 1 ? cb_len : (cb_len - 24);
+    memcpy(&tb->data[cb_idx * rlen / 8], dec->cb_data, rlen / 8 * sizeof(uint8_t));
+  }
+  return tb->softbuffer->cb_crc[cb_idx];
+}
+
 bool decode_tb_cb(srsran_sch_t*           q,
                   srsran_softbuffer_rx_t* softbuffer,
                   srsran_cbsegm_t*        cb_segm,
@@ -377,102 +545,39 @@ bool decode_tb_cb(srsran_sch_t*           q,
                   void*                   e_bits,
                   uint8_t*                data)
 {
-  int8_t*  e_bits_b = e_bits;
-  int16_t* e_bits_s = e_bits;
-
   if (cb_segm->C > SRSRAN_MAX_CODEBLOCKS) {
     ERROR("Error SRSRAN_MAX_CODEBLOCKS=%d", SRSRAN_MAX_CODEBLOCKS);
     return false;
   }
 
-  q->avg_iterations = 0;
-
-  for (int cb_idx = 0; cb_idx < cb_segm->C; cb_idx++) {
-    /* Do not process blocks with CRC Ok */
-    if (softbuffer->cb_crc[cb_idx] == false) {
-      uint32_t cb_len     = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
-      uint32_t cb_len_idx = cb_idx < cb_segm->C1 ? cb_segm->K1_idx : cb_segm->K2_idx;
-
-      uint32_t rlen  = cb_segm->C == 1 ? cb_len : (cb_len - 24);
-      uint32_t Gp    = nof_e_bits / Qm;
-      uint32_t gamma = cb_segm->C > 0 ? Gp % cb_segm->C : Gp;
-      uint32_t n_e   = Qm * (Gp / cb_segm->C);
+  sch_decode_tb_t tb = {q, softbuffer, cb_segm, Qm, rv, nof_e_bits, e_bits, data, {}};
 
-      uint32_t rp   = cb_idx * n_e;
-      uint32_t n_e2 = n_e;
-
-      if (cb_idx > cb_segm->C - gamma) {
-        n_e2 = n_e + Qm;
-        rp   = (cb_segm->C - gamma) * n_e + (cb_idx - (cb_segm->C - gamma)) * n_e2;
-      }
-
-      if (q->llr_is_8bit) {
-        if (srsran_rm_turbo_rx_lut_8bit(&e_bits_b[rp], (int8_t*)softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching");
+  if (q->decoder_pool != NULL && q->pool_caller_dec != NULL && cb_segm->C > 1) {
+    srsran_sch_decoder_pool_job_t job = {};
+    job.fn                            = decode_cb_pool_task;
+    job.arg                           = &tb;
+    job.nof_tasks                     = cb_segm->C;
+    srsran_sch_decoder_pool_run(q->decoder_pool, &job, q->pool_caller_dec);
+  } else {
+    for (uint32_t cb_idx = 0; cb_idx < cb_segm->C; cb_idx++) {
+      /* Do not process blocks with CRC Ok */
+      if (softbuffer->cb_crc[cb_idx] == false) {
+        uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+        uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
+        if (decode_cb(&tb, &q->decoder, &q->crc_cb, &q->crc_tb, cb_idx, true, &data[cb_idx * rlen / 8])) {
           return SRSRAN_ERROR;
         }
       } else {
-        if (srsran_rm_turbo_rx_lut(&e_bits_s[rp], softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching");
-          return SRSRAN_ERROR;
-        }
+        decode_cb_copy_previous(&tb, cb_idx);
       }
-
-      srsran_tdec_new_cb(&q->decoder, cb_len);
-
-      // Run iterations and use CRC for early stopping
-      bool     early_stop = false;
-      uint32_t cb_noi     = 0;
-      do {
-        if (q->llr_is_8bit) {
-          srsran_tdec_iteration_8bit(&q->decoder, (int8_t*)softbuffer->buffer_f[cb_idx], &data[cb_idx * rlen / 8]);
-        } else {
-          srsran_tdec_iteration(&q->decoder, softbuffer->buffer_f[cb_idx], &data[cb_idx * rlen / 8]);
-        }
-        q->avg_iterations++;
-        cb_noi++;
-
-        uint32_t      len_crc;
-        srsran_crc_t* crc_ptr;
-
-        if (cb_segm->C > 1) {
-          len_crc = cb_len;
-          crc_ptr = &q->crc_cb;
-        } else {
-          len_crc = cb_segm->tbs + 24;
-          crc_ptr = &q->crc_tb;
-        }
-
-        // CRC is OK and ran the minimum number of iterations
-        if (!srsran_crc_checksum_byte(crc_ptr, &data[cb_idx * rlen / 8], len_crc) &&
-            (cb_noi >= SRSRAN_PDSCH_MIN_TDEC_ITERS)) {
-          softbuffer->cb_crc[cb_idx] = true;
-          early_stop                 = true;
-
-          // CRC is error and exceeded maximum iterations for this CB.
-          // Early stop the whole transport block.
-        }
-
-      } while (cb_noi < q->max_iterations && !early_stop);
-
-      INFO("CB %d: rp=%d, n_e=%d, cb_len=%d, CRC=%s, rlen=%d, iterations=%d/%d",
-           cb_idx,
-           rp,
-           n_e2,
-           cb_len,
-           early_stop ? "OK" : "KO",
-           rlen,
-           cb_noi,
-           q->max_iterations);
-
-    } else {
-      // Copy decoded data from previous transmissions
-      uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
-      uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
-      memcpy(&data[cb_idx * rlen / 8], softbuffer->data[cb_idx], rlen / 8 * sizeof(uint8_t));
     }
   }
 
+  q->avg_iterations = 0;
+  for (uint32_t i = 0; i < cb_segm->C; i++) {
+    q->avg_iterations += tb.cb_noi[i];
+  }
+
   softbuffer->tb_crc = true;
   for (int i = 0; i < cb_segm->C && softbuffer->tb_crc; i++) {
     /* If one CB failed return false */
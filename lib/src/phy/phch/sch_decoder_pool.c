@@ -0,0 +1,264 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/phy/phch/sch_decoder_pool.h"
+#include "srsran/phy/common/phy_common.h"
+#include "srsran/phy/fec/turbo/turbocoder.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  pthread_t               pthread;
+  srsran_sch_cb_decoder_t dec;
+  void*                   pool;
+} sch_decoder_pool_thread_t;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cvar_work; // New job or quit
+  pthread_cond_t  cvar_done; // A job completed
+
+  // Queue of jobs with tasks left to start
+  srsran_sch_decoder_pool_job_t* head;
+  srsran_sch_decoder_pool_job_t* tail;
+
+  sch_decoder_pool_thread_t* threads;
+  uint32_t                   nof_started;
+  bool                       quit;
+} sch_decoder_pool_impl_t;
+
+int srsran_sch_cb_decoder_init(srsran_sch_cb_decoder_t* dec)
+{
+  if (dec == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  memset(dec, 0, sizeof(srsran_sch_cb_decoder_t));
+  if (srsran_crc_init(&dec->crc_tb, SRSRAN_LTE_CRC24A, 24)) {
+    ERROR("Error initiating CRC");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_crc_init(&dec->crc_cb, SRSRAN_LTE_CRC24B, 24)) {
+    ERROR("Error initiating CRC");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_tdec_init(&dec->decoder, SRSRAN_TCOD_MAX_LEN_CB)) {
+    ERROR("Error initiating Turbo Decoder");
+    return SRSRAN_ERROR;
+  }
+  dec->cb_data = srsran_vec_u8_malloc((SRSRAN_TCOD_MAX_LEN_CB + 8) / 8);
+  if (dec->cb_data == NULL) {
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+void srsran_sch_cb_decoder_free(srsran_sch_cb_decoder_t* dec)
+{
+  if (dec != NULL) {
+    srsran_tdec_free(&dec->decoder);
+    if (dec->cb_data) {
+      free(dec->cb_data);
+    }
+    memset(dec, 0, sizeof(srsran_sch_cb_decoder_t));
+  }
+}
+
+// Takes the next task of a job and removes the job from the queue once all its tasks are started. Lock must be held
+static uint32_t pool_take_task(sch_decoder_pool_impl_t* h, srsran_sch_decoder_pool_job_t* job, bool* aborted)
+{
+  uint32_t task_idx = job->next_task++;
+  *aborted          = job->aborted;
+
+  if (job->next_task == job->nof_tasks) {
+    srsran_sch_decoder_pool_job_t* prev = NULL;
+    srsran_sch_decoder_pool_job_t* it   = h->head;
+    while (it != NULL && it != job) {
+      prev = it;
+      it   = it->next_job;
+    }
+    if (it != NULL) {
+      if (prev == NULL) {
+        h->head = it->next_job;
+      } else {
+        prev->next_job = it->next_job;
+      }
+      if (h->tail == it) {
+        h->tail = prev;
+      }
+      it->next_job = NULL;
+    }
+  }
+  return task_idx;
+}
+
+// Runs a task without the lock and accounts for it. Lock must be held
+static void pool_run_task(sch_decoder_pool_impl_t*       h,
+                          srsran_sch_decoder_pool_job_t* job,
+                          srsran_sch_cb_decoder_t*       dec)
+{
+  bool     aborted  = false;
+  uint32_t task_idx = pool_take_task(h, job, &aborted);
+
+  pthread_mutex_unlock(&h->mutex);
+  bool ok = job->fn(job->arg, task_idx, dec, aborted);
+  pthread_mutex_lock(&h->mutex);
+
+  if (!ok) {
+    job->aborted = true;
+  }
+  job->nof_done++;
+  if (job->nof_done == job->nof_tasks) {
+    pthread_cond_broadcast(&h->cvar_done);
+  }
+}
+
+static void* sch_decoder_pool_thread(void* arg)
+{
+  sch_decoder_pool_thread_t* t = (sch_decoder_pool_thread_t*)arg;
+  sch_decoder_pool_impl_t*   h = (sch_decoder_pool_impl_t*)t->pool;
+
+  pthread_mutex_lock(&h->mutex);
+  while (!h->quit) {
+    if (h->head != NULL) {
+      pool_run_task(h, h->head, &t->dec);
+    } else {
+      pthread_cond_wait(&h->cvar_work, &h->mutex);
+    }
+  }
+  pthread_mutex_unlock(&h->mutex);
+  return NULL;
+}
+
+void srsran_sch_decoder_pool_free(srsran_sch_decoder_pool_t* q)
+{
+  if (q == NULL || q->impl == NULL) {
+    return;
+  }
+  sch_decoder_pool_impl_t* h = (sch_decoder_pool_impl_t*)q->impl;
+
+  pthread_mutex_lock(&h->mutex);
+  h->quit = true;
+  pthread_cond_broadcast(&h->cvar_work);
+  pthread_mutex_unlock(&h->mutex);
+
+  for (uint32_t i = 0; i < h->nof_started; i++) {
+    pthread_join(h->threads[i].pthread, NULL);
+  }
+  for (uint32_t i = 0; i < q->nof_threads; i++) {
+    srsran_sch_cb_decoder_free(&h->threads[i].dec);
+  }
+  free(h->threads);
+
+  pthread_cond_destroy(&h->cvar_done);
+  pthread_cond_destroy(&h->cvar_work);
+  pthread_mutex_destroy(&h->mutex);
+  free(h);
+  q->impl = NULL;
+}
+
+int srsran_sch_decoder_pool_init(srsran_sch_decoder_pool_t* q, uint32_t nof_threads)
+{
+  if (q == NULL || nof_threads == 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  q->nof_threads = nof_threads;
+
+  sch_decoder_pool_impl_t* h = calloc(1, sizeof(sch_decoder_pool_impl_t));
+  if (h == NULL) {
+    ERROR("Allocating SCH decoder pool");
+    return SRSRAN_ERROR;
+  }
+  q->impl = h;
+  pthread_mutex_init(&h->mutex, NULL);
+  pthread_cond_init(&h->cvar_work, NULL);
+  pthread_cond_init(&h->cvar_done, NULL);
+
+  h->threads = calloc(nof_threads, sizeof(sch_decoder_pool_thread_t));
+  if (h->threads == NULL) {
+    ERROR("Allocating SCH decoder pool threads");
+    srsran_sch_decoder_pool_free(q);
+    return SRSRAN_ERROR;
+  }
+
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    sch_decoder_pool_thread_t* t = &h->threads[i];
+    t->pool                      = h;
+    if (srsran_sch_cb_decoder_init(&t->dec)) {
+      srsran_sch_decoder_pool_free(q);
+      return SRSRAN_ERROR;
+    }
+    if (pthread_create(&t->pthread, NULL, sch_decoder_pool_thread, t)) {
+      ERROR("Creating SCH decoder pool thread");
+      srsran_sch_decoder_pool_free(q);
+      return SRSRAN_ERROR;
+    }
+    h->nof_started++;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+bool srsran_sch_decoder_pool_run(srsran_sch_decoder_pool_t*     q,
+                                 srsran_sch_decoder_pool_job_t* job,
+                                 srsran_sch_cb_decoder_t*       caller_dec)
+{
+  if (q == NULL || q->impl == NULL || job == NULL || caller_dec == NULL) {
+    return false;
+  }
+  sch_decoder_pool_impl_t* h = (sch_decoder_pool_impl_t*)q->impl;
+
+  job->next_task = 0;
+  job->nof_done  = 0;
+  job->aborted   = false;
+  job->next_job  = NULL;
+  if (job->nof_tasks == 0) {
+    return true;
+  }
+
+  pthread_mutex_lock(&h->mutex);
+
+  // Queue the job for the pool threads, unless it is a single task
+  if (job->nof_tasks > 1) {
+    if (h->tail == NULL) {
+      h->head = job;
+    } else {
+      h->tail->next_job = job;
+    }
+    h->tail = job;
+    pthread_cond_broadcast(&h->cvar_work);
+  }
+
+  // Run tasks in the calling thread while there are some left
+  while (job->next_task < job->nof_tasks) {
+    pool_run_task(h, job, caller_dec);
+  }
+
+  // Wait for the tasks running in the pool threads
+  while (job->nof_done < job->nof_tasks) {
+    pthread_cond_wait(&h->cvar_done, &h->mutex);
+  }
+  bool ok = !job->aborted;
+  pthread_mutex_unlock(&h->mutex);
+
+  return ok;
+}
@@ -0,0 +1,312 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/phch/sch.h"
+#include "srsran/phy/utils/bit.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/vector.h"
+
+#define TBS_IDX 20
+#define NOF_RE_X_PRB 120
+
+static uint32_t nof_prb_list[] = {6, 15, 25, 50, 75, 100};
+static uint32_t nof_repetitions = 100;
+static uint32_t max_threads     = 4;
+static float    snr_db          = 10.0f;
+static float    harq_snr_db     = 2.0f;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [ntshv]\n", prog);
+  printf("\t-n Number of decoded transport blocks per size [Default %d]\n", nof_repetitions);
+  printf("\t-t Maximum number of decoder pool threads [Default %d]\n", max_threads);
+  printf("\t-s SNR in dB [Default %.1f]\n", snr_db);
+  printf("\t-h SNR in dB of each transmission of the HARQ checks [Default %.1f]\n", harq_snr_db);
+  printf("\t-v [set srsran_verbose to debug, default none]\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "n:t:s:h:v")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_repetitions = (uint32_t)strtol(optarg, NULL, 10);
+        break;
+      case 't':
+        max_threads = (uint32_t)strtol(optarg, NULL, 10);
+        break;
+      case 's':
+        snr_db = strtof(optarg, NULL);
+        break;
+      case 'h':
+        harq_snr_db = strtof(optarg, NULL);
+        break;
+      case 'v':
+        increase_srsran_verbose_level();
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+/* Decodes the same transport block nof_repetitions times and returns the average latency in microseconds, or a
+ * negative value if any of them is not decoded correctly */
+static double run_decoder(srsran_sch_t*           sch,
+                          srsran_pdsch_cfg_t*     cfg,
+                          srsran_softbuffer_rx_t* softbuffer,
+                          int16_t*                llr,
+                          uint8_t*                data_tx,
+                          uint8_t*                data_rx)
+{
+  struct timeval t[3] = {};
+  double         usec = 0;
+
+  for (uint32_t i = 0; i < nof_repetitions; i++) {
+    srsran_softbuffer_rx_reset_tbs(softbuffer, cfg->grant.tb[0].tbs);
+    memset(data_rx, 0, cfg->grant.tb[0].tbs / 8);
+
+    gettimeofday(&t[1], NULL);
+    int ret = srsran_dlsch_decode(sch, cfg, llr, data_rx);
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    usec += t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+    if (ret != SRSRAN_SUCCESS || memcmp(data_tx, data_rx, cfg->grant.tb[0].tbs / 8) != 0) {
+      return -1.0;
+    }
+  }
+  return usec / nof_repetitions;
+}
+
+/* Generates the LLR of the encoded bits e_bits with the given amplitude and SNR */
+static void
+gen_llr(srsran_random_t random_gen, uint8_t* e_bits, uint32_t nof_bits, float amplitude, float snr, int16_t* llr)
+{
+  float std_dev = amplitude * powf(10.0f, -snr / 20.0f);
+  for (uint32_t i = 0; i < nof_bits; i++) {
+    llr[i] = (int16_t)((e_bits[i] ? amplitude : -amplitude) + srsran_random_gauss_dist(random_gen, std_dev));
+  }
+}
+
+/* Checks the decoding of transport blocks with failed code blocks, which the decoder pool aborts:
+ * - Low SNR: two transmissions that do not decode on their own, but do once soft combined. All the code blocks of the
+ *   first transmission, including the aborted ones, must be combined into the softbuffer.
+ * - Mixed CB: only the last code block of the first transmission is noisy. The code blocks decoded in the first
+ *   transmission are then copied from the softbuffer by the retransmission.
+ * Returns SRSRAN_ERROR if any of the transmissions gives an unexpected result */
+static int run_harq_check(srsran_sch_t*           sch,
+                          srsran_pdsch_cfg_t*     cfg,
+                          srsran_softbuffer_rx_t* softbuffer,
+                          int16_t*                llr_tx[2],
+                          int16_t*                llr_mixed,
+                          int16_t*                llr_clean,
+                          uint8_t*                data_tx,
+                          uint8_t*                data_rx)
+{
+  uint32_t tbs = cfg->grant.tb[0].tbs;
+
+  // Low SNR
+  srsran_softbuffer_rx_reset_tbs(softbuffer, tbs);
+  if (srsran_dlsch_decode(sch, cfg, llr_tx[0], data_rx) == SRSRAN_SUCCESS) {
+    ERROR("Low SNR: first transmission decoded");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_dlsch_decode(sch, cfg, llr_tx[1], data_rx) != SRSRAN_SUCCESS || memcmp(data_tx, data_rx, tbs / 8) != 0) {
+    ERROR("Low SNR: combined transmissions not decoded");
+    return SRSRAN_ERROR;
+  }
+
+  // Mixed CB
+  srsran_softbuffer_rx_reset_tbs(softbuffer, tbs);
+  if (srsran_dlsch_decode(sch, cfg, llr_mixed, data_rx) == SRSRAN_SUCCESS) {
+    ERROR("Mixed CB: first transmission decoded");
+    return SRSRAN_ERROR;
+  }
+  memset(data_rx, 0, tbs / 8);
+  if (srsran_dlsch_decode(sch, cfg, llr_clean, data_rx) != SRSRAN_SUCCESS || memcmp(data_tx, data_rx, tbs / 8) != 0) {
+    ERROR("Mixed CB: retransmission not decoded");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  int                    ret         = SRSRAN_ERROR;
+  srsran_random_t        random_gen  = srsran_random_init(0x1234);
+  srsran_sch_t           sch_tx      = {};
+  srsran_sch_t           sch_rx      = {};
+  srsran_softbuffer_tx_t sb_tx       = {};
+  srsran_softbuffer_rx_t sb_rx       = {};
+  uint32_t               max_bits    = SRSRAN_MAX_PRB * NOF_RE_X_PRB * 6;
+  uint8_t*               data_tx     = srsran_vec_u8_malloc(max_bits / 8);
+  uint8_t*               data_rx     = srsran_vec_u8_malloc(max_bits / 8);
+  uint8_t*               e_bytes     = srsran_vec_u8_malloc(max_bits / 8);
+  uint8_t*               e_bits      = srsran_vec_u8_malloc(max_bits);
+  int16_t*               llr         = srsran_vec_i16_malloc(max_bits);
+  int16_t*               llr_harq[2] = {srsran_vec_i16_malloc(max_bits), srsran_vec_i16_malloc(max_bits)};
+  int16_t*               llr_mixed   = srsran_vec_i16_malloc(max_bits);
+
+  parse_args(argc, argv);
+
+  if (!data_tx || !data_rx || !e_bytes || !e_bits || !llr || !llr_harq[0] || !llr_harq[1] || !llr_mixed) {
+    ERROR("Error allocating buffers");
+    goto clean_exit;
+  }
+  if (srsran_sch_init(&sch_tx) || srsran_sch_init(&sch_rx)) {
+    ERROR("Error initiating SCH");
+    goto clean_exit;
+  }
+  if (srsran_softbuffer_tx_init(&sb_tx, SRSRAN_MAX_PRB) || srsran_softbuffer_rx_init(&sb_rx, SRSRAN_MAX_PRB)) {
+    ERROR("Error initiating softbuffers");
+    goto clean_exit;
+  }
+
+  // BPSK equivalent channel, the LLR amplitude is scaled so that the soft bits do not saturate
+  float amplitude = 100.0f;
+
+  printf("  TBS   CB |  serial");
+  for (uint32_t nof_threads = 1; nof_threads <= max_threads; nof_threads++) {
+    printf(" | %d thread%s", nof_threads, nof_threads > 1 ? "s" : " ");
+  }
+  printf("   (us/TB)\n");
+
+  for (uint32_t p = 0; p < sizeof(nof_prb_list) / sizeof(nof_prb_list[0]); p++) {
+    srsran_pdsch_cfg_t cfg = {};
+    cfg.grant.nof_tb       = 1;
+    cfg.grant.tb[0].mod    = SRSRAN_MOD_64QAM;
+    cfg.grant.tb[0].tbs    = srsran_ra_tbs_from_idx(TBS_IDX, nof_prb_list[p]);
+    cfg.grant.tb[0].nof_bits    = nof_prb_list[p] * NOF_RE_X_PRB * 6;
+    cfg.grant.tb[0].rv          = 0;
+    cfg.grant.tb[0].enabled     = true;
+    cfg.softbuffers.tx[0]       = &sb_tx;
+    uint32_t        tbs         = cfg.grant.tb[0].tbs;
+    srsran_cbsegm_t cb_segm     = {};
+    srsran_cbsegm(&cb_segm, tbs);
+
+    // Encode random data and convert it to LLR
+    srsran_random_byte_vector(random_gen, data_tx, tbs / 8);
+    srsran_softbuffer_tx_reset_tbs(&sb_tx, tbs);
+    if (srsran_dlsch_encode(&sch_tx, &cfg, data_tx, e_bytes)) {
+      ERROR("Error encoding TBS=%d", tbs);
+      goto clean_exit;
+    }
+    uint32_t nof_bits = cfg.grant.tb[0].nof_bits;
+    srsran_bit_unpack_vector(e_bytes, e_bits, nof_bits);
+    gen_llr(random_gen, e_bits, nof_bits, amplitude, snr_db, llr);
+    gen_llr(random_gen, e_bits, nof_bits, amplitude, harq_snr_db, llr_harq[0]);
+    gen_llr(random_gen, e_bits, nof_bits, amplitude, harq_snr_db, llr_harq[1]);
+
+    // The last code block gets at least the last Qm * floor(G / (Qm * C)) bits. They are replaced by weak and noisy
+    // LLRs, which make the code block fail without preventing its decoding once combined with a clean retransmission
+    uint32_t Qm        = srsran_mod_bits_x_symbol(cfg.grant.tb[0].mod);
+    uint32_t last_bits = Qm * (nof_bits / (Qm * cb_segm.C));
+    memcpy(llr_mixed, llr, sizeof(int16_t) * (nof_bits - last_bits));
+    gen_llr(random_gen,
+            &e_bits[nof_bits - last_bits],
+            last_bits,
+            amplitude / 10,
+            -10.0f,
+            &llr_mixed[nof_bits - last_bits]);
+    cfg.softbuffers.rx[0] = &sb_rx;
+
+    srsran_sch_set_decoder_pool(&sch_rx, NULL);
+    double usec = run_decoder(&sch_rx, &cfg, &sb_rx, llr, data_tx, data_rx);
+    if (usec < 0) {
+      ERROR("Error decoding TBS=%d in serial", tbs);
+      goto clean_exit;
+    }
+    if (run_harq_check(&sch_rx, &cfg, &sb_rx, llr_harq, llr_mixed, llr, data_tx, data_rx)) {
+      ERROR("Error in HARQ check of TBS=%d in serial", tbs);
+      goto clean_exit;
+    }
+    printf("%6d  %2d | %7.1f", tbs, cb_segm.C, usec);
+
+    for (uint32_t nof_threads = 1; nof_threads <= max_threads; nof_threads++) {
+      srsran_sch_decoder_pool_t pool = {};
+      if (srsran_sch_decoder_pool_init(&pool, nof_threads) || srsran_sch_set_decoder_pool(&sch_rx, &pool)) {
+        ERROR("Error initiating decoder pool with %d threads", nof_threads);
+        srsran_sch_decoder_pool_free(&pool);
+        goto clean_exit;
+      }
+      usec         = run_decoder(&sch_rx, &cfg, &sb_rx, llr, data_tx, data_rx);
+      int harq_ret = run_harq_check(&sch_rx, &cfg, &sb_rx, llr_harq, llr_mixed, llr, data_tx, data_rx);
+      srsran_sch_set_decoder_pool(&sch_rx, NULL);
+      srsran_sch_decoder_pool_free(&pool);
+      if (usec < 0) {
+        ERROR("Error decoding TBS=%d with %d threads", tbs, nof_threads);
+        goto clean_exit;
+      }
+      if (harq_ret) {
+        ERROR("Error in HARQ check of TBS=%d with %d threads", tbs, nof_threads);
+        goto clean_exit;
+      }
+      printf(" | %9.1f", usec);
+    }
+    printf("\n");
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_softbuffer_tx_free(&sb_tx);
+  srsran_softbuffer_rx_free(&sb_rx);
+  srsran_sch_free(&sch_tx);
+  srsran_sch_free(&sch_rx);
+  srsran_random_free(random_gen);
+  if (data_tx) {
+    free(data_tx);
+  }
+  if (data_rx) {
+    free(data_rx);
+  }
+  if (e_bytes) {
+    free(e_bytes);
+  }
+  if (e_bits) {
+    free(e_bits);
+  }
+  if (llr) {
+    free(llr);
+  }
+  for (uint32_t i = 0; i < 2; i++) {
+    if (llr_harq[i]) {
+      free(llr_harq[i]);
+    }
+  }
+  if (llr_mixed) {
+    free(llr_mixed);
+  }
+
+  printf("%s\n", ret == SRSRAN_SUCCESS ? "Ok" : "Error");
+  return ret;
+}
@@ -79,7 +79,7 @@ public:
 
   float gauss_dist(float sigma)
   {
-    std::normal_distribution<float> dist(sigma);
+    std::normal_distribution<float> dist(0.0f, sigma);
     return dist(*mt19937);
   }
 };
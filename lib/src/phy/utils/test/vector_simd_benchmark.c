@@ -0,0 +1,399 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Benchmarks the vector SIMD kernels with every ISA available in this build and CPU. The output of each ISA is checked
+ * against the generic kernels for every length up to CHECK_MAX_LEN and for the block size, so that the tails that do
+ * not fill a SIMD register are covered. With -i, only the given ISA is checked and benchmarked against the generic one.
+ */
+
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/vector.h"
+#include "srsran/phy/utils/vector_simd.h"
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static uint32_t    block_size      = 2048;
+static uint32_t    nof_repetitions = 1000;
+static const char* test_isa_name   = NULL;
+
+#define MAX_ERROR (1e-3f)
+
+/* Covers a few full registers of the widest ISA (64 bytes) for every element size, plus all the possible tails */
+#define CHECK_MAX_LEN (4 * 64 + 3)
+
+/* Kernel inputs and outputs */
+static float*          x_f;
+static float*          y_f;
+static float*          z_f;
+static cf_t*           x_c;
+static cf_t*           y_c;
+static cf_t*           z_c;
+static int16_t*        x_s;
+static int16_t*        y_s;
+static int16_t*        z_s;
+static int8_t*         x_b;
+static int8_t*         y_b;
+static int8_t*         z_b;
+static unsigned short* lut;
+static cf_t            z_scalar;
+
+/* Kernel output used for checking the ISA variants. The scalar results are stored in z_scalar, with the integer ones
+ * truncated to the width of the SIMD accumulators */
+typedef enum { OUTPUT_F = 0, OUTPUT_C, OUTPUT_S, OUTPUT_B, OUTPUT_SCALAR } output_t;
+
+typedef struct {
+  const char* name;
+  void (*run)(uint32_t len);
+  output_t output;
+} kernel_t;
+
+#define KERNEL(NAME, CODE)                                                                                             \
+  static void run_##NAME(uint32_t len) { CODE; }
+
+KERNEL(xor_bbb, srsran_vec_xor_bbb_simd((uint8_t*)x_b, (uint8_t*)y_b, (uint8_t*)z_b, len))
+KERNEL(sum_sss, srsran_vec_sum_sss_simd(x_s, y_s, z_s, len))
+KERNEL(sub_sss, srsran_vec_sub_sss_simd(x_s, y_s, z_s, len))
+KERNEL(prod_sss, srsran_vec_prod_sss_simd(x_s, y_s, z_s, len))
+KERNEL(neg_sss, srsran_vec_neg_sss_simd(x_s, y_s, z_s, len))
+KERNEL(neg_bbb, srsran_vec_neg_bbb_simd(x_b, y_b, z_b, len))
+KERNEL(dot_prod_sss, z_scalar = (int16_t)srsran_vec_dot_prod_sss_simd(x_s, y_s, len))
+KERNEL(lut_sss, srsran_vec_lut_sss_simd(x_s, lut, z_s, len))
+KERNEL(acc_ff, z_scalar = srsran_vec_acc_ff_simd(x_f, len))
+KERNEL(acc_cc, z_scalar = srsran_vec_acc_cc_simd(x_c, len))
+KERNEL(add_fff, srsran_vec_add_fff_simd(x_f, y_f, z_f, len))
+KERNEL(sub_fff, srsran_vec_sub_fff_simd(x_f, y_f, z_f, len))
+KERNEL(prod_fff, srsran_vec_prod_fff_simd(x_f, y_f, z_f, len))
+KERNEL(div_fff, srsran_vec_div_fff_simd(x_f, y_f, z_f, len))
+KERNEL(sc_prod_fff, srsran_vec_sc_prod_fff_simd(x_f, 0.5f, z_f, len))
+KERNEL(sc_prod_cfc, srsran_vec_sc_prod_cfc_simd(x_c, 0.5f, z_c, len))
+KERNEL(sc_prod_ccc, srsran_vec_sc_prod_ccc_simd(x_c, 0.5f + 0.25f * I, z_c, len))
+KERNEL(prod_cfc, srsran_vec_prod_cfc_simd(x_c, y_f, z_c, len))
+KERNEL(prod_ccc, srsran_vec_prod_ccc_simd(x_c, y_c, z_c, len))
+KERNEL(prod_conj_ccc, srsran_vec_prod_conj_ccc_simd(x_c, y_c, z_c, len))
+KERNEL(div_ccc, srsran_vec_div_ccc_simd(x_c, y_c, z_c, len))
+KERNEL(div_cfc, srsran_vec_div_cfc_simd(x_c, y_f, z_c, len))
+KERNEL(dot_prod_ccc, z_scalar = srsran_vec_dot_prod_ccc_simd(x_c, y_c, len))
+KERNEL(dot_prod_conj_ccc, z_scalar = srsran_vec_dot_prod_conj_ccc_simd(x_c, y_c, len))
+KERNEL(abs_cf, srsran_vec_abs_cf_simd(x_c, z_f, len))
+KERNEL(abs_square_cf, srsran_vec_abs_square_cf_simd(x_c, z_f, len))
+KERNEL(convert_if, srsran_vec_convert_if_simd(x_s, z_f, 1.0f / 256.0f, len))
+KERNEL(convert_fi, srsran_vec_convert_fi_simd(x_f, z_s, 256.0f, len))
+KERNEL(convert_fb, srsran_vec_convert_fb_simd(x_f, z_b, 64.0f, len))
+// Interleaves two halves of the input in the output, the SSE kernel does not support empty inputs
+KERNEL(interleave, if (len >= 2) { srsran_vec_interleave_simd(x_c, y_c, z_c, len / 2); })
+KERNEL(apply_cfo, srsran_vec_apply_cfo_simd(x_c, 0.01f, z_c, len))
+KERNEL(estimate_frequency, z_scalar = srsran_vec_estimate_frequency_simd(x_c, len))
+KERNEL(max_fi, z_scalar = srsran_vec_max_fi_simd(x_f, len))
+KERNEL(max_abs_fi, z_scalar = srsran_vec_max_abs_fi_simd(x_f, len))
+KERNEL(max_ci, z_scalar = srsran_vec_max_ci_simd(x_c, len))
+
+#define KERNEL_ENTRY(NAME, OUTPUT)                                                                                     \
+  {                                                                                                                    \
+    #NAME, run_##NAME, OUTPUT                                                                                          \
+  }
+
+static const kernel_t kernels[] = {KERNEL_ENTRY(xor_bbb, OUTPUT_B),
+                                   KERNEL_ENTRY(sum_sss, OUTPUT_S),
+                                   KERNEL_ENTRY(sub_sss, OUTPUT_S),
+                                   KERNEL_ENTRY(prod_sss, OUTPUT_S),
+                                   KERNEL_ENTRY(neg_sss, OUTPUT_S),
+                                   KERNEL_ENTRY(neg_bbb, OUTPUT_B),
+                                   KERNEL_ENTRY(dot_prod_sss, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(lut_sss, OUTPUT_S),
+                                   KERNEL_ENTRY(acc_ff, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(acc_cc, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(add_fff, OUTPUT_F),
+                                   KERNEL_ENTRY(sub_fff, OUTPUT_F),
+                                   KERNEL_ENTRY(prod_fff, OUTPUT_F),
+                                   KERNEL_ENTRY(div_fff, OUTPUT_F),
+                                   KERNEL_ENTRY(sc_prod_fff, OUTPUT_F),
+                                   KERNEL_ENTRY(sc_prod_cfc, OUTPUT_C),
+                                   KERNEL_ENTRY(sc_prod_ccc, OUTPUT_C),
+                                   KERNEL_ENTRY(prod_cfc, OUTPUT_C),
+                                   KERNEL_ENTRY(prod_ccc, OUTPUT_C),
+                                   KERNEL_ENTRY(prod_conj_ccc, OUTPUT_C),
+                                   KERNEL_ENTRY(div_ccc, OUTPUT_C),
+                                   KERNEL_ENTRY(div_cfc, OUTPUT_C),
+                                   KERNEL_ENTRY(dot_prod_ccc, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(dot_prod_conj_ccc, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(abs_cf, OUTPUT_F),
+                                   KERNEL_ENTRY(abs_square_cf, OUTPUT_F),
+                                   KERNEL_ENTRY(convert_if, OUTPUT_F),
+                                   KERNEL_ENTRY(convert_fi, OUTPUT_S),
+                                   KERNEL_ENTRY(convert_fb, OUTPUT_B),
+                                   KERNEL_ENTRY(interleave, OUTPUT_C),
+                                   KERNEL_ENTRY(apply_cfo, OUTPUT_C),
+                                   KERNEL_ENTRY(estimate_frequency, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(max_fi, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(max_abs_fi, OUTPUT_SCALAR),
+                                   KERNEL_ENTRY(max_ci, OUTPUT_SCALAR)};
+
+#define NOF_KERNELS (sizeof(kernels) / sizeof(kernel_t))
+
+void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-n Block size [Default %d]\n", block_size);
+  printf("\t-r Number of repetitions [Default %d]\n", nof_repetitions);
+  printf("\t-i Only check and benchmark this ISA against the generic one [Default all available]\n");
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "nri")) != -1) {
+    switch (opt) {
+      case 'n':
+        block_size = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'r':
+        nof_repetitions = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'i':
+        test_isa_name = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static double elapsed_us(struct timeval* ts_start, struct timeval* ts_end)
+{
+  return ((double)ts_end->tv_sec - (double)ts_start->tv_sec) * 1000000 + (double)ts_end->tv_usec -
+         (double)ts_start->tv_usec;
+}
+
+/* Copies the output of the kernel as complex values, so the outputs of all kernels are compared in the same way */
+static void save_output(const kernel_t* kernel, uint32_t len, cf_t* output)
+{
+  for (uint32_t i = 0; i < len; i++) {
+    switch (kernel->output) {
+      case OUTPUT_F:
+        output[i] = z_f[i];
+        break;
+      case OUTPUT_C:
+        output[i] = z_c[i];
+        break;
+      case OUTPUT_S:
+        output[i] = z_s[i];
+        break;
+      case OUTPUT_B:
+        output[i] = z_b[i];
+        break;
+      case OUTPUT_SCALAR:
+        output[i] = (i == 0) ? z_scalar : 0.0f;
+        break;
+    }
+  }
+}
+
+/* Returns the maximum error relative to the gold output. Integer outputs are allowed to differ in the rounding */
+static float output_error(const kernel_t* kernel, uint32_t len, const cf_t* gold, const cf_t* output)
+{
+  float max_error = 0.0f;
+  for (uint32_t i = 0; i < len; i++) {
+    float error = cabsf(gold[i] - output[i]);
+    if (kernel->output == OUTPUT_S || kernel->output == OUTPUT_B) {
+      error = (error <= 1.0f) ? 0.0f : error;
+    } else {
+      error /= 1.0f + cabsf(gold[i]);
+    }
+    max_error = SRSRAN_MAX(max_error, error);
+  }
+  return max_error;
+}
+
+/* Runs the kernel with the given ISA and length, starting from a cleared output */
+static void run_kernel(const kernel_t* kernel, srsran_simd_isa_t isa, uint32_t len, cf_t* output)
+{
+  srsran_vec_simd_set_isa(isa);
+  srsran_vec_f_zero(z_f, block_size);
+  srsran_vec_cf_zero(z_c, block_size);
+  srsran_vec_i16_zero(z_s, block_size);
+  memset(z_b, 0, block_size);
+  z_scalar = 0.0f;
+  kernel->run(len);
+  save_output(kernel, len, output);
+}
+
+/* Checks the output of the kernel with the given ISA and length against the generic one */
+static bool check_kernel_len(const kernel_t* kernel, srsran_simd_isa_t isa, uint32_t len, cf_t* gold, cf_t* output)
+{
+  run_kernel(kernel, SRSRAN_SIMD_ISA_GENERIC, len, gold);
+  run_kernel(kernel, isa, len, output);
+  float error = output_error(kernel, len, gold, output);
+  if (!(error < MAX_ERROR)) {
+    ERROR("%s: %s output differs from generic with length %d (error %f)",
+          kernel->name,
+          srsran_simd_isa_string(isa),
+          len,
+          error);
+    return false;
+  }
+  return true;
+}
+
+/* Checks the kernel for every length up to CHECK_MAX_LEN and for the block size */
+static bool check_kernel(const kernel_t* kernel, srsran_simd_isa_t isa, cf_t* gold, cf_t* output)
+{
+  bool passed = true;
+  for (uint32_t len = 1; len <= SRSRAN_MIN(CHECK_MAX_LEN, block_size) && passed; len++) {
+    passed = check_kernel_len(kernel, isa, len, gold, output);
+  }
+  if (passed && block_size > CHECK_MAX_LEN) {
+    passed = check_kernel_len(kernel, isa, block_size, gold, output);
+  }
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  srsran_random_t random_h = srsran_random_init(0x1234);
+
+  x_f      = srsran_vec_f_malloc(block_size);
+  y_f      = srsran_vec_f_malloc(block_size);
+  z_f      = srsran_vec_f_malloc(block_size);
+  x_c      = srsran_vec_cf_malloc(block_size);
+  y_c      = srsran_vec_cf_malloc(block_size);
+  z_c      = srsran_vec_cf_malloc(block_size);
+  x_s      = srsran_vec_i16_malloc(block_size);
+  y_s      = srsran_vec_i16_malloc(block_size);
+  z_s      = srsran_vec_i16_malloc(block_size);
+  x_b      = srsran_vec_i8_malloc(block_size);
+  y_b      = srsran_vec_i8_malloc(block_size);
+  z_b      = srsran_vec_i8_malloc(block_size);
+  lut      = srsran_vec_u16_malloc(block_size);
+  cf_t* gold   = srsran_vec_cf_malloc(block_size);
+  cf_t* output = srsran_vec_cf_malloc(block_size);
+  if (!x_f || !y_f || !z_f || !x_c || !y_c || !z_c || !x_s || !y_s || !z_s || !x_b || !y_b || !z_b || !lut || !gold ||
+      !output) {
+    ERROR("Error allocating memory");
+    return SRSRAN_ERROR;
+  }
+
+  for (uint32_t i = 0; i < block_size; i++) {
+    x_f[i] = srsran_random_uniform_real_dist(random_h, -1.0f, +1.0f);
+    y_f[i] = srsran_random_uniform_real_dist(random_h, 0.5f, 1.5f);
+    x_c[i] = srsran_random_uniform_complex_dist(random_h, -1.0f, +1.0f);
+    y_c[i] = srsran_random_uniform_complex_dist(random_h, 0.5f, 1.5f);
+    x_s[i] = (int16_t)srsran_random_uniform_int_dist(random_h, -255, +255);
+    x_b[i] = (int8_t)srsran_random_uniform_int_dist(random_h, -127, +127);
+    // The sign of zero is not defined for the neg kernels
+    do {
+      y_s[i] = (int16_t)srsran_random_uniform_int_dist(random_h, -255, +255);
+      y_b[i] = (int8_t)srsran_random_uniform_int_dist(random_h, -127, +127);
+    } while (!y_s[i] || !y_b[i]);
+    lut[i] = (unsigned short)(block_size - 1 - i);
+  }
+
+  // The generic kernels go first, their output is the reference for the other ISAs
+  srsran_simd_isa_t startup_isa = srsran_vec_simd_get_isa();
+  srsran_simd_isa_t isa_list[SRSRAN_SIMD_ISA_COUNT];
+  uint32_t          nof_isa = 0;
+  for (int isa = SRSRAN_SIMD_ISA_GENERIC; isa < SRSRAN_SIMD_ISA_COUNT; isa++) {
+    if (test_isa_name != NULL && isa != SRSRAN_SIMD_ISA_GENERIC &&
+        strcmp(test_isa_name, srsran_simd_isa_string((srsran_simd_isa_t)isa)) != 0) {
+      continue;
+    }
+    if (srsran_vec_simd_isa_available((srsran_simd_isa_t)isa)) {
+      isa_list[nof_isa++] = (srsran_simd_isa_t)isa;
+    }
+  }
+  if (test_isa_name != NULL && (nof_isa != 2 || isa_list[0] != SRSRAN_SIMD_ISA_GENERIC)) {
+    // Not a failure, the build or the CPU does not support the ISA
+    printf("The %s and generic kernels are not both available, skipping\n", test_isa_name);
+    return SRSRAN_SUCCESS;
+  }
+
+  printf("Startup ISA: %s; block size: %d; repetitions: %d\n",
+         srsran_simd_isa_string(startup_isa),
+         block_size,
+         nof_repetitions);
+  printf("\n%20s |", "MSamp/s");
+  for (uint32_t j = 0; j < nof_isa; j++) {
+    printf(" %9s |", srsran_simd_isa_string(isa_list[j]));
+  }
+  printf(" %8s |\n", "speedup");
+
+  bool all_passed = true;
+  for (uint32_t k = 0; k < NOF_KERNELS; k++) {
+    const kernel_t* kernel      = &kernels[k];
+    double          first_speed = 0.0, best_speed = 0.0;
+
+    printf("%20s |", kernel->name);
+    for (uint32_t j = 0; j < nof_isa; j++) {
+      bool passed = true;
+      if (isa_list[j] != isa_list[0]) {
+        passed = check_kernel(kernel, isa_list[j], gold, output);
+      }
+      all_passed &= passed;
+
+      srsran_vec_simd_set_isa(isa_list[j]);
+
+      struct timeval start, end;
+      gettimeofday(&start, NULL);
+      for (uint32_t i = 0; i < nof_repetitions; i++) {
+        kernel->run(block_size);
+      }
+      gettimeofday(&end, NULL);
+
+      double speed = (double)block_size * nof_repetitions / SRSRAN_MAX(elapsed_us(&start, &end), 1.0);
+      first_speed  = (j == 0) ? speed : first_speed;
+      best_speed   = SRSRAN_MAX(best_speed, speed);
+      printf(" %8.1f%s |", speed, passed ? " " : "*");
+    }
+    printf(" %7.1fx |\n", best_speed / first_speed);
+  }
+  printf("\n* Output differs from the %s kernels\n", srsran_simd_isa_string(isa_list[0]));
+
+  srsran_vec_simd_set_isa(startup_isa);
+
+  free(x_f);
+  free(y_f);
+  free(z_f);
+  free(x_c);
+  free(y_c);
+  free(z_c);
+  free(x_s);
+  free(y_s);
+  free(z_s);
+  free(x_b);
+  free(y_b);
+  free(z_b);
+  free(lut);
+  free(gold);
+  free(output);
+  srsran_random_free(random_h);
+
+  printf("%s!\n", all_passed ? "Ok" : "Failed");
+  return all_passed ? SRSRAN_SUCCESS : SRSRAN_ERROR;
+}
@@ -19,6 +19,10 @@
  *
  */
 
+#ifdef SRSRAN_SIMD_ISA_SUFFIX
+#include "vector_simd_isa_names.h"
+#endif /* SRSRAN_SIMD_ISA_SUFFIX */
+
 #include <complex.h>
 #include <inttypes.h>
 #include <math.h>
@@ -0,0 +1,293 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector_simd.h"
+
+static const char* simd_isa_names[SRSRAN_SIMD_ISA_COUNT] = {"generic", "sse", "avx", "avx2", "avx512", "neon"};
+
+const char* srsran_simd_isa_string(srsran_simd_isa_t isa)
+{
+  if (isa < SRSRAN_SIMD_ISA_GENERIC || isa >= SRSRAN_SIMD_ISA_COUNT) {
+    return "invalid";
+  }
+  return simd_isa_names[isa];
+}
+
+#ifndef SRSRAN_SIMD_DISPATCH
+
+/*
+ * Without runtime dispatch, the kernels in vector_simd.c are built once with the ISA selected at compile time.
+ */
+#if defined(LV_HAVE_AVX512)
+#define VECTOR_SIMD_COMPILED_ISA SRSRAN_SIMD_ISA_AVX512
+#elif defined(LV_HAVE_AVX2)
+#define VECTOR_SIMD_COMPILED_ISA SRSRAN_SIMD_ISA_AVX2
+#elif defined(LV_HAVE_AVX)
+#define VECTOR_SIMD_COMPILED_ISA SRSRAN_SIMD_ISA_AVX
+#elif defined(LV_HAVE_SSE)
+#define VECTOR_SIMD_COMPILED_ISA SRSRAN_SIMD_ISA_SSE
+#elif defined(HAVE_NEON)
+#define VECTOR_SIMD_COMPILED_ISA SRSRAN_SIMD_ISA_NEON
+#else
+#define VECTOR_SIMD_COMPILED_ISA SRSRAN_SIMD_ISA_GENERIC
+#endif
+
+srsran_simd_isa_t srsran_vec_simd_get_isa(void)
+{
+  return VECTOR_SIMD_COMPILED_ISA;
+}
+
+bool srsran_vec_simd_isa_available(srsran_simd_isa_t isa)
+{
+  return isa == VECTOR_SIMD_COMPILED_ISA;
+}
+
+int srsran_vec_simd_set_isa(srsran_simd_isa_t isa)
+{
+  return (isa == VECTOR_SIMD_COMPILED_ISA) ? SRSRAN_SUCCESS : SRSRAN_ERROR;
+}
+
+#else /* SRSRAN_SIMD_DISPATCH */
+
+/*
+ * With runtime dispatch, vector_simd.c is built once per ISA with the kernel names suffixed by the ISA name (see
+ * vector_simd_isa_names.h). The build system defines SRSRAN_SIMD_HAVE_<ISA> for each variant it was able to compile,
+ * the generic variant is always present. The public kernels defined here forward to the variant selected at startup.
+ */
+#include <cpuid.h>
+
+#define X86_CPUID_BASIC_LEAF 1
+#define X86_CPUID_ADVANCED_LEAF 7
+
+/* XCR0 state components that the OS must save for each ISA */
+#define XCR0_SSE_AVX_STATE 0x06
+#define XCR0_AVX512_STATE 0xe6
+
+#define VECTOR_SIMD_GENERIC(NAME) NAME##_generic
+#ifdef SRSRAN_SIMD_HAVE_SSE
+#define VECTOR_SIMD_SSE(NAME) NAME##_sse
+#else
+#define VECTOR_SIMD_SSE(NAME) NAME##_generic
+#endif
+#ifdef SRSRAN_SIMD_HAVE_AVX
+#define VECTOR_SIMD_AVX(NAME) NAME##_avx
+#else
+#define VECTOR_SIMD_AVX(NAME) NAME##_generic
+#endif
+#ifdef SRSRAN_SIMD_HAVE_AVX2
+#define VECTOR_SIMD_AVX2(NAME) NAME##_avx2
+#else
+#define VECTOR_SIMD_AVX2(NAME) NAME##_generic
+#endif
+#ifdef SRSRAN_SIMD_HAVE_AVX512
+#define VECTOR_SIMD_AVX512(NAME) NAME##_avx512
+#else
+#define VECTOR_SIMD_AVX512(NAME) NAME##_generic
+#endif
+
+/* Declare the ISA variants of each kernel */
+#define VECTOR_SIMD_DECLARE(RET, NAME, PARAMS)                                                                         \
+  RET VECTOR_SIMD_GENERIC(NAME) PARAMS;                                                                                \
+  RET VECTOR_SIMD_SSE(NAME) PARAMS;                                                                                    \
+  RET VECTOR_SIMD_AVX(NAME) PARAMS;                                                                                    \
+  RET VECTOR_SIMD_AVX2(NAME) PARAMS;                                                                                   \
+  RET VECTOR_SIMD_AVX512(NAME) PARAMS;
+#define VECTOR_SIMD_KERNEL_VOID(NAME, PARAMS, ARGS) VECTOR_SIMD_DECLARE(void, NAME, PARAMS)
+#define VECTOR_SIMD_KERNEL(RET, NAME, PARAMS, ARGS) VECTOR_SIMD_DECLARE(RET, NAME, PARAMS)
+#include "vector_simd_kernels.h"
+
+/* Table with the kernels of the selected ISA */
+typedef struct {
+#define VECTOR_SIMD_KERNEL_VOID(NAME, PARAMS, ARGS) void(*NAME) PARAMS;
+#define VECTOR_SIMD_KERNEL(RET, NAME, PARAMS, ARGS) RET(*NAME) PARAMS;
+#include "vector_simd_kernels.h"
+} vector_simd_table_t;
+
+/* Starts with the generic kernels, so they are valid even if they are called before the ISA is selected */
+static vector_simd_table_t vector_simd = {
+#define VECTOR_SIMD_KERNEL_VOID(NAME, PARAMS, ARGS) VECTOR_SIMD_GENERIC(NAME),
+#define VECTOR_SIMD_KERNEL(RET, NAME, PARAMS, ARGS) VECTOR_SIMD_GENERIC(NAME),
+#include "vector_simd_kernels.h"
+};
+
+static srsran_simd_isa_t vector_simd_isa = SRSRAN_SIMD_ISA_GENERIC;
+
+/* Public kernels */
+#define VECTOR_SIMD_KERNEL_VOID(NAME, PARAMS, ARGS)                                                                    \
+  void NAME PARAMS { vector_simd.NAME ARGS; }
+#define VECTOR_SIMD_KERNEL(RET, NAME, PARAMS, ARGS)                                                                    \
+  RET NAME PARAMS { return vector_simd.NAME ARGS; }
+#include "vector_simd_kernels.h"
+
+static int get_cpuid_count(unsigned int  leaf,
+                           unsigned int  subleaf,
+                           unsigned int* eax,
+                           unsigned int* ebx,
+                           unsigned int* ecx,
+                           unsigned int* edx)
+{
+  unsigned int max_leaf = __get_cpuid_max(leaf & 0x80000000, 0);
+
+  if (max_leaf == 0 || max_leaf < leaf) {
+    return 0;
+  }
+
+  __cpuid_count(leaf, subleaf, *eax, *ebx, *ecx, *edx);
+  return 1;
+}
+
+/* Reads the extended control register 0, which tells the register states enabled by the OS */
+static unsigned int get_xcr0(void)
+{
+  unsigned int eax = 0, edx = 0;
+  __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return eax;
+}
+
+/* Returns the best ISA supported by the CPU and the OS, in the same way as arch_select */
+static srsran_simd_isa_t cpu_get_isa(void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  bool         has_sse41 = false, has_avx = false, has_fma = false, has_avx2 = false, has_avx512 = false;
+  unsigned int xcr0 = 0;
+
+  // query basic features
+  if (__get_cpuid(X86_CPUID_BASIC_LEAF, &eax, &ebx, &ecx, &edx)) {
+    has_sse41 = ecx & bit_SSE4_1;
+    has_fma   = ecx & bit_FMA;
+    // AVX registers must also be enabled by the OS
+    if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+      xcr0    = get_xcr0();
+      has_avx = (xcr0 & XCR0_SSE_AVX_STATE) == XCR0_SSE_AVX_STATE;
+    }
+  }
+
+  // query advanced features
+  if (has_avx && get_cpuid_count(X86_CPUID_ADVANCED_LEAF, 0, &eax, &ebx, &ecx, &edx)) {
+    has_avx2   = (ebx & bit_AVX2) && has_fma;
+    has_avx512 = has_avx2 && (ebx & bit_AVX512F) && (ebx & bit_AVX512CD) && (ebx & bit_AVX512BW) &&
+                 (ebx & bit_AVX512DQ) && (xcr0 & XCR0_AVX512_STATE) == XCR0_AVX512_STATE;
+  }
+
+  if (has_avx512) {
+    return SRSRAN_SIMD_ISA_AVX512;
+  } else if (has_avx2) {
+    return SRSRAN_SIMD_ISA_AVX2;
+  } else if (has_avx) {
+    return SRSRAN_SIMD_ISA_AVX;
+  } else if (has_sse41) {
+    return SRSRAN_SIMD_ISA_SSE;
+  }
+  return SRSRAN_SIMD_ISA_GENERIC;
+}
+
+/* Returns true if the kernels have been built for the given ISA */
+static bool isa_is_built(srsran_simd_isa_t isa)
+{
+  switch (isa) {
+    case SRSRAN_SIMD_ISA_GENERIC:
+      return true;
+#ifdef SRSRAN_SIMD_HAVE_SSE
+    case SRSRAN_SIMD_ISA_SSE:
+      return true;
+#endif
+#ifdef SRSRAN_SIMD_HAVE_AVX
+    case SRSRAN_SIMD_ISA_AVX:
+      return true;
+#endif
+#ifdef SRSRAN_SIMD_HAVE_AVX2
+    case SRSRAN_SIMD_ISA_AVX2:
+      return true;
+#endif
+#ifdef SRSRAN_SIMD_HAVE_AVX512
+    case SRSRAN_SIMD_ISA_AVX512:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+srsran_simd_isa_t srsran_vec_simd_get_isa(void)
+{
+  return vector_simd_isa;
+}
+
+bool srsran_vec_simd_isa_available(srsran_simd_isa_t isa)
+{
+  // The x86 ISAs are ordered, every ISA up to the one supported by the CPU can be used
+  return isa_is_built(isa) && isa != SRSRAN_SIMD_ISA_NEON && isa <= cpu_get_isa();
+}
+
+int srsran_vec_simd_set_isa(srsran_simd_isa_t isa)
+{
+  if (!srsran_vec_simd_isa_available(isa)) {
+    return SRSRAN_ERROR;
+  }
+
+#define VECTOR_SIMD_LOAD(NAME)                                                                                         \
+  vector_simd.NAME = (isa == SRSRAN_SIMD_ISA_AVX512) ? VECTOR_SIMD_AVX512(NAME)                                        \
+                     : (isa == SRSRAN_SIMD_ISA_AVX2) ? VECTOR_SIMD_AVX2(NAME)                                          \
+                     : (isa == SRSRAN_SIMD_ISA_AVX)  ? VECTOR_SIMD_AVX(NAME)                                           \
+                     : (isa == SRSRAN_SIMD_ISA_SSE)  ? VECTOR_SIMD_SSE(NAME)                                           \
+                                                     : VECTOR_SIMD_GENERIC(NAME);
+#define VECTOR_SIMD_KERNEL_VOID(NAME, PARAMS, ARGS) VECTOR_SIMD_LOAD(NAME)
+#define VECTOR_SIMD_KERNEL(RET, NAME, PARAMS, ARGS) VECTOR_SIMD_LOAD(NAME)
+#include "vector_simd_kernels.h"
+#undef VECTOR_SIMD_LOAD
+
+  vector_simd_isa = isa;
+  return SRSRAN_SUCCESS;
+}
+
+/* Selects the kernels once at startup, before main() and before any other thread is created */
+__attribute__((constructor)) static void vector_simd_init(void)
+{
+  srsran_simd_isa_t isa = SRSRAN_SIMD_ISA_GENERIC;
+
+  // Pick the best ISA, unless it is lowered by the environment
+  for (int i = SRSRAN_SIMD_ISA_GENERIC; i < SRSRAN_SIMD_ISA_COUNT; i++) {
+    if (srsran_vec_simd_isa_available((srsran_simd_isa_t)i)) {
+      isa = (srsran_simd_isa_t)i;
+    }
+  }
+
+  const char* env_isa = getenv("SRSRAN_SIMD_ISA");
+  if (env_isa != NULL) {
+    int i = SRSRAN_SIMD_ISA_GENERIC;
+    while (i < SRSRAN_SIMD_ISA_COUNT && strcmp(env_isa, simd_isa_names[i]) != 0) {
+      i++;
+    }
+    if (i < SRSRAN_SIMD_ISA_COUNT && srsran_vec_simd_isa_available((srsran_simd_isa_t)i)) {
+      isa = (srsran_simd_isa_t)i;
+    } else {
+      ERROR("SIMD ISA '%s' is not available, using '%s'", env_isa, srsran_simd_isa_string(isa));
+    }
+  }
+
+  srsran_vec_simd_set_isa(isa);
+}
+
+#endif /* SRSRAN_SIMD_DISPATCH */
@@ -336,7 +336,7 @@ void rlc::write_pdu_bcch_bch(srsran::unique_byte_buffer_t pdu)
 void rlc::write_pdu_bcch_dlsch(uint8_t* payload, uint32_t nof_bytes)
 {
   logger.info(payload, nof_bytes, "BCCH TXSCH message received.");
-  unique_byte_buffer_t buf = make_byte_buffer();
+  unique_byte_buffer_t buf = make_sized_byte_buffer(nof_bytes);
   if (buf != NULL) {
     memcpy(buf->msg, payload, nof_bytes);
     buf->N_bytes = nof_bytes;
@@ -673,7 +673,7 @@ void rlc_am_lte::rlc_am_lte_tx::retransmit_pdu(uint32_t sn)
   rlc_amd_retx_t& retx = retx_queue.push();
   retx.is_segment      = false;
   retx.so_start        = 0;
-  retx.so_end          = pdu.buf->N_bytes;
+  retx.so_end          = pdu.buf.length();
   retx.sn              = pdu.rlc_sn;
 }
 
@@ -793,7 +793,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_retx_pdu(uint8_t* payload, uint32_t nof_byt
 
   // Set poll bit
   pdu_without_poll++;
-  byte_without_poll += (tx_window[retx.sn].buf->N_bytes + rlc_am_packed_length(&new_header));
+  byte_without_poll += (tx_window[retx.sn].buf.length() + rlc_am_packed_length(&new_header));
   logger.info("%s pdu_without_poll: %d", RB_NAME, pdu_without_poll);
   logger.info("%s byte_without_poll: %d", RB_NAME, byte_without_poll);
   if (poll_required()) {
@@ -809,33 +809,33 @@ int rlc_am_lte::rlc_am_lte_tx::build_retx_pdu(uint8_t* payload, uint32_t nof_byt
 
   uint8_t* ptr = payload;
   rlc_am_write_data_pdu_header(&new_header, &ptr);
-  memcpy(ptr, tx_window[retx.sn].buf->msg, tx_window[retx.sn].buf->N_bytes);
+  tx_window[retx.sn].buf.copy_to(ptr);
 
   retx_queue.pop();
 
   logger.info(payload,
-              tx_window[retx.sn].buf->N_bytes,
+              tx_window[retx.sn].buf.length(),
               "%s Tx PDU SN=%d (%d B) (attempt %d/%d)",
               RB_NAME,
               retx.sn,
-              tx_window[retx.sn].buf->N_bytes,
+              tx_window[retx.sn].buf.length(),
               tx_window[retx.sn].retx_count + 1,
               cfg.max_retx_thresh);
   log_rlc_amd_pdu_header_to_string(logger.debug, new_header);
 
   debug_state();
-  return (ptr - payload) + tx_window[retx.sn].buf->N_bytes;
+  return (ptr - payload) + tx_window[retx.sn].buf.length();
 }
 
 int rlc_am_lte::rlc_am_lte_tx::build_segment(uint8_t* payload, uint32_t nof_bytes, rlc_amd_retx_t retx)
 {
-  if (tx_window[retx.sn].buf == NULL) {
-    logger.error("In build_segment: retx.sn=%d has null buffer", retx.sn);
+  if (tx_window[retx.sn].buf.empty()) {
+    logger.error("In build_segment: retx.sn=%d has empty buffer", retx.sn);
     return 0;
   }
   if (!retx.is_segment) {
     retx.so_start = 0;
-    retx.so_end   = tx_window[retx.sn].buf->N_bytes;
+    retx.so_end   = tx_window[retx.sn].buf.length();
   }
 
   // Construct new header
@@ -843,7 +843,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_segment(uint8_t* payload, uint32_t nof_byte
   rlc_amd_pdu_header_t old_header = tx_window[retx.sn].header;
 
   pdu_without_poll++;
-  byte_without_poll += (tx_window[retx.sn].buf->N_bytes + rlc_am_packed_length(&new_header));
+  byte_without_poll += (tx_window[retx.sn].buf.length() + rlc_am_packed_length(&new_header));
   logger.info("%s pdu_without_poll: %d", RB_NAME, pdu_without_poll);
   logger.info("%s byte_without_poll: %d", RB_NAME, byte_without_poll);
 
@@ -957,7 +957,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_segment(uint8_t* payload, uint32_t nof_byte
   srsran_expect(head_len + (retx.so_end - retx.so_start) <= nof_bytes, "The provided buffer was overflown.");
 
   // Update retx_queue
-  if (tx_window[retx.sn].buf->N_bytes == retx.so_end) {
+  if (tx_window[retx.sn].buf.length() == retx.so_end) {
     retx_queue.pop();
     new_header.lsf = 1;
     if (rlc_am_end_aligned(old_header.fi)) {
@@ -973,9 +973,8 @@ int rlc_am_lte::rlc_am_lte_tx::build_segment(uint8_t* payload, uint32_t nof_byte
   // Write header and pdu
   uint8_t* ptr = payload;
   rlc_am_write_data_pdu_header(&new_header, &ptr);
-  uint8_t* data = &tx_window[retx.sn].buf->msg[retx.so_start];
-  uint32_t len  = retx.so_end - retx.so_start;
-  memcpy(ptr, data, len);
+  uint32_t len = retx.so_end - retx.so_start;
+  tx_window[retx.sn].buf.copy_to(ptr, retx.so_start, len);
 
   debug_state();
   int pdu_len = (ptr - payload) + len;
@@ -1023,23 +1022,6 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
     return 0;
   }
 
-  unique_byte_buffer_t pdu = srsran::make_byte_buffer();
-  if (pdu == NULL) {
-#ifdef RLC_AM_BUFFER_DEBUG
-    srsran::console("Fatal Error: Could not allocate PDU in build_data_pdu()\n");
-    srsran::console("tx_window size: %zd PDUs\n", tx_window.size());
-    srsran::console("vt_a = %d, vt_ms = %d, vt_s = %d, poll_sn = %d\n", vt_a, vt_ms, vt_s, poll_sn);
-    srsran::console("retx_queue size: %zd PDUs\n", retx_queue.size());
-    std::map<uint32_t, rlc_amd_tx_pdu>::iterator txit;
-    for (txit = tx_window.begin(); txit != tx_window.end(); txit++) {
-      srsran::console("tx_window - SN=%d\n", txit->first);
-    }
-    exit(-1);
-#else
-    logger.error("Fatal Error: Couldn't allocate PDU in build_data_pdu().");
-    return 0;
-#endif
-  }
   rlc_amd_pdu_header_t header = {};
   header.dc                   = RLC_DC_FIELD_DATA_PDU;
   header.fi                   = RLC_FI_FIELD_START_AND_END_ALIGNED;
@@ -1054,21 +1036,20 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
   // NOTE: from now on, we can't return from this function anymore before increasing vt_s
   rlc_amd_tx_pdu& tx_pdu = tx_window.add_pdu(header.sn);
 
-  uint32_t head_len  = rlc_am_packed_length(&header);
-  uint32_t to_move   = 0;
-  uint32_t last_li   = 0;
-  uint32_t pdu_space = SRSRAN_MIN(nof_bytes, pdu->get_tailroom());
-  uint8_t* pdu_ptr   = pdu->msg;
+  // The PDU references the SDU segments, which are only copied when the PDU is written into the MAC payload
+  byte_buffer_chain& pdu       = tx_pdu.buf;
+  uint32_t           head_len  = rlc_am_packed_length(&header);
+  uint32_t           to_move   = 0;
+  uint32_t           last_li   = 0;
+  uint32_t           pdu_space = nof_bytes;
 
   logger.debug("%s Building PDU - pdu_space: %d, head_len: %d ", RB_NAME, pdu_space, head_len);
 
   // Check for SDU segment
   if (tx_sdu != nullptr) {
     to_move = ((pdu_space - head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space - head_len;
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    pdu.append(tx_sdu, tx_sdu->msg, to_move);
     last_li = to_move;
-    pdu_ptr += to_move;
-    pdu->N_bytes += to_move;
     tx_sdu->N_bytes -= to_move;
     tx_sdu->msg += to_move;
     if (undelivered_sdu_info_queue.has_pdcp_sn(tx_sdu->md.pdcp_sn)) {
@@ -1087,7 +1068,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
       tx_sdu.reset();
     }
     if (pdu_space > to_move) {
-      pdu_space -= SRSRAN_MIN(to_move, pdu->get_tailroom());
+      pdu_space -= to_move;
     } else {
       pdu_space = 0;
     }
@@ -1106,7 +1087,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
   while (pdu_space > head_len && tx_sdu_queue.get_n_sdus() > 0 && header.N_li < MAX_SDUS_PER_PDU) {
     if (not segment_pool.has_segments()) {
       logger.info("Can't build a PDU segment - No segment resources available");
-      if (pdu_ptr != pdu->msg) {
+      if (not pdu.empty()) {
         break; // continue with the segments created up to this point
       }
       tx_window.remove_pdu(tx_pdu.rlc_sn);
@@ -1125,7 +1106,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
     }
 
     do {
-      tx_sdu = tx_sdu_queue.read();
+      tx_sdu = shared_byte_buffer_t(tx_sdu_queue.read());
     } while (tx_sdu == nullptr && tx_sdu_queue.size() != 0);
     if (tx_sdu == nullptr) {
       if (header.N_li > 0) {
@@ -1146,10 +1127,8 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
     pdcp_pdu_info& pdcp_pdu = undelivered_sdu_info_queue[tx_sdu->md.pdcp_sn];
 
     to_move = ((pdu_space - head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space - head_len;
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    pdu.append(tx_sdu, tx_sdu->msg, to_move);
     last_li = to_move;
-    pdu_ptr += to_move;
-    pdu->N_bytes += to_move;
     tx_sdu->N_bytes -= to_move;
     tx_sdu->msg += to_move;
     segment_pool.make_segment(tx_pdu, pdcp_pdu);
@@ -1175,7 +1154,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
   }
 
   // Make sure, at least one SDU (segment) has been added until this point
-  if (pdu->N_bytes == 0) {
+  if (pdu.empty()) {
     logger.error("Generated empty RLC PDU.");
   }
 
@@ -1185,7 +1164,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
 
   // Set Poll bit
   pdu_without_poll++;
-  byte_without_poll += (pdu->N_bytes + head_len);
+  byte_without_poll += (pdu.length() + head_len);
   logger.debug("%s pdu_without_poll: %d", RB_NAME, pdu_without_poll);
   logger.debug("%s byte_without_poll: %d", RB_NAME, byte_without_poll);
   if (poll_required()) {
@@ -1202,15 +1181,13 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
   // Update Tx window
   vt_s = (vt_s + 1) % MOD;
 
-  // Write final header and TX
-  tx_pdu.buf                      = std::move(pdu);
-  tx_pdu.header                   = header;
-  const byte_buffer_t* buffer_ptr = tx_pdu.buf.get();
+  // Write final header and gather the SDU segments into the MAC payload
+  tx_pdu.header = header;
 
   uint8_t* ptr = payload;
   rlc_am_write_data_pdu_header(&header, &ptr);
-  memcpy(ptr, buffer_ptr->msg, buffer_ptr->N_bytes);
-  int total_len = (ptr - payload) + buffer_ptr->N_bytes;
+  ptr += pdu.copy_to(ptr);
+  int total_len = ptr - payload;
   logger.info(payload, total_len, "%s Tx PDU SN=%d (%d B)", RB_NAME, header.sn, total_len);
   log_rlc_amd_pdu_header_to_string(logger.debug, header);
   debug_state();
@@ -1287,25 +1264,25 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
             retx.sn         = i;
             retx.is_segment = false;
             retx.so_start   = 0;
-            retx.so_end     = pdu.buf->N_bytes;
+            retx.so_end     = pdu.buf.length();
 
             if (status.nacks[j].has_so) {
               // sanity check
-              if (status.nacks[j].so_start >= pdu.buf->N_bytes) {
+              if (status.nacks[j].so_start >= pdu.buf.length()) {
                 // print error but try to send original PDU again
                 logger.info(
-                    "SO_start is larger than original PDU (%d >= %d)", status.nacks[j].so_start, pdu.buf->N_bytes);
+                    "SO_start is larger than original PDU (%d >= %d)", status.nacks[j].so_start, pdu.buf.length());
                 status.nacks[j].so_start = 0;
               }
 
               // check for special SO_end value
               if (status.nacks[j].so_end == 0x7FFF) {
-                status.nacks[j].so_end = pdu.buf->N_bytes;
+                status.nacks[j].so_end = pdu.buf.length();
               } else {
                 retx.so_end = status.nacks[j].so_end + 1;
               }
 
-              if (status.nacks[j].so_start < pdu.buf->N_bytes && status.nacks[j].so_end <= pdu.buf->N_bytes) {
+              if (status.nacks[j].so_start < pdu.buf.length() && status.nacks[j].so_end <= pdu.buf.length()) {
                 retx.is_segment = true;
                 retx.so_start   = status.nacks[j].so_start;
               } else {
@@ -1314,7 +1291,7 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
                                i,
                                status.nacks[j].so_start,
                                status.nacks[j].so_end,
-                               pdu.buf->N_bytes);
+                               pdu.buf.length());
               }
             }
           } else {
@@ -1412,10 +1389,10 @@ int rlc_am_lte::rlc_am_lte_tx::required_buffer_size(const rlc_amd_retx_t& retx)
 {
   if (!retx.is_segment) {
     if (tx_window.has_sn(retx.sn)) {
-      if (tx_window[retx.sn].buf) {
-        return rlc_am_packed_length(&tx_window[retx.sn].header) + tx_window[retx.sn].buf->N_bytes;
+      if (not tx_window[retx.sn].buf.empty()) {
+        return rlc_am_packed_length(&tx_window[retx.sn].header) + tx_window[retx.sn].buf.length();
       } else {
-        logger.warning("retx.sn=%d has null ptr in required_buffer_size()", retx.sn);
+        logger.warning("retx.sn=%d has empty buffer in required_buffer_size()", retx.sn);
         return -1;
       }
     } else {
@@ -1589,7 +1566,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
 
   // Write to rx window
   rlc_amd_rx_pdu& pdu = rx_window.add_pdu(header.sn);
-  pdu.buf             = srsran::make_byte_buffer();
+  pdu.buf             = srsran::make_sized_byte_buffer(nof_bytes);
   if (pdu.buf == NULL) {
 #ifdef RLC_AM_BUFFER_DEBUG
     srsran::console("Fatal Error: Couldn't allocate PDU in handle_data_pdu().\n");
@@ -1694,7 +1671,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
   }
 
   rlc_amd_rx_pdu segment;
-  segment.buf = srsran::make_byte_buffer();
+  segment.buf = srsran::make_sized_byte_buffer(nof_bytes);
   if (segment.buf == NULL) {
 #ifdef RLC_AM_BUFFER_DEBUG
     srsran::console("Fatal Error: Couldn't allocate PDU in handle_data_pdu_segment().\n");
@@ -1761,7 +1738,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
 {
   uint32_t len = 0;
   if (rx_sdu == NULL) {
-    rx_sdu = srsran::make_byte_buffer();
+    rx_sdu = srsran::make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
     if (rx_sdu == NULL) {
 #ifdef RLC_AM_BUFFER_DEBUG
       srsran::console("Fatal Error: Could not allocate PDU in reassemble_rx_sdus() (1)\n");
@@ -1792,8 +1769,8 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
         break;
       }
 
-      if (rx_sdu->get_tailroom() >= len) {
-        if ((rx_window[vr_r].buf->msg - rx_window[vr_r].buf->buffer) + len < SRSRAN_MAX_BUFFER_SIZE_BYTES) {
+      if (rx_sdu->N_bytes + len <= RLC_MAX_RX_SDU_SIZE) {
+        if (rx_window[vr_r].buf->get_headroom() + len <= rx_window[vr_r].buf->get_storage_size()) {
           if (rx_window[vr_r].buf->N_bytes < len) {
             logger.error("Dropping corrupted SN=%d", vr_r);
             rx_sdu.reset();
@@ -1803,8 +1780,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
           if (rx_sdu->N_bytes == 0) {
             rx_sdu->set_timestamp(rx_window[vr_r].buf->get_timestamp());
           }
-          memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_r].buf->msg, len);
-          rx_sdu->N_bytes += len;
+          rx_sdu->append_bytes(rx_window[vr_r].buf->msg, len);
 
           rx_window[vr_r].buf->msg += len;
           rx_window[vr_r].buf->N_bytes -= len;
@@ -1819,7 +1795,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
             parent->metrics.num_rx_sdus++;
           }
 
-          rx_sdu = srsran::make_byte_buffer();
+          rx_sdu = srsran::make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
           if (rx_sdu == nullptr) {
 #ifdef RLC_AM_BUFFER_DEBUG
             srsran::console("Fatal Error: Could not allocate PDU in reassemble_rx_sdus() (2)\n");
@@ -1830,7 +1806,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
 #endif
           }
         } else {
-          int buf_len = rx_window[vr_r].buf->msg - rx_window[vr_r].buf->buffer;
+          int buf_len = rx_window[vr_r].buf->get_headroom();
           logger.error("Cannot read %d bytes from rx_window. vr_r=%d, msg-buffer=%d B", len, vr_r, buf_len);
           rx_sdu.reset();
           goto exit;
@@ -1845,16 +1821,15 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
     // Handle last segment
     len = rx_window[vr_r].buf->N_bytes;
     logger.debug(rx_window[vr_r].buf->msg, len, "Handling last segment of length %d B of SN=%d", len, vr_r);
-    if (rx_sdu->get_tailroom() >= len) {
+    if (rx_sdu->N_bytes + len <= RLC_MAX_RX_SDU_SIZE) {
       // store timestamp of the first segment when starting to assemble SDUs
       if (rx_sdu->N_bytes == 0) {
         rx_sdu->set_timestamp(rx_window[vr_r].buf->get_timestamp());
       }
-      memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_r].buf->msg, len);
-      rx_sdu->N_bytes += rx_window[vr_r].buf->N_bytes;
+      rx_sdu->append_bytes(rx_window[vr_r].buf->msg, len);
     } else {
-      printf("Cannot fit RLC PDU in SDU buffer (tailroom=%d, len=%d), dropping both. Erasing SN=%d.\n",
-             rx_sdu->get_tailroom(),
+      printf("Cannot fit RLC PDU in SDU buffer (sdu_len=%d, len=%d), dropping both. Erasing SN=%d.\n",
+             rx_sdu->N_bytes,
              len,
              vr_r);
       rx_sdu.reset();
@@ -1872,7 +1847,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
         parent->metrics.num_rx_sdus++;
       }
 
-      rx_sdu = srsran::make_byte_buffer();
+      rx_sdu = srsran::make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
       if (rx_sdu == NULL) {
 #ifdef RLC_AM_BUFFER_DEBUG
         srsran::console("Fatal Error: Could not allocate PDU in reassemble_rx_sdus() (3)\n");
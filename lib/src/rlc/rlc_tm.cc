@@ -195,7 +195,7 @@ uint32_t rlc_tm::read_pdu(uint8_t* payload, uint32_t nof_bytes)
 
 void rlc_tm::write_pdu(uint8_t* payload, uint32_t nof_bytes)
 {
-  unique_byte_buffer_t buf = make_byte_buffer();
+  unique_byte_buffer_t buf = make_sized_byte_buffer(nof_bytes);
   if (buf != nullptr) {
     memcpy(buf->msg, payload, nof_bytes);
     buf->N_bytes = nof_bytes;
@@ -333,11 +333,12 @@ uint32_t rlc_um_base::rlc_um_base_tx::build_data_pdu(uint8_t* payload, uint32_t
       return 0;
     }
 
-    pdu = make_byte_buffer();
+    pdu = make_sized_byte_buffer(nof_bytes);
     if (!pdu || pdu->N_bytes != 0) {
       logger.error("Failed to allocate PDU buffer");
       return 0;
     }
+    pdu->reserve(nof_bytes);
   }
   return build_data_pdu(std::move(pdu), payload, nof_bytes);
 }
@@ -328,7 +328,7 @@ void rlc_um_lte::rlc_um_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
 
   // Write to rx window
   rlc_umd_pdu_t pdu = {};
-  pdu.buf           = make_byte_buffer();
+  pdu.buf           = make_sized_byte_buffer(nof_bytes);
   if (!pdu.buf) {
     logger.error("Discarting packet: no space in buffer pool");
     return;
@@ -372,7 +372,7 @@ void rlc_um_lte::rlc_um_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
 void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
 {
   if (!rx_sdu) {
-    rx_sdu = make_byte_buffer();
+    rx_sdu = make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
     if (!rx_sdu) {
       logger.error("Fatal Error: Couldn't allocate buffer in rlc_um::reassemble_rx_sdus().");
       return;
@@ -408,8 +408,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
           break;
         }
 
-        memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
-        rx_sdu->N_bytes += len;
+        rx_sdu->append_bytes(rx_window[vr_ur].buf->msg, len);
         rx_window[vr_ur].buf->msg += len;
         rx_window[vr_ur].buf->N_bytes -= len;
         if ((pdu_lost && !rlc_um_start_aligned(rx_window[vr_ur].header.fi)) ||
@@ -434,7 +433,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
           } else {
             pdcp->write_pdu(lcid, std::move(rx_sdu));
           }
-          rx_sdu = make_byte_buffer();
+          rx_sdu = make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
           if (!rx_sdu) {
             logger.error("Fatal Error: Couldn't allocate buffer in rlc_um::reassemble_rx_sdus().");
             return;
@@ -450,8 +449,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
                     rx_sdu->N_bytes,
                     rx_window[vr_ur].buf->N_bytes);
 
-        memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
-        rx_sdu->N_bytes += rx_window[vr_ur].buf->N_bytes;
+        rx_sdu->append_bytes(rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
         vr_ur_in_rx_sdu = vr_ur;
         if (rlc_um_end_aligned(rx_window[vr_ur].header.fi)) {
           if (pdu_lost && !rlc_um_start_aligned(rx_window[vr_ur].header.fi)) {
@@ -469,7 +467,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
             } else {
               pdcp->write_pdu(lcid, std::move(rx_sdu));
             }
-            rx_sdu = make_byte_buffer();
+            rx_sdu = make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
             if (!rx_sdu) {
               logger.error("Fatal Error: Couldn't allocate buffer in rlc_um::reassemble_rx_sdus().");
               return;
@@ -530,7 +528,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
       }
 
       // Check available space in SDU
-      if ((uint32_t)len > rx_sdu->get_tailroom()) {
+      if (rx_sdu->N_bytes + len > RLC_MAX_RX_SDU_SIZE) {
         logger.error("Dropping PDU %d due to buffer mis-alignment (current segment len %d B, received %d B)",
                      vr_ur,
                      rx_sdu->N_bytes,
@@ -558,8 +556,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
                     (vr_ur_in_rx_sdu + 1) % cfg.um.rx_mod);
       }
 
-      memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
-      rx_sdu->N_bytes += len;
+      rx_sdu->append_bytes(rx_window[vr_ur].buf->msg, len);
       rx_window[vr_ur].buf->msg += len;
       rx_window[vr_ur].buf->N_bytes -= len;
       vr_ur_in_rx_sdu = vr_ur;
@@ -579,7 +576,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
         } else {
           pdcp->write_pdu(lcid, std::move(rx_sdu));
         }
-        rx_sdu = make_byte_buffer();
+        rx_sdu = make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
         if (!rx_sdu) {
           logger.error("Fatal Error: Couldn't allocate buffer in rlc_um::reassemble_rx_sdus().");
           return;
@@ -605,9 +602,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
       goto clean_up_rx_window;
     }
 
-    if (rx_sdu->N_bytes < SRSRAN_MAX_BUFFER_SIZE_BYTES &&
-        rx_window[vr_ur].buf->N_bytes < SRSRAN_MAX_BUFFER_SIZE_BYTES &&
-        rx_window[vr_ur].buf->N_bytes + rx_sdu->N_bytes < SRSRAN_MAX_BUFFER_SIZE_BYTES) {
+    if (rx_sdu->N_bytes + rx_window[vr_ur].buf->N_bytes <= RLC_MAX_RX_SDU_SIZE) {
       logger.info(rx_window[vr_ur].buf->msg,
                   rx_window[vr_ur].buf->N_bytes,
                   "Writing last segment in SDU buffer. Updating vr_ur=%d, vr_ur_in_rx_sdu=%d, Buffer size=%d, "
@@ -616,8 +611,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
                   vr_ur_in_rx_sdu,
                   rx_sdu->N_bytes,
                   rx_window[vr_ur].buf->N_bytes);
-      memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
-      rx_sdu->N_bytes += rx_window[vr_ur].buf->N_bytes;
+      rx_sdu->append_bytes(rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
     } else {
       logger.error("Out of bounds while reassembling SDU buffer in UM: sdu_len=%d, window_buffer_len=%d, vr_ur=%d",
                    rx_sdu->N_bytes,
@@ -641,7 +635,7 @@ void rlc_um_lte::rlc_um_lte_rx::reassemble_rx_sdus()
         } else {
           pdcp->write_pdu(lcid, std::move(rx_sdu));
         }
-        rx_sdu = make_byte_buffer();
+        rx_sdu = make_sized_byte_buffer(RLC_RX_SDU_BUFFER_SIZE);
         if (!rx_sdu) {
           logger.error("Fatal Error: Couldn't allocate buffer in rlc_um::reassemble_rx_sdus().");
           return;
@@ -356,7 +356,7 @@ unique_byte_buffer_t rlc_um_nr::rlc_um_nr_rx::rlc_um_nr_strip_pdu_header(const r
                                                                          const uint8_t*                payload,
                                                                          const uint32_t                nof_bytes)
 {
-  unique_byte_buffer_t sdu = make_byte_buffer();
+  unique_byte_buffer_t sdu = make_sized_byte_buffer(nof_bytes);
   if (sdu == nullptr) {
     logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
     return nullptr;
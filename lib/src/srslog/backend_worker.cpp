@@ -124,6 +124,11 @@ static void process_flush_command(const detail::flush_backend_cmd& cmd)
     sink->flush();
   }
 
+  // When the command is shared with other workers, only the last one to finish notifies the caller.
+  if (cmd.pending_workers && cmd.pending_workers->fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
   // Notify caller thread we are done.
   cmd.completion_flag = true;
 }
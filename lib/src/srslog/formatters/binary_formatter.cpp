@@ -0,0 +1,471 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "binary_formatter.h"
+#include <cstring>
+#include <limits>
+
+using namespace srslog;
+using namespace srslog::binary_log;
+
+/// Appends the raw bytes of the input value into the buffer.
+template <typename T>
+static void put(fmt::memory_buffer& buffer, const T& value)
+{
+  const char* p = reinterpret_cast<const char*>(&value);
+  buffer.append(p, p + sizeof(T));
+}
+
+/// Appends a record header into the buffer and returns its offset, so that the payload size can be later patched.
+static size_t put_record_header(fmt::memory_buffer& buffer, record_type type, uint32_t payload_size = 0)
+{
+  size_t offset = buffer.size();
+  put(buffer, static_cast<uint8_t>(type));
+  put(buffer, payload_size);
+  return offset;
+}
+
+/// Sets the payload size of the record starting at the specified offset to span until the end of the buffer.
+static void patch_record_size(fmt::memory_buffer& buffer, size_t offset)
+{
+  uint32_t payload_size = buffer.size() - offset - record_hdr_size;
+  std::memcpy(buffer.data() + offset + sizeof(uint8_t), &payload_size, sizeof(payload_size));
+}
+
+std::unique_ptr<log_formatter> binary_formatter::clone() const
+{
+  // String ids are only valid within one stream, each new sink starts from an empty string table.
+  return std::unique_ptr<log_formatter>(new binary_formatter);
+}
+
+void binary_formatter::write_header_once(fmt::memory_buffer& buffer)
+{
+  if (header_written) {
+    return;
+  }
+  header_written = true;
+  buffer.append(magic, magic + magic_size);
+  put(buffer, version);
+}
+
+uint32_t binary_formatter::define_string(fmt::string_view str, fmt::memory_buffer& buffer)
+{
+  uint32_t id = next_string_id++;
+  put_record_header(buffer, record_type::string_def, sizeof(id) + str.size());
+  put(buffer, id);
+  buffer.append(str.data(), str.data() + str.size());
+  return id;
+}
+
+uint32_t binary_formatter::get_fmtstring_id(const char* str, fmt::memory_buffer& buffer)
+{
+  if (str == nullptr) {
+    return null_string_id;
+  }
+
+  auto it = fmtstrings.find(str);
+  if (it != fmtstrings.end()) {
+    // Format strings are usually literals, but check the contents in case the address has been reused.
+    if (it->second.str == str) {
+      return it->second.id;
+    }
+    it->second.id  = define_string(str, buffer);
+    it->second.str = str;
+    return it->second.id;
+  }
+
+  uint32_t id = define_string(str, buffer);
+  fmtstrings.emplace(str, fmtstring_def{id, str});
+  return id;
+}
+
+uint32_t binary_formatter::get_log_name_id(const std::string& name, fmt::memory_buffer& buffer)
+{
+  if (name.empty()) {
+    return null_string_id;
+  }
+
+  auto it = log_names.find(name);
+  if (it != log_names.end()) {
+    return it->second;
+  }
+
+  uint32_t id = define_string(name, buffer);
+  log_names.emplace(name, id);
+  return id;
+}
+
+namespace {
+
+/// Visitor that serializes a format argument. Returns false for argument types that can not be serialized.
+struct arg_writer {
+  fmt::memory_buffer& buffer;
+
+  template <typename T>
+  bool put_arg(arg_type type, const T& value)
+  {
+    put(buffer, static_cast<uint8_t>(type));
+    put(buffer, value);
+    return true;
+  }
+
+  bool operator()(int value) { return put_arg(arg_type::i32, value); }
+  bool operator()(unsigned value) { return put_arg(arg_type::u32, value); }
+  bool operator()(long long value) { return put_arg(arg_type::i64, value); }
+  bool operator()(unsigned long long value) { return put_arg(arg_type::u64, value); }
+  bool operator()(bool value) { return put_arg(arg_type::boolean, value); }
+  bool operator()(char value) { return put_arg(arg_type::chr, value); }
+  bool operator()(float value) { return put_arg(arg_type::f32, value); }
+  bool operator()(double value) { return put_arg(arg_type::f64, value); }
+  bool operator()(long double value) { return put_arg(arg_type::f_long, value); }
+  bool operator()(const void* value) { return put_arg(arg_type::ptr, reinterpret_cast<uint64_t>(value)); }
+  bool operator()(const char* value) { return (*this)(fmt::string_view(value)); }
+  bool operator()(fmt::string_view value)
+  {
+    put(buffer, static_cast<uint8_t>(arg_type::str));
+    put(buffer, static_cast<uint32_t>(value.size()));
+    buffer.append(value.data(), value.data() + value.size());
+    return true;
+  }
+
+  /// Custom types, 128 bit integers and empty arguments.
+  template <typename T>
+  bool operator()(const T&)
+  {
+    return false;
+  }
+};
+
+} // namespace
+
+bool binary_formatter::write_args(const fmt::dynamic_format_arg_store<fmt::printf_context>& store,
+                                  fmt::memory_buffer&                                       buffer)
+{
+  fmt::basic_format_args<fmt::printf_context> args(store);
+
+  // Reserve the slot for the number of arguments.
+  size_t nof_args_offset = buffer.size();
+  put(buffer, uint8_t(0));
+
+  unsigned   nof_args = 0;
+  arg_writer writer{buffer};
+  for (auto arg = args.get(nof_args); arg; arg = args.get(++nof_args)) {
+    if (nof_args == std::numeric_limits<uint8_t>::max() || !fmt::visit_format_arg(writer, arg)) {
+      return false;
+    }
+  }
+  buffer[nof_args_offset] = static_cast<char>(nof_args);
+
+  return true;
+}
+
+void binary_formatter::write_text_record(detail::log_entry_metadata&& metadata, fmt::memory_buffer& buffer)
+{
+  size_t offset = put_record_header(buffer, record_type::text);
+  text_formatter::format(std::move(metadata), buffer);
+  patch_record_size(buffer, offset);
+}
+
+void binary_formatter::format(detail::log_entry_metadata&& metadata, fmt::memory_buffer& buffer)
+{
+  write_header_once(buffer);
+
+  // String definitions have to precede the entry that references them.
+  uint32_t fmt_id  = get_fmtstring_id(metadata.fmtstring, buffer);
+  uint32_t name_id = get_log_name_id(metadata.log_name, buffer);
+
+  int64_t ts_ns  = std::chrono::duration_cast<std::chrono::nanoseconds>(metadata.tp.time_since_epoch()).count();
+  uint8_t flags  = (metadata.context.enabled ? flag_context_enabled : 0) | (metadata.store ? flag_has_args : 0);
+  size_t  offset = put_record_header(buffer, record_type::entry);
+  put(buffer, ts_ns);
+  put(buffer, fmt_id);
+  put(buffer, name_id);
+  put(buffer, metadata.context.value);
+  put(buffer, metadata.log_tag);
+  put(buffer, flags);
+
+  if (metadata.store && !write_args(*metadata.store, buffer)) {
+    // Fall back to text for arguments that can only be formatted in the context of the process.
+    buffer.resize(offset);
+    write_text_record(std::move(metadata), buffer);
+    return;
+  }
+
+  put(buffer, static_cast<uint32_t>(metadata.hex_dump.size()));
+  buffer.append(metadata.hex_dump.data(), metadata.hex_dump.data() + metadata.hex_dump.size());
+
+  patch_record_size(buffer, offset);
+}
+
+void binary_formatter::format_context_begin(const detail::log_entry_metadata& md,
+                                            fmt::string_view                  ctx_name,
+                                            unsigned                          size,
+                                            fmt::memory_buffer&               buffer)
+{
+  // Contexts are rendered by the text formatter and stored as a text record.
+  write_header_once(buffer);
+  ctx_record_offset = put_record_header(buffer, record_type::text);
+  text_formatter::format_context_begin(md, ctx_name, size, buffer);
+}
+
+void binary_formatter::format_context_end(const detail::log_entry_metadata& md,
+                                          fmt::string_view                  ctx_name,
+                                          fmt::memory_buffer&               buffer)
+{
+  text_formatter::format_context_end(md, ctx_name, buffer);
+  patch_record_size(buffer, ctx_record_offset);
+}
+
+namespace {
+
+/// Bounds checked reader of a record payload.
+class payload_reader
+{
+public:
+  payload_reader(const uint8_t* data, size_t len) : p(data), end(data + len) {}
+
+  template <typename T>
+  bool read(T& value)
+  {
+    if (static_cast<size_t>(end - p) < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+  }
+
+  bool read_bytes(size_t n, const uint8_t*& bytes)
+  {
+    if (static_cast<size_t>(end - p) < n) {
+      return false;
+    }
+    bytes = p;
+    p += n;
+    return true;
+  }
+
+private:
+  const uint8_t* p;
+  const uint8_t* end;
+};
+
+/// Reads a value of type T from the reader and pushes it as type U into the argument store.
+template <typename T, typename U = T>
+bool read_arg(payload_reader& reader, fmt::dynamic_format_arg_store<fmt::printf_context>& store)
+{
+  T value;
+  if (!reader.read(value)) {
+    return false;
+  }
+  store.push_back(static_cast<U>(value));
+  return true;
+}
+
+} // namespace
+
+const std::string* binary_log_decoder::find_string(uint32_t id) const
+{
+  auto it = strings.find(id);
+  return (it != strings.end()) ? &it->second : nullptr;
+}
+
+bool binary_log_decoder::decode_entry(const uint8_t* payload, size_t len, fmt::memory_buffer& buffer)
+{
+  payload_reader reader(payload, len);
+
+  int64_t  ts_ns;
+  uint32_t fmt_id, name_id;
+  uint32_t ctx_value;
+  char     tag;
+  uint8_t  flags;
+  if (!reader.read(ts_ns) || !reader.read(fmt_id) || !reader.read(name_id) || !reader.read(ctx_value) ||
+      !reader.read(tag) || !reader.read(flags)) {
+    error = "Truncated log entry";
+    return false;
+  }
+
+  const std::string* fmtstring = (fmt_id == null_string_id) ? nullptr : find_string(fmt_id);
+  const std::string* log_name  = (name_id == null_string_id) ? nullptr : find_string(name_id);
+  if ((fmt_id != null_string_id && !fmtstring) || (name_id != null_string_id && !log_name)) {
+    error = "Log entry references an undefined string, the stream should be decoded from its beginning";
+    return false;
+  }
+
+  store.clear();
+  if (flags & flag_has_args) {
+    uint8_t nof_args;
+    if (!reader.read(nof_args)) {
+      error = "Truncated log entry";
+      return false;
+    }
+    for (unsigned i = 0; i != nof_args; ++i) {
+      uint8_t type = 0;
+      if (!reader.read(type)) {
+        error = "Truncated log entry";
+        return false;
+      }
+      bool ok = false;
+      switch (static_cast<arg_type>(type)) {
+        case arg_type::i32:
+          ok = read_arg<int>(reader, store);
+          break;
+        case arg_type::u32:
+          ok = read_arg<unsigned>(reader, store);
+          break;
+        case arg_type::i64:
+          ok = read_arg<long long>(reader, store);
+          break;
+        case arg_type::u64:
+          ok = read_arg<unsigned long long>(reader, store);
+          break;
+        case arg_type::boolean:
+          ok = read_arg<bool>(reader, store);
+          break;
+        case arg_type::chr:
+          ok = read_arg<char>(reader, store);
+          break;
+        case arg_type::f32:
+          ok = read_arg<float>(reader, store);
+          break;
+        case arg_type::f64:
+          ok = read_arg<double>(reader, store);
+          break;
+        case arg_type::f_long:
+          ok = read_arg<long double>(reader, store);
+          break;
+        case arg_type::ptr: {
+          uint64_t ptr;
+          ok = reader.read(ptr);
+          if (ok) {
+            store.push_back(reinterpret_cast<const void*>(ptr));
+          }
+          break;
+        }
+        case arg_type::str: {
+          uint32_t       size;
+          const uint8_t* chars;
+          ok = reader.read(size) && reader.read_bytes(size, chars);
+          if (ok) {
+            store.push_back(std::string(reinterpret_cast<const char*>(chars), size));
+          }
+          break;
+        }
+        default:
+          ok = false;
+          break;
+      }
+      if (!ok) {
+        error = fmt::format("Invalid argument #{} in log entry", i);
+        return false;
+      }
+    }
+  }
+
+  uint32_t       hex_size;
+  const uint8_t* hex_bytes;
+  if (!reader.read(hex_size) || !reader.read_bytes(hex_size, hex_bytes)) {
+    error = "Truncated log entry";
+    return false;
+  }
+
+  detail::log_entry_metadata md;
+  md.tp = std::chrono::high_resolution_clock::time_point(
+      std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::nanoseconds(ts_ns)));
+  md.context   = {ctx_value, (flags & flag_context_enabled) != 0};
+  md.fmtstring = fmtstring ? fmtstring->c_str() : nullptr;
+  md.store     = (flags & flag_has_args) ? &store : nullptr;
+  md.log_name  = log_name ? *log_name : std::string();
+  md.log_tag   = tag;
+  md.hex_dump.assign(hex_bytes, hex_bytes + hex_size);
+
+  formatter.format(std::move(md), buffer);
+  ++nof_entries;
+
+  return true;
+}
+
+bool binary_log_decoder::decode_record(record_type type, const uint8_t* payload, size_t len, fmt::memory_buffer& buffer)
+{
+  switch (type) {
+    case record_type::string_def: {
+      uint32_t id;
+      if (len < sizeof(id)) {
+        error = "Truncated string definition";
+        return false;
+      }
+      std::memcpy(&id, payload, sizeof(id));
+      strings[id].assign(reinterpret_cast<const char*>(payload) + sizeof(id), len - sizeof(id));
+      return true;
+    }
+    case record_type::entry:
+      return decode_entry(payload, len, buffer);
+    case record_type::text:
+      buffer.append(payload, payload + len);
+      ++nof_entries;
+      return true;
+  }
+
+  error = fmt::format("Unknown record type {}", static_cast<unsigned>(type));
+  return false;
+}
+
+size_t binary_log_decoder::decode(const uint8_t* data, size_t len, fmt::memory_buffer& buffer)
+{
+  if (has_error()) {
+    return 0;
+  }
+
+  size_t consumed = 0;
+  if (!header_read) {
+    if (len < header_size) {
+      return 0;
+    }
+    uint32_t stream_version;
+    std::memcpy(&stream_version, data + magic_size, sizeof(stream_version));
+    if (std::memcmp(data, magic, magic_size) != 0) {
+      error = "Invalid stream header, this is not a binary log";
+      return 0;
+    }
+    if (stream_version != version) {
+      error = fmt::format("Unsupported binary log version {}, expected {}", stream_version, version);
+      return 0;
+    }
+    header_read = true;
+    consumed    = header_size;
+  }
+
+  while (len - consumed >= record_hdr_size) {
+    uint8_t  type;
+    uint32_t payload_size;
+    std::memcpy(&type, data + consumed, sizeof(type));
+    std::memcpy(&payload_size, data + consumed + sizeof(type), sizeof(payload_size));
+    if (len - consumed - record_hdr_size < payload_size) {
+      break;
+    }
+    if (!decode_record(static_cast<record_type>(type), data + consumed + record_hdr_size, payload_size, buffer)) {
+      break;
+    }
+    consumed += record_hdr_size + payload_size;
+  }
+
+  return consumed;
+}
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLOG_BINARY_FORMATTER_H
+#define SRSLOG_BINARY_FORMATTER_H
+
+#include "text_formatter.h"
+#include "srsran/srslog/detail/log_entry_metadata.h"
+#include <unordered_map>
+
+namespace srslog {
+
+/// Definitions of the binary log stream.
+/// The stream starts with a header, followed by a sequence of records. Each record starts with a one byte record type
+/// and the 4 byte length of its payload. All integers use the byte order of the host that wrote the stream.
+namespace binary_log {
+
+/// Stream header: magic string followed by the 4 byte format version.
+constexpr char     magic[]         = "SRSLOGB";
+constexpr size_t   magic_size      = sizeof(magic);
+constexpr uint32_t version         = 1;
+constexpr size_t   header_size     = magic_size + sizeof(uint32_t);
+constexpr size_t   record_hdr_size = sizeof(uint8_t) + sizeof(uint32_t);
+
+enum class record_type : uint8_t {
+  /// Defines a string that is referenced by id in the following records.
+  /// Payload: uint32 id, string chars.
+  string_def = 1,
+  /// Log entry with the raw format arguments.
+  /// Payload: int64 time stamp in ns, uint32 format string id, uint32 log name id, uint32 context value, char tag,
+  /// uint8 flags, uint8 number of args, args (uint8 arg_type + value), uint32 hex dump size, hex dump bytes.
+  entry = 2,
+  /// Entry that has already been formatted as text, used for context dumps and for arguments that can not be
+  /// serialized. Payload: text chars.
+  text = 3
+};
+
+/// Types of the serialized format arguments.
+/// Fixed size values are stored as raw bytes, strings as uint32 size followed by the chars.
+enum class arg_type : uint8_t { i32, u32, i64, u64, boolean, chr, f32, f64, f_long, str, ptr };
+
+/// Entry flags.
+constexpr uint8_t flag_context_enabled = 1u << 0;
+constexpr uint8_t flag_has_args        = 1u << 1;
+
+/// Id used for empty strings.
+constexpr uint32_t null_string_id = 0;
+
+} // namespace binary_log
+
+/// Binary formatter implementation class.
+/// Instead of formatting the message, it writes compact records with the format string interned as an id, the raw time
+/// stamp and context, and the format arguments as stored in the dynamic argument store. This moves the cost of text
+/// formatting out of the backend worker into the offline decoder (see binary_log_decoder).
+/// Context dumps are written as pre-formatted text records.
+/// NOTE: The emitted string definitions are only valid for the stream being written by this formatter instance, so the
+/// formatter must not be shared by several sinks and the stream must be decoded from its beginning.
+class binary_formatter : public text_formatter
+{
+public:
+  binary_formatter() = default;
+
+  std::unique_ptr<log_formatter> clone() const override;
+
+  void format(detail::log_entry_metadata&& metadata, fmt::memory_buffer& buffer) override;
+
+private:
+  void format_context_begin(const detail::log_entry_metadata& md,
+                            fmt::string_view                  ctx_name,
+                            unsigned                          size,
+                            fmt::memory_buffer&               buffer) override;
+
+  void format_context_end(const detail::log_entry_metadata& md,
+                          fmt::string_view                  ctx_name,
+                          fmt::memory_buffer&               buffer) override;
+
+  /// Writes the stream header if it has not been written yet.
+  void write_header_once(fmt::memory_buffer& buffer);
+
+  /// Returns the id of the specified format string, defining it in the stream when it is seen for the first time.
+  uint32_t get_fmtstring_id(const char* str, fmt::memory_buffer& buffer);
+
+  /// Returns the id of the specified log name, defining it in the stream when it is seen for the first time.
+  uint32_t get_log_name_id(const std::string& name, fmt::memory_buffer& buffer);
+
+  /// Appends a string definition record into the buffer and returns its new id.
+  uint32_t define_string(fmt::string_view str, fmt::memory_buffer& buffer);
+
+  /// Serializes the format arguments into the buffer. Returns false if any of them can not be serialized.
+  static bool write_args(const fmt::dynamic_format_arg_store<fmt::printf_context>& store, fmt::memory_buffer& buffer);
+
+  /// Appends the entry as a text record, formatted with the text formatter.
+  void write_text_record(detail::log_entry_metadata&& metadata, fmt::memory_buffer& buffer);
+
+private:
+  /// Interned format string, keyed by its address. The contents are kept to detect when the address is reused by a
+  /// different string.
+  struct fmtstring_def {
+    uint32_t    id;
+    std::string str;
+  };
+
+  bool                                           header_written    = false;
+  uint32_t                                       next_string_id    = binary_log::null_string_id + 1;
+  std::unordered_map<const char*, fmtstring_def> fmtstrings;
+  std::unordered_map<std::string, uint32_t>      log_names;
+  size_t                                         ctx_record_offset = 0;
+};
+
+/// Decodes binary log streams written by the binary formatter, rendering the entries as plain text with the same
+/// format as the text formatter.
+/// The stream can be fed in chunks of any size, partial records are left unconsumed for the next call.
+class binary_log_decoder
+{
+public:
+  /// Decodes the complete records found in the input data, appending the rendered text into the buffer.
+  /// Returns the number of consumed bytes, the remaining ones belong to a partial record and should be provided again
+  /// with the next chunk of the stream. On error, decoding stops and the error can be retrieved with get_error().
+  size_t decode(const uint8_t* data, size_t len, fmt::memory_buffer& buffer);
+
+  /// Returns true if an invalid stream has been found.
+  bool has_error() const { return !error.empty(); }
+
+  /// Returns the description of the error found in the stream.
+  const std::string& get_error() const { return error; }
+
+  /// Returns the number of log entries decoded so far.
+  uint64_t get_nof_decoded_entries() const { return nof_entries; }
+
+private:
+  /// Decodes a single record payload. Returns false on error.
+  bool decode_record(binary_log::record_type type, const uint8_t* payload, size_t len, fmt::memory_buffer& buffer);
+
+  /// Decodes an entry record payload. Returns false on error.
+  bool decode_entry(const uint8_t* payload, size_t len, fmt::memory_buffer& buffer);
+
+  /// Returns the string associated to the id, or nullptr when it has not been defined.
+  const std::string* find_string(uint32_t id) const;
+
+private:
+  bool                                               header_read = false;
+  uint64_t                                           nof_entries = 0;
+  std::string                                        error;
+  std::unordered_map<uint32_t, std::string>          strings;
+  fmt::dynamic_format_arg_store<fmt::printf_context> store;
+  text_formatter                                     formatter;
+};
+
+} // namespace srslog
+
+#endif // SRSLOG_BINARY_FORMATTER_H
@@ -36,7 +36,7 @@ public:
 
   void format(detail::log_entry_metadata&& metadata, fmt::memory_buffer& buffer) override;
 
-private:
+protected:
   void format_context_begin(const detail::log_entry_metadata& md,
                             fmt::string_view                  ctx_name,
                             unsigned                          size,
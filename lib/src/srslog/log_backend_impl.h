@@ -24,46 +24,194 @@
 
 #include "backend_worker.h"
 #include "srsran/srslog/detail/log_backend.h"
+#include <algorithm>
 
 namespace srslog {
 
-/// This class implements the log backend interface. It internally manages a
-/// worker thread to process incoming log entries.
+/// This class implements the log backend interface. It internally manages one
+/// or more worker threads to process incoming log entries. Each worker has its
+/// own lock-free queue and processes the entries of a subset of the sinks, so
+/// that entries of the same sink are always written in order by the same thread.
 /// NOTE: Thread safe class.
 class log_backend_impl : public detail::log_backend
 {
 public:
-  log_backend_impl() = default;
+  log_backend_impl() { set_nof_workers(1); }
 
   log_backend_impl(const log_backend_impl& other) = delete;
   log_backend_impl& operator=(const log_backend_impl& other) = delete;
 
-  void start(backend_priority priority = backend_priority::normal) override { worker.start(priority); }
+  void start(backend_priority priority = backend_priority::normal) override
+  {
+    for (auto& w : workers) {
+      w->worker.start(priority);
+    }
+  }
 
   bool push(detail::log_entry&& entry) override
   {
-    auto* arg_store = entry.metadata.store;
-    if (!queue.push(std::move(entry))) {
-      arg_pool.dealloc(arg_store);
+    if (entry.flush_cmd && workers.size() > 1) {
+      push_flush_cmd(std::move(entry));
+      return true;
+    }
+
+    auto& queue = get_worker(entry.s).queue;
+    if (queue.push(std::move(entry))) {
+      return true;
+    }
+    // Flush commands are retried by the caller.
+    if (entry.flush_cmd) {
       return false;
     }
-    return true;
+    if (policy == backend_overflow_policy::block) {
+      // Wait for the backend to make room while it is able to do so.
+      while (is_running()) {
+        if (queue.push(std::move(entry))) {
+          return true;
+        }
+        std::this_thread::yield();
+      }
+    }
+
+    arg_pool.dealloc(entry.metadata.store);
+    nof_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  fmt::dynamic_format_arg_store<fmt::printf_context>* alloc_arg_store() override
+  {
+    auto* p = arg_pool.alloc();
+    if (p) {
+      return p;
+    }
+    // All stores are in use by queued entries, which means the backend is behind.
+    if (policy == backend_overflow_policy::block) {
+      while (is_running()) {
+        if ((p = arg_pool.alloc())) {
+          return p;
+        }
+        std::this_thread::yield();
+      }
+    }
+    nof_dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  bool is_running() const override { return workers.front()->worker.is_running(); }
+
+  /// Installs the specified error handler into the backend workers.
+  void set_error_handler(error_handler err_handler)
+  {
+    handler            = std::move(err_handler);
+    has_custom_handler = true;
+    for (auto& w : workers) {
+      w->worker.set_error_handler(handler);
+    }
+  }
+
+  /// Sets the policy applied when a new log entry does not fit in the backend.
+  void set_overflow_policy(backend_overflow_policy new_policy) { policy = new_policy; }
+
+  /// Sets the number of worker threads. Only increasing the number of workers
+  /// is supported, and calls to this method when the backend is running will
+  /// get ignored. The queue capacity is split among the workers, so the memory
+  /// of the backend does not grow with the number of workers.
+  /// NOTE: This function is NOT thread safe.
+  void set_nof_workers(unsigned nof_workers)
+  {
+    if (nof_workers <= workers.size() || (!workers.empty() && is_running())) {
+      return;
+    }
+
+    // Entries pushed before the backend started are routed again, since
+    // sinks get spread among the new set of workers.
+    std::vector<detail::log_entry> pending;
+    for (auto& w : workers) {
+      for (auto item = w->queue.try_pop(); item.first; item = w->queue.try_pop()) {
+        pending.push_back(std::move(item.second));
+      }
+    }
+
+    workers.clear();
+    size_t queue_capacity = std::max<size_t>(SRSLOG_QUEUE_CAPACITY / nof_workers, 1);
+    while (workers.size() < nof_workers) {
+      workers.emplace_back(new worker_context(arg_pool, queue_capacity));
+      if (has_custom_handler) {
+        workers.back()->worker.set_error_handler(handler);
+      }
+    }
+    for (auto& entry : pending) {
+      push(std::move(entry));
+    }
+  }
+
+  /// Returns the number of worker threads.
+  unsigned get_nof_workers() const { return workers.size(); }
+
+  /// Returns the number of log entries discarded since the backend was created.
+  uint64_t get_nof_dropped_entries() const { return nof_dropped.load(std::memory_order_relaxed); }
+
+  /// Stops the backend worker threads.
+  void stop()
+  {
+    for (auto& w : workers) {
+      w->worker.stop();
+    }
   }
 
-  fmt::dynamic_format_arg_store<fmt::printf_context>* alloc_arg_store() override { return arg_pool.alloc(); }
+private:
+  /// Queue and thread of a backend worker.
+  struct worker_context {
+    worker_context(detail::dyn_arg_store_pool& arg_pool, size_t queue_capacity) :
+      queue(queue_capacity), worker(queue, arg_pool)
+    {}
+
+    detail::work_queue<detail::log_entry> queue;
+    backend_worker                        worker;
+  };
 
-  bool is_running() const override { return worker.is_running(); }
+  /// Returns the index of the worker that processes the entries of the specified sink.
+  unsigned get_worker_index(const sink* s) const
+  {
+    if (workers.size() == 1) {
+      return 0;
+    }
+    // Fibonacci hashing of the sink address spreads the sinks evenly among the workers.
+    uint64_t h = reinterpret_cast<uintptr_t>(s) * 0x9e3779b97f4a7c15ULL;
+    return (h >> 32) % workers.size();
+  }
 
-  /// Installs the specified error handler into the backend worker.
-  void set_error_handler(error_handler err_handler) { worker.set_error_handler(std::move(err_handler)); }
+  worker_context& get_worker(const sink* s) { return *workers[get_worker_index(s)]; }
 
-  /// Stops the backend worker thread.
-  void stop() { worker.stop(); }
+  /// Splits a flush command among the workers, each one flushing its own sinks.
+  /// The last worker to finish notifies the caller.
+  void push_flush_cmd(detail::log_entry&& cmd)
+  {
+    std::vector<std::vector<sink*> > worker_sinks(workers.size());
+    for (auto* s : cmd.flush_cmd->sinks) {
+      worker_sinks[get_worker_index(s)].push_back(s);
+    }
+
+    auto pending = std::make_shared<std::atomic<unsigned> >(workers.size());
+    for (unsigned i = 0, e = workers.size(); i != e; ++i) {
+      detail::log_entry worker_cmd;
+      worker_cmd.metadata.store = nullptr;
+      worker_cmd.flush_cmd      = std::unique_ptr<detail::flush_backend_cmd>(
+          new detail::flush_backend_cmd{cmd.flush_cmd->completion_flag, std::move(worker_sinks[i]), pending});
+      // Each command has to get into its queue, since the caller waits for all of them.
+      while (!workers[i]->queue.push(std::move(worker_cmd))) {
+        std::this_thread::yield();
+      }
+    }
+  }
 
 private:
-  detail::work_queue<detail::log_entry> queue;
-  detail::dyn_arg_store_pool            arg_pool;
-  backend_worker                        worker{queue, arg_pool};
+  detail::dyn_arg_store_pool                    arg_pool;
+  std::vector<std::unique_ptr<worker_context> > workers;
+  error_handler                                 handler;
+  bool                                          has_custom_handler = false;
+  backend_overflow_policy                       policy             = backend_overflow_policy::discard;
+  std::atomic<uint64_t>                         nof_dropped{0};
 };
 
 } // namespace srslog
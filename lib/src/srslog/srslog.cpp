@@ -20,6 +20,7 @@
  */
 
 #include "srsran/srslog/srslog.h"
+#include "formatters/binary_formatter.h"
 #include "formatters/json_formatter.h"
 #include "sinks/file_sink.h"
 #include "sinks/syslog_sink.h"
@@ -105,6 +106,11 @@ std::unique_ptr<log_formatter> srslog::create_json_formatter()
   return std::unique_ptr<log_formatter>(new json_formatter);
 }
 
+std::unique_ptr<log_formatter> srslog::create_binary_formatter()
+{
+  return std::unique_ptr<log_formatter>(new binary_formatter);
+}
+
 ///
 /// Sink management function implementations.
 ///
@@ -178,6 +184,11 @@ sink& srslog::fetch_file_sink(const std::string&             path,
   return *s;
 }
 
+sink& srslog::fetch_binary_file_sink(const std::string& path, bool force_flush)
+{
+  return fetch_file_sink(path, 0, force_flush, create_binary_formatter());
+}
+
 sink& srslog::fetch_syslog_sink(const std::string&             preamble_,
                                 syslog_local_type              log_local_,
                                 std::unique_ptr<log_formatter> f)
@@ -258,6 +269,21 @@ void srslog::set_error_handler(error_handler handler)
   srslog_instance::get().set_error_handler(std::move(handler));
 }
 
+void srslog::set_backend_overflow_policy(backend_overflow_policy policy)
+{
+  srslog_instance::get().set_backend_overflow_policy(policy);
+}
+
+void srslog::set_nof_backend_workers(unsigned nof_workers)
+{
+  srslog_instance::get().set_nof_backend_workers(nof_workers);
+}
+
+uint64_t srslog::get_nof_dropped_entries()
+{
+  return srslog_instance::get().get_nof_dropped_entries();
+}
+
 ///
 /// Logger management function implementations.
 ///
@@ -88,6 +88,15 @@ public:
   /// Installs the specified error handler into the backend.
   void set_error_handler(error_handler callback) { backend.set_error_handler(std::move(callback)); }
 
+  /// Sets the overflow policy of the backend.
+  void set_backend_overflow_policy(backend_overflow_policy policy) { backend.set_overflow_policy(policy); }
+
+  /// Sets the number of backend worker threads.
+  void set_nof_backend_workers(unsigned nof_workers) { backend.set_nof_workers(nof_workers); }
+
+  /// Returns the number of log entries discarded by the backend.
+  uint64_t get_nof_dropped_entries() const { return backend.get_nof_dropped_entries(); }
+
   /// Set the specified sink as the default one.
   void set_default_sink(sink& s) { default_sink = &s; }
 
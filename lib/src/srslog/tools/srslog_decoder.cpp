@@ -0,0 +1,102 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/// Renders as plain text the binary logs written by the srslog binary formatter.
+/// Usage: srslog_decoder <input file | -> [output file]
+
+#include "../formatters/binary_formatter.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace srslog;
+
+static void usage(const char* prog)
+{
+  fmt::print(stderr,
+             "Usage: {} <input file> [output file]\n"
+             "Decodes a binary srslog file into plain text. Use '-' to read from stdin. The text is written to stdout "
+             "when no output file is specified.\n",
+             prog);
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2 || argc > 3 || !std::strcmp(argv[1], "-h") || !std::strcmp(argv[1], "--help")) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  bool  from_stdin = !std::strcmp(argv[1], "-");
+  FILE* in         = from_stdin ? stdin : std::fopen(argv[1], "rb");
+  if (!in) {
+    fmt::print(stderr, "Unable to open input file \"{}\": {}\n", argv[1], std::strerror(errno));
+    return 1;
+  }
+  FILE* out = (argc == 3) ? std::fopen(argv[2], "w") : stdout;
+  if (!out) {
+    fmt::print(stderr, "Unable to open output file \"{}\": {}\n", argv[2], std::strerror(errno));
+    return 1;
+  }
+
+  binary_log_decoder   decoder;
+  fmt::memory_buffer   text;
+  std::vector<uint8_t> chunk(1u << 20);
+  size_t               pending = 0;
+
+  // Feed the decoder with chunks of the file, moving the bytes of partial records to the start of the next chunk.
+  while (size_t nof_read = std::fread(chunk.data() + pending, 1, chunk.size() - pending, in)) {
+    size_t len      = pending + nof_read;
+    size_t consumed = decoder.decode(chunk.data(), len, text);
+    if (decoder.has_error()) {
+      break;
+    }
+
+    std::fwrite(text.data(), 1, text.size(), out);
+    text.clear();
+
+    pending = len - consumed;
+    std::memmove(chunk.data(), chunk.data() + consumed, pending);
+    // Grow the chunk when a single record does not fit.
+    if (pending == chunk.size()) {
+      chunk.resize(chunk.size() * 2);
+    }
+  }
+  std::fwrite(text.data(), 1, text.size(), out);
+
+  int ret = 0;
+  if (decoder.has_error()) {
+    fmt::print(stderr, "Error decoding \"{}\": {}\n", argv[1], decoder.get_error());
+    ret = 1;
+  } else if (pending) {
+    fmt::print(stderr, "Warning: discarded {} bytes of a truncated record at the end of the file\n", pending);
+  }
+  fmt::print(stderr, "Decoded {} log entries\n", decoder.get_nof_decoded_entries());
+
+  if (!from_stdin) {
+    std::fclose(in);
+  }
+  if (out != stdout) {
+    std::fclose(out);
+  }
+
+  return ret;
+}
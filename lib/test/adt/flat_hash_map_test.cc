@@ -0,0 +1,129 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/adt/flat_hash_map.h"
+#include "srsran/common/test_common.h"
+#include <map>
+#include <memory>
+#include <random>
+
+namespace srsran {
+
+void test_flat_hash_map_basic()
+{
+  flat_hash_map<uint32_t, std::string> myobj;
+  TESTASSERT(myobj.size() == 0 and myobj.empty());
+  TESTASSERT(myobj.begin() == myobj.end());
+
+  TESTASSERT(not myobj.contains(0));
+  TESTASSERT(myobj.insert(0, "obj0").second);
+  TESTASSERT(myobj.contains(0) and myobj[0] == "obj0");
+  TESTASSERT(myobj.size() == 1 and not myobj.empty());
+  TESTASSERT(myobj.begin() != myobj.end());
+
+  TESTASSERT(not myobj.insert(0, "obj1").second);
+  TESTASSERT(myobj[0] == "obj0");
+  TESTASSERT(myobj.insert(1, "obj1").second);
+  TESTASSERT(myobj.count(1) == 1 and myobj.count(2) == 0);
+  TESTASSERT(myobj.find(1) != myobj.end());
+  TESTASSERT(myobj.find(1)->first == 1 and myobj.find(1)->second == "obj1");
+  TESTASSERT(myobj.find_value(2) == nullptr);
+  TESTASSERT(*myobj.find_value(1) == "obj1");
+
+  // operator[] inserts default constructed value
+  myobj[2] += "obj2";
+  TESTASSERT(myobj.size() == 3 and myobj[2] == "obj2");
+
+  // TEST: iteration
+  uint32_t count = 0;
+  for (const std::pair<uint32_t, std::string>& obj : myobj) {
+    TESTASSERT(obj.second == "obj" + std::to_string(obj.first));
+    count++;
+  }
+  TESTASSERT(count == 3);
+
+  TESTASSERT(myobj.erase(0) == 1);
+  TESTASSERT(myobj.erase(0) == 0);
+  TESTASSERT(myobj.size() == 2 and not myobj.contains(0));
+  myobj.clear();
+  TESTASSERT(myobj.size() == 0 and myobj.empty() and myobj.begin() == myobj.end());
+}
+
+void test_flat_hash_map_random_ops()
+{
+  // Compare against std::map under random insertions and erasures, including table growth
+  std::mt19937                            rng(0);
+  std::uniform_int_distribution<uint32_t> key_dist(0, 4095);
+  flat_hash_map<uint32_t, uint32_t>       hmap(4);
+  std::map<uint32_t, uint32_t>            ref;
+
+  for (uint32_t i = 0; i < 100000; ++i) {
+    uint32_t key = key_dist(rng);
+    if (rng() % 3 == 0) {
+      TESTASSERT(hmap.erase(key) == ref.erase(key));
+    } else {
+      TESTASSERT(hmap.insert(key, i).second == ref.insert(std::make_pair(key, i)).second);
+    }
+    TESTASSERT(hmap.size() == ref.size());
+  }
+  for (const auto& e : ref) {
+    TESTASSERT(hmap.contains(e.first) and hmap[e.first] == e.second);
+  }
+  size_t count = 0;
+  for (const auto& e : hmap) {
+    TESTASSERT(ref.count(e.first) == 1 and ref[e.first] == e.second);
+    count++;
+  }
+  TESTASSERT(count == ref.size());
+  TESTASSERT(2 * hmap.size() <= hmap.capacity());
+}
+
+void test_flat_hash_map_move_only()
+{
+  flat_hash_map<uint64_t, std::unique_ptr<int> > myobj;
+  for (uint64_t i = 0; i < 100; ++i) {
+    TESTASSERT(myobj.insert(i << 32U, std::unique_ptr<int>(new int(i))).second);
+  }
+  for (uint64_t i = 0; i < 100; i += 2) {
+    TESTASSERT(myobj.erase(i << 32U) == 1);
+  }
+  TESTASSERT(myobj.size() == 50);
+  for (uint64_t i = 1; i < 100; i += 2) {
+    TESTASSERT(*myobj[i << 32U] == (int)i);
+  }
+}
+
+} // namespace srsran
+
+int main(int argc, char** argv)
+{
+  auto& test_log = srslog::fetch_basic_logger("TEST");
+  test_log.set_level(srslog::basic_levels::info);
+
+  srsran::test_init(argc, argv);
+
+  srsran::test_flat_hash_map_basic();
+  srsran::test_flat_hash_map_random_ops();
+  srsran::test_flat_hash_map_move_only();
+
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/adt/lockfree_queue.h"
+#include "srsran/common/test_common.h"
+#include <thread>
+
+namespace srsran {
+
+struct C {
+  C() { count++; }
+  C(int v) : val(new int(v)) { count++; }
+  ~C() { count--; }
+  C(C&& other) : val(std::move(other.val)) { count++; }
+  C& operator=(C&&) = default;
+
+  std::unique_ptr<int> val;
+
+  static size_t count;
+};
+size_t C::count = 0;
+
+void test_mpsc_queue_single_thread()
+{
+  {
+    bounded_mpsc_queue<C> q(5);
+    TESTASSERT(q.capacity() == 8);
+
+    C c;
+    TESTASSERT(not q.try_pop(c));
+
+    // push until full
+    for (int i = 0; i < 8; ++i) {
+      TESTASSERT(q.try_push(C{i}));
+    }
+    C c2{8};
+    TESTASSERT(not q.try_push(std::move(c2)));
+    TESTASSERT(c2.val != nullptr and *c2.val == 8);
+
+    // pop in FIFO order, and wrap around the ring
+    for (int i = 0; i < 20; ++i) {
+      TESTASSERT(q.try_pop(c));
+      TESTASSERT(*c.val == i);
+      TESTASSERT(q.try_push(C{i + 8}));
+    }
+    TESTASSERT(C::count == 8 + 2);
+  }
+  // elements left in the queue are destroyed
+  TESTASSERT(C::count == 0);
+}
+
+void test_mpsc_queue_multiple_producers()
+{
+  const int                nof_producers = 4, nof_values = 100000;
+  bounded_mpsc_queue<int>  q(64);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < nof_producers; ++p) {
+    producers.emplace_back([&q, p]() {
+      for (int i = 0; i < nof_values; ++i) {
+        while (not q.try_push(p * nof_values + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // The values of each producer are popped in order
+  std::vector<int> next_value(nof_producers, 0);
+  for (int count = 0; count < nof_producers * nof_values;) {
+    int val;
+    if (not q.try_pop(val)) {
+      std::this_thread::yield();
+      continue;
+    }
+    int p = val / nof_values;
+    TESTASSERT(val % nof_values == next_value[p]);
+    next_value[p]++;
+    count++;
+  }
+  for (std::thread& t : producers) {
+    t.join();
+  }
+  int val;
+  TESTASSERT(not q.try_pop(val));
+}
+
+void test_mpmc_queue_multiple_consumers()
+{
+  const int                nof_threads = 4, nof_values = 100000;
+  bounded_mpmc_queue<int>  q(64);
+  std::atomic<long>        sum{0};
+  std::atomic<int>         count{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < nof_threads; ++p) {
+    threads.emplace_back([&q, p]() {
+      for (int i = 0; i < nof_values; ++i) {
+        while (not q.try_push(p * nof_values + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (int c = 0; c < nof_threads; ++c) {
+    threads.emplace_back([&]() {
+      while (count.load(std::memory_order_relaxed) < nof_threads * nof_values) {
+        int val;
+        if (not q.try_pop(val)) {
+          std::this_thread::yield();
+          continue;
+        }
+        sum.fetch_add(val, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  // Every value is popped exactly once
+  long n = static_cast<long>(nof_threads) * nof_values;
+  TESTASSERT(count == nof_threads * nof_values);
+  TESTASSERT(sum == n * (n - 1) / 2);
+  TESTASSERT(q.size() == 0);
+}
+
+} // namespace srsran
+
+int main(int argc, char** argv)
+{
+  auto& test_log = srslog::fetch_basic_logger("TEST");
+  test_log.set_level(srslog::basic_levels::info);
+
+  srsran::test_init(argc, argv);
+
+  srsran::test_mpsc_queue_single_thread();
+  srsran::test_mpsc_queue_multiple_producers();
+  srsran::test_mpmc_queue_multiple_consumers();
+  srsran::console("Success\n");
+  return SRSRAN_SUCCESS;
+}
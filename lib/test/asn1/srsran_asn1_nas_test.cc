@@ -20,6 +20,7 @@
  */
 
 #include "srsran/asn1/liblte_mme.h"
+#include "srsran/asn1/liblte_utils.h"
 #include "srsran/srslog/srslog.h"
 #include <iostream>
 #include <srsran/common/buffer_pool.h>
@@ -59,12 +60,12 @@ int nas_dedicated_eps_bearer_context_setup_request_test()
 
   // Test message type and protocol discriminator
   uint8_t pd, msg_type;
-  liblte_mme_parse_msg_header((LIBLTE_BYTE_MSG_STRUCT*)tst_msg.get(), &pd, &msg_type);
+  liblte_mme_parse_msg_header(srsran::liblte_unpack_msg(tst_msg.get()).get(), &pd, &msg_type);
   TESTASSERT(msg_type == LIBLTE_MME_MSG_TYPE_ACTIVATE_DEDICATED_EPS_BEARER_CONTEXT_REQUEST);
 
   // Unpack message
-  err = liblte_mme_unpack_activate_dedicated_eps_bearer_context_request_msg((LIBLTE_BYTE_MSG_STRUCT*)tst_msg.get(),
-                                                                            &ded_bearer_req);
+  err = liblte_mme_unpack_activate_dedicated_eps_bearer_context_request_msg(
+      srsran::liblte_unpack_msg(tst_msg.get()).get(), &ded_bearer_req);
   TESTASSERT(err == LIBLTE_SUCCESS);
 
   // Check EPS bearer identity
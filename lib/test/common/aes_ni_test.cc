@@ -0,0 +1,228 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/aes_ni.h"
+#include "srsran/common/liblte_security.h"
+#include "srsran/common/ssl.h"
+#include "srsran/common/test_common.h"
+#include <random>
+#include <vector>
+
+/*
+ * Checks that the AES-NI and VAES implementations are bit-exact with the portable AES of the security library
+ */
+
+static std::mt19937 rand_gen(0);
+
+static void fill_random(uint8_t* data, uint32_t len)
+{
+  std::uniform_int_distribution<int> dist(0, 255);
+  for (uint32_t i = 0; i < len; i++) {
+    data[i] = (uint8_t)dist(rand_gen);
+  }
+}
+
+int test_encrypt_block(aes_ni_impl_t impl)
+{
+  for (uint32_t n = 0; n < 100; n++) {
+    uint8_t key[16], in[16], out_ref[16], out[16];
+    fill_random(key, sizeof(key));
+    fill_random(in, sizeof(in));
+
+    aes_context ctx;
+    TESTASSERT(aes_setkey_enc(&ctx, key, 128) == 0);
+    TESTASSERT(aes_crypt_ecb(&ctx, AES_ENCRYPT, in, out_ref) == 0);
+
+    aes_ni_key_t ni_key;
+    TESTASSERT(aes_ni_setkey_enc(&ni_key, key, impl) == 0);
+    TESTASSERT(ni_key.impl == impl);
+    aes_ni_encrypt_block(&ni_key, in, out);
+    TESTASSERT(memcmp(out, out_ref, sizeof(out)) == 0);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int test_crypt_ctr(aes_ni_impl_t impl)
+{
+  // Lengths covering the pipelined, single-block and partial block paths
+  std::vector<uint32_t> lens;
+  for (uint32_t len = 0; len <= 300; len++) {
+    lens.push_back(len);
+  }
+  lens.push_back(1500);
+  lens.push_back(9000);
+
+  for (uint32_t len : lens) {
+    uint8_t key[16], nonce[16];
+    fill_random(key, sizeof(key));
+    fill_random(nonce, sizeof(nonce));
+    if (len % 2 == 0) {
+      // Carry from the lower to the upper 64 bits of the counter
+      memset(&nonce[8], 0xff, 7);
+    }
+    std::vector<uint8_t> in(len), out_ref(len), out(len);
+    fill_random(in.data(), len);
+
+    aes_context   ctx;
+    uint8_t       nonce_ref[16], stream_blk[16] = {};
+    size_t        nc_off = 0;
+    memcpy(nonce_ref, nonce, sizeof(nonce));
+    TESTASSERT(aes_setkey_enc(&ctx, key, 128) == 0);
+    TESTASSERT(aes_crypt_ctr(&ctx, len, &nc_off, nonce_ref, stream_blk, in.data(), out_ref.data()) == 0);
+
+    aes_ni_key_t ni_key;
+    TESTASSERT(aes_ni_setkey_enc(&ni_key, key, impl) == 0);
+    aes_ni_crypt_ctr(&ni_key, nonce, in.data(), out.data(), len);
+    TESTASSERT(out == out_ref);
+    TESTASSERT(memcmp(nonce, nonce_ref, sizeof(nonce)) == 0);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int test_crypt_ctr_batch(aes_ni_impl_t impl)
+{
+  uint8_t key[16];
+  fill_random(key, sizeof(key));
+  aes_ni_key_t ni_key;
+  TESTASSERT(aes_ni_setkey_enc(&ni_key, key, impl) == 0);
+
+  std::uniform_int_distribution<uint32_t> len_dist(0, 300);
+  for (uint32_t nof_msgs = 0; nof_msgs <= 40; nof_msgs++) {
+    std::vector<std::vector<uint8_t> > in(nof_msgs), out_ref(nof_msgs), out(nof_msgs);
+    std::vector<aes_ni_ctr_msg_t>      msgs(nof_msgs);
+    for (uint32_t i = 0; i < nof_msgs; i++) {
+      uint32_t len = len_dist(rand_gen);
+      in[i].resize(len);
+      fill_random(in[i].data(), len);
+      out_ref[i].resize(len);
+      fill_random(msgs[i].nonce_counter, sizeof(msgs[i].nonce_counter));
+
+      uint8_t nonce_ref[16];
+      memcpy(nonce_ref, msgs[i].nonce_counter, sizeof(nonce_ref));
+      aes_ni_crypt_ctr(&ni_key, nonce_ref, in[i].data(), out_ref[i].data(), len);
+
+      // Every other message is ciphered in place
+      if (i % 2 == 0) {
+        out[i] = in[i];
+        msgs[i].in = out[i].data();
+      } else {
+        out[i].resize(len);
+        msgs[i].in = in[i].data();
+      }
+      msgs[i].out = out[i].data();
+      msgs[i].len = len;
+    }
+    aes_ni_crypt_ctr_batch(&ni_key, msgs.data(), nof_msgs);
+    for (uint32_t i = 0; i < nof_msgs; i++) {
+      TESTASSERT(out[i] == out_ref[i]);
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int test_cbc_mac(aes_ni_impl_t impl)
+{
+  for (uint32_t nof_blocks = 0; nof_blocks < 100; nof_blocks++) {
+    uint8_t key[16], state_ref[16], state[16], tmp[16];
+    fill_random(key, sizeof(key));
+    fill_random(state_ref, sizeof(state_ref));
+    memcpy(state, state_ref, sizeof(state));
+    std::vector<uint8_t> in(nof_blocks * 16);
+    fill_random(in.data(), in.size());
+
+    aes_context ctx;
+    TESTASSERT(aes_setkey_enc(&ctx, key, 128) == 0);
+    for (uint32_t i = 0; i < nof_blocks; i++) {
+      for (uint32_t j = 0; j < 16; j++) {
+        tmp[j] = state_ref[j] ^ in[i * 16 + j];
+      }
+      TESTASSERT(aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, state_ref) == 0);
+    }
+
+    aes_ni_key_t ni_key;
+    TESTASSERT(aes_ni_setkey_enc(&ni_key, key, impl) == 0);
+    aes_ni_cbc_mac(&ni_key, state, in.data(), nof_blocks);
+    TESTASSERT(memcmp(state, state_ref, sizeof(state)) == 0);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int test_encrypt_blocks_multikey(aes_ni_impl_t impl)
+{
+  // A few keys shared by several blocks, in an order that crosses the lanes of the pipeline
+  const uint32_t            nof_keys = 5;
+  std::vector<aes_ni_key_t> ni_keys(nof_keys);
+  for (aes_ni_key_t& ni_key : ni_keys) {
+    uint8_t key[16];
+    fill_random(key, sizeof(key));
+    TESTASSERT(aes_ni_setkey_enc(&ni_key, key, impl) == 0);
+  }
+
+  for (uint32_t nof_blocks = 0; nof_blocks <= 40; nof_blocks++) {
+    std::vector<const aes_ni_key_t*> keys(nof_blocks);
+    std::vector<uint8_t>             in(nof_blocks * 16), out_ref(nof_blocks * 16), out(nof_blocks * 16);
+    fill_random(in.data(), in.size());
+    for (uint32_t i = 0; i < nof_blocks; i++) {
+      keys[i] = &ni_keys[(i * 3) % nof_keys];
+      aes_ni_encrypt_block(keys[i], &in[i * 16], &out_ref[i * 16]);
+    }
+    aes_ni_encrypt_blocks_multikey(keys.data(), in.data(), out.data(), nof_blocks);
+    TESTASSERT(out == out_ref);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int test_unsupported()
+{
+  uint8_t      key[16] = {};
+  aes_ni_key_t ni_key;
+  TESTASSERT(aes_ni_setkey_enc(&ni_key, key, AES_NI_IMPL_NONE) != 0);
+  TESTASSERT(ni_key.impl == AES_NI_IMPL_NONE);
+  if (aes_ni_get_impl() != AES_NI_IMPL_VAES) {
+    TESTASSERT(aes_ni_setkey_enc(&ni_key, key, AES_NI_IMPL_VAES) != 0);
+    TESTASSERT(ni_key.impl == AES_NI_IMPL_NONE);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int main()
+{
+  srsran::test_init(0, nullptr);
+
+  printf("Best AES implementation: %s\n", aes_ni_impl_to_string(aes_ni_get_impl()));
+
+  TESTASSERT(test_unsupported() == SRSRAN_SUCCESS);
+  for (aes_ni_impl_t impl : {AES_NI_IMPL_AESNI, AES_NI_IMPL_VAES}) {
+    if (not aes_ni_is_supported(impl)) {
+      printf("Skipping %s, not supported by this CPU\n", aes_ni_impl_to_string(impl));
+      continue;
+    }
+    TESTASSERT(test_encrypt_block(impl) == SRSRAN_SUCCESS);
+    TESTASSERT(test_crypt_ctr(impl) == SRSRAN_SUCCESS);
+    TESTASSERT(test_crypt_ctr_batch(impl) == SRSRAN_SUCCESS);
+    TESTASSERT(test_cbc_mac(impl) == SRSRAN_SUCCESS);
+    TESTASSERT(test_encrypt_blocks_multikey(impl) == SRSRAN_SUCCESS);
+    printf("%s: OK\n", aes_ni_impl_to_string(impl));
+  }
+
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
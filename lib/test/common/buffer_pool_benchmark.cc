@@ -0,0 +1,231 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Multi-producer/multi-consumer benchmark of srsran::buffer_pool. Each thread allocates buffers and passes them to
+ * the next thread, which deallocates them, so that every buffer is freed by a different thread than the one that
+ * allocated it. The results are compared against the previous mutex-based pool.
+ */
+
+#include "srsran/common/buffer_pool.h"
+#include "srsran/common/test_common.h"
+#include <chrono>
+#include <getopt.h>
+#include <pthread.h>
+#include <thread>
+
+namespace {
+
+struct bench_buffer {
+  uint8_t payload[2048];
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+  char debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN];
+#endif
+};
+
+/// Previous buffer_pool implementation: mutex-protected free list and linear ownership check on deallocation.
+template <class buffer_t>
+class mutex_buffer_pool
+{
+public:
+  explicit mutex_buffer_pool(uint32_t nof_buffers)
+  {
+    pthread_mutex_init(&mutex, nullptr);
+    for (uint32_t i = 0; i < nof_buffers; i++) {
+      buffer_t* b = new buffer_t;
+      pool.push_back(b);
+      free_list.push_back(b);
+    }
+  }
+  ~mutex_buffer_pool()
+  {
+    for (auto* p : pool) {
+      delete p;
+    }
+    pthread_mutex_destroy(&mutex);
+  }
+
+  buffer_t* allocate()
+  {
+    pthread_mutex_lock(&mutex);
+    buffer_t* b = nullptr;
+    if (!free_list.empty()) {
+      b = free_list.back();
+      free_list.pop_back();
+    }
+    pthread_mutex_unlock(&mutex);
+    return b;
+  }
+
+  bool deallocate(buffer_t* b)
+  {
+    bool ret = false;
+    pthread_mutex_lock(&mutex);
+    if (std::find(pool.cbegin(), pool.cend(), b) != pool.cend()) {
+      free_list.push_back(b);
+      ret = true;
+    }
+    pthread_mutex_unlock(&mutex);
+    return ret;
+  }
+
+private:
+  std::vector<buffer_t*> pool;
+  std::vector<buffer_t*> free_list;
+  pthread_mutex_t        mutex;
+};
+
+/// Single-producer/single-consumer ring used to pass buffers between two threads.
+class spsc_ring
+{
+public:
+  explicit spsc_ring(uint32_t sz) : slots(sz) {}
+
+  bool try_push(bench_buffer* b)
+  {
+    uint32_t w = wpos.load(std::memory_order_relaxed);
+    if (w - rpos.load(std::memory_order_acquire) == slots.size()) {
+      return false;
+    }
+    slots[w % slots.size()] = b;
+    wpos.store(w + 1, std::memory_order_release);
+    return true;
+  }
+
+  bench_buffer* try_pop()
+  {
+    uint32_t r = rpos.load(std::memory_order_relaxed);
+    if (r == wpos.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    bench_buffer* b = slots[r % slots.size()];
+    rpos.store(r + 1, std::memory_order_release);
+    return b;
+  }
+
+private:
+  std::vector<bench_buffer*> slots;
+  std::atomic<uint32_t>      wpos{0};
+  uint8_t                    padding[64];
+  std::atomic<uint32_t>      rpos{0};
+};
+
+struct bench_result {
+  double   mops;
+  uint64_t nof_failed_allocs;
+};
+
+template <typename Pool>
+bench_result run_bench(Pool& pool, uint32_t nof_threads, uint32_t nof_iters, uint32_t burst_size)
+{
+  std::vector<std::unique_ptr<spsc_ring> > rings;
+  for (uint32_t i = 0; i < nof_threads; ++i) {
+    rings.emplace_back(new spsc_ring(2 * burst_size));
+  }
+  std::atomic<uint64_t>    nof_failed{0};
+  std::atomic<uint32_t>    nof_ready{0};
+  std::vector<std::thread> threads;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      spsc_ring& tx = *rings[t];
+      spsc_ring& rx = *rings[(t + nof_threads - 1) % nof_threads];
+      nof_ready++;
+      while (nof_ready.load() < nof_threads) {
+      }
+      uint64_t failed = 0;
+      for (uint32_t i = 0; i < nof_iters; ++i) {
+        for (uint32_t j = 0; j < burst_size; ++j) {
+          bench_buffer* b = pool.allocate();
+          if (b == nullptr) {
+            failed++;
+          } else if (nof_threads == 1 or not tx.try_push(b)) {
+            pool.deallocate(b);
+          }
+        }
+        for (bench_buffer* b = rx.try_pop(); b != nullptr; b = rx.try_pop()) {
+          pool.deallocate(b);
+        }
+      }
+      nof_failed += failed;
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  double elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+  // return the buffers left in flight
+  for (std::unique_ptr<spsc_ring>& r : rings) {
+    for (bench_buffer* b = r->try_pop(); b != nullptr; b = r->try_pop()) {
+      pool.deallocate(b);
+    }
+  }
+
+  bench_result ret;
+  ret.mops              = (double)nof_threads * nof_iters * burst_size / elapsed_us;
+  ret.nof_failed_allocs = nof_failed;
+  return ret;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t nof_buffers = 4096;
+  uint32_t nof_iters   = 100000;
+  uint32_t burst_size  = 16;
+  int      opt;
+  while ((opt = getopt(argc, argv, "b:n:s:")) != -1) {
+    switch (opt) {
+      case 'b':
+        nof_buffers = strtoul(optarg, nullptr, 10);
+        break;
+      case 'n':
+        nof_iters = strtoul(optarg, nullptr, 10);
+        break;
+      case 's':
+        burst_size = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        fmt::print("Usage: {} [-b nof_buffers] [-n nof_iterations] [-s burst_size]\n", argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+
+  fmt::print("Pool size: {}, iterations: {}, burst: {}\n", nof_buffers, nof_iters, burst_size);
+  fmt::print("{:>8}{:>16}{:>16}{:>16}\n", "threads", "mutex [Mops/s]", "lock-free", "high watermark");
+  for (uint32_t nof_threads : {1, 2, 4, 8}) {
+    mutex_buffer_pool<bench_buffer>   old_pool(nof_buffers);
+    srsran::buffer_pool<bench_buffer> new_pool(nof_buffers);
+
+    bench_result old_res = run_bench(old_pool, nof_threads, nof_iters, burst_size);
+    bench_result new_res = run_bench(new_pool, nof_threads, nof_iters, burst_size);
+    TESTASSERT(old_res.nof_failed_allocs == 0 and new_res.nof_failed_allocs == 0);
+    TESTASSERT(new_pool.nof_buffers_in_use() == 0);
+
+    fmt::print("{:>8}{:>16.2f}{:>16.2f}{:>16}\n", nof_threads, old_res.mops, new_res.mops, new_pool.high_watermark());
+  }
+
+  return SRSRAN_SUCCESS;
+}
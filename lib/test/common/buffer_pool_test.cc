@@ -0,0 +1,297 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/buffer_pool.h"
+#include "srsran/common/test_common.h"
+#include <thread>
+
+struct test_buffer {
+  uint32_t value = 0;
+  uint8_t  payload[1000];
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+  char debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN];
+#endif
+};
+
+int test_ownership_and_metrics()
+{
+  const uint32_t                   nof_buffers = 256;
+  srsran::buffer_pool<test_buffer> pool(nof_buffers);
+  srsran::buffer_pool<test_buffer> other_pool(8);
+  std::vector<test_buffer*>        bufs;
+  TESTASSERT(pool.size() == nof_buffers);
+  TESTASSERT(pool.nof_available_pdus() == nof_buffers);
+
+  for (uint32_t i = 0; i < nof_buffers; ++i) {
+    test_buffer* b = pool.allocate("test");
+    TESTASSERT(b != nullptr);
+    TESTASSERT(pool.owns(b) and not other_pool.owns(b));
+    b->value = i;
+    bufs.push_back(b);
+  }
+  // Pool is depleted
+  TESTASSERT(pool.allocate() == nullptr);
+  TESTASSERT(pool.nof_available_pdus() == 0);
+  TESTASSERT(pool.high_watermark() == nof_buffers);
+
+  // Buffers of other pools and addresses inside a buffer are rejected
+  test_buffer* foreign = other_pool.allocate();
+  TESTASSERT(not pool.deallocate(foreign));
+  TESTASSERT(not pool.deallocate(reinterpret_cast<test_buffer*>(&bufs[0]->payload[0])));
+  TESTASSERT(other_pool.deallocate(foreign));
+  TESTASSERT(other_pool.get_metrics().nof_in_use == 0 and other_pool.get_metrics().high_watermark == 1);
+
+  for (uint32_t i = 0; i < nof_buffers / 2; ++i) {
+    TESTASSERT(pool.deallocate(bufs[i]));
+  }
+  srsran::buffer_pool_metrics_t metrics = pool.get_metrics();
+  TESTASSERT(metrics.capacity == nof_buffers);
+  TESTASSERT(metrics.nof_in_use == nof_buffers / 2);
+  TESTASSERT(metrics.high_watermark == nof_buffers);
+
+  // Buffers kept in the thread caches are still available
+  for (uint32_t i = 0; i < nof_buffers / 2; ++i) {
+    bufs[i] = pool.allocate();
+    TESTASSERT(bufs[i] != nullptr);
+  }
+  TESTASSERT(pool.allocate() == nullptr);
+  for (test_buffer* b : bufs) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  TESTASSERT(pool.nof_buffers_in_use() == 0);
+  return SRSRAN_SUCCESS;
+}
+
+int test_multi_thread()
+{
+  const uint32_t                   nof_buffers = 512, nof_threads = 4, nof_iters = 100000;
+  srsran::buffer_pool<test_buffer> pool(nof_buffers);
+  std::vector<std::thread>         threads;
+
+  // Each thread allocates bursts of buffers and frees them, checking that no buffer is handed out twice. Bursts are
+  // small enough so that allocations never fail while other threads hold their caches
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&pool, t]() {
+      std::vector<test_buffer*> bufs;
+      for (uint32_t i = 0; i < nof_iters; ++i) {
+        test_buffer* b = pool.allocate();
+        TESTASSERT(b != nullptr);
+        b->value = t;
+        bufs.push_back(b);
+        if (bufs.size() == nof_buffers / (2 * nof_threads)) {
+          for (test_buffer* b2 : bufs) {
+            TESTASSERT(b2->value == t);
+            TESTASSERT(pool.deallocate(b2));
+          }
+          bufs.clear();
+        }
+      }
+      for (test_buffer* b : bufs) {
+        TESTASSERT(pool.deallocate(b));
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  TESTASSERT(pool.nof_buffers_in_use() == 0);
+  TESTASSERT(pool.high_watermark() <= nof_buffers);
+
+  // All buffers can be allocated from a single thread, wherever they were cached
+  std::vector<test_buffer*> bufs;
+  for (uint32_t i = 0; i < nof_buffers; ++i) {
+    bufs.push_back(pool.allocate());
+    TESTASSERT(bufs.back() != nullptr);
+  }
+  for (test_buffer* b : bufs) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int test_multi_thread_full_capacity()
+{
+  const uint32_t                   nof_buffers = 256, nof_threads = 4, nof_iters = 20000;
+  srsran::buffer_pool<test_buffer> pool(nof_buffers);
+  std::vector<std::thread>         threads;
+
+  // Together, the threads hold the whole pool at times. The buffers they need may sit in the cache of another
+  // thread which is using it, and allocations must still succeed
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&pool, t]() {
+      std::vector<test_buffer*> bufs;
+      for (uint32_t i = 0; i < nof_iters; ++i) {
+        test_buffer* b = pool.allocate();
+        TESTASSERT(b != nullptr);
+        b->value = t;
+        bufs.push_back(b);
+        if (bufs.size() == nof_buffers / nof_threads) {
+          for (test_buffer* b2 : bufs) {
+            TESTASSERT(b2->value == t);
+            TESTASSERT(pool.deallocate(b2));
+          }
+          bufs.clear();
+        }
+      }
+      for (test_buffer* b : bufs) {
+        TESTASSERT(pool.deallocate(b));
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  TESTASSERT(pool.nof_buffers_in_use() == 0);
+  TESTASSERT(pool.high_watermark() <= nof_buffers);
+  return SRSRAN_SUCCESS;
+}
+
+int test_blocking_allocation()
+{
+  srsran::buffer_pool<test_buffer> pool(4);
+  std::vector<test_buffer*>        bufs;
+  for (uint32_t i = 0; i < 4; ++i) {
+    bufs.push_back(pool.allocate());
+  }
+  std::thread t([&pool, &bufs]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.deallocate(bufs[0]);
+  });
+  test_buffer* b = pool.allocate(nullptr, true);
+  TESTASSERT(b == bufs[0]);
+  t.join();
+  return SRSRAN_SUCCESS;
+}
+
+int test_byte_buffer_size_classes()
+{
+  using srsran::byte_buffer_class_t;
+  srsran::byte_buffer_pool* pool = srsran::byte_buffer_pool::get_instance();
+  auto in_use = [pool](byte_buffer_class_t c) { return pool->get_metrics(c).nof_in_use; };
+
+  TESTASSERT(srsran::byte_buffer_class_for(40) == byte_buffer_class_t::small);
+  TESTASSERT(srsran::byte_buffer_class_for(1500) == byte_buffer_class_t::medium);
+  TESTASSERT(srsran::byte_buffer_class_for(9000) == byte_buffer_class_t::large);
+  TESTASSERT(srsran::byte_buffer_class_for(100000) == byte_buffer_class_t::large);
+
+  uint32_t nof_small = in_use(byte_buffer_class_t::small), nof_medium = in_use(byte_buffer_class_t::medium),
+           nof_large = in_use(byte_buffer_class_t::large);
+
+  // A TCP ACK sized buffer takes a small block, with headroom for the headers of all layers
+  srsran::unique_byte_buffer_t ack = srsran::make_sized_byte_buffer(40);
+  TESTASSERT(ack != nullptr);
+  TESTASSERT(ack->get_storage_size() == 256 and ack->get_headroom() == 64 and ack->get_tailroom() == 192);
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small + 1);
+  std::vector<uint8_t> payload(4000);
+  for (uint32_t i = 0; i < payload.size(); ++i) {
+    payload[i] = i;
+  }
+  ack->append_bytes(payload.data(), 40);
+
+  // Appending past the storage moves the payload to a larger class
+  ack->append_bytes(payload.data() + 40, 1000);
+  TESTASSERT(ack->N_bytes == 1040 and ack->get_storage_size() == 2048 and ack->get_headroom() == 512);
+  TESTASSERT(std::equal(ack->begin(), ack->end(), payload.begin()));
+  TESTASSERT(in_use(byte_buffer_class_t::medium) == nof_medium + 1);
+  ack->resize(4000);
+  TESTASSERT(ack->get_storage_size() == SRSRAN_MAX_BUFFER_SIZE_BYTES and
+             std::equal(ack->begin(), ack->begin() + 1040, payload.begin()));
+  TESTASSERT(in_use(byte_buffer_class_t::medium) == nof_medium);
+  TESTASSERT(in_use(byte_buffer_class_t::large) == nof_large + 1);
+
+  // Copies fit the payload
+  srsran::unique_byte_buffer_t small_copy = srsran::make_sized_byte_buffer(40);
+  *small_copy                             = *ack;
+  TESTASSERT(small_copy->N_bytes == 4000 and std::equal(ack->begin(), ack->end(), small_copy->begin()));
+
+  // Buffers beyond the large class are kept in the heap
+  ack->resize(20000);
+  TESTASSERT(ack->get_tailroom() == 0 and ack->get_storage_size() > 20000);
+  ack.reset();
+  small_copy.reset();
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small and in_use(byte_buffer_class_t::large) == nof_large);
+
+  // Unsized buffers keep the full transport block capacity
+  srsran::unique_byte_buffer_t pdu = srsran::make_byte_buffer();
+  TESTASSERT(pdu->get_headroom() == SRSRAN_BUFFER_HEADER_OFFSET);
+  TESTASSERT(pdu->get_tailroom() >= SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET);
+  TESTASSERT(in_use(byte_buffer_class_t::large) == nof_large + 1);
+  pdu.reset();
+
+  // Default constructed buffers outside the pool, even when placed in a raw pool node, take a large class segment
+  {
+    srsran::byte_buffer_t stack_buf;
+    TESTASSERT(stack_buf.get_headroom() == SRSRAN_BUFFER_HEADER_OFFSET);
+    TESTASSERT(stack_buf.get_storage_size() == SRSRAN_MAX_BUFFER_SIZE_BYTES);
+    TESTASSERT(in_use(byte_buffer_class_t::large) == nof_large + 1);
+  }
+  TESTASSERT(in_use(byte_buffer_class_t::large) == nof_large);
+  {
+    // ... unless they are constructed for a given payload
+    srsran::byte_buffer_t sized_buf(100);
+    TESTASSERT(sized_buf.N_bytes == 100 and sized_buf.get_storage_size() == 256);
+    TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small + 1);
+  }
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small);
+
+  // A depleted class hands out blocks of the next larger one
+  std::vector<srsran::unique_byte_buffer_t> small_bufs;
+  while (in_use(byte_buffer_class_t::small) < pool->get_metrics(byte_buffer_class_t::small).capacity) {
+    small_bufs.push_back(srsran::make_sized_byte_buffer(40));
+    TESTASSERT(small_bufs.back() != nullptr);
+  }
+  srsran::unique_byte_buffer_t borrowed = srsran::make_sized_byte_buffer(40);
+  TESTASSERT(borrowed != nullptr and borrowed->get_storage_size() == 2048);
+  TESTASSERT(in_use(byte_buffer_class_t::medium) == nof_medium + 1);
+  borrowed.reset();
+  small_bufs.clear();
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small and in_use(byte_buffer_class_t::medium) == nof_medium);
+
+  struct node_t {
+    srsran::byte_buffer_t buf;
+    uint8_t               other[1000];
+  };
+  srsran::byte_buffer_pool_ptr<node_t> node = srsran::byte_buffer_pool_ptr<node_t>::make();
+  if (not node.has_value()) {
+    return SRSRAN_ERROR;
+  }
+  memset(node->other, 0xff, sizeof(node->other));
+  node->buf.append_bytes(payload.data(), 2000);
+  TESTASSERT(node->other[0] == 0xff and node->buf.get_headroom() == SRSRAN_BUFFER_HEADER_OFFSET);
+  TESTASSERT(in_use(byte_buffer_class_t::large) == nof_large + 2);
+  node.reset();
+  TESTASSERT(in_use(byte_buffer_class_t::large) == nof_large);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srsran::test_init(argc, argv);
+
+  TESTASSERT(test_ownership_and_metrics() == SRSRAN_SUCCESS);
+  TESTASSERT(test_multi_thread() == SRSRAN_SUCCESS);
+  TESTASSERT(test_multi_thread_full_capacity() == SRSRAN_SUCCESS);
+  TESTASSERT(test_blocking_allocation() == SRSRAN_SUCCESS);
+  TESTASSERT(test_byte_buffer_size_classes() == SRSRAN_SUCCESS);
+
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/buffer_pool.h"
+#include "srsran/common/byte_buffer_chain.h"
+#include "srsran/common/test_common.h"
+#include <numeric>
+#include <thread>
+
+using srsran::byte_buffer_chain;
+using srsran::byte_buffer_class_t;
+using srsran::shared_byte_buffer_t;
+
+static uint32_t in_use(byte_buffer_class_t c)
+{
+  return srsran::byte_buffer_pool::get_instance()->get_metrics(c).nof_in_use;
+}
+
+int test_shared_byte_buffer()
+{
+  uint32_t nof_small = in_use(byte_buffer_class_t::small);
+
+  shared_byte_buffer_t empty;
+  TESTASSERT(empty == nullptr and not empty and empty.use_count() == 0);
+
+  shared_byte_buffer_t b1(srsran::make_sized_byte_buffer(100));
+  TESTASSERT(b1 != nullptr and b1.use_count() == 1);
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small + 1);
+  b1->append_bytes(std::vector<uint8_t>(100, 0xaa).data(), 100);
+
+  {
+    shared_byte_buffer_t b2 = b1;
+    TESTASSERT(b1.use_count() == 2 and b2.get() == b1.get());
+    shared_byte_buffer_t b3 = std::move(b2);
+    TESTASSERT(b2 == nullptr and b3.use_count() == 2);
+    b3 = nullptr;
+    TESTASSERT(b1.use_count() == 1);
+  }
+  TESTASSERT(b1->N_bytes == 100);
+
+  // Handles released concurrently
+  std::vector<shared_byte_buffer_t> copies(1000, b1);
+  TESTASSERT(b1.use_count() == 1001);
+  std::thread t([&copies]() {
+    for (uint32_t i = 0; i < copies.size() / 2; ++i) {
+      copies[i].reset();
+    }
+  });
+  for (uint32_t i = copies.size() / 2; i < copies.size(); ++i) {
+    copies[i].reset();
+  }
+  t.join();
+  TESTASSERT(b1.use_count() == 1);
+
+  b1.reset();
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small);
+  return SRSRAN_SUCCESS;
+}
+
+int test_byte_buffer_chain()
+{
+  uint32_t nof_medium = in_use(byte_buffer_class_t::medium);
+
+  std::vector<uint8_t> payload(3000);
+  std::iota(payload.begin(), payload.end(), 0);
+
+  byte_buffer_chain chain;
+  TESTASSERT(chain.empty() and chain.length() == 0);
+  {
+    shared_byte_buffer_t sdu1(srsran::make_sized_byte_buffer(1500));
+    shared_byte_buffer_t sdu2(srsran::make_sized_byte_buffer(1500));
+    sdu1->append_bytes(&payload[0], 1500);
+    sdu2->append_bytes(&payload[1500], 1500);
+    TESTASSERT(in_use(byte_buffer_class_t::medium) == nof_medium + 2);
+
+    // Tail of the first buffer, empty slice and head of the second buffer
+    chain.append(sdu1, sdu1->msg + 1000, 500);
+    chain.append(sdu2, sdu2->msg, 0);
+    chain.append(sdu2, sdu2->msg, 700);
+    TESTASSERT(chain.nof_slices() == 2 and chain.length() == 1200);
+    TESTASSERT(sdu1.use_count() == 2 and sdu2.use_count() == 2);
+
+    // Writing to the SDU after slicing it does not change the chain length
+    sdu1->msg += 1000;
+    sdu1->N_bytes -= 1000;
+  }
+  // The slices keep the SDUs alive
+  TESTASSERT(in_use(byte_buffer_class_t::medium) == nof_medium + 2);
+
+  std::vector<uint8_t> out(chain.length());
+  TESTASSERT(chain.copy_to(out.data()) == 1200);
+  TESTASSERT(std::equal(out.begin(), out.end(), payload.begin() + 1000));
+
+  // Ranges inside and across slices
+  std::fill(out.begin(), out.end(), 0);
+  TESTASSERT(chain.copy_to(out.data(), 10, 20) == 20);
+  TESTASSERT(std::equal(out.begin(), out.begin() + 20, payload.begin() + 1010));
+  TESTASSERT(chain.copy_to(out.data(), 450, 100) == 100);
+  TESTASSERT(std::equal(out.begin(), out.begin() + 100, payload.begin() + 1450));
+  TESTASSERT(chain.copy_to(out.data(), 1199, 1) == 1 and out[0] == payload[2199]);
+  TESTASSERT(chain.copy_to(out.data(), 1200, 0) == 0);
+
+  byte_buffer_chain copy = chain;
+  chain.clear();
+  TESTASSERT(chain.empty() and chain.nof_slices() == 0);
+  TESTASSERT(in_use(byte_buffer_class_t::medium) == nof_medium + 2);
+  copy.clear();
+  TESTASSERT(in_use(byte_buffer_class_t::medium) == nof_medium);
+  return SRSRAN_SUCCESS;
+}
+
+int test_byte_buffer_chain_many_slices()
+{
+  uint32_t nof_small = in_use(byte_buffer_class_t::small);
+
+  // One byte slices of a single SDU, past the inline slices and across several pool chunks
+  const uint32_t       nof_slices = 40;
+  std::vector<uint8_t> payload(nof_slices);
+  std::iota(payload.begin(), payload.end(), 0);
+  shared_byte_buffer_t sdu(srsran::make_sized_byte_buffer(nof_slices));
+  sdu->append_bytes(payload.data(), nof_slices);
+
+  byte_buffer_chain chain;
+  for (uint32_t i = 0; i < byte_buffer_chain::nof_inline_slices; ++i) {
+    chain.append(sdu, sdu->msg + i, 1);
+  }
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small + 1);
+  for (uint32_t i = byte_buffer_chain::nof_inline_slices; i < nof_slices; ++i) {
+    chain.append(sdu, sdu->msg + i, 1);
+  }
+  TESTASSERT(chain.nof_slices() == nof_slices and chain.length() == nof_slices);
+  TESTASSERT(sdu.use_count() == nof_slices + 1);
+  uint32_t nof_chunks = in_use(byte_buffer_class_t::small) - nof_small - 1;
+  TESTASSERT(nof_chunks > 1);
+
+  std::vector<uint8_t> out(nof_slices);
+  TESTASSERT(chain.copy_to(out.data()) == nof_slices and out == payload);
+  TESTASSERT(chain.copy_to(out.data(), 3, 10) == 10 and std::equal(out.begin(), out.begin() + 10, &payload[3]));
+
+  // Copies take their own chunks, moves take over the chunks of the source
+  byte_buffer_chain copy = chain;
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small + 1 + 2 * nof_chunks);
+  TESTASSERT(sdu.use_count() == 2 * nof_slices + 1);
+  byte_buffer_chain moved = std::move(chain);
+  TESTASSERT(chain.empty() and chain.nof_slices() == 0 and moved.nof_slices() == nof_slices);
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small + 1 + 2 * nof_chunks);
+  std::fill(out.begin(), out.end(), 0);
+  TESTASSERT(copy.copy_to(out.data()) == nof_slices and out == payload);
+
+  copy.clear();
+  moved.clear();
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small + 1 and sdu.use_count() == 1);
+  sdu.reset();
+  TESTASSERT(in_use(byte_buffer_class_t::small) == nof_small);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srsran::test_init(argc, argv);
+
+  TESTASSERT(test_shared_byte_buffer() == SRSRAN_SUCCESS);
+  TESTASSERT(test_byte_buffer_chain() == SRSRAN_SUCCESS);
+  TESTASSERT(test_byte_buffer_chain_many_slices() == SRSRAN_SUCCESS);
+
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
@@ -410,6 +410,56 @@ int test_task_thread_pool3()
   return 0;
 }
 
+int test_task_thread_pool_parallel_for()
+{
+  std::cout << "\n====== TEST task thread pool parallel_for: start ======\n";
+  // Description: check that every item is run exactly once before parallel_for returns, including nested calls from
+  //              the pool workers and calls into a pool whose workers are all busy
+
+  uint32_t         nof_workers = 4, nof_items = 1000, nof_inner = 8;
+  task_thread_pool thread_pool(nof_workers);
+
+  std::vector<std::atomic<uint32_t> > count(nof_items);
+  srsran::parallel_for(thread_pool, nof_items, [&count](uint32_t idx) { count[idx]++; });
+  for (uint32_t i = 0; i < nof_items; ++i) {
+    TESTASSERT(count[i] == 1);
+  }
+
+  std::vector<std::atomic<uint32_t> > nested_count(nof_items * nof_inner);
+  srsran::parallel_for(thread_pool, nof_items, [&](uint32_t idx) {
+    srsran::parallel_for(
+        thread_pool, nof_inner, [&nested_count, idx, nof_inner](uint32_t j) { nested_count[idx * nof_inner + j]++; });
+  });
+  for (auto& c : nested_count) {
+    TESTASSERT(c == 1);
+  }
+
+  // Block all the workers, the caller must complete the items by itself
+  std::atomic<bool>     release{false};
+  std::atomic<uint32_t> nof_blocked{0};
+  for (uint32_t i = 0; i < nof_workers; ++i) {
+    thread_pool.push_task([&release, &nof_blocked]() {
+      nof_blocked++;
+      while (not release) {
+        usleep(100);
+      }
+    });
+  }
+  while (nof_blocked != nof_workers) {
+    usleep(10);
+  }
+  std::atomic<uint32_t> sum{0};
+  srsran::parallel_for(thread_pool, nof_items, [&sum](uint32_t idx) { sum += idx; });
+  TESTASSERT(sum == nof_items * (nof_items - 1) / 2);
+  release = true;
+
+  thread_pool.stop();
+
+  std::cout << "outcome: Success\n";
+  std::cout << "===================================================\n";
+  return 0;
+}
+
 struct C {
   std::unique_ptr<int> val{new int{5}};
 };
@@ -503,6 +553,7 @@ int main()
   TESTASSERT(test_task_thread_pool() == 0);
   TESTASSERT(test_task_thread_pool2() == 0);
   TESTASSERT(test_task_thread_pool3() == 0);
+  TESTASSERT(test_task_thread_pool_parallel_for() == 0);
 
   TESTASSERT(test_inplace_task() == 0);
 }
@@ -0,0 +1,391 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Throughput of the PDCP ciphering and integrity algorithms, comparing the key-based functions, which expand the key
+ * for every PDU, with the ones using a precomputed security_key_ctx. Both must produce the same output.
+ * The AES-CTR and CBC-MAC primitives of EEA2/EIA2 are also compared for each AES implementation supported by the CPU,
+ * as well as per-PDU against batched EEA2 ciphering of bursts of PDUs.
+ * Finally, the authentication vectors per second of the HSS are measured for the per-subscriber Milenage functions
+ * and for security_milenage_batch() with per-request and cached key schedules.
+ */
+
+#include "srsran/common/aes_ni.h"
+#include "srsran/common/security.h"
+#include "srsran/common/ssl.h"
+#include "srsran/common/test_common.h"
+#include <algorithm>
+#include <chrono>
+#include <getopt.h>
+#include <random>
+
+using namespace srsran;
+
+namespace {
+
+enum class algo_t { eea1, eea2, eea3, eia1, eia2, eia3 };
+const char* algo_names[] = {"128-EEA1", "128-EEA2", "128-EEA3", "128-EIA1", "128-EIA2", "128-EIA3"};
+
+const uint8_t  bearer    = 3;
+const uint8_t  direction = SECURITY_DIRECTION_DOWNLINK;
+const uint32_t mac_len   = 4;
+
+void run_key(algo_t algo, uint8_t* key, uint32_t count, uint8_t* msg, uint32_t len, uint8_t* out)
+{
+  switch (algo) {
+    case algo_t::eea1:
+      security_128_eea1(key, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eea2:
+      security_128_eea2(key, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eea3:
+      security_128_eea3(key, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eia1:
+      security_128_eia1(key, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eia2:
+      security_128_eia2(key, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eia3:
+      security_128_eia3(key, count, bearer, direction, msg, len, out);
+      break;
+  }
+}
+
+void run_ctx(algo_t algo, const security_key_ctx& ctx, uint32_t count, uint8_t* msg, uint32_t len, uint8_t* out)
+{
+  switch (algo) {
+    case algo_t::eea1:
+      security_128_eea1(ctx, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eea2:
+      security_128_eea2(ctx, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eea3:
+      security_128_eea3(ctx, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eia1:
+      security_128_eia1(ctx, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eia2:
+      security_128_eia2(ctx, count, bearer, direction, msg, len, out);
+      break;
+    case algo_t::eia3:
+      security_128_eia3(ctx, count, bearer, direction, msg, len, out);
+      break;
+  }
+}
+
+double pdus_per_sec(std::chrono::high_resolution_clock::time_point start, uint32_t nof_pdus)
+{
+  auto dur = std::chrono::high_resolution_clock::now() - start;
+  return nof_pdus * 1e6 / std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+}
+
+int run_benchmark(uint32_t nof_pdus)
+{
+  std::mt19937                           rng(1234);
+  std::uniform_int_distribution<uint8_t> dist(0, 255);
+
+  uint8_t key[16];
+  for (uint8_t& k : key) {
+    k = dist(rng);
+  }
+  security_key_ctx ctx;
+  ctx.set_key(key);
+
+  const uint32_t       pdu_sizes[] = {64, 512, 1500};
+  std::vector<uint8_t> msg(1500), out_key(1500), out_ctx(1500);
+  for (uint8_t& b : msg) {
+    b = dist(rng);
+  }
+
+  fmt::print("{:>10}{:>8}{:>16}{:>16}{:>10}\n", "algorithm", "bytes", "key [PDU/s]", "cached [PDU/s]", "gain");
+  for (uint32_t a = 0; a < 6; ++a) {
+    algo_t algo     = static_cast<algo_t>(a);
+    bool   is_integ = algo == algo_t::eia1 or algo == algo_t::eia2 or algo == algo_t::eia3;
+    for (uint32_t len : pdu_sizes) {
+      uint32_t out_len = is_integ ? mac_len : len;
+
+      // Outputs must match for all COUNT values
+      for (uint32_t count = 0; count < 16; ++count) {
+        run_key(algo, key, count, msg.data(), len, out_key.data());
+        run_ctx(algo, ctx, count, msg.data(), len, out_ctx.data());
+        TESTASSERT(memcmp(out_key.data(), out_ctx.data(), out_len) == 0);
+      }
+
+      auto tp = std::chrono::high_resolution_clock::now();
+      for (uint32_t count = 0; count < nof_pdus; ++count) {
+        run_key(algo, key, count, msg.data(), len, out_key.data());
+      }
+      double key_rate = pdus_per_sec(tp, nof_pdus);
+
+      tp = std::chrono::high_resolution_clock::now();
+      for (uint32_t count = 0; count < nof_pdus; ++count) {
+        run_ctx(algo, ctx, count, msg.data(), len, out_ctx.data());
+      }
+      double ctx_rate = pdus_per_sec(tp, nof_pdus);
+
+      fmt::print("{:>10}{:>8}{:>16.0f}{:>16.0f}{:>9.2f}x\n", algo_names[a], len, key_rate, ctx_rate, ctx_rate / key_rate);
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int run_aes_benchmark(uint32_t nof_pdus)
+{
+  uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+  const uint32_t       pdu_sizes[] = {64, 512, 1500};
+  std::vector<uint8_t> msg(1500, 0x5a), out(1500);
+
+  aes_context ctx;
+  TESTASSERT(aes_setkey_enc(&ctx, key, 128) == 0);
+
+  fmt::print("\n{:>10}{:>8}{:>8}{:>16}{:>16}\n", "AES", "mode", "bytes", "[PDU/s]", "[Mbit/s]");
+  for (aes_ni_impl_t impl : {AES_NI_IMPL_NONE, AES_NI_IMPL_AESNI, AES_NI_IMPL_VAES}) {
+    aes_ni_key_t ni_key;
+    if (impl != AES_NI_IMPL_NONE and aes_ni_setkey_enc(&ni_key, key, impl) != 0) {
+      continue;
+    }
+    const char* impl_name = impl == AES_NI_IMPL_NONE ? "portable" : aes_ni_impl_to_string(impl);
+    for (uint32_t len : pdu_sizes) {
+      auto tp = std::chrono::high_resolution_clock::now();
+      for (uint32_t count = 0; count < nof_pdus; ++count) {
+        uint8_t nonce[16] = {(uint8_t)(count >> 24), (uint8_t)(count >> 16), (uint8_t)(count >> 8), (uint8_t)count};
+        if (impl == AES_NI_IMPL_NONE) {
+          uint8_t stream_blk[16];
+          size_t  nc_off = 0;
+          aes_crypt_ctr(&ctx, len, &nc_off, nonce, stream_blk, msg.data(), out.data());
+        } else {
+          aes_ni_crypt_ctr(&ni_key, nonce, msg.data(), out.data(), len);
+        }
+      }
+      double rate = pdus_per_sec(tp, nof_pdus);
+      fmt::print("{:>10}{:>8}{:>8}{:>16.0f}{:>16.1f}\n", impl_name, "CTR", len, rate, rate * len * 8 / 1e6);
+
+      tp = std::chrono::high_resolution_clock::now();
+      for (uint32_t count = 0; count < nof_pdus; ++count) {
+        uint8_t state[16] = {};
+        if (impl == AES_NI_IMPL_NONE) {
+          uint8_t tmp[16];
+          for (uint32_t i = 0; i < len / 16; ++i) {
+            for (uint32_t j = 0; j < 16; ++j) {
+              tmp[j] = state[j] ^ msg[i * 16 + j];
+            }
+            aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, state);
+          }
+        } else {
+          aes_ni_cbc_mac(&ni_key, state, msg.data(), len / 16);
+        }
+        out[count % out.size()] = state[0];
+      }
+      rate = pdus_per_sec(tp, nof_pdus);
+      fmt::print("{:>10}{:>8}{:>8}{:>16.0f}{:>16.1f}\n", impl_name, "CBC-MAC", len, rate, rate * len * 8 / 1e6);
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int run_batch_benchmark(uint32_t nof_pdus)
+{
+  uint8_t key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+  security_key_ctx ctx;
+  ctx.set_key(key);
+
+  const uint32_t pdu_sizes[]   = {40, 64, 128, 512, 1500};
+  const uint32_t burst_sizes[] = {8, 32};
+  const uint32_t max_burst     = 32;
+
+  std::vector<std::vector<uint8_t> > msgs(max_burst, std::vector<uint8_t>(1500, 0x5a));
+  std::vector<std::vector<uint8_t> > out_ref(max_burst, std::vector<uint8_t>(1500));
+  std::vector<std::vector<uint8_t> > out(max_burst, std::vector<uint8_t>(1500));
+  std::vector<security_cipher_msg_t> batch(max_burst);
+
+  fmt::print("\n{:>10}{:>8}{:>8}{:>16}{:>16}{:>10}\n", "EEA2", "burst", "bytes", "PDU [PDU/s]", "batch [PDU/s]", "gain");
+  for (uint32_t burst : burst_sizes) {
+    uint32_t nof_bursts = std::max(nof_pdus / burst, 1U);
+    for (uint32_t len : pdu_sizes) {
+      for (uint32_t i = 0; i < burst; ++i) {
+        batch[i] = {i, msgs[i].data(), len, out[i].data()};
+      }
+
+      // Outputs must match the per-PDU ciphering
+      security_128_eea2_batch(ctx, bearer, direction, batch.data(), burst);
+      for (uint32_t i = 0; i < burst; ++i) {
+        security_128_eea2(ctx, i, bearer, direction, msgs[i].data(), len, out_ref[i].data());
+        TESTASSERT(memcmp(out_ref[i].data(), out[i].data(), len) == 0);
+      }
+
+      auto tp = std::chrono::high_resolution_clock::now();
+      for (uint32_t n = 0; n < nof_bursts; ++n) {
+        for (uint32_t i = 0; i < burst; ++i) {
+          security_128_eea2(ctx, n * burst + i, bearer, direction, msgs[i].data(), len, out_ref[i].data());
+        }
+      }
+      double pdu_rate = pdus_per_sec(tp, nof_bursts * burst);
+
+      tp = std::chrono::high_resolution_clock::now();
+      for (uint32_t n = 0; n < nof_bursts; ++n) {
+        for (uint32_t i = 0; i < burst; ++i) {
+          batch[i].count = n * burst + i;
+        }
+        security_128_eea2_batch(ctx, bearer, direction, batch.data(), burst);
+      }
+      double batch_rate = pdus_per_sec(tp, nof_bursts * burst);
+
+      fmt::print(
+          "{:>10}{:>8}{:>8}{:>16.0f}{:>16.0f}{:>9.2f}x\n", "", burst, len, pdu_rate, batch_rate, batch_rate / pdu_rate);
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/// Milenage inputs and outputs of one subscriber, for the f1 and f2345 functions of an authentication info answer
+struct milenage_sub_t {
+  uint8_t               k[16];
+  uint8_t               opc[16];
+  uint8_t               rand[16];
+  uint8_t               sqn[6];
+  uint8_t               amf[2];
+  uint8_t               mac_a[8];
+  uint8_t               res[8];
+  uint8_t               ck[16];
+  uint8_t               ik[16];
+  uint8_t               ak[6];
+  security_milenage_key key;
+};
+
+void set_milenage_vec(security_milenage_vec_t& vec, milenage_sub_t& sub)
+{
+  vec       = {};
+  vec.k     = &sub.key;
+  vec.opc   = sub.opc;
+  vec.rand  = sub.rand;
+  vec.sqn   = sub.sqn;
+  vec.amf   = sub.amf;
+  vec.mac_a = sub.mac_a;
+  vec.res   = sub.res;
+  vec.ck    = sub.ck;
+  vec.ik    = sub.ik;
+  vec.ak    = sub.ak;
+}
+
+int run_milenage_benchmark(uint32_t nof_vecs)
+{
+  std::mt19937                           rng(4321);
+  std::uniform_int_distribution<uint8_t> dist(0, 255);
+
+  const uint32_t              nof_subs      = 1024;
+  const uint32_t              burst_sizes[] = {1, 8, 32};
+  std::vector<milenage_sub_t> subs(nof_subs);
+  for (milenage_sub_t& sub : subs) {
+    for (uint8_t* field : {sub.k, sub.opc, sub.rand}) {
+      std::generate(field, field + 16, [&]() { return dist(rng); });
+    }
+    std::generate(sub.sqn, sub.sqn + 6, [&]() { return dist(rng); });
+    sub.amf[0] = 0x80;
+    sub.amf[1] = 0x00;
+    sub.key.set_key(sub.k);
+  }
+
+  // The batch must give the same vectors as the per-subscriber functions
+  std::vector<security_milenage_vec_t> vecs(nof_subs);
+  for (uint32_t i = 0; i < nof_subs; ++i) {
+    set_milenage_vec(vecs[i], subs[i]);
+  }
+  TESTASSERT(security_milenage_batch(vecs.data(), nof_subs) == SRSRAN_SUCCESS);
+  for (milenage_sub_t& sub : subs) {
+    uint8_t mac_a[8], res[8], ck[16], ik[16], ak[6];
+    security_milenage_f1(sub.k, sub.opc, sub.rand, sub.sqn, sub.amf, mac_a);
+    security_milenage_f2345(sub.k, sub.opc, sub.rand, res, ck, ik, ak);
+    TESTASSERT(memcmp(mac_a, sub.mac_a, sizeof(mac_a)) == 0);
+    TESTASSERT(memcmp(res, sub.res, sizeof(res)) == 0);
+    TESTASSERT(memcmp(ck, sub.ck, sizeof(ck)) == 0);
+    TESTASSERT(memcmp(ik, sub.ik, sizeof(ik)) == 0);
+    TESTASSERT(memcmp(ak, sub.ak, sizeof(ak)) == 0);
+  }
+
+  fmt::print("\n{:>10}{:>8}{:>16}{:>10}\n", "Milenage", "burst", "[vectors/s]", "gain");
+
+  // f1 and f2345 of each subscriber, each expanding the key and computing TEMP
+  auto tp = std::chrono::high_resolution_clock::now();
+  for (uint32_t n = 0; n < nof_vecs; ++n) {
+    milenage_sub_t& sub = subs[n % nof_subs];
+    security_milenage_f2345(sub.k, sub.opc, sub.rand, sub.res, sub.ck, sub.ik, sub.ak);
+    security_milenage_f1(sub.k, sub.opc, sub.rand, sub.sqn, sub.amf, sub.mac_a);
+  }
+  double legacy_rate = pdus_per_sec(tp, nof_vecs);
+  fmt::print("{:>10}{:>8}{:>16.0f}{:>9.2f}x\n", "f1+f2345", 1, legacy_rate, 1.0);
+
+  // One vector per call with the key expanded for every request, as done for subscribers of the binary database
+  tp = std::chrono::high_resolution_clock::now();
+  for (uint32_t n = 0; n < nof_vecs; ++n) {
+    milenage_sub_t&       sub = subs[n % nof_subs];
+    security_milenage_key key;
+    key.set_key(sub.k);
+    set_milenage_vec(vecs[0], sub);
+    vecs[0].k = &key;
+    security_milenage_batch(vecs.data(), 1);
+  }
+  double rate = pdus_per_sec(tp, nof_vecs);
+  fmt::print("{:>10}{:>8}{:>16.0f}{:>9.2f}x\n", "key", 1, rate, rate / legacy_rate);
+
+  // Cached key schedules, with bursts of vectors of different subscribers
+  for (uint32_t burst : burst_sizes) {
+    uint32_t nof_bursts = std::max(nof_vecs / burst, 1U);
+    tp                  = std::chrono::high_resolution_clock::now();
+    for (uint32_t n = 0; n < nof_bursts; ++n) {
+      for (uint32_t i = 0; i < burst; ++i) {
+        set_milenage_vec(vecs[i], subs[(n * burst + i) % nof_subs]);
+      }
+      security_milenage_batch(vecs.data(), burst);
+    }
+    rate = pdus_per_sec(tp, nof_bursts * burst);
+    fmt::print("{:>10}{:>8}{:>16.0f}{:>9.2f}x\n", "cached", burst, rate, rate / legacy_rate);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t nof_pdus = 20000;
+  int      opt;
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_pdus = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        fmt::print("Usage: {} [-n nof_pdus]\n", argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+
+  TESTASSERT(run_benchmark(nof_pdus) == SRSRAN_SUCCESS);
+  TESTASSERT(run_aes_benchmark(nof_pdus) == SRSRAN_SUCCESS);
+  TESTASSERT(run_batch_benchmark(nof_pdus) == SRSRAN_SUCCESS);
+  TESTASSERT(run_milenage_benchmark(nof_pdus) == SRSRAN_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
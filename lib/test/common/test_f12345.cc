@@ -162,6 +162,148 @@ int test_set_2()
   return SRSRAN_SUCCESS;
 }
 
+/*
+ * Batched Milenage with the test sets 1 to 3 of 35.208, mixed so that every chunk of the batch holds vectors of
+ * different subscribers, and with some outputs not requested
+ */
+
+struct milenage_test_set_t {
+  uint8_t k[16];
+  uint8_t rand[16];
+  uint8_t sqn[6];
+  uint8_t amf[2];
+  uint8_t opc[16];
+  uint8_t mac_a[8];
+  uint8_t mac_s[8];
+  uint8_t res[8];
+  uint8_t ck[16];
+  uint8_t ik[16];
+  uint8_t ak[6];
+  uint8_t ak_star[6];
+};
+
+static const milenage_test_set_t milenage_test_sets[] = {
+    {{0x46, 0x5b, 0x5c, 0xe8, 0xb1, 0x99, 0xb4, 0x9f, 0xaa, 0x5f, 0x0a, 0x2e, 0xe2, 0x38, 0xa6, 0xbc},
+     {0x23, 0x55, 0x3c, 0xbe, 0x96, 0x37, 0xa8, 0x9d, 0x21, 0x8a, 0xe6, 0x4d, 0xae, 0x47, 0xbf, 0x35},
+     {0xff, 0x9b, 0xb4, 0xd0, 0xb6, 0x07},
+     {0xb9, 0xb9},
+     {0xcd, 0x63, 0xcb, 0x71, 0x95, 0x4a, 0x9f, 0x4e, 0x48, 0xa5, 0x99, 0x4e, 0x37, 0xa0, 0x2b, 0xaf},
+     {0x4a, 0x9f, 0xfa, 0xc3, 0x54, 0xdf, 0xaf, 0xb3},
+     {0x01, 0xcf, 0xaf, 0x9e, 0xc4, 0xe8, 0x71, 0xe9},
+     {0xa5, 0x42, 0x11, 0xd5, 0xe3, 0xba, 0x50, 0xbf},
+     {0xb4, 0x0b, 0xa9, 0xa3, 0xc5, 0x8b, 0x2a, 0x05, 0xbb, 0xf0, 0xd9, 0x87, 0xb2, 0x1b, 0xf8, 0xcb},
+     {0xf7, 0x69, 0xbc, 0xd7, 0x51, 0x04, 0x46, 0x04, 0x12, 0x76, 0x72, 0x71, 0x1c, 0x6d, 0x34, 0x41},
+     {0xaa, 0x68, 0x9c, 0x64, 0x83, 0x70},
+     {0x45, 0x1e, 0x8b, 0xec, 0xa4, 0x3b}},
+    {{0x03, 0x96, 0xeb, 0x31, 0x7b, 0x6d, 0x1c, 0x36, 0xf1, 0x9c, 0x1c, 0x84, 0xcd, 0x6f, 0xfd, 0x16},
+     {0xc0, 0x0d, 0x60, 0x31, 0x03, 0xdc, 0xee, 0x52, 0xc4, 0x47, 0x81, 0x19, 0x49, 0x42, 0x02, 0xe8},
+     {0xfd, 0x8e, 0xef, 0x40, 0xdf, 0x7d},
+     {0xaf, 0x17},
+     {0x53, 0xc1, 0x56, 0x71, 0xc6, 0x0a, 0x4b, 0x73, 0x1c, 0x55, 0xb4, 0xa4, 0x41, 0xc0, 0xbd, 0xe2},
+     {0x5d, 0xf5, 0xb3, 0x18, 0x07, 0xe2, 0x58, 0xb0},
+     {0xa8, 0xc0, 0x16, 0xe5, 0x1e, 0xf4, 0xa3, 0x43},
+     {0xd3, 0xa6, 0x28, 0xed, 0x98, 0x86, 0x20, 0xf0},
+     {0x58, 0xc4, 0x33, 0xff, 0x7a, 0x70, 0x82, 0xac, 0xd4, 0x24, 0x22, 0x0f, 0x2b, 0x67, 0xc5, 0x56},
+     {0x21, 0xa8, 0xc1, 0xf9, 0x29, 0x70, 0x2a, 0xdb, 0x3e, 0x73, 0x84, 0x88, 0xb9, 0xf5, 0xc5, 0xda},
+     {0xc4, 0x77, 0x83, 0x99, 0x5f, 0x72},
+     {0x30, 0xf1, 0x19, 0x70, 0x61, 0xc1}},
+    {{0xfe, 0xc8, 0x6b, 0xa6, 0xeb, 0x70, 0x7e, 0xd0, 0x89, 0x05, 0x75, 0x7b, 0x1b, 0xb4, 0x4b, 0x8f},
+     {0x9f, 0x7c, 0x8d, 0x02, 0x1a, 0xcc, 0xf4, 0xdb, 0x21, 0x3c, 0xcf, 0xf0, 0xc7, 0xf7, 0x1a, 0x6a},
+     {0x9d, 0x02, 0x77, 0x59, 0x5f, 0xfc},
+     {0x72, 0x5c},
+     {0x10, 0x06, 0x02, 0x0f, 0x0a, 0x47, 0x8b, 0xf6, 0xb6, 0x99, 0xf1, 0x5c, 0x06, 0x2e, 0x42, 0xb3},
+     {0x9c, 0xab, 0xc3, 0xe9, 0x9b, 0xaf, 0x72, 0x81},
+     {0x95, 0x81, 0x4b, 0xa2, 0xb3, 0x04, 0x43, 0x24},
+     {0x80, 0x11, 0xc4, 0x8c, 0x0c, 0x21, 0x4e, 0xd2},
+     {0x5d, 0xbd, 0xbb, 0x29, 0x54, 0xe8, 0xf3, 0xcd, 0xe6, 0x65, 0xb0, 0x46, 0x17, 0x9a, 0x50, 0x98},
+     {0x59, 0xa9, 0x2d, 0x3b, 0x47, 0x6a, 0x04, 0x43, 0x48, 0x70, 0x55, 0xcf, 0x88, 0xb2, 0x30, 0x7b},
+     {0x33, 0x48, 0x4d, 0xc2, 0x13, 0x6b},
+     {0xde, 0xac, 0xdd, 0x84, 0x8c, 0xc6}},
+};
+
+int test_milenage_batch()
+{
+  const uint32_t nof_sets = sizeof(milenage_test_sets) / sizeof(milenage_test_sets[0]);
+  const uint32_t nof_vecs = 40;
+
+  srsran::security_milenage_key keys[nof_sets];
+  for (uint32_t s = 0; s < nof_sets; s++) {
+    keys[s].set_key(milenage_test_sets[s].k);
+    TESTASSERT(keys[s].is_set());
+  }
+
+  milenage_test_set_t              in[nof_vecs];
+  milenage_test_set_t              out[nof_vecs];
+  srsran::security_milenage_vec_t vecs[nof_vecs];
+  for (uint32_t i = 0; i < nof_vecs; i++) {
+    uint32_t s = (i * 7) % nof_sets;
+    in[i]      = milenage_test_sets[s];
+    memset(&out[i], 0, sizeof(out[i]));
+    vecs[i]      = {};
+    vecs[i].k    = &keys[s];
+    vecs[i].opc  = in[i].opc;
+    vecs[i].rand = in[i].rand;
+    vecs[i].sqn  = in[i].sqn;
+    vecs[i].amf  = in[i].amf;
+    // Authentication info (f1 and f2345), resynchronisation (f1* and f5*) or all the functions
+    if (i % 3 != 1) {
+      vecs[i].mac_a = out[i].mac_a;
+      vecs[i].res   = out[i].res;
+      vecs[i].ck    = out[i].ck;
+      vecs[i].ik    = out[i].ik;
+      vecs[i].ak    = out[i].ak;
+    }
+    if (i % 3 != 0) {
+      vecs[i].mac_s   = out[i].mac_s;
+      vecs[i].ak_star = out[i].ak_star;
+    }
+  }
+
+  TESTASSERT(srsran::security_milenage_batch(vecs, nof_vecs) == LIBLTE_SUCCESS);
+
+  uint8_t zero[16] = {};
+  for (uint32_t i = 0; i < nof_vecs; i++) {
+    if (i % 3 != 1) {
+      TESTASSERT(arrcmp(out[i].mac_a, in[i].mac_a, sizeof(in[i].mac_a)) == 0);
+      TESTASSERT(arrcmp(out[i].res, in[i].res, sizeof(in[i].res)) == 0);
+      TESTASSERT(arrcmp(out[i].ck, in[i].ck, sizeof(in[i].ck)) == 0);
+      TESTASSERT(arrcmp(out[i].ik, in[i].ik, sizeof(in[i].ik)) == 0);
+      TESTASSERT(arrcmp(out[i].ak, in[i].ak, sizeof(in[i].ak)) == 0);
+    } else {
+      TESTASSERT(arrcmp(out[i].mac_a, zero, sizeof(out[i].mac_a)) == 0);
+      TESTASSERT(arrcmp(out[i].ck, zero, sizeof(out[i].ck)) == 0);
+    }
+    if (i % 3 != 0) {
+      TESTASSERT(arrcmp(out[i].mac_s, in[i].mac_s, sizeof(in[i].mac_s)) == 0);
+      TESTASSERT(arrcmp(out[i].ak_star, in[i].ak_star, sizeof(in[i].ak_star)) == 0);
+    } else {
+      TESTASSERT(arrcmp(out[i].ak_star, zero, sizeof(out[i].ak_star)) == 0);
+    }
+  }
+
+  // The per-subscriber functions give the same results
+  for (uint32_t s = 0; s < nof_sets; s++) {
+    milenage_test_set_t set = milenage_test_sets[s];
+    uint8_t             mac_a[8], mac_s[8], res[8], ck[16], ik[16], ak[6], ak_star[6];
+    TESTASSERT(liblte_security_milenage_f1(set.k, set.opc, set.rand, set.sqn, set.amf, mac_a) == LIBLTE_SUCCESS);
+    TESTASSERT(liblte_security_milenage_f1_star(set.k, set.opc, set.rand, set.sqn, set.amf, mac_s) == LIBLTE_SUCCESS);
+    TESTASSERT(liblte_security_milenage_f2345(set.k, set.opc, set.rand, res, ck, ik, ak) == LIBLTE_SUCCESS);
+    TESTASSERT(liblte_security_milenage_f5_star(set.k, set.opc, set.rand, ak_star) == LIBLTE_SUCCESS);
+    TESTASSERT(arrcmp(mac_a, set.mac_a, sizeof(mac_a)) == 0);
+    TESTASSERT(arrcmp(mac_s, set.mac_s, sizeof(mac_s)) == 0);
+    TESTASSERT(arrcmp(res, set.res, sizeof(res)) == 0);
+    TESTASSERT(arrcmp(ck, set.ck, sizeof(ck)) == 0);
+    TESTASSERT(arrcmp(ik, set.ik, sizeof(ik)) == 0);
+    TESTASSERT(arrcmp(ak, set.ak, sizeof(ak)) == 0);
+    TESTASSERT(arrcmp(ak_star, set.ak_star, sizeof(ak_star)) == 0);
+  }
+
+  // A vector without key is rejected
+  vecs[0].k = nullptr;
+  TESTASSERT(srsran::security_milenage_batch(vecs, nof_vecs) != LIBLTE_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
+
 /*
   Own test sets
 */
@@ -224,5 +366,6 @@ int main(int argc, char* argv[])
 
   TESTASSERT(test_set_2() == SRSRAN_SUCCESS);
   TESTASSERT(test_set_xor_own_set_1() == SRSRAN_SUCCESS);
+  TESTASSERT(test_milenage_batch() == SRSRAN_SUCCESS);
   return SRSRAN_SUCCESS;
 }
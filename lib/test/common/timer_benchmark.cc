@@ -0,0 +1,514 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Benchmark of srsran::timer_handler with a large number of concurrently running timers, as created by RLC, PDCP and
+ * RRC for thousands of UEs. Every tic, a fraction of the timers is restarted or stopped, either by the thread that
+ * steps the timers or by other threads. The results are compared against the previous implementation, with a single
+ * mutex-protected flat wheel of 65536 slots.
+ */
+
+#include "srsran/common/test_common.h"
+#include "srsran/common/timers.h"
+#include <chrono>
+#include <getopt.h>
+#include <random>
+#include <thread>
+
+namespace {
+
+/// Previous timer_handler implementation: single wheel of 65536 slots, where every operation takes the same mutex.
+class flat_timer_handler
+{
+  using tic_diff_t                      = uint32_t;
+  using tic_t                           = uint32_t;
+  constexpr static uint32_t INVALID_ID  = std::numeric_limits<uint32_t>::max();
+  constexpr static size_t   WHEEL_SHIFT = 16U;
+  constexpr static size_t   WHEEL_SIZE  = 1U << WHEEL_SHIFT;
+  constexpr static size_t   WHEEL_MASK  = WHEEL_SIZE - 1U;
+
+  constexpr static uint64_t   STOPPED_FLAG       = 0U;
+  constexpr static uint64_t   RUNNING_FLAG       = static_cast<uint64_t>(1U) << 63U;
+  constexpr static uint64_t   EXPIRED_FLAG       = static_cast<uint64_t>(1U) << 62U;
+  constexpr static tic_diff_t MAX_TIMER_DURATION = 0x3FFFFFFFU;
+
+  static bool       decode_is_running(uint64_t value) { return (value & RUNNING_FLAG) != 0; }
+  static bool       decode_is_expired(uint64_t value) { return (value & EXPIRED_FLAG) != 0; }
+  static tic_diff_t decode_duration(uint64_t value) { return (value >> 32U) & MAX_TIMER_DURATION; }
+  static tic_t      decode_timeout(uint64_t value) { return static_cast<uint32_t>(value & 0xFFFFFFFFU); }
+  static uint64_t   encode_state(uint64_t mode_flag, uint32_t duration, uint32_t timeout)
+  {
+    return mode_flag + (static_cast<uint64_t>(duration) << 32U) + timeout;
+  }
+
+  struct timer_impl : public srsran::intrusive_double_linked_list_element<>,
+                      public srsran::intrusive_forward_list_element<> {
+    // const
+    const uint32_t      id;
+    flat_timer_handler& parent;
+    // writes protected by backend lock
+    bool                                  allocated = false;
+    std::atomic<uint64_t>                 state{0}; ///< read can be without lock, thus writes must be atomic
+    srsran::move_callback<void(uint32_t)> callback;
+
+    explicit timer_impl(flat_timer_handler& parent_, uint32_t id_) : parent(parent_), id(id_) {}
+    timer_impl(const timer_impl&) = delete;
+    timer_impl(timer_impl&&)      = delete;
+    timer_impl& operator=(const timer_impl&) = delete;
+    timer_impl& operator=(timer_impl&&) = delete;
+
+    // unprotected
+    bool       is_running_() const { return decode_is_running(state.load(std::memory_order_relaxed)); }
+    bool       is_expired_() const { return decode_is_expired(state.load(std::memory_order_relaxed)); }
+    uint32_t   duration_() const { return decode_duration(state.load(std::memory_order_relaxed)); }
+    bool       is_set_() const { return duration_() > 0; }
+    tic_diff_t time_elapsed_() const
+    {
+      uint64_t state_snapshot = state.load(std::memory_order_relaxed);
+      bool     running = decode_is_running(state_snapshot), expired = decode_is_expired(state_snapshot);
+      uint32_t duration = decode_duration(state_snapshot), timeout = decode_timeout(state_snapshot);
+      return running ? duration - (timeout - parent.cur_time) : (expired ? duration : 0);
+    }
+
+    void set(uint32_t duration_)
+    {
+      srsran_assert(duration_ <= MAX_TIMER_DURATION,
+                    "Invalid timer duration=%" PRIu32 ">%" PRIu32,
+                    duration_,
+                    MAX_TIMER_DURATION);
+      std::lock_guard<std::mutex> lock(parent.mutex);
+      set_(duration_);
+    }
+
+    void set(uint32_t duration_, srsran::move_callback<void(uint32_t)> callback_)
+    {
+      srsran_assert(duration_ <= MAX_TIMER_DURATION,
+                    "Invalid timer duration=%" PRIu32 ">%" PRIu32,
+                    duration_,
+                    MAX_TIMER_DURATION);
+      std::lock_guard<std::mutex> lock(parent.mutex);
+      set_(duration_);
+      callback = std::move(callback_);
+    }
+
+    void run()
+    {
+      std::lock_guard<std::mutex> lock(parent.mutex);
+      parent.start_run_(*this);
+    }
+
+    void stop()
+    {
+      std::lock_guard<std::mutex> lock(parent.mutex);
+      // does not call callback
+      parent.stop_timer_(*this, false);
+    }
+
+    void deallocate()
+    {
+      std::lock_guard<std::mutex> lock(parent.mutex);
+      parent.dealloc_timer_(*this);
+    }
+
+  private:
+    void set_(uint32_t duration_)
+    {
+      duration_ = std::max(duration_, 1U); // the next step will be one place ahead of current one
+      // called in locked context
+      uint64_t old_state = state.load(std::memory_order_relaxed);
+      if (decode_is_running(old_state)) {
+        // if already running, just extends timer lifetime
+        parent.start_run_(*this, duration_);
+      } else {
+        state.store(encode_state(STOPPED_FLAG, duration_, 0), std::memory_order_relaxed);
+      }
+    }
+  };
+
+public:
+  class unique_timer
+  {
+  public:
+    unique_timer() = default;
+    explicit unique_timer(timer_impl* handle_) : handle(handle_) {}
+    unique_timer(const unique_timer&) = delete;
+    unique_timer(unique_timer&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    ~unique_timer() { release(); }
+    unique_timer& operator=(const unique_timer&) = delete;
+    unique_timer& operator                       =(unique_timer&& other) noexcept
+    {
+      if (this != &other) {
+        handle       = other.handle;
+        other.handle = nullptr;
+      }
+      return *this;
+    }
+
+    bool is_valid() const { return handle != nullptr; }
+
+    void set(uint32_t duration_, srsran::move_callback<void(uint32_t)> callback_)
+    {
+      srsran_assert(is_valid(), "Trying to setup empty timer handle");
+      handle->set(duration_, std::move(callback_));
+    }
+    void set(uint32_t duration_)
+    {
+      srsran_assert(is_valid(), "Trying to setup empty timer handle");
+      handle->set(duration_);
+    }
+
+    uint32_t   id() const { return is_valid() ? handle->id : INVALID_ID; }
+    bool       is_set() const { return is_valid() and handle->is_set_(); }
+    bool       is_running() const { return is_valid() and handle->is_running_(); }
+    bool       is_expired() const { return is_valid() and handle->is_expired_(); }
+    tic_diff_t time_elapsed() const { return is_valid() ? handle->time_elapsed_() : 0; }
+    tic_diff_t duration() const { return is_valid() ? handle->duration_() : 0; }
+
+    void run()
+    {
+      srsran_assert(is_valid(), "Starting invalid timer");
+      handle->run();
+    }
+
+    void stop()
+    {
+      if (is_valid()) {
+        handle->stop();
+      }
+    }
+
+    void release()
+    {
+      if (is_valid()) {
+        handle->deallocate();
+        handle = nullptr;
+      }
+    }
+
+  private:
+    timer_impl* handle = nullptr;
+  };
+
+  explicit flat_timer_handler(uint32_t capacity = 64)
+  {
+    time_wheel.resize(WHEEL_SIZE);
+    // Pre-reserve timers
+    while (timer_list.size() < capacity) {
+      timer_list.emplace_back(*this, timer_list.size());
+    }
+    // push to free list in reverse order to keep ascending ids
+    for (auto it = timer_list.rbegin(); it != timer_list.rend(); ++it) {
+      free_list.push_front(&(*it));
+    }
+    nof_free_timers = timer_list.size();
+  }
+
+  void step_all()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint32_t                     cur_time_local = cur_time.load(std::memory_order_relaxed) + 1;
+    auto&                        wheel_list     = time_wheel[cur_time_local & WHEEL_MASK];
+
+    for (auto it = wheel_list.begin(); it != wheel_list.end();) {
+      timer_impl& timer = timer_list[it->id];
+      ++it;
+      if (decode_timeout(timer.state.load(std::memory_order_relaxed)) == cur_time_local) {
+        // stop timer (callback has to see the timer has already expired)
+        stop_timer_(timer, true);
+
+        // Call callback if configured
+        if (not timer.callback.is_empty()) {
+          // unlock mutex. It can happen that the callback tries to run a timer too
+          lock.unlock();
+
+          timer.callback(timer.id);
+
+          // Lock again to keep protecting the wheel
+          lock.lock();
+        }
+      }
+    }
+
+    cur_time.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  unique_timer get_unique_timer() { return unique_timer(&alloc_timer()); }
+
+private:
+  timer_impl& alloc_timer()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    timer_impl*                 t;
+    if (not free_list.empty()) {
+      t = &free_list.front();
+      srsran_assert(not t->allocated, "Invalid timer id=%d state", t->id);
+      free_list.pop_front();
+      nof_free_timers--;
+    } else {
+      // Need to increase deque
+      timer_list.emplace_back(*this, timer_list.size());
+      t = &timer_list.back();
+    }
+    t->allocated = true;
+    return *t;
+  }
+
+  void dealloc_timer_(timer_impl& timer)
+  {
+    if (not timer.allocated) {
+      // already deallocated
+      return;
+    }
+    stop_timer_(timer, false);
+    timer.allocated = false;
+    timer.state.store(encode_state(STOPPED_FLAG, 0, 0), std::memory_order_relaxed);
+    timer.callback = srsran::move_callback<void(uint32_t)>();
+    free_list.push_front(&timer);
+    nof_free_timers++;
+    // leave id unchanged.
+  }
+
+  void start_run_(timer_impl& timer, uint32_t duration_ = 0)
+  {
+    uint64_t timer_old_state = timer.state.load(std::memory_order_relaxed);
+    duration_                = duration_ == 0 ? decode_duration(timer_old_state) : duration_;
+    uint32_t new_timeout     = cur_time.load(std::memory_order_relaxed) + duration_;
+    size_t   new_wheel_pos   = new_timeout & WHEEL_MASK;
+
+    uint32_t old_timeout = decode_timeout(timer_old_state);
+    bool     was_running = decode_is_running(timer_old_state);
+    if (was_running and (old_timeout & WHEEL_MASK) == new_wheel_pos) {
+      // If no change in timer wheel position. Just update absolute timeout
+      timer.state.store(encode_state(RUNNING_FLAG, duration_, new_timeout), std::memory_order_relaxed);
+      return;
+    }
+
+    // Stop timer if it was running, removing it from wheel in the process
+    if (was_running) {
+      time_wheel[old_timeout & WHEEL_MASK].pop(&timer);
+      nof_timers_running_--;
+    }
+
+    // Insert timer in wheel
+    time_wheel[new_wheel_pos].push_front(&timer);
+    timer.state.store(encode_state(RUNNING_FLAG, duration_, new_timeout), std::memory_order_relaxed);
+    nof_timers_running_++;
+  }
+
+  /// called when user manually stops timer (as an alternative to expiry)
+  void stop_timer_(timer_impl& timer, bool expiry)
+  {
+    uint64_t timer_old_state = timer.state.load(std::memory_order_relaxed);
+    if (not decode_is_running(timer_old_state)) {
+      return;
+    }
+
+    // If already running, need to disconnect it from previous wheel
+    uint32_t old_timeout = decode_timeout(timer_old_state);
+    time_wheel[old_timeout & WHEEL_MASK].pop(&timer);
+    uint64_t new_state =
+        encode_state(expiry ? EXPIRED_FLAG : STOPPED_FLAG, decode_duration(timer_old_state), old_timeout);
+    timer.state.store(new_state, std::memory_order_relaxed);
+    nof_timers_running_--;
+  }
+
+  std::atomic<tic_t> cur_time{0};
+  size_t             nof_timers_running_ = 0, nof_free_timers = 0;
+  // using a deque to maintain reference validity on emplace_back. Also, this deque will only grow.
+  std::deque<timer_impl>                                         timer_list;
+  srsran::intrusive_forward_list<timer_impl>                     free_list;
+  std::vector<srsran::intrusive_double_linked_list<timer_impl> > time_wheel;
+  mutable std::mutex                                             mutex; // Protect priority queue
+};
+
+/// Adapter of the timer handlers to the interface of the benchmark
+template <typename Handler>
+class timer_domain
+{
+public:
+  explicit timer_domain(uint32_t nof_timers) : timers(nof_timers)
+  {
+    for (uint32_t i = 0; i < nof_timers; ++i) {
+      utimers.push_back(timers.get_unique_timer());
+      utimers.back().set(1, [this](uint32_t tid) { nof_expired++; });
+    }
+  }
+
+  void run(uint32_t id, uint32_t duration)
+  {
+    utimers[id].set(duration);
+    utimers[id].run();
+  }
+  void stop(uint32_t id) { utimers[id].stop(); }
+  void step_all() { timers.step_all(); }
+
+  uint64_t nof_expired = 0;
+
+private:
+  Handler                                       timers;
+  std::vector<typename Handler::unique_timer> utimers;
+};
+
+/// Timer durations (ms) of the RLC, PDCP and RRC timers of a UE
+uint32_t random_duration(std::mt19937& rgen)
+{
+  static const uint32_t durations[] = {35, 35, 45, 45, 50, 100, 1000, 5000, 30000};
+  return durations[rgen() % (sizeof(durations) / sizeof(durations[0]))];
+}
+
+struct bench_result {
+  double   us_per_tic;
+  double   max_step_us;
+  uint64_t nof_expired;
+};
+
+/// Thread t of nof_threads owns the timers with id % nof_threads == t. Thread 0 also steps the timers.
+template <typename Wheel>
+bench_result run_bench(uint32_t nof_timers, uint32_t nof_tics, uint32_t churn_permille, uint32_t nof_threads)
+{
+  Wheel        wheel(nof_timers);
+  std::mt19937 rgen(0);
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    wheel.run(i, 1 + rgen() % random_duration(rgen));
+  }
+  uint32_t nof_ops = std::max(nof_timers / nof_threads * churn_permille / 1000, 1U);
+
+  auto churn = [&wheel, nof_timers, nof_threads, nof_ops](uint32_t t, std::mt19937& g) {
+    for (uint32_t i = 0; i < nof_ops; ++i) {
+      uint32_t id = (g() % (nof_timers / nof_threads)) * nof_threads + t;
+      if (g() % 5 != 0) {
+        wheel.run(id, random_duration(g));
+      } else {
+        wheel.stop(id);
+      }
+    }
+  };
+
+  std::atomic<uint32_t>    tic{0};
+  std::vector<std::thread> workers;
+  std::vector<uint32_t>    done(nof_threads, 0);
+  std::atomic<uint32_t>    nof_done{0};
+  for (uint32_t t = 1; t < nof_threads; ++t) {
+    workers.emplace_back([&, t]() {
+      std::mt19937 g(t);
+      for (uint32_t k = 1; k <= nof_tics; ++k) {
+        while (tic.load(std::memory_order_acquire) < k) {
+          std::this_thread::yield();
+        }
+        churn(t, g);
+        nof_done.fetch_add(1, std::memory_order_acq_rel);
+      }
+    });
+  }
+
+  double max_step_us = 0;
+  auto   start       = std::chrono::high_resolution_clock::now();
+  for (uint32_t k = 1; k <= nof_tics; ++k) {
+    tic.store(k, std::memory_order_release);
+    churn(0, rgen);
+
+    auto step_start = std::chrono::high_resolution_clock::now();
+    wheel.step_all();
+    double step_us = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() -
+                                                                          step_start)
+                         .count() /
+                     1000.0;
+    max_step_us = std::max(max_step_us, step_us);
+
+    // wait for the other threads to finish their requests of this tic
+    while (nof_done.load(std::memory_order_acquire) < k * (nof_threads - 1)) {
+      std::this_thread::yield();
+    }
+  }
+  double elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+  for (std::thread& t : workers) {
+    t.join();
+  }
+
+  bench_result ret;
+  ret.us_per_tic  = elapsed_us / nof_tics;
+  ret.max_step_us = max_step_us;
+  ret.nof_expired = wheel.nof_expired;
+  return ret;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t nof_timers     = 100000;
+  uint32_t nof_tics       = 2000;
+  uint32_t churn_permille = 10;
+  uint32_t max_threads    = 4;
+  uint32_t nof_runs       = 3;
+  int      opt;
+  while ((opt = getopt(argc, argv, "t:n:c:w:r:")) != -1) {
+    switch (opt) {
+      case 't':
+        nof_timers = strtoul(optarg, nullptr, 10);
+        break;
+      case 'n':
+        nof_tics = strtoul(optarg, nullptr, 10);
+        break;
+      case 'c':
+        churn_permille = strtoul(optarg, nullptr, 10);
+        break;
+      case 'w':
+        max_threads = strtoul(optarg, nullptr, 10);
+        break;
+      case 'r':
+        nof_runs = std::max(strtoul(optarg, nullptr, 10), 1UL);
+        break;
+      default:
+        fmt::print("Usage: {} [-t timers] [-n tics] [-c churn (permille)] [-w max threads] [-r runs]\n", argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+
+  fmt::print("Timers: {}, tics: {}, restarted/stopped per tic: {} permille\n", nof_timers, nof_tics, churn_permille);
+  fmt::print("{:>8}{:>16}{:>16}{:>16}{:>16}\n", "threads", "flat [us/tic]", "max step", "hier. [us/tic]", "max step");
+  for (uint32_t nof_threads = 1; nof_threads <= max_threads; nof_threads *= 2) {
+    // best of several runs, to filter out the preemptions of the benchmark threads
+    bench_result old_res = {}, new_res = {};
+    for (uint32_t i = 0; i < nof_runs; ++i) {
+      using old_domain  = timer_domain<flat_timer_handler>;
+      using new_domain  = timer_domain<srsran::timer_handler>;
+      bench_result r1   = run_bench<old_domain>(nof_timers, nof_tics, churn_permille, nof_threads);
+      bench_result r2   = run_bench<new_domain>(nof_timers, nof_tics, churn_permille, nof_threads);
+      old_res           = (i == 0 or r1.us_per_tic < old_res.us_per_tic) ? r1 : old_res;
+      new_res           = (i == 0 or r2.us_per_tic < new_res.us_per_tic) ? r2 : new_res;
+    }
+    if (nof_threads == 1) {
+      // Without other threads, both implementations expire exactly the same timers
+      TESTASSERT(old_res.nof_expired == new_res.nof_expired);
+    }
+
+    fmt::print("{:>8}{:>16.2f}{:>16.2f}{:>16.2f}{:>16.2f}\n",
+               nof_threads,
+               old_res.us_per_tic,
+               old_res.max_step_us,
+               new_res.us_per_tic,
+               new_res.max_step_us);
+  }
+
+  return SRSRAN_SUCCESS;
+}
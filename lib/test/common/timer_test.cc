@@ -448,6 +448,112 @@ void timers_test7()
   TESTASSERT(timers.nof_running_timers() == 1 and timers.nof_timers() == 3);
 }
 
+/**
+ * Tests specific to the hierarchical wheel:
+ * - timers that are cascaded from the upper levels expire at the exact tic
+ * - timers run from the callbacks of expiring timers
+ */
+void timers_test8()
+{
+  timer_handler               timers;
+  uint32_t                    cur_tic = 0;
+  std::vector<unique_timer>   utimers;
+  std::vector<uint32_t>       expiry_tic;
+  const std::vector<uint32_t> durations = {1, 255, 256, 257, 300, 511, 512, 65535, 65536, 65537, 70000, 131072};
+
+  for (uint32_t i = 0; i < durations.size(); ++i) {
+    utimers.push_back(timers.get_unique_timer());
+    expiry_tic.push_back(0);
+    utimers[i].set(durations[i], [&expiry_tic, &cur_tic, i](uint32_t tid) { expiry_tic[i] = cur_tic; });
+    utimers[i].run();
+  }
+  // restart a timer from its own callback with the minimum duration
+  unique_timer t = timers.get_unique_timer();
+  uint32_t     nof_restarts = 0;
+  t.set(100, [&t, &nof_restarts](uint32_t tid) {
+    if (++nof_restarts < 3) {
+      t.set(1);
+      t.run();
+    }
+  });
+  t.run();
+
+  for (cur_tic = 1; cur_tic <= 131072; ++cur_tic) {
+    timers.step_all();
+    if (cur_tic == 100) {
+      TESTASSERT(nof_restarts == 1 and t.is_running());
+    }
+  }
+  for (uint32_t i = 0; i < durations.size(); ++i) {
+    TESTASSERT(expiry_tic[i] == durations[i]);
+    TESTASSERT(utimers[i].is_expired());
+  }
+  TESTASSERT(nof_restarts == 3 and t.is_expired());
+  TESTASSERT(timers.nof_running_timers() == 0);
+}
+
+/**
+ * Description: Requests from a thread other than the one stepping the timers are visible to the getters right away,
+ * and the timers are placed in the wheel in the next tic
+ */
+void timers_test9()
+{
+  timer_handler timers;
+  bool          expired = false;
+  unique_timer  t       = timers.get_unique_timer();
+  unique_timer  t2      = timers.get_unique_timer();
+
+  // The first step binds the timers to this thread
+  timers.step_all();
+
+  std::thread thread([&]() {
+    t.set(2, [&expired](uint32_t tid) { expired = true; });
+    t.run();
+    t2.set(5);
+    t2.run();
+    t2.stop();
+    t2.run();
+  });
+  thread.join();
+  TESTASSERT(t.is_running() and t.duration() == 2 and t.time_elapsed() == 0);
+  TESTASSERT(t2.is_running() and t2.duration() == 5);
+  TESTASSERT(timers.nof_running_timers() == 2);
+
+  timers.step_all();
+  TESTASSERT(t.is_running() and t.duration() == 2 and t.time_elapsed() == 1);
+  TESTASSERT(not expired);
+
+  timers.step_all();
+  TESTASSERT(expired and t.is_expired());
+
+  // A timer stopped by another thread does not expire, and a timer run again is no longer expired
+  thread = std::thread([&]() {
+    t2.stop();
+    t.run();
+  });
+  thread.join();
+  TESTASSERT(not t2.is_running() and not t2.is_expired());
+  TESTASSERT(t.is_running() and not t.is_expired());
+  TESTASSERT(timers.nof_running_timers() == 1);
+  expired = false;
+  for (uint32_t i = 0; i < 5; ++i) {
+    timers.step_all();
+  }
+  TESTASSERT(expired and t.is_expired());
+  TESTASSERT(not t2.is_running() and not t2.is_expired());
+  TESTASSERT(timers.nof_running_timers() == 0);
+
+  // Release of timers from another thread
+  thread = std::thread([&]() {
+    t.release();
+    t2.release();
+  });
+  thread.join();
+  TESTASSERT(timers.nof_timers() == 2);
+  timers.step_all();
+  TESTASSERT(timers.nof_timers() == 0 and timers.nof_running_timers() == 0);
+}
+
 int main()
 {
   timers_test1();
@@ -457,6 +563,8 @@ int main()
   timers_test5();
   timers_test6();
   timers_test7();
+  timers_test8();
+  timers_test9();
   printf("Success\n");
   return 0;
 }
@@ -30,6 +30,7 @@
 #include "srsran/interfaces/ue_interfaces.h"
 #include "srsran/interfaces/ue_rlc_interfaces.h"
 #include <iostream>
+#include <vector>
 
 int compare_two_packets(const srsran::unique_byte_buffer_t& msg1, const srsran::unique_byte_buffer_t& msg2)
 {
@@ -54,6 +55,11 @@ public:
   void write_sdu(uint32_t lcid, srsran::unique_byte_buffer_t sdu)
   {
     logger.info(sdu->msg, sdu->N_bytes, "RLC SDU");
+    if (keep_history) {
+      srsran::unique_byte_buffer_t copy = srsran::make_byte_buffer();
+      *copy                             = *sdu;
+      sdu_history.push_back(std::move(copy));
+    }
     last_pdcp_pdu.swap(sdu);
     rx_count++;
   }
@@ -69,6 +75,10 @@ public:
   uint64_t rx_count      = 0;
   uint64_t discard_count = 0;
 
+  // When set, a copy of every SDU is kept, in order of arrival
+  bool                                      keep_history = false;
+  std::vector<srsran::unique_byte_buffer_t> sdu_history;
+
 private:
   srslog::basic_logger&        logger;
   srsran::unique_byte_buffer_t last_pdcp_pdu;
@@ -0,0 +1,111 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include "pdcp_lte_test.h"
+
+/*
+ * Checks that a burst of SDUs written with write_sdus(), whose PDUs are ciphered in one batch, produces the same PDUs
+ * as writing the SDUs one by one.
+ */
+int test_tx_burst(srsran::pdcp_rb_type_t          rb_type,
+                  uint8_t                         sn_len,
+                  const srsran::pdcp_lte_state_t& init_state,
+                  uint32_t                        nof_sdus,
+                  srslog::basic_logger&           logger)
+{
+  srsran::pdcp_config_t cfg = {1,
+                               rb_type,
+                               srsran::SECURITY_DIRECTION_UPLINK,
+                               srsran::SECURITY_DIRECTION_DOWNLINK,
+                               sn_len,
+                               srsran::pdcp_t_reordering_t::ms500,
+                               srsran::pdcp_discard_timer_t::infinity,
+                               false,
+                               srsran::srsran_rat_t::lte};
+
+  pdcp_lte_test_helper     pdcp_hlp(cfg, sec_cfg, logger);
+  srsran::pdcp_entity_lte* pdcp = &pdcp_hlp.pdcp;
+  rlc_dummy*               rlc  = &pdcp_hlp.rlc;
+  rlc->keep_history             = true;
+  pdcp_hlp.set_pdcp_initial_state(init_state);
+
+  // SDUs of different sizes, so that the ciphering lanes are unevenly filled
+  std::vector<srsran::unique_byte_buffer_t> sdus;
+  std::vector<srsran::unique_byte_buffer_t> burst;
+  for (uint32_t i = 0; i < nof_sdus; ++i) {
+    srsran::unique_byte_buffer_t sdu = srsran::make_byte_buffer();
+    TESTASSERT(sdu != nullptr);
+    for (uint32_t j = 0; j < 1 + (i * 37) % 300; ++j) {
+      sdu->msg[j] = (uint8_t)(i + j);
+    }
+    sdu->N_bytes = 1 + (i * 37) % 300;
+
+    srsran::unique_byte_buffer_t copy = srsran::make_byte_buffer();
+    TESTASSERT(copy != nullptr);
+    *copy = *sdu;
+    sdus.push_back(std::move(copy));
+    burst.push_back(std::move(sdu));
+  }
+  pdcp->write_sdus(burst);
+
+  TESTASSERT(rlc->rx_count == nof_sdus);
+  TESTASSERT(rlc->sdu_history.size() == nof_sdus);
+  uint32_t count = pdcp->COUNT(init_state.tx_hfn, init_state.next_pdcp_tx_sn);
+  for (uint32_t i = 0; i < nof_sdus; ++i) {
+    srsran::unique_byte_buffer_t expected = gen_expected_pdu(sdus[i], count + i, sn_len, rb_type, sec_cfg, logger);
+    TESTASSERT(compare_two_packets(expected, rlc->sdu_history[i]) == 0);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int run_all_tests()
+{
+  // Setup log
+  auto& logger = srslog::fetch_basic_logger("PDCP LTE Test", false);
+  logger.set_level(srslog::basic_levels::info);
+  logger.set_hex_dump_max_size(128);
+
+  // Close to the SN wraparound, so that the burst crosses an HFN increment
+  srsran::pdcp_lte_state_t wrap_state = {};
+  wrap_state.next_pdcp_tx_sn          = 4090;
+
+  for (uint32_t nof_sdus : {1, 7, 33, 80}) {
+    TESTASSERT(test_tx_burst(srsran::PDCP_RB_IS_DRB, srsran::PDCP_SN_LEN_12, normal_init_state, nof_sdus, logger) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(test_tx_burst(srsran::PDCP_RB_IS_DRB, srsran::PDCP_SN_LEN_12, wrap_state, nof_sdus, logger) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(test_tx_burst(srsran::PDCP_RB_IS_SRB, srsran::PDCP_SN_LEN_5, normal_init_state, nof_sdus, logger) ==
+               SRSRAN_SUCCESS);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int main()
+{
+  srslog::init();
+
+  if (run_all_tests() != SRSRAN_SUCCESS) {
+    fprintf(stderr, "pdcp_lte_test_tx_burst() failed\n");
+    return SRSRAN_ERROR;
+  }
+
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
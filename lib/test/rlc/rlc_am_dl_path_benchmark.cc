@@ -0,0 +1,236 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Benchmark of the DL user-plane path from RLC AM to the MAC TB. PDCP PDUs of a fixed size are segmented into RLC
+ * data PDUs, which the MAC writes directly into the TB buffer. The RLC entity keeps slices of the SDUs for
+ * retransmission, so that every payload byte is copied once, from the SDU into the TB. The previous data path, which
+ * first copied the SDU segments into a PDU buffer and then copied that buffer into the TB, is emulated for comparison.
+ * The peer acks the whole Tx window periodically, so no retransmissions take place.
+ */
+
+#include "srsran/common/buffer_pool.h"
+#include "srsran/common/test_common.h"
+#include "srsran/interfaces/ue_pdcp_interfaces.h"
+#include "srsran/interfaces/ue_rrc_interfaces.h"
+#include "srsran/mac/pdu.h"
+#include "srsran/rlc/rlc_am_lte.h"
+#include <chrono>
+#include <deque>
+#include <getopt.h>
+
+using namespace srsran;
+
+namespace {
+
+const uint32_t lcid        = 3;
+const uint32_t sn_mod      = 1024;
+const uint32_t pdcp_sn_mod = 4096;
+
+struct bench_args {
+  uint32_t sdu_size  = 1500;
+  uint32_t tb_size   = 4000;
+  uint32_t nof_tbs   = 100000;
+  uint32_t ack_every = 64; ///< Number of TBs between status PDUs that ack the whole window
+};
+
+struct bench_result {
+  double   mbps;
+  uint64_t nof_data_bytes;   ///< SDU bytes delivered in TBs
+  uint64_t nof_copied_bytes; ///< SDU bytes copied on the way to the TB
+  uint64_t nof_pdus;
+};
+
+/// Stubs of the upper layers of the RLC entity under test
+class upper_layer_dummy : public srsue::pdcp_interface_rlc, public srsue::rrc_interface_rlc
+{
+public:
+  void        write_pdu(uint32_t lcid_, unique_byte_buffer_t sdu) override {}
+  void        write_pdu_bcch_bch(unique_byte_buffer_t sdu) override {}
+  void        write_pdu_bcch_dlsch(unique_byte_buffer_t sdu) override {}
+  void        write_pdu_pcch(unique_byte_buffer_t sdu) override {}
+  void        write_pdu_mch(uint32_t lcid_, unique_byte_buffer_t sdu) override {}
+  void        notify_delivery(uint32_t lcid_, const pdcp_sn_vector_t& pdcp_sns) override {}
+  void        notify_failure(uint32_t lcid_, const pdcp_sn_vector_t& pdcp_sns) override {}
+  void        max_retx_attempted() override {}
+  void        protocol_failure() override {}
+  const char* get_rb_name(uint32_t lcid_) override { return "DRB1"; }
+};
+
+/// Exposes the RLC AM entity to the MAC. The entity gathers the SDU slices of a PDU straight into the TB, so the
+/// data field of each PDU is copied once. In legacy mode, the previous data path is emulated on top of it: the PDU is
+/// built in a pool buffer, which is kept until the PDU is acked, and copied into the TB.
+class rlc_am_reader : public read_pdu_interface
+{
+public:
+  rlc_am_reader(rlc_am_lte& rlc_, bool legacy_) : rlc(rlc_), legacy(legacy_) {}
+
+  uint32_t read_pdu(uint32_t lcid_, uint8_t* payload, uint32_t nof_bytes) override
+  {
+    uint8_t*             pdu_ptr = payload;
+    unique_byte_buffer_t pdu;
+    if (legacy) {
+      pdu = make_byte_buffer();
+      if (pdu == nullptr) {
+        return 0;
+      }
+      pdu_ptr   = pdu->msg;
+      nof_bytes = std::min(nof_bytes, pdu->get_tailroom());
+    }
+    uint32_t len = rlc.read_pdu(pdu_ptr, nof_bytes);
+    if (len == 0) {
+      return 0;
+    }
+
+    rlc_amd_pdu_header_t header;
+    uint8_t*             ptr      = pdu_ptr;
+    uint32_t             data_len = len;
+    rlc_am_read_data_pdu_header(&ptr, &data_len, &header);
+    next_sn = (header.sn + 1) % sn_mod;
+    nof_data_bytes += data_len;
+    nof_copied_bytes += data_len;
+    nof_pdus++;
+    if (legacy) {
+      memcpy(payload, pdu_ptr, len);
+      nof_copied_bytes += data_len;
+      pdu->N_bytes = len;
+      tx_window.push_back(std::move(pdu));
+    }
+    return len;
+  }
+
+  /// Acks every PDU sent so far with a status PDU from the peer
+  void ack_all()
+  {
+    rlc_status_pdu_t status;
+    status.ack_sn = next_sn;
+    uint8_t buf[16];
+    int     len = rlc_am_write_status_pdu(&status, buf);
+    rlc.write_pdu(buf, len);
+    tx_window.clear();
+  }
+
+  uint64_t nof_data_bytes   = 0;
+  uint64_t nof_copied_bytes = 0;
+  uint64_t nof_pdus         = 0;
+
+private:
+  rlc_am_lte&                      rlc;
+  bool                             legacy;
+  uint32_t                         next_sn = 0;
+  std::deque<unique_byte_buffer_t> tx_window;
+};
+
+bench_result run_bench(const bench_args& args, bool legacy)
+{
+  upper_layer_dummy upper;
+  timer_handler     timers(8);
+  rlc_am_lte        rlc(srslog::fetch_basic_logger("RLC", false), lcid, &upper, &upper, &timers);
+  TESTASSERT(rlc.configure(rlc_config_t::default_rlc_am_config()));
+  rlc_am_reader reader(rlc, legacy);
+
+  srslog::basic_logger&    logger = srslog::fetch_basic_logger("MAC", false);
+  sch_pdu                  mac_msg(20, logger);
+  uint32_t                 pdcp_sn = 0;
+  std::chrono::nanoseconds elapsed{0};
+
+  for (uint32_t i = 0; i < args.nof_tbs; ++i) {
+    // Keep enough SDUs queued to fill the next TB
+    while (rlc.get_buffer_state() < 2 * args.tb_size) {
+      unique_byte_buffer_t sdu = make_sized_byte_buffer(args.sdu_size);
+      TESTASSERT(sdu != nullptr);
+      sdu->N_bytes    = args.sdu_size;
+      sdu->md.pdcp_sn = pdcp_sn;
+      pdcp_sn         = (pdcp_sn + 1) % pdcp_sn_mod;
+      memset(sdu->msg, pdcp_sn, sdu->N_bytes);
+      rlc.write_sdu(std::move(sdu));
+    }
+
+    unique_byte_buffer_t tb = make_sized_byte_buffer(args.tb_size);
+    TESTASSERT(tb != nullptr);
+    auto tic = std::chrono::high_resolution_clock::now();
+    mac_msg.init_tx(tb.get(), args.tb_size, false);
+    int sdu_space = mac_msg.get_sdu_space();
+    TESTASSERT(mac_msg.new_subh());
+    int sdu_len = mac_msg.get()->set_sdu(lcid, sdu_space, &reader);
+    TESTASSERT(mac_msg.write_packet(logger) != nullptr);
+    elapsed += std::chrono::high_resolution_clock::now() - tic;
+    TESTASSERT(sdu_len > 0);
+
+    if ((i + 1) % args.ack_every == 0) {
+      reader.ack_all();
+    }
+  }
+
+  bench_result ret;
+  ret.mbps             = reader.nof_data_bytes * 8000.0 / elapsed.count();
+  ret.nof_data_bytes   = reader.nof_data_bytes;
+  ret.nof_copied_bytes = reader.nof_copied_bytes;
+  ret.nof_pdus         = reader.nof_pdus;
+  return ret;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  bench_args args;
+  int        opt;
+  while ((opt = getopt(argc, argv, "a:n:s:t:")) != -1) {
+    switch (opt) {
+      case 'a':
+        args.ack_every = strtoul(optarg, nullptr, 10);
+        break;
+      case 'n':
+        args.nof_tbs = strtoul(optarg, nullptr, 10);
+        break;
+      case 's':
+        args.sdu_size = strtoul(optarg, nullptr, 10);
+        break;
+      case 't':
+        args.tb_size = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        fmt::print("Usage: {} [-s sdu_size] [-t tb_size] [-n nof_tbs] [-a tbs_between_acks]\n", argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+  srslog::fetch_basic_logger("MAC", false).set_level(srslog::basic_levels::none);
+  srslog::fetch_basic_logger("RLC", false).set_level(srslog::basic_levels::none);
+  srslog::init();
+
+  bench_result old_res = run_bench(args, true);
+  bench_result new_res = run_bench(args, false);
+
+  // Both paths deliver the same SDU bytes in the same PDUs. Only the number of copies differs
+  TESTASSERT(new_res.nof_pdus > 0);
+  TESTASSERT(old_res.nof_data_bytes == new_res.nof_data_bytes and old_res.nof_pdus == new_res.nof_pdus);
+  TESTASSERT(new_res.nof_copied_bytes == new_res.nof_data_bytes);
+
+  fmt::print("SDU size: {} B, TB size: {} B, TBs: {}\n", args.sdu_size, args.tb_size, args.nof_tbs);
+  fmt::print("Delivered {} B in {} PDUs\n", new_res.nof_data_bytes, new_res.nof_pdus);
+  fmt::print("{:>12}{:>16}{:>24}\n", "path", "Mbps", "copied B / delivered B");
+  fmt::print("{:>12}{:>16.1f}{:>24.2f}\n", "copy", old_res.mbps, (double)old_res.nof_copied_bytes / old_res.nof_data_bytes);
+  fmt::print("{:>12}{:>16.1f}{:>24.2f}\n", "chain", new_res.mbps, (double)new_res.nof_copied_bytes / new_res.nof_data_bytes);
+
+  srslog::flush();
+  return SRSRAN_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include "srsran/interfaces/ue_pdcp_interfaces.h"
 #include "srsran/interfaces/ue_rrc_interfaces.h"
 #include "srsran/rlc/rlc_am_lte.h"
+#include <thread>
 
 #define NBUFS 5
 #define HAVE_PCAP 0
@@ -3305,6 +3306,61 @@ bool status_pdu_test()
   return SRSRAN_SUCCESS;
 }
 
+// Checks that the status prohibit timer, started when a status PDU is built in a thread other than the one stepping
+// the timers, prohibits further status PDUs in the same TTI.
+bool status_prohibit_other_thread_test()
+{
+  rlc_am_tester         tester;
+  srsran::timer_handler timers(8);
+
+  rlc_am_lte rlc1(srslog::fetch_basic_logger("RLC_AM_1"), 1, &tester, &tester, &timers);
+  rlc_am_lte rlc2(srslog::fetch_basic_logger("RLC_AM_2"), 1, &tester, &tester, &timers);
+
+  if (not rlc1.configure(rlc_config_t::default_rlc_am_config())) {
+    return -1;
+  }
+
+  if (not rlc2.configure(rlc_config_t::default_rlc_am_config())) {
+    return -1;
+  }
+
+  // The timers are stepped by this thread
+  timers.step_all();
+
+  std::thread worker([&]() {
+    // Read a PDU with the poll bit set, since the Tx queue is left empty
+    unique_byte_buffer_t sdu = srsran::make_byte_buffer();
+    sdu->N_bytes             = 1;
+    sdu->msg[0]              = 0;
+    rlc1.write_sdu(std::move(sdu));
+    byte_buffer_t pdu_buf;
+    pdu_buf.N_bytes = rlc1.read_pdu(pdu_buf.msg, 3); // 2 byte header + 1 byte payload
+    rlc2.write_pdu(pdu_buf.msg, pdu_buf.N_bytes);
+
+    // Read the status PDU, which starts the status prohibit timer
+    byte_buffer_t status_buf;
+    TESTASSERT(rlc2.get_buffer_state() == 2);
+    status_buf.N_bytes = rlc2.read_pdu(status_buf.msg, 2);
+    TESTASSERT(status_buf.N_bytes == 2);
+
+    // Poll again with a duplicate PDU. The status PDU is prohibited
+    rlc2.write_pdu(pdu_buf.msg, pdu_buf.N_bytes);
+    TESTASSERT(rlc2.get_buffer_state() == 0);
+    TESTASSERT(not rlc2.has_data());
+    TESTASSERT(rlc2.read_pdu(status_buf.msg, 2) == 0);
+  });
+  worker.join();
+
+  // Step timers until the status prohibit timer expires
+  for (int cnt = 0; cnt < 5; cnt++) {
+    TESTASSERT(rlc2.get_buffer_state() == 0);
+    timers.step_all();
+  }
+  TESTASSERT(rlc2.get_buffer_state() == 2);
+
+  return SRSRAN_SUCCESS;
+}
+
 // This test checks the correct handling of a sending RLC entity when an incorrect status PDU is injected.
 // In this test, the receiver requests the retransmission of a SN that he has acknowledeged before.
 // The incidence is reported to the upper layers.
@@ -3868,6 +3924,11 @@ int main(int argc, char** argv)
     exit(-1);
   };
 
+  if (status_prohibit_other_thread_test()) {
+    printf("status_prohibit_other_thread_test failed\n");
+    exit(-1);
+  };
+
   if (incorrect_status_pdu_test()) {
     printf("incorrect_status_pdu_test failed\n");
     exit(-1);
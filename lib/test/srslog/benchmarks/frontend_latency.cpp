@@ -21,6 +21,7 @@
 
 #include "srsran/srslog/srslog.h"
 #include <atomic>
+#include <cstdio>
 #include <sys/resource.h>
 #include <thread>
 
@@ -29,6 +30,9 @@ using namespace srslog;
 static constexpr unsigned num_iterations       = 4000;
 static constexpr unsigned num_entries_per_iter = 40;
 
+/// Number of entries generated by each thread in the backend throughput benchmark.
+static constexpr unsigned num_throughput_entries = 200000;
+
 namespace {
 
 /// This helper class checks if there has been context switches between its construction and destruction for the caller
@@ -56,6 +60,47 @@ private:
   std::atomic<unsigned>& counter;
 };
 
+/// Sink that writes into a file and counts the number of entries that reach it.
+class counting_file_sink : public sink
+{
+public:
+  counting_file_sink(const std::string& path, std::unique_ptr<log_formatter> f) :
+    sink(std::move(f)), handle(std::fopen(path.c_str(), "wb"))
+  {}
+
+  ~counting_file_sink() override
+  {
+    if (handle) {
+      std::fclose(handle);
+    }
+  }
+
+  detail::error_string write(detail::memory_buffer buffer) override
+  {
+    ++nof_entries;
+    nof_bytes += buffer.size();
+    if (handle) {
+      std::fwrite(buffer.data(), 1, buffer.size(), handle);
+    }
+    return {};
+  }
+
+  detail::error_string flush() override
+  {
+    if (handle) {
+      std::fflush(handle);
+    }
+    return {};
+  }
+
+  /// Counters only modified by the backend thread, read them after flushing the backend.
+  uint64_t nof_entries = 0;
+  uint64_t nof_bytes   = 0;
+
+private:
+  std::FILE* handle;
+};
+
 } // namespace
 
 /// Busy waits in the calling thread for the specified amount of time.
@@ -104,6 +149,7 @@ static void benchmark(unsigned num_threads)
   std::vector<std::thread> workers;
   workers.reserve(num_threads);
 
+  uint64_t              dropped_before = srslog::get_nof_dropped_entries();
   std::atomic<unsigned> ctx_counter(0);
   for (unsigned i = 0; i != num_threads; ++i) {
     workers.emplace_back(run_thread, std::ref(channel), std::ref(thread_results[i]), std::ref(ctx_counter));
@@ -118,12 +164,14 @@ static void benchmark(unsigned num_threads)
     results.insert(results.end(), v.begin(), v.end());
   }
   std::sort(results.begin(), results.end());
+  uint64_t num_dropped = srslog::get_nof_dropped_entries() - dropped_before;
 
   fmt::print("SRSLOG Frontend Latency Benchmark - logging with {} thread{}\n"
              "All values in nanoseconds\n"
              "Percentiles: | 50th | 75th | 90th | 99th | 99.9th | Worst |\n"
              "             |{:6}|{:6}|{:6}|{:6}|{:8}|{:7}|\n"
-             "Context switches: {} in {} of generated entries\n\n",
+             "Context switches: {} in {} of generated entries\n"
+             "Dropped entries: {}\n\n",
              num_threads,
              (num_threads > 1) ? "s" : "",
              results[static_cast<size_t>(results.size() * 0.5)],
@@ -133,14 +181,69 @@ static void benchmark(unsigned num_threads)
              results[static_cast<size_t>(results.size() * 0.999)],
              results.back(),
              ctx_counter,
-             num_threads * num_iterations * num_entries_per_iter);
+             num_threads * num_iterations * num_entries_per_iter,
+             num_dropped);
+}
+
+/// Worker function used for each thread of the throughput benchmark, generating log entries as fast as possible.
+static void run_throughput_thread(log_channel& c)
+{
+  for (unsigned i = 0; i != num_throughput_entries; ++i) {
+    double d = i;
+    c("SRSLOG throughput benchmark: int: %u, double: %f, string: %s", i, d, "test");
+  }
+}
+
+/// This function measures the rate at which the backend writes log entries into a sink using the specified formatter.
+/// The producer threads generate entries faster than the backend can process them, so that the backend is always busy
+/// and the entries that do not fit in the queue are discarded.
+static void benchmark_backend_throughput(const std::string& name, std::unique_ptr<log_formatter> f, unsigned num_threads)
+{
+  std::string sink_id = fmt::format("srslog_throughput_benchmark_{}_{}.log", name, num_threads);
+  srslog::install_custom_sink(sink_id, std::unique_ptr<sink>(new counting_file_sink(sink_id, std::move(f))));
+  auto& s       = static_cast<counting_file_sink&>(*srslog::find_sink(sink_id));
+  auto& channel = srslog::fetch_log_channel(sink_id, s, {});
+
+  srslog::init();
+
+  auto                     begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads);
+  for (unsigned i = 0; i != num_threads; ++i) {
+    workers.emplace_back(run_throughput_thread, std::ref(channel));
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  srslog::flush();
+  auto end = std::chrono::steady_clock::now();
+
+  double   elapsed_s       = std::chrono::duration_cast<std::chrono::duration<double> >(end - begin).count();
+  uint64_t num_generated   = uint64_t(num_threads) * num_throughput_entries;
+  uint64_t num_written     = s.nof_entries;
+  double   dropped_percent = 100.0 * (num_generated - num_written) / num_generated;
+
+  fmt::print("{:<8}|{:8}|{:11.0f}|{:9.1f}|{:13.1f}|\n",
+             name,
+             num_threads,
+             num_written / elapsed_s,
+             dropped_percent,
+             num_written ? double(s.nof_bytes) / num_written : 0.0);
 }
 
 int main()
 {
-  for (auto n : {1, 2, 4}) {
+  for (auto n : {1, 2, 4, 8, 16}) {
     benchmark(n);
   }
 
+  fmt::print("SRSLOG Backend Throughput Benchmark - {} entries generated per thread\n"
+             "Format  | Threads| Entries/s | Dropped%| Bytes/entry |\n",
+             num_throughput_entries);
+  for (auto n : {1, 4, 8}) {
+    benchmark_backend_throughput("text", srslog::create_text_formatter(), n);
+    benchmark_backend_throughput("binary", srslog::create_binary_formatter(), n);
+  }
+
   return 0;
 }
@@ -0,0 +1,298 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "src/srslog/formatters/binary_formatter.h"
+#include "srsran/srslog/context.h"
+#include "testing_helpers.h"
+#include <cstring>
+#include <numeric>
+
+using namespace srslog;
+
+using arg_store_t = fmt::dynamic_format_arg_store<fmt::printf_context>;
+
+/// Helper to build a log entry.
+static detail::log_entry_metadata build_log_entry_metadata(arg_store_t* store)
+{
+  // Create a time point 50000us from epoch.
+  using tp_ty = std::chrono::time_point<std::chrono::high_resolution_clock>;
+  tp_ty tp(std::chrono::microseconds(50000));
+
+  if (store) {
+    store->push_back(88);
+  }
+
+  return {tp, {10, true}, "Text %d", store, "ABC", 'Z'};
+}
+
+/// Decodes the input binary stream.
+static std::string decode(const fmt::memory_buffer& stream, binary_log_decoder& decoder)
+{
+  fmt::memory_buffer text;
+  size_t             consumed = decoder.decode(reinterpret_cast<const uint8_t*>(stream.data()), stream.size(), text);
+  if (consumed != stream.size()) {
+    return "";
+  }
+  return fmt::to_string(text);
+}
+
+static bool when_fully_filled_log_entry_then_decoded_text_matches_text_formatter()
+{
+  arg_store_t store;
+  auto        entry = build_log_entry_metadata(&store);
+  entry.hex_dump.resize(20);
+  std::iota(entry.hex_dump.begin(), entry.hex_dump.end(), 0);
+
+  fmt::memory_buffer stream;
+  binary_formatter{}.format(std::move(entry), stream);
+
+  binary_log_decoder decoder;
+  std::string        result   = decode(stream, decoder);
+  std::string        expected = "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] Text 88\n"
+                                "    0000: 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f\n"
+                                "    0010: 10 11 12 13\n";
+
+  ASSERT_EQ(result, expected);
+  ASSERT_EQ(decoder.get_nof_decoded_entries(), 1);
+
+  return true;
+}
+
+static bool when_entry_has_arguments_of_all_types_then_they_are_decoded()
+{
+  int         x = 0;
+  std::string s = "std::string";
+
+  arg_store_t store;
+  store.push_back(-1);
+  store.push_back(2u);
+  store.push_back(-3LL);
+  store.push_back(4ULL);
+  store.push_back(true);
+  store.push_back('c');
+  store.push_back(5.5f);
+  store.push_back(6.25);
+  store.push_back(7.125L);
+  store.push_back("cstring");
+  store.push_back(s);
+  store.push_back(static_cast<const void*>(&x));
+
+  auto entry      = build_log_entry_metadata(nullptr);
+  entry.fmtstring = "%d %u %lld %llu %s %c %.1f %f %.3Lf %s %s %p";
+  entry.store     = &store;
+
+  fmt::memory_buffer expected;
+  text_formatter{}.format(detail::log_entry_metadata(entry), expected);
+
+  fmt::memory_buffer stream;
+  binary_formatter{}.format(std::move(entry), stream);
+
+  binary_log_decoder decoder;
+  ASSERT_EQ(decode(stream, decoder), fmt::to_string(expected));
+
+  return true;
+}
+
+static bool when_optional_fields_are_missing_then_they_are_not_decoded()
+{
+  arg_store_t store;
+  auto        entry     = build_log_entry_metadata(&store);
+  entry.log_name        = "";
+  entry.log_tag         = '\0';
+  entry.context.enabled = false;
+
+  auto no_args      = build_log_entry_metadata(nullptr);
+  no_args.fmtstring = "Text without args";
+
+  fmt::memory_buffer stream;
+  binary_formatter   formatter;
+  formatter.format(std::move(entry), stream);
+  formatter.format(std::move(no_args), stream);
+
+  binary_log_decoder decoder;
+  std::string        result   = decode(stream, decoder);
+  std::string        expected = "1970-01-01T00:00:00.050000 Text 88\n"
+                                "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] Text without args\n";
+
+  ASSERT_EQ(result, expected);
+
+  return true;
+}
+
+static bool when_format_string_is_repeated_then_it_is_only_defined_once()
+{
+  binary_formatter   formatter;
+  fmt::memory_buffer first, second;
+
+  arg_store_t store1;
+  formatter.format(build_log_entry_metadata(&store1), first);
+  arg_store_t store2;
+  formatter.format(build_log_entry_metadata(&store2), second);
+
+  // The second entry carries no header nor string definitions.
+  ASSERT_EQ(second.size() < first.size(), true);
+  ASSERT_EQ(static_cast<uint8_t>(second[0]), static_cast<uint8_t>(binary_log::record_type::entry));
+
+  fmt::memory_buffer stream;
+  stream.append(first.data(), first.data() + first.size());
+  stream.append(second.data(), second.data() + second.size());
+
+  binary_log_decoder decoder;
+  std::string        line = "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] Text 88\n";
+  ASSERT_EQ(decode(stream, decoder), line + line);
+
+  return true;
+}
+
+static bool when_format_string_address_is_reused_then_string_is_redefined()
+{
+  binary_formatter   formatter;
+  fmt::memory_buffer stream;
+  char               fmtstring[16] = "First %d";
+
+  arg_store_t store1;
+  auto        entry1 = build_log_entry_metadata(&store1);
+  entry1.fmtstring   = fmtstring;
+  formatter.format(std::move(entry1), stream);
+
+  std::strcpy(fmtstring, "Second %d");
+  arg_store_t store2;
+  auto        entry2 = build_log_entry_metadata(&store2);
+  entry2.fmtstring   = fmtstring;
+  formatter.format(std::move(entry2), stream);
+
+  binary_log_decoder decoder;
+  std::string        result   = decode(stream, decoder);
+  std::string        expected = "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] First 88\n"
+                                "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] Second 88\n";
+
+  ASSERT_EQ(result, expected);
+
+  return true;
+}
+
+namespace {
+DECLARE_METRIC("SNR", snr_t, float, "dB");
+DECLARE_METRIC_SET("RF", rf_set, snr_t);
+using ctx_t = srslog::build_context_type<rf_set>;
+} // namespace
+
+static bool when_log_entry_with_context_is_passed_then_context_is_decoded()
+{
+  ctx_t ctx("Context");
+  ctx.get<rf_set>().write<snr_t>(5.1);
+
+  arg_store_t        store;
+  fmt::memory_buffer expected;
+  text_formatter{}.format_ctx(ctx, build_log_entry_metadata(&store), expected);
+
+  arg_store_t        store2;
+  fmt::memory_buffer stream;
+  binary_formatter{}.format_ctx(ctx, build_log_entry_metadata(&store2), stream);
+
+  binary_log_decoder decoder;
+  ASSERT_EQ(decode(stream, decoder), fmt::to_string(expected));
+  ASSERT_EQ(decoder.get_nof_decoded_entries(), 1);
+
+  return true;
+}
+
+static bool when_stream_is_decoded_in_chunks_then_partial_records_are_not_consumed()
+{
+  binary_formatter   formatter;
+  fmt::memory_buffer stream;
+  for (unsigned i = 0; i != 3; ++i) {
+    arg_store_t store;
+    formatter.format(build_log_entry_metadata(&store), stream);
+  }
+
+  // Feed the stream one byte at a time, keeping the unconsumed bytes as done with file chunks.
+  binary_log_decoder   decoder;
+  fmt::memory_buffer   text;
+  std::vector<uint8_t> pending;
+  for (size_t i = 0; i != stream.size(); ++i) {
+    pending.push_back(stream[i]);
+    size_t consumed = decoder.decode(pending.data(), pending.size(), text);
+    pending.erase(pending.begin(), pending.begin() + consumed);
+  }
+
+  std::string line = "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] Text 88\n";
+  ASSERT_EQ(pending.empty(), true);
+  ASSERT_EQ(fmt::to_string(text), line + line + line);
+  ASSERT_EQ(decoder.has_error(), false);
+
+  return true;
+}
+
+static bool when_stream_has_invalid_header_then_error_is_reported()
+{
+  std::string        text_log = "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] Text 88\n";
+  binary_log_decoder decoder;
+  fmt::memory_buffer text;
+
+  ASSERT_EQ(decoder.decode(reinterpret_cast<const uint8_t*>(text_log.data()), text_log.size(), text), 0);
+  ASSERT_EQ(decoder.has_error(), true);
+  ASSERT_EQ(text.size(), 0);
+
+  return true;
+}
+
+static bool when_entry_is_truncated_before_argument_type_then_error_is_reported()
+{
+  arg_store_t        store;
+  fmt::memory_buffer stream;
+  binary_formatter{}.format(build_log_entry_metadata(&store), stream);
+
+  // Find the entry record, which follows the string definitions, and cut its payload right after the number of args.
+  size_t offset = binary_log::header_size;
+  while (static_cast<binary_log::record_type>(stream[offset]) != binary_log::record_type::entry) {
+    uint32_t payload_size;
+    std::memcpy(&payload_size, stream.data() + offset + 1, sizeof(payload_size));
+    offset += binary_log::record_hdr_size + payload_size;
+  }
+  uint32_t truncated_size = sizeof(int64_t) + 3 * sizeof(uint32_t) + sizeof(char) + 2 * sizeof(uint8_t);
+  std::memcpy(stream.data() + offset + 1, &truncated_size, sizeof(truncated_size));
+  stream.resize(offset + binary_log::record_hdr_size + truncated_size);
+
+  binary_log_decoder decoder;
+  fmt::memory_buffer text;
+  decoder.decode(reinterpret_cast<const uint8_t*>(stream.data()), stream.size(), text);
+  ASSERT_EQ(decoder.has_error(), true);
+  ASSERT_EQ(decoder.get_error(), std::string("Truncated log entry"));
+  ASSERT_EQ(decoder.get_nof_decoded_entries(), 0);
+
+  return true;
+}
+
+int main()
+{
+  TEST_FUNCTION(when_fully_filled_log_entry_then_decoded_text_matches_text_formatter);
+  TEST_FUNCTION(when_entry_has_arguments_of_all_types_then_they_are_decoded);
+  TEST_FUNCTION(when_optional_fields_are_missing_then_they_are_not_decoded);
+  TEST_FUNCTION(when_format_string_is_repeated_then_it_is_only_defined_once);
+  TEST_FUNCTION(when_format_string_address_is_reused_then_string_is_redefined);
+  TEST_FUNCTION(when_log_entry_with_context_is_passed_then_context_is_decoded);
+  TEST_FUNCTION(when_stream_is_decoded_in_chunks_then_partial_records_are_not_consumed);
+  TEST_FUNCTION(when_stream_has_invalid_header_then_error_is_reported);
+  TEST_FUNCTION(when_entry_is_truncated_before_argument_type_then_error_is_reported);
+
+  return 0;
+}
@@ -64,14 +64,21 @@ public:
     return {};
   }
 
-  detail::error_string flush() override { return {}; }
+  detail::error_string flush() override
+  {
+    ++flush_count;
+    return {};
+  }
 
   unsigned write_invocation_count() const { return count; }
 
+  unsigned flush_invocation_count() const { return flush_count; }
+
   const std::string& received_buffer() const { return str; }
 
 private:
-  unsigned    count = 0;
+  unsigned    count       = 0;
+  unsigned    flush_count = 0;
   std::string str;
 };
 
@@ -233,6 +240,123 @@ static bool when_empty_handler_is_used_then_backend_does_not_crash()
   return true;
 }
 
+static bool when_queue_is_full_then_new_entries_are_dropped_and_counted()
+{
+  sink_spy         spy;
+  log_backend_impl backend;
+  // We want to remove output to stderr by the default handler.
+  backend.set_error_handler([](const std::string&) {});
+
+  // Entries stay in the queue while the backend is not running.
+  for (unsigned i = 0; i != SRSLOG_QUEUE_CAPACITY; ++i) {
+    ASSERT_EQ(backend.push(build_log_entry(&spy, nullptr)), true);
+  }
+  ASSERT_EQ(backend.get_nof_dropped_entries(), 0);
+
+  ASSERT_EQ(backend.push(build_log_entry(&spy, backend.alloc_arg_store())), false);
+  ASSERT_EQ(backend.get_nof_dropped_entries(), 1);
+
+  backend.start();
+  backend.stop();
+
+  ASSERT_EQ(spy.write_invocation_count(), SRSLOG_QUEUE_CAPACITY);
+
+  return true;
+}
+
+static bool when_block_policy_is_used_then_no_entries_are_dropped()
+{
+  sink_spy         spy;
+  log_backend_impl backend;
+  backend.set_error_handler([](const std::string&) {});
+  backend.set_overflow_policy(backend_overflow_policy::block);
+  backend.start();
+
+  const unsigned nof_entries = 4 * SRSLOG_QUEUE_CAPACITY;
+  for (unsigned i = 0; i != nof_entries; ++i) {
+    ASSERT_EQ(backend.push(build_log_entry(&spy, backend.alloc_arg_store())), true);
+  }
+
+  // Stop the backend to ensure the entries have been processed.
+  backend.stop();
+
+  ASSERT_EQ(backend.get_nof_dropped_entries(), 0);
+  ASSERT_EQ(spy.write_invocation_count(), nof_entries);
+
+  return true;
+}
+
+static bool when_several_workers_are_used_then_entries_and_flushes_reach_all_sinks()
+{
+  std::vector<sink_spy> spies(8);
+  log_backend_impl      backend;
+  backend.set_nof_workers(4);
+  ASSERT_EQ(backend.get_nof_workers(), 4);
+  backend.start();
+
+  const unsigned nof_entries = 100;
+  for (unsigned i = 0; i != nof_entries; ++i) {
+    for (auto& spy : spies) {
+      backend.push(build_log_entry(&spy, backend.alloc_arg_store()));
+    }
+  }
+
+  // The flush command is split among the workers, completion is signaled once all of them are done.
+  detail::shared_variable<bool> completion_flag(false);
+  std::vector<sink*>            sinks;
+  for (auto& spy : spies) {
+    sinks.push_back(&spy);
+  }
+  detail::log_entry cmd;
+  cmd.metadata.store = nullptr;
+  cmd.flush_cmd =
+      std::unique_ptr<detail::flush_backend_cmd>(new detail::flush_backend_cmd{completion_flag, std::move(sinks)});
+  ASSERT_EQ(backend.push(std::move(cmd)), true);
+  while (!completion_flag) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  for (const auto& spy : spies) {
+    ASSERT_EQ(spy.write_invocation_count(), nof_entries);
+    ASSERT_EQ(spy.flush_invocation_count(), 1);
+  }
+
+  backend.stop();
+
+  return true;
+}
+
+static bool when_workers_are_added_then_queue_capacity_is_split_and_pending_entries_are_kept()
+{
+  std::vector<sink_spy> spies(4);
+  log_backend_impl      backend;
+  backend.set_error_handler([](const std::string&) {});
+
+  for (auto& spy : spies) {
+    ASSERT_EQ(backend.push(build_log_entry(&spy, backend.alloc_arg_store())), true);
+  }
+  backend.set_nof_workers(4);
+
+  // Each worker queue gets a share of the capacity, which is filled by the entries of a single sink.
+  const unsigned worker_capacity = SRSLOG_QUEUE_CAPACITY / 4;
+  unsigned       nof_pushed      = 1;
+  while (backend.push(build_log_entry(&spies[0], nullptr))) {
+    ++nof_pushed;
+  }
+  ASSERT_EQ(nof_pushed, worker_capacity);
+  ASSERT_EQ(backend.get_nof_dropped_entries(), 1);
+
+  backend.start();
+  backend.stop();
+
+  ASSERT_EQ(spies[0].write_invocation_count(), worker_capacity);
+  for (unsigned i = 1, e = spies.size(); i != e; ++i) {
+    ASSERT_EQ(spies[i].write_invocation_count(), 1);
+  }
+
+  return true;
+}
+
 int main()
 {
   TEST_FUNCTION(when_backend_is_started_then_is_started_returns_true);
@@ -243,6 +367,10 @@ int main()
   TEST_FUNCTION(when_sink_write_fails_then_error_handler_is_invoked);
   TEST_FUNCTION(when_handler_is_set_after_start_then_handler_is_not_used);
   TEST_FUNCTION(when_empty_handler_is_used_then_backend_does_not_crash);
+  TEST_FUNCTION(when_queue_is_full_then_new_entries_are_dropped_and_counted);
+  TEST_FUNCTION(when_block_policy_is_used_then_no_entries_are_dropped);
+  TEST_FUNCTION(when_several_workers_are_used_then_entries_and_flushes_reach_all_sinks);
+  TEST_FUNCTION(when_workers_are_added_then_queue_capacity_is_split_and_pending_entries_are_kept);
 
   return 0;
 }
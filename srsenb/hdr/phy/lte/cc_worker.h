@@ -22,6 +22,7 @@
 #ifndef SRSENB_CC_WORKER_H
 #define SRSENB_CC_WORKER_H
 
+#include <atomic>
 #include <string.h>
 
 #include "../phy_common.h"
@@ -62,16 +63,36 @@ public:
                srsran_mbsfn_cfg_t*                  mbsfn_cfg);
 
   uint32_t get_metrics(std::vector<phy_metrics_t>& metrics);
+  void     get_timing_metrics(phy_timing_metrics_t& metrics);
 
 private:
   constexpr static float PUSCH_RL_SNR_DB_TH = 1.0f;
   constexpr static float PUCCH_RL_CORR_TH   = 0.15f;
 
+  // PUSCH of a grant, prepared and reported to MAC in grant order and decoded by any of the PUSCH lanes
+  struct pusch_job_t {
+    stack_interface_phy_lte::ul_sched_grant_t* ul_grant     = nullptr;
+    srsran_ul_cfg_t                            ul_cfg       = {};
+    srsran_pusch_res_t                         pusch_res    = {};
+    srsran_chest_ul_res_t                      chest_res    = {};
+    bool                                       uci_required = false;
+    bool                                       decoded      = false;
+  };
+
+  // PDSCH of a grant, prepared and reported in grant order and encoded by any of the PDSCH lanes
+  struct pdsch_job_t {
+    uint32_t                                   grant_idx = 0;
+    stack_interface_phy_lte::dl_sched_grant_t* grant     = nullptr;
+    srsran_dl_cfg_t                            dl_cfg    = {};
+    bool                                       encoded   = false;
+  };
+
   int  encode_pdsch(stack_interface_phy_lte::dl_sched_grant_t* grants, uint32_t nof_grants);
+  void encode_pdsch_lane(uint32_t lane_idx);
   int  encode_pmch(stack_interface_phy_lte::dl_sched_grant_t* grant, srsran_mbsfn_cfg_t* mbsfn_cfg);
-  bool decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant,
-                         srsran_ul_cfg_t&                           ul_cfg,
-                         srsran_pusch_res_t&                        pusch_res);
+  bool prepare_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant, pusch_job_t& job);
+  void decode_pusch_lane(uint32_t lane_idx);
+  bool report_pusch_rnti(pusch_job_t& job);
   void decode_pusch(stack_interface_phy_lte::ul_sched_grant_t* grants, uint32_t nof_pusch);
   int  encode_phich(stack_interface_phy_lte::ul_sched_ack_t* acks, uint32_t nof_acks);
   int  encode_pdcch_dl(stack_interface_phy_lte::dl_sched_grant_t* grants, uint32_t nof_grants);
@@ -95,6 +116,18 @@ private:
 
   srsran_softbuffer_tx_t temp_mbsfn_softbuffer = {};
 
+  // Lane 0 uses the PUSCH decoder and PDSCH encoder of enb_ul and enb_dl, the rest are only created when the PHY
+  // task threads are enabled
+  std::vector<std::unique_ptr<srsran_enb_ul_pusch_lane_t> > pusch_lanes;
+  std::vector<std::unique_ptr<srsran_pdsch_t> >             pdsch_lanes;
+  std::vector<pusch_job_t>                                  pusch_jobs;
+  std::vector<pdsch_job_t>                                  pdsch_jobs;
+  std::atomic<uint32_t>                                     next_pusch_job = {0};
+  std::atomic<uint32_t>                                     next_pdsch_job = {0};
+
+  // Processing time of the carrier stages, protected by the worker mutex
+  phy_timing_metrics_t timing = {};
+
   // Class to store user information
   class ue
   {
@@ -57,6 +57,7 @@ public:
   void     start_plot();
 
   uint32_t get_metrics(std::vector<phy_metrics_t>& metrics);
+  void     get_timing_metrics(phy_timing_metrics_t& metrics);
 
 private:
   void work_imp() final;
@@ -73,6 +74,10 @@ private:
   srsran::phy_common_interface::worker_context_t context = {};
 
   srsran_softbuffer_tx_t temp_mbsfn_softbuffer = {};
+
+  // Subframe processing time, from the start of the UL processing until the DL signal is ready
+  std::mutex          timing_mutex;
+  phy_stage_metrics_t total_time = {};
 };
 
 } // namespace lte
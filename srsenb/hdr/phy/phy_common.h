@@ -33,6 +33,7 @@
 #include "srsran/interfaces/phy_common_interface.h"
 #include "srsran/interfaces/radio_interfaces.h"
 #include "srsran/phy/channel/channel.h"
+#include "srsran/phy/phch/sch_decoder_pool.h"
 #include "srsran/radio/radio.h"
 
 #include <map>
@@ -45,6 +46,7 @@ class phy_common : public srsran::phy_common_interface
 {
 public:
   phy_common() = default;
+  ~phy_common();
 
   bool init(const phy_cell_cfg_list_t&    cell_list_,
             const phy_cell_cfg_list_nr_t& cell_list_nr_,
@@ -71,6 +73,24 @@ public:
   // Common objects
   phy_args_t params = {};
 
+  // Threads shared by all the workers for decoding the PUSCH code blocks in parallel, if enabled
+  srsran_sch_decoder_pool_t pusch_decoder_pool = {};
+
+  /**
+   * Runs func(idx) for every idx in [0, nof_items) and returns once all of them have completed. The calls are spread
+   * over the PHY task threads when enabled, otherwise they are run in order by the calling worker.
+   *
+   * @param nof_items Number of calls
+   * @param func Function to call, it may be called concurrently from several threads
+   */
+  void parallel_for(uint32_t nof_items, const std::function<void(uint32_t)>& func);
+
+  /**
+   * Number of concurrent PUSCH decoders or PDSCH encoders worth having per carrier, that is the PHY task threads plus
+   * the calling worker
+   */
+  uint32_t get_nof_task_lanes() const { return (task_pool != nullptr) ? params.nof_phy_task_threads + 1 : 1; }
+
   uint32_t get_nof_carriers_lte() { return static_cast<uint32_t>(cell_list_lte.size()); }
   uint32_t get_nof_carriers_nr() { return static_cast<uint32_t>(cell_list_nr.size()); }
   uint32_t get_nof_carriers() { return static_cast<uint32_t>(cell_list_lte.size() + cell_list_nr.size()); }
@@ -249,6 +269,9 @@ private:
   phy_cell_cfg_list_nr_t cell_list_nr;
   std::mutex             cell_gain_mutex;
 
+  // Threads shared by all the workers for processing the carriers and users of a subframe in parallel, if enabled
+  std::unique_ptr<srsran::task_thread_pool> task_pool;
+
   bool                    have_mtch_stop   = false;
   pthread_mutex_t         mtch_mutex       = {};
   pthread_cond_t          mtch_cvar        = {};
@@ -22,6 +22,8 @@
 #ifndef SRSENB_PHY_METRICS_H
 #define SRSENB_PHY_METRICS_H
 
+#include <stdint.h>
+
 namespace srsenb {
 
 // PHY metrics per user
@@ -47,6 +49,55 @@ struct phy_metrics_t {
   ul_metrics_t ul;
 };
 
+// Processing time of a PHY subframe processing stage
+
+struct phy_stage_metrics_t {
+  float    avg_us;
+  float    max_us;
+  uint32_t n_samples;
+
+  void add(float time_us)
+  {
+    avg_us = (avg_us * n_samples + time_us) / (n_samples + 1);
+    max_us = (time_us > max_us) ? time_us : max_us;
+    n_samples++;
+  }
+
+  void merge(const phy_stage_metrics_t& other)
+  {
+    if (other.n_samples == 0) {
+      return;
+    }
+    avg_us = (avg_us * n_samples + other.avg_us * other.n_samples) / (n_samples + other.n_samples);
+    max_us = (other.max_us > max_us) ? other.max_us : max_us;
+    n_samples += other.n_samples;
+  }
+};
+
+// LTE PHY subframe processing time. The carrier stages are sampled once per carrier and subframe, the total once per
+// subframe from the start of the UL processing until the DL signal is handed for transmission
+
+struct phy_timing_metrics_t {
+  phy_stage_metrics_t ul_fft;
+  phy_stage_metrics_t pusch;
+  phy_stage_metrics_t pucch;
+  phy_stage_metrics_t dl_ctrl;
+  phy_stage_metrics_t pdsch;
+  phy_stage_metrics_t dl_ifft;
+  phy_stage_metrics_t total;
+
+  void merge(const phy_timing_metrics_t& other)
+  {
+    ul_fft.merge(other.ul_fft);
+    pusch.merge(other.pusch);
+    pucch.merge(other.pucch);
+    dl_ctrl.merge(other.dl_ctrl);
+    pdsch.merge(other.pdsch);
+    dl_ifft.merge(other.dl_ifft);
+    total.merge(other.total);
+  }
+};
+
 } // namespace srsenb
 
 #endif // SRSENB_PHY_METRICS_H
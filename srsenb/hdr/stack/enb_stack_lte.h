@@ -33,6 +33,7 @@
 #include "srsran/common/task_scheduler.h"
 #include "upper/gtpu.h"
 #include "upper/pdcp.h"
+#include "upper/pdcp_workers.h"
 #include "upper/rlc.h"
 
 #include "enb_stack_base.h"
@@ -185,6 +186,8 @@ private:
   srsenb::rlc  rlc;
   srsenb::pdcp pdcp;
   srsenb::rrc  rrc;
+
+  std::unique_ptr<pdcp_workers> pdcp_pool; ///< Replaces pdcp when the UEs are sharded across user-plane workers
   srsenb::gtpu gtpu;
   srsenb::s1ap s1ap;
 
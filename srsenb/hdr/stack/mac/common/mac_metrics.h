@@ -63,12 +63,28 @@ struct mac_cc_info_t {
   uint32_t cc_rach_counter;
 };
 
+/// Memory usage of the HARQ soft-buffer pool.
+struct mac_softbuffer_metrics_t {
+  /// Memory allocated by the pool, in bytes.
+  uint64_t allocated_bytes;
+  /// Memory attached to UL HARQ processes, in bytes.
+  uint64_t rx_used_bytes;
+  /// Memory attached to DL HARQ processes, in bytes.
+  uint64_t tx_used_bytes;
+  /// Maximum memory attached to HARQ processes since the previous metrics report, in bytes.
+  uint64_t peak_used_bytes;
+  /// Number of grants whose code blocks could not be attached because the memory limit was reached.
+  uint32_t nof_alloc_failures;
+};
+
 /// Main MAC metrics.
 struct mac_metrics_t {
   /// Per CC info.
   std::vector<mac_cc_info_t> cc_info;
   /// Per UE MAC metrics.
   std::vector<mac_ue_metrics_t> ues;
+  /// HARQ soft-buffer memory usage.
+  mac_softbuffer_metrics_t softbuffers;
 };
 
 } // namespace srsenb
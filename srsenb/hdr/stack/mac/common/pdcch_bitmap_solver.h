@@ -0,0 +1,119 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_PDCCH_BITMAP_SOLVER_H
+#define SRSRAN_PDCCH_BITMAP_SOLVER_H
+
+#include "srsran/adt/bounded_vector.h"
+#include <array>
+#include <cstdint>
+
+namespace srsenb {
+
+/**
+ * Places DCIs in a PDCCH/CORESET CCE grid, given the list of candidate CCE positions of each DCI.
+ * The CCE occupancy is kept in fixed-size word bitmaps, so that a collision check is a couple of word operations.
+ * When a new DCI does not fit in the CCEs left free by the current solution, the positions of all DCIs are searched
+ * again, most constrained DCI first, within a budget of visited candidates per search and a total budget shared by all
+ * the searches until the next clear(). The worst-case allocation time of a subframe is thus bounded, at the cost of
+ * possibly missing a solution that the exhaustive search would find.
+ */
+class pdcch_bitmap_solver
+{
+public:
+  static const uint32_t MAX_NOF_CCES                = 192; ///< NR CORESETs may span up to 45x3 CCEs
+  static const uint32_t MAX_NOF_UCI_RES             = 128; ///< e.g. LTE PUCCH PRBs
+  static const uint32_t MAX_NOF_CANDIDATES          = 8;
+  static const uint32_t MAX_NOF_DCIS                = 64;
+  static const uint32_t DEFAULT_SEARCH_BUDGET       = 128;
+  static const uint32_t DEFAULT_TOTAL_SEARCH_BUDGET = 1024;
+
+  struct candidate_t {
+    uint32_t ncce    = 0;
+    int32_t  uci_res = -1; ///< UL control resource that cannot be shared with other DCIs, or -1 if none
+  };
+  using candidate_list = srsran::bounded_vector<candidate_t, MAX_NOF_CANDIDATES>;
+
+  explicit pdcch_bitmap_solver(uint32_t search_budget_       = DEFAULT_SEARCH_BUDGET,
+                               uint32_t total_search_budget_ = DEFAULT_TOTAL_SEARCH_BUDGET) :
+    search_budget(search_budget_), total_search_budget(total_search_budget_)
+  {
+    clear();
+  }
+
+  /// Removes all DCIs and resets the total search budget
+  void clear();
+
+  /**
+   * Adds a DCI to the current solution. A first fit in the CCEs left free by the other DCIs is tried first. If it
+   * fails, the positions of all DCIs are searched again within the search budget
+   * @param aggr_idx Aggregation level index (0..4)
+   * @param cands list of candidate CCE positions of the DCI
+   * @return true if a solution was found. Otherwise, the previous solution is kept
+   */
+  bool push(uint32_t aggr_idx, const candidate_list& cands);
+
+  /// Adds a DCI without placing it. solve() has to be called before the solution is accessed
+  bool push_unsolved(uint32_t aggr_idx, const candidate_list& cands);
+
+  /// Searches the positions of all DCIs within the search budget. Keeps the previous solution in case of failure
+  bool solve();
+
+  /// Replaces the candidate positions of a DCI (e.g. due to a CFI change). solve() has to be called afterwards
+  void set_candidates(size_t dci_idx, const candidate_list& cands);
+
+  /// Removes the last added DCI
+  void pop();
+
+  size_t             size() const { return dcis.size(); }
+  bool               empty() const { return dcis.empty(); }
+  const candidate_t& get_position(size_t dci_idx) const { return dcis[dci_idx].cands[dcis[dci_idx].pos_idx]; }
+  uint32_t           get_position_idx(size_t dci_idx) const { return dcis[dci_idx].pos_idx; }
+  /// Number of candidates visited in the last search
+  uint32_t nof_visited() const { return last_nof_visited; }
+  uint32_t remaining_search_budget() const { return remaining_budget; }
+
+private:
+  /// Value-initialize (i.e. bitmap_t{}) to get an empty bitmap
+  struct bitmap_t {
+    std::array<uint64_t, MAX_NOF_CCES / 64>    cces;
+    std::array<uint64_t, MAX_NOF_UCI_RES / 64> uci;
+
+    bool collides(const candidate_t& cand, uint32_t L) const;
+    void set(const candidate_t& cand, uint32_t L);
+  };
+  struct dci_entry {
+    uint32_t       L;
+    uint32_t       pos_idx;
+    candidate_list cands;
+  };
+
+  uint32_t                                           search_budget;
+  uint32_t                                           total_search_budget;
+  uint32_t                                           remaining_budget = 0;
+  uint32_t                                           last_nof_visited = 0;
+  srsran::bounded_vector<dci_entry, MAX_NOF_DCIS>    dcis;
+  srsran::bounded_vector<bitmap_t, MAX_NOF_DCIS + 1> prefix_bitmaps; ///< occupancy of DCIs [0, i) at position i
+};
+
+} // namespace srsenb
+
+#endif // SRSRAN_PDCCH_BITMAP_SOLVER_H
@@ -190,6 +190,9 @@ private:
   // Number of rach preambles detected for a cc.
   std::vector<uint32_t> detected_rachs;
 
+  // Code blocks shared by the softbuffers of all UEs. Must outlive the softbuffer pool
+  std::unique_ptr<softbuffer_cb_pool> softbuffer_cbs;
+
   // Softbuffer pool
   std::unique_ptr<srsran::obj_pool_itf<ue_cc_softbuffers> > softbuffer_pool;
 };
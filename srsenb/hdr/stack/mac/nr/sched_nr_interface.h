@@ -96,6 +96,7 @@ public:
     int         fixed_dl_mcs       = 28;
     int         fixed_ul_mcs       = 28;
     std::string logger_name        = "MAC-NR";
+    std::string pdcch_alloc_algo   = "dfs"; ///< PDCCH CCE allocation algorithm (dfs, bitmap)
   };
 
   using ue_cc_cfg_t = sched_nr_ue_cc_cfg_t;
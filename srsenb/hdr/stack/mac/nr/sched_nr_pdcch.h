@@ -22,6 +22,7 @@
 #ifndef SRSRAN_SCHED_NR_PDCCH_H
 #define SRSRAN_SCHED_NR_PDCCH_H
 
+#include "srsenb/hdr/stack/mac/common/pdcch_bitmap_solver.h"
 #include "srsenb/hdr/stack/mac/nr/sched_nr_cfg.h"
 #include "srsran/adt/bounded_bitset.h"
 #include "srsran/adt/bounded_vector.h"
@@ -64,7 +65,7 @@ public:
   uint32_t get_td_symbols() const { return coreset_cfg->duration; }
   uint32_t get_freq_resources() const { return nof_freq_res; }
   uint32_t nof_cces() const { return nof_freq_res * get_td_symbols(); }
-  size_t   nof_allocs() const { return dfs_tree.size(); }
+  size_t   nof_allocs() const { return dci_list.size(); }
 
 private:
   const srsran_coreset_t* coreset_cfg;
@@ -72,6 +73,7 @@ private:
   uint32_t                slot_idx;
   uint32_t                nof_freq_res = 0;
   const bwp_cce_pos_list& rar_cce_list;
+  bool                    use_bitmap = false;
 
   // List of PDCCH grants
   struct alloc_record {
@@ -98,8 +100,13 @@ private:
   alloc_tree_dfs_t dfs_tree, saved_dfs_tree;
 
   srsran::span<const uint32_t> get_cce_loc_table(const alloc_record& record) const;
+  bool                         alloc_dfs(const alloc_record& record);
   bool                         alloc_dfs_node(const alloc_record& record, uint32_t dci_idx);
   bool                         get_next_dfs();
+
+  // Bitmap PDCCH allocation algorithm, used instead of the DFS if sched_args_t::pdcch_alloc_algo is "bitmap"
+  pdcch_bitmap_solver bitmap_solver;
+  bool                alloc_bitmap(const alloc_record& record);
 };
 
 } // namespace sched_nr_impl
@@ -27,10 +27,12 @@
 #include "sched_nr_grant_allocator.h"
 #include "sched_nr_ue.h"
 #include "srsran/adt/circular_array.h"
+#include "srsran/adt/lockfree_queue.h"
 #include "srsran/adt/optional.h"
 #include "srsran/adt/pool/cached_alloc.h"
 #include "srsran/adt/span.h"
-#include <condition_variable>
+#include <atomic>
+#include <limits>
 #include <mutex>
 
 namespace srsenb {
@@ -57,6 +59,7 @@ public:
 private:
   /// Run all pending feedback. This should be called at the beginning of a TTI
   void run_feedback(ue_map_t& ue_db);
+  void drain_feedback_rings();
 
   void alloc_dl_ues();
   void alloc_ul_ues();
@@ -69,29 +72,27 @@ private:
   slot_point         slot_rx;
   bwp_slot_allocator bwp_alloc;
 
-  // Process of UE cell-specific feedback
+  // Process of UE cell-specific feedback. Feedback is pushed by several threads (e.g. PHY workers) to lock-free
+  // rings. When a ring is full, the remaining items are kept in a mutex-protected overflow queue until the next slot
   struct feedback_t {
     uint16_t            rnti;
     feedback_callback_t fdbk;
   };
-  std::mutex                                    feedback_mutex;
-  srsran::deque<feedback_t>                     pending_feedback, tmp_feedback_to_run;
-  srsran::deque<srsran::move_callback<void()> > pending_events, tmp_events_to_run;
+  static const size_t FEEDBACK_QUEUE_SIZE = 512;
+  static const size_t EVENT_QUEUE_SIZE    = 64;
+
+  srsran::bounded_mpsc_queue<feedback_t>                     pending_feedback{FEEDBACK_QUEUE_SIZE};
+  srsran::bounded_mpsc_queue<srsran::move_callback<void()> > pending_events{EVENT_QUEUE_SIZE};
+  std::atomic<bool>                                          overflow_pending{false};
+  std::mutex                                                 overflow_mutex;
+  srsran::deque<feedback_t>                                  overflow_feedback, tmp_feedback_to_run;
+  srsran::deque<srsran::move_callback<void()> >              overflow_events, tmp_events_to_run;
 
   slot_ue_map_t slot_ues;
 };
 
 class sched_worker_manager
 {
-  struct slot_worker_ctxt {
-    std::mutex                  slot_mutex; // lock of all workers of the same slot.
-    std::condition_variable     cvar;
-    slot_point                  slot_rx;
-    int                         nof_workers_waiting = 0;
-    std::atomic<int>            worker_count{0}; // variable shared across slot_cc_workers
-    std::vector<slot_cc_worker> workers;
-  };
-
 public:
   explicit sched_worker_manager(ue_map_t&                                         ue_db_,
                                 const sched_params&                               cfg_,
@@ -112,6 +113,8 @@ public:
   }
 
 private:
+  void wait_slot_state_change(uint32_t old_state);
+  void notify_slot_state_change();
   void update_ue_db(slot_point slot_tx, bool locked_context);
   void get_metrics_nolocking(mac_metrics_t& metrics);
   bool save_sched_result(slot_point pdcch_slot, uint32_t cc, dl_sched_res_t& dl_res, ul_sched_t& ul_res);
@@ -128,20 +131,22 @@ private:
   std::mutex                event_mutex;
   srsran::deque<ue_event_t> next_slot_events, slot_events;
 
-  std::vector<std::unique_ptr<slot_worker_ctxt> > slot_worker_ctxts;
   struct cc_context {
-    std::condition_variable cvar;
-    int                     waiting = 0;
-    slot_cc_worker          worker;
+    slot_cc_worker worker;
 
     cc_context(serv_cell_manager& sched) : worker(sched) {}
   };
-
-  std::mutex                                slot_mutex;
-  std::condition_variable                   cvar;
-  slot_point                                current_slot;
-  std::atomic<int>                          worker_count{0}; // variable shared across slot_cc_workers
   std::vector<std::unique_ptr<cc_context> > cc_worker_list;
+
+  // Barrier between CC workers. slot_state is NO_SLOT, 2 * slot index while the first worker of the slot updates the
+  // UEs with CA, 2 * slot index + 1 while the CC workers of the slot run in parallel, or EXCLUSIVE_STATE while the UE
+  // metrics are read. Workers of a different slot spin, and then sleep on a futex until the state changes
+  static const uint32_t NO_SLOT         = std::numeric_limits<uint32_t>::max();
+  static const uint32_t EXCLUSIVE_STATE = NO_SLOT - 1;
+
+  std::atomic<uint32_t> slot_state{NO_SLOT};
+  std::atomic<int>      worker_count{0}; // number of CC workers of the current slot still running
+  std::atomic<int>      nof_sleepers{0};
 };
 
 } // namespace sched_nr_impl
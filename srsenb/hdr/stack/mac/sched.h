@@ -47,6 +47,7 @@ public:
   ~sched() override;
 
   void init(rrc_interface_mac* rrc, const sched_args_t& sched_cfg);
+  void stop();
   int  cell_cfg(const std::vector<cell_cfg_t>& cell_cfg) override;
   int  reset() final;
 
@@ -89,9 +90,16 @@ public:
 
   class carrier_sched;
 
+  /// Maximum number of TTIs the scheduling decisions can be computed ahead of the PHY
+  static const uint32_t MAX_LOOKAHEAD_TTI = 4;
+
 protected:
+  class lookahead_worker;
+
   void new_tti(srsran::tti_point tti_rx);
   bool is_generated(srsran::tti_point, uint32_t enb_cc_idx) const;
+  void run_lookahead(srsran::tti_point tti_rx);
+  void correct_ul_result(sched_ue& ue, srsran::tti_point tti_rx, uint32_t enb_cc_idx);
   // Helper methods
   template <typename Func>
   int ue_db_access_locked(uint16_t rnti, Func&& f, const char* func_name = nullptr, bool log_fail = true);
@@ -112,6 +120,10 @@ protected:
   srsran::tti_point last_tti;
   std::mutex        sched_mutex;
   bool              configured;
+
+  // Computation of the scheduling decisions ahead of the PHY
+  std::unique_ptr<lookahead_worker> lookahead;
+  srsran::tti_point                 phy_tti; ///< last tti_rx requested by the PHY. Its feedback is complete
 };
 
 } // namespace srsenb
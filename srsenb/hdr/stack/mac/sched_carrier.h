@@ -43,7 +43,7 @@ public:
   void                   reset();
   void                   carrier_cfg(const sched_cell_params_t& sched_params_);
   void                   set_dl_tti_mask(uint8_t* tti_mask, uint32_t nof_sfs);
-  const cc_sched_result& generate_tti_result(srsran::tti_point tti_rx);
+  const cc_sched_result& generate_tti_result(srsran::tti_point tti_rx, bool ul_feedback_pending = false);
   int                    dl_rach_info(dl_sched_rar_info_t rar_info);
 
   // getters
@@ -79,6 +79,8 @@ public:
     int         init_dl_cqi               = 5;
     float       max_sib_coderate          = 0.8;
     int         pdcch_cqi_offset          = 0;
+    uint32_t    lookahead_tti             = 0;     ///< TTIs the scheduler runs ahead of the PHY (0 = inline scheduling)
+    std::string pdcch_alloc_algo          = "dfs"; ///< PDCCH CCE allocation algorithm (dfs, bitmap)
   };
 
   struct cell_cfg_t {
@@ -19,6 +19,7 @@
  *
  */
 
+#include "../common/pdcch_bitmap_solver.h"
 #include "../sched_lte_common.h"
 #include "sched_result.h"
 
@@ -30,6 +31,8 @@ namespace srsenb {
 class sched_ue;
 
 /// Class responsible for managing a PDCCH CCE grid, namely CCE allocs, and avoid collisions.
+/// The DCI positions are found with an exhaustive DFS over the positions of past DCIs, or with the bounded
+/// pdcch_bitmap_solver if sched_args_t::pdcch_alloc_algo is "bitmap".
 class sf_cch_allocator
 {
 public:
@@ -80,13 +83,23 @@ private:
   const cce_cfi_position_table* get_cce_loc_table(alloc_type_t alloc_type, sched_ue* user, uint32_t cfix) const;
 
   // PDCCH allocation algorithm
+  bool alloc_dfs(const alloc_record& record);
   bool alloc_dfs_node(const alloc_record& record, uint32_t start_child_idx);
   bool get_next_dfs();
 
+  // Bitmap PDCCH allocation algorithm
+  bool alloc_bitmap(const alloc_record& record);
+  void get_bitmap_candidates(const alloc_record&                  record,
+                             uint32_t                             cfix,
+                             pdcch_bitmap_solver::candidate_list& cands) const;
+  void update_bitmap_dci_nodes();
+
   // consts
   const sched_cell_params_t* cc_cfg = nullptr;
   srslog::basic_logger&      logger;
   srsran_pucch_cfg_t         pucch_cfg_common = {};
+  bool                       use_bitmap       = false;
+  std::vector<int8_t>        cce_pucch_n_prb; ///< PUCCH PRB of the HARQ-ACK of a DL DCI starting at a given CCE
 
   // tti vars
   tti_point                 tti_rx;
@@ -94,6 +107,7 @@ private:
   uint32_t                  current_max_cfix = 0;
   std::vector<tree_node>    last_dci_dfs, temp_dci_dfs;
   std::vector<alloc_record> dci_record_list; ///< Keeps a record of all the PDCCH allocations done so far
+  pdcch_bitmap_solver       bitmap_solver;
 };
 
 // Helper methods
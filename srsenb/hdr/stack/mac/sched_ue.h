@@ -134,6 +134,7 @@ public:
                        srsran_dci_location_t             cce_range,
                        int                               explicit_mcs = -1,
                        uci_pusch_t                       uci_type     = UCI_PUSCH_NONE);
+  void revert_ul_ack(tti_point tti_rx, uint32_t enb_cc_idx, sched_interface::ul_sched_data_t* data);
 
   srsran_dci_format_t           get_dci_format();
   const cce_cfi_position_table* get_locations(uint32_t enb_cc_idx, uint32_t current_cfi, uint32_t sf_idx) const;
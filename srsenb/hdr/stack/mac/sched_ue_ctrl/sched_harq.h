@@ -131,7 +131,11 @@ class harq_entity
 public:
   static const bool is_async = ASYNC_DL_SCHED;
 
-  harq_entity(size_t nof_dl_harqs, size_t nof_ul_harqs);
+  /**
+   * @param feedback_delay_ number of TTIs the scheduling decisions run ahead of the HARQ feedback reception. DL
+   *                        retxs are only considered once the respective ACK/NACK is guaranteed to have been received
+   */
+  harq_entity(size_t nof_dl_harqs, size_t nof_ul_harqs, uint32_t feedback_delay_ = 0);
 
   void reset();
   void new_tti(tti_point tti_rx);
@@ -172,6 +176,17 @@ public:
    */
   int set_ul_crc(srsran::tti_point tti_tx_ul, uint32_t tb_idx, bool ack_);
 
+  /**
+   * Assume that the PUSCH received in tti_rx was decoded, when the scheduling decision has to be taken before its CRC
+   * is known. The HARQ state is kept, so that the assumption can be reverted if the CRC turns out to be KO
+   */
+  void assume_ul_ack(srsran::tti_point tti_rx);
+  /**
+   * Restore the UL HARQ state saved by assume_ul_ack(), after a KO CRC for tti_rx
+   * @return restored UL Harq, or nullptr if the ACK was not assumed or the TB reached its maximum number of retxs
+   */
+  ul_harq_proc* revert_ul_ack(srsran::tti_point tti_rx);
+
   //! Resets pending harq ACKs and cleans UL Harqs with maxretx == 0
   void finish_tti(srsran::tti_point tti_rx);
 
@@ -179,9 +194,17 @@ private:
   dl_harq_proc* get_oldest_dl_harq(tti_point tti_tx_dl);
 
   std::array<tti_point, SRSRAN_FDD_NOF_HARQ> last_ttis;
+  uint32_t                                   feedback_delay;
 
   std::vector<dl_harq_proc> dl_harqs;
   std::vector<ul_harq_proc> ul_harqs;
+
+  // UL HARQ states saved when their ACK was assumed ahead of the CRC
+  struct ul_harq_backup {
+    tti_point    tti_rx;
+    ul_harq_proc h;
+  };
+  std::vector<ul_harq_backup> ul_backups;
 };
 
 } // namespace srsenb
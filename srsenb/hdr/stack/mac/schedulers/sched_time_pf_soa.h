@@ -0,0 +1,148 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_SCHED_TIME_PF_SOA_H
+#define SRSRAN_SCHED_TIME_PF_SOA_H
+
+#include "sched_base.h"
+#include "srsenb/hdr/common/common_enb.h"
+#include <cmath>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * Proportional-fair metrics of the UEs of a carrier in one direction, stored as structure-of-arrays.
+ * The priority of a UE is r / R^fairness_coeff, where r is the expected rate and R the average allocated rate. Both
+ * terms are kept up-to-date incrementally: r is only set when the channel quality of the UE changes and 1/R^coeff
+ * when the UE average rate is updated. Each TTI, the priorities of the candidate UEs are computed in a single
+ * vectorized pass, and the candidates are popped in descending priority order with a SIMD arg-max, retransmissions
+ * first. Each pop is O(n), but only a few UEs fit in a subframe, and up to a few hundred candidates the arg-max scan
+ * is faster than keeping them in a heap.
+ */
+class pf_soa_metrics
+{
+public:
+  explicit pf_soa_metrics(float fairness_coeff_, float exp_avg_alpha_ = 0.01);
+
+  /// Adds a UE with empty rate history at index size()
+  void push_back();
+  /// Removes the UE at index idx. The last UE takes its place
+  void   swap_remove(uint32_t idx);
+  size_t size() const { return exp_rate.size(); }
+
+  void  set_expected_rate(uint32_t idx, float rate) { exp_rate[idx] = rate; }
+  void  save_alloc(uint32_t idx, uint32_t alloc_bytes);
+  float avg_rate(uint32_t idx) const { return nof_samples[idx] == 0 ? 0 : avg_rate_[idx]; }
+  float prio(uint32_t idx) const { return exp_rate[idx] * inv_avg_rate_pow[idx]; }
+
+  /// Candidate UEs of the current TTI
+  void clear_candidates();
+  void push_candidate(uint32_t idx, bool is_retx);
+  /// Computes the priorities of all pushed candidates
+  void compute_priorities();
+  /// Pops the candidate with highest priority, retransmissions first
+  /// @return UE index, or -1 if all candidates were popped
+  int pop_candidate();
+  /// Pops all remaining candidates, in no particular order
+  template <typename Func>
+  void pop_remaining(Func&& f)
+  {
+    for (candidate_list* l : {&retx_cands, &newtx_cands}) {
+      for (uint32_t i = 0; i < l->idxs.size(); ++i) {
+        if (l->prio[i] != -INFINITY) {
+          l->prio[i] = -INFINITY;
+          f(l->idxs[i]);
+        }
+      }
+      l->nof_popped = l->idxs.size();
+    }
+  }
+
+private:
+  void update_inv_avg_rate_pow(uint32_t idx);
+
+  struct candidate_list {
+    std::vector<uint32_t> idxs;
+    std::vector<float>    exp_rate;
+    std::vector<float>    inv_avg_rate_pow;
+    std::vector<float>    prio; ///< -INFINITY once popped
+    uint32_t              nof_popped = 0;
+
+    void clear();
+    void push(uint32_t idx, float r, float inv_R_pow);
+    void compute_priorities();
+    int  pop();
+  };
+
+  const float fairness_coeff;
+  const float exp_avg_alpha;
+  const float decay_inv_pow; ///< (1-alpha)^-fairness_coeff
+
+  std::vector<float>    exp_rate;         ///< r, in bytes/TTI
+  std::vector<float>    avg_rate_;        ///< R, in bytes/TTI
+  std::vector<float>    inv_avg_rate_pow; ///< 1/R^fairness_coeff, or FLT_MAX while R==0
+  std::vector<uint32_t> nof_samples;
+
+  candidate_list retx_cands, newtx_cands;
+};
+
+/**
+ * Time-domain proportional-fair scheduler with the same policy as sched_time_pf, but with UE metrics kept in
+ * structure-of-arrays form and incrementally updated, and candidates selected by SIMD arg-max instead of rebuilding
+ * priority queues every TTI. The allocation attempts stop once the subframe grid is full.
+ * HARQ availability depends on the TTI and is only known to sched_ue, so the candidates are still collected by
+ * walking all UEs every TTI. Only the expected rate is event-driven, i.e. recomputed when the reported CQI changes.
+ */
+class sched_time_pf_soa final : public sched_base
+{
+public:
+  sched_time_pf_soa(const sched_cell_params_t& cell_params_, const sched_interface::sched_args_t& sched_args);
+  void sched_dl_users(sched_ue_list& ue_db, sf_sched* tti_sched) override;
+  void sched_ul_users(sched_ue_list& ue_db, sf_sched* tti_sched) override;
+
+private:
+  void new_tti(sched_ue_list& ue_db, sf_sched* tti_sched);
+  void add_ue(uint16_t rnti);
+  void rem_ue(uint32_t idx);
+
+  uint32_t try_dl_alloc(uint32_t idx, sched_ue& ue, sf_sched* tti_sched);
+  uint32_t try_ul_alloc(uint32_t idx, sched_ue& ue, sf_sched* tti_sched);
+
+  const sched_cell_params_t* cc_cfg = nullptr;
+  const float                fairness_coeff;
+
+  srsran::tti_point current_tti_rx;
+
+  // UE state, indexed by the same UE index as the PF metrics
+  rnti_map_t<uint32_t>             ue_idx_map;
+  std::vector<uint16_t>            rntis;
+  std::vector<int>                 dl_cqi, ul_cqi; ///< CQI used to derive the cached expected rate, or -1
+  std::vector<const dl_harq_proc*> dl_retx_h, dl_newtx_h;
+  std::vector<const ul_harq_proc*> ul_h;
+
+  pf_soa_metrics dl_metrics;
+  pf_soa_metrics ul_metrics;
+};
+
+} // namespace srsenb
+
+#endif // SRSRAN_SCHED_TIME_PF_SOA_H
@@ -0,0 +1,101 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_SOFTBUFFER_POOL_H
+#define SRSENB_SOFTBUFFER_POOL_H
+
+#include "common/mac_metrics.h"
+#include <mutex>
+#include <vector>
+extern "C" {
+#include "srsran/phy/fec/softbuffer.h"
+}
+
+namespace srsenb {
+
+/// Pool of code-block storage shared by the HARQ soft-buffers of all UEs and carriers. The soft-buffers only hold the
+/// code-block pointer arrays, and storage is attached for the code blocks of each scheduled TB and given back once
+/// the HARQ process no longer needs it. Memory is allocated in batches of code blocks and reused LIFO, so recently
+/// used code blocks, which are likely still cached, are handed out first.
+class softbuffer_cb_pool
+{
+public:
+  /// \param llr_8bit_ Rx code blocks hold 8-bit LLRs, as written by the PUSCH 8-bit decoder
+  /// \param max_bytes_ Maximum memory allocated by the pool, or 0 for no limit
+  /// \param cbs_per_batch_ Number of code blocks allocated at once when the pool runs out of them
+  explicit softbuffer_cb_pool(bool llr_8bit_, size_t max_bytes_ = 0, uint32_t cbs_per_batch_ = 64);
+  ~softbuffer_cb_pool();
+  softbuffer_cb_pool(const softbuffer_cb_pool&) = delete;
+  softbuffer_cb_pool& operator=(const softbuffer_cb_pool&) = delete;
+
+  bool is_llr_8bit() const { return llr_8bit; }
+
+  /// Number of code blocks of a TB of tbs bits.
+  static uint32_t get_nof_cb(uint32_t tbs);
+  /// Maximum number of code blocks of a TB in a cell of nof_prb PRBs.
+  static uint32_t get_max_cb(uint32_t nof_prb);
+
+  /// Allocates the code-block pointer arrays of a soft-buffer, without attaching any storage.
+  bool init_rx(srsran_softbuffer_rx_t& buffer, uint32_t max_cb);
+  bool init_tx(srsran_softbuffer_tx_t& buffer, uint32_t max_cb);
+  /// Gives back the attached code blocks and frees the pointer arrays.
+  void free_rx(srsran_softbuffer_rx_t& buffer);
+  void free_tx(srsran_softbuffer_tx_t& buffer);
+
+  /// Attaches storage to the code blocks [0, nof_cb) of the soft-buffer that have none. The LLRs of newly attached
+  /// Rx code blocks are zeroed if zero is set. Returns false if the memory limit was reached.
+  bool attach_rx(srsran_softbuffer_rx_t& buffer, uint32_t nof_cb, bool zero);
+  bool attach_tx(srsran_softbuffer_tx_t& buffer, uint32_t nof_cb);
+  /// Gives back the storage of the code blocks from first_cb onwards.
+  void release_rx(srsran_softbuffer_rx_t& buffer, uint32_t first_cb = 0);
+  void release_tx(srsran_softbuffer_tx_t& buffer, uint32_t first_cb = 0);
+
+  /// Returns the memory usage. The peak usage restarts from the current usage after each call.
+  mac_softbuffer_metrics_t get_metrics();
+
+private:
+  /// Free code blocks of one size.
+  struct cb_list_t {
+    size_t                cb_size = 0;
+    std::vector<uint8_t*> free_cbs;
+    uint32_t              nof_used = 0;
+  };
+
+  uint8_t* alloc_cb(cb_list_t& list);
+  void     update_peak();
+
+  const bool     llr_8bit;
+  const size_t   max_bytes;
+  const uint32_t cbs_per_batch;
+  size_t         rx_llr_size = 0; // Bytes of LLRs at the start of each Rx code block, followed by the decoded data
+
+  std::mutex            mutex;
+  cb_list_t             rx_cbs;
+  cb_list_t             tx_cbs;
+  std::vector<uint8_t*> batches;
+  size_t                allocated_bytes    = 0;
+  size_t                peak_used_bytes    = 0;
+  uint32_t              nof_alloc_failures = 0;
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_SOFTBUFFER_POOL_H
@@ -24,6 +24,7 @@
 
 #include "common/mac_metrics.h"
 #include "sched_interface.h"
+#include "softbuffer_pool.h"
 #include "srsran/adt/circular_array.h"
 #include "srsran/adt/circular_map.h"
 #include "srsran/adt/pool/pool_interface.h"
@@ -45,28 +46,50 @@ class rrc_interface_mac;
 class rlc_interface_mac;
 class phy_interface_stack_lte;
 
-/// Class to manage the allocation, deallocation & access to UE carrier DL + UL softbuffers
+/// Class to manage the allocation, deallocation & access to UE carrier DL + UL softbuffers. The softbuffers only get
+/// code-block storage from the shared pool while their HARQ process has a TB in flight.
 struct ue_cc_softbuffers {
   // List of Tx softbuffers for all HARQ processes of one carrier
   using cc_softbuffer_tx_list_t = std::vector<srsran_softbuffer_tx_t>;
   // List of Rx softbuffers for all HARQ processes of one carrier
   using cc_softbuffer_rx_list_t = std::vector<srsran_softbuffer_rx_t>;
 
+  // HARQ processes not scheduled for this long give their code blocks back to the pool
+  const static uint32_t MAX_IDLE_TTIS = 200;
+
   const uint32_t          nof_tx_harq_proc;
   const uint32_t          nof_rx_harq_proc;
   cc_softbuffer_tx_list_t softbuffer_tx_list;
   cc_softbuffer_rx_list_t softbuffer_rx_list;
 
-  ue_cc_softbuffers(uint32_t nof_prb, uint32_t nof_tx_harq_proc_, uint32_t nof_rx_harq_proc_);
-  ue_cc_softbuffers(ue_cc_softbuffers&&) noexcept = default;
+  ue_cc_softbuffers(softbuffer_cb_pool& cb_pool_,
+                    uint32_t            nof_prb,
+                    uint32_t            nof_tx_harq_proc_,
+                    uint32_t            nof_rx_harq_proc_);
+  ue_cc_softbuffers(const ue_cc_softbuffers&) = delete;
+  ue_cc_softbuffers& operator=(const ue_cc_softbuffers&) = delete;
   ~ue_cc_softbuffers();
   void clear();
 
-  srsran_softbuffer_tx_t& get_tx(uint32_t pid, uint32_t tb_idx)
-  {
-    return softbuffer_tx_list.at(pid * SRSRAN_MAX_TB + tb_idx);
-  }
-  srsran_softbuffer_rx_t& get_rx(uint32_t tti) { return softbuffer_rx_list.at(tti % nof_rx_harq_proc); }
+  /// Returns the softbuffer of a DL HARQ process TB with storage for tbs bits, or nullptr if the pool is exhausted.
+  /// A new transmission gives back the code blocks not needed anymore.
+  srsran_softbuffer_tx_t* get_tx(uint32_t pid, uint32_t tb_idx, uint32_t tbs, bool new_tx, tti_point tti_tx_dl);
+  /// Returns the softbuffer of the UL HARQ process of a PUSCH with storage for tbs bits, or nullptr if the pool is
+  /// exhausted. The softbuffer is reset for a new transmission.
+  srsran_softbuffer_rx_t* get_rx(tti_point tti_rx, uint32_t tbs, bool new_tx);
+
+  /// Gives back the code blocks of the DL TB acknowledged at tti_rx
+  void release_tx(tti_point tti_rx, uint32_t tb_idx);
+  /// Gives back the code blocks of the PUSCH received at tti_rx, once it has been decoded
+  void release_rx(tti_point tti_rx);
+  /// Gives back the code blocks of the HARQ processes not scheduled in the last MAX_IDLE_TTIS
+  void release_idle(tti_point current_tti);
+
+private:
+  softbuffer_cb_pool&    cb_pool;
+  std::mutex             mutex;
+  std::vector<tti_point> tx_last_tti;
+  std::vector<tti_point> rx_last_tti;
 };
 
 /// Class to manage the allocation, deallocation & access to pending UL HARQ buffers
@@ -105,13 +128,9 @@ public:
   void allocate_cc(srsran::unique_pool_ptr<ue_cc_softbuffers> cc_softbuffers_);
   void deallocate_cc();
 
-  bool                    empty() const { return cc_softbuffers == nullptr; }
-  srsran_softbuffer_tx_t& get_tx_softbuffer(uint32_t pid, uint32_t tb_idx)
-  {
-    return cc_softbuffers->get_tx(pid, tb_idx);
-  }
-  srsran_softbuffer_rx_t& get_rx_softbuffer(uint32_t tti) { return cc_softbuffers->get_rx(tti); }
-  srsran::byte_buffer_t*  get_tx_payload_buffer(size_t harq_pid, size_t tb)
+  bool                   empty() const { return cc_softbuffers == nullptr; }
+  ue_cc_softbuffers&     get_softbuffers() { return *cc_softbuffers; }
+  srsran::byte_buffer_t* get_tx_payload_buffer(size_t harq_pid, size_t tb)
   {
     return tx_payload_buffer[harq_pid][tb].get();
   }
@@ -168,8 +187,15 @@ public:
                             uint32_t                             nof_pdu_elems,
                             uint32_t                             grant_size);
 
-  srsran_softbuffer_tx_t* get_tx_softbuffer(uint32_t enb_cc_idx, uint32_t harq_process, uint32_t tb_idx);
-  srsran_softbuffer_rx_t* get_rx_softbuffer(uint32_t enb_cc_idx, uint32_t tti);
+  srsran_softbuffer_tx_t* get_tx_softbuffer(uint32_t enb_cc_idx,
+                                            uint32_t harq_process,
+                                            uint32_t tb_idx,
+                                            uint32_t tbs,
+                                            bool     new_tx,
+                                            uint32_t tti_tx_dl);
+  srsran_softbuffer_rx_t* get_rx_softbuffer(uint32_t enb_cc_idx, uint32_t tti, uint32_t tbs, bool new_tx);
+  void                    release_tx_softbuffer(uint32_t enb_cc_idx, uint32_t tti_rx, uint32_t tb_idx);
+  void                    release_rx_softbuffer(uint32_t enb_cc_idx, uint32_t tti_rx);
 
   uint8_t* request_buffer(uint32_t tti, uint32_t enb_cc_idx, uint32_t len);
   void     process_pdu(srsran::unique_byte_buffer_t pdu, uint32_t ue_cc_idx, uint32_t grant_nof_prbs);
@@ -206,6 +206,26 @@ private:
   void parse_ul_ccch(ue& ue, srsran::unique_byte_buffer_t pdu);
   void send_rrc_connection_reject(uint16_t rnti);
 
+  /// Packs a DL message and copies it into a new PDU of the size class of its encoding. Returns nullptr on failure
+  template <class T>
+  srsran::unique_byte_buffer_t pack_dl_msg(const T& msg, const char* msg_name)
+  {
+    asn1::bit_ref bref(dl_pack_buffer.data(), dl_pack_buffer.size());
+    if (msg.pack(bref) != asn1::SRSASN_SUCCESS) {
+      logger.error(dl_pack_buffer.data(), bref.distance_bytes(), "Failed to pack %s:", msg_name);
+      return nullptr;
+    }
+    uint32_t                     nof_bytes = (uint32_t)bref.distance_bytes();
+    srsran::unique_byte_buffer_t pdu       = srsran::make_sized_byte_buffer(nof_bytes);
+    if (pdu == nullptr) {
+      logger.error("Allocating pdu");
+      return nullptr;
+    }
+    pdu->append_bytes(dl_pack_buffer.data(), nof_bytes);
+    return pdu;
+  }
+  std::vector<uint8_t> dl_pack_buffer;
+
   const static int mcch_payload_len                      = 3000;
   int              current_mcch_length                   = 0;
   uint8_t          mcch_payload_buffer[mcch_payload_len] = {};
@@ -167,6 +167,7 @@ public:
 
   // stack interface
   void handle_gtpu_s1u_rx_packet(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr);
+  void handle_gtpu_s1u_rx_burst(std::vector<srsran::rx_datagram_t>& burst);
   void handle_gtpu_m1u_rx_packet(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr);
 
 private:
@@ -225,6 +226,18 @@ private:
   void error_indication(in_addr_t addr, in_port_t port, uint32_t err_teid);
   bool send_end_marker(uint32_t teidin);
 
+  // SDUs without PDCP SN of consecutive data PDUs of one active tunnel, forwarded to PDCP as a single burst
+  struct rx_sdu_burst_t {
+    uint32_t                                  teid_in       = 0;
+    uint16_t                                  rnti          = SRSRAN_INVALID_RNTI;
+    uint32_t                                  eps_bearer_id = 0;
+    std::vector<srsran::unique_byte_buffer_t> sdus;
+  };
+  rx_sdu_burst_t rx_burst;
+
+  void handle_s1u_rx_pdu(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr);
+  void flush_rx_burst();
+
   void handle_end_marker(const gtpu_tunnel& rx_tunnel);
   void handle_msg_data_pdu(const srsran::gtpu_header_t& header,
                            const gtpu_tunnel&           rx_tunnel,
@@ -70,10 +70,12 @@ public:
   void reestablish(uint16_t rnti) override;
 
   // pdcp_interface_gtpu
+  void write_sdus(uint16_t rnti, uint32_t lcid, srsran::span<srsran::unique_byte_buffer_t> sdus) override;
   std::map<uint32_t, srsran::unique_byte_buffer_t> get_buffered_pdus(uint16_t rnti, uint32_t lcid) override;
 
   // Metrics
   void get_metrics(pdcp_metrics_t& m, const uint32_t nof_tti);
+  void get_metrics(std::map<uint32_t, srsran::pdcp_metrics_t>& m, const uint32_t nof_tti);
 
 private:
   class user_interface_rlc : public srsue::rlc_interface_pdcp
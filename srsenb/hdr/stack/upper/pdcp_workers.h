@@ -0,0 +1,211 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_PDCP_WORKERS_H
+#define SRSENB_PDCP_WORKERS_H
+
+#include "srsenb/hdr/stack/upper/pdcp.h"
+#include "srsran/common/task_scheduler.h"
+#include "srsran/common/threads.h"
+#include "srsran/interfaces/enb_gtpu_interfaces.h"
+#include "srsran/interfaces/enb_rlc_interfaces.h"
+#include "srsran/interfaces/enb_rrc_interfaces.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * PDCP of the eNB with the UEs sharded across a pool of worker threads, keyed by RNTI.
+ * Each worker owns a PDCP instance with its own task scheduler, so that the PDCP entities of a UE, including their
+ * timers, the writes of SDUs to the UE RLC queues and the UL RLC PDUs handed over by MAC only run in the worker of the
+ * UE. The calls for a UE are forwarded to its worker in call order, which preserves the order of each bearer. RRC and
+ * GTP-U stay in the stack control thread: the PDUs and notifications addressed to them are handed back to it, without
+ * ever blocking the workers or dropping any of them.
+ */
+class pdcp_workers final : public pdcp_interface_rlc, public pdcp_interface_gtpu, public pdcp_interface_rrc
+{
+public:
+  pdcp_workers(srsran::task_sched_handle task_sched_, srslog::basic_logger& logger_, uint32_t nof_workers);
+  ~pdcp_workers();
+  void init(rlc_interface_pdcp*  rlc_,
+            rrc_interface_pdcp*  rrc_,
+            gtpu_interface_pdcp* gtpu_,
+            rlc_interface_mac*   rlc_mac_ = nullptr);
+  void stop();
+
+  /// Steps the timers of the workers and runs the pending RRC/GTP-U calls. Called once per TTI by the control thread
+  void tic();
+
+  uint32_t nof_workers() const { return workers.size(); }
+
+  /// Interface given to MAC instead of the RLC one, so that the UL RLC PDUs of a UE are processed in its worker
+  rlc_interface_mac* get_rlc_mac_itf() { return &rlc_mac_itf; }
+
+  // pdcp_interface_rlc
+  void write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t sdu) override;
+  void notify_delivery(uint16_t rnti, uint32_t lcid, const srsran::pdcp_sn_vector_t& pdcp_sn) override;
+  void notify_failure(uint16_t rnti, uint32_t lcid, const srsran::pdcp_sn_vector_t& pdcp_sn) override;
+
+  // pdcp_interface_rrc
+  void set_enabled(uint16_t rnti, uint32_t lcid, bool enabled) override;
+  void reset(uint16_t rnti) override;
+  void add_user(uint16_t rnti) override;
+  void rem_user(uint16_t rnti) override;
+  void write_sdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t sdu, int pdcp_sn = -1) override;
+  void add_bearer(uint16_t rnti, uint32_t lcid, const srsran::pdcp_config_t& cnfg) override;
+  void del_bearer(uint16_t rnti, uint32_t lcid) override;
+  void config_security(uint16_t rnti, uint32_t lcid, const srsran::as_security_config_t& cfg_sec) override;
+  void enable_integrity(uint16_t rnti, uint32_t lcid) override;
+  void enable_encryption(uint16_t rnti, uint32_t lcid) override;
+  bool get_bearer_state(uint16_t rnti, uint32_t lcid, srsran::pdcp_lte_state_t* state) override;
+  bool set_bearer_state(uint16_t rnti, uint32_t lcid, const srsran::pdcp_lte_state_t& state) override;
+  void send_status_report(uint16_t rnti) override;
+  void send_status_report(uint16_t rnti, uint32_t lcid) override;
+  void reestablish(uint16_t rnti) override;
+
+  // pdcp_interface_gtpu
+  void write_sdus(uint16_t rnti, uint32_t lcid, srsran::span<srsran::unique_byte_buffer_t> sdus) override;
+  std::map<uint32_t, srsran::unique_byte_buffer_t> get_buffered_pdus(uint16_t rnti, uint32_t lcid) override;
+
+  // Metrics
+  void get_metrics(pdcp_metrics_t& m, const uint32_t nof_tti);
+
+private:
+  // Hands the PDUs and notifications of the workers to RRC in the control thread
+  class rrc_proxy final : public rrc_interface_pdcp
+  {
+  public:
+    explicit rrc_proxy(pdcp_workers* parent_) : parent(parent_) {}
+    void write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t pdu) override;
+    void notify_pdcp_integrity_error(uint16_t rnti, uint32_t lcid) override;
+
+  private:
+    pdcp_workers* parent;
+  };
+
+  // Hands the PDUs of the workers to GTP-U in the control thread
+  class gtpu_proxy final : public gtpu_interface_pdcp
+  {
+  public:
+    explicit gtpu_proxy(pdcp_workers* parent_) : parent(parent_) {}
+    void write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t pdu) override;
+
+  private:
+    pdcp_workers* parent;
+  };
+
+  // Moves the UL RLC PDUs from MAC to the worker of the UE. DL reads stay in the calling PHY worker
+  class rlc_mac_proxy final : public rlc_interface_mac
+  {
+  public:
+    explicit rlc_mac_proxy(pdcp_workers* parent_) : parent(parent_) {}
+    int  read_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) override;
+    void write_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) override;
+
+  private:
+    pdcp_workers* parent;
+  };
+
+  class worker final : public srsran::thread
+  {
+  public:
+    worker(uint32_t idx, srslog::basic_logger& logger);
+    void start_worker();
+    void stop_worker();
+    bool is_current() const;
+
+    template <typename F>
+    void push(F&& func)
+    {
+      queue.push(locked_task<typename std::decay<F>::type>{this, std::forward<F>(func), false});
+    }
+
+    /// Pushes a task that changes the configuration of a UE, which the synchronous queries have to wait for
+    template <typename F>
+    void push_cfg(F&& func)
+    {
+      nof_pending_cfg.fetch_add(1, std::memory_order_relaxed);
+      queue.push(locked_task<typename std::decay<F>::type>{this, std::forward<F>(func), true});
+    }
+
+    srsran::task_scheduler task_sched;
+    srsenb::pdcp           pdcp;
+    /// Held while the worker runs a task, so that the control thread can query its PDCP without queueing behind it
+    std::mutex            pdcp_mutex;
+    std::atomic<uint32_t> nof_pending_cfg{0};
+
+  private:
+    // Task of the worker, run while holding pdcp_mutex
+    template <typename F>
+    struct locked_task {
+      worker* w;
+      F       func;
+      bool    is_cfg;
+      void    operator()()
+      {
+        std::lock_guard<std::mutex> lock(w->pdcp_mutex);
+        func();
+        if (is_cfg) {
+          w->nof_pending_cfg.fetch_sub(1, std::memory_order_release);
+        }
+      }
+    };
+
+    void run_thread() override;
+
+    srsran::task_queue_handle queue;
+    std::atomic<bool>         running{false};
+  };
+
+  worker& get_worker(uint16_t rnti) { return *workers[rnti % workers.size()]; }
+  void    push_to_ctrl(srsran::move_task_t task);
+  void    run_ctrl_tasks();
+
+  /// Runs func in the worker of the UE. It only waits for the worker when configuration changes of the UE are still
+  /// queued, otherwise it runs func in the calling thread, between two tasks of the worker
+  template <typename R, typename F>
+  R run_sync(worker& w, F&& func);
+
+  rrc_interface_pdcp*  rrc     = nullptr;
+  gtpu_interface_pdcp* gtpu    = nullptr;
+  rlc_interface_mac*   rlc_mac = nullptr;
+  rrc_proxy            rrc_itf;
+  gtpu_proxy           gtpu_itf;
+  rlc_mac_proxy        rlc_mac_itf;
+
+  // Calls of the workers towards RRC/GTP-U. The list is unbounded, so that the workers never wait for the control
+  // thread, which in turn may wait for them. The control thread runs it when woken up, and at least once per TTI
+  std::mutex                       ctrl_mutex;
+  std::vector<srsran::move_task_t> ctrl_tasks;
+  std::vector<srsran::move_task_t> ctrl_tasks_running;
+  bool                             ctrl_wakeup_pending = false;
+
+  srsran::task_queue_handle            ctrl_queue;
+  srslog::basic_logger&                logger;
+  std::vector<std::unique_ptr<worker> > workers;
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_PDCP_WORKERS_H
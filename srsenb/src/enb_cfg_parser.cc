@@ -1415,8 +1415,9 @@ int set_derived_args(all_args_t* args_, rrc_cfg_t* rrc_cfg_, phy_cfg_t* phy_cfg_
   // Patch certain args that are not exposed yet
   args_->rf.nof_antennas = args_->enb.nof_ports;
 
-  // MAC needs to know the cell bandwidth to dimension softbuffers
-  args_->stack.mac.nof_prb = args_->enb.n_prb;
+  // MAC needs to know the cell bandwidth and the LLR width to dimension softbuffers
+  args_->stack.mac.nof_prb            = args_->enb.n_prb;
+  args_->stack.mac.pusch_8bit_decoder = args_->phy.pusch_8bit_decoder;
 
   // RRC needs eNB id for SIB1 packing
   rrc_cfg_->enb_id = args_->stack.s1ap.enb_id;
@@ -81,13 +81,56 @@ DECLARE_METRIC("nof_rach", metric_nof_rach, uint32_t, "");
 DECLARE_METRIC_LIST("ue_list", mlist_ues, std::vector<mset_ue_container>);
 DECLARE_METRIC_SET("cell_container", mset_cell_container, metric_carrier_id, metric_pci, metric_nof_rach, mlist_ues);
 
+/// PHY processing time metrics.
+DECLARE_METRIC("stage", metric_phy_stage, std::string, "");
+DECLARE_METRIC("avg_time", metric_phy_stage_avg_time, float, "us");
+DECLARE_METRIC("max_time", metric_phy_stage_max_time, float, "us");
+DECLARE_METRIC_SET("phy_stage_container",
+                   mset_phy_stage_container,
+                   metric_phy_stage,
+                   metric_phy_stage_avg_time,
+                   metric_phy_stage_max_time);
+
+/// HARQ softbuffer pool metrics.
+DECLARE_METRIC("allocated_bytes", metric_softbuffer_allocated_bytes, uint64_t, "");
+DECLARE_METRIC("ul_used_bytes", metric_softbuffer_ul_used_bytes, uint64_t, "");
+DECLARE_METRIC("dl_used_bytes", metric_softbuffer_dl_used_bytes, uint64_t, "");
+DECLARE_METRIC("peak_used_bytes", metric_softbuffer_peak_used_bytes, uint64_t, "");
+DECLARE_METRIC("alloc_failures", metric_softbuffer_alloc_failures, uint32_t, "");
+DECLARE_METRIC_SET("softbuffer_pool",
+                   mset_softbuffer_pool,
+                   metric_softbuffer_allocated_bytes,
+                   metric_softbuffer_ul_used_bytes,
+                   metric_softbuffer_dl_used_bytes,
+                   metric_softbuffer_peak_used_bytes,
+                   metric_softbuffer_alloc_failures);
+
+/// Byte buffer pool metrics, per size class.
+DECLARE_METRIC("class", metric_buffer_pool_class, std::string, "");
+DECLARE_METRIC("capacity", metric_buffer_pool_capacity, uint32_t, "");
+DECLARE_METRIC("in_use", metric_buffer_pool_in_use, uint32_t, "");
+DECLARE_METRIC("high_watermark", metric_buffer_pool_high_watermark, uint32_t, "");
+DECLARE_METRIC_SET("buffer_pool_container",
+                   mset_buffer_pool_container,
+                   metric_buffer_pool_class,
+                   metric_buffer_pool_capacity,
+                   metric_buffer_pool_in_use,
+                   metric_buffer_pool_high_watermark);
+
 /// Metrics root object.
 DECLARE_METRIC("type", metric_type_tag, std::string, "");
 DECLARE_METRIC("timestamp", metric_timestamp_tag, double, "");
 DECLARE_METRIC_LIST("cell_list", mlist_cell, std::vector<mset_cell_container>);
+DECLARE_METRIC_LIST("phy_timing", mlist_phy_stages, std::vector<mset_phy_stage_container>);
+DECLARE_METRIC_LIST("byte_buffer_pool", mlist_buffer_pools, std::vector<mset_buffer_pool_container>);
 
 /// Metrics context.
-using metric_context_t = srslog::build_context_type<metric_type_tag, metric_timestamp_tag, mlist_cell>;
+using metric_context_t = srslog::build_context_type<metric_type_tag,
+                                                    metric_timestamp_tag,
+                                                    mlist_cell,
+                                                    mlist_phy_stages,
+                                                    mset_softbuffer_pool,
+                                                    mlist_buffer_pools>;
 
 } // namespace
 
@@ -151,6 +194,20 @@ static double get_time_stamp()
   return std::chrono::duration_cast<std::chrono::milliseconds>(tp).count() * 1e-3;
 }
 
+/// Add the processing time of a PHY stage, unless it has not been sampled.
+static void add_phy_stage_metrics(std::vector<mset_phy_stage_container>& stages,
+                                  const char*                            name,
+                                  const phy_stage_metrics_t&             m)
+{
+  if (m.n_samples == 0) {
+    return;
+  }
+  stages.emplace_back();
+  stages.back().write<metric_phy_stage>(name);
+  stages.back().write<metric_phy_stage_avg_time>(m.avg_us);
+  stages.back().write<metric_phy_stage_max_time>(m.max_us);
+}
+
 /// Returns false if the input index is out of bounds in the metrics struct.
 static bool has_valid_metric_ranges(const enb_metrics_t& m, unsigned index)
 {
@@ -208,6 +265,35 @@ void metrics_json::set_metrics(const enb_metrics_t& m, const uint32_t period_use
     }
   }
 
+  // Fill the PHY processing time of each stage.
+  auto& phy_stages = ctx.get<mlist_phy_stages>();
+  add_phy_stage_metrics(phy_stages, "ul_fft", m.phy_timing.ul_fft);
+  add_phy_stage_metrics(phy_stages, "pusch", m.phy_timing.pusch);
+  add_phy_stage_metrics(phy_stages, "pucch", m.phy_timing.pucch);
+  add_phy_stage_metrics(phy_stages, "dl_ctrl", m.phy_timing.dl_ctrl);
+  add_phy_stage_metrics(phy_stages, "pdsch", m.phy_timing.pdsch);
+  add_phy_stage_metrics(phy_stages, "dl_ifft", m.phy_timing.dl_ifft);
+  add_phy_stage_metrics(phy_stages, "total", m.phy_timing.total);
+
+  // Fill the memory usage of the HARQ softbuffers.
+  auto& softbuffers = ctx.get<mset_softbuffer_pool>();
+  softbuffers.write<metric_softbuffer_allocated_bytes>(m.stack.mac.softbuffers.allocated_bytes);
+  softbuffers.write<metric_softbuffer_ul_used_bytes>(m.stack.mac.softbuffers.rx_used_bytes);
+  softbuffers.write<metric_softbuffer_dl_used_bytes>(m.stack.mac.softbuffers.tx_used_bytes);
+  softbuffers.write<metric_softbuffer_peak_used_bytes>(m.stack.mac.softbuffers.peak_used_bytes);
+  softbuffers.write<metric_softbuffer_alloc_failures>(m.stack.mac.softbuffers.nof_alloc_failures);
+
+  // Fill the occupancy of each byte buffer size class.
+  auto& buffer_pools = ctx.get<mlist_buffer_pools>();
+  for (size_t i = 0; i < m.stack.byte_buffer_pool.size(); ++i) {
+    const srsran::buffer_pool_metrics_t& pool = m.stack.byte_buffer_pool[i];
+    buffer_pools.emplace_back();
+    buffer_pools.back().write<metric_buffer_pool_class>(srsran::to_string((srsran::byte_buffer_class_t)i));
+    buffer_pools.back().write<metric_buffer_pool_capacity>(pool.capacity);
+    buffer_pools.back().write<metric_buffer_pool_in_use>(pool.nof_in_use);
+    buffer_pools.back().write<metric_buffer_pool_high_watermark>(pool.high_watermark);
+  }
+
   // Log the context.
   ctx.write<metric_timestamp_tag>(get_time_stamp());
   log_c(ctx);
@@ -23,6 +23,7 @@
 #include "srsran/srsran.h"
 
 #include "srsenb/hdr/phy/lte/cc_worker.h"
+#include <chrono>
 
 #define Error(fmt, ...)                                                                                                \
   if (SRSRAN_DEBUG_ENABLED)                                                                                            \
@@ -54,6 +55,14 @@ using namespace asn1::rrc;
 namespace srsenb {
 namespace lte {
 
+// Returns the time elapsed since t in microseconds and moves t to the current time
+static float stage_time_us(std::chrono::steady_clock::time_point& t)
+{
+  auto start = t;
+  t          = std::chrono::steady_clock::now();
+  return std::chrono::duration<float, std::micro>(t - start).count();
+}
+
 cc_worker::cc_worker(srslog::basic_logger& logger) : logger(logger)
 {
   reset();
@@ -65,6 +74,13 @@ cc_worker::~cc_worker()
   srsran_enb_dl_free(&enb_dl);
   srsran_enb_ul_free(&enb_ul);
 
+  for (auto& lane : pusch_lanes) {
+    srsran_enb_ul_pusch_lane_free(lane.get());
+  }
+  for (auto& lane : pdsch_lanes) {
+    srsran_pdsch_free(lane.get());
+  }
+
   for (int p = 0; p < SRSRAN_MAX_PORTS; p++) {
     if (signal_buffer_rx[p]) {
       free(signal_buffer_rx[p]);
@@ -149,6 +165,50 @@ void cc_worker::init(phy_common* phy_, uint32_t cc_idx_)
     enb_ul.pusch.llr_is_8bit        = true;
     enb_ul.pusch.ul_sch.llr_is_8bit = true;
   }
+  if (phy->params.nof_pusch_dec_threads > 0) {
+    if (srsran_sch_set_decoder_pool(&enb_ul.pusch.ul_sch, &phy->pusch_decoder_pool) < SRSRAN_SUCCESS) {
+      ERROR("Error setting PUSCH decoder pool");
+      return;
+    }
+  }
+
+  // Additional PUSCH decoders and PDSCH encoders for processing the users of a subframe in parallel
+  for (uint32_t i = 1; i < phy->get_nof_task_lanes(); i++) {
+    pusch_lanes.emplace_back(new srsran_enb_ul_pusch_lane_t{});
+    srsran_enb_ul_pusch_lane_t* ul_lane = pusch_lanes.back().get();
+    if (srsran_enb_ul_pusch_lane_init(ul_lane, nof_prb)) {
+      ERROR("Error initiating PUSCH lane (cc=%d)", cc_idx);
+      return;
+    }
+    if (srsran_enb_ul_pusch_lane_set_cell(ul_lane, cell, &phy->dmrs_pusch_cfg, nullptr)) {
+      ERROR("Error initiating PUSCH lane (cc=%d)", cc_idx);
+      return;
+    }
+    if (phy->params.pusch_8bit_decoder) {
+      ul_lane->pusch.llr_is_8bit        = true;
+      ul_lane->pusch.ul_sch.llr_is_8bit = true;
+    }
+    if (phy->params.nof_pusch_dec_threads > 0) {
+      if (srsran_sch_set_decoder_pool(&ul_lane->pusch.ul_sch, &phy->pusch_decoder_pool) < SRSRAN_SUCCESS) {
+        ERROR("Error setting PUSCH decoder pool");
+        return;
+      }
+    }
+
+    pdsch_lanes.emplace_back(new srsran_pdsch_t{});
+    srsran_pdsch_t* dl_lane = pdsch_lanes.back().get();
+    if (srsran_pdsch_init_enb(dl_lane, nof_prb)) {
+      ERROR("Error initiating PDSCH lane (cc=%d)", cc_idx);
+      return;
+    }
+    if (srsran_pdsch_set_cell(dl_lane, cell)) {
+      ERROR("Error initiating PDSCH lane (cc=%d)", cc_idx);
+      return;
+    }
+  }
+  pusch_jobs.reserve(stack_interface_phy_lte::MAX_GRANTS);
+  pdsch_jobs.reserve(stack_interface_phy_lte::MAX_GRANTS);
+
   initiated = true;
 
 #ifdef DEBUG_WRITE_FILE
@@ -211,14 +271,19 @@ void cc_worker::work_ul(const srsran_ul_sf_cfg_t& ul_sf_cfg, stack_interface_phy
   ul_sf = ul_sf_cfg;
   logger.set_context(ul_sf.tti);
 
+  std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+
   // Process UL signal
   srsran_enb_ul_fft(&enb_ul);
+  timing.ul_fft.add(stage_time_us(t));
 
   // Decode pending UL grants for the tti they were scheduled
   decode_pusch(ul_grants.pusch, ul_grants.nof_grants);
+  timing.pusch.add(stage_time_us(t));
 
   // Decode remaining PUCCH ACKs not associated with PUSCH transmission and SR signals
   decode_pucch();
+  timing.pucch.add(stage_time_us(t));
 }
 
 void cc_worker::work_dl(const srsran_dl_sf_cfg_t&            dl_sf_cfg,
@@ -229,17 +294,14 @@ void cc_worker::work_dl(const srsran_dl_sf_cfg_t&            dl_sf_cfg,
   std::lock_guard<std::mutex> lock(mutex);
   dl_sf = dl_sf_cfg;
 
+  std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+
   // Put base signals (references, PBCH, PCFICH and PSS/SSS) into the resource grid
   srsran_enb_dl_put_base(&enb_dl, &dl_sf);
 
-  // Put DL grants to resource grid. PDSCH data will be encoded as well.
+  // Put DL grants to resource grid
   if (dl_sf_cfg.sf_type == SRSRAN_SF_NORM) {
     encode_pdcch_dl(dl_grants.pdsch, dl_grants.nof_grants);
-    encode_pdsch(dl_grants.pdsch, dl_grants.nof_grants);
-  } else {
-    if (mbsfn_cfg->enable) {
-      encode_pmch(dl_grants.pdsch, mbsfn_cfg);
-    }
   }
 
   // Put UL grants to resource grid.
@@ -247,6 +309,17 @@ void cc_worker::work_dl(const srsran_dl_sf_cfg_t&            dl_sf_cfg,
 
   // Put pending PHICH HARQ ACK/NACK indications into subframe
   encode_phich(ul_grants.phich, ul_grants.nof_phich);
+  timing.dl_ctrl.add(stage_time_us(t));
+
+  // Encode PDSCH data into the resource grid, it does not overlap with the control region filled above
+  if (dl_sf_cfg.sf_type == SRSRAN_SF_NORM) {
+    encode_pdsch(dl_grants.pdsch, dl_grants.nof_grants);
+  } else {
+    if (mbsfn_cfg->enable) {
+      encode_pmch(dl_grants.pdsch, mbsfn_cfg);
+    }
+  }
+  timing.pdsch.add(stage_time_us(t));
 
   // Generate signal and transmit
   srsran_enb_dl_gen_signal(&enb_dl);
@@ -260,13 +333,13 @@ void cc_worker::work_dl(const srsran_dl_sf_cfg_t&            dl_sf_cfg,
       srsran_vec_sc_prod_cfc(signal_buffer_tx[i], scale, signal_buffer_tx[i], sf_len);
     }
   }
+  timing.dl_ifft.add(stage_time_us(t));
 }
 
-bool cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant,
-                                  srsran_ul_cfg_t&                           ul_cfg,
-                                  srsran_pusch_res_t&                        pusch_res)
+bool cc_worker::prepare_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant, pusch_job_t& job)
 {
-  uint16_t rnti = ul_grant.dci.rnti;
+  uint16_t         rnti   = ul_grant.dci.rnti;
+  srsran_ul_cfg_t& ul_cfg = job.ul_cfg;
 
   // Invalid RNTI
   if (rnti == SRSRAN_INVALID_RNTI) {
@@ -286,7 +359,7 @@ bool cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_
   }
 
   // Fill UCI configuration
-  bool uci_required =
+  job.uci_required =
       phy->ue_db.fill_uci_cfg(tti_rx, cc_idx, rnti, ul_grant.dci.cqi_request, true, ul_cfg.pusch.uci_cfg);
 
   // Compute UL grant
@@ -317,20 +390,55 @@ bool cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_
     Error("Error setting last UL TB for RNTI %x, CC %d, PID %d", rnti, cc_idx, ul_grant.pid);
   }
 
-  // Run PUSCH decoder
+  // Prepare PUSCH decoder
   ul_cfg.pusch.softbuffers.rx = ul_grant.softbuffer_rx;
-  pusch_res.data              = ul_grant.data;
-  if (pusch_res.data) {
-    if (srsran_enb_ul_get_pusch(&enb_ul, &ul_sf, &ul_cfg.pusch, &pusch_res)) {
-      Error("Decoding PUSCH for RNTI %x", rnti);
-      return false;
+  job.pusch_res.data          = ul_grant.data;
+  job.ul_grant                = &ul_grant;
+  return true;
+}
+
+void cc_worker::decode_pusch_lane(uint32_t lane_idx)
+{
+  // Take jobs until there are none left, only the lane decoder and the job are written
+  for (uint32_t i = next_pusch_job++; i < pusch_jobs.size(); i = next_pusch_job++) {
+    pusch_job_t& job = pusch_jobs[i];
+
+    // Nothing to decode if MAC did not provide a buffer
+    if (job.pusch_res.data == nullptr) {
+      job.decoded = true;
+      continue;
+    }
+
+    int ret = SRSRAN_ERROR;
+    if (lane_idx == 0) {
+      ret           = srsran_enb_ul_get_pusch(&enb_ul, &ul_sf, &job.ul_cfg.pusch, &job.pusch_res);
+      job.chest_res = enb_ul.chest_res;
+    } else {
+      srsran_enb_ul_pusch_lane_t* lane = pusch_lanes[lane_idx - 1].get();
+
+      ret           = srsran_enb_ul_get_pusch_lane(&enb_ul, lane, &ul_sf, &job.ul_cfg.pusch, &job.pusch_res);
+      job.chest_res = lane->chest_res;
     }
+    job.decoded = (ret == SRSRAN_SUCCESS);
+  }
+}
+
+bool cc_worker::report_pusch_rnti(pusch_job_t& job)
+{
+  stack_interface_phy_lte::ul_sched_grant_t& ul_grant = *job.ul_grant;
+  srsran_ul_cfg_t&                           ul_cfg   = job.ul_cfg;
+  uint16_t                                   rnti     = ul_grant.dci.rnti;
+
+  if (not job.decoded) {
+    Error("Decoding PUSCH for RNTI %x", rnti);
+    return false;
   }
+
   // Save PHICH scheduling for this user. Each user can have just 1 PUSCH dci per TTI
-  ue_db[rnti]->phich_grant.n_prb_lowest = grant.n_prb_tilde[0];
+  ue_db[rnti]->phich_grant.n_prb_lowest = ul_cfg.pusch.grant.n_prb_tilde[0];
   ue_db[rnti]->phich_grant.n_dmrs       = ul_grant.dci.n_dmrs;
 
-  float snr_db = enb_ul.chest_res.snr_db;
+  float snr_db = job.chest_res.snr_db;
 
   // Notify MAC of RL status
   if (snr_db >= PUSCH_RL_SNR_DB_TH) {
@@ -338,51 +446,63 @@ bool cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_
     phy->stack->snr_info(ul_sf.tti, rnti, cc_idx, snr_db, mac_interface_phy_lte::PUSCH);
 
     // Notify MAC of Time Alignment only if it enabled and valid measurement, ignore value otherwise
-    if (ul_cfg.pusch.meas_ta_en and not std::isnan(enb_ul.chest_res.ta_us) and not std::isinf(enb_ul.chest_res.ta_us)) {
-      phy->stack->ta_info(ul_sf.tti, rnti, enb_ul.chest_res.ta_us);
+    if (ul_cfg.pusch.meas_ta_en and not std::isnan(job.chest_res.ta_us) and not std::isinf(job.chest_res.ta_us)) {
+      phy->stack->ta_info(ul_sf.tti, rnti, job.chest_res.ta_us);
     }
   }
 
   // Send UCI data to MAC
-  if (uci_required) {
-    phy->ue_db.send_uci_data(tti_rx, rnti, cc_idx, ul_cfg.pusch.uci_cfg, pusch_res.uci);
+  if (job.uci_required) {
+    phy->ue_db.send_uci_data(tti_rx, rnti, cc_idx, ul_cfg.pusch.uci_cfg, job.pusch_res.uci);
   }
 
   // Save statistics only if data was provided
   if (ul_grant.data != nullptr) {
     // Save metrics stats
-    ue_db[rnti]->metrics_ul(ul_grant.dci.tb.mcs_idx, 0, enb_ul.chest_res.snr_db, pusch_res.avg_iterations_block);
+    ue_db[rnti]->metrics_ul(ul_grant.dci.tb.mcs_idx, 0, snr_db, job.pusch_res.avg_iterations_block);
   }
   return true;
 }
 
 void cc_worker::decode_pusch(stack_interface_phy_lte::ul_sched_grant_t* grants, uint32_t nof_pusch)
 {
-  // Iterate over all the grants, all the grants need to report MAC the CRC status
+  // Prepare the grants in order, processing stops at the first grant that cannot be decoded
+  pusch_jobs.clear();
   for (uint32_t i = 0; i < nof_pusch; i++) {
+    pusch_jobs.emplace_back();
+    if (!prepare_pusch_rnti(grants[i], pusch_jobs.back())) {
+      pusch_jobs.pop_back();
+      break;
+    }
+  }
+
+  // Decode the PUSCH of different users in parallel, each lane is used by a single thread at a time
+  uint32_t nof_lanes = std::min((uint32_t)pusch_jobs.size(), (uint32_t)pusch_lanes.size() + 1);
+  next_pusch_job     = 0;
+  phy->parallel_for(nof_lanes, [this](uint32_t lane_idx) { decode_pusch_lane(lane_idx); });
+
+  // Iterate over all the grants, all the grants need to report MAC the CRC status
+  for (pusch_job_t& job : pusch_jobs) {
     // Get grant itself and RNTI
-    stack_interface_phy_lte::ul_sched_grant_t& ul_grant = grants[i];
+    stack_interface_phy_lte::ul_sched_grant_t& ul_grant = *job.ul_grant;
     uint16_t                                   rnti     = ul_grant.dci.rnti;
 
-    srsran_pusch_res_t pusch_res = {};
-    srsran_ul_cfg_t    ul_cfg    = {};
-
-    // Decodes PUSCH for the given grant
-    if (!decode_pusch_rnti(ul_grant, ul_cfg, pusch_res)) {
+    if (!report_pusch_rnti(job)) {
       return;
     }
 
     // Notify MAC new received data and HARQ Indication value
     if (ul_grant.data != nullptr) {
+      srsran_ul_cfg_t& ul_cfg = job.ul_cfg;
       // Inform MAC about the CRC result
-      phy->stack->crc_info(tti_rx, rnti, cc_idx, ul_cfg.pusch.grant.tb.tbs / 8, pusch_res.crc);
+      phy->stack->crc_info(tti_rx, rnti, cc_idx, ul_cfg.pusch.grant.tb.tbs / 8, job.pusch_res.crc);
       // Push PDU buffer
       phy->stack->push_pdu(
-          tti_rx, rnti, cc_idx, ul_cfg.pusch.grant.tb.tbs / 8, pusch_res.crc, ul_cfg.pusch.grant.L_prb);
+          tti_rx, rnti, cc_idx, ul_cfg.pusch.grant.tb.tbs / 8, job.pusch_res.crc, ul_cfg.pusch.grant.L_prb);
       // Logging
       if (logger.info.enabled()) {
         char str[512];
-        srsran_pusch_rx_info(&ul_cfg.pusch, &pusch_res, &enb_ul.chest_res, str, sizeof(str));
+        srsran_pusch_rx_info(&ul_cfg.pusch, &job.pusch_res, &job.chest_res, str, sizeof(str));
         logger.info("PUSCH: cc=%d, %s", cc_idx, str);
       }
     }
@@ -569,14 +689,18 @@ int cc_worker::encode_pdsch(stack_interface_phy_lte::dl_sched_grant_t* grants, u
 {
   /* Scales the Resources Elements affected by the power allocation (p_b) */
   // srsran_enb_dl_prepare_power_allocation(&enb_dl);
+  pdsch_jobs.clear();
   for (uint32_t i = 0; i < nof_grants; i++) {
     uint16_t rnti = grants[i].dci.rnti;
 
     if (rnti && ue_db.count(rnti)) {
-      srsran_dl_cfg_t dl_cfg = {};
+      pdsch_jobs.emplace_back();
+      pdsch_job_t&     job    = pdsch_jobs.back();
+      srsran_dl_cfg_t& dl_cfg = job.dl_cfg;
 
       if (phy->ue_db.get_dl_config(rnti, cc_idx, dl_cfg) < SRSRAN_SUCCESS) {
         Error("Error retrieving DCI DL configuration for RNTI %x, CC %d", grants[i].dci.rnti, cc_idx);
+        pdsch_jobs.pop_back();
         continue;
       }
 
@@ -584,6 +708,7 @@ int cc_worker::encode_pdsch(stack_interface_phy_lte::dl_sched_grant_t* grants, u
       if (srsran_ra_dl_dci_to_grant(
               &enb_dl.cell, &dl_sf, dl_cfg.tm, dl_cfg.pdsch.use_tbs_index_alt, &grants[i].dci, &dl_cfg.pdsch.grant)) {
         Error("Computing DL grant");
+        pdsch_jobs.pop_back();
         continue;
       }
 
@@ -591,31 +716,41 @@ int cc_worker::encode_pdsch(stack_interface_phy_lte::dl_sched_grant_t* grants, u
       for (uint32_t j = 0; j < SRSRAN_MAX_CODEWORDS; j++) {
         dl_cfg.pdsch.softbuffers.tx[j] = grants[i].softbuffer_tx[j];
       }
+      job.grant_idx = i;
+      job.grant     = &grants[i];
+    } else {
+      Error("User rnti=0x%x not found in cc_worker=%d", rnti, cc_idx);
+    }
+  }
 
-      // Encode PDSCH
-      if (srsran_enb_dl_put_pdsch(&enb_dl, &dl_cfg.pdsch, grants[i].data)) {
-        Error("Error putting PDSCH %d", i);
-        return SRSRAN_ERROR;
-      }
+  // Encode the PDSCH of different users in parallel, they are mapped to disjoint resource elements
+  uint32_t nof_lanes = std::min((uint32_t)pdsch_jobs.size(), (uint32_t)pdsch_lanes.size() + 1);
+  next_pdsch_job     = 0;
+  phy->parallel_for(nof_lanes, [this](uint32_t lane_idx) { encode_pdsch_lane(lane_idx); });
 
-      // Save pending ACK
-      if (SRSRAN_RNTI_ISUSER(rnti)) {
-        // Push whole DCI
-        phy->ue_db.set_ack_pending(tti_tx_ul, cc_idx, grants[i].dci);
-      }
+  for (pdsch_job_t& job : pdsch_jobs) {
+    uint16_t rnti = job.grant->dci.rnti;
 
-      if (LOG_THIS(rnti) and logger.info.enabled()) {
-        // Logging
-        char str[512];
-        srsran_pdsch_tx_info(&dl_cfg.pdsch, str, 512);
-        logger.info("PDSCH: cc=%d, %s, tti_tx_dl=%d", cc_idx, str, tti_tx_dl);
-      }
+    if (not job.encoded) {
+      Error("Error putting PDSCH %d", job.grant_idx);
+      return SRSRAN_ERROR;
+    }
 
-      // Save metrics stats
-      ue_db[rnti]->metrics_dl(grants[i].dci.tb[0].mcs_idx);
-    } else {
-      Error("User rnti=0x%x not found in cc_worker=%d", rnti, cc_idx);
+    // Save pending ACK
+    if (SRSRAN_RNTI_ISUSER(rnti)) {
+      // Push whole DCI
+      phy->ue_db.set_ack_pending(tti_tx_ul, cc_idx, job.grant->dci);
+    }
+
+    if (LOG_THIS(rnti) and logger.info.enabled()) {
+      // Logging
+      char str[512];
+      srsran_pdsch_tx_info(&job.dl_cfg.pdsch, str, 512);
+      logger.info("PDSCH: cc=%d, %s, tti_tx_dl=%d", cc_idx, str, tti_tx_dl);
     }
+
+    // Save metrics stats
+    ue_db[rnti]->metrics_dl(job.grant->dci.tb[0].mcs_idx);
   }
 
   // srsran_enb_dl_apply_power_allocation(&enb_dl);
@@ -623,6 +758,22 @@ int cc_worker::encode_pdsch(stack_interface_phy_lte::dl_sched_grant_t* grants, u
   return SRSRAN_SUCCESS;
 }
 
+void cc_worker::encode_pdsch_lane(uint32_t lane_idx)
+{
+  // Take jobs until there are none left, only the lane encoder, the job and the job resource elements are written
+  for (uint32_t i = next_pdsch_job++; i < pdsch_jobs.size(); i = next_pdsch_job++) {
+    pdsch_job_t& job = pdsch_jobs[i];
+
+    int ret = SRSRAN_ERROR;
+    if (lane_idx == 0) {
+      ret = srsran_enb_dl_put_pdsch(&enb_dl, &job.dl_cfg.pdsch, job.grant->data);
+    } else {
+      ret = srsran_enb_dl_put_pdsch_lane(&enb_dl, pdsch_lanes[lane_idx - 1].get(), &job.dl_cfg.pdsch, job.grant->data);
+    }
+    job.encoded = (ret == SRSRAN_SUCCESS);
+  }
+}
+
 /************ METRICS interface ********************/
 uint32_t cc_worker::get_metrics(std::vector<phy_metrics_t>& metrics)
 {
@@ -638,6 +789,13 @@ uint32_t cc_worker::get_metrics(std::vector<phy_metrics_t>& metrics)
   return cnt;
 }
 
+void cc_worker::get_timing_metrics(phy_timing_metrics_t& metrics)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  metrics.merge(timing);
+  timing = {};
+}
+
 void cc_worker::ue::metrics_read(phy_metrics_t* metrics_)
 {
   if (metrics_) {
@@ -23,6 +23,7 @@
 #include "srsran/srsran.h"
 
 #include "srsenb/hdr/phy/lte/sf_worker.h"
+#include <chrono>
 
 #define Error(fmt, ...)                                                                                                \
   if (SRSRAN_DEBUG_ENABLED)                                                                                            \
@@ -188,10 +189,11 @@ void sf_worker::work_imp()
     Info("Failed setting UL grants. Some grant's RNTI does not exist.");
   }
 
-  // Process UL
-  for (uint32_t cc = 0; cc < cc_workers.size(); cc++) {
-    cc_workers[cc]->work_ul(ul_sf, ul_grants[cc]);
-  }
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+  // Process UL, the carriers run in parallel if the PHY task threads are enabled
+  phy->parallel_for(cc_workers.size(),
+                    [this, &ul_sf, &ul_grants](uint32_t cc) { cc_workers[cc]->work_ul(ul_sf, ul_grants[cc]); });
 
   // Get DL scheduling for the TX TTI from MAC
   if (sf_type == SRSRAN_SF_NORM) {
@@ -224,15 +226,17 @@ void sf_worker::work_imp()
   // Prepare for receive ACK for DL grants in t_tx_dl+4
   phy->ue_db.clear_tti_pending_ack(tti_tx_ul);
 
-  // Process DL
-  for (uint32_t cc = 0; cc < cc_workers.size(); cc++) {
+  // Process DL, the carriers run in parallel if the PHY task threads are enabled
+  phy->parallel_for(cc_workers.size(), [this, &dl_sf, &dl_grants, &ul_grants_tx, &mbsfn_cfg](uint32_t cc) {
+    srsran_dl_sf_cfg_t cc_dl_sf = dl_sf;
+
     // Select CFI and make sure it is in the right range
-    dl_sf.cfi = dl_grants[cc].cfi;
-    dl_sf.cfi = SRSRAN_MAX(dl_sf.cfi, 1);
-    dl_sf.cfi = SRSRAN_MIN(dl_sf.cfi, 3);
+    cc_dl_sf.cfi = dl_grants[cc].cfi;
+    cc_dl_sf.cfi = SRSRAN_MAX(cc_dl_sf.cfi, 1);
+    cc_dl_sf.cfi = SRSRAN_MIN(cc_dl_sf.cfi, 3);
 
-    cc_workers[cc]->work_dl(dl_sf, dl_grants[cc], ul_grants_tx[cc], &mbsfn_cfg);
-  }
+    cc_workers[cc]->work_dl(cc_dl_sf, dl_grants[cc], ul_grants_tx[cc], &mbsfn_cfg);
+  });
 
   // Save grants
   phy->set_ul_grants(tti_tx_ul, ul_grants_tx);
@@ -244,6 +248,11 @@ void sf_worker::work_imp()
     }
   }
 
+  {
+    std::lock_guard<std::mutex> timing_lock(timing_mutex);
+    total_time.add(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - t_start).count());
+  }
+
   Debug("Sending to radio");
   phy->worker_end(context, true, tx_buffer);
 
@@ -293,6 +302,17 @@ uint32_t sf_worker::get_metrics(std::vector<phy_metrics_t>& metrics)
   return cnt;
 }
 
+void sf_worker::get_timing_metrics(phy_timing_metrics_t& metrics)
+{
+  for (auto& w : cc_workers) {
+    w->get_timing_metrics(metrics);
+  }
+
+  std::lock_guard<std::mutex> lock(timing_mutex);
+  metrics.total.merge(total_time);
+  total_time = {};
+}
+
 void sf_worker::start_plot()
 {
 #ifdef ENABLE_GUI
@@ -275,6 +275,14 @@ void phy::get_metrics(std::vector<phy_metrics_t>& metrics)
   }
 }
 
+void phy::get_timing_metrics(phy_timing_metrics_t& metrics)
+{
+  metrics = {};
+  for (uint32_t i = 0; i < nof_workers; i++) {
+    lte_workers[i]->get_timing_metrics(metrics);
+  }
+}
+
 void phy::cmd_cell_gain(uint32_t cell_id, float gain_db)
 {
   Info("set_cell_gain: cell_id=%d, gain_db=%.2f", cell_id, gain_db);
@@ -31,6 +31,11 @@ using namespace asn1::rrc;
 
 namespace srsenb {
 
+phy_common::~phy_common()
+{
+  srsran_sch_decoder_pool_free(&pusch_decoder_pool);
+}
+
 void phy_common::reset()
 {
   for (auto& q : ul_grants) {
@@ -61,6 +66,19 @@ bool phy_common::init(const phy_cell_cfg_list_t&    cell_list_,
     dl_channel->set_signal_power_dBfs(srsran_enb_dl_get_maximum_signal_power_dBfs(cell_list_lte[0].cell.nof_prb));
   }
 
+  // Create PUSCH decoder threads
+  if (params.nof_pusch_dec_threads > 0) {
+    if (srsran_sch_decoder_pool_init(&pusch_decoder_pool, params.nof_pusch_dec_threads) < SRSRAN_SUCCESS) {
+      srslog::fetch_basic_logger("PHY").error("Error initiating PUSCH decoder pool");
+      return false;
+    }
+  }
+
+  // Create PHY task threads
+  if (params.nof_phy_task_threads > 0) {
+    task_pool.reset(new srsran::task_thread_pool(params.nof_phy_task_threads));
+  }
+
   // Create grants
   for (auto& q : ul_grants) {
     q.resize(cell_list_lte.size());
@@ -80,6 +98,20 @@ bool phy_common::init(const phy_cell_cfg_list_t&    cell_list_,
 void phy_common::stop()
 {
   semaphore.wait_all();
+  if (task_pool != nullptr) {
+    task_pool->stop();
+  }
+}
+
+void phy_common::parallel_for(uint32_t nof_items, const std::function<void(uint32_t)>& func)
+{
+  if (task_pool == nullptr) {
+    for (uint32_t i = 0; i < nof_items; i++) {
+      func(i);
+    }
+    return;
+  }
+  srsran::parallel_for(*task_pool, nof_items, func);
 }
 
 void phy_common::clear_grants(uint16_t rnti)
@@ -35,7 +35,7 @@ class gtpu_pdcp_adapter final : public gtpu_interface_pdcp, public pdcp_interfac
 {
 public:
   gtpu_pdcp_adapter(srslog::basic_logger& logger_,
-                    pdcp*                 pdcp_lte,
+                    pdcp_interface_gtpu*  pdcp_lte,
                     pdcp_interface_gtpu*  pdcp_x2,
                     gtpu*                 gtpu_,
                     enb_bearer_manager&   bearers_) :
@@ -64,6 +64,18 @@ public:
       logger.warning("Can't deliver SDU for EPS bearer %d. Dropping it.", eps_bearer_id);
     }
   }
+  void write_sdus(uint16_t rnti, uint32_t eps_bearer_id, srsran::span<srsran::unique_byte_buffer_t> sdus) override
+  {
+    auto bearer = bearers->get_radio_bearer(rnti, eps_bearer_id);
+    // route the burst to the PDCP entity
+    if (bearer.rat == srsran_rat_t::lte) {
+      pdcp_obj->write_sdus(rnti, bearer.lcid, sdus);
+    } else if (bearer.rat == srsran_rat_t::nr) {
+      pdcp_x2_obj->write_sdus(rnti, bearer.lcid, sdus);
+    } else {
+      logger.warning("Can't deliver %zd SDUs for EPS bearer %d. Dropping them.", sdus.size(), eps_bearer_id);
+    }
+  }
   std::map<uint32_t, srsran::unique_byte_buffer_t> get_buffered_pdus(uint16_t rnti, uint32_t eps_bearer_id) override
   {
     auto bearer = bearers->get_radio_bearer(rnti, eps_bearer_id);
@@ -80,7 +92,7 @@ public:
 private:
   srslog::basic_logger& logger;
   gtpu*                 gtpu_obj    = nullptr;
-  pdcp*                 pdcp_obj    = nullptr;
+  pdcp_interface_gtpu*  pdcp_obj    = nullptr;
   pdcp_interface_gtpu*  pdcp_x2_obj = nullptr;
   enb_bearer_manager*   bearers     = nullptr;
 };
@@ -178,17 +190,34 @@ int enb_stack_lte::init(const stack_args_t&      args_,
     x2_task_queue = task_sched.make_task_queue();
   }
 
+  // PDCP and UL RLC of the UEs run in the stack thread, unless they are sharded across user-plane workers
+  pdcp_interface_rlc*  pdcp_rlc  = &pdcp;
+  pdcp_interface_rrc*  pdcp_rrc  = &pdcp;
+  pdcp_interface_gtpu* pdcp_gtpu = &pdcp;
+  rlc_interface_mac*   rlc_mac   = &rlc;
+  if (args.nof_user_plane_workers > 0) {
+    pdcp_pool.reset(new pdcp_workers(&task_sched, pdcp_logger, args.nof_user_plane_workers));
+    pdcp_rlc  = pdcp_pool.get();
+    pdcp_rrc  = pdcp_pool.get();
+    pdcp_gtpu = pdcp_pool.get();
+    rlc_mac   = pdcp_pool->get_rlc_mac_itf();
+  }
+
   // setup bearer managers
-  gtpu_adapter.reset(new gtpu_pdcp_adapter(stack_logger, &pdcp, x2_, &gtpu, bearers));
+  gtpu_adapter.reset(new gtpu_pdcp_adapter(stack_logger, pdcp_gtpu, x2_, &gtpu, bearers));
 
   // Init all LTE layers
-  if (!mac.init(args.mac, rrc_cfg.cell_list, phy, &rlc, &rrc)) {
+  if (!mac.init(args.mac, rrc_cfg.cell_list, phy, rlc_mac, &rrc)) {
     stack_logger.error("Couldn't initialize MAC");
     return SRSRAN_ERROR;
   }
-  rlc.init(&pdcp, &rrc, &mac, task_sched.get_timer_handler());
-  pdcp.init(&rlc, &rrc, gtpu_adapter.get());
-  if (rrc.init(rrc_cfg, phy, &mac, &rlc, &pdcp, &s1ap, &gtpu, x2_) != SRSRAN_SUCCESS) {
+  rlc.init(pdcp_rlc, &rrc, &mac, task_sched.get_timer_handler());
+  if (pdcp_pool != nullptr) {
+    pdcp_pool->init(&rlc, &rrc, gtpu_adapter.get(), &rlc);
+  } else {
+    pdcp.init(&rlc, &rrc, gtpu_adapter.get());
+  }
+  if (rrc.init(rrc_cfg, phy, &mac, &rlc, pdcp_rrc, &s1ap, &gtpu, x2_) != SRSRAN_SUCCESS) {
     stack_logger.error("Couldn't initialize RRC");
     return SRSRAN_ERROR;
   }
@@ -225,6 +254,9 @@ void enb_stack_lte::tti_clock()
 void enb_stack_lte::tti_clock_impl()
 {
   task_sched.tic();
+  if (pdcp_pool != nullptr) {
+    pdcp_pool->tic();
+  }
   rrc.tti_clock();
 }
 
@@ -245,6 +277,9 @@ void enb_stack_lte::stop_impl()
   mac.stop();
   rlc.stop();
   pdcp.stop();
+  if (pdcp_pool != nullptr) {
+    pdcp_pool->stop();
+  }
   rrc.stop();
 
   if (args.mac_pcap.enable) {
@@ -273,10 +308,17 @@ bool enb_stack_lte::get_metrics(stack_metrics_t* metrics)
     mac.get_metrics(metrics.mac);
     if (not metrics.mac.ues.empty()) {
       rlc.get_metrics(metrics.rlc, metrics.mac.ues[0].nof_tti);
-      pdcp.get_metrics(metrics.pdcp, metrics.mac.ues[0].nof_tti);
+      if (pdcp_pool != nullptr) {
+        pdcp_pool->get_metrics(metrics.pdcp, metrics.mac.ues[0].nof_tti);
+      } else {
+        pdcp.get_metrics(metrics.pdcp, metrics.mac.ues[0].nof_tti);
+      }
     }
     rrc.get_metrics(metrics.rrc);
     s1ap.get_metrics(metrics.s1ap);
+    for (size_t i = 0; i < metrics.byte_buffer_pool.size(); ++i) {
+      metrics.byte_buffer_pool[i] = srsran::byte_buffer_pool::get_instance()->get_metrics((srsran::byte_buffer_class_t)i);
+    }
     if (not pending_stack_metrics.try_push(metrics)) {
       stack_logger.error("Unable to push metrics to queue");
     }
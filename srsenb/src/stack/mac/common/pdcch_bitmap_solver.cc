@@ -0,0 +1,203 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/common/pdcch_bitmap_solver.h"
+#include "srsran/support/srsran_assert.h"
+#include <algorithm>
+#include <numeric>
+
+namespace srsenb {
+
+bool pdcch_bitmap_solver::bitmap_t::collides(const candidate_t& cand, uint32_t L) const
+{
+  uint64_t mask   = (1ULL << L) - 1;
+  uint32_t word   = cand.ncce / 64;
+  uint32_t offset = cand.ncce % 64;
+  if ((cces[word] & (mask << offset)) != 0) {
+    return true;
+  }
+  if (offset + L > 64 and (cces[word + 1] & (mask >> (64 - offset))) != 0) {
+    // CCE positions are multiples of L in both LTE and NR, so this should not happen in practice
+    return true;
+  }
+  return cand.uci_res >= 0 and (uci[cand.uci_res / 64] & (1ULL << (cand.uci_res % 64))) != 0;
+}
+
+void pdcch_bitmap_solver::bitmap_t::set(const candidate_t& cand, uint32_t L)
+{
+  uint64_t mask   = (1ULL << L) - 1;
+  uint32_t word   = cand.ncce / 64;
+  uint32_t offset = cand.ncce % 64;
+  cces[word] |= mask << offset;
+  if (offset + L > 64) {
+    cces[word + 1] |= mask >> (64 - offset);
+  }
+  if (cand.uci_res >= 0) {
+    uci[cand.uci_res / 64] |= 1ULL << (cand.uci_res % 64);
+  }
+}
+
+void pdcch_bitmap_solver::clear()
+{
+  dcis.clear();
+  prefix_bitmaps.clear();
+  prefix_bitmaps.push_back(bitmap_t{});
+  remaining_budget = total_search_budget;
+  last_nof_visited = 0;
+}
+
+bool pdcch_bitmap_solver::push_unsolved(uint32_t aggr_idx, const candidate_list& cands)
+{
+  srsran_assert(aggr_idx <= 4, "Invalid DCI aggregation level=%d", 1U << aggr_idx);
+  if (dcis.full()) {
+    return false;
+  }
+  dcis.emplace_back();
+  dci_entry& dci = dcis.back();
+  dci.L          = 1U << aggr_idx;
+  dci.pos_idx    = 0;
+  set_candidates(dcis.size() - 1, cands);
+  return true;
+}
+
+void pdcch_bitmap_solver::set_candidates(size_t dci_idx, const candidate_list& cands)
+{
+  dci_entry& dci = dcis[dci_idx];
+  dci.cands      = cands;
+  for (const candidate_t& cand : cands) {
+    srsran_assert(cand.ncce + dci.L <= MAX_NOF_CCES and cand.uci_res < (int32_t)MAX_NOF_UCI_RES,
+                  "Invalid PDCCH candidate ncce=%d",
+                  cand.ncce);
+  }
+}
+
+bool pdcch_bitmap_solver::push(uint32_t aggr_idx, const candidate_list& cands)
+{
+  srsran_assert(prefix_bitmaps.size() == dcis.size() + 1, "solve() must be called before adding DCIs with push()");
+  if (not push_unsolved(aggr_idx, cands)) {
+    return false;
+  }
+
+  // First fit in the CCEs left free by the other DCIs
+  dci_entry&      dci         = dcis.back();
+  const bitmap_t& occupied    = prefix_bitmaps.back();
+  uint32_t        nof_visited = 0;
+  for (; dci.pos_idx < dci.cands.size(); ++dci.pos_idx) {
+    nof_visited++;
+    if (not occupied.collides(dci.cands[dci.pos_idx], dci.L)) {
+      prefix_bitmaps.push_back(occupied);
+      prefix_bitmaps.back().set(dci.cands[dci.pos_idx], dci.L);
+      last_nof_visited = nof_visited;
+      return true;
+    }
+  }
+
+  // Move the other DCIs to make space
+  bool success = solve();
+  last_nof_visited += nof_visited;
+  if (not success) {
+    dcis.pop_back();
+  }
+  return success;
+}
+
+bool pdcch_bitmap_solver::solve()
+{
+  size_t   nof_dcis = dcis.size();
+  uint32_t budget   = std::min(search_budget, remaining_budget);
+  last_nof_visited  = 0;
+  if (budget < nof_dcis) {
+    // Not enough budget to visit even a single candidate per DCI
+    return false;
+  }
+
+  // Search most constrained DCIs first, i.e. the ones with fewer candidates and higher aggregation level
+  std::array<uint32_t, MAX_NOF_DCIS> order;
+  std::iota(order.begin(), order.begin() + nof_dcis, 0);
+  std::sort(order.begin(), order.begin() + nof_dcis, [this](uint32_t lhs, uint32_t rhs) {
+    if (dcis[lhs].cands.size() != dcis[rhs].cands.size()) {
+      return dcis[lhs].cands.size() < dcis[rhs].cands.size();
+    }
+    if (dcis[lhs].L != dcis[rhs].L) {
+      return dcis[lhs].L > dcis[rhs].L;
+    }
+    return lhs < rhs;
+  });
+
+  // Bounded backtracking search
+  std::array<uint32_t, MAX_NOF_DCIS + 1> choice;
+  std::array<bitmap_t, MAX_NOF_DCIS + 1> occupied;
+  size_t                                 depth = 0;
+  occupied[0]                                  = bitmap_t{};
+  choice[0]                                    = 0;
+  while (depth < nof_dcis) {
+    const dci_entry& dci = dcis[order[depth]];
+    uint32_t&        idx = choice[depth];
+    for (; idx < dci.cands.size(); ++idx) {
+      if (last_nof_visited == budget) {
+        remaining_budget -= budget;
+        return false;
+      }
+      last_nof_visited++;
+      if (not occupied[depth].collides(dci.cands[idx], dci.L)) {
+        break;
+      }
+    }
+    if (idx < dci.cands.size()) {
+      occupied[depth + 1] = occupied[depth];
+      occupied[depth + 1].set(dci.cands[idx], dci.L);
+      depth++;
+      choice[depth] = 0;
+    } else {
+      if (depth == 0) {
+        remaining_budget -= last_nof_visited;
+        return false;
+      }
+      depth--;
+      choice[depth]++;
+    }
+  }
+
+  remaining_budget -= last_nof_visited;
+
+  // Store solution in DCI order
+  for (size_t i = 0; i < nof_dcis; ++i) {
+    dcis[order[i]].pos_idx = choice[i];
+  }
+  prefix_bitmaps.resize(1);
+  prefix_bitmaps[0] = bitmap_t{};
+  for (const dci_entry& dci : dcis) {
+    prefix_bitmaps.push_back(prefix_bitmaps.back());
+    prefix_bitmaps.back().set(dci.cands[dci.pos_idx], dci.L);
+  }
+  return true;
+}
+
+void pdcch_bitmap_solver::pop()
+{
+  srsran_assert(not dcis.empty(), "%s called when no DCIs have been allocated", __FUNCTION__);
+  dcis.pop_back();
+  if (prefix_bitmaps.size() > dcis.size() + 1) {
+    prefix_bitmaps.pop_back();
+  }
+}
+
+} // namespace srsenb
@@ -79,10 +79,12 @@ bool mac::init(const mac_args_t&        args_,
     srsran_softbuffer_tx_init(&cc.rar_softbuffer_tx, args.nof_prb);
   }
 
-  // Initiate common pool of softbuffers
-  uint32_t nof_prb          = args.nof_prb;
-  auto     init_softbuffers = [nof_prb](void* ptr) {
-    new (ptr) ue_cc_softbuffers(nof_prb, SRSRAN_FDD_NOF_HARQ, SRSRAN_FDD_NOF_HARQ);
+  // Initiate common pool of softbuffers. Their code blocks are attached on demand from a pool shared by all UEs
+  softbuffer_cbs.reset(new softbuffer_cb_pool(args.pusch_8bit_decoder, (size_t)args.max_softbuffer_mem_mb << 20U));
+  softbuffer_cb_pool* cb_pool          = softbuffer_cbs.get();
+  uint32_t            nof_prb          = args.nof_prb;
+  auto                init_softbuffers = [cb_pool, nof_prb](void* ptr) {
+    new (ptr) ue_cc_softbuffers(*cb_pool, nof_prb, SRSRAN_FDD_NOF_HARQ, SRSRAN_FDD_NOF_HARQ);
   };
   auto recycle_softbuffers = [](ue_cc_softbuffers& softbuffers) { softbuffers.clear(); };
   softbuffer_pool.reset(new srsran::background_obj_pool<ue_cc_softbuffers>(
@@ -100,6 +102,7 @@ void mac::stop()
   if (started) {
     started = false;
 
+    scheduler.stop();
     ue_db.clear();
     for (auto& cc : common_buffers) {
       for (int i = 0; i < NOF_BCCH_DLSCH_MSG; i++) {
@@ -257,6 +260,7 @@ void mac::get_metrics(mac_metrics_t& metrics)
     metrics.cc_info[cc].cc_rach_counter = detected_rachs[cc];
     metrics.cc_info[cc].pci             = (cc < cell_config.size()) ? cell_config[cc].cell.id : 0;
   }
+  metrics.softbuffers = softbuffer_cbs->get_metrics();
 }
 
 void mac::toggle_padding()
@@ -293,6 +297,11 @@ int mac::ack_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint32_t
   int nof_bytes = scheduler.dl_ack_info(tti_rx, rnti, enb_cc_idx, tb_idx, ack);
   ue_db[rnti]->metrics_tx(ack, nof_bytes);
 
+  // The TB will not be retransmitted
+  if (ack) {
+    ue_db[rnti]->release_tx_softbuffer(enb_cc_idx, tti_rx, tb_idx);
+  }
+
   rrc_h->set_radiolink_dl_state(rnti, ack);
 
   return SRSRAN_SUCCESS;
@@ -310,6 +319,11 @@ int mac::crc_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint32_t
   ue_db[rnti]->set_tti(tti_rx);
   ue_db[rnti]->metrics_rx(crc, nof_bytes);
 
+  // The TB will not be retransmitted
+  if (crc) {
+    ue_db[rnti]->release_rx_softbuffer(enb_cc_idx, tti_rx);
+  }
+
   rrc_h->set_radiolink_ul_state(rnti, crc);
 
   // Scheduler uses eNB's CC mapping
@@ -628,7 +642,12 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
 
         for (uint32_t tb = 0; tb < SRSRAN_MAX_TB; tb++) {
           dl_sched_res->pdsch[n].softbuffer_tx[tb] =
-              ue_db[rnti]->get_tx_softbuffer(enb_cc_idx, sched_result.data[i].dci.pid, tb);
+              ue_db[rnti]->get_tx_softbuffer(enb_cc_idx,
+                                             sched_result.data[i].dci.pid,
+                                             tb,
+                                             sched_result.data[i].tbs[tb] * 8,
+                                             sched_result.data[i].nof_pdu_elems[tb] > 0,
+                                             tti_tx_dl);
 
           // If the Rx soft-buffer is not given, abort transmission
           if (dl_sched_res->pdsch[n].softbuffer_tx[tb] == nullptr) {
@@ -937,17 +956,15 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
           phy_ul_sched_res->pusch[n].pid           = TTI_RX(tti_tx_ul) % SRSRAN_FDD_NOF_HARQ;
           phy_ul_sched_res->pusch[n].needs_pdcch   = sched_result.pusch[i].needs_pdcch;
           phy_ul_sched_res->pusch[n].dci           = sched_result.pusch[i].dci;
-          phy_ul_sched_res->pusch[n].softbuffer_rx = ue_db[rnti]->get_rx_softbuffer(enb_cc_idx, tti_tx_ul);
+          // The softbuffer is reset for a new transmission
+          phy_ul_sched_res->pusch[n].softbuffer_rx = ue_db[rnti]->get_rx_softbuffer(
+              enb_cc_idx, tti_tx_ul, sched_result.pusch[i].tbs * 8, sched_result.pusch[i].current_tx_nb == 0);
 
           // If the Rx soft-buffer is not given, abort reception
           if (phy_ul_sched_res->pusch[n].softbuffer_rx == nullptr) {
             logger.warning("Failed to retrieve UL softbuffer for tti=%d, cc=%d", tti_tx_ul, enb_cc_idx);
             continue;
           }
-
-          if (sched_result.pusch[n].current_tx_nb == 0) {
-            srsran_softbuffer_rx_reset_tbs(phy_ul_sched_res->pusch[n].softbuffer_rx, sched_result.pusch[i].tbs * 8);
-          }
           phy_ul_sched_res->pusch[n].data =
               ue_db[rnti]->request_buffer(tti_tx_ul, enb_cc_idx, sched_result.pusch[i].tbs);
           if (phy_ul_sched_res->pusch[n].data) {
@@ -35,7 +35,8 @@ coreset_region::coreset_region(const bwp_params_t& bwp_cfg_,
   slot_idx(slot_idx_),
   pdcch_dl_list(dl_list_),
   pdcch_ul_list(ul_list_),
-  rar_cce_list(bwp_cfg_.rar_cce_list)
+  rar_cce_list(bwp_cfg_.rar_cce_list),
+  use_bitmap(bwp_cfg_.sched_cfg.pdcch_alloc_algo == "bitmap")
 {
   const bool* res_active = &coreset_cfg->freq_resources[0];
   nof_freq_res           = std::count(res_active, res_active + SRSRAN_CORESET_FREQ_DOMAIN_RES_SIZE, true);
@@ -51,6 +52,7 @@ void coreset_region::reset()
 {
   dfs_tree.clear();
   saved_dfs_tree.clear();
+  bitmap_solver.clear();
   dci_list.clear();
   pdcch_dl_list.clear();
   pdcch_ul_list.clear();
@@ -66,7 +68,6 @@ bool coreset_region::alloc_dci(pdcch_grant_type_t alloc_type,
                     (alloc_type == pdcch_grant_type_t::dl_data or alloc_type == pdcch_grant_type_t::ul_data),
                 "UE should be only provided for DL or UL data allocations");
   srsran_assert(not dci_list.full(), "SCHED: Unable to allocate DCI");
-  saved_dfs_tree.clear();
 
   alloc_record record;
   record.ue         = user;
@@ -81,13 +82,30 @@ bool coreset_region::alloc_dci(pdcch_grant_type_t alloc_type,
     pdcch_dl_list.emplace_back();
   }
 
+  bool success = use_bitmap ? alloc_bitmap(record) : alloc_dfs(record);
+  if (success) {
+    // DCI record allocation successful
+    dci_list.push_back(record);
+    return true;
+  }
+
+  // Revert steps to initial state, before dci record allocation was attempted
+  if (record.alloc_type == pdcch_grant_type_t::ul_data) {
+    pdcch_ul_list.pop_back();
+  } else {
+    pdcch_dl_list.pop_back();
+  }
+  return false;
+}
+
+bool coreset_region::alloc_dfs(const alloc_record& record)
+{
+  saved_dfs_tree.clear();
+
   // Try to allocate grant. If it fails, attempt the same grant, but using a different permutation of past grant DCI
   // positions
   do {
-    bool success = alloc_dfs_node(record, 0);
-    if (success) {
-      // DCI record allocation successful
-      dci_list.push_back(record);
+    if (alloc_dfs_node(record, 0)) {
       return true;
     }
     if (saved_dfs_tree.empty()) {
@@ -95,22 +113,45 @@ bool coreset_region::alloc_dci(pdcch_grant_type_t alloc_type,
     }
   } while (get_next_dfs());
 
-  // Revert steps to initial state, before dci record allocation was attempted
   dfs_tree.swap(saved_dfs_tree);
-  if (record.alloc_type == pdcch_grant_type_t::ul_data) {
-    pdcch_ul_list.pop_back();
-  } else {
-    pdcch_dl_list.pop_back();
-  }
   return false;
 }
 
+bool coreset_region::alloc_bitmap(const alloc_record& record)
+{
+  pdcch_bitmap_solver::candidate_list cands;
+  for (uint32_t ncce : get_cce_loc_table(record)) {
+    pdcch_bitmap_solver::candidate_t cand;
+    cand.ncce = ncce;
+    cands.push_back(cand);
+  }
+  if (not bitmap_solver.push(record.aggr_idx, cands)) {
+    return false;
+  }
+
+  // Update the location of all DCIs, as the search may have moved the past DCIs
+  for (uint32_t i = 0; i < bitmap_solver.size(); ++i) {
+    const alloc_record&   dci_record = i < dci_list.size() ? dci_list[i] : record;
+    srsran_dci_location_t location   = {dci_record.aggr_idx, bitmap_solver.get_position(i).ncce};
+    if (dci_record.alloc_type == pdcch_grant_type_t::ul_data) {
+      pdcch_ul_list[dci_record.idx].dci.ctx.location = location;
+    } else {
+      pdcch_dl_list[dci_record.idx].dci.ctx.location = location;
+    }
+  }
+  return true;
+}
+
 void coreset_region::rem_last_dci()
 {
   srsran_assert(not dci_list.empty(), "%s called when no PDCCH have yet been allocated", __FUNCTION__);
 
   // Remove DCI record
-  dfs_tree.pop_back();
+  if (use_bitmap) {
+    bitmap_solver.pop();
+  } else {
+    dfs_tree.pop_back();
+  }
   if (dci_list.back().alloc_type == pdcch_grant_type_t::ul_data) {
     pdcch_ul_list.pop_back();
   } else {
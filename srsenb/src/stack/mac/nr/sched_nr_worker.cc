@@ -23,6 +23,9 @@
 #include "srsenb/hdr/stack/mac/common/mac_metrics.h"
 #include "srsenb/hdr/stack/mac/nr/sched_nr_signalling.h"
 #include "srsran/common/string_helpers.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace srsenb {
 namespace sched_nr_impl {
@@ -36,29 +39,68 @@ slot_cc_worker::slot_cc_worker(serv_cell_manager& cc_sched) :
 
 void slot_cc_worker::enqueue_cc_event(srsran::move_callback<void()> ev)
 {
-  std::lock_guard<std::mutex> lock(feedback_mutex);
-  pending_events.emplace_back();
-  pending_events.back() = std::move(ev);
+  // While the overflow queue is non-empty, new items go behind it, so that they are not run before older items
+  if (not overflow_pending.load(std::memory_order_acquire) and pending_events.try_push(std::move(ev))) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(overflow_mutex);
+  overflow_events.emplace_back();
+  overflow_events.back() = std::move(ev);
+  overflow_pending.store(true, std::memory_order_release);
 }
 
 void slot_cc_worker::enqueue_cc_feedback(uint16_t rnti, feedback_callback_t fdbk)
 {
-  std::lock_guard<std::mutex> lock(feedback_mutex);
-  pending_feedback.emplace_back();
-  pending_feedback.back().rnti = rnti;
-  pending_feedback.back().fdbk = std::move(fdbk);
+  feedback_t f;
+  f.rnti = rnti;
+  f.fdbk = std::move(fdbk);
+  if (not overflow_pending.load(std::memory_order_acquire) and pending_feedback.try_push(std::move(f))) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(overflow_mutex);
+  overflow_feedback.emplace_back();
+  overflow_feedback.back() = std::move(f);
+  overflow_pending.store(true, std::memory_order_release);
+}
+
+void slot_cc_worker::drain_feedback_rings()
+{
+  srsran::move_callback<void()> ev;
+  while (pending_events.try_pop(ev)) {
+    tmp_events_to_run.push_back(std::move(ev));
+  }
+  feedback_t fdbk;
+  while (pending_feedback.try_pop(fdbk)) {
+    tmp_feedback_to_run.push_back(std::move(fdbk));
+  }
 }
 
 void slot_cc_worker::run_feedback(ue_map_t& ue_db)
 {
-  {
-    std::lock_guard<std::mutex> lock(feedback_mutex);
-    tmp_feedback_to_run.swap(pending_feedback);
-    tmp_events_to_run.swap(pending_events);
+  drain_feedback_rings();
+  if (overflow_pending.load(std::memory_order_acquire)) {
+    // Slow path. The rings got full since the last slot.
+    // Producers stop pushing to the rings once the overflow queue is non-empty, but items pushed to the rings before
+    // the first overflowed item may have arrived after the drain above. Drain the rings again while holding the lock,
+    // so that those items are run before the overflowed ones.
+    std::lock_guard<std::mutex> lock(overflow_mutex);
+    drain_feedback_rings();
+    logger.info("SCHED: %zd feedback items of cc=%d did not fit in the feedback queue",
+                overflow_feedback.size() + overflow_events.size(),
+                cfg.cc);
+    for (srsran::move_callback<void()>& e : overflow_events) {
+      tmp_events_to_run.push_back(std::move(e));
+    }
+    for (feedback_t& fb : overflow_feedback) {
+      tmp_feedback_to_run.push_back(std::move(fb));
+    }
+    overflow_events.clear();
+    overflow_feedback.clear();
+    overflow_pending.store(false, std::memory_order_release);
   }
 
-  for (srsran::move_callback<void()>& ev : tmp_events_to_run) {
-    ev();
+  for (srsran::move_callback<void()>& e : tmp_events_to_run) {
+    e();
   }
   tmp_events_to_run.clear();
 
@@ -284,16 +326,13 @@ void sched_worker_manager::run_slot(slot_point slot_tx, uint32_t cc, dl_sched_re
   sched_dl_signalling(*serv_cell.bwps[0].cfg, slot_tx, bwp_slot.ssb, bwp_slot.nzp_csi_rs);
 
   // Synchronization point between CC workers, to avoid concurrency in UE state access
-  srsran::bounded_vector<std::condition_variable*, SRSRAN_MAX_CARRIERS> waiting_cvars;
-  {
-    std::unique_lock<std::mutex> lock(slot_mutex);
-    while (current_slot.valid() and current_slot != slot_tx) {
-      // Wait for previous slot to finish
-      cc_worker_list[cc]->waiting++;
-      cc_worker_list[cc]->cvar.wait(lock);
-      cc_worker_list[cc]->waiting--;
-    }
-    if (not current_slot.valid()) {
+  const uint32_t slot_prep_state = 2 * slot_tx.to_uint(), slot_run_state = slot_prep_state + 1;
+  uint32_t       state           = slot_state.load(std::memory_order_acquire);
+  while (state != slot_run_state) {
+    if (state == NO_SLOT) {
+      if (not slot_state.compare_exchange_strong(state, slot_prep_state)) {
+        continue;
+      }
       /* First Worker to start slot */
 
       // process non-cc specific feedback if pending for UEs with CA
@@ -305,20 +344,15 @@ void sched_worker_manager::run_slot(slot_point slot_tx, uint32_t cc, dl_sched_re
       }
       update_ue_db(slot_tx, true);
 
-      // mark the start of slot. awake remaining workers if locking on the mutex
-      current_slot = slot_tx;
+      // mark the start of slot. awake remaining workers if waiting
       worker_count.store(static_cast<int>(cc_worker_list.size()), std::memory_order_relaxed);
-      for (auto& w : cc_worker_list) {
-        if (w->waiting > 0) {
-          waiting_cvars.push_back(&w->cvar);
-        }
-      }
-      lock.unlock();
-      for (auto& w : waiting_cvars) {
-        w->notify_one();
-      }
-      waiting_cvars.clear();
+      slot_state.store(slot_run_state, std::memory_order_release);
+      notify_slot_state_change();
+      break;
     }
+    // Wait for previous slot to finish, or for the first worker of this slot to update the UEs with CA
+    wait_slot_state_change(state);
+    state = slot_state.load(std::memory_order_acquire);
   }
 
   /* Parallel Region */
@@ -330,27 +364,14 @@ void sched_worker_manager::run_slot(slot_point slot_tx, uint32_t cc, dl_sched_re
   cc_worker_list[cc]->worker.run(slot_tx, ue_db);
 
   // decrement the number of active workers
-  int rem_workers = worker_count.fetch_sub(1, std::memory_order_release) - 1;
+  int rem_workers = worker_count.fetch_sub(1, std::memory_order_acq_rel) - 1;
   srsran_assert(rem_workers >= 0, "invalid number of calls to run_slot(slot, cc)");
   if (rem_workers == 0) {
     /* Last Worker to finish slot */
 
     // Signal the release of slot if it is the last worker that finished its own generation
-    std::unique_lock<std::mutex> lock(slot_mutex);
-    current_slot = {};
-
-    // All the workers of the same slot have finished. Synchronize scheduling decisions with UEs state
-    for (auto& c : cc_worker_list) {
-      if (c->waiting > 0) {
-        waiting_cvars.push_back(&c->cvar);
-      }
-    }
-
-    // Awake waiting workers
-    lock.unlock();
-    for (auto& c : waiting_cvars) {
-      c->notify_one();
-    }
+    slot_state.store(NO_SLOT, std::memory_order_release);
+    notify_slot_state_change();
   }
 
   // Post-process and copy results to intermediate buffer
@@ -359,8 +380,59 @@ void sched_worker_manager::run_slot(slot_point slot_tx, uint32_t cc, dl_sched_re
 
 void sched_worker_manager::get_metrics(mac_metrics_t& metrics)
 {
-  std::unique_lock<std::mutex> lock(slot_mutex);
+  // Block the start of new slots while the UE metrics are read
+  uint32_t state = NO_SLOT;
+  while (not slot_state.compare_exchange_weak(state, EXCLUSIVE_STATE)) {
+    if (state != NO_SLOT) {
+      wait_slot_state_change(state);
+    }
+    state = NO_SLOT;
+  }
   get_metrics_nolocking(metrics);
+  slot_state.store(NO_SLOT, std::memory_order_release);
+  notify_slot_state_change();
+}
+
+/// Hint to the CPU that the thread is busy-waiting, so that it yields pipeline resources to the sibling hyperthread
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+void sched_worker_manager::wait_slot_state_change(uint32_t old_state)
+{
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex requires a plain 32-bit word");
+
+  // The other CC workers of a slot usually finish within a few microseconds
+  for (uint32_t i = 0; i < 1000; ++i) {
+    if (slot_state.load(std::memory_order_acquire) != old_state) {
+      return;
+    }
+    cpu_relax();
+  }
+  while (slot_state.load(std::memory_order_acquire) == old_state) {
+    // Pairs with the fence in notify_slot_state_change(). Either the notifier sees this sleeper, or the state change
+    // is seen here or by the futex check
+    nof_sleepers.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (slot_state.load(std::memory_order_relaxed) == old_state) {
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&slot_state), FUTEX_WAIT_PRIVATE, old_state, nullptr, nullptr, 0);
+    }
+    nof_sleepers.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+void sched_worker_manager::notify_slot_state_change()
+{
+  // The release store of slot_state must not be reordered with the load of nof_sleepers
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (nof_sleepers.load(std::memory_order_relaxed) > 0) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&slot_state), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+  }
 }
 
 bool sched_worker_manager::save_sched_result(slot_point      pdcch_slot,
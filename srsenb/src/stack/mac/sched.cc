@@ -25,7 +25,9 @@
 #include "srsenb/hdr/stack/mac/sched.h"
 #include "srsenb/hdr/stack/mac/sched_carrier.h"
 #include "srsenb/hdr/stack/mac/sched_helpers.h"
+#include "srsran/common/threads.h"
 #include "srsran/srslog/srslog.h"
+#include <condition_variable>
 
 #define Console(fmt, ...) srsran::console(fmt, ##__VA_ARGS__)
 #define Error(fmt, ...) srslog::fetch_basic_logger("MAC").error(fmt, ##__VA_ARGS__)
@@ -34,6 +36,70 @@ using srsran::tti_point;
 
 namespace srsenb {
 
+/*******************************************************
+ *
+ * Thread computing the scheduling decisions of the next TTIs while the PHY processes the current one
+ *
+ *******************************************************/
+
+class sched::lookahead_worker final : public srsran::thread
+{
+public:
+  explicit lookahead_worker(sched* parent_) : thread("SCHED_LOOKAHEAD"), parent(parent_) {}
+
+  void start_worker()
+  {
+    running = true;
+    start();
+  }
+
+  void stop_worker()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (not running) {
+        return;
+      }
+      running = false;
+    }
+    cvar.notify_one();
+    wait_thread_finish();
+  }
+
+  /// Request the generation of the scheduling decisions up to tti_rx
+  void push(tti_point tti_rx)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      target = tti_rx;
+    }
+    cvar.notify_one();
+  }
+
+private:
+  void run_thread() override
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+      if (not target.is_valid()) {
+        cvar.wait(lock);
+        continue;
+      }
+      tti_point tti_rx = target;
+      target           = tti_point{};
+      lock.unlock();
+      parent->run_lookahead(tti_rx);
+      lock.lock();
+    }
+  }
+
+  sched*                  parent;
+  std::mutex              mutex;
+  std::condition_variable cvar;
+  tti_point               target;
+  bool                    running = false;
+};
+
 /*******************************************************
  *
  * Initialization and sched configuration functions
@@ -42,7 +108,10 @@ namespace srsenb {
 
 sched::sched() {}
 
-sched::~sched() {}
+sched::~sched()
+{
+  stop();
+}
 
 void sched::init(rrc_interface_mac* rrc_, const sched_args_t& sched_cfg_)
 {
@@ -53,6 +122,22 @@ void sched::init(rrc_interface_mac* rrc_, const sched_args_t& sched_cfg_)
   carrier_schedulers.emplace_back(new carrier_sched{rrc, &ue_db, 0, &sched_results});
 
   reset();
+
+  if (sched_cfg.lookahead_tti > MAX_LOOKAHEAD_TTI) {
+    sched_cfg.lookahead_tti = MAX_LOOKAHEAD_TTI;
+    Error("SCHED: lookahead of %d TTIs not supported. Using %d", sched_cfg_.lookahead_tti, sched_cfg.lookahead_tti);
+  }
+  if (sched_cfg.lookahead_tti > 0) {
+    lookahead.reset(new lookahead_worker{this});
+    lookahead->start_worker();
+  }
+}
+
+void sched::stop()
+{
+  if (lookahead != nullptr) {
+    lookahead->stop_worker();
+  }
 }
 
 int sched::reset()
@@ -75,6 +160,12 @@ int sched::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg)
     if (not sched_cell_params[cc_idx].set_cfg(cc_idx, cell_cfg[cc_idx], sched_cfg)) {
       return SRSRAN_ERROR;
     }
+    if (sched_cfg.lookahead_tti >= cell_cfg[cc_idx].prach_rar_window) {
+      // RARs can only be allocated in TTIs that were not computed yet when the PRACH was detected
+      srslog::fetch_basic_logger("MAC").warning("SCHED: lookahead of %d TTIs does not fit in the RAR window of %d TTIs",
+                                                sched_cfg.lookahead_tti,
+                                                cell_cfg[cc_idx].prach_rar_window);
+    }
   }
 
   sched_results.set_nof_carriers(cell_cfg.size());
@@ -196,8 +287,12 @@ int sched::dl_ack_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint
 
 int sched::ul_crc_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, bool crc)
 {
-  return ue_db_access_locked(
-      rnti, [tti_rx, enb_cc_idx, crc](sched_ue& ue) { ue.set_ul_crc(tti_point{tti_rx}, enb_cc_idx, crc); });
+  return ue_db_access_locked(rnti, [this, tti_rx, enb_cc_idx, crc](sched_ue& ue) {
+    ue.set_ul_crc(tti_point{tti_rx}, enb_cc_idx, crc);
+    if (not crc and lookahead != nullptr) {
+      correct_ul_result(ue, tti_point{tti_rx}, enb_cc_idx);
+    }
+  });
 }
 
 int sched::dl_ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_value)
@@ -319,11 +414,17 @@ int sched::dl_sched(uint32_t tti_tx_dl, uint32_t enb_cc_idx, sched_interface::dl
   }
 
   tti_point tti_rx = tti_point{tti_tx_dl} - TX_ENB_DELAY;
+  phy_tti          = tti_rx;
+  // Fallback to inline scheduling, if the result was not computed ahead
   new_tti(tti_rx);
 
   // copy result
   sched_result = sched_results.get_sf(tti_rx)->get_cc(enb_cc_idx)->dl_sched_result;
 
+  if (lookahead != nullptr) {
+    lookahead->push(tti_rx + sched_cfg.lookahead_tti);
+  }
+
   return 0;
 }
 
@@ -340,6 +441,7 @@ int sched::ul_sched(uint32_t tti, uint32_t enb_cc_idx, srsenb::sched_interface::
 
   // Compute scheduling Result for tti_rx
   tti_point tti_rx = tti_point{tti} - TX_ENB_DELAY - FDD_HARQ_DELAY_DL_MS;
+  phy_tti          = tti_rx;
   new_tti(tti_rx);
 
   // copy result
@@ -355,13 +457,46 @@ void sched::new_tti(tti_point tti_rx)
 {
   last_tti = std::max(last_tti, tti_rx);
 
+  // The PHY only provides the UL CRCs of tti_rx right before requesting its scheduling result
+  bool ul_feedback_pending = lookahead != nullptr and tti_rx > phy_tti;
+
   // Generate sched results for all CCs, if not yet generated
   for (size_t cc_idx = 0; cc_idx < carrier_schedulers.size(); ++cc_idx) {
     if (not is_generated(tti_rx, cc_idx)) {
       // Generate carrier scheduling result
-      carrier_schedulers[cc_idx]->generate_tti_result(tti_rx);
+      carrier_schedulers[cc_idx]->generate_tti_result(tti_rx, ul_feedback_pending);
+    }
+  }
+}
+
+/// Generate the scheduling decisions of the TTIs following the last generated one, up to tti_rx. Called by the
+/// lookahead worker. The lock is released between TTIs, so that the PHY is not blocked behind several decisions
+void sched::run_lookahead(tti_point tti_rx)
+{
+  while (true) {
+    std::lock_guard<std::mutex> lock(sched_mutex);
+    if (not configured or not last_tti.is_valid() or last_tti >= tti_rx) {
+      return;
+    }
+    new_tti(last_tti + 1);
+  }
+}
+
+/// Apply a KO UL CRC that arrived after the decision for tti_rx was computed, assuming the PUSCH was decoded
+void sched::correct_ul_result(sched_ue& ue, tti_point tti_rx, uint32_t enb_cc_idx)
+{
+  if (not is_generated(tti_rx, enb_cc_idx)) {
+    return;
+  }
+  ul_sched_res_t&  ul_result = sched_results.get_sf(tti_rx)->get_cc(enb_cc_idx)->ul_sched_result;
+  ul_sched_data_t* pusch     = nullptr;
+  for (ul_sched_data_t& ul_data : ul_result.pusch) {
+    if (ul_data.dci.rnti == ue.get_rnti()) {
+      pusch = &ul_data;
+      break;
     }
   }
+  ue.revert_ul_ack(tti_rx, enb_cc_idx, pusch);
 }
 
 /// Check if TTI result is generated
@@ -22,6 +22,7 @@
 #include "srsenb/hdr/stack/mac/sched_carrier.h"
 #include "srsenb/hdr/stack/mac/sched_helpers.h"
 #include "srsenb/hdr/stack/mac/schedulers/sched_time_pf.h"
+#include "srsenb/hdr/stack/mac/schedulers/sched_time_pf_soa.h"
 #include "srsenb/hdr/stack/mac/schedulers/sched_time_rr.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/common/string_helpers.h"
@@ -364,6 +365,9 @@ void sched::carrier_sched::carrier_cfg(const sched_cell_params_t& cell_params_)
   if (cell_params_.sched_cfg->sched_policy == "time_rr") {
     sched_algo.reset(new sched_time_rr{*cc_cfg, *cell_params_.sched_cfg});
     logger.info("Using time-domain RR scheduling policy for cc=%d", cc_cfg->enb_cc_idx);
+  } else if (cell_params_.sched_cfg->sched_policy == "time_pf_soa") {
+    sched_algo.reset(new sched_time_pf_soa{*cc_cfg, *cell_params_.sched_cfg});
+    logger.info("Using vectorized time-domain PF scheduling policy for cc=%d", cc_cfg->enb_cc_idx);
   } else {
     sched_algo.reset(new sched_time_pf{*cc_cfg, *cell_params_.sched_cfg});
     logger.info("Using time-domain PF scheduling policy for cc=%d", cc_cfg->enb_cc_idx);
@@ -380,7 +384,7 @@ void sched::carrier_sched::set_dl_tti_mask(uint8_t* tti_mask, uint32_t nof_sfs)
   sf_dl_mask.assign(tti_mask, tti_mask + nof_sfs);
 }
 
-const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_rx)
+const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_rx, bool ul_feedback_pending)
 {
   sf_sched*        tti_sched = get_sf_sched(tti_rx);
   sf_sched_result* sf_result = prev_sched_results->get_sf(tti_rx);
@@ -393,6 +397,16 @@ const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_r
     user.second->new_subframe(tti_rx, enb_cc_idx);
   }
 
+  /* The UL CRCs of tti_rx are not known yet. Assume the PUSCHs were decoded, and revert it later in case of KO CRC */
+  if (ul_feedback_pending) {
+    for (auto& user : *ue_db) {
+      sched_ue_cell* cc_ue = user.second->find_ue_carrier(enb_cc_idx);
+      if (cc_ue != nullptr and cc_ue->cc_state() != cc_st::idle) {
+        cc_ue->harq_ent.assume_ul_ack(tti_rx);
+      }
+    }
+  }
+
   /* Schedule PHICH */
   for (auto& ue_pair : *ue_db) {
     if (tti_sched->alloc_phich(ue_pair.second.get()) == alloc_result::no_grant_space) {
@@ -40,6 +40,16 @@ void sf_cch_allocator::init(const sched_cell_params_t& cell_params_)
   dci_record_list.reserve(16);
   last_dci_dfs.reserve(16);
   temp_dci_dfs.reserve(16);
+
+  use_bitmap = cc_cfg->sched_cfg->pdcch_alloc_algo == "bitmap";
+  if (use_bitmap) {
+    // Precompute the PUCCH PRB used by the HARQ-ACK of each possible DCI starting CCE
+    cce_pucch_n_prb.resize(cc_cfg->nof_cce_table[MAX_CFI - 1]);
+    for (uint32_t ncce = 0; ncce < cce_pucch_n_prb.size(); ++ncce) {
+      pucch_cfg_common.n_pucch = ncce + pucch_cfg_common.N_pucch_1;
+      cce_pucch_n_prb[ncce]    = srsran_pucch_n_prb(&cc_cfg->cfg.cell, &pucch_cfg_common, 0);
+    }
+  }
 }
 
 void sf_cch_allocator::new_tti(tti_point tti_rx_)
@@ -48,6 +58,7 @@ void sf_cch_allocator::new_tti(tti_point tti_rx_)
 
   dci_record_list.clear();
   last_dci_dfs.clear();
+  bitmap_solver.clear();
   current_cfix     = cc_cfg->sched_cfg->min_nof_ctrl_symbols - 1;
   current_max_cfix = cc_cfg->sched_cfg->max_nof_ctrl_symbols - 1;
 }
@@ -72,7 +83,6 @@ sf_cch_allocator::get_cce_loc_table(alloc_type_t alloc_type, sched_ue* user, uin
 
 bool sf_cch_allocator::alloc_dci(alloc_type_t alloc_type, uint32_t aggr_idx, sched_ue* user, bool has_pusch_grant)
 {
-  temp_dci_dfs.clear();
   uint32_t start_cfix = current_cfix;
 
   alloc_record record;
@@ -97,18 +107,33 @@ bool sf_cch_allocator::alloc_dci(alloc_type_t alloc_type, uint32_t aggr_idx, sch
     }
   }
 
+  bool success = use_bitmap ? alloc_bitmap(record) : alloc_dfs(record);
+  if (not success) {
+    current_cfix = start_cfix;
+    return false;
+  }
+
+  // DCI record allocation successful
+  dci_record_list.push_back(record);
+  if (use_bitmap) {
+    update_bitmap_dci_nodes();
+  }
+
+  if (is_dl_ctrl_alloc(alloc_type)) {
+    // Dynamic CFI not yet supported for DL control allocations, as coderate can be exceeded
+    current_max_cfix = current_cfix;
+  }
+  return true;
+}
+
+bool sf_cch_allocator::alloc_dfs(const alloc_record& record)
+{
+  temp_dci_dfs.clear();
+
   // Try to allocate grant. If it fails, attempt the same grant, but using a different permutation of past grant DCI
   // positions
   do {
-    bool success = alloc_dfs_node(record, 0);
-    if (success) {
-      // DCI record allocation successful
-      dci_record_list.push_back(record);
-
-      if (is_dl_ctrl_alloc(alloc_type)) {
-        // Dynamic CFI not yet supported for DL control allocations, as coderate can be exceeded
-        current_max_cfix = current_cfix;
-      }
+    if (alloc_dfs_node(record, 0)) {
       return true;
     }
     if (temp_dci_dfs.empty()) {
@@ -118,7 +143,6 @@ bool sf_cch_allocator::alloc_dci(alloc_type_t alloc_type, uint32_t aggr_idx, sch
 
   // Revert steps to initial state, before dci record allocation was attempted
   last_dci_dfs.swap(temp_dci_dfs);
-  current_cfix = start_cfix;
   return false;
 }
 
@@ -220,6 +244,112 @@ bool sf_cch_allocator::alloc_dfs_node(const alloc_record& record, uint32_t start
   return false;
 }
 
+bool sf_cch_allocator::alloc_bitmap(const alloc_record& record)
+{
+  pdcch_bitmap_solver::candidate_list cands;
+  get_bitmap_candidates(record, current_cfix, cands);
+  if (bitmap_solver.push(record.aggr_idx, cands)) {
+    return true;
+  }
+  if (bitmap_solver.remaining_search_budget() == 0) {
+    // The search budget of this subframe was exhausted
+    return false;
+  }
+
+  // Increase the CFI. All DCIs get new candidate positions, so the search has to start from scratch
+  for (uint32_t cfix = current_cfix + 1; cfix <= current_max_cfix; ++cfix) {
+    for (uint32_t i = 0; i < dci_record_list.size(); ++i) {
+      get_bitmap_candidates(dci_record_list[i], cfix, cands);
+      bitmap_solver.set_candidates(i, cands);
+    }
+    get_bitmap_candidates(record, cfix, cands);
+    if (not bitmap_solver.push_unsolved(record.aggr_idx, cands)) {
+      break;
+    }
+    if (bitmap_solver.solve()) {
+      current_cfix = cfix;
+      return true;
+    }
+    bitmap_solver.pop();
+  }
+
+  // Restore the candidates of the current CFI. The positions of the DCIs were left untouched
+  for (uint32_t i = 0; i < dci_record_list.size(); ++i) {
+    get_bitmap_candidates(dci_record_list[i], current_cfix, cands);
+    bitmap_solver.set_candidates(i, cands);
+  }
+  return false;
+}
+
+void sf_cch_allocator::get_bitmap_candidates(const alloc_record&                  record,
+                                             uint32_t                             cfix,
+                                             pdcch_bitmap_solver::candidate_list& cands) const
+{
+  cands.clear();
+  const cce_cfi_position_table* dci_locs = get_cce_loc_table(record.alloc_type, record.user, cfix);
+  if (dci_locs == nullptr) {
+    return;
+  }
+  for (uint32_t ncce : (*dci_locs)[record.aggr_idx]) {
+    pdcch_bitmap_solver::candidate_t cand;
+    cand.ncce = ncce;
+    if (record.alloc_type == alloc_type_t::DL_DATA and not record.pusch_uci) {
+      // The UE needs to allocate space in PUCCH for HARQ-ACK
+      if (is_pucch_sr_collision(
+              record.user->get_ue_cfg().pucch_cfg, to_tx_dl_ack(tti_rx), ncce + pucch_cfg_common.N_pucch_1)) {
+        continue;
+      }
+      int pucch_n_prb = cce_pucch_n_prb[ncce];
+      int low_rb      = pucch_n_prb < (int)cc_cfg->cfg.cell.nof_prb / 2 ? pucch_n_prb
+                                                                          : cc_cfg->cfg.cell.nof_prb - pucch_n_prb - 1;
+      if (cc_cfg->sched_cfg->pucch_harq_max_rb > 0 && low_rb >= cc_cfg->sched_cfg->pucch_harq_max_rb) {
+        continue;
+      }
+      if (not cc_cfg->sched_cfg->pucch_mux_enabled) {
+        cand.uci_res = pucch_n_prb;
+      }
+    }
+    cands.push_back(cand);
+  }
+}
+
+void sf_cch_allocator::update_bitmap_dci_nodes()
+{
+  // Find the first DCI whose position was changed by the bitmap search
+  size_t idx = 0;
+  for (; idx < last_dci_dfs.size(); ++idx) {
+    if (last_dci_dfs[idx].total_mask.size() != nof_cces() or
+        last_dci_dfs[idx].dci_pos.ncce != bitmap_solver.get_position(idx).ncce) {
+      break;
+    }
+  }
+  last_dci_dfs.resize(idx);
+
+  for (; idx < dci_record_list.size(); ++idx) {
+    const alloc_record& record = dci_record_list[idx];
+    tree_node           node;
+    node.dci_pos_idx  = bitmap_solver.get_position_idx(idx);
+    node.dci_pos.L    = record.aggr_idx;
+    node.dci_pos.ncce = bitmap_solver.get_position(idx).ncce;
+    node.rnti         = record.user != nullptr ? record.user->get_rnti() : SRSRAN_INVALID_RNTI;
+    if (not last_dci_dfs.empty()) {
+      node.total_mask       = last_dci_dfs.back().total_mask;
+      node.total_pucch_mask = last_dci_dfs.back().total_pucch_mask;
+    } else {
+      node.total_mask.resize(nof_cces());
+      node.total_pucch_mask.resize(cc_cfg->nof_prb());
+    }
+    node.current_mask.resize(nof_cces());
+    node.current_mask.fill(node.dci_pos.ncce, node.dci_pos.ncce + (1U << record.aggr_idx));
+    node.total_mask |= node.current_mask;
+    if (record.alloc_type == alloc_type_t::DL_DATA and not record.pusch_uci) {
+      node.pucch_n_prb = cce_pucch_n_prb[node.dci_pos.ncce];
+      node.total_pucch_mask.set(node.pucch_n_prb);
+    }
+    last_dci_dfs.push_back(node);
+  }
+}
+
 void sf_cch_allocator::rem_last_dci()
 {
   assert(not dci_record_list.empty());
@@ -227,6 +357,9 @@ void sf_cch_allocator::rem_last_dci()
   // Remove DCI record
   last_dci_dfs.pop_back();
   dci_record_list.pop_back();
+  if (use_bitmap) {
+    bitmap_solver.pop();
+  }
 }
 
 void sf_cch_allocator::get_allocs(alloc_result_t* vec, pdcch_mask_t* tot_mask, size_t idx) const
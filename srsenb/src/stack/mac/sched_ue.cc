@@ -693,6 +693,44 @@ int sched_ue::generate_format0(sched_interface::ul_sched_data_t* data,
   return tbinfo.tbs_bytes;
 }
 
+/**
+ * Reverts the ACK that was assumed for the PUSCH of tti_rx, when its scheduling decision was computed ahead of the CRC,
+ * now that the CRC turned out to be KO. The UE received a PHICH ACK, so the retx has to be signalled in PDCCH.
+ * @param data UL grant of the UE in the scheduling result of tti_rx, if any. If the HARQ was reused for this newtx, the
+ *             grant is turned into an adaptive retx of the previous TB
+ */
+void sched_ue::revert_ul_ack(tti_point tti_rx, uint32_t enb_cc_idx, sched_interface::ul_sched_data_t* data)
+{
+  if (cells[enb_cc_idx].cc_state() == cc_st::idle) {
+    return;
+  }
+  ul_harq_proc* h = cells[enb_cc_idx].harq_ent.revert_ul_ack(tti_rx);
+  if (h == nullptr) {
+    return;
+  }
+  // Clear the PHICH of the restored HARQ, as it was already sent as ACK
+  h->pop_pending_phich();
+
+  if (data == nullptr or not data->needs_pdcch) {
+    // Resume the HARQ in a later TTI, with PDCCH
+    h->retx_skipped();
+    return;
+  }
+
+  prb_interval alloc;
+  uint32_t     L, rb_start;
+  srsran_ra_type2_from_riv(data->dci.type2_alloc.riv, &L, &rb_start, cell.nof_prb, cell.nof_prb);
+  alloc.set(rb_start, rb_start + L);
+
+  int mcs = 0, tbs = 0;
+  h->new_retx(to_tx_ul(tti_rx), &mcs, &tbs, alloc);
+  data->tbs            = tbs;
+  data->current_tx_nb  = h->nof_retx(0);
+  data->dci.tb.ndi     = h->get_ndi(0);
+  data->dci.tb.rv      = get_rvidx(h->nof_retx(0));
+  data->dci.tb.mcs_idx = 28 + data->dci.tb.rv;
+}
+
 /*******************************************************
  *
  * Functions used by scheduler or scheduler metric objects
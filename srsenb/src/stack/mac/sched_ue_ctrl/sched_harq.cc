@@ -340,7 +340,8 @@ uint32_t ul_harq_proc::get_pending_data() const
  *   Harq Entity
  *******************/
 
-harq_entity::harq_entity(size_t nof_dl_harqs, size_t nof_ul_harqs) : dl_harqs(nof_dl_harqs), ul_harqs(nof_ul_harqs)
+harq_entity::harq_entity(size_t nof_dl_harqs, size_t nof_ul_harqs, uint32_t feedback_delay_) :
+  feedback_delay(feedback_delay_), dl_harqs(nof_dl_harqs), ul_harqs(nof_ul_harqs), ul_backups(nof_ul_harqs)
 {
   for (uint32_t i = 0; i < dl_harqs.size(); ++i) {
     dl_harqs[i].init(i);
@@ -365,6 +366,9 @@ void harq_entity::reset()
       h.reset_pending_data();
     }
   }
+  for (auto& b : ul_backups) {
+    b.tti_rx = tti_point{};
+  }
 }
 
 void harq_entity::new_tti(tti_point tti_rx)
@@ -372,7 +376,7 @@ void harq_entity::new_tti(tti_point tti_rx)
   last_ttis[tti_rx.to_uint() % last_ttis.size()] = tti_rx;
   get_ul_harq(to_tx_ul(tti_rx))->new_tti();
   for (auto& hdl : dl_harqs) {
-    hdl.new_tti(to_tx_dl(tti_rx));
+    hdl.new_tti(to_tx_dl(tti_rx) - feedback_delay);
   }
 }
 
@@ -393,7 +397,8 @@ dl_harq_proc* harq_entity::get_pending_dl_harq(tti_point tti_tx_dl)
     dl_harq_proc* h = &dl_harqs[tti_tx_dl.to_uint() % nof_dl_harqs()];
     return (h->has_pending_retx(0, tti_tx_dl) or h->has_pending_retx(1, tti_tx_dl)) ? h : nullptr;
   }
-  return get_oldest_dl_harq(tti_tx_dl);
+  // Decisions taken ahead of time cannot rely on the HARQ feedback of the last feedback_delay TTIs
+  return get_oldest_dl_harq(tti_tx_dl - feedback_delay);
 }
 
 std::tuple<uint32_t, int, int> harq_entity::set_ack_info(tti_point tti_rx, uint32_t tb_idx, bool ack)
@@ -418,9 +423,44 @@ int harq_entity::set_ul_crc(tti_point tti_rx, uint32_t tb_idx, bool ack_)
 {
   ul_harq_proc* h   = get_ul_harq(tti_rx);
   uint32_t      pid = h->get_id();
+  if (ul_backups[pid].tti_rx == tti_rx) {
+    // The ACK was already assumed and the HARQ may have been reused since. A KO CRC is handled in revert_ul_ack()
+    if (ack_) {
+      ul_backups[pid].tti_rx = tti_point{};
+    }
+    return pid;
+  }
   return h->set_ack(tb_idx, ack_) ? pid : -1;
 }
 
+void harq_entity::assume_ul_ack(tti_point tti_rx)
+{
+  ul_harq_proc* h = get_ul_harq(tti_rx);
+  if (not h->has_pending_retx() or h->get_tti() != tti_rx or h->is_msg3()) {
+    // Only the PUSCHs of tti_rx are pending a CRC. Msg3 is excluded, as its retxs can't be resumed with PDCCH
+    return;
+  }
+  ul_backups[h->get_id()].tti_rx = tti_rx;
+  ul_backups[h->get_id()].h      = *h;
+  h->set_ack(0, true);
+}
+
+ul_harq_proc* harq_entity::revert_ul_ack(tti_point tti_rx)
+{
+  ul_harq_proc*   h      = get_ul_harq(tti_rx);
+  ul_harq_backup& backup = ul_backups[h->get_id()];
+  if (backup.tti_rx != tti_rx) {
+    return nullptr;
+  }
+  backup.tti_rx = tti_point{};
+  if (backup.h.nof_retx(0) + 1 >= backup.h.max_nof_retx()) {
+    // The TB would have been discarded anyway
+    return nullptr;
+  }
+  *h = backup.h;
+  return h;
+}
+
 void harq_entity::finish_tti(tti_point tti_rx)
 {
   // Reset UL HARQ if no retxs
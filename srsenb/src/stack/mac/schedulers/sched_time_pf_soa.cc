@@ -0,0 +1,363 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/schedulers/sched_time_pf_soa.h"
+#include "srsran/phy/utils/vector.h"
+#include <cfloat>
+
+namespace srsenb {
+
+using srsran::tti_point;
+
+/*****************************************************************
+ *                         PF metrics
+ *****************************************************************/
+
+pf_soa_metrics::pf_soa_metrics(float fairness_coeff_, float exp_avg_alpha_) :
+  fairness_coeff(fairness_coeff_),
+  exp_avg_alpha(exp_avg_alpha_),
+  decay_inv_pow(std::pow(1 - exp_avg_alpha_, -fairness_coeff_))
+{
+  for (candidate_list* l : {&retx_cands, &newtx_cands}) {
+    l->idxs.reserve(SRSENB_MAX_UES);
+    l->exp_rate.reserve(SRSENB_MAX_UES);
+    l->inv_avg_rate_pow.reserve(SRSENB_MAX_UES);
+    l->prio.reserve(SRSENB_MAX_UES);
+  }
+}
+
+void pf_soa_metrics::push_back()
+{
+  exp_rate.push_back(0);
+  avg_rate_.push_back(0);
+  inv_avg_rate_pow.push_back(FLT_MAX);
+  nof_samples.push_back(0);
+}
+
+void pf_soa_metrics::swap_remove(uint32_t idx)
+{
+  exp_rate[idx]         = exp_rate.back();
+  avg_rate_[idx]        = avg_rate_.back();
+  inv_avg_rate_pow[idx] = inv_avg_rate_pow.back();
+  nof_samples[idx]      = nof_samples.back();
+  exp_rate.pop_back();
+  avg_rate_.pop_back();
+  inv_avg_rate_pow.pop_back();
+  nof_samples.pop_back();
+}
+
+void pf_soa_metrics::save_alloc(uint32_t idx, uint32_t alloc_bytes)
+{
+  float& R = avg_rate_[idx];
+  if (nof_samples[idx] < 1 / exp_avg_alpha) {
+    // fast start
+    R = R + (alloc_bytes - R) / (nof_samples[idx] + 1);
+    update_inv_avg_rate_pow(idx);
+  } else if (alloc_bytes == 0) {
+    // R^-coeff scales by (1-alpha)^-coeff, which avoids the pow() for the UEs that were not allocated
+    R                     = (1 - exp_avg_alpha) * R;
+    inv_avg_rate_pow[idx] = std::min(inv_avg_rate_pow[idx] * decay_inv_pow, FLT_MAX);
+  } else {
+    R = (1 - exp_avg_alpha) * R + exp_avg_alpha * alloc_bytes;
+    update_inv_avg_rate_pow(idx);
+  }
+  nof_samples[idx]++;
+}
+
+void pf_soa_metrics::update_inv_avg_rate_pow(uint32_t idx)
+{
+  float R = avg_rate_[idx];
+  float R_pow;
+  if (fairness_coeff == 1) {
+    R_pow = R;
+  } else if (fairness_coeff == 2) {
+    R_pow = R * R;
+  } else {
+    R_pow = std::pow(R, fairness_coeff);
+  }
+  inv_avg_rate_pow[idx] = R_pow > 1 / FLT_MAX ? 1 / R_pow : FLT_MAX;
+}
+
+void pf_soa_metrics::clear_candidates()
+{
+  retx_cands.clear();
+  newtx_cands.clear();
+}
+
+void pf_soa_metrics::push_candidate(uint32_t idx, bool is_retx)
+{
+  candidate_list& l = is_retx ? retx_cands : newtx_cands;
+  l.push(idx, exp_rate[idx], inv_avg_rate_pow[idx]);
+}
+
+void pf_soa_metrics::compute_priorities()
+{
+  retx_cands.compute_priorities();
+  newtx_cands.compute_priorities();
+}
+
+int pf_soa_metrics::pop_candidate()
+{
+  int idx = retx_cands.pop();
+  return idx >= 0 ? idx : newtx_cands.pop();
+}
+
+void pf_soa_metrics::candidate_list::clear()
+{
+  idxs.clear();
+  exp_rate.clear();
+  inv_avg_rate_pow.clear();
+  prio.clear();
+  nof_popped = 0;
+}
+
+void pf_soa_metrics::candidate_list::push(uint32_t idx, float r, float inv_R_pow)
+{
+  idxs.push_back(idx);
+  exp_rate.push_back(r);
+  inv_avg_rate_pow.push_back(inv_R_pow);
+}
+
+void pf_soa_metrics::candidate_list::compute_priorities()
+{
+  prio.resize(idxs.size());
+  srsran_vec_prod_fff(exp_rate.data(), inv_avg_rate_pow.data(), prio.data(), prio.size());
+}
+
+int pf_soa_metrics::candidate_list::pop()
+{
+  if (nof_popped == idxs.size()) {
+    return -1;
+  }
+  uint32_t pos = srsran_vec_max_fi(prio.data(), prio.size());
+  prio[pos]    = -INFINITY;
+  nof_popped++;
+  return idxs[pos];
+}
+
+/*****************************************************************
+ *                         Scheduler
+ *****************************************************************/
+
+sched_time_pf_soa::sched_time_pf_soa(const sched_cell_params_t&          cell_params_,
+                                     const sched_interface::sched_args_t& sched_args) :
+  cc_cfg(&cell_params_),
+  fairness_coeff(sched_args.sched_policy_args.empty() ? 1 : std::stof(sched_args.sched_policy_args)),
+  dl_metrics(fairness_coeff),
+  ul_metrics(fairness_coeff)
+{}
+
+void sched_time_pf_soa::add_ue(uint16_t rnti)
+{
+  ue_idx_map.insert(rnti, rntis.size());
+  rntis.push_back(rnti);
+  dl_cqi.push_back(-1);
+  ul_cqi.push_back(-1);
+  dl_retx_h.push_back(nullptr);
+  dl_newtx_h.push_back(nullptr);
+  ul_h.push_back(nullptr);
+  dl_metrics.push_back();
+  ul_metrics.push_back();
+}
+
+void sched_time_pf_soa::rem_ue(uint32_t idx)
+{
+  ue_idx_map.erase(rntis[idx]);
+  if (idx != rntis.size() - 1) {
+    ue_idx_map[rntis.back()] = idx;
+  }
+  rntis[idx]  = rntis.back();
+  dl_cqi[idx] = dl_cqi.back();
+  ul_cqi[idx] = ul_cqi.back();
+  rntis.pop_back();
+  dl_cqi.pop_back();
+  ul_cqi.pop_back();
+  dl_retx_h.pop_back();
+  dl_newtx_h.pop_back();
+  ul_h.pop_back();
+  dl_metrics.swap_remove(idx);
+  ul_metrics.swap_remove(idx);
+}
+
+void sched_time_pf_soa::new_tti(sched_ue_list& ue_db, sf_sched* tti_sched)
+{
+  current_tti_rx = tti_point{tti_sched->get_tti_rx()};
+  dl_metrics.clear_candidates();
+  ul_metrics.clear_candidates();
+
+  // remove deleted users
+  for (uint32_t idx = 0; idx < rntis.size();) {
+    if (not ue_db.contains(rntis[idx])) {
+      rem_ue(idx);
+    } else {
+      ++idx;
+    }
+  }
+
+  for (auto& u : ue_db) {
+    auto it = ue_idx_map.find(u.first);
+    if (it == ue_idx_map.end()) {
+      add_ue(u.first);
+      it = ue_idx_map.find(u.first);
+    }
+    uint32_t  idx = it->second;
+    sched_ue& ue  = *u.second;
+
+    dl_retx_h[idx]  = nullptr;
+    dl_newtx_h[idx] = nullptr;
+    ul_h[idx]       = nullptr;
+    if (ue.enb_to_ue_cc_idx(cc_cfg->enb_cc_idx) < 0) {
+      // not active
+      continue;
+    }
+    const sched_ue_cell& cell = *ue.find_ue_carrier(cc_cfg->enb_cc_idx);
+
+    // The expected rates are only recomputed when the reported channel quality changes. The small variation of the
+    // number of REs across subframes (e.g. PBCH, SS) is common to all UEs and does not change their ordering
+    dl_retx_h[idx]  = get_dl_retx_harq(ue, tti_sched);
+    dl_newtx_h[idx] = get_dl_newtx_harq(ue, tti_sched);
+    if (dl_retx_h[idx] != nullptr or dl_newtx_h[idx] != nullptr) {
+      if (cell.get_dl_cqi() != dl_cqi[idx]) {
+        dl_cqi[idx] = cell.get_dl_cqi();
+        dl_metrics.set_expected_rate(idx, ue.get_expected_dl_bitrate(cc_cfg->enb_cc_idx) / 8);
+      }
+      dl_metrics.push_candidate(idx, dl_retx_h[idx] != nullptr);
+    }
+
+    ul_h[idx] = get_ul_retx_harq(ue, tti_sched);
+    if (ul_h[idx] == nullptr) {
+      ul_h[idx] = get_ul_newtx_harq(ue, tti_sched);
+    }
+    if (ul_h[idx] != nullptr) {
+      if (cell.get_ul_cqi() != ul_cqi[idx]) {
+        ul_cqi[idx] = cell.get_ul_cqi();
+        ul_metrics.set_expected_rate(idx, ue.get_expected_ul_bitrate(cc_cfg->enb_cc_idx) / 8);
+      }
+      ul_metrics.push_candidate(idx, ul_h[idx]->has_pending_retx());
+    }
+  }
+
+  dl_metrics.compute_priorities();
+  ul_metrics.compute_priorities();
+}
+
+/*****************************************************************
+ *                         Dowlink
+ *****************************************************************/
+
+void sched_time_pf_soa::sched_dl_users(sched_ue_list& ue_db, sf_sched* tti_sched)
+{
+  srsran::tti_point tti_rx{tti_sched->get_tti_rx()};
+  if (current_tti_rx != tti_rx) {
+    new_tti(ue_db, tti_sched);
+  }
+
+  for (int idx = dl_metrics.pop_candidate(); idx >= 0; idx = dl_metrics.pop_candidate()) {
+    if (tti_sched->get_dl_mask().all()) {
+      // No RBGs left. The remaining UEs would not get any allocation
+      dl_metrics.save_alloc(idx, 0);
+      dl_metrics.pop_remaining([this](uint32_t idx2) { dl_metrics.save_alloc(idx2, 0); });
+      break;
+    }
+    dl_metrics.save_alloc(idx, try_dl_alloc(idx, *ue_db[rntis[idx]], tti_sched));
+  }
+}
+
+uint32_t sched_time_pf_soa::try_dl_alloc(uint32_t idx, sched_ue& ue, sf_sched* tti_sched)
+{
+  alloc_result code = alloc_result::other_cause;
+  if (dl_retx_h[idx] != nullptr) {
+    code = try_dl_retx_alloc(*tti_sched, ue, *dl_retx_h[idx]);
+    if (code == alloc_result::success) {
+      return dl_retx_h[idx]->get_tbs(0) + dl_retx_h[idx]->get_tbs(1);
+    }
+  }
+
+  // There is space in PDCCH and an available DL HARQ
+  if (code != alloc_result::no_cch_space and dl_newtx_h[idx] != nullptr) {
+    rbgmask_t alloc_mask;
+    code = try_dl_newtx_alloc_greedy(*tti_sched, ue, *dl_newtx_h[idx], &alloc_mask);
+    if (code == alloc_result::success) {
+      return ue.get_expected_dl_bitrate(cc_cfg->enb_cc_idx, alloc_mask.count()) * tti_duration_ms / 8;
+    }
+  }
+  return 0;
+}
+
+/*****************************************************************
+ *                         Uplink
+ *****************************************************************/
+
+void sched_time_pf_soa::sched_ul_users(sched_ue_list& ue_db, sf_sched* tti_sched)
+{
+  srsran::tti_point tti_rx{tti_sched->get_tti_rx()};
+  if (current_tti_rx != tti_rx) {
+    new_tti(ue_db, tti_sched);
+  }
+
+  for (int idx = ul_metrics.pop_candidate(); idx >= 0; idx = ul_metrics.pop_candidate()) {
+    if (tti_sched->get_ul_mask().all()) {
+      // No PRBs left. Only the UL grants already allocated for UCI count towards the average rate
+      auto save_ul_uci_alloc = [this, tti_sched](uint32_t idx2) {
+        ul_metrics.save_alloc(idx2, tti_sched->is_ul_alloc(rntis[idx2]) ? ul_h[idx2]->get_pending_data() : 0);
+      };
+      save_ul_uci_alloc(idx);
+      ul_metrics.pop_remaining(save_ul_uci_alloc);
+      break;
+    }
+    ul_metrics.save_alloc(idx, try_ul_alloc(idx, *ue_db[rntis[idx]], tti_sched));
+  }
+}
+
+uint32_t sched_time_pf_soa::try_ul_alloc(uint32_t idx, sched_ue& ue, sf_sched* tti_sched)
+{
+  const ul_harq_proc* h = ul_h[idx];
+  if (tti_sched->is_ul_alloc(rntis[idx])) {
+    // NOTE: An UL grant could have been previously allocated for UCI
+    return h->get_pending_data();
+  }
+
+  alloc_result code;
+  uint32_t     estim_tbs_bytes = 0;
+  if (h->has_pending_retx()) {
+    code            = try_ul_retx_alloc(*tti_sched, ue, *h);
+    estim_tbs_bytes = code == alloc_result::success ? h->get_pending_data() : 0;
+  } else {
+    // Note: h->is_empty check is required, in case CA allocated a small UL grant for UCI
+    uint32_t pending_data = ue.get_pending_ul_new_data(tti_sched->get_tti_tx_ul(), cc_cfg->enb_cc_idx);
+    // Check if there is a empty harq, and data to transmit
+    if (pending_data == 0) {
+      return 0;
+    }
+    uint32_t     pending_rb = ue.get_required_prb_ul(cc_cfg->enb_cc_idx, pending_data);
+    prb_interval alloc      = find_contiguous_ul_prbs(pending_rb, tti_sched->get_ul_mask());
+    if (alloc.empty()) {
+      return 0;
+    }
+    code            = tti_sched->alloc_ul_user(&ue, alloc);
+    estim_tbs_bytes = code == alloc_result::success
+                          ? ue.get_expected_ul_bitrate(cc_cfg->enb_cc_idx, alloc.length()) * tti_duration_ms / 8
+                          : 0;
+  }
+  return estim_tbs_bytes;
+}
+
+} // namespace srsenb
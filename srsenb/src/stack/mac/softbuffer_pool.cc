@@ -0,0 +1,247 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/softbuffer_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+extern "C" {
+#include "srsran/phy/fec/turbo/turbodecoder.h"
+#include "srsran/phy/phch/ra.h"
+#include "srsran/phy/utils/vector.h"
+}
+
+namespace srsenb {
+
+// Code blocks start at cache line boundaries, which also satisfies the alignment of the SIMD turbo decoders
+static const size_t cb_align = 64;
+
+static size_t align_cb(size_t size)
+{
+  return (size + cb_align - 1) / cb_align * cb_align;
+}
+
+softbuffer_cb_pool::softbuffer_cb_pool(bool llr_8bit_, size_t max_bytes_, uint32_t cbs_per_batch_) :
+  llr_8bit(llr_8bit_), max_bytes(max_bytes_), cbs_per_batch(std::max(cbs_per_batch_, 1u))
+{
+  // The 8-bit decoder stores one byte per LLR in the int16_t buffer of each code block
+  rx_llr_size    = align_cb(llr_8bit ? SOFTBUFFER_SIZE : SOFTBUFFER_SIZE * sizeof(int16_t));
+  rx_cbs.cb_size = rx_llr_size + align_cb(SOFTBUFFER_SIZE / 8);
+  tx_cbs.cb_size = align_cb(SOFTBUFFER_SIZE);
+}
+
+softbuffer_cb_pool::~softbuffer_cb_pool()
+{
+  for (uint8_t* batch : batches) {
+    free(batch);
+  }
+}
+
+uint32_t softbuffer_cb_pool::get_nof_cb(uint32_t tbs)
+{
+  // Code block segmentation of TS 36.212 Section 5.1.2, including the TB CRC
+  if (tbs == 0) {
+    return 0;
+  }
+  uint32_t B = tbs + 24;
+  if (B <= SRSRAN_TCOD_MAX_LEN_CB) {
+    return 1;
+  }
+  return (B + SRSRAN_TCOD_MAX_LEN_CB - 24 - 1) / (SRSRAN_TCOD_MAX_LEN_CB - 24);
+}
+
+uint32_t softbuffer_cb_pool::get_max_cb(uint32_t nof_prb)
+{
+  // Same dimensioning as srsran_softbuffer_rx_init()
+  int tbs = srsran_ra_tbs_from_idx(SRSRAN_RA_NOF_TBS_IDX - 1, nof_prb);
+  if (tbs == SRSRAN_ERROR) {
+    return 0;
+  }
+  return (uint32_t)tbs / (SRSRAN_TCOD_MAX_LEN_CB - 24) + 1;
+}
+
+bool softbuffer_cb_pool::init_rx(srsran_softbuffer_rx_t& buffer, uint32_t max_cb)
+{
+  memset(&buffer, 0, sizeof(buffer));
+  buffer.max_cb = max_cb;
+  // srsran_softbuffer_rx_reset_cb() zeroes max_cb_size int16_t LLRs, i.e. twice as many 8-bit LLRs
+  buffer.max_cb_size = llr_8bit ? SOFTBUFFER_SIZE / 2 : SOFTBUFFER_SIZE;
+  buffer.buffer_f    = (int16_t**)calloc(max_cb, sizeof(int16_t*));
+  buffer.data        = (uint8_t**)calloc(max_cb, sizeof(uint8_t*));
+  buffer.cb_crc      = (bool*)calloc(max_cb, sizeof(bool));
+  if (buffer.buffer_f == nullptr or buffer.data == nullptr or buffer.cb_crc == nullptr) {
+    srsran_softbuffer_rx_free(&buffer);
+    return false;
+  }
+  return true;
+}
+
+bool softbuffer_cb_pool::init_tx(srsran_softbuffer_tx_t& buffer, uint32_t max_cb)
+{
+  memset(&buffer, 0, sizeof(buffer));
+  buffer.max_cb      = max_cb;
+  buffer.max_cb_size = SOFTBUFFER_SIZE;
+  buffer.buffer_b    = (uint8_t**)calloc(max_cb, sizeof(uint8_t*));
+  return buffer.buffer_b != nullptr;
+}
+
+void softbuffer_cb_pool::free_rx(srsran_softbuffer_rx_t& buffer)
+{
+  release_rx(buffer);
+  srsran_softbuffer_rx_free(&buffer);
+}
+
+void softbuffer_cb_pool::free_tx(srsran_softbuffer_tx_t& buffer)
+{
+  release_tx(buffer);
+  srsran_softbuffer_tx_free(&buffer);
+}
+
+// Note: storage is always attached to a prefix of the code blocks of a soft-buffer
+bool softbuffer_cb_pool::attach_rx(srsran_softbuffer_rx_t& buffer, uint32_t nof_cb, bool zero)
+{
+  nof_cb               = std::min(nof_cb, buffer.max_cb);
+  uint32_t first_cb    = 0;
+  uint32_t nof_new_cbs = 0;
+  while (first_cb < nof_cb and buffer.buffer_f[first_cb] != nullptr) {
+    first_cb++;
+  }
+  if (first_cb == nof_cb) {
+    return true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t i = first_cb; i < nof_cb; i++, nof_new_cbs++) {
+      uint8_t* cb = alloc_cb(rx_cbs);
+      if (cb == nullptr) {
+        break;
+      }
+      buffer.buffer_f[i] = (int16_t*)cb;
+      buffer.data[i]     = cb + rx_llr_size;
+      buffer.cb_crc[i]   = false;
+    }
+    update_peak();
+  }
+
+  if (zero) {
+    for (uint32_t i = first_cb; i < first_cb + nof_new_cbs; i++) {
+      srsran_vec_u8_zero((uint8_t*)buffer.buffer_f[i], rx_llr_size);
+    }
+  }
+  return first_cb + nof_new_cbs == nof_cb;
+}
+
+bool softbuffer_cb_pool::attach_tx(srsran_softbuffer_tx_t& buffer, uint32_t nof_cb)
+{
+  nof_cb            = std::min(nof_cb, buffer.max_cb);
+  uint32_t first_cb = 0;
+  while (first_cb < nof_cb and buffer.buffer_b[first_cb] != nullptr) {
+    first_cb++;
+  }
+  if (first_cb == nof_cb) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (uint32_t i = first_cb; i < nof_cb; i++) {
+    buffer.buffer_b[i] = alloc_cb(tx_cbs);
+    if (buffer.buffer_b[i] == nullptr) {
+      update_peak();
+      return false;
+    }
+  }
+  update_peak();
+  return true;
+}
+
+void softbuffer_cb_pool::release_rx(srsran_softbuffer_rx_t& buffer, uint32_t first_cb)
+{
+  if (buffer.buffer_f == nullptr or first_cb >= buffer.max_cb or buffer.buffer_f[first_cb] == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  for (uint32_t i = first_cb; i < buffer.max_cb and buffer.buffer_f[i] != nullptr; i++) {
+    rx_cbs.free_cbs.push_back((uint8_t*)buffer.buffer_f[i]);
+    rx_cbs.nof_used--;
+    buffer.buffer_f[i] = nullptr;
+    buffer.data[i]     = nullptr;
+    buffer.cb_crc[i]   = false;
+  }
+}
+
+void softbuffer_cb_pool::release_tx(srsran_softbuffer_tx_t& buffer, uint32_t first_cb)
+{
+  if (buffer.buffer_b == nullptr or first_cb >= buffer.max_cb or buffer.buffer_b[first_cb] == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  for (uint32_t i = first_cb; i < buffer.max_cb and buffer.buffer_b[i] != nullptr; i++) {
+    tx_cbs.free_cbs.push_back(buffer.buffer_b[i]);
+    tx_cbs.nof_used--;
+    buffer.buffer_b[i] = nullptr;
+  }
+}
+
+mac_softbuffer_metrics_t softbuffer_cb_pool::get_metrics()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  mac_softbuffer_metrics_t    metrics = {};
+  metrics.allocated_bytes             = allocated_bytes;
+  metrics.rx_used_bytes               = (uint64_t)rx_cbs.nof_used * rx_cbs.cb_size;
+  metrics.tx_used_bytes               = (uint64_t)tx_cbs.nof_used * tx_cbs.cb_size;
+  metrics.peak_used_bytes             = peak_used_bytes;
+  metrics.nof_alloc_failures          = nof_alloc_failures;
+  peak_used_bytes                     = metrics.rx_used_bytes + metrics.tx_used_bytes;
+  return metrics;
+}
+
+uint8_t* softbuffer_cb_pool::alloc_cb(cb_list_t& list)
+{
+  if (list.free_cbs.empty()) {
+    size_t nof_cbs = cbs_per_batch;
+    if (max_bytes > 0) {
+      nof_cbs = std::min(nof_cbs, (max_bytes - std::min(max_bytes, allocated_bytes)) / list.cb_size);
+    }
+    uint8_t* batch = nof_cbs > 0 ? (uint8_t*)srsran_vec_malloc(nof_cbs * list.cb_size) : nullptr;
+    if (batch == nullptr) {
+      nof_alloc_failures++;
+      return nullptr;
+    }
+    batches.push_back(batch);
+    allocated_bytes += nof_cbs * list.cb_size;
+    // Code blocks are handed out in address order
+    for (size_t i = nof_cbs; i > 0; i--) {
+      list.free_cbs.push_back(batch + (i - 1) * list.cb_size);
+    }
+  }
+  uint8_t* cb = list.free_cbs.back();
+  list.free_cbs.pop_back();
+  list.nof_used++;
+  return cb;
+}
+
+void softbuffer_cb_pool::update_peak()
+{
+  peak_used_bytes = std::max(peak_used_bytes, rx_cbs.nof_used * rx_cbs.cb_size + tx_cbs.nof_used * tx_cbs.cb_size);
+}
+
+} // namespace srsenb
@@ -19,6 +19,7 @@
  *
  */
 
+#include <algorithm>
 #include <bitset>
 #include <inttypes.h>
 #include <iostream>
@@ -32,42 +33,132 @@
 
 namespace srsenb {
 
-ue_cc_softbuffers::ue_cc_softbuffers(uint32_t nof_prb, uint32_t nof_tx_harq_proc_, uint32_t nof_rx_harq_proc_) :
-  nof_tx_harq_proc(nof_tx_harq_proc_), nof_rx_harq_proc(nof_rx_harq_proc_)
+ue_cc_softbuffers::ue_cc_softbuffers(softbuffer_cb_pool& cb_pool_,
+                                     uint32_t            nof_prb,
+                                     uint32_t            nof_tx_harq_proc_,
+                                     uint32_t            nof_rx_harq_proc_) :
+  nof_tx_harq_proc(nof_tx_harq_proc_), nof_rx_harq_proc(nof_rx_harq_proc_), cb_pool(cb_pool_)
 {
+  // Only the code-block pointers are allocated, the code blocks are attached when the HARQ processes are scheduled
+  uint32_t max_cb = softbuffer_cb_pool::get_max_cb(nof_prb);
+
   // Create and init Rx buffers
   softbuffer_rx_list.resize(nof_rx_harq_proc);
   for (srsran_softbuffer_rx_t& buffer : softbuffer_rx_list) {
-    srsran_softbuffer_rx_init(&buffer, nof_prb);
+    cb_pool.init_rx(buffer, max_cb);
   }
+  rx_last_tti.resize(nof_rx_harq_proc);
 
   // Create and init Tx buffers
   softbuffer_tx_list.resize(nof_tx_harq_proc * SRSRAN_MAX_TB);
   for (auto& buffer : softbuffer_tx_list) {
-    srsran_softbuffer_tx_init(&buffer, nof_prb);
+    cb_pool.init_tx(buffer, max_cb);
   }
+  tx_last_tti.resize(nof_tx_harq_proc * SRSRAN_MAX_TB);
 }
 
 ue_cc_softbuffers::~ue_cc_softbuffers()
 {
   for (auto& buffer : softbuffer_rx_list) {
-    srsran_softbuffer_rx_free(&buffer);
+    cb_pool.free_rx(buffer);
   }
   softbuffer_rx_list.clear();
 
   for (auto& buffer : softbuffer_tx_list) {
-    srsran_softbuffer_tx_free(&buffer);
+    cb_pool.free_tx(buffer);
   }
   softbuffer_tx_list.clear();
 }
 
 void ue_cc_softbuffers::clear()
 {
+  std::lock_guard<std::mutex> lock(mutex);
   for (auto& buffer : softbuffer_rx_list) {
+    cb_pool.release_rx(buffer);
     srsran_softbuffer_rx_reset(&buffer);
   }
   for (auto& buffer : softbuffer_tx_list) {
-    srsran_softbuffer_tx_reset(&buffer);
+    cb_pool.release_tx(buffer);
+  }
+  std::fill(rx_last_tti.begin(), rx_last_tti.end(), tti_point{});
+  std::fill(tx_last_tti.begin(), tx_last_tti.end(), tti_point{});
+}
+
+srsran_softbuffer_tx_t*
+ue_cc_softbuffers::get_tx(uint32_t pid, uint32_t tb_idx, uint32_t tbs, bool new_tx, tti_point tti_tx_dl)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  uint32_t                    idx    = pid * SRSRAN_MAX_TB + tb_idx;
+  srsran_softbuffer_tx_t&     buffer = softbuffer_tx_list.at(idx);
+  uint32_t                    nof_cb = softbuffer_cb_pool::get_nof_cb(tbs);
+
+  if (new_tx) {
+    cb_pool.release_tx(buffer, nof_cb);
+  }
+  if (not cb_pool.attach_tx(buffer, nof_cb)) {
+    return nullptr;
+  }
+  tx_last_tti[idx] = tti_tx_dl;
+  return &buffer;
+}
+
+srsran_softbuffer_rx_t* ue_cc_softbuffers::get_rx(tti_point tti_rx, uint32_t tbs, bool new_tx)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  uint32_t                    pid    = tti_rx.to_uint() % nof_rx_harq_proc;
+  srsran_softbuffer_rx_t&     buffer = softbuffer_rx_list.at(pid);
+  uint32_t                    nof_cb = softbuffer_cb_pool::get_nof_cb(tbs);
+
+  if (new_tx) {
+    cb_pool.release_rx(buffer, nof_cb);
+  }
+  // Code blocks missing in a retransmission are combined from zero
+  if (not cb_pool.attach_rx(buffer, nof_cb, not new_tx)) {
+    return nullptr;
+  }
+  if (new_tx) {
+    srsran_softbuffer_rx_reset_cb(&buffer, nof_cb);
+  }
+  rx_last_tti[pid] = tti_rx;
+  return &buffer;
+}
+
+void ue_cc_softbuffers::release_tx(tti_point tti_rx, uint32_t tb_idx)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  for (uint32_t pid = 0; pid < nof_tx_harq_proc; pid++) {
+    uint32_t idx = pid * SRSRAN_MAX_TB + tb_idx;
+    if (tx_last_tti[idx].is_valid() and tx_last_tti[idx] + FDD_HARQ_DELAY_DL_MS == tti_rx) {
+      cb_pool.release_tx(softbuffer_tx_list[idx]);
+      return;
+    }
+  }
+}
+
+void ue_cc_softbuffers::release_rx(tti_point tti_rx)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  uint32_t                    pid = tti_rx.to_uint() % nof_rx_harq_proc;
+  // The process may already have been scheduled for a new PUSCH
+  if (rx_last_tti[pid] == tti_rx) {
+    cb_pool.release_rx(softbuffer_rx_list[pid]);
+  }
+}
+
+void ue_cc_softbuffers::release_idle(tti_point current_tti)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  for (uint32_t i = 0; i < softbuffer_rx_list.size(); i++) {
+    if (rx_last_tti[i].is_valid() and current_tti - rx_last_tti[i] > (int)MAX_IDLE_TTIS) {
+      cb_pool.release_rx(softbuffer_rx_list[i]);
+      rx_last_tti[i] = tti_point{};
+    }
+  }
+  for (uint32_t i = 0; i < softbuffer_tx_list.size(); i++) {
+    if (tx_last_tti[i].is_valid() and current_tti - tx_last_tti[i] > (int)MAX_IDLE_TTIS) {
+      cb_pool.release_tx(softbuffer_tx_list[i]);
+      tx_last_tti[i] = tti_point{};
+    }
   }
 }
 
@@ -101,12 +192,13 @@ uint8_t* cc_used_buffers_map::request_pdu(tti_point tti, uint32_t len)
     return nullptr;
   }
 
-  srsran::unique_byte_buffer_t pdu = srsran::make_byte_buffer();
+  srsran::unique_byte_buffer_t pdu = srsran::make_sized_byte_buffer(len);
   if (pdu == nullptr) {
     logger->error("UE buffers: Requesting buffer from byte buffer pool");
     return nullptr;
   }
-  srsran_assert(len < pdu->get_tailroom(), "Requested UL pdu doesn't fit in byte_buffer");
+  pdu->reserve(len);
+  srsran_assert(len <= pdu->get_tailroom(), "Requested UL pdu doesn't fit in byte_buffer");
   pdu->N_bytes = len;
 
   auto inserted_elem = pdu_map.insert(tti.to_uint(), std::move(pdu));
@@ -145,7 +237,9 @@ cc_buffer_handler::cc_buffer_handler()
 {
   for (auto& harq_buffers : tx_payload_buffer) {
     for (srsran::unique_byte_buffer_t& tb_buffer : harq_buffers) {
-      tb_buffer = srsran::make_byte_buffer();
+      // Sized for typical grants. generate_pdu() grows the buffer to the grant size when needed
+      tb_buffer =
+          srsran::make_sized_byte_buffer(srsran::byte_buffer_class_payload(srsran::byte_buffer_class_t::medium));
       if (tb_buffer == nullptr) {
         srslog::fetch_basic_logger("MAC").error("Failed to allocate HARQ buffers for UE");
         return;
@@ -245,24 +339,43 @@ void ue::ue_cfg(const sched_interface::ue_cfg_t& ue_cfg)
   }
 }
 
-srsran_softbuffer_rx_t* ue::get_rx_softbuffer(uint32_t enb_cc_idx, uint32_t tti)
+srsran_softbuffer_rx_t* ue::get_rx_softbuffer(uint32_t enb_cc_idx, uint32_t tti, uint32_t tbs, bool new_tx)
 {
   if ((size_t)enb_cc_idx >= cc_buffers.size() or cc_buffers[enb_cc_idx].empty()) {
     ERROR("eNB CC Index (%d/%zd) out-of-range", enb_cc_idx, cc_buffers.size());
     return nullptr;
   }
 
-  return &cc_buffers[enb_cc_idx].get_rx_softbuffer(tti);
+  return cc_buffers[enb_cc_idx].get_softbuffers().get_rx(tti_point{tti}, tbs, new_tx);
 }
 
-srsran_softbuffer_tx_t* ue::get_tx_softbuffer(uint32_t enb_cc_idx, uint32_t harq_process, uint32_t tb_idx)
+srsran_softbuffer_tx_t* ue::get_tx_softbuffer(uint32_t enb_cc_idx,
+                                              uint32_t harq_process,
+                                              uint32_t tb_idx,
+                                              uint32_t tbs,
+                                              bool     new_tx,
+                                              uint32_t tti_tx_dl)
 {
   if ((size_t)enb_cc_idx >= cc_buffers.size() or cc_buffers[enb_cc_idx].empty()) {
     ERROR("eNB CC Index (%d/%zd) out-of-range", enb_cc_idx, cc_buffers.size());
     return nullptr;
   }
 
-  return &cc_buffers[enb_cc_idx].get_tx_softbuffer(harq_process, tb_idx);
+  return cc_buffers[enb_cc_idx].get_softbuffers().get_tx(harq_process, tb_idx, tbs, new_tx, tti_point{tti_tx_dl});
+}
+
+void ue::release_tx_softbuffer(uint32_t enb_cc_idx, uint32_t tti_rx, uint32_t tb_idx)
+{
+  if ((size_t)enb_cc_idx < cc_buffers.size() and not cc_buffers[enb_cc_idx].empty()) {
+    cc_buffers[enb_cc_idx].get_softbuffers().release_tx(tti_point{tti_rx}, tb_idx);
+  }
+}
+
+void ue::release_rx_softbuffer(uint32_t enb_cc_idx, uint32_t tti_rx)
+{
+  if ((size_t)enb_cc_idx < cc_buffers.size() and not cc_buffers[enb_cc_idx].empty()) {
+    cc_buffers[enb_cc_idx].get_softbuffers().release_rx(tti_point{tti_rx});
+  }
 }
 
 uint8_t* ue::request_buffer(uint32_t tti, uint32_t enb_cc_idx, uint32_t len)
@@ -276,6 +389,9 @@ void ue::clear_old_buffers(uint32_t tti)
   // remove old buffers
   for (auto& cc : cc_buffers) {
     cc.get_rx_used_buffers().clear_old_pdus(tti_point{tti});
+    if (not cc.empty()) {
+      cc.get_softbuffers().release_idle(tti_point{tti});
+    }
   }
 }
 
@@ -556,6 +672,7 @@ uint8_t* ue::generate_pdu(uint32_t                              enb_cc_idx,
   if (enb_cc_idx < SRSRAN_MAX_CARRIERS && harq_pid < SRSRAN_FDD_NOF_HARQ && tb_idx < SRSRAN_MAX_TB) {
     srsran::byte_buffer_t* buffer = cc_buffers[enb_cc_idx].get_tx_payload_buffer(harq_pid, tb_idx);
     buffer->clear();
+    buffer->reserve(grant_size);
     mac_msg_dl.init_tx(buffer, grant_size, false);
     for (uint32_t i = 0; i < nof_pdu_elems; i++) {
       if (pdu[i].lcid <= (uint32_t)srsran::ul_sch_lcid::PHR_REPORT) {
@@ -586,6 +703,7 @@ uint8_t* ue::generate_mch_pdu(uint32_t                             harq_pid,
   uint8_t*                    ret    = nullptr;
   srsran::byte_buffer_t*      buffer = cc_buffers[0].get_tx_payload_buffer(harq_pid, 0);
   buffer->clear();
+  buffer->reserve(grant_size);
   mch_mac_msg_dl.init_tx(buffer, grant_size);
 
   for (uint32_t i = 0; i < nof_pdu_elems; i++) {
@@ -44,7 +44,10 @@ namespace srsenb {
 
 rrc::rrc(srsran::task_sched_handle task_sched_, enb_bearer_manager& manager_) :
   logger(srslog::fetch_basic_logger("RRC")), bearer_manager(manager_), task_sched(task_sched_), rx_pdu_queue(128)
-{}
+{
+  // DL messages are packed here first, and then copied into a PDU that fits them
+  dl_pack_buffer.resize(srsran::byte_buffer_class_payload(srsran::byte_buffer_class_t::large));
+}
 
 rrc::~rrc() {}
 
@@ -306,18 +309,11 @@ void rrc::send_rrc_connection_reject(uint16_t rnti)
   dl_ccch_msg_s dl_ccch_msg;
   dl_ccch_msg.msg.set_c1().set_rrc_conn_reject().crit_exts.set_c1().set_rrc_conn_reject_r8().wait_time = 10;
 
-  // Allocate a new PDU buffer, pack the message and send to PDCP
-  srsran::unique_byte_buffer_t pdu = srsran::make_byte_buffer();
+  // Pack the message into a new PDU buffer and send to PDCP
+  srsran::unique_byte_buffer_t pdu = pack_dl_msg(dl_ccch_msg, "DL-CCCH-Msg");
   if (pdu == nullptr) {
-    logger.error("Allocating pdu");
-    return;
-  }
-  asn1::bit_ref bref(pdu->msg, pdu->get_tailroom());
-  if (dl_ccch_msg.pack(bref) != asn1::SRSASN_SUCCESS) {
-    logger.error(pdu->msg, bref.distance_bytes(), "Failed to pack DL-CCCH-Msg:");
     return;
   }
-  pdu->N_bytes = bref.distance_bytes();
 
   log_rrc_message(Tx, rnti, srb_to_lcid(lte_srb::srb0), *pdu, dl_ccch_msg, dl_ccch_msg.msg.c1().type().to_string());
 
@@ -1294,15 +1294,9 @@ void rrc::ue::update_scells()
 
 void rrc::ue::send_dl_ccch(dl_ccch_msg_s* dl_ccch_msg, std::string* octet_str)
 {
-  // Allocate a new PDU buffer, pack the message and send to PDCP
-  srsran::unique_byte_buffer_t pdu = srsran::make_byte_buffer();
+  // Pack the message into a new PDU buffer and send to PDCP
+  srsran::unique_byte_buffer_t pdu = parent->pack_dl_msg(*dl_ccch_msg, "DL-CCCH-Msg");
   if (pdu) {
-    asn1::bit_ref bref(pdu->msg, pdu->get_tailroom());
-    if (dl_ccch_msg->pack(bref) != asn1::SRSASN_SUCCESS) {
-      parent->logger.error(pdu->msg, pdu->N_bytes, "Failed to pack DL-CCCH-Msg:");
-      return;
-    }
-    pdu->N_bytes = (uint32_t)bref.distance_bytes();
 
     // Log Tx message
     parent->log_rrc_message(
@@ -1314,28 +1308,25 @@ void rrc::ue::send_dl_ccch(dl_ccch_msg_s* dl_ccch_msg, std::string* octet_str)
     }
 
     parent->rlc->write_sdu(rnti, srb_to_lcid(lte_srb::srb0), std::move(pdu));
-  } else {
-    parent->logger.error("Allocating pdu");
   }
 }
 
 bool rrc::ue::send_dl_dcch(const dl_dcch_msg_s* dl_dcch_msg, srsran::unique_byte_buffer_t pdu, std::string* octet_str)
 {
   if (pdu == nullptr) {
-    pdu = srsran::make_byte_buffer();
+    pdu = parent->pack_dl_msg(*dl_dcch_msg, "DL-DCCH-Msg");
     if (pdu == nullptr) {
-      parent->logger.error("Allocating pdu");
       return false;
     }
+  } else {
+    asn1::bit_ref bref(pdu->msg, pdu->get_tailroom());
+    if (dl_dcch_msg->pack(bref) == asn1::SRSASN_ERROR_ENCODE_FAIL) {
+      parent->logger.error("Failed to encode DL-DCCH-Msg for rnti=0x%x", rnti);
+      return false;
+    }
+    pdu->N_bytes = (uint32_t)bref.distance_bytes();
   }
 
-  asn1::bit_ref bref(pdu->msg, pdu->get_tailroom());
-  if (dl_dcch_msg->pack(bref) == asn1::SRSASN_ERROR_ENCODE_FAIL) {
-    parent->logger.error("Failed to encode DL-DCCH-Msg for rnti=0x%x", rnti);
-    return false;
-  }
-  pdu->N_bytes = (uint32_t)bref.distance_bytes();
-
   lte_srb rb = lte_srb::srb1;
   if (dl_dcch_msg->msg.c1().type() == dl_dcch_msg_type_c::c1_c_::types_opts::dl_info_transfer) {
     // send messages with NAS on SRB2 if user is fully registered (after RRC reconfig complete)
@@ -227,10 +227,22 @@ void gtpu_tunnel_manager::activate_tunnel(uint32_t teid)
                      const std::pair<uint32_t, srsran::unique_byte_buffer_t>& rhs) { return lhs.first < rhs.first; };
   std::stable_sort(tun.buffer->begin(), tun.buffer->end(), lower_sn);
 
+  // SDUs without a PDCP SN take consecutive SNs, so runs of them are forwarded to PDCP as one burst
+  std::vector<srsran::unique_byte_buffer_t> burst;
   for (auto& sdu_pair : *tun.buffer) {
     uint32_t pdcp_sn = sdu_pair.first;
-    pdcp->write_sdu(
-        tun.rnti, tun.eps_bearer_id, std::move(sdu_pair.second), pdcp_sn == undefined_pdcp_sn ? -1 : pdcp_sn);
+    if (pdcp_sn == undefined_pdcp_sn) {
+      burst.push_back(std::move(sdu_pair.second));
+      continue;
+    }
+    if (not burst.empty()) {
+      pdcp->write_sdus(tun.rnti, tun.eps_bearer_id, burst);
+      burst.clear();
+    }
+    pdcp->write_sdu(tun.rnti, tun.eps_bearer_id, std::move(sdu_pair.second), pdcp_sn);
+  }
+  if (not burst.empty()) {
+    pdcp->write_sdus(tun.rnti, tun.eps_bearer_id, burst);
   }
   tun.buffer.reset();
   tun.state = tunnel_state::pdcp_active;
@@ -411,11 +423,10 @@ int gtpu::init(const gtpu_args_t& gtpu_args, pdcp_interface_gtpu* pdcp_)
     return SRSRAN_ERROR;
   }
 
-  // Assign a handler to rx S1U packets
-  auto rx_callback = [this](srsran::unique_byte_buffer_t pdu, const sockaddr_in& from) {
-    handle_gtpu_s1u_rx_packet(std::move(pdu), from);
-  };
-  rx_socket_handler->add_socket_handler(fd, srsran::make_sdu_handler(logger, gtpu_queue, rx_callback));
+  // Assign a handler to rx S1U packets. The socket is drained on each wake-up, so that bursts of DL packets reach PDCP
+  // as a single write_sdus() call
+  auto rx_callback = [this](std::vector<srsran::rx_datagram_t>& burst) { handle_gtpu_s1u_rx_burst(burst); };
+  rx_socket_handler->add_socket_handler(fd, srsran::make_sdu_burst_handler(logger, gtpu_queue, rx_callback));
 
   // Start MCH socket if enabled
   if (args.embms_enable) {
@@ -612,6 +623,29 @@ void gtpu::handle_end_marker(const gtpu_tunnel& rx_tunnel)
 }
 
 void gtpu::handle_gtpu_s1u_rx_packet(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr)
+{
+  handle_s1u_rx_pdu(std::move(pdu), addr);
+  flush_rx_burst();
+}
+
+void gtpu::handle_gtpu_s1u_rx_burst(std::vector<srsran::rx_datagram_t>& burst)
+{
+  for (srsran::rx_datagram_t& dgram : burst) {
+    handle_s1u_rx_pdu(std::move(dgram.pdu), dgram.from);
+  }
+  flush_rx_burst();
+}
+
+void gtpu::flush_rx_burst()
+{
+  if (rx_burst.sdus.empty()) {
+    return;
+  }
+  pdcp->write_sdus(rx_burst.rnti, rx_burst.eps_bearer_id, rx_burst.sdus);
+  rx_burst.sdus.clear();
+}
+
+void gtpu::handle_s1u_rx_pdu(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr)
 {
   srsran_assert(pdu != nullptr, "Called with null PDU");
 
@@ -646,6 +680,11 @@ void gtpu::handle_gtpu_s1u_rx_packet(srsran::unique_byte_buffer_t pdu, const soc
     return;
   }
 
+  // Anything other than a data PDU of the tunnel being batched is handled after the pending burst, to keep the order
+  if (header.message_type != GTPU_MSG_DATA_PDU or header.teid != rx_burst.teid_in) {
+    flush_rx_burst();
+  }
+
   switch (header.message_type) {
     case GTPU_MSG_DATA_PDU: {
       handle_msg_data_pdu(header, *tun_ptr, std::move(pdu));
@@ -693,7 +732,18 @@ void gtpu::handle_msg_data_pdu(const gtpu_header_t&         header,
       break;
     }
     case gtpu_tunnel_manager::tunnel_state::pdcp_active: {
-      pdcp->write_sdu(rnti, eps_bearer_id, std::move(pdu), pdcp_sn == undefined_pdcp_sn ? -1 : (int)pdcp_sn);
+      if (pdcp_sn != undefined_pdcp_sn) {
+        flush_rx_burst();
+        pdcp->write_sdu(rnti, eps_bearer_id, std::move(pdu), (int)pdcp_sn);
+        break;
+      }
+      // SDUs without a PDCP SN take consecutive SNs, so they are collected and forwarded to PDCP as one burst
+      if (rx_burst.sdus.empty()) {
+        rx_burst.teid_in       = rx_tunnel.teid_in;
+        rx_burst.rnti          = rnti;
+        rx_burst.eps_bearer_id = eps_bearer_id;
+      }
+      rx_burst.sdus.push_back(std::move(pdu));
       break;
     }
     case gtpu_tunnel_manager::tunnel_state::forwarded_from:
@@ -739,7 +789,7 @@ void gtpu::error_indication(in_addr_t addr, in_port_t port, uint32_t err_teid)
   logger.info("TX GTPU Error Indication. Seq: %d, Error TEID: %d", tx_seq, err_teid);
 
   gtpu_header_t        header = {};
-  unique_byte_buffer_t pdu    = make_byte_buffer();
+  unique_byte_buffer_t pdu    = make_sized_byte_buffer(GTPU_EXTENDED_HEADER_LEN);
   if (pdu == nullptr) {
     logger.error("Could not allocate byte buffer for error indication");
     return;
@@ -773,7 +823,7 @@ void gtpu::echo_response(in_addr_t addr, in_port_t port, uint16_t seq)
   logger.info("TX GTPU Echo Response, Seq: %d", seq);
 
   gtpu_header_t        header = {};
-  unique_byte_buffer_t pdu    = make_byte_buffer();
+  unique_byte_buffer_t pdu    = make_sized_byte_buffer(GTPU_EXTENDED_HEADER_LEN);
   if (pdu == nullptr) {
     logger.error("Could not allocate byte buffer for echo response");
     return;
@@ -811,7 +861,7 @@ bool gtpu::send_end_marker(uint32_t teidin)
   logger.info("Tx GTPU End Marker, " TEID_IN_FMT ", rnti=0x%x", teidin, tx_tun->rnti);
 
   gtpu_header_t        header = {};
-  unique_byte_buffer_t pdu    = make_byte_buffer();
+  unique_byte_buffer_t pdu    = make_sized_byte_buffer(GTPU_EXTENDED_HEADER_LEN);
   if (pdu == nullptr) {
     logger.warning("Failed to allocate buffer to send End Marker to TEID=%d", teidin);
     return false;
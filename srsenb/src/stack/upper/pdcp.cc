@@ -184,6 +184,15 @@ void pdcp::write_sdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t
   }
 }
 
+void pdcp::write_sdus(uint16_t rnti, uint32_t lcid, srsran::span<srsran::unique_byte_buffer_t> sdus)
+{
+  if (users.count(rnti) and rnti != SRSRAN_MRNTI) {
+    users[rnti].pdcp->write_sdus(lcid, sdus);
+  } else {
+    pdcp_interface_gtpu::write_sdus(rnti, lcid, sdus);
+  }
+}
+
 void pdcp::send_status_report(uint16_t rnti, uint32_t lcid)
 {
   if (users.count(rnti)) {
@@ -276,4 +285,11 @@ void pdcp::get_metrics(pdcp_metrics_t& m, const uint32_t nof_tti)
   }
 }
 
+void pdcp::get_metrics(std::map<uint32_t, srsran::pdcp_metrics_t>& m, const uint32_t nof_tti)
+{
+  for (auto& user : users) {
+    user.second.pdcp->get_metrics(m[user.first], nof_tti);
+  }
+}
+
 } // namespace srsenb
@@ -0,0 +1,394 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/upper/pdcp_workers.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+namespace srsenb {
+
+/// Worker running in the calling thread, if any
+static thread_local const void* current_worker = nullptr;
+
+pdcp_workers::pdcp_workers(srsran::task_sched_handle task_sched_, srslog::basic_logger& logger_, uint32_t nof_workers) :
+  rrc_itf(this), gtpu_itf(this), rlc_mac_itf(this), ctrl_queue(task_sched_.make_task_queue()), logger(logger_)
+{
+  for (uint32_t i = 0; i < std::max(nof_workers, 1U); ++i) {
+    workers.emplace_back(new worker(i, logger));
+  }
+}
+
+pdcp_workers::~pdcp_workers()
+{
+  stop();
+}
+
+void pdcp_workers::init(rlc_interface_pdcp*  rlc_,
+                        rrc_interface_pdcp*  rrc_,
+                        gtpu_interface_pdcp* gtpu_,
+                        rlc_interface_mac*   rlc_mac_)
+{
+  rrc     = rrc_;
+  gtpu    = gtpu_;
+  rlc_mac = rlc_mac_;
+  for (auto& w : workers) {
+    w->pdcp.init(rlc_, &rrc_itf, &gtpu_itf);
+    w->start_worker();
+  }
+  logger.info("Sharding PDCP of the UEs across %zd workers", workers.size());
+}
+
+void pdcp_workers::stop()
+{
+  for (auto& w : workers) {
+    w->stop_worker();
+  }
+}
+
+void pdcp_workers::tic()
+{
+  for (auto& w : workers) {
+    worker* w_ptr = w.get();
+    w->push([w_ptr]() { w_ptr->task_sched.tic(); });
+  }
+  run_ctrl_tasks();
+}
+
+void pdcp_workers::push_to_ctrl(srsran::move_task_t task)
+{
+  bool wakeup = false;
+  {
+    std::lock_guard<std::mutex> lock(ctrl_mutex);
+    ctrl_tasks.push_back(std::move(task));
+    wakeup              = not ctrl_wakeup_pending;
+    ctrl_wakeup_pending = true;
+  }
+  // Nothing is lost if the stack queue is full, the calls are then run in the next tic()
+  if (wakeup and not ctrl_queue.try_push([this]() { run_ctrl_tasks(); }).has_value()) {
+    logger.debug("Stack task queue is full. Deferring PDCP output to the next TTI");
+  }
+}
+
+void pdcp_workers::run_ctrl_tasks()
+{
+  {
+    std::lock_guard<std::mutex> lock(ctrl_mutex);
+    ctrl_tasks_running.swap(ctrl_tasks);
+    ctrl_wakeup_pending = false;
+  }
+  for (srsran::move_task_t& task : ctrl_tasks_running) {
+    task();
+  }
+  ctrl_tasks_running.clear();
+}
+
+template <typename R, typename F>
+R pdcp_workers::run_sync(worker& w, F&& func)
+{
+  // The configuration calls are only pushed by the control thread, which is the caller, so none can be added meanwhile
+  if (w.nof_pending_cfg.load(std::memory_order_acquire) == 0) {
+    std::lock_guard<std::mutex> lock(w.pdcp_mutex);
+    return func();
+  }
+  std::mutex              mutex;
+  std::condition_variable cvar;
+  bool                    done = false;
+  R                       ret{};
+  w.push([&]() {
+    ret = func();
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    cvar.notify_one();
+  });
+  std::unique_lock<std::mutex> lock(mutex);
+  while (not done) {
+    cvar.wait(lock);
+  }
+  return ret;
+}
+
+/*******************************************************************************
+ *  pdcp_interface_rlc
+ *******************************************************************************/
+
+void pdcp_workers::write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t sdu)
+{
+  worker& w = get_worker(rnti);
+  if (w.is_current()) {
+    // UL RLC PDUs are already processed in the worker of the UE
+    w.pdcp.write_pdu(rnti, lcid, std::move(sdu));
+    return;
+  }
+  auto task = [&w, rnti, lcid](srsran::unique_byte_buffer_t& sdu) { w.pdcp.write_pdu(rnti, lcid, std::move(sdu)); };
+  w.push(std::bind(task, std::move(sdu)));
+}
+
+void pdcp_workers::notify_delivery(uint16_t rnti, uint32_t lcid, const srsran::pdcp_sn_vector_t& pdcp_sns)
+{
+  worker& w = get_worker(rnti);
+  if (w.is_current()) {
+    w.pdcp.notify_delivery(rnti, lcid, pdcp_sns);
+    return;
+  }
+  w.push([&w, rnti, lcid, pdcp_sns]() { w.pdcp.notify_delivery(rnti, lcid, pdcp_sns); });
+}
+
+void pdcp_workers::notify_failure(uint16_t rnti, uint32_t lcid, const srsran::pdcp_sn_vector_t& pdcp_sns)
+{
+  worker& w = get_worker(rnti);
+  if (w.is_current()) {
+    w.pdcp.notify_failure(rnti, lcid, pdcp_sns);
+    return;
+  }
+  w.push([&w, rnti, lcid, pdcp_sns]() { w.pdcp.notify_failure(rnti, lcid, pdcp_sns); });
+}
+
+/*******************************************************************************
+ *  pdcp_interface_rrc
+ *******************************************************************************/
+
+void pdcp_workers::set_enabled(uint16_t rnti, uint32_t lcid, bool enabled)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti, lcid, enabled]() { w.pdcp.set_enabled(rnti, lcid, enabled); });
+}
+
+void pdcp_workers::reset(uint16_t rnti)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti]() { w.pdcp.reset(rnti); });
+}
+
+void pdcp_workers::add_user(uint16_t rnti)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti]() { w.pdcp.add_user(rnti); });
+}
+
+void pdcp_workers::rem_user(uint16_t rnti)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti]() { w.pdcp.rem_user(rnti); });
+}
+
+void pdcp_workers::write_sdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t sdu, int pdcp_sn)
+{
+  worker& w    = get_worker(rnti);
+  auto    task = [&w, rnti, lcid, pdcp_sn](srsran::unique_byte_buffer_t& sdu) {
+    w.pdcp.write_sdu(rnti, lcid, std::move(sdu), pdcp_sn);
+  };
+  w.push(std::bind(task, std::move(sdu)));
+}
+
+void pdcp_workers::add_bearer(uint16_t rnti, uint32_t lcid, const srsran::pdcp_config_t& cfg)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti, lcid, cfg]() { w.pdcp.add_bearer(rnti, lcid, cfg); });
+}
+
+void pdcp_workers::del_bearer(uint16_t rnti, uint32_t lcid)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti, lcid]() { w.pdcp.del_bearer(rnti, lcid); });
+}
+
+void pdcp_workers::config_security(uint16_t rnti, uint32_t lcid, const srsran::as_security_config_t& sec_cfg)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti, lcid, sec_cfg]() { w.pdcp.config_security(rnti, lcid, sec_cfg); });
+}
+
+void pdcp_workers::enable_integrity(uint16_t rnti, uint32_t lcid)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti, lcid]() { w.pdcp.enable_integrity(rnti, lcid); });
+}
+
+void pdcp_workers::enable_encryption(uint16_t rnti, uint32_t lcid)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti, lcid]() { w.pdcp.enable_encryption(rnti, lcid); });
+}
+
+bool pdcp_workers::get_bearer_state(uint16_t rnti, uint32_t lcid, srsran::pdcp_lte_state_t* state)
+{
+  worker& w = get_worker(rnti);
+  return run_sync<bool>(w, [&w, rnti, lcid, state]() { return w.pdcp.get_bearer_state(rnti, lcid, state); });
+}
+
+bool pdcp_workers::set_bearer_state(uint16_t rnti, uint32_t lcid, const srsran::pdcp_lte_state_t& state)
+{
+  // Applied before any later call for the UE. The UEs are only known to the workers, so the result is not waited for
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti, lcid, state]() { w.pdcp.set_bearer_state(rnti, lcid, state); });
+  return true;
+}
+
+void pdcp_workers::send_status_report(uint16_t rnti)
+{
+  worker& w = get_worker(rnti);
+  w.push([&w, rnti]() { w.pdcp.send_status_report(rnti); });
+}
+
+void pdcp_workers::send_status_report(uint16_t rnti, uint32_t lcid)
+{
+  worker& w = get_worker(rnti);
+  w.push([&w, rnti, lcid]() { w.pdcp.send_status_report(rnti, lcid); });
+}
+
+void pdcp_workers::reestablish(uint16_t rnti)
+{
+  worker& w = get_worker(rnti);
+  w.push_cfg([&w, rnti]() { w.pdcp.reestablish(rnti); });
+}
+
+/*******************************************************************************
+ *  pdcp_interface_gtpu
+ *******************************************************************************/
+
+void pdcp_workers::write_sdus(uint16_t rnti, uint32_t lcid, srsran::span<srsran::unique_byte_buffer_t> sdus)
+{
+  std::vector<srsran::unique_byte_buffer_t> burst;
+  burst.reserve(sdus.size());
+  for (srsran::unique_byte_buffer_t& sdu : sdus) {
+    burst.push_back(std::move(sdu));
+  }
+  worker& w    = get_worker(rnti);
+  auto    task = [&w, rnti, lcid](std::vector<srsran::unique_byte_buffer_t>& burst) {
+    w.pdcp.write_sdus(rnti, lcid, burst);
+  };
+  w.push(std::bind(task, std::move(burst)));
+}
+
+std::map<uint32_t, srsran::unique_byte_buffer_t> pdcp_workers::get_buffered_pdus(uint16_t rnti, uint32_t lcid)
+{
+  worker& w = get_worker(rnti);
+  return run_sync<std::map<uint32_t, srsran::unique_byte_buffer_t> >(
+      w, [&w, rnti, lcid]() { return w.pdcp.get_buffered_pdus(rnti, lcid); });
+}
+
+void pdcp_workers::get_metrics(pdcp_metrics_t& m, const uint32_t nof_tti)
+{
+  // UE metrics are reported in RNTI order, as done by the other layers
+  std::map<uint32_t, srsran::pdcp_metrics_t> ue_metrics;
+  for (auto& w : workers) {
+    std::lock_guard<std::mutex> lock(w->pdcp_mutex);
+    w->pdcp.get_metrics(ue_metrics, nof_tti);
+  }
+  m.ues.clear();
+  for (auto& ue : ue_metrics) {
+    m.ues.push_back(ue.second);
+  }
+}
+
+/*******************************************************************************
+ *  Interfaces towards the control thread
+ *******************************************************************************/
+
+void pdcp_workers::rrc_proxy::write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t pdu)
+{
+  rrc_interface_pdcp* rrc  = parent->rrc;
+  auto                task = [rrc, rnti, lcid](srsran::unique_byte_buffer_t& pdu) {
+    rrc->write_pdu(rnti, lcid, std::move(pdu));
+  };
+  parent->push_to_ctrl(std::bind(task, std::move(pdu)));
+}
+
+void pdcp_workers::rrc_proxy::notify_pdcp_integrity_error(uint16_t rnti, uint32_t lcid)
+{
+  rrc_interface_pdcp* rrc = parent->rrc;
+  parent->push_to_ctrl([rrc, rnti, lcid]() { rrc->notify_pdcp_integrity_error(rnti, lcid); });
+}
+
+void pdcp_workers::gtpu_proxy::write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t pdu)
+{
+  gtpu_interface_pdcp* gtpu = parent->gtpu;
+  auto                 task = [gtpu, rnti, lcid](srsran::unique_byte_buffer_t& pdu) {
+    gtpu->write_pdu(rnti, lcid, std::move(pdu));
+  };
+  parent->push_to_ctrl(std::bind(task, std::move(pdu)));
+}
+
+int pdcp_workers::rlc_mac_proxy::read_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
+{
+  return parent->rlc_mac->read_pdu(rnti, lcid, payload, nof_bytes);
+}
+
+void pdcp_workers::rlc_mac_proxy::write_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
+{
+  // The payload belongs to the MAC PDU, so it is copied before leaving the MAC thread
+  srsran::unique_byte_buffer_t pdu = srsran::make_sized_byte_buffer(nof_bytes);
+  if (pdu == nullptr or pdu->get_tailroom() < nof_bytes) {
+    parent->logger.error("Unable to allocate byte buffer for UL RLC PDU of rnti=0x%x, lcid=%d", rnti, lcid);
+    return;
+  }
+  pdu->append_bytes(payload, nof_bytes);
+
+  rlc_interface_mac* rlc_mac = parent->rlc_mac;
+  auto               task    = [rlc_mac, rnti, lcid](srsran::unique_byte_buffer_t& pdu) {
+    rlc_mac->write_pdu(rnti, lcid, pdu->msg, pdu->N_bytes);
+  };
+  parent->get_worker(rnti).push(std::bind(task, std::move(pdu)));
+}
+
+/*******************************************************************************
+ *  Worker
+ *******************************************************************************/
+
+pdcp_workers::worker::worker(uint32_t idx, srslog::basic_logger& logger) :
+  thread("PDCP" + std::to_string(idx)), task_sched(512, 128), pdcp(&task_sched, logger)
+{
+  queue = task_sched.make_task_queue();
+}
+
+void pdcp_workers::worker::start_worker()
+{
+  running = true;
+  start();
+}
+
+void pdcp_workers::worker::stop_worker()
+{
+  if (running) {
+    push([this]() {
+      pdcp.stop();
+      running = false;
+    });
+    wait_thread_finish();
+    task_sched.stop();
+  }
+}
+
+bool pdcp_workers::worker::is_current() const
+{
+  return current_worker == this;
+}
+
+void pdcp_workers::worker::run_thread()
+{
+  current_worker = this;
+  while (running.load(std::memory_order_relaxed)) {
+    task_sched.run_next_task();
+  }
+}
+
+} // namespace srsenb
@@ -0,0 +1,155 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "sched_nr_cfg_generators.h"
+#include "sched_nr_sim_ue.h"
+#include "srsran/common/test_common.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+namespace srsenb {
+
+struct run_params {
+  uint32_t nof_sectors;
+  uint32_t nof_workers;
+  uint32_t nof_ues;
+  uint32_t nof_slots;
+};
+
+struct run_result {
+  run_params params;
+  double     avg_latency_us;
+  double     p50_latency_us;
+  double     p99_latency_us;
+  double     max_latency_us;
+  double     pdschs_per_slot;
+};
+
+/// Stores the time taken by the scheduler to generate the results of all carriers of each slot
+class sched_nr_bench_tester : public sched_nr_base_tester
+{
+public:
+  using sched_nr_base_tester::sched_nr_base_tester;
+
+  void process_slot_result(const sim_nr_enb_ctxt_t& slot_ctxt, srsran::const_span<cc_result_t> cc_list) override
+  {
+    if (not measuring) {
+      return;
+    }
+    auto slot_latency =
+        std::max_element(cc_list.begin(), cc_list.end(), [](const cc_result_t& lhs, const cc_result_t& rhs) {
+          return lhs.cc_latency_ns < rhs.cc_latency_ns;
+        })->cc_latency_ns;
+    latency_samples.push_back(slot_latency.count());
+    for (const cc_result_t& cc_out : cc_list) {
+      pdsch_count += cc_out.dl_res.pdsch.size();
+    }
+  }
+
+  bool                  measuring   = false;
+  uint64_t              pdsch_count = 0;
+  std::vector<uint64_t> latency_samples;
+};
+
+run_result run_benchmark_scenario(const run_params& params)
+{
+  sched_nr_interface::sched_args_t cfg;
+  cfg.auto_refill_buffer = true;
+
+  std::vector<sched_nr_interface::cell_cfg_t> cells_cfg = get_default_cells_cfg(params.nof_sectors);
+
+  std::string test_name =
+      fmt::format("Benchmark with {} cells, {} workers, {} UEs", params.nof_sectors, params.nof_workers, params.nof_ues);
+  sched_nr_bench_tester tester(cfg, cells_cfg, test_name, params.nof_workers);
+  tester.latency_samples.reserve(params.nof_slots);
+
+  // Add one UE per frame, and let all of them complete the RA procedure before measuring
+  uint32_t nof_warmup_slots = 10 * params.nof_ues + 100;
+  for (uint32_t count = 0; count < nof_warmup_slots + params.nof_slots; ++count) {
+    slot_point slot_rx(0, count % 10240);
+    slot_point slot_tx = slot_rx + TX_ENB_DELAY;
+    if (slot_rx.to_uint() % 10 == 9 and count / 10 < params.nof_ues) {
+      sched_nr_interface::ue_cfg_t uecfg = get_default_ue_cfg(params.nof_sectors);
+      TESTASSERT(tester.add_user(0x4601 + count / 10, uecfg, slot_rx, count / 10) == SRSRAN_SUCCESS);
+    }
+    tester.measuring = count >= nof_warmup_slots;
+    tester.run_slot(slot_tx);
+  }
+  tester.stop();
+
+  std::vector<uint64_t>& samples = tester.latency_samples;
+  std::sort(samples.begin(), samples.end());
+  run_result r      = {};
+  r.params          = params;
+  r.avg_latency_us  = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size() / 1e3;
+  r.p50_latency_us  = samples[samples.size() / 2] / 1e3;
+  r.p99_latency_us  = samples[samples.size() * 99 / 100] / 1e3;
+  r.max_latency_us  = samples.back() / 1e3;
+  r.pdschs_per_slot = tester.pdsch_count / static_cast<double>(samples.size());
+  return r;
+}
+
+void run_benchmark(uint32_t nof_slots)
+{
+  std::vector<run_result> results;
+  for (uint32_t nof_sectors : {1, 2, 4}) {
+    for (uint32_t nof_workers : {1, 2, 4}) {
+      if (nof_workers > nof_sectors) {
+        continue;
+      }
+      results.push_back(run_benchmark_scenario(run_params{nof_sectors, nof_workers, 4, nof_slots}));
+    }
+  }
+
+  srslog::flush();
+  fmt::print("\ncells | workers | Nue | PDSCHs/slot | slot latency avg/p50/p99/max [usec]\n");
+  fmt::print("---------------------------------------------------------------------------\n");
+  for (const run_result& r : results) {
+    fmt::print("{:>5d} {:>9d} {:>5d} {:>13.2f} {:>14.1f}/{:.1f}/{:.1f}/{:.1f}\n",
+               r.params.nof_sectors,
+               r.params.nof_workers,
+               r.params.nof_ues,
+               r.pdschs_per_slot,
+               r.avg_latency_us,
+               r.p50_latency_us,
+               r.p99_latency_us,
+               r.max_latency_us);
+  }
+}
+
+} // namespace srsenb
+
+int main(int argc, char** argv)
+{
+  auto& test_logger = srslog::fetch_basic_logger("TEST");
+  test_logger.set_level(srslog::basic_levels::warning);
+  auto& mac_nr_logger = srslog::fetch_basic_logger("MAC-NR");
+  mac_nr_logger.set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  // Short run by default, so that it can be run as a test
+  bool long_run = argc > 1 and strcmp(argv[1], "benchmark") == 0;
+  srsenb::run_benchmark(long_run ? 20000 : 1000);
+}
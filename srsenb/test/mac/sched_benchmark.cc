@@ -21,9 +21,13 @@
 
 #include "sched_test_common.h"
 #include "srsenb/hdr/stack/mac/sched.h"
+#include "srsenb/hdr/stack/mac/sched_phy_ch/sf_cch_allocator.h"
+#include "srsenb/hdr/stack/mac/schedulers/sched_time_pf_soa.h"
 #include "srsran/adt/accumulators.h"
 #include "srsran/common/common_lte.h"
 #include <chrono>
+#include <queue>
+#include <thread>
 
 namespace srsenb {
 
@@ -33,6 +37,8 @@ struct run_params {
   uint32_t    nof_ttis;
   uint32_t    cqi;
   const char* sched_policy;
+  uint32_t    lookahead_tti;
+  uint32_t    tti_period_us; ///< wall-clock duration of a TTI. 0 runs the TTIs back-to-back
 };
 
 struct run_params_range {
@@ -40,20 +46,28 @@ struct run_params_range {
   std::vector<uint32_t>    nof_ues      = {1, 2, 5, 32};
   uint32_t                 nof_ttis     = 10000;
   std::vector<uint32_t>    cqi          = {5, 10, 15};
-  std::vector<const char*> sched_policy = {"time_rr", "time_pf"};
+  std::vector<const char*> sched_policy  = {"time_rr", "time_pf", "time_pf_soa"};
+  std::vector<uint32_t>    lookahead_tti = {0};
+  uint32_t                 tti_period_us = 0;
 
-  size_t     nof_runs() const { return nof_prbs.size() * nof_ues.size() * cqi.size() * sched_policy.size(); }
+  size_t nof_runs() const
+  {
+    return nof_prbs.size() * nof_ues.size() * cqi.size() * sched_policy.size() * lookahead_tti.size();
+  }
   run_params get_params(size_t idx) const
   {
-    run_params r = {};
-    r.nof_ttis   = nof_ttis;
-    r.nof_prbs   = nof_prbs[idx % nof_prbs.size()];
+    run_params r    = {};
+    r.nof_ttis      = nof_ttis;
+    r.tti_period_us = tti_period_us;
+    r.nof_prbs      = nof_prbs[idx % nof_prbs.size()];
     idx /= nof_prbs.size();
     r.nof_ues = nof_ues[idx % nof_ues.size()];
     idx /= nof_ues.size();
     r.cqi = cqi[idx % cqi.size()];
     idx /= cqi.size();
-    r.sched_policy = sched_policy.at(idx);
+    r.sched_policy = sched_policy[idx % sched_policy.size()];
+    idx /= sched_policy.size();
+    r.lookahead_tti = lookahead_tti.at(idx);
     return r;
   }
 };
@@ -160,21 +174,29 @@ public:
 };
 
 struct run_data {
-  run_params                params;
-  float                     avg_dl_throughput;
-  float                     avg_ul_throughput;
-  float                     avg_dl_mcs;
-  float                     avg_ul_mcs;
-  std::chrono::microseconds avg_latency;
-  std::chrono::microseconds q0_9_latency;
+  run_params               params;
+  float                    avg_dl_throughput;
+  float                    avg_ul_throughput;
+  float                    avg_dl_mcs;
+  float                    avg_ul_mcs;
+  std::chrono::nanoseconds avg_latency;
+  std::chrono::nanoseconds p50_latency;
+  std::chrono::nanoseconds p99_latency;
+  std::chrono::nanoseconds p999_latency;
+  std::chrono::nanoseconds max_latency;
 };
 
 int run_benchmark_scenario(run_params params, std::vector<run_data>& run_results)
 {
   std::vector<sched_interface::cell_cfg_t> cell_list(1, generate_default_cell_cfg(params.nof_prbs));
+  if (params.lookahead_tti > 0) {
+    // The TTIs computed ahead of the PRACH detection shorten the RAR window. Use the window of sib.conf.example
+    cell_list[0].prach_rar_window = 10;
+  }
   sched_interface::ue_cfg_t                ue_cfg_default = generate_default_ue_cfg();
   sched_interface::sched_args_t            sched_args     = {};
   sched_args.sched_policy                                 = params.sched_policy;
+  sched_args.lookahead_tti                                = params.lookahead_tti;
 
   sched     sched_obj;
   rrc_dummy rrc{};
@@ -209,10 +231,21 @@ int run_benchmark_scenario(run_params params, std::vector<run_data>& run_results
   // Run benchmark
   tester.total_stats = {};
   tester.total_stats.latency_samples.reserve(params.nof_ttis);
+  std::chrono::steady_clock::time_point tti_deadline = std::chrono::steady_clock::now();
   for (uint32_t count = 0; count < params.nof_ttis; ++count) {
     tester.advance_tti();
+    if (params.tti_period_us > 0) {
+      // Emulate the rest of the PHY processing of the TTI, during which the scheduler may run ahead
+      tti_deadline += std::chrono::microseconds(params.tti_period_us);
+      std::this_thread::sleep_until(tti_deadline);
+    }
   }
-  std::sort(tester.total_stats.latency_samples.begin(), tester.total_stats.latency_samples.end());
+  sched_obj.stop();
+  std::vector<uint32_t>& samples = tester.total_stats.latency_samples;
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&samples](double q) {
+    return std::chrono::nanoseconds(samples[std::min(static_cast<size_t>(samples.size() * q), samples.size() - 1)]);
+  };
 
   run_data run_result          = {};
   run_result.params            = params;
@@ -220,9 +253,11 @@ int run_benchmark_scenario(run_params params, std::vector<run_data>& run_results
   run_result.avg_ul_throughput = tester.total_stats.mean_ul_tbs.value() * 8.0F / 1e-3F;
   run_result.avg_dl_mcs        = tester.total_stats.avg_dl_mcs.value();
   run_result.avg_ul_mcs        = tester.total_stats.avg_ul_mcs.value();
-  run_result.avg_latency  = std::chrono::microseconds(static_cast<int>(tester.total_stats.avg_latency.value() / 1000));
-  run_result.q0_9_latency = std::chrono::microseconds(
-      tester.total_stats.latency_samples[static_cast<size_t>(tester.total_stats.latency_samples.size() * 0.9)] / 1000);
+  run_result.avg_latency       = std::chrono::nanoseconds(static_cast<int64_t>(tester.total_stats.avg_latency.value()));
+  run_result.p50_latency       = percentile(0.5);
+  run_result.p99_latency       = percentile(0.99);
+  run_result.p999_latency      = percentile(0.999);
+  run_result.max_latency       = std::chrono::nanoseconds(samples.back());
   run_results.push_back(run_result);
 
   return SRSRAN_SUCCESS;
@@ -258,16 +293,19 @@ run_data expected_run_result(run_params params)
       ret.avg_ul_throughput *= 0.84;
       break;
   }
+  // With lookahead, a DL HARQ only becomes available again lookahead_tti TTIs after its ACK is received
+  ret.avg_dl_throughput *= static_cast<float>(sched_ue_cell::SCHED_MAX_HARQ_PROC) /
+                           static_cast<float>(sched_ue_cell::SCHED_MAX_HARQ_PROC + params.lookahead_tti);
   return ret;
 }
 
 void print_benchmark_results(const std::vector<run_data>& run_results)
 {
   srslog::flush();
-  fmt::print("run | Nprb | cqi | sched pol | Nue | DL/UL [Mbps] | DL/UL mcs | DL/UL OH [%] | latency | latency q0.9 "
-             "[usec]\n");
+  fmt::print("run | Nprb | cqi | sched pol | Nue | la | DL/UL [Mbps] | DL/UL mcs | DL/UL OH [%] | latency avg/p50/p99/"
+             "p99.9/max [usec]\n");
   fmt::print("------------------------------------------------------------------------------------------------------"
-             "------\n");
+             "-----------------------\n");
   for (uint32_t i = 0; i < run_results.size(); ++i) {
     const run_data& r = run_results[i];
 
@@ -279,20 +317,25 @@ void print_benchmark_results(const std::vector<run_data>& run_results)
     tbs                     = srsran_ra_tbs_from_idx(tbs_idx, nof_pusch_prbs);
     float ul_rate_overhead  = 1.0F - r.avg_ul_throughput / (static_cast<float>(tbs) * 1e3F);
 
-    fmt::print("{:>3d}{:>6d}{:>6d}{:>12}{:>6d}{:>9.2}/{:>4.2}{:>9.1f}/{:>4.1f}{:9.1f}/{:>4.1f}{:>9d}{:12d}\n",
+    fmt::print("{:>3d}{:>6d}{:>6d}{:>12}{:>6d}{:>5d}{:>9.2}/{:>4.2}{:>9.1f}/{:>4.1f}{:9.1f}/{:>4.1f}{:>9.1f}/{:.1f}/{:.1f}/"
+               "{:.1f}/{:.1f}\n",
                i,
                r.params.nof_prbs,
                r.params.cqi,
                r.params.sched_policy,
                r.params.nof_ues,
+               r.params.lookahead_tti,
                r.avg_dl_throughput / 1e6,
                r.avg_ul_throughput / 1e6,
                r.avg_dl_mcs,
                r.avg_ul_mcs,
                dl_rate_overhead * 100,
                ul_rate_overhead * 100,
-               r.avg_latency.count(),
-               r.q0_9_latency.count());
+               r.avg_latency.count() / 1e3,
+               r.p50_latency.count() / 1e3,
+               r.p99_latency.count() / 1e3,
+               r.p999_latency.count() / 1e3,
+               r.max_latency.count() / 1e3);
   }
 }
 
@@ -302,8 +345,9 @@ int run_rate_test()
   run_params_range      run_param_list{};
   srslog::basic_logger& mac_logger = srslog::fetch_basic_logger("MAC");
 
-  run_param_list.nof_ues = {1};
-  run_param_list.cqi     = {15};
+  run_param_list.nof_ues       = {1};
+  run_param_list.cqi           = {15};
+  run_param_list.lookahead_tti = {0, 1};
 
   std::vector<run_data> run_results;
   size_t                nof_runs = run_param_list.nof_runs();
@@ -394,6 +438,250 @@ int run_benchmark()
   return SRSRAN_SUCCESS;
 }
 
+int run_lookahead_benchmark()
+{
+  run_params_range      run_param_list{};
+  srslog::basic_logger& mac_logger = srslog::fetch_basic_logger("MAC");
+
+  run_param_list.nof_ttis      = 5000;
+  run_param_list.tti_period_us = 500;
+  run_param_list.nof_prbs      = {100};
+  run_param_list.cqi           = {15};
+  run_param_list.nof_ues       = {5, 32};
+  run_param_list.sched_policy  = {"time_pf"};
+  run_param_list.lookahead_tti = {0, 1, 2};
+
+  std::vector<run_data> run_results;
+  size_t                nof_runs = run_param_list.nof_runs();
+  fmt::print("Running lookahead benchmark (TTI period of {} usec)\n", run_param_list.tti_period_us);
+  for (size_t r = 0; r < nof_runs; ++r) {
+    run_params runparams = run_param_list.get_params(r);
+
+    mac_logger.info("\n### New run {} ###\n", r);
+    TESTASSERT(run_benchmark_scenario(runparams, run_results) == SRSRAN_SUCCESS);
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+/// Measures the time spent by the PDCCH allocator in subframes where more UEs than PDCCH space are scheduled
+int run_pdcch_benchmark()
+{
+  using rand_uint             = std::uniform_int_distribution<uint32_t>;
+  const uint32_t nof_prbs     = 100;
+  const uint32_t nof_ttis     = 2000;
+  const size_t   max_nof_dcis = sf_cch_allocator::alloc_result_t{}.capacity();
+
+  fmt::print("\n====== PDCCH Allocator Benchmark ======\n\n");
+  fmt::print(" algo  | Nprb | Nue | DCIs/TTI | alloc time per TTI avg/p50/p99/max [usec] | max per DCI [usec]\n");
+  fmt::print("------------------------------------------------------------------------------------------\n");
+  for (const char* algo : {"dfs", "bitmap"}) {
+    for (uint32_t nof_ues : {64, 128, 256}) {
+      std::vector<sched_cell_params_t> cell_params(1);
+      sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
+      sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(nof_prbs);
+      sched_interface::sched_args_t    sched_args{};
+      sched_args.pdcch_alloc_algo = algo;
+      TESTASSERT(cell_params[0].set_cfg(0, cell_cfg, sched_args));
+
+      std::vector<std::unique_ptr<sched_ue>> ues;
+      for (uint32_t i = 0; i < nof_ues; ++i) {
+        ues.emplace_back(new sched_ue{static_cast<uint16_t>(0x46 + i), cell_params, ue_cfg});
+      }
+      sf_cch_allocator pdcch;
+      pdcch.init(cell_params[0]);
+
+      // Same sequence of DCI requests for all algorithms
+      std::mt19937                     rand_gen(nof_ues);
+      std::vector<uint32_t>            tti_samples;
+      std::chrono::nanoseconds         max_dci_latency{0};
+      srsran::rolling_average<double>  avg_latency, avg_nof_dcis;
+      tti_samples.reserve(nof_ttis);
+      for (uint32_t tti = 0; tti < nof_ttis; ++tti) {
+        pdcch.new_tti(tti_point{tti});
+        std::chrono::nanoseconds tti_latency{0};
+        for (uint32_t i = 0; i < nof_ues and pdcch.nof_allocs() < max_nof_dcis; ++i) {
+          sched_ue*    ue         = ues[rand_uint{0, nof_ues - 1}(rand_gen)].get();
+          alloc_type_t alloc_type = rand_uint{0, 1}(rand_gen) == 0 ? alloc_type_t::DL_DATA : alloc_type_t::UL_DATA;
+          uint32_t     aggr_idx   = rand_uint{0, 3}(rand_gen);
+
+          auto tp = std::chrono::steady_clock::now();
+          pdcch.alloc_dci(alloc_type, aggr_idx, ue, false);
+          auto dci_latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tp);
+          tti_latency += dci_latency;
+          max_dci_latency = std::max(max_dci_latency, dci_latency);
+        }
+        tti_samples.push_back(tti_latency.count());
+        avg_latency.push(tti_latency.count());
+        avg_nof_dcis.push(pdcch.nof_allocs());
+      }
+
+      std::sort(tti_samples.begin(), tti_samples.end());
+      fmt::print("{:>6} {:>6d} {:>5d} {:>10.1f} {:>16.1f}/{:.1f}/{:.1f}/{:.1f} {:>20.1f}\n",
+                 algo,
+                 nof_prbs,
+                 nof_ues,
+                 avg_nof_dcis.value(),
+                 avg_latency.value() / 1e3,
+                 tti_samples[tti_samples.size() / 2] / 1e3,
+                 tti_samples[tti_samples.size() * 99 / 100] / 1e3,
+                 tti_samples.back() / 1e3,
+                 max_dci_latency.count() / 1e3);
+    }
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+/// Compares the PF scheduling policies, and their UE selection at UE counts above the scheduler UE limit
+int run_pf_benchmark()
+{
+  run_params_range      run_param_list{};
+  srslog::basic_logger& mac_logger = srslog::fetch_basic_logger("MAC");
+
+  run_param_list.nof_ttis     = 5000;
+  run_param_list.nof_prbs     = {100};
+  run_param_list.cqi          = {15};
+  run_param_list.nof_ues      = {32, SRSENB_MAX_UES};
+  run_param_list.sched_policy = {"time_pf", "time_pf_soa"};
+
+  std::vector<run_data> run_results;
+  size_t                nof_runs = run_param_list.nof_runs();
+  fmt::print("Running PF scheduler benchmark\n");
+  for (size_t r = 0; r < nof_runs; ++r) {
+    run_params runparams = run_param_list.get_params(r);
+
+    mac_logger.info("\n### New run {} ###\n", r);
+    TESTASSERT(run_benchmark_scenario(runparams, run_results) == SRSRAN_SUCCESS);
+  }
+  print_benchmark_results(run_results);
+
+  // UE selection alone, with the same sequence of channel quality and allocation events for both policies. Per TTI,
+  // a fraction of UEs reports a new CQI and only the first nof_allocs UEs in priority order get an allocation
+  using rand_uint                = std::uniform_int_distribution<uint32_t>;
+  const uint32_t nof_ttis        = 20000;
+  const uint32_t nof_allocs      = 8;
+  const float    fairness_coeff  = 2;
+  const float    alpha           = 0.01;
+  const uint32_t cqi_change_prob = 10; // in %
+  const uint32_t retx_prob       = 10; // in %
+
+  fmt::print("\n====== PF UE Selection Benchmark ======\n\n");
+  fmt::print("   policy   | Nue | selection time per TTI avg/p50/p99/max [usec] | Jain fairness index\n");
+  fmt::print("----------------------------------------------------------------------------------\n");
+  for (uint32_t nof_ues : {64, 128, 256}) {
+    for (uint32_t policy = 0; policy < 2; ++policy) {
+      // time_pf UE history and priority queue
+      struct ue_ctxt {
+        float    r = 0, R = 0, prio = 0;
+        uint32_t nof_samples = 0;
+        bool     retx        = false;
+        uint32_t idx         = 0;
+      };
+      auto cmp = [](const ue_ctxt* lhs, const ue_ctxt* rhs) {
+        return (not lhs->retx and rhs->retx) or (lhs->retx == rhs->retx and lhs->prio < rhs->prio);
+      };
+      std::vector<ue_ctxt>  ues(nof_ues);
+      std::vector<ue_ctxt*> queue_storage;
+      queue_storage.reserve(nof_ues);
+      std::priority_queue<ue_ctxt*, std::vector<ue_ctxt*>, decltype(cmp)> queue(cmp, std::move(queue_storage));
+      for (uint32_t i = 0; i < nof_ues; ++i) {
+        ues[i].idx = i;
+      }
+      // time_pf_soa UE metrics
+      pf_soa_metrics metrics(fairness_coeff, alpha);
+      for (uint32_t i = 0; i < nof_ues; ++i) {
+        metrics.push_back();
+      }
+
+      std::mt19937                    rand_gen(nof_ues);
+      std::vector<uint32_t>           tti_samples;
+      std::vector<float>              exp_rates(nof_ues);
+      std::vector<bool>               is_retx(nof_ues);
+      std::vector<double>             total_bytes(nof_ues, 0);
+      srsran::rolling_average<double> avg_latency;
+      tti_samples.reserve(nof_ttis);
+      for (uint32_t tti = 0; tti < nof_ttis; ++tti) {
+        // Generate the events of this TTI outside of the measured interval
+        std::vector<uint32_t> cqi_changes;
+        for (uint32_t i = 0; i < nof_ues; ++i) {
+          if (tti == 0 or rand_uint{0, 99}(rand_gen) < cqi_change_prob) {
+            exp_rates[i] = rand_uint{100, 10000}(rand_gen);
+            cqi_changes.push_back(i);
+          }
+          is_retx[i] = rand_uint{0, 99}(rand_gen) < retx_prob;
+        }
+        std::array<uint32_t, nof_allocs> selected;
+
+        auto tp = std::chrono::steady_clock::now();
+        if (policy == 0) {
+          for (ue_ctxt& u : ues) {
+            u.r    = exp_rates[u.idx];
+            u.retx = is_retx[u.idx];
+            u.prio = (u.R != 0) ? u.r / pow(u.R, fairness_coeff) : (u.r == 0 ? 0 : std::numeric_limits<float>::max());
+            queue.push(&u);
+          }
+          for (uint32_t count = 0; not queue.empty(); ++count) {
+            ue_ctxt& u           = *queue.top();
+            uint32_t alloc_bytes = count < nof_allocs ? u.r : 0;
+            if (u.nof_samples < 1 / alpha) {
+              u.R = u.R + (alloc_bytes - u.R) / (u.nof_samples + 1);
+            } else {
+              u.R = (1 - alpha) * u.R + alpha * alloc_bytes;
+            }
+            u.nof_samples++;
+            if (count < nof_allocs) {
+              selected[count] = u.idx;
+            }
+            queue.pop();
+          }
+        } else {
+          for (uint32_t i : cqi_changes) {
+            metrics.set_expected_rate(i, exp_rates[i]);
+          }
+          metrics.clear_candidates();
+          for (uint32_t i = 0; i < nof_ues; ++i) {
+            metrics.push_candidate(i, is_retx[i]);
+          }
+          metrics.compute_priorities();
+          for (uint32_t count = 0; count < nof_allocs; ++count) {
+            int idx = metrics.pop_candidate();
+            metrics.save_alloc(idx, exp_rates[idx]);
+            selected[count] = idx;
+          }
+          metrics.pop_remaining([&metrics](uint32_t idx) { metrics.save_alloc(idx, 0); });
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tp);
+        tti_samples.push_back(latency.count());
+        avg_latency.push(latency.count());
+        for (uint32_t i : selected) {
+          total_bytes[i] += exp_rates[i];
+        }
+      }
+
+      // Both policies should be equally fair. The exact UE sequence differs, as ties are broken differently
+      double sum = 0, sum_sq = 0;
+      for (double b : total_bytes) {
+        sum += b;
+        sum_sq += b * b;
+      }
+      std::sort(tti_samples.begin(), tti_samples.end());
+      fmt::print("{:>11} {:>5d} {:>22.2f}/{:.2f}/{:.2f}/{:.2f} {:>18.3f}\n",
+                 policy == 0 ? "time_pf" : "time_pf_soa",
+                 nof_ues,
+                 avg_latency.value() / 1e3,
+                 tti_samples[tti_samples.size() / 2] / 1e3,
+                 tti_samples[tti_samples.size() * 99 / 100] / 1e3,
+                 tti_samples.back() / 1e3,
+                 sum * sum / (nof_ues * sum_sq));
+    }
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
 } // namespace srsenb
 
 int main(int argc, char* argv[])
@@ -424,6 +712,12 @@ int main(int argc, char* argv[])
     TESTASSERT(srsenb::run_rate_test() == SRSRAN_SUCCESS);
   } else if (strcmp(argv[1], "benchmark") == 0) {
     TESTASSERT(srsenb::run_benchmark() == SRSRAN_SUCCESS);
+  } else if (strcmp(argv[1], "lookahead") == 0) {
+    TESTASSERT(srsenb::run_lookahead_benchmark() == SRSRAN_SUCCESS);
+  } else if (strcmp(argv[1], "pdcch") == 0) {
+    TESTASSERT(srsenb::run_pdcch_benchmark() == SRSRAN_SUCCESS);
+  } else if (strcmp(argv[1], "pf") == 0) {
+    TESTASSERT(srsenb::run_pf_benchmark() == SRSRAN_SUCCESS);
   } else {
     TESTASSERT(srsenb::run_all() == SRSRAN_SUCCESS);
   }
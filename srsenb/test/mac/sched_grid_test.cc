@@ -37,7 +37,7 @@ uint32_t get_aggr_level(sched_ue& sched_ue, uint32_t enb_cc_idx, const std::vect
   return aggr_level;
 }
 
-int test_pdcch_one_ue()
+int test_pdcch_one_ue(const char* pdcch_alloc_algo)
 {
   using rand_uint           = std::uniform_int_distribution<uint32_t>;
   const uint32_t ENB_CC_IDX = 0;
@@ -52,6 +52,7 @@ int test_pdcch_one_ue()
   sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
   sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(nof_prb);
   sched_interface::sched_args_t    sched_args{};
+  sched_args.pdcch_alloc_algo = pdcch_alloc_algo;
   TESTASSERT(cell_params[ENB_CC_IDX].set_cfg(ENB_CC_IDX, cell_cfg, sched_args));
 
   sf_cch_allocator pdcch;
@@ -139,7 +140,7 @@ int test_pdcch_one_ue()
   return SRSRAN_SUCCESS;
 }
 
-int test_pdcch_ue_and_sibs()
+int test_pdcch_ue_and_sibs(const char* pdcch_alloc_algo)
 {
   // Params
   uint32_t nof_prb = 100;
@@ -148,6 +149,7 @@ int test_pdcch_ue_and_sibs()
   sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
   sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(nof_prb);
   sched_interface::sched_args_t    sched_args{};
+  sched_args.pdcch_alloc_algo = pdcch_alloc_algo;
   TESTASSERT(cell_params[0].set_cfg(0, cell_cfg, sched_args));
 
   sf_cch_allocator pdcch;
@@ -181,7 +183,12 @@ int test_pdcch_ue_and_sibs()
   pdcch.get_allocs(&dci_result, &result_pdcch_mask);
   TESTASSERT(dci_result.size() == 2);
   const cce_position_list& bc_dci_locs = cell_params[0].common_locations[cfi - 1][2];
-  TESTASSERT(bc_dci_locs[0] == dci_result[0]->dci_pos.ncce);
+  if (sched_args.pdcch_alloc_algo == "dfs") {
+    TESTASSERT(bc_dci_locs[0] == dci_result[0]->dci_pos.ncce);
+  } else {
+    // The bitmap search places the most constrained DCIs first, so the SIB DCI may have been moved to make space
+    TESTASSERT(std::count(bc_dci_locs.begin(), bc_dci_locs.end(), dci_result[0]->dci_pos.ncce) > 0);
+  }
   const cce_position_list& rar_dci_locs = cell_params[0].rar_locations[to_tx_dl(tti_rx).sf_idx()][cfi - 1][2];
   TESTASSERT(std::any_of(rar_dci_locs.begin(), rar_dci_locs.end(), [&dci_result](uint32_t val) {
     return dci_result[1]->dci_pos.ncce == val;
@@ -190,12 +197,13 @@ int test_pdcch_ue_and_sibs()
   return SRSRAN_SUCCESS;
 }
 
-int test_6prbs()
+int test_6prbs(const char* pdcch_alloc_algo)
 {
   std::vector<sched_cell_params_t> cell_params(1);
   sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
   sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(6);
   sched_interface::sched_args_t    sched_args{};
+  sched_args.pdcch_alloc_algo = pdcch_alloc_algo;
   TESTASSERT(cell_params[0].set_cfg(0, cell_cfg, sched_args));
 
   sf_cch_allocator                 pdcch;
@@ -251,6 +259,58 @@ int test_6prbs()
   return SRSRAN_SUCCESS;
 }
 
+int test_pdcch_many_ues(const char* pdcch_alloc_algo)
+{
+  using rand_uint         = std::uniform_int_distribution<uint32_t>;
+  const uint32_t nof_prb  = 100;
+  const uint32_t nof_ues  = 16;
+  const uint32_t nof_ttis = 100;
+
+  std::vector<sched_cell_params_t> cell_params(1);
+  sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
+  sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(nof_prb);
+  sched_interface::sched_args_t    sched_args{};
+  sched_args.pdcch_alloc_algo = pdcch_alloc_algo;
+  TESTASSERT(cell_params[0].set_cfg(0, cell_cfg, sched_args));
+
+  std::vector<std::unique_ptr<sched_ue>> ues;
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    ues.emplace_back(new sched_ue{static_cast<uint16_t>(0x46 + i), cell_params, ue_cfg});
+  }
+  sf_cch_allocator pdcch;
+  pdcch.init(cell_params[PCell_IDX]);
+
+  // TEST: DCIs never collide, independently of the number of failed allocations
+  for (uint32_t tti_counter = 0; tti_counter < nof_ttis; ++tti_counter) {
+    pdcch.new_tti(tti_point{tti_counter});
+    for (auto& ue : ues) {
+      alloc_type_t alloc_type = rand_uint{0, 1}(get_rand_gen()) == 0 ? alloc_type_t::DL_DATA : alloc_type_t::UL_DATA;
+      pdcch.alloc_dci(alloc_type, rand_uint{0, 3}(get_rand_gen()), ue.get(), false);
+    }
+    TESTASSERT(pdcch.nof_allocs() > 0);
+
+    sf_cch_allocator::alloc_result_t dci_result;
+    pdcch_mask_t                     result_pdcch_mask;
+    pdcch.get_allocs(&dci_result, &result_pdcch_mask);
+    TESTASSERT(dci_result.size() == pdcch.nof_allocs());
+    pdcch_mask_t total_mask(pdcch.nof_cces());
+    prbmask_t    pucch_mask(nof_prb);
+    for (const auto* node : dci_result) {
+      TESTASSERT(node->current_mask.size() == pdcch.nof_cces());
+      TESTASSERT((total_mask & node->current_mask).none());
+      total_mask |= node->current_mask;
+      TESTASSERT(node->total_mask == total_mask);
+      if (node->pucch_n_prb >= 0) {
+        TESTASSERT(not pucch_mask.test(node->pucch_n_prb));
+        pucch_mask.set(node->pucch_n_prb);
+      }
+    }
+    TESTASSERT(result_pdcch_mask == total_mask);
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
 int main()
 {
   srsenb::set_randseed(seed);
@@ -262,9 +322,12 @@ int main()
   // Start the log backend.
   srslog::init();
 
-  TESTASSERT(test_pdcch_one_ue() == SRSRAN_SUCCESS);
-  TESTASSERT(test_pdcch_ue_and_sibs() == SRSRAN_SUCCESS);
-  TESTASSERT(test_6prbs() == SRSRAN_SUCCESS);
+  for (const char* pdcch_alloc_algo : {"dfs", "bitmap"}) {
+    TESTASSERT(test_pdcch_one_ue(pdcch_alloc_algo) == SRSRAN_SUCCESS);
+    TESTASSERT(test_pdcch_ue_and_sibs(pdcch_alloc_algo) == SRSRAN_SUCCESS);
+    TESTASSERT(test_6prbs(pdcch_alloc_algo) == SRSRAN_SUCCESS);
+    TESTASSERT(test_pdcch_many_ues(pdcch_alloc_algo) == SRSRAN_SUCCESS);
+  }
 
   srslog::flush();
 
@@ -0,0 +1,184 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "sched_test_common.h"
+#include "sched_test_utils.h"
+#include "srsenb/hdr/stack/mac/sched_ue_ctrl/sched_harq.h"
+#include "srsran/common/test_common.h"
+
+using namespace srsenb;
+
+namespace {
+
+const uint16_t rnti          = 0x46;
+const uint32_t lookahead_tti = 2;
+
+/// Scheduler whose lookahead can be forced, so that the decisions are computed ahead of the CRCs deterministically
+class lookahead_sched : public sched
+{
+public:
+  using sched::run_lookahead;
+};
+
+struct pusch_info {
+  tti_point tti_tx_ul;
+  uint32_t  tbs;
+  uint32_t  current_tx_nb;
+  bool      needs_pdcch;
+  bool      ndi;
+  uint32_t  mcs_idx;
+};
+
+} // namespace
+
+/**
+ * Test of the UL HARQ state saved when the ACK of a PUSCH is assumed ahead of its CRC
+ * - a KO CRC does not touch the HARQ, which may have been reused already
+ * - revert_ul_ack() restores the TB pending a retx
+ * - an ACK CRC discards the saved state
+ */
+int test_harq_assume_ul_ack()
+{
+  harq_entity harqs(SRSRAN_FDD_NOF_HARQ, SRSRAN_FDD_NOF_HARQ);
+  tti_point   tti_rx{10};
+  tti_point   tti_tx_ul = to_tx_ul(tti_rx);
+
+  ul_harq_proc* h = harqs.get_ul_harq(tti_tx_ul);
+  h->new_tx(tti_tx_ul, 10, 100, prb_interval{0, 4}, 4, false);
+  bool ndi = h->get_ndi(0);
+
+  // No ACK was assumed for the PUSCH
+  TESTASSERT(harqs.revert_ul_ack(tti_tx_ul) == nullptr);
+
+  harqs.assume_ul_ack(tti_tx_ul);
+  TESTASSERT(not h->has_pending_retx());
+  TESTASSERT(harqs.set_ul_crc(tti_tx_ul, 0, false) == (int)h->get_id());
+  TESTASSERT(not h->has_pending_retx());
+  ul_harq_proc* restored = harqs.revert_ul_ack(tti_tx_ul);
+  TESTASSERT(restored == h and h->has_pending_retx() and h->get_ndi(0) == ndi);
+  TESTASSERT(harqs.revert_ul_ack(tti_tx_ul) == nullptr);
+
+  // The ACK CRC confirms the assumption
+  tti_point next_tx_ul = tti_tx_ul + SRSRAN_FDD_NOF_HARQ;
+  h->new_tx(next_tx_ul, 10, 100, prb_interval{0, 4}, 4, false);
+  harqs.assume_ul_ack(next_tx_ul);
+  TESTASSERT(harqs.set_ul_crc(next_tx_ul, 0, true) == (int)h->get_id());
+  TESTASSERT(harqs.revert_ul_ack(next_tx_ul) == nullptr and not h->has_pending_retx());
+  return SRSRAN_SUCCESS;
+}
+
+/**
+ * Test of a KO CRC received after the scheduling decision of its TTI was computed ahead, assuming an ACK
+ * - the UE gets a PHICH ACK, as the PHICH was already decided
+ * - the PUSCH that reused the HARQ becomes an adaptive retx of the failed TB, with PDCCH and the same NDI
+ * - PUSCHs with an ACK CRC are followed by newtxs
+ */
+int test_ul_crc_ko_after_lookahead()
+{
+  std::vector<sched_interface::cell_cfg_t> cell_list(1, generate_default_cell_cfg(25));
+  cell_list[0].prach_rar_window         = 10;
+  sched_interface::sched_args_t sched_args = {};
+  sched_args.lookahead_tti                 = lookahead_tti;
+
+  rrc_dummy       rrc;
+  lookahead_sched sched_obj;
+  sched_obj.init(&rrc, sched_args);
+  TESTASSERT(sched_obj.cell_cfg(cell_list) == SRSRAN_SUCCESS);
+  TESTASSERT(sched_obj.ue_cfg(rnti, generate_default_ue_cfg()) == SRSRAN_SUCCESS);
+
+  std::map<uint32_t, pusch_info> puschs; ///< PUSCHs of the UE, indexed by tti_tx_ul
+  bool                           crc_ko_sent = false, retx_checked = false;
+  uint32_t                       nof_newtx_after_ack = 0;
+  pusch_info                     failed_pusch        = {};
+  tti_point                      tti_rx{0};
+  for (uint32_t count = 0; count < 200 and (not retx_checked or nof_newtx_after_ack < 2); ++count, ++tti_rx) {
+    TESTASSERT(sched_obj.ul_bsr(rnti, 1, 100000) == SRSRAN_SUCCESS);
+
+    // CRC of the PUSCH received in tti_rx. The first one is KO, after its decision was computed ahead
+    auto it = puschs.find(tti_rx.to_uint());
+    if (it != puschs.end()) {
+      bool crc = crc_ko_sent;
+      if (not crc_ko_sent) {
+        TESTASSERT(it->second.current_tx_nb == 0);
+        failed_pusch = it->second;
+        crc_ko_sent  = true;
+      }
+      TESTASSERT(sched_obj.ul_crc_info(tti_rx.to_uint(), rnti, 0, crc) == SRSRAN_SUCCESS);
+    }
+
+    sched_interface::dl_sched_res_t dl_res;
+    sched_interface::ul_sched_res_t ul_res;
+    TESTASSERT(sched_obj.dl_sched(to_tx_dl(tti_rx).to_uint(), 0, dl_res) == SRSRAN_SUCCESS);
+    TESTASSERT(sched_obj.ul_sched(to_tx_ul(tti_rx).to_uint(), 0, ul_res) == SRSRAN_SUCCESS);
+
+    if (crc_ko_sent and failed_pusch.tti_tx_ul == tti_rx) {
+      // The PHICH was decided with the assumed ACK
+      TESTASSERT(ul_res.phich.size() == 1 and ul_res.phich[0].rnti == rnti);
+      TESTASSERT(ul_res.phich[0].phich == sched_interface::ul_sched_phich_t::ACK);
+    }
+
+    for (const sched_interface::ul_sched_data_t& pusch : ul_res.pusch) {
+      if (pusch.dci.rnti != rnti) {
+        continue;
+      }
+      pusch_info info;
+      info.tti_tx_ul     = to_tx_ul(tti_rx);
+      info.tbs           = pusch.tbs;
+      info.current_tx_nb = pusch.current_tx_nb;
+      info.needs_pdcch   = pusch.needs_pdcch;
+      info.ndi           = pusch.dci.tb.ndi;
+      info.mcs_idx       = pusch.dci.tb.mcs_idx;
+      puschs[info.tti_tx_ul.to_uint()] = info;
+
+      if (crc_ko_sent and info.tti_tx_ul == failed_pusch.tti_tx_ul + SRSRAN_FDD_NOF_HARQ) {
+        // The HARQ was reused for a newtx before the CRC was known. It carries the retx of the failed TB instead
+        TESTASSERT(info.current_tx_nb == 1 and info.needs_pdcch);
+        TESTASSERT(info.ndi == failed_pusch.ndi and info.tbs == failed_pusch.tbs and info.mcs_idx > 28);
+        retx_checked = true;
+      } else if (retx_checked and info.tti_tx_ul > failed_pusch.tti_tx_ul + SRSRAN_FDD_NOF_HARQ) {
+        TESTASSERT(info.current_tx_nb == 0);
+        nof_newtx_after_ack++;
+      }
+    }
+
+    // Compute the next TTIs before their CRCs arrive
+    sched_obj.run_lookahead(tti_rx + lookahead_tti);
+  }
+  TESTASSERT(retx_checked and nof_newtx_after_ack >= 2);
+
+  sched_obj.stop();
+  return SRSRAN_SUCCESS;
+}
+
+int main()
+{
+  srsran::test_init(0, nullptr);
+  auto& mac_log = srslog::fetch_basic_logger("MAC");
+  mac_log.set_level(srslog::basic_levels::info);
+  srslog::init();
+
+  TESTASSERT(test_harq_assume_ul_ack() == SRSRAN_SUCCESS);
+  TESTASSERT(test_ul_crc_ko_after_lookahead() == SRSRAN_SUCCESS);
+
+  srslog::flush();
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,235 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/softbuffer_pool.h"
+#include "srsenb/hdr/stack/mac/ue.h"
+#include "srsran/common/test_common.h"
+#include <cstring>
+
+using namespace srsenb;
+
+static uint32_t nof_attached_rx(const srsran_softbuffer_rx_t& buffer)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < buffer.max_cb; i++) {
+    n += buffer.buffer_f[i] != nullptr ? 1 : 0;
+  }
+  return n;
+}
+
+static uint32_t nof_attached_tx(const srsran_softbuffer_tx_t& buffer)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < buffer.max_cb; i++) {
+    n += buffer.buffer_b[i] != nullptr ? 1 : 0;
+  }
+  return n;
+}
+
+int test_nof_cb()
+{
+  TESTASSERT(softbuffer_cb_pool::get_nof_cb(0) == 0);
+  TESTASSERT(softbuffer_cb_pool::get_nof_cb(16) == 1);
+  TESTASSERT(softbuffer_cb_pool::get_nof_cb(6120) == 1);
+  TESTASSERT(softbuffer_cb_pool::get_nof_cb(6121) == 2);
+  TESTASSERT(softbuffer_cb_pool::get_nof_cb(75376) == 13);
+
+  // Must match the segmentation used by the PHY
+  for (uint32_t tbs : {16u, 6120u, 6200u, 12216u, 12240u, 30576u, 75376u}) {
+    srsran_cbsegm_t cb_segm = {};
+    TESTASSERT(srsran_cbsegm(&cb_segm, tbs) == SRSRAN_SUCCESS);
+    TESTASSERT(softbuffer_cb_pool::get_nof_cb(tbs) == cb_segm.C);
+  }
+  TESTASSERT(softbuffer_cb_pool::get_max_cb(100) >= softbuffer_cb_pool::get_nof_cb(75376));
+  return SRSRAN_SUCCESS;
+}
+
+int test_attach_release()
+{
+  softbuffer_cb_pool     pool(false, 0, 4);
+  srsran_softbuffer_rx_t rx;
+  srsran_softbuffer_tx_t tx;
+  TESTASSERT(pool.init_rx(rx, softbuffer_cb_pool::get_max_cb(100)));
+  TESTASSERT(pool.init_tx(tx, softbuffer_cb_pool::get_max_cb(100)));
+  TESTASSERT(nof_attached_rx(rx) == 0 and nof_attached_tx(tx) == 0);
+  TESTASSERT(pool.get_metrics().allocated_bytes == 0);
+
+  // Storage is attached to the code blocks of the TB only
+  TESTASSERT(pool.attach_rx(rx, 3, true));
+  TESTASSERT(pool.attach_tx(tx, 5));
+  TESTASSERT(nof_attached_rx(rx) == 3 and nof_attached_tx(tx) == 5);
+  for (uint32_t i = 0; i < 3; i++) {
+    TESTASSERT(((uintptr_t)rx.buffer_f[i] % 64) == 0);
+    TESTASSERT(rx.data[i] != nullptr and rx.data[i] != (uint8_t*)rx.buffer_f[i]);
+    for (uint32_t j = 0; j < SOFTBUFFER_SIZE; j++) {
+      TESTASSERT(rx.buffer_f[i][j] == 0);
+    }
+  }
+  mac_softbuffer_metrics_t metrics = pool.get_metrics();
+  TESTASSERT(metrics.rx_used_bytes > 0 and metrics.tx_used_bytes > 0);
+  TESTASSERT(metrics.peak_used_bytes == metrics.rx_used_bytes + metrics.tx_used_bytes);
+  TESTASSERT(metrics.allocated_bytes >= metrics.peak_used_bytes);
+  uint64_t rx_cb_size = metrics.rx_used_bytes / 3;
+
+  // Attaching to a prefix that already has storage is a no-op
+  TESTASSERT(pool.attach_rx(rx, 2, true));
+  TESTASSERT(pool.get_metrics().rx_used_bytes == 3 * rx_cb_size);
+
+  // The code blocks beyond the TB of a new transmission are given back
+  int16_t* cb0 = rx.buffer_f[0];
+  rx.cb_crc[2] = true;
+  pool.release_rx(rx, 2);
+  TESTASSERT(nof_attached_rx(rx) == 2 and rx.buffer_f[0] == cb0 and not rx.cb_crc[2]);
+  pool.release_tx(tx, 1);
+  TESTASSERT(nof_attached_tx(tx) == 1);
+  metrics = pool.get_metrics();
+  TESTASSERT(metrics.rx_used_bytes == 2 * rx_cb_size);
+
+  // Released code blocks are reused before allocating new ones
+  uint64_t allocated = metrics.allocated_bytes;
+  TESTASSERT(pool.attach_tx(tx, 5));
+  TESTASSERT(pool.get_metrics().allocated_bytes == allocated);
+
+  pool.free_rx(rx);
+  pool.free_tx(tx);
+  metrics = pool.get_metrics();
+  TESTASSERT(metrics.rx_used_bytes == 0 and metrics.tx_used_bytes == 0);
+  TESTASSERT(metrics.nof_alloc_failures == 0);
+  return SRSRAN_SUCCESS;
+}
+
+int test_8bit_llr()
+{
+  softbuffer_cb_pool     pool16(false);
+  softbuffer_cb_pool     pool8(true);
+  srsran_softbuffer_rx_t rx16;
+  srsran_softbuffer_rx_t rx8;
+  TESTASSERT(pool16.init_rx(rx16, 4) and pool8.init_rx(rx8, 4));
+  TESTASSERT(pool16.attach_rx(rx16, 1, false) and pool8.attach_rx(rx8, 1, false));
+
+  // 8-bit LLRs take about half the memory
+  uint64_t size16 = pool16.get_metrics().rx_used_bytes;
+  uint64_t size8  = pool8.get_metrics().rx_used_bytes;
+  TESTASSERT(size8 < size16 and size8 >= SOFTBUFFER_SIZE + SOFTBUFFER_SIZE / 8);
+
+  // A reset zeroes all the 8-bit LLRs of the code block, and the decoded data is stored after them
+  auto* llr = (int8_t*)rx8.buffer_f[0];
+  memset(llr, 0x7f, SOFTBUFFER_SIZE);
+  TESTASSERT(rx8.data[0] >= (uint8_t*)llr + SOFTBUFFER_SIZE);
+  srsran_softbuffer_rx_reset_cb(&rx8, 1);
+  for (uint32_t i = 0; i < SOFTBUFFER_SIZE; i++) {
+    TESTASSERT(llr[i] == 0);
+  }
+
+  pool16.free_rx(rx16);
+  pool8.free_rx(rx8);
+  return SRSRAN_SUCCESS;
+}
+
+int test_memory_limit()
+{
+  softbuffer_cb_pool     pool(false, 2 * SOFTBUFFER_SIZE + 128, 8);
+  srsran_softbuffer_tx_t tx1;
+  srsran_softbuffer_tx_t tx2;
+  TESTASSERT(pool.init_tx(tx1, 4) and pool.init_tx(tx2, 4));
+
+  TESTASSERT(pool.attach_tx(tx1, 2));
+  TESTASSERT(not pool.attach_tx(tx2, 1));
+  mac_softbuffer_metrics_t metrics = pool.get_metrics();
+  TESTASSERT(metrics.nof_alloc_failures == 1);
+  TESTASSERT(metrics.allocated_bytes <= 2 * SOFTBUFFER_SIZE + 128);
+
+  // Code blocks given back can be used by other UEs
+  pool.release_tx(tx1);
+  TESTASSERT(pool.attach_tx(tx2, 2));
+  TESTASSERT(nof_attached_tx(tx2) == 2);
+
+  pool.free_tx(tx1);
+  pool.free_tx(tx2);
+  return SRSRAN_SUCCESS;
+}
+
+int test_ue_softbuffers()
+{
+  softbuffer_cb_pool pool(false);
+  {
+    ue_cc_softbuffers softbuffers(pool, 25, SRSRAN_FDD_NOF_HARQ, SRSRAN_FDD_NOF_HARQ);
+    TESTASSERT(pool.get_metrics().allocated_bytes == 0);
+
+    // UL: the code blocks are given back once the PUSCH is decoded, unless the process has a new PUSCH
+    srsran_softbuffer_rx_t* rx = softbuffers.get_rx(tti_point{10}, 6200, true);
+    TESTASSERT(rx != nullptr and nof_attached_rx(*rx) == 2);
+    TESTASSERT(softbuffers.get_rx(tti_point{10}, 6200, false) == rx);
+    softbuffers.release_rx(tti_point{10});
+    TESTASSERT(nof_attached_rx(*rx) == 0);
+    TESTASSERT(softbuffers.get_rx(tti_point{18}, 1000, true) == rx);
+    softbuffers.release_rx(tti_point{10});
+    TESTASSERT(nof_attached_rx(*rx) == 1);
+
+    // DL: the code blocks of a TB are given back once it is acknowledged
+    srsran_softbuffer_tx_t* tx = softbuffers.get_tx(2, 1, 12240, true, tti_point{100});
+    TESTASSERT(tx != nullptr and nof_attached_tx(*tx) == 3);
+    TESTASSERT(softbuffers.get_tx(2, 1, 1000, true, tti_point{110}) == tx);
+    TESTASSERT(nof_attached_tx(*tx) == 1);
+    softbuffers.release_tx(tti_point{110 + FDD_HARQ_DELAY_DL_MS}, 0);
+    TESTASSERT(nof_attached_tx(*tx) == 1);
+    softbuffers.release_tx(tti_point{110 + FDD_HARQ_DELAY_DL_MS}, 1);
+    TESTASSERT(nof_attached_tx(*tx) == 0);
+
+    // Processes that are not scheduled anymore give back their code blocks
+    tx = softbuffers.get_tx(3, 0, 12240, true, tti_point{10230});
+    TESTASSERT(tx != nullptr and nof_attached_tx(*tx) == 3);
+    softbuffers.release_idle(tti_point{10230 + ue_cc_softbuffers::MAX_IDLE_TTIS});
+    TESTASSERT(nof_attached_tx(*tx) == 3);
+    softbuffers.release_idle(tti_point{10230 + ue_cc_softbuffers::MAX_IDLE_TTIS + 1});
+    TESTASSERT(nof_attached_tx(*tx) == 0 and nof_attached_rx(*rx) == 1);
+    softbuffers.release_idle(tti_point{18 + ue_cc_softbuffers::MAX_IDLE_TTIS + 1});
+    TESTASSERT(nof_attached_rx(*rx) == 0);
+    mac_softbuffer_metrics_t metrics = pool.get_metrics();
+    TESTASSERT(metrics.rx_used_bytes == 0 and metrics.tx_used_bytes == 0);
+
+    // The UE release gives back everything
+    TESTASSERT(softbuffers.get_rx(tti_point{20}, 30576, true) != nullptr);
+    TESTASSERT(softbuffers.get_tx(0, 0, 30576, true, tti_point{20}) != nullptr);
+    softbuffers.clear();
+    metrics = pool.get_metrics();
+    TESTASSERT(metrics.rx_used_bytes == 0 and metrics.tx_used_bytes == 0);
+
+    TESTASSERT(softbuffers.get_rx(tti_point{21}, 30576, true) != nullptr);
+  }
+  TESTASSERT(pool.get_metrics().rx_used_bytes == 0);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srsran::test_init(argc, argv);
+
+  TESTASSERT(test_nof_cb() == SRSRAN_SUCCESS);
+  TESTASSERT(test_attach_release() == SRSRAN_SUCCESS);
+  TESTASSERT(test_8bit_llr() == SRSRAN_SUCCESS);
+  TESTASSERT(test_memory_limit() == SRSRAN_SUCCESS);
+  TESTASSERT(test_ue_softbuffers() == SRSRAN_SUCCESS);
+
+  srslog::flush();
+  srsran::console("Success\n");
+  return SRSRAN_SUCCESS;
+}
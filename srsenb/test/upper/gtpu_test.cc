@@ -45,6 +45,11 @@ public:
     last_rnti          = rnti;
     last_eps_bearer_id = eps_bearer_id;
   }
+  void write_sdus(uint16_t rnti, uint32_t eps_bearer_id, srsran::span<srsran::unique_byte_buffer_t> sdus) override
+  {
+    burst_sizes.push_back(sdus.size());
+    pdcp_dummy::write_sdus(rnti, eps_bearer_id, sdus);
+  }
   std::map<uint32_t, srsran::unique_byte_buffer_t> get_buffered_pdus(uint16_t rnti, uint32_t eps_bearer_id) override
   {
     return std::move(buffered_pdus);
@@ -67,6 +72,7 @@ public:
   int                                              last_pdcp_sn       = -1;
   uint16_t                                         last_rnti          = SRSRAN_INVALID_RNTI;
   uint32_t                                         last_eps_bearer_id = 0;
+  std::vector<size_t>                              burst_sizes;
 };
 
 struct dummy_socket_manager : public srsran::socket_manager_itf {
@@ -381,6 +387,77 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
   return SRSRAN_SUCCESS;
 }
 
+int test_gtpu_s1u_rx_burst()
+{
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("TEST");
+  logger.info("\n\n**** Test GTPU S1-U RX burst ****\n");
+  uint16_t           rnti = 0x46;
+  uint32_t           drb1_bearer_id = 5, drb2_bearer_id = 6;
+  const char *       sgw_addr_str = "127.0.0.1", *senb_addr_str = "127.0.1.1";
+  struct sockaddr_in senb_sockaddr = {}, sgw_sockaddr = {};
+  srsran::net_utils::set_sockaddr(&senb_sockaddr, senb_addr_str, GTPU_PORT);
+  srsran::net_utils::set_sockaddr(&sgw_sockaddr, sgw_addr_str, GTPU_PORT);
+  uint32_t sgw_addr = ntohl(sgw_sockaddr.sin_addr.s_addr);
+
+  srsran::task_scheduler task_sched;
+  dummy_socket_manager   senb_rx_sockets;
+  srsenb::gtpu           senb_gtpu(&task_sched, srslog::fetch_basic_logger("GTPU1"), &senb_rx_sockets);
+  pdcp_tester            senb_pdcp;
+  gtpu_args_t            gtpu_args;
+  gtpu_args.gtp_bind_addr = senb_addr_str;
+  gtpu_args.mme_addr      = sgw_addr_str;
+  senb_gtpu.init(gtpu_args, &senb_pdcp);
+  uint32_t addr_in;
+  uint32_t teid_in1 = senb_gtpu.add_bearer(rnti, drb1_bearer_id, sgw_addr, 1, addr_in).value();
+  uint32_t teid_in2 = senb_gtpu.add_bearer(rnti, drb2_bearer_id, sgw_addr, 2, addr_in).value();
+
+  // TEST: consecutive datagrams of the same tunnel queued in the socket reach PDCP as one burst, in order
+  int sgw_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  TESTASSERT(sgw_fd >= 0);
+  const uint32_t       teids[] = {teid_in1, teid_in1, teid_in1, teid_in2, teid_in2, teid_in1};
+  std::vector<uint8_t> data(10);
+  for (uint32_t i = 0; i < sizeof(teids) / sizeof(teids[0]); ++i) {
+    std::fill(data.begin(), data.end(), i);
+    srsran::unique_byte_buffer_t pdu = encode_gtpu_packet(data, teids[i], sgw_sockaddr, senb_sockaddr);
+    TESTASSERT(sendto(sgw_fd, pdu->msg, pdu->N_bytes, 0, (struct sockaddr*)&senb_sockaddr, sizeof(senb_sockaddr)) ==
+               (ssize_t)pdu->N_bytes);
+  }
+  close(sgw_fd);
+  TESTASSERT(senb_rx_sockets.callback(senb_rx_sockets.s1u_fd));
+  task_sched.run_pending_tasks();
+  TESTASSERT(senb_pdcp.burst_sizes.size() == 3);
+  TESTASSERT(senb_pdcp.burst_sizes[0] == 3 and senb_pdcp.burst_sizes[1] == 2 and senb_pdcp.burst_sizes[2] == 1);
+  TESTASSERT(senb_pdcp.last_eps_bearer_id == drb1_bearer_id);
+  srsran::span<uint8_t> pdu_view = srsran::make_span(senb_pdcp.last_sdu);
+  TESTASSERT(std::count(pdu_view.begin() + PDU_HEADER_SIZE, pdu_view.end(), 5) == 10);
+
+  // TEST: a single packet is still delivered on its own
+  std::fill(data.begin(), data.end(), 7);
+  senb_gtpu.handle_gtpu_s1u_rx_packet(encode_gtpu_packet(data, teid_in2, sgw_sockaddr, senb_sockaddr), sgw_sockaddr);
+  TESTASSERT(senb_pdcp.burst_sizes.size() == 4 and senb_pdcp.burst_sizes[3] == 1);
+  TESTASSERT(senb_pdcp.last_eps_bearer_id == drb2_bearer_id);
+
+  // TEST: datagrams longer than the buffers they are read into are not truncated
+  sgw_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  TESTASSERT(sgw_fd >= 0);
+  data.assign(3000, 9);
+  srsran::unique_byte_buffer_t jumbo_pdu = encode_gtpu_packet(data, teid_in1, sgw_sockaddr, senb_sockaddr);
+  TESTASSERT(sendto(sgw_fd,
+                    jumbo_pdu->msg,
+                    jumbo_pdu->N_bytes,
+                    0,
+                    (struct sockaddr*)&senb_sockaddr,
+                    sizeof(senb_sockaddr)) == (ssize_t)jumbo_pdu->N_bytes);
+  close(sgw_fd);
+  TESTASSERT(senb_rx_sockets.callback(senb_rx_sockets.s1u_fd));
+  task_sched.run_pending_tasks();
+  TESTASSERT(senb_pdcp.burst_sizes.size() == 5 and senb_pdcp.last_eps_bearer_id == drb1_bearer_id);
+  pdu_view = srsran::make_span(senb_pdcp.last_sdu);
+  TESTASSERT(std::count(pdu_view.begin() + PDU_HEADER_SIZE, pdu_view.end(), 9) == 3000);
+
+  return SRSRAN_SUCCESS;
+}
+
 } // namespace srsenb
 
 int main(int argc, char** argv)
@@ -398,6 +475,7 @@ int main(int argc, char** argv)
   TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::wait_end_marker_timeout) == SRSRAN_SUCCESS);
   TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::ue_removal_no_marker) == SRSRAN_SUCCESS);
   TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::reest_senb) == SRSRAN_SUCCESS);
+  TESTASSERT(srsenb::test_gtpu_s1u_rx_burst() == SRSRAN_SUCCESS);
 
   srslog::flush();
 
@@ -0,0 +1,304 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Downlink throughput of the eNB PDCP, from GTP-U SDUs to the RLC SDU queues, and uplink throughput, from the MAC SDUs
+ * handed to RLC up to GTP-U, when the UEs are processed in the stack thread and when they are sharded across user-plane
+ * workers. Also checks that the PDUs of each bearer reach RLC in order, and that no UL PDU is lost on the way back to
+ * the stack thread.
+ */
+
+#include "srsenb/hdr/stack/upper/pdcp_workers.h"
+#include "srsran/common/test_common.h"
+#include "srsran/interfaces/enb_rlc_interfaces.h"
+#include <chrono>
+#include <getopt.h>
+#include <thread>
+
+using namespace srsenb;
+
+namespace {
+
+const uint16_t first_rnti = 0x46;
+const uint32_t drb_lcid   = 3;
+
+/// Counts the SDUs that reach each UE and checks that their PDCP SNs are consecutive
+class rlc_sink final : public rlc_interface_pdcp
+{
+public:
+  explicit rlc_sink(uint32_t nof_ues) : ues(nof_ues) {}
+
+  void write_sdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t sdu) override
+  {
+    ue_ctxt& ue = ues[rnti - first_rnti];
+    if (ue.nof_sdus > 0 and sdu->md.pdcp_sn != (ue.last_sn + 1) % (1U << srsran::PDCP_SN_LEN_12)) {
+      ue.nof_out_of_order++;
+    }
+    ue.last_sn = sdu->md.pdcp_sn;
+    ue.nof_sdus++;
+    nof_sdus.fetch_add(1, std::memory_order_release);
+  }
+  void discard_sdu(uint16_t rnti, uint32_t lcid, uint32_t sn) override {}
+  bool rb_is_um(uint16_t rnti, uint32_t lcid) override { return true; }
+  bool sdu_queue_is_full(uint16_t rnti, uint32_t lcid) override { return false; }
+  bool is_suspended(uint16_t rnti, uint32_t lcid) override { return false; }
+
+  void reset()
+  {
+    for (ue_ctxt& ue : ues) {
+      ue = {};
+    }
+    nof_sdus = 0;
+  }
+
+  // Each UE is only written by the thread owning it
+  struct alignas(64) ue_ctxt {
+    uint32_t last_sn          = 0;
+    uint64_t nof_sdus         = 0;
+    uint64_t nof_out_of_order = 0;
+  };
+  std::vector<ue_ctxt>  ues;
+  std::atomic<uint64_t> nof_sdus{0};
+};
+
+class rrc_sink final : public rrc_interface_pdcp
+{
+public:
+  void write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t pdu) override {}
+  void notify_pdcp_integrity_error(uint16_t rnti, uint32_t lcid) override {}
+};
+
+class gtpu_sink final : public gtpu_interface_pdcp
+{
+public:
+  void write_pdu(uint16_t rnti, uint32_t lcid, srsran::unique_byte_buffer_t pdu) override
+  {
+    nof_pdus.fetch_add(1, std::memory_order_release);
+  }
+
+  std::atomic<uint64_t> nof_pdus{0};
+};
+
+/// Stands for the UL of srsenb::rlc: each MAC SDU is handed to PDCP as a complete RLC SDU
+class rlc_mac_loopback final : public rlc_interface_mac
+{
+public:
+  explicit rlc_mac_loopback(pdcp_interface_rlc* pdcp_) : pdcp(pdcp_) {}
+  int  read_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) override { return 0; }
+  void write_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) override
+  {
+    srsran::unique_byte_buffer_t sdu = srsran::make_byte_buffer();
+    TESTASSERT(sdu != nullptr);
+    sdu->append_bytes(payload, nof_bytes);
+    pdcp->write_pdu(rnti, lcid, std::move(sdu));
+  }
+
+private:
+  pdcp_interface_rlc* pdcp;
+};
+
+struct bench_args_t {
+  uint32_t nof_ues     = 64;
+  uint32_t nof_sdus    = 200000;
+  uint32_t sdu_size    = 1400;
+  uint32_t max_workers = 4;
+};
+
+template <typename PdcpType>
+void setup_ues(PdcpType& pdcp, const bench_args_t& args)
+{
+  srsran::as_security_config_t sec_cfg = {};
+  for (uint32_t i = 0; i < sec_cfg.k_up_enc.size(); ++i) {
+    sec_cfg.k_up_enc[i] = i;
+  }
+  sec_cfg.integ_algo  = srsran::INTEGRITY_ALGORITHM_ID_128_EIA2;
+  sec_cfg.cipher_algo = srsran::CIPHERING_ALGORITHM_ID_128_EEA2;
+
+  srsran::pdcp_config_t drb_cfg(1,
+                                srsran::PDCP_RB_IS_DRB,
+                                srsran::SECURITY_DIRECTION_DOWNLINK,
+                                srsran::SECURITY_DIRECTION_UPLINK,
+                                srsran::PDCP_SN_LEN_12,
+                                srsran::pdcp_t_reordering_t::ms500,
+                                srsran::pdcp_discard_timer_t::infinity,
+                                false,
+                                srsran::srsran_rat_t::lte);
+  for (uint32_t i = 0; i < args.nof_ues; ++i) {
+    uint16_t rnti = first_rnti + i;
+    pdcp.add_user(rnti);
+    pdcp.add_bearer(rnti, drb_lcid, drb_cfg);
+    pdcp.config_security(rnti, drb_lcid, sec_cfg);
+    pdcp.enable_encryption(rnti, drb_lcid);
+  }
+}
+
+/// Writes the SDUs round-robin across UEs, as GTP-U does from the stack thread, and returns the rate in SDU/s
+template <typename PdcpType>
+double run_dl(PdcpType& pdcp, rlc_sink& rlc, const bench_args_t& args)
+{
+  rlc.reset();
+  auto tp = std::chrono::high_resolution_clock::now();
+  for (uint32_t n = 0; n < args.nof_sdus; ++n) {
+    srsran::unique_byte_buffer_t sdu = srsran::make_byte_buffer();
+    TESTASSERT(sdu != nullptr);
+    sdu->N_bytes = args.sdu_size;
+    pdcp.write_sdu(first_rnti + n % args.nof_ues, drb_lcid, std::move(sdu));
+  }
+  while (rlc.nof_sdus.load(std::memory_order_acquire) < args.nof_sdus) {
+    std::this_thread::yield();
+  }
+  auto dur = std::chrono::high_resolution_clock::now() - tp;
+
+  for (const rlc_sink::ue_ctxt& ue : rlc.ues) {
+    TESTASSERT(ue.nof_out_of_order == 0);
+  }
+  return args.nof_sdus / std::chrono::duration_cast<std::chrono::duration<double> >(dur).count();
+}
+
+/// Writes UL MAC SDUs round-robin across UEs, as MAC does from the stack thread, and returns the rate in PDU/s
+double run_ul(rlc_interface_mac& rlc_mac, srsran::task_scheduler& ctrl_sched, gtpu_sink& gtpu, const bench_args_t& args)
+{
+  std::vector<uint32_t> next_sn(args.nof_ues, 0);
+  std::vector<uint8_t>  mac_sdu(args.sdu_size + 2);
+  gtpu.nof_pdus = 0;
+
+  auto tp = std::chrono::high_resolution_clock::now();
+  for (uint32_t n = 0; n < args.nof_sdus; ++n) {
+    uint32_t  ue_idx = n % args.nof_ues;
+    uint32_t& sn     = next_sn[ue_idx];
+    mac_sdu[0]       = 0x80U | ((sn >> 8U) & 0x0fU);
+    mac_sdu[1]       = sn & 0xffU;
+    sn               = (sn + 1) % (1U << srsran::PDCP_SN_LEN_12);
+    rlc_mac.write_pdu(first_rnti + ue_idx, drb_lcid, mac_sdu.data(), mac_sdu.size());
+    if (n % 64 == 0) {
+      ctrl_sched.run_pending_tasks();
+    }
+  }
+  while (gtpu.nof_pdus.load(std::memory_order_acquire) < args.nof_sdus) {
+    ctrl_sched.run_pending_tasks();
+    std::this_thread::yield();
+  }
+  auto dur = std::chrono::high_resolution_clock::now() - tp;
+
+  TESTASSERT(gtpu.nof_pdus == args.nof_sdus);
+  return args.nof_sdus / std::chrono::duration_cast<std::chrono::duration<double> >(dur).count();
+}
+
+void print_result(const char* mode, uint32_t nof_workers, double rate, double base_rate, const bench_args_t& args)
+{
+  fmt::print("{:>14}{:>9}{:>14.0f}{:>12.2f}{:>10.2f}x\n",
+             mode,
+             nof_workers,
+             rate,
+             rate * args.sdu_size * 8 / 1e9,
+             rate / base_rate);
+}
+
+int run_benchmark(const bench_args_t& args)
+{
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("PDCP", false);
+  logger.set_level(srslog::basic_levels::warning);
+
+  srsran::task_scheduler ctrl_sched;
+  rlc_sink               rlc(args.nof_ues);
+  rrc_sink               rrc;
+  gtpu_sink              gtpu;
+
+  fmt::print("UEs: {}, SDUs: {}, SDU size: {} bytes\n", args.nof_ues, args.nof_sdus, args.sdu_size);
+  fmt::print("{:>14}{:>9}{:>14}{:>12}{:>11}\n", "DL mode", "workers", "[SDU/s]", "[Gbit/s]", "speedup");
+
+  // Baseline, with the PDCP of all UEs in the stack thread
+  double base_rate;
+  {
+    srsenb::pdcp pdcp(&ctrl_sched, logger);
+    pdcp.init(&rlc, &rrc, &gtpu);
+    setup_ues(pdcp, args);
+    // The first run warms up the buffer pool
+    run_dl(pdcp, rlc, args);
+    base_rate = run_dl(pdcp, rlc, args);
+    pdcp.stop();
+  }
+  print_result("stack thread", 0, base_rate, base_rate, args);
+
+  for (uint32_t nof_workers = 1; nof_workers <= args.max_workers; nof_workers *= 2) {
+    pdcp_workers pdcp(&ctrl_sched, logger, nof_workers);
+    pdcp.init(&rlc, &rrc, &gtpu);
+    setup_ues(pdcp, args);
+    double rate = run_dl(pdcp, rlc, args);
+    pdcp.stop();
+    print_result("workers", nof_workers, rate, base_rate, args);
+  }
+
+  fmt::print("{:>14}{:>9}{:>14}{:>12}{:>11}\n", "UL mode", "workers", "[PDU/s]", "[Gbit/s]", "speedup");
+  {
+    srsenb::pdcp     pdcp(&ctrl_sched, logger);
+    rlc_mac_loopback rlc_mac(&pdcp);
+    pdcp.init(&rlc, &rrc, &gtpu);
+    setup_ues(pdcp, args);
+    run_ul(rlc_mac, ctrl_sched, gtpu, args);
+    base_rate = run_ul(rlc_mac, ctrl_sched, gtpu, args);
+    pdcp.stop();
+  }
+  print_result("stack thread", 0, base_rate, base_rate, args);
+
+  for (uint32_t nof_workers = 1; nof_workers <= args.max_workers; nof_workers *= 2) {
+    pdcp_workers     pdcp(&ctrl_sched, logger, nof_workers);
+    rlc_mac_loopback rlc_mac(&pdcp);
+    pdcp.init(&rlc, &rrc, &gtpu, &rlc_mac);
+    setup_ues(pdcp, args);
+    double rate = run_ul(*pdcp.get_rlc_mac_itf(), ctrl_sched, gtpu, args);
+    pdcp.stop();
+    print_result("workers", nof_workers, rate, base_rate, args);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  bench_args_t args;
+  int          opt;
+  while ((opt = getopt(argc, argv, "u:n:s:w:")) != -1) {
+    switch (opt) {
+      case 'u':
+        args.nof_ues = strtoul(optarg, nullptr, 10);
+        break;
+      case 'n':
+        args.nof_sdus = strtoul(optarg, nullptr, 10);
+        break;
+      case 's':
+        args.sdu_size = strtoul(optarg, nullptr, 10);
+        break;
+      case 'w':
+        args.max_workers = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        fmt::print("Usage: {} [-u nof_ues] [-n nof_sdus] [-s sdu_size] [-w max_workers]\n", argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+  TESTASSERT(args.nof_ues > 0 and args.sdu_size > 0 and args.sdu_size <= srsran::byte_buffer_t().get_tailroom());
+
+  srsran::test_init(argc, argv);
+  TESTASSERT(run_benchmark(args) == SRSRAN_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
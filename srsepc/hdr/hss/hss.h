@@ -28,13 +28,18 @@
 #ifndef SRSEPC_HSS_H
 #define SRSEPC_HSS_H
 
+#include "srsepc/hdr/hss/hss_db.h"
 #include "srsran/common/buffer_pool.h"
+#include "srsran/common/security.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/interfaces/epc_interfaces.h"
 #include "srsran/srslog/srslog.h"
+#include <array>
 #include <cstddef>
 
 #include <map>
+#include <memory>
+#include <mutex>
 
 #define LTE_FDD_ENB_IND_HE_N_BITS 5
 #define LTE_FDD_ENB_IND_HE_MASK 0x1FUL
@@ -45,12 +50,11 @@ namespace srsepc {
 
 struct hss_args_t {
   std::string db_file;
+  bool        db_sync; // flush every SQN update of a binary database to disk
   uint16_t    mcc;
   uint16_t    mnc;
 };
 
-enum hss_auth_algo { HSS_ALGO_XOR, HSS_ALGO_MILENAGE };
-
 struct hss_ue_ctx_t {
   // Members
   std::string        name;
@@ -66,6 +70,10 @@ struct hss_ue_ctx_t {
   uint8_t            last_rand[16];
   std::string        static_ip_addr;
 
+  // Milenage key schedule, expanded on first use. Contexts read from the binary database are built for every
+  // request, so they expand the key once per request.
+  srsran::security_milenage_key milenage_key;
+
   // Helper getters/setters
   void set_sqn(const uint8_t* sqn_);
   void set_last_rand(const uint8_t* rand_);
@@ -85,6 +93,8 @@ public:
 
   virtual bool resync_sqn(uint64_t imsi, uint8_t* auts);
 
+  virtual uint32_t gen_auth_info_answers(hss_auth_info_t* infos, uint32_t nof_infos);
+
   std::map<std::string, uint64_t> get_ip_to_imsi() const;
 
 private:
@@ -92,12 +102,33 @@ private:
   virtual ~hss();
   static hss* m_instance;
 
+  // Subscribers are read either from a CSV file into m_imsi_to_ue_ctx, or from a binary database mapped by m_db
   std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> > m_imsi_to_ue_ctx;
+  std::unique_ptr<hss_db>                            m_db;
+
+  // The CSV UE map is only filled at init, and in database mode each request works on a copy of the mapped record,
+  // so vectors can be generated from several threads. Updates to a UE's SQN and last RAND are serialized by a lock
+  // striped on the IMSI, and hss_db serializes its journal appends and checkpoints on its own mutex.
+  static const uint32_t                    NOF_UE_CTX_LOCKS = 64;
+  std::array<std::mutex, NOF_UE_CTX_LOCKS> m_ue_ctx_locks;
+  std::mutex& get_ue_ctx_lock(uint64_t imsi) { return m_ue_ctx_locks[imsi % NOF_UE_CTX_LOCKS]; }
 
   void gen_rand(uint8_t rand_[16]);
 
-  void
-       gen_auth_info_answer_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres);
+  // Milenage vector of a request. The SQN and RAND are drawn under the UE's lock, and f1-f5 are computed with those
+  // of the other requests once the locks are released.
+  struct milenage_air_t {
+    hss_auth_info_t* info;
+    hss_ue_ctx_t*    ue_ctx;
+    hss_ue_ctx_t     db_ue_ctx;
+    uint8_t          sqn[6];
+    uint8_t          ck[16];
+    uint8_t          ik[16];
+    uint8_t          ak[6];
+    uint8_t          mac[8];
+  };
+  void prepare_auth_info_answer_milenage(hss_ue_ctx_t* ue_ctx, milenage_air_t* air);
+  void gen_auth_info_answers_milenage(milenage_air_t* airs, uint32_t nof_airs);
   void gen_auth_info_answer_xor(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres);
 
   void resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* auts);
@@ -112,7 +143,9 @@ private:
   bool          set_auth_algo(std::string auth_algo);
   bool          read_db_file(std::string db_file);
   bool          write_db_file(std::string db_file);
-  hss_ue_ctx_t* get_ue_ctx(uint64_t imsi);
+  bool          open_db(const std::string& db_file, bool sync);
+  hss_ue_ctx_t* get_ue_ctx(uint64_t imsi, hss_ue_ctx_t& db_ue_ctx);
+  void          store_ue_sqn(hss_ue_ctx_t* ue_ctx);
 
   std::string hex_string(uint8_t* hex, int size);
 
@@ -0,0 +1,131 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        hss_db.h
+ * Description: Binary subscriber database of the HSS. The file is memory
+ *              mapped and holds fixed size records plus an open addressing
+ *              index on the IMSI. SQN updates are written in place and
+ *              appended to a journal, which is replayed when the database
+ *              is opened.
+ *****************************************************************************/
+
+#ifndef SRSEPC_HSS_DB_H
+#define SRSEPC_HSS_DB_H
+
+#include "srsran/srslog/srslog.h"
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace srsepc {
+
+enum hss_auth_algo { HSS_ALGO_XOR, HSS_ALGO_MILENAGE };
+
+/// Subscriber record as stored in the database file.
+struct hss_db_record_t {
+  char     name[32]; // not null terminated when 32 characters long
+  uint64_t imsi;
+  uint8_t  algo; // hss_auth_algo
+  uint8_t  op_configured;
+  uint8_t  key[16];
+  uint8_t  op[16];
+  uint8_t  opc[16];
+  uint8_t  amf[2];
+  uint8_t  sqn[6];
+  uint8_t  last_rand[16];
+  uint16_t qci;
+  uint32_t static_ip; // network byte order, 0 for dynamic allocation
+};
+
+class hss_db
+{
+public:
+  hss_db() = default;
+  ~hss_db();
+  hss_db(const hss_db&) = delete;
+  hss_db& operator=(const hss_db&) = delete;
+
+  /// Returns true if the file starts with the database signature.
+  static bool is_db_file(const std::string& filename);
+
+  /// Writes a new database file with the given records, replacing any previous file and its journal.
+  static bool create(const std::string& filename, const std::vector<hss_db_record_t>& records);
+
+  /// Parses a user_db.csv file. Fails on the first malformed line.
+  static bool read_csv(const std::string& filename, std::vector<hss_db_record_t>& records);
+  /// Writes the records in the user_db.csv format.
+  static bool write_csv(const std::string& filename, const std::vector<hss_db_record_t>& records);
+  static void write_csv_header(std::ostream& os);
+
+  /// Maps the database and replays its journal. With sync_journal set, every journal entry is flushed to disk
+  /// before update_sqn() returns.
+  bool open(const std::string& filename, bool sync_journal);
+  /// Checkpoints and unmaps the database.
+  void close();
+  bool is_open() const { return m_map != nullptr; }
+
+  uint32_t               size() const { return m_nof_records; }
+  const hss_db_record_t& operator[](uint32_t idx) const { return m_records[idx]; }
+  std::vector<hss_db_record_t> get_records() const;
+
+  /// Finds a subscriber in O(1). Returns nullptr if the IMSI is not in the database.
+  const hss_db_record_t* find(uint64_t imsi) const;
+  /// Indices of the records with a static IP address.
+  const uint32_t* static_ip_records_begin() const { return m_static_ip_records; }
+  const uint32_t* static_ip_records_end() const { return m_static_ip_records + m_nof_static_ips; }
+
+  /// Stores the SQN and last RAND of a subscriber. Callers serialize updates of the same IMSI.
+  bool update_sqn(uint64_t imsi, const uint8_t* sqn, const uint8_t* last_rand);
+
+  /// Flushes the mapped records to the file and empties the journal.
+  bool checkpoint();
+
+private:
+  static const uint32_t MAX_JOURNAL_ENTRIES = 65536; // checkpoint once the journal holds this many updates
+
+  hss_db_record_t* find_record(uint64_t imsi) const;
+  bool             replay_journal();
+  bool             checkpoint_unlocked();
+
+  srslog::basic_logger& m_logger = srslog::fetch_basic_logger("HSS");
+
+  std::string      m_filename;
+  uint8_t*         m_map               = nullptr;
+  size_t           m_map_size          = 0;
+  hss_db_record_t* m_records           = nullptr;
+  uint32_t         m_nof_records       = 0;
+  const uint32_t*  m_buckets           = nullptr;
+  uint32_t         m_bucket_mask       = 0;
+  const uint32_t*  m_static_ip_records = nullptr;
+  uint32_t         m_nof_static_ips    = 0;
+  int              m_fd                = -1;
+  int              m_journal_fd        = -1;
+  bool             m_sync_journal      = false;
+  std::mutex       m_journal_mutex;
+  uint32_t         m_nof_journal_entries = 0;
+};
+
+} // namespace srsepc
+
+#endif // SRSEPC_HSS_DB_H
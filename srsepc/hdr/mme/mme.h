@@ -28,26 +28,29 @@
 #ifndef SRSEPC_MME_H
 #define SRSEPC_MME_H
 
+#include "nas_timer_wheel.h"
 #include "s1ap.h"
 #include "srsran/common/buffer_pool.h"
 #include "srsran/common/standard_streams.h"
+#include "srsran/common/thread_pool.h"
 #include "srsran/common/threads.h"
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace srsepc {
 
 typedef struct {
   s1ap_args_t s1ap_args;
+  uint32_t    nof_workers     = 0; // 0 handles all S1AP/NAS/S11 signalling on the MME thread
+  uint32_t    nof_hss_workers = 0; // authentication vectors are generated inline when 0
   // diameter_args_t diameter_args;
   // gtpc_args_t gtpc_args;
 } mme_args_t;
 
-typedef struct {
-  int                 fd;
-  uint64_t            imsi;
-  enum nas_timer_type type;
-} mme_timer_t;
-
 class mme : public srsran::thread, public mme_interface_nas
 {
 public:
@@ -60,10 +63,14 @@ public:
   void run_thread();
 
   // Timer Methods
-  virtual bool add_nas_timer(int timer_fd, enum nas_timer_type type, uint64_t imsi);
+  virtual bool add_nas_timer(uint32_t duration_ms, enum nas_timer_type type, uint64_t imsi);
   virtual bool is_nas_timer_running(enum nas_timer_type type, uint64_t imsi);
   virtual bool remove_nas_timer(enum nas_timer_type type, uint64_t imsi);
 
+  // HSS Methods
+  virtual void defer_hss_request(srsran::move_task_t request, srsran::move_task_t response);
+  virtual void defer_auth_info_request(uint64_t imsi, hss_auth_info_callback_t response);
+
 private:
   mme();
   virtual ~mme();
@@ -71,14 +78,53 @@ private:
   s1ap*       m_s1ap;
   mme_gtpc*   m_mme_gtpc;
 
-  bool   m_running;
-  fd_set m_set;
+  bool m_running;
+  int  m_epoll_fd = -1;
+  int  m_stop_fd  = -1;
+  int  m_tick_fd  = -1;
+
+  // Worker sharding. The MME thread only reads the sockets and hands each UE-associated message to the worker that
+  // owns the UE, so the messages of a UE keep their SCTP stream order. Non-UE-associated signalling stays on the MME
+  // thread, and HSS authentication vectors are optionally generated on a separate pool.
+  const static uint32_t                              WORKER_QUEUE_SIZE = 4096;
+  std::vector<std::unique_ptr<srsran::task_worker> > m_workers;
+  std::unique_ptr<srsran::task_thread_pool>          m_hss_workers;
+  // Number of HSS requests whose answer is not queued in a worker yet
+  std::mutex                                         m_hss_mutex;
+  std::condition_variable                            m_hss_cvar;
+  uint32_t                                           m_nof_hss_requests = 0;
+  hss_interface_nas*                                 m_hss              = nullptr;
+
+  // Authentication Information Requests waiting for the HSS pool. The first free HSS worker takes all of them, up to
+  // MAX_AIR_BATCH, and generates their vectors in one Milenage batch.
+  const static uint32_t MAX_AIR_BATCH = 64;
+  struct air_request_t {
+    uint64_t                 imsi;
+    hss_auth_info_callback_t response;
+    srsran::task_worker*     worker;
+  };
+  std::deque<air_request_t> m_pending_airs;
+
+  struct s1ap_rx_msg_t {
+    s1ap_pdu_t             pdu;
+    struct sctp_sndrcvinfo sri;
+  };
+
+  // NAS timers are advanced by a single periodic timerfd, armed only while timers run. Expiries are handled by the
+  // shard that started the timer.
+  nas_timer_wheel m_nas_timers;
+  bool            m_tick_armed = false;
 
-  // Timer map
-  std::vector<mme_timer_t> timers;
+  // Event handlers
+  void handle_s1_mme_rx(int s1mme, srsran::byte_buffer_t* pdu);
+  void handle_s11_rx(int s11, srsran::byte_buffer_t* pdu);
+  void dispatch_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, const struct sctp_sndrcvinfo& sri);
+  void sync_workers();
+  void handle_pending_airs();
 
   // Timer Methods
-  void handle_timer_expire(int timer_fd);
+  void handle_timer_tick();
+  void arm_timer_tick(bool arm);
 
   // Logs
   srslog::basic_logger& m_s1ap_logger = srslog::fetch_basic_logger("S1AP");
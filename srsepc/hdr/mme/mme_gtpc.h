@@ -24,8 +24,11 @@
 #include "nas.h"
 #include "srsran/asn1/gtpc.h"
 #include "srsran/common/buffer_pool.h"
+#include <mutex>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <unordered_map>
+#include <vector>
 
 namespace srsepc {
 
@@ -58,7 +61,8 @@ public:
   void         send_downlink_data_notification_acknowledge(uint64_t imsi, enum srsran::gtpc_cause_value cause);
   virtual bool send_downlink_data_notification_failure_indication(uint64_t imsi, enum srsran::gtpc_cause_value cause);
 
-  int get_s11();
+  int      get_s11();
+  uint32_t get_rx_pdu_shard(const srsran::gtpc_pdu& pdu, uint32_t nof_shards) const;
 
 private:
   mme_gtpc() = default;
@@ -66,9 +70,11 @@ private:
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("MME GTPC");
   s1ap*                 m_s1ap;
 
-  uint32_t                            m_next_ctrl_teid;
-  std::map<uint32_t, uint64_t>        m_mme_ctr_teid_to_imsi;
-  std::map<uint64_t, struct gtpc_ctx> m_imsi_to_gtpc_ctx;
+  // Control TEIDs are allocated per MME worker shard, so that S11 responses can be routed by TEID
+  std::vector<uint32_t>                         m_next_ctrl_teid;
+  std::mutex                                    m_ctx_mutex;
+  std::unordered_map<uint32_t, uint64_t>        m_mme_ctr_teid_to_imsi;
+  std::unordered_map<uint64_t, struct gtpc_ctx> m_imsi_to_gtpc_ctx;
 
   int                m_s11;
   struct sockaddr_un m_mme_addr, m_spgw_addr;
@@ -77,14 +83,14 @@ private:
   uint32_t get_new_ctrl_teid();
 };
 
-inline uint32_t mme_gtpc::get_new_ctrl_teid()
+inline int mme_gtpc::get_s11()
 {
-  return m_next_ctrl_teid++;
+  return m_s11;
 }
 
-inline int mme_gtpc::get_s11()
+inline uint32_t mme_gtpc::get_rx_pdu_shard(const srsran::gtpc_pdu& pdu, uint32_t nof_shards) const
 {
-  return m_s11;
+  return pdu.header.teid % nof_shards;
 }
 
 } // namespace srsepc
@@ -234,6 +234,24 @@ public:
   bool handle_authentication_failure(srsran::byte_buffer_t* nas_rx);
   bool handle_detach_request(srsran::byte_buffer_t* nas_rx);
 
+  /* HSS requests */
+  // Procedure that asked the HSS for authentication vectors, which tells what to do with the answer
+  enum auth_info_proc_t {
+    AUTH_INFO_IMSI_ATTACH, // attach of a new UE context, released if the user is not found
+    AUTH_INFO_IDENTITY,    // IMSI learnt from the UE, the context is stored by IMSI once the user is found
+    AUTH_INFO_REAUTH,      // authentication restarted for a known UE
+    AUTH_INFO_RESYNC,      // SQN resynchronization requested by the UE, with a new eKSI
+  };
+  // Authentication vectors requested from the HSS. They are owned by the request, not by the UE context, which may
+  // be released before the answer is back.
+  struct auth_info_answer_t {
+    hss_auth_info_t info;
+    uint8_t         auts[16];
+    bool            resync_failed;
+  };
+  void request_auth_info(auth_info_proc_t proc, const uint8_t* auts = nullptr);
+  void handle_auth_info_answer(auth_info_proc_t proc, const auth_info_answer_t& answer);
+
   /* Downlink NAS messages packing */
   bool pack_authentication_request(srsran::byte_buffer_t* nas_buffer);
   bool pack_authentication_reject(srsran::byte_buffer_t* nas_buffer);
@@ -262,6 +280,9 @@ public:
   esm_ctx_t m_esm_ctx[MAX_ERABS_PER_UE] = {};
   sec_ctx_t m_sec_ctx                   = {};
 
+  // Worker shard that created the context. All the signalling of the UE is routed to it.
+  const uint32_t m_shard;
+
 private:
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("NAS");
   gtpc_interface_nas*   m_gtpc   = nullptr;
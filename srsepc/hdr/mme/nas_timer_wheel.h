@@ -0,0 +1,83 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        nas_timer_wheel.h
+ * Description: NAS timers of the MME, kept in a timer wheel advanced by a
+ *              periodic tick.
+ *****************************************************************************/
+
+#ifndef SRSEPC_NAS_TIMER_WHEEL_H
+#define SRSEPC_NAS_TIMER_WHEEL_H
+
+#include "srsran/common/timers.h"
+#include "srsran/interfaces/epc_interfaces.h"
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace srsepc {
+
+// NAS timers are kept per IMSI and type, and remember the shard that started them. The owner advances the wheel with
+// step() on every tick; the tick is only needed while a timer runs, which the wheel reports through the arm callback.
+// All methods may be called from any thread.
+class nas_timer_wheel
+{
+public:
+  const static uint32_t TICK_MS = 10;
+
+  typedef std::pair<uint64_t, enum nas_timer_type> key_t;
+  struct expiry_t {
+    key_t    key;
+    uint32_t shard;
+  };
+  // Called with true when the first timer starts and with false once no timer runs, under the wheel lock
+  typedef std::function<void(bool)> arm_tick_callback_t;
+
+  explicit nas_timer_wheel(arm_tick_callback_t arm_tick_) : arm_tick(std::move(arm_tick_)) {}
+
+  // Starts the timer, or restarts it with the new duration and shard if it is already running
+  void start(uint32_t duration_ms, enum nas_timer_type type, uint64_t imsi, uint32_t shard);
+  bool is_running(enum nas_timer_type type, uint64_t imsi);
+  bool stop(enum nas_timer_type type, uint64_t imsi);
+  void clear();
+
+  // Advances the wheel and returns the timers that expired. They no longer run when this returns, so the expiry
+  // handlers are free to start them again.
+  std::vector<expiry_t> step(uint64_t nof_ticks);
+
+private:
+  struct nas_timer_t {
+    srsran::unique_timer timer;
+    uint32_t             shard;
+  };
+
+  arm_tick_callback_t          arm_tick;
+  std::mutex                   mutex;
+  srsran::timer_handler        timers;
+  std::map<key_t, nas_timer_t> nas_timers;
+  std::vector<key_t>           expired_keys;
+};
+
+} // namespace srsepc
+
+#endif // SRSEPC_NAS_TIMER_WHEEL_H
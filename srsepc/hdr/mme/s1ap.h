@@ -39,12 +39,14 @@
 #include "srsran/srslog/srslog.h"
 #include <arpa/inet.h>
 #include <map>
+#include <mutex>
 #include <netinet/sctp.h>
 #include <set>
 #include <strings.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <unordered_map>
 
 namespace srsepc {
 
@@ -64,10 +66,16 @@ public:
 
   int get_s1_mme();
 
+  // Must be set before init(), the MME does not open the S1-MME SCTP socket then
+  void set_s1mme_transport(s1mme_transport_interface* transport) { m_s1mme_transport = transport; }
+  s1mme_transport_interface* get_s1mme_transport() { return m_s1mme_transport; }
+
   void delete_enb_ctx(int32_t assoc_id);
 
   bool s1ap_tx_pdu(const s1ap_pdu_t& pdu, struct sctp_sndrcvinfo* enb_sri);
   void handle_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, struct sctp_sndrcvinfo* enb_sri);
+  bool unpack_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, s1ap_pdu_t* rx_pdu);
+  void handle_s1ap_rx_pdu(const s1ap_pdu_t& rx_pdu, struct sctp_sndrcvinfo* enb_sri);
   void handle_initiating_message(const asn1::s1ap::init_msg_s& msg, struct sctp_sndrcvinfo* enb_sri);
   void handle_successful_outcome(const asn1::s1ap::successful_outcome_s& msg);
 
@@ -82,12 +90,22 @@ public:
   void       add_new_enb_ctx(const enb_ctx_t& enb_ctx, const struct sctp_sndrcvinfo* enb_sri);
   void       get_enb_ctx(uint16_t sctp_stream);
 
+  std::vector<enb_ctx_t> get_active_enbs();
+
+  // Worker sharding. The MME-UE-S1AP-Ids, M-TMSIs and MME S11 TEIDs allocated by a shard are congruent to the
+  // shard index modulo the number of shards, so later messages carrying them are routed back to the same worker.
+  void            set_nof_shards(uint32_t nof_shards);
+  uint32_t        get_nof_shards() const { return m_nof_shards; }
+  int             get_rx_pdu_shard(const s1ap_pdu_t& rx_pdu, const struct sctp_sndrcvinfo* enb_sri);
+  static uint32_t get_current_shard() { return m_current_shard; }
+  static void     set_current_shard(uint32_t shard) { m_current_shard = shard; }
+
   bool add_nas_ctx_to_imsi_map(nas* nas_ctx);
   bool add_nas_ctx_to_mme_ue_s1ap_id_map(nas* nas_ctx);
   bool add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id);
 
   virtual nas* find_nas_ctx_from_imsi(uint64_t imsi);
-  nas*         find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id);
+  virtual nas* find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id);
 
   bool         release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id);
   void         release_ues_ecm_ctx_in_enb(int32_t enb_assoc);
@@ -105,8 +123,8 @@ public:
   s1ap_erab_mngmt_proc* m_s1ap_erab_mngmt_proc;
   s1ap_paging*          m_s1ap_paging;
 
-  std::map<uint32_t, uint64_t>   m_tmsi_to_imsi;
-  std::map<uint16_t, enb_ctx_t*> m_active_enbs;
+  std::unordered_map<uint32_t, uint64_t> m_tmsi_to_imsi;
+  std::map<uint16_t, enb_ctx_t*>         m_active_enbs;
 
   // Interfaces
   virtual bool send_initial_context_setup_request(uint64_t imsi, uint16_t erab_to_setup);
@@ -138,20 +156,31 @@ private:
 
   hss_interface_nas*                     m_hss;
   int                                    m_s1mme;
+  s1mme_transport_interface*             m_s1mme_transport = nullptr;
+  std::mutex                             m_enb_mutex; // protects the eNB maps, taken before m_ue_ctx_mutex
   std::map<int32_t, uint16_t>            m_sctp_to_enb_id;
   std::map<int32_t, std::set<uint32_t> > m_enb_assoc_to_ue_ids;
 
-  std::map<uint64_t, nas*> m_imsi_to_nas_ctx;
-  std::map<uint32_t, nas*> m_mme_ue_s1ap_id_to_nas_ctx;
+  std::mutex                         m_ue_ctx_mutex; // protects the UE context tables and the M-TMSI map
+  std::unordered_map<uint64_t, nas*> m_imsi_to_nas_ctx;
+  std::unordered_map<uint32_t, nas*> m_mme_ue_s1ap_id_to_nas_ctx;
+
+  // Routing of Initial UE Messages to the shard owning the UE context
+  bool get_attach_request_identity(const asn1::unbounded_octstring<true>& nas_pdu, uint64_t* imsi, uint32_t* m_tmsi);
+  int  find_ue_shard(uint64_t imsi, uint32_t m_tmsi);
 
-  uint32_t m_next_mme_ue_s1ap_id;
-  uint32_t m_next_m_tmsi;
+  // Per-shard identifier counters, only touched by the owning shard
+  uint32_t                     m_nof_shards = 1;
+  static thread_local uint32_t m_current_shard;
+  std::vector<uint32_t>        m_next_mme_ue_s1ap_id;
+  std::vector<uint32_t>        m_next_m_tmsi;
 
   // GTP-C Interface
   mme_gtpc* m_mme_gtpc;
 
   // PCAP
   bool              m_pcap_enable;
+  std::mutex        m_pcap_mutex;
   srsran::s1ap_pcap m_pcap;
 };
 
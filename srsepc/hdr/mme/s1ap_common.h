@@ -68,6 +68,19 @@ typedef struct {
   struct sctp_sndrcvinfo                              sri;
 } enb_ctx_t;
 
+// Transport of the S1-MME associations. The MME opens its own SCTP socket unless a transport is set in S1AP, which
+// lets the MME run over in-process associations, e.g. in tests and benchmarks.
+class s1mme_transport_interface
+{
+public:
+  // Descriptor that is readable while messages are pending
+  virtual int get_fd() = 0;
+  // Reads one message, same as sctp_recvmsg(). An association shutdown is a MSG_NOTIFICATION with SCTP_SHUTDOWN_EVENT
+  virtual int recv_msg(uint8_t* buf, uint32_t len, struct sctp_sndrcvinfo* sri, int* msg_flags) = 0;
+  // Sends a message to the association in sri, same as sctp_send()
+  virtual int send_msg(const uint8_t* buf, uint32_t len, const struct sctp_sndrcvinfo* sri) = 0;
+};
+
 } // namespace srsepc
 
 #endif // SRSEPC_S1AP_COMMON_H
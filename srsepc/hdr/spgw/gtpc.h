@@ -22,6 +22,7 @@
 #define SRSEPC_GTPC_H
 
 #include "srsepc/hdr/spgw/spgw.h"
+#include "srsran/adt/flat_hash_map.h"
 #include "srsran/asn1/gtpc.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/interfaces/epc_interfaces.h"
@@ -85,13 +86,15 @@ public:
   uint64_t m_next_user_teid;
   uint32_t m_max_paging_queue;
 
-  std::map<uint64_t, uint32_t> m_imsi_to_ctr_teid;           // IMSI to control TEID map. Important to check if UE
-                                                             // is previously connected
-  std::map<uint32_t, spgw_tunnel_ctx*> m_teid_to_tunnel_ctx; // Map control TEID to tunnel ctx. Usefull to get
-                                                             // reply ctrl TEID, UE IP, etc.
+  using tunnel_ctx_map_t = srsran::flat_hash_map<uint32_t, spgw_tunnel_ctx*>;
 
-  std::set<uint32_t>                 m_ue_ip_addr_pool;
-  std::map<uint64_t, struct in_addr> m_imsi_to_ip;
+  srsran::flat_hash_map<uint64_t, uint32_t> m_imsi_to_ctr_teid; // IMSI to control TEID map. Important to check if UE
+                                                                // is previously connected
+  tunnel_ctx_map_t m_teid_to_tunnel_ctx; // Map control TEID to tunnel ctx. Usefull to get
+                                         // reply ctrl TEID, UE IP, etc.
+
+  std::set<uint32_t>                              m_ue_ip_addr_pool;
+  srsran::flat_hash_map<uint64_t, struct in_addr> m_imsi_to_ip;
 
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("SPGW GTPC");
 };
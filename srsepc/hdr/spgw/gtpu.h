@@ -22,18 +22,40 @@
 #ifndef SRSEPC_GTPU_H
 #define SRSEPC_GTPU_H
 
+#include "srsepc/hdr/spgw/gtpu_dp.h"
 #include "srsepc/hdr/spgw/spgw.h"
+#include "srsran/adt/flat_hash_map.h"
 #include "srsran/asn1/gtpc.h"
 #include "srsran/common/buffer_pool.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/interfaces/epc_interfaces.h"
 #include "srsran/srslog/srslog.h"
 #include <cstddef>
+#include <memory>
+#include <pthread.h>
 #include <queue>
 
 namespace srsepc {
 
-class spgw::gtpu : public gtpu_interface_gtpc
+/// Downlink context of a UE, indexed by UE IPv4 address. Resolves SGi packets with a single lookup.
+struct spgw_dl_tunnel_t {
+  srsran::gtp_fteid_t enb_fteid;     // eNB user-plane F-TEID
+  uint32_t            spgw_ctr_teid; // SP-GW control TEID, used to trigger paging
+  uint32_t            spgw_usr_teid; // SP-GW user-plane TEID, i.e. the key of the uplink context
+  bool                usr_active;    // User-plane tunnel present. If not, the UE is ECM-IDLE and must be paged
+  bool                ctr_active;    // Control-plane tunnel present
+};
+
+/// Uplink context of a UE, indexed by SP-GW user-plane TEID.
+struct spgw_ul_tunnel_t {
+  in_addr_t ue_ipv4;
+  uint32_t  spgw_ctr_teid;
+};
+
+using spgw_dl_tunnel_map_t = srsran::flat_hash_map<in_addr_t, spgw_dl_tunnel_t>;
+using spgw_ul_tunnel_map_t = srsran::flat_hash_map<uint32_t, spgw_ul_tunnel_t>;
+
+class spgw::gtpu : public gtpu_interface_gtpc, public gtpu_dp_interface
 {
 public:
   gtpu();
@@ -43,35 +65,50 @@ public:
 
   int init_sgi(spgw_args_t* args);
   int init_s1u(spgw_args_t* args);
+  int init_dp_workers(spgw_args_t* args);
   int get_sgi();
   int get_s1u();
 
+  bool has_dp_workers() const { return not m_dp_workers.empty(); }
+
   void handle_sgi_pdu(srsran::unique_byte_buffer_t msg);
   void handle_s1u_pdu(srsran::byte_buffer_t* msg);
   void send_s1u_pdu(srsran::gtp_fteid_t enb_fteid, srsran::byte_buffer_t* msg);
 
   virtual in_addr_t get_s1u_addr();
 
-  virtual bool modify_gtpu_tunnel(in_addr_t ue_ipv4, srsran::gtp_fteid_t dw_user_fteid, uint32_t up_ctr_fteid);
+  virtual bool modify_gtpu_tunnel(in_addr_t           ue_ipv4,
+                                  srsran::gtp_fteid_t dw_user_fteid,
+                                  uint32_t            up_user_teid,
+                                  uint32_t            up_ctrl_teid);
   virtual bool delete_gtpu_tunnel(in_addr_t ue_ipv4);
   virtual bool delete_gtpc_tunnel(in_addr_t ue_ipv4);
   virtual void send_all_queued_packets(srsran::gtp_fteid_t                       dw_user_fteid,
                                        std::queue<srsran::unique_byte_buffer_t>& pkt_queue);
 
+  // Data-plane worker interface
+  bool      resolve_ul_tunnel(uint32_t spgw_usr_teid, in_addr_t* ue_ipv4) override;
+  dl_action resolve_dl_tunnel(in_addr_t ue_ipv4, srsran::gtp_fteid_t* enb_fteid, uint32_t* spgw_ctr_teid) override;
+  void      handle_dl_paging(uint32_t spgw_ctr_teid, srsran::unique_byte_buffer_t msg) override;
+
   spgw*                m_spgw;
   gtpc_interface_gtpu* m_gtpc;
 
-  bool m_sgi_up;
-  int  m_sgi;
+  bool             m_sgi_up;
+  int              m_sgi;
+  std::vector<int> m_sgi_queues; // TUN queues of the data-plane workers. The first one is m_sgi
+
+  bool             m_s1u_up;
+  int              m_s1u;
+  std::vector<int> m_s1u_socks; // S1-U sockets of the data-plane workers. The first one is m_s1u
+  sockaddr_in      m_s1u_addr;
 
-  bool        m_s1u_up;
-  int         m_s1u;
-  sockaddr_in m_s1u_addr;
+  std::vector<std::unique_ptr<gtpu_dp_worker> > m_dp_workers;
 
-  std::map<in_addr_t, srsran::gtp_fteid_t> m_ip_to_usr_teid; // Map IP to User-plane TEID for downlink traffic
-  std::map<in_addr_t, uint32_t>            m_ip_to_ctr_teid; // IP to control TEID map. Important to check if
-                                                             // UE is attached without an active user-plane
-                                                             // for downlink notifications.
+  spgw_dl_tunnel_map_t m_dl_tunnels; // UE IP to downlink context. A UE may be attached without an active
+                                     // user-plane, in which case downlink data triggers a notification.
+  spgw_ul_tunnel_map_t m_ul_tunnels; // SP-GW user-plane TEID to uplink context
+  pthread_rwlock_t     m_tunnel_rwlock; // Protects the tunnel maps, which are read by the data-plane workers
 
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("GTPU");
 };
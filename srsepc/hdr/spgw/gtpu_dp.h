@@ -0,0 +1,123 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        gtpu_dp.h
+ * Description: SP-GW data-plane worker. Each worker owns one SGi TUN queue
+ *              and one S1-U socket of a SO_REUSEPORT group, and forwards
+ *              packets in batches using epoll, recvmmsg and sendmmsg.
+ *****************************************************************************/
+
+#ifndef SRSEPC_GTPU_DP_H
+#define SRSEPC_GTPU_DP_H
+
+#include "srsran/asn1/gtpc_ies.h"
+#include "srsran/common/buffer_pool.h"
+#include "srsran/common/threads.h"
+#include "srsran/srslog/srslog.h"
+#include <atomic>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
+
+namespace srsepc {
+
+/// Default number of packets handled per syscall by the data-plane workers.
+const uint32_t GTPU_DP_DEFAULT_BATCH_SIZE = 32;
+
+/// Interface used by the data-plane workers to resolve tunnels. Implementations must be thread-safe.
+class gtpu_dp_interface
+{
+public:
+  enum class dl_action { drop, forward, page };
+
+  /// Finds the UE of an uplink tunnel. Returns false if the TEID is unknown. Uplink packets are forwarded either way,
+  /// the lookup only feeds the metrics and the logs.
+  virtual bool resolve_ul_tunnel(uint32_t spgw_usr_teid, in_addr_t* ue_ipv4) = 0;
+
+  /// Finds the downlink tunnel of the UE with the given IPv4 address.
+  virtual dl_action resolve_dl_tunnel(in_addr_t ue_ipv4, srsran::gtp_fteid_t* enb_fteid, uint32_t* spgw_ctr_teid) = 0;
+
+  /// Hands over a downlink packet of an ECM-IDLE UE, so that paging is triggered and the packet is queued.
+  virtual void handle_dl_paging(uint32_t spgw_ctr_teid, srsran::unique_byte_buffer_t msg) = 0;
+};
+
+struct gtpu_dp_metrics_t {
+  uint64_t ul_pkts;
+  uint64_t ul_bytes;
+  uint64_t ul_drops;
+  uint64_t ul_unknown_teid; // Forwarded uplink packets that do not belong to a known tunnel
+  uint64_t dl_pkts;
+  uint64_t dl_bytes;
+  uint64_t dl_drops;
+  uint64_t nof_syscalls;
+};
+
+class gtpu_dp_worker : public srsran::thread
+{
+public:
+  gtpu_dp_worker(uint32_t id_, gtpu_dp_interface* parent_);
+  ~gtpu_dp_worker();
+
+  /// Registers the SGi queue and S1-U socket of this worker. Both descriptors are switched to non-blocking mode.
+  int  init(int sgi_fd_, int s1u_fd_, uint32_t batch_size_);
+  bool start_worker(int prio = -1);
+  void stop();
+
+  gtpu_dp_metrics_t get_metrics() const;
+
+private:
+  void run_thread() override;
+  void handle_s1u_batch();
+  void handle_sgi_batch();
+  void send_s1u_batch(uint32_t nof_msgs);
+  bool realloc_rx_buffer(uint32_t idx);
+  bool alloc_rx_buffers();
+
+  uint32_t           id;
+  gtpu_dp_interface* parent;
+  int                sgi_fd     = -1;
+  int                s1u_fd     = -1;
+  int                epoll_fd   = -1;
+  int                stop_fd    = -1;
+  uint32_t           batch_size = GTPU_DP_DEFAULT_BATCH_SIZE;
+  std::atomic<bool>  running{false};
+
+  // Per-batch scratch memory, allocated once in init()
+  std::vector<srsran::unique_byte_buffer_t> bufs;
+  std::vector<struct mmsghdr>               msgs;
+  std::vector<struct iovec>                 iovs;
+  std::vector<struct sockaddr_in>           addrs;
+
+  std::atomic<uint64_t> ul_pkts{0}, ul_bytes{0}, ul_drops{0}, ul_unknown_teid{0};
+  std::atomic<uint64_t> dl_pkts{0}, dl_bytes{0}, dl_drops{0};
+  std::atomic<uint64_t> nof_syscalls{0};
+
+  srslog::basic_logger& m_logger = srslog::fetch_basic_logger("GTPU");
+};
+
+/// Opens and binds one S1-U socket per worker in a SO_REUSEPORT group. Uplink packets are steered to the socket
+/// with index TEID % nof_socks, so that all packets of one tunnel are handled by the same worker.
+int gtpu_dp_open_s1u_sockets(const sockaddr_in& addr, uint32_t nof_socks, std::vector<int>& socks);
+
+} // namespace srsepc
+
+#endif // SRSEPC_GTPU_DP_H
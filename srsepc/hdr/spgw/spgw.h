@@ -33,6 +33,7 @@
 #include "srsran/common/threads.h"
 #include "srsran/srslog/srslog.h"
 #include <cstddef>
+#include <mutex>
 #include <queue>
 
 namespace srsepc {
@@ -46,6 +47,8 @@ typedef struct {
   std::string sgi_if_addr;
   std::string sgi_if_name;
   uint32_t    max_paging_queue;
+  uint32_t    nof_dp_workers; // 0 keeps SGi and S1-U on the SPGW thread
+  uint32_t    dp_batch_size;
 } spgw_args_t;
 
 typedef struct spgw_tunnel_ctx {
@@ -83,6 +86,9 @@ private:
   bool      m_running;
   mme_gtpc* m_mme_gtpc;
 
+  // Serializes GTP-C processing between the SPGW thread and the data-plane workers
+  std::mutex m_ctrl_mutex;
+
   // GTP-C and GTP-U handlers
   gtpc* m_gtpc;
   gtpu* m_gtpu;
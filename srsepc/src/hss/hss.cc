@@ -28,6 +28,7 @@
 #include <stdlib.h> /* srand, rand */
 #include <string>
 #include <time.h>
+#include <vector>
 
 namespace srsepc {
 
@@ -69,7 +70,9 @@ int hss::init(hss_args_t* hss_args)
   srand(time(NULL));
 
   /*Read user information from DB*/
-  if (read_db_file(hss_args->db_file) == false) {
+  bool db_ok = hss_db::is_db_file(hss_args->db_file) ? open_db(hss_args->db_file, hss_args->db_sync)
+                                                      : read_db_file(hss_args->db_file);
+  if (db_ok == false) {
     srsran::console("Error reading user database file %s\n", hss_args->db_file.c_str());
     return -1;
   }
@@ -86,10 +89,35 @@ int hss::init(hss_args_t* hss_args)
 
 void hss::stop()
 {
-  write_db_file(db_file);
+  if (m_db != nullptr) {
+    // SQNs are already stored, only checkpoint the journal
+    m_db->close();
+    m_db.reset();
+  } else {
+    write_db_file(db_file);
+  }
   return;
 }
 
+bool hss::open_db(const std::string& db_filename, bool sync)
+{
+  m_db = std::unique_ptr<hss_db>(new hss_db);
+  if (not m_db->open(db_filename, sync)) {
+    m_db.reset();
+    return false;
+  }
+
+  // Only records with a static IP are visited, so startup does not depend on the number of subscribers
+  for (const uint32_t* it = m_db->static_ip_records_begin(); it != m_db->static_ip_records_end(); ++it) {
+    const hss_db_record_t& rec = (*m_db)[*it];
+    char                   ip_str[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &rec.static_ip, ip_str, sizeof(ip_str));
+    m_ip_to_imsi.insert(std::make_pair(std::string(ip_str), rec.imsi));
+  }
+  m_logger.info("Opened binary DB file: %s, %d users", db_filename.c_str(), m_db->size());
+  return true;
+}
+
 bool hss::read_db_file(std::string db_filename)
 {
   std::ifstream m_db_file;
@@ -196,25 +224,7 @@ bool hss::write_db_file(std::string db_filename)
   m_logger.info("Opened DB file: %s", db_filename.c_str());
 
   // Write comment info
-  m_db_file << "#                                                                                           \n"
-            << "# .csv to store UE's information in HSS                                                     \n"
-            << "# Kept in the following format: \"Name,Auth,IMSI,Key,OP_Type,OP/OPc,AMF,SQN,QCI,IP_alloc\"  \n"
-            << "#                                                                                           \n"
-            << "# Name:     Human readable name to help distinguish UE's. Ignored by the HSS                \n"
-            << "# Auth:     Authentication algorithm used by the UE. Valid algorithms are XOR               \n"
-            << "#           (xor) and MILENAGE (mil)                                                        \n"
-            << "# IMSI:     UE's IMSI value                                                                 \n"
-            << "# Key:      UE's key, where other keys are derived from. Stored in hexadecimal              \n"
-            << "# OP_Type:  Operator's code type, either OP or OPc                                          \n"
-            << "# OP/OPc:   Operator Code/Cyphered Operator Code, stored in hexadecimal                     \n"
-            << "# AMF:      Authentication management field, stored in hexadecimal                          \n"
-            << "# SQN:      UE's Sequence number for freshness of the authentication                        \n"
-            << "# QCI:      QoS Class Identifier for the UE's default bearer.                               \n"
-            << "# IP_alloc: IP allocation stratagy for the SPGW.                                            \n"
-            << "#           With 'dynamic' the SPGW will automatically allocate IPs                         \n"
-            << "#           With a valid IPv4 (e.g. '172.16.0.2') the UE will have a statically assigned IP.\n"
-            << "#                                                                                           \n"
-            << "# Note: Lines starting by '#' are ignored and will be overwritten                           \n";
+  hss_db::write_csv_header(m_db_file);
 
   std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator it = m_imsi_to_ue_ctx.begin();
   while (it != m_imsi_to_ue_ctx.end()) {
@@ -256,87 +266,133 @@ bool hss::write_db_file(std::string db_filename)
 
 bool hss::gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres)
 {
-
-  m_logger.debug("Generating AUTH info answer");
-  hss_ue_ctx_t* ue_ctx = get_ue_ctx(imsi);
-  if (ue_ctx == nullptr) {
-    srsran::console("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
-    m_logger.error("User not found at HSS. IMSI: %015" PRIu64 "", imsi);
+  hss_auth_info_t info = {};
+  info.imsi            = imsi;
+  if (gen_auth_info_answers(&info, 1) == 0) {
     return false;
   }
-
-  switch (ue_ctx->algo) {
-    case HSS_ALGO_XOR:
-      gen_auth_info_answer_xor(ue_ctx, k_asme, autn, rand, xres);
-      break;
-    case HSS_ALGO_MILENAGE:
-      gen_auth_info_answer_milenage(ue_ctx, k_asme, autn, rand, xres);
-      break;
-  }
-  increment_ue_sqn(ue_ctx);
+  memcpy(k_asme, info.k_asme, sizeof(info.k_asme));
+  memcpy(autn, info.autn, sizeof(info.autn));
+  memcpy(rand, info.rand, sizeof(info.rand));
+  memcpy(xres, info.xres, sizeof(info.xres));
   return true;
 }
 
-void hss::gen_auth_info_answer_milenage(hss_ue_ctx_t* ue_ctx,
-                                        uint8_t*      k_asme,
-                                        uint8_t*      autn,
-                                        uint8_t*      rand,
-                                        uint8_t*      xres)
+uint32_t hss::gen_auth_info_answers(hss_auth_info_t* infos, uint32_t nof_infos)
 {
-  // Get K, AMF, OPC and SQN
-  uint8_t* k   = ue_ctx->key;
-  uint8_t* amf = ue_ctx->amf;
-  uint8_t* opc = ue_ctx->opc;
-  uint8_t* sqn = ue_ctx->sqn;
-
-  // Temp variables
-  uint8_t ck[16];
-  uint8_t ik[16];
-  uint8_t ak[6];
-  uint8_t mac[8];
-
-  gen_rand(rand);
+  m_logger.debug("Generating AUTH info answers. Requests: %d", nof_infos);
+  std::unique_ptr<milenage_air_t[]> airs(new milenage_air_t[nof_infos]);
+  uint32_t                          nof_airs  = 0;
+  uint32_t                          nof_found = 0;
+  for (uint32_t i = 0; i < nof_infos; ++i) {
+    hss_auth_info_t*            info = &infos[i];
+    milenage_air_t*             air  = &airs[nof_airs];
+    std::lock_guard<std::mutex> lock(get_ue_ctx_lock(info->imsi));
+    hss_ue_ctx_t*               ue_ctx = get_ue_ctx(info->imsi, air->db_ue_ctx);
+    info->user_found                   = ue_ctx != nullptr;
+    if (ue_ctx == nullptr) {
+      srsran::console("User not found at HSS. IMSI: %015" PRIu64 "\n", info->imsi);
+      m_logger.error("User not found at HSS. IMSI: %015" PRIu64 "", info->imsi);
+      continue;
+    }
+    nof_found++;
+
+    switch (ue_ctx->algo) {
+      case HSS_ALGO_XOR:
+        gen_auth_info_answer_xor(ue_ctx, info->k_asme, info->autn, info->rand, info->xres);
+        break;
+      case HSS_ALGO_MILENAGE:
+        air->info = info;
+        prepare_auth_info_answer_milenage(ue_ctx, air);
+        nof_airs++;
+        break;
+    }
+    // Requests of the same UE in one batch get consecutive SQNs
+    increment_ue_sqn(ue_ctx);
+    store_ue_sqn(ue_ctx);
+  }
 
-  srsran::security_milenage_f2345(k, opc, rand, xres, ck, ik, ak);
+  gen_auth_info_answers_milenage(airs.get(), nof_airs);
+  return nof_found;
+}
 
-  m_logger.debug(k, 16, "User Key : ");
-  m_logger.debug(opc, 16, "User OPc : ");
-  m_logger.debug(rand, 16, "User Rand : ");
-  m_logger.debug(xres, 8, "User XRES: ");
-  m_logger.debug(ck, 16, "User CK: ");
-  m_logger.debug(ik, 16, "User IK: ");
-  m_logger.debug(ak, 6, "User AK: ");
+void hss::prepare_auth_info_answer_milenage(hss_ue_ctx_t* ue_ctx, milenage_air_t* air)
+{
+  gen_rand(air->info->rand);
+  memcpy(air->sqn, ue_ctx->sqn, sizeof(air->sqn));
+  ue_ctx->set_last_rand(air->info->rand);
 
-  srsran::security_milenage_f1(k, opc, rand, sqn, amf, mac);
+  // The key schedule of a CSV context is only expanded once, so it can be read without the lock. K, OPc and AMF never
+  // change after init.
+  if (not ue_ctx->milenage_key.is_set()) {
+    ue_ctx->milenage_key.set_key(ue_ctx->key);
+  }
+  air->ue_ctx = ue_ctx;
 
-  m_logger.debug(sqn, 6, "User SQN : ");
-  m_logger.debug(mac, 8, "User MAC : ");
+  m_logger.debug(ue_ctx->key, 16, "User Key : ");
+  m_logger.debug(ue_ctx->opc, 16, "User OPc : ");
+  m_logger.debug(air->info->rand, 16, "User Rand : ");
+  m_logger.debug(air->sqn, 6, "User SQN : ");
+}
 
-  uint8_t ak_xor_sqn[6];
-  for (int i = 0; i < 6; i++) {
-    ak_xor_sqn[i] = sqn[i] ^ ak[i];
-  }
-  // Generate K_asme
-  srsran::security_generate_k_asme(ck, ik, ak_xor_sqn, mcc, mnc, k_asme);
+void hss::gen_auth_info_answers_milenage(milenage_air_t* airs, uint32_t nof_airs)
+{
+  if (nof_airs == 0) {
+    return;
+  }
+
+  // f1 and f2345 share TEMP, and the AES blocks of all the vectors are pipelined
+  std::vector<srsran::security_milenage_vec_t> vecs(nof_airs);
+  for (uint32_t i = 0; i < nof_airs; ++i) {
+    milenage_air_t&                  air = airs[i];
+    srsran::security_milenage_vec_t& vec = vecs[i];
+    vec.k                                = &air.ue_ctx->milenage_key;
+    vec.opc                              = air.ue_ctx->opc;
+    vec.rand                             = air.info->rand;
+    vec.sqn                              = air.sqn;
+    vec.amf                              = air.ue_ctx->amf;
+    vec.mac_a                            = air.mac;
+    vec.res                              = air.info->xres;
+    vec.ck                               = air.ck;
+    vec.ik                               = air.ik;
+    vec.ak                               = air.ak;
+  }
+  srsran::security_milenage_batch(vecs.data(), nof_airs);
+
+  for (uint32_t i = 0; i < nof_airs; ++i) {
+    milenage_air_t&  air  = airs[i];
+    hss_auth_info_t* info = air.info;
+    uint8_t*         sqn  = air.sqn;
+    uint8_t*         amf  = air.ue_ctx->amf;
+
+    m_logger.debug(info->xres, 8, "User XRES: ");
+    m_logger.debug(air.ck, 16, "User CK: ");
+    m_logger.debug(air.ik, 16, "User IK: ");
+    m_logger.debug(air.ak, 6, "User AK: ");
+    m_logger.debug(air.mac, 8, "User MAC : ");
+
+    uint8_t ak_xor_sqn[6];
+    for (int j = 0; j < 6; j++) {
+      ak_xor_sqn[j] = sqn[j] ^ air.ak[j];
+    }
+    // Generate K_asme
+    srsran::security_generate_k_asme(air.ck, air.ik, ak_xor_sqn, mcc, mnc, info->k_asme);
 
-  m_logger.debug("User MCC : %x  MNC : %x ", mcc, mnc);
-  m_logger.debug(k_asme, 32, "User k_asme : ");
+    m_logger.debug("User MCC : %x  MNC : %x ", mcc, mnc);
+    m_logger.debug(info->k_asme, 32, "User k_asme : ");
 
-  // Generate AUTN (autn = sqn ^ ak |+| amf |+| mac)
-  for (int i = 0; i < 6; i++) {
-    autn[i] = sqn[i] ^ ak[i];
-  }
-  for (int i = 0; i < 2; i++) {
-    autn[6 + i] = amf[i];
-  }
-  for (int i = 0; i < 8; i++) {
-    autn[8 + i] = mac[i];
+    // Generate AUTN (autn = sqn ^ ak |+| amf |+| mac)
+    for (int j = 0; j < 6; j++) {
+      info->autn[j] = ak_xor_sqn[j];
+    }
+    for (int j = 0; j < 2; j++) {
+      info->autn[6 + j] = amf[j];
+    }
+    for (int j = 0; j < 8; j++) {
+      info->autn[8 + j] = air.mac[j];
+    }
+    m_logger.debug(info->autn, 16, "User AUTN: ");
   }
-  m_logger.debug(autn, 16, "User AUTN: ");
-
-  // Set last RAND
-  ue_ctx->set_last_rand(rand);
-  return;
 }
 
 void hss::gen_auth_info_answer_xor(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres)
@@ -440,13 +496,13 @@ void hss::gen_auth_info_answer_xor(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_
 
 bool hss::gen_update_loc_answer(uint64_t imsi, uint8_t* qci)
 {
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
-  if (ue_ctx_it == m_imsi_to_ue_ctx.end()) {
-    m_logger.info("User not found. IMSI: %015" PRIu64 "", imsi);
+  std::lock_guard<std::mutex> lock(get_ue_ctx_lock(imsi));
+  hss_ue_ctx_t                db_ue_ctx;
+  hss_ue_ctx_t*               ue_ctx = get_ue_ctx(imsi, db_ue_ctx);
+  if (ue_ctx == nullptr) {
     srsran::console("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
     return false;
   }
-  const std::unique_ptr<hss_ue_ctx_t>& ue_ctx = ue_ctx_it->second;
   m_logger.info("Found User %015" PRIu64 "", imsi);
   *qci = ue_ctx->qci;
   return true;
@@ -455,7 +511,9 @@ bool hss::gen_update_loc_answer(uint64_t imsi, uint8_t* qci)
 bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
 {
   m_logger.debug("Re-syncing SQN");
-  hss_ue_ctx_t* ue_ctx = get_ue_ctx(imsi);
+  std::lock_guard<std::mutex> lock(get_ue_ctx_lock(imsi));
+  hss_ue_ctx_t                db_ue_ctx;
+  hss_ue_ctx_t*               ue_ctx = get_ue_ctx(imsi, db_ue_ctx);
   if (ue_ctx == nullptr) {
     srsran::console("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
     m_logger.error("User not found at HSS. IMSI: %015" PRIu64 "", imsi);
@@ -472,6 +530,7 @@ bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
   }
 
   increment_seq_after_resync(ue_ctx);
+  store_ue_sqn(ue_ctx);
   return true;
 }
 
@@ -514,7 +573,15 @@ void hss::resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* auts)
   m_logger.debug(sqn_ms_xor_ak, 6, "SQN xor AK : ");
   m_logger.debug(mac_s, 8, "MAC : ");
 
-  srsran::security_milenage_f5_star(k, opc, last_rand, ak);
+  if (not ue_ctx->milenage_key.is_set()) {
+    ue_ctx->milenage_key.set_key(k);
+  }
+  srsran::security_milenage_vec_t vec = {};
+  vec.k                               = &ue_ctx->milenage_key;
+  vec.opc                             = opc;
+  vec.rand                            = last_rand;
+  vec.ak_star                         = ak;
+  srsran::security_milenage_batch(&vec, 1);
   m_logger.debug(ak, 6, "Resynch AK : ");
 
   uint8_t sqn_ms[6];
@@ -528,7 +595,15 @@ void hss::resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* auts)
 
   uint8_t dummy_amf[2] = {};
 
-  srsran::security_milenage_f1_star(k, opc, last_rand, sqn_ms, dummy_amf, mac_s_tmp);
+  // f1* depends on SQN MS, which is only known once AK has been computed
+  vec       = {};
+  vec.k     = &ue_ctx->milenage_key;
+  vec.opc   = opc;
+  vec.rand  = last_rand;
+  vec.sqn   = sqn_ms;
+  vec.amf   = dummy_amf;
+  vec.mac_s = mac_s_tmp;
+  srsran::security_milenage_batch(&vec, 1);
   m_logger.debug(mac_s_tmp, 8, "MAC calc : ");
 
   ue_ctx->set_sqn(sqn_ms);
@@ -610,8 +685,28 @@ void hss::gen_rand(uint8_t rand_[16])
   return;
 }
 
-hss_ue_ctx_t* hss::get_ue_ctx(uint64_t imsi)
+hss_ue_ctx_t* hss::get_ue_ctx(uint64_t imsi, hss_ue_ctx_t& db_ue_ctx)
 {
+  if (m_db != nullptr) {
+    // Copy the fields needed by the AKA procedures. The SQN and last RAND are written back by store_ue_sqn()
+    const hss_db_record_t* rec = m_db->find(imsi);
+    if (rec == nullptr) {
+      m_logger.info("User not found. IMSI: %015" PRIu64 "", imsi);
+      return nullptr;
+    }
+    db_ue_ctx.imsi          = rec->imsi;
+    db_ue_ctx.algo          = (hss_auth_algo)rec->algo;
+    db_ue_ctx.op_configured = rec->op_configured;
+    db_ue_ctx.qci           = rec->qci;
+    memcpy(db_ue_ctx.key, rec->key, sizeof(db_ue_ctx.key));
+    memcpy(db_ue_ctx.op, rec->op, sizeof(db_ue_ctx.op));
+    memcpy(db_ue_ctx.opc, rec->opc, sizeof(db_ue_ctx.opc));
+    memcpy(db_ue_ctx.amf, rec->amf, sizeof(db_ue_ctx.amf));
+    db_ue_ctx.set_sqn(rec->sqn);
+    db_ue_ctx.set_last_rand(rec->last_rand);
+    return &db_ue_ctx;
+  }
+
   std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
   if (ue_ctx_it == m_imsi_to_ue_ctx.end()) {
     m_logger.info("User not found. IMSI: %015" PRIu64 "", imsi);
@@ -621,6 +716,14 @@ hss_ue_ctx_t* hss::get_ue_ctx(uint64_t imsi)
   return ue_ctx_it->second.get();
 }
 
+void hss::store_ue_sqn(hss_ue_ctx_t* ue_ctx)
+{
+  // Contexts of the CSV database are updated in place and saved at stop()
+  if (m_db != nullptr and not m_db->update_sqn(ue_ctx->imsi, ue_ctx->sqn, ue_ctx->last_rand)) {
+    m_logger.error("Could not store SQN -- IMSI: %015" PRIu64 "", ue_ctx->imsi);
+  }
+}
+
 std::map<std::string, uint64_t> hss::get_ip_to_imsi(void) const
 {
   return m_ip_to_imsi;
@@ -0,0 +1,513 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include "srsepc/hdr/hss/hss_db.h"
+#include "srsran/common/security.h"
+#include "srsran/common/string_helpers.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <inttypes.h>
+#include <iomanip>
+#include <set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace srsepc {
+
+namespace {
+
+const char     db_magic[8] = {'S', 'R', 'S', 'H', 'S', 'S', 'D', 'B'};
+const uint32_t db_version  = 1;
+
+// File layout: header, records, IMSI index and static IP record table, each section 64-byte aligned.
+struct db_header_t {
+  char     magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t nof_records;
+  uint32_t nof_buckets; // power of 2, each bucket holds a record index + 1 or 0 when empty
+  uint32_t nof_static_ips;
+  uint32_t reserved;
+  uint64_t records_offset;
+  uint64_t index_offset;
+  uint64_t static_ips_offset;
+  uint64_t file_size;
+};
+
+struct journal_entry_t {
+  uint64_t imsi;
+  uint8_t  sqn[6];
+  uint8_t  last_rand[16];
+  uint16_t reserved;
+  uint32_t checksum;
+  uint32_t reserved2;
+};
+
+static_assert(sizeof(hss_db_record_t) == 120, "Changing the record layout requires a new db_version");
+static_assert(sizeof(journal_entry_t) == 40, "Unexpected journal entry layout");
+static_assert(std::is_trivially_copyable<hss_db_record_t>::value, "Records are accessed in place");
+
+uint64_t align_offset(uint64_t offset)
+{
+  return (offset + 63) & ~uint64_t(63);
+}
+
+uint32_t hash_imsi(uint64_t imsi)
+{
+  // IMSIs are mostly consecutive, mix all bits before masking
+  imsi ^= imsi >> 33U;
+  imsi *= 0xff51afd7ed558ccdULL;
+  imsi ^= imsi >> 33U;
+  return (uint32_t)imsi;
+}
+
+uint32_t journal_checksum(const journal_entry_t& entry)
+{
+  // FNV-1a over the entry contents, enough to detect an entry torn by a crash
+  const uint8_t* data = (const uint8_t*)&entry;
+  uint32_t       hash = 2166136261U;
+  for (size_t i = 0; i < offsetof(journal_entry_t, checksum); ++i) {
+    hash = (hash ^ data[i]) * 16777619U;
+  }
+  return hash;
+}
+
+std::string journal_filename(const std::string& filename)
+{
+  return filename + ".journal";
+}
+
+} // namespace
+
+hss_db::~hss_db()
+{
+  close();
+}
+
+bool hss_db::is_db_file(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  char          magic[sizeof(db_magic)];
+  return file.read(magic, sizeof(magic)) and memcmp(magic, db_magic, sizeof(magic)) == 0;
+}
+
+bool hss_db::create(const std::string& filename, const std::vector<hss_db_record_t>& records)
+{
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("HSS");
+
+  // Index with a load factor of 50% at most
+  uint32_t nof_buckets = 16;
+  while (nof_buckets < 2 * records.size()) {
+    nof_buckets *= 2;
+  }
+  std::vector<uint32_t> buckets(nof_buckets, 0);
+  std::vector<uint32_t> static_ip_records;
+  for (uint32_t i = 0; i < records.size(); ++i) {
+    uint32_t pos = hash_imsi(records[i].imsi) & (nof_buckets - 1);
+    while (buckets[pos] != 0) {
+      if (records[buckets[pos] - 1].imsi == records[i].imsi) {
+        logger.error("Duplicated IMSI %015" PRIu64 " in HSS database", records[i].imsi);
+        return false;
+      }
+      pos = (pos + 1) & (nof_buckets - 1);
+    }
+    buckets[pos] = i + 1;
+    if (records[i].static_ip != 0) {
+      static_ip_records.push_back(i);
+    }
+  }
+
+  db_header_t header = {};
+  memcpy(header.magic, db_magic, sizeof(db_magic));
+  header.version           = db_version;
+  header.record_size       = sizeof(hss_db_record_t);
+  header.nof_records       = records.size();
+  header.nof_buckets       = nof_buckets;
+  header.nof_static_ips    = static_ip_records.size();
+  header.records_offset    = align_offset(sizeof(db_header_t));
+  header.index_offset      = align_offset(header.records_offset + records.size() * sizeof(hss_db_record_t));
+  header.static_ips_offset = align_offset(header.index_offset + nof_buckets * sizeof(uint32_t));
+  header.file_size         = header.static_ips_offset + static_ip_records.size() * sizeof(uint32_t);
+
+  // Write a temporary file and rename it, so that a failed import never leaves a truncated database behind
+  std::string   tmp_filename = filename + ".tmp";
+  std::ofstream file(tmp_filename, std::ios::binary | std::ios::trunc);
+  if (not file.is_open()) {
+    logger.error("Could not create HSS database %s", tmp_filename.c_str());
+    return false;
+  }
+  const char padding[64] = {};
+  file.write((const char*)&header, sizeof(header));
+  file.write(padding, header.records_offset - sizeof(header));
+  file.write((const char*)records.data(), records.size() * sizeof(hss_db_record_t));
+  file.write(padding, header.index_offset - header.records_offset - records.size() * sizeof(hss_db_record_t));
+  file.write((const char*)buckets.data(), buckets.size() * sizeof(uint32_t));
+  file.write(padding, header.static_ips_offset - header.index_offset - buckets.size() * sizeof(uint32_t));
+  file.write((const char*)static_ip_records.data(), static_ip_records.size() * sizeof(uint32_t));
+  file.close();
+  if (file.fail()) {
+    logger.error("Error writing HSS database %s", tmp_filename.c_str());
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+
+  // A journal left by a previous database does not apply to this one
+  unlink(journal_filename(filename).c_str());
+  if (rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    logger.error("Could not rename %s to %s: %s", tmp_filename.c_str(), filename.c_str(), strerror(errno));
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool hss_db::read_csv(const std::string& filename, std::vector<hss_db_record_t>& records)
+{
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("HSS");
+
+  std::ifstream csv(filename);
+  if (not csv.is_open()) {
+    logger.error("Could not open %s", filename.c_str());
+    return false;
+  }
+
+  std::set<uint32_t> static_ips;
+  std::string        line;
+  uint32_t           line_nof = 0;
+  while (std::getline(csv, line)) {
+    line_nof++;
+    if (line.empty() or line[0] == '#') {
+      continue;
+    }
+    std::vector<std::string> split = srsran::split_string(line, ',');
+    if (split.size() != 10) {
+      logger.error("%s:%d: wrong number of columns %zd, expected 10", filename.c_str(), line_nof, split.size());
+      return false;
+    }
+
+    hss_db_record_t rec = {};
+    memcpy(rec.name, split[0].data(), std::min(split[0].size(), sizeof(rec.name)));
+    if (split[1] == "xor") {
+      rec.algo = HSS_ALGO_XOR;
+    } else if (split[1] == "mil") {
+      rec.algo = HSS_ALGO_MILENAGE;
+    } else {
+      logger.error("%s:%d: neither XOR nor MILENAGE configured", filename.c_str(), line_nof);
+      return false;
+    }
+    rec.imsi = strtoull(split[2].c_str(), nullptr, 10);
+    srsran::get_uint_vec_from_hex_str(split[3], rec.key, 16);
+    if (split[4] == "op") {
+      rec.op_configured = true;
+      srsran::get_uint_vec_from_hex_str(split[5], rec.op, 16);
+      srsran::compute_opc(rec.key, rec.op, rec.opc);
+    } else if (split[4] == "opc") {
+      rec.op_configured = false;
+      srsran::get_uint_vec_from_hex_str(split[5], rec.opc, 16);
+    } else {
+      logger.error("%s:%d: neither OP nor OPc configured", filename.c_str(), line_nof);
+      return false;
+    }
+    srsran::get_uint_vec_from_hex_str(split[6], rec.amf, 2);
+    srsran::get_uint_vec_from_hex_str(split[7], rec.sqn, 6);
+    rec.qci = (uint16_t)strtol(split[8].c_str(), nullptr, 10);
+    if (split[9] != "dynamic") {
+      if (inet_pton(AF_INET, split[9].c_str(), &rec.static_ip) != 1 or rec.static_ip == 0) {
+        logger.error("%s:%d: invalid static ip addr %s", filename.c_str(), line_nof, split[9].c_str());
+        return false;
+      }
+      if (not static_ips.insert(rec.static_ip).second) {
+        logger.error("%s:%d: duplicate static ip addr %s", filename.c_str(), line_nof, split[9].c_str());
+        return false;
+      }
+    }
+    records.push_back(rec);
+  }
+  return true;
+}
+
+void hss_db::write_csv_header(std::ostream& os)
+{
+  os << "#                                                                                           \n"
+     << "# .csv to store UE's information in HSS                                                     \n"
+     << "# Kept in the following format: \"Name,Auth,IMSI,Key,OP_Type,OP/OPc,AMF,SQN,QCI,IP_alloc\"  \n"
+     << "#                                                                                           \n"
+     << "# Name:     Human readable name to help distinguish UE's. Ignored by the HSS                \n"
+     << "# Auth:     Authentication algorithm used by the UE. Valid algorithms are XOR               \n"
+     << "#           (xor) and MILENAGE (mil)                                                        \n"
+     << "# IMSI:     UE's IMSI value                                                                 \n"
+     << "# Key:      UE's key, where other keys are derived from. Stored in hexadecimal              \n"
+     << "# OP_Type:  Operator's code type, either OP or OPc                                          \n"
+     << "# OP/OPc:   Operator Code/Cyphered Operator Code, stored in hexadecimal                     \n"
+     << "# AMF:      Authentication management field, stored in hexadecimal                          \n"
+     << "# SQN:      UE's Sequence number for freshness of the authentication                        \n"
+     << "# QCI:      QoS Class Identifier for the UE's default bearer.                               \n"
+     << "# IP_alloc: IP allocation stratagy for the SPGW.                                            \n"
+     << "#           With 'dynamic' the SPGW will automatically allocate IPs                         \n"
+     << "#           With a valid IPv4 (e.g. '172.16.0.2') the UE will have a statically assigned IP.\n"
+     << "#                                                                                           \n"
+     << "# Note: Lines starting by '#' are ignored and will be overwritten                           \n";
+}
+
+bool hss_db::write_csv(const std::string& filename, const std::vector<hss_db_record_t>& records)
+{
+  std::ofstream csv(filename, std::ofstream::out | std::ofstream::trunc);
+  if (not csv.is_open()) {
+    srslog::fetch_basic_logger("HSS").error("Could not open %s", filename.c_str());
+    return false;
+  }
+
+  write_csv_header(csv);
+  for (hss_db_record_t rec : records) {
+    csv << std::string(rec.name, strnlen(rec.name, sizeof(rec.name))) << ",";
+    csv << (rec.algo == HSS_ALGO_XOR ? "xor" : "mil") << ",";
+    csv << std::setfill('0') << std::setw(15) << rec.imsi << ",";
+    csv << srsran::hex_string(rec.key, 16) << ",";
+    if (rec.op_configured) {
+      csv << "op," << srsran::hex_string(rec.op, 16) << ",";
+    } else {
+      csv << "opc," << srsran::hex_string(rec.opc, 16) << ",";
+    }
+    csv << srsran::hex_string(rec.amf, 2) << ",";
+    csv << srsran::hex_string(rec.sqn, 6) << ",";
+    csv << rec.qci << ",";
+    if (rec.static_ip != 0) {
+      char ip_str[INET_ADDRSTRLEN];
+      inet_ntop(AF_INET, &rec.static_ip, ip_str, sizeof(ip_str));
+      csv << ip_str << "\n";
+    } else {
+      csv << "dynamic\n";
+    }
+  }
+  csv.close();
+  return not csv.fail();
+}
+
+bool hss_db::open(const std::string& filename, bool sync_journal)
+{
+  close();
+
+  m_fd = ::open(filename.c_str(), O_RDWR);
+  if (m_fd < 0) {
+    m_logger.error("Could not open HSS database %s: %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (fstat(m_fd, &st) != 0 or (size_t)st.st_size < sizeof(db_header_t)) {
+    m_logger.error("HSS database %s is too short", filename.c_str());
+    close();
+    return false;
+  }
+  void* map = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED) {
+    m_logger.error("Could not map HSS database %s: %s", filename.c_str(), strerror(errno));
+    close();
+    return false;
+  }
+  m_map      = (uint8_t*)map;
+  m_map_size = st.st_size;
+  m_filename = filename;
+  // Lookups hit random pages, read-ahead would only fetch records nobody asked for
+  madvise(m_map, m_map_size, MADV_RANDOM);
+
+  const db_header_t* header = (const db_header_t*)m_map;
+  if (memcmp(header->magic, db_magic, sizeof(db_magic)) != 0 or header->version != db_version or
+      header->record_size != sizeof(hss_db_record_t) or header->file_size != m_map_size or
+      header->nof_buckets == 0 or (header->nof_buckets & (header->nof_buckets - 1)) != 0 or
+      header->nof_buckets < 2 * (uint64_t)header->nof_records or
+      header->records_offset + (uint64_t)header->nof_records * sizeof(hss_db_record_t) > header->index_offset or
+      header->index_offset + (uint64_t)header->nof_buckets * sizeof(uint32_t) > header->static_ips_offset or
+      header->static_ips_offset + (uint64_t)header->nof_static_ips * sizeof(uint32_t) > m_map_size) {
+    m_logger.error("HSS database %s is corrupt or was written by another version", filename.c_str());
+    close();
+    return false;
+  }
+  m_records           = (hss_db_record_t*)(m_map + header->records_offset);
+  m_nof_records       = header->nof_records;
+  m_buckets           = (const uint32_t*)(m_map + header->index_offset);
+  m_bucket_mask       = header->nof_buckets - 1;
+  m_static_ip_records = (const uint32_t*)(m_map + header->static_ips_offset);
+  m_nof_static_ips    = header->nof_static_ips;
+  m_sync_journal      = sync_journal;
+
+  m_journal_fd = ::open(journal_filename(filename).c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (m_journal_fd < 0) {
+    m_logger.error("Could not open HSS journal %s: %s", journal_filename(filename).c_str(), strerror(errno));
+    close();
+    return false;
+  }
+  if (not replay_journal()) {
+    close();
+    return false;
+  }
+
+  m_logger.info("Opened HSS database %s with %d subscribers", filename.c_str(), m_nof_records);
+  return true;
+}
+
+void hss_db::close()
+{
+  if (m_map != nullptr and m_journal_fd >= 0) {
+    checkpoint();
+  }
+  if (m_journal_fd >= 0) {
+    ::close(m_journal_fd);
+    m_journal_fd = -1;
+  }
+  if (m_map != nullptr) {
+    munmap(m_map, m_map_size);
+    m_map               = nullptr;
+    m_map_size          = 0;
+    m_records           = nullptr;
+    m_nof_records       = 0;
+    m_buckets           = nullptr;
+    m_static_ip_records = nullptr;
+    m_nof_static_ips    = 0;
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+std::vector<hss_db_record_t> hss_db::get_records() const
+{
+  return std::vector<hss_db_record_t>(m_records, m_records + m_nof_records);
+}
+
+hss_db_record_t* hss_db::find_record(uint64_t imsi) const
+{
+  if (m_map == nullptr) {
+    return nullptr;
+  }
+  // The index lives in the mapped file, so a damaged one must not send the probe out of the records or around forever
+  uint32_t pos = hash_imsi(imsi) & m_bucket_mask;
+  for (uint32_t nof_probes = 0; nof_probes <= m_bucket_mask and m_buckets[pos] != 0; ++nof_probes) {
+    uint32_t idx = m_buckets[pos] - 1;
+    if (idx >= m_nof_records) {
+      m_logger.error("HSS database %s has an index entry out of bounds (%d)", m_filename.c_str(), idx);
+      return nullptr;
+    }
+    if (m_records[idx].imsi == imsi) {
+      return &m_records[idx];
+    }
+    pos = (pos + 1) & m_bucket_mask;
+  }
+  return nullptr;
+}
+
+const hss_db_record_t* hss_db::find(uint64_t imsi) const
+{
+  return find_record(imsi);
+}
+
+bool hss_db::update_sqn(uint64_t imsi, const uint8_t* sqn, const uint8_t* last_rand)
+{
+  hss_db_record_t* rec = find_record(imsi);
+  if (rec == nullptr) {
+    return false;
+  }
+  memcpy(rec->sqn, sqn, sizeof(rec->sqn));
+  memcpy(rec->last_rand, last_rand, sizeof(rec->last_rand));
+
+  // The mapped page reaches the disk whenever the kernel writes it back, the journal entry makes the update
+  // durable before that
+  journal_entry_t entry = {};
+  entry.imsi            = imsi;
+  memcpy(entry.sqn, sqn, sizeof(entry.sqn));
+  memcpy(entry.last_rand, last_rand, sizeof(entry.last_rand));
+  entry.checksum = journal_checksum(entry);
+
+  std::lock_guard<std::mutex> lock(m_journal_mutex);
+  if (write(m_journal_fd, &entry, sizeof(entry)) != sizeof(entry)) {
+    m_logger.error("Error writing HSS journal: %s", strerror(errno));
+    return false;
+  }
+  if (m_sync_journal) {
+    fdatasync(m_journal_fd);
+  }
+  if (++m_nof_journal_entries >= MAX_JOURNAL_ENTRIES) {
+    return checkpoint_unlocked();
+  }
+  return true;
+}
+
+bool hss_db::checkpoint()
+{
+  std::lock_guard<std::mutex> lock(m_journal_mutex);
+  return checkpoint_unlocked();
+}
+
+bool hss_db::checkpoint_unlocked()
+{
+  if (m_nof_journal_entries == 0) {
+    return true;
+  }
+  if (msync(m_map, m_map_size, MS_SYNC) != 0) {
+    m_logger.error("Error flushing HSS database %s: %s", m_filename.c_str(), strerror(errno));
+    return false;
+  }
+  if (ftruncate(m_journal_fd, 0) != 0) {
+    m_logger.error("Error truncating HSS journal: %s", strerror(errno));
+    return false;
+  }
+  m_nof_journal_entries = 0;
+  return true;
+}
+
+bool hss_db::replay_journal()
+{
+  journal_entry_t entry;
+  uint32_t        nof_entries = 0;
+  if (lseek(m_journal_fd, 0, SEEK_SET) != 0) {
+    return false;
+  }
+  while (read(m_journal_fd, &entry, sizeof(entry)) == sizeof(entry)) {
+    // A crash can leave the last entry partially written, it was never acknowledged
+    if (entry.checksum != journal_checksum(entry)) {
+      m_logger.warning("Discarding corrupt HSS journal entry %d", nof_entries);
+      break;
+    }
+    hss_db_record_t* rec = find_record(entry.imsi);
+    if (rec != nullptr) {
+      memcpy(rec->sqn, entry.sqn, sizeof(rec->sqn));
+      memcpy(rec->last_rand, entry.last_rand, sizeof(rec->last_rand));
+    }
+    nof_entries++;
+  }
+  if (nof_entries > 0) {
+    m_logger.info("Replayed %d SQN updates from the HSS journal", nof_entries);
+  }
+
+  // Always start with an empty journal, also when its tail was corrupt
+  m_nof_journal_entries = nof_entries;
+  if (m_nof_journal_entries == 0 and lseek(m_journal_fd, 0, SEEK_END) > 0) {
+    m_nof_journal_entries = 1;
+  }
+  return checkpoint_unlocked();
+}
+
+} // namespace srsepc
@@ -0,0 +1,82 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/// Converts HSS subscriber databases between the user_db.csv format and the binary format opened by srsepc.
+/// Usage: srsepc_hss_db import <user_db.csv> <user_db.db>
+///        srsepc_hss_db export <user_db.db> <user_db.csv>
+///        srsepc_hss_db info <user_db.db>
+
+#include "srsepc/hdr/hss/hss_db.h"
+#include <cstring>
+
+using namespace srsepc;
+
+static void usage(const char* prog)
+{
+  fmt::print(stderr,
+             "Usage: {0} import <csv file> <db file>\n"
+             "       {0} export <db file> <csv file>\n"
+             "       {0} info <db file>\n"
+             "Imports a user_db.csv into a binary HSS database, exports a binary database with its current SQNs "
+             "back to CSV, or prints the number of subscribers of a database.\n",
+             prog);
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 3 || !std::strcmp(argv[1], "-h") || !std::strcmp(argv[1], "--help")) {
+    usage(argv[0]);
+    return 1;
+  }
+  // Errors are reported by the HSS logger
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("HSS", srslog::fetch_stderr_sink(), false);
+  logger.set_level(srslog::basic_levels::warning);
+  srslog::init();
+
+  int ret = 1;
+  if (!std::strcmp(argv[1], "import") && argc == 4) {
+    std::vector<hss_db_record_t> records;
+    if (hss_db::read_csv(argv[2], records) && hss_db::create(argv[3], records)) {
+      fmt::print(stderr, "Imported {} subscribers into \"{}\"\n", records.size(), argv[3]);
+      ret = 0;
+    }
+  } else if (!std::strcmp(argv[1], "export") && argc == 4) {
+    // Opening the database replays its journal, so the latest SQNs are exported
+    hss_db db;
+    if (db.open(argv[2], false) && hss_db::write_csv(argv[3], db.get_records())) {
+      fmt::print(stderr, "Exported {} subscribers to \"{}\"\n", db.size(), argv[3]);
+      ret = 0;
+    }
+  } else if (!std::strcmp(argv[1], "info") && argc == 3) {
+    hss_db db;
+    if (db.open(argv[2], false)) {
+      fmt::print("{} subscribers, {} with a static IP\n",
+                 db.size(),
+                 db.static_ip_records_end() - db.static_ip_records_begin());
+      ret = 0;
+    }
+  } else {
+    usage(argv[0]);
+  }
+
+  srslog::flush();
+  return ret;
+}
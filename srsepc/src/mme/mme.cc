@@ -20,9 +20,12 @@
  */
 
 #include "srsepc/hdr/mme/mme.h"
+#include "srsran/common/epoll_helper.h"
 #include <arpa/inet.h>
 #include <inttypes.h> // for printing uint64_t
+#include <future>
 #include <netinet/sctp.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -31,7 +34,7 @@ namespace srsepc {
 mme*            mme::m_instance    = NULL;
 pthread_mutex_t mme_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-mme::mme() : m_running(false), thread("MME")
+mme::mme() : m_running(false), thread("MME"), m_nas_timers([this](bool arm) { arm_timer_tick(arm); })
 {
   return;
 }
@@ -65,11 +68,14 @@ int mme::init(mme_args_t* args)
 {
   /*Init S1AP*/
   m_s1ap = s1ap::get_instance();
+  m_s1ap->set_nof_shards(args->nof_workers);
   if (m_s1ap->init(args->s1ap_args)) {
     m_s1ap_logger.error("Error initializing MME S1APP");
     exit(-1);
   }
 
+  m_hss = hss::get_instance();
+
   /*Init GTP-C*/
   m_mme_gtpc = mme_gtpc::get_instance();
   if (!m_mme_gtpc->init()) {
@@ -77,6 +83,35 @@ int mme::init(mme_args_t* args)
     exit(-1);
   }
 
+  /*Init event loop: S1-MME, S11, NAS timer tick and stop event*/
+  m_epoll_fd = epoll_create1(0);
+  m_stop_fd  = eventfd(0, EFD_NONBLOCK);
+  m_tick_fd  = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  if (m_epoll_fd < 0 || m_stop_fd < 0 || m_tick_fd < 0) {
+    m_s1ap_logger.error("Error creating MME event loop descriptors: %s", strerror(errno));
+    return SRSRAN_ERROR;
+  }
+  if (add_epoll(m_s1ap->get_s1_mme(), m_epoll_fd) != SRSRAN_SUCCESS ||
+      add_epoll(m_mme_gtpc->get_s11(), m_epoll_fd) != SRSRAN_SUCCESS ||
+      add_epoll(m_tick_fd, m_epoll_fd) != SRSRAN_SUCCESS || add_epoll(m_stop_fd, m_epoll_fd) != SRSRAN_SUCCESS) {
+    m_s1ap_logger.error("Error registering MME descriptors in epoll");
+    return SRSRAN_ERROR;
+  }
+
+  /*Init signalling workers, each owning the UEs of one shard*/
+  for (uint32_t i = 0; i < args->nof_workers; ++i) {
+    m_workers.emplace_back(new srsran::task_worker("MME_W" + std::to_string(i), WORKER_QUEUE_SIZE, true));
+    m_workers.back()->push_task([i]() { s1ap::set_current_shard(i); });
+    m_workers.back()->start();
+  }
+  if (args->nof_hss_workers > 0) {
+    if (m_workers.empty()) {
+      m_s1ap_logger.warning("HSS workers require MME workers. Generating authentication vectors inline.");
+    } else {
+      m_hss_workers.reset(new srsran::task_thread_pool(args->nof_hss_workers));
+    }
+  }
+
   /*Log successful initialization*/
   m_s1ap_logger.info("MME Initialized. MCC: 0x%x, MNC: 0x%x", args->s1ap_args.mcc, args->s1ap_args.mnc);
   srsran::console("MME Initialized. MCC: 0x%x, MNC: 0x%x\n", args->s1ap_args.mcc, args->s1ap_args.mnc);
@@ -86,11 +121,34 @@ int mme::init(mme_args_t* args)
 void mme::stop()
 {
   if (m_running) {
+    // Wake up the event loop and wait for it to finish before tearing down S1AP
+    m_running    = false;
+    uint64_t one = 1;
+    if (write(m_stop_fd, &one, sizeof(one)) < 0) {
+      m_s1ap_logger.error("Error signaling MME thread to stop: %s", strerror(errno));
+    }
+    wait_thread_finish();
+
+    // Pending HSS answers are posted to the workers, so the HSS pool is stopped first
+    if (m_hss_workers != nullptr) {
+      m_hss_workers->stop();
+      m_hss_workers.reset();
+    }
+    m_pending_airs.clear();
+    for (std::unique_ptr<srsran::task_worker>& worker : m_workers) {
+      worker->stop();
+    }
+    m_workers.clear();
     m_s1ap->stop();
     m_s1ap->cleanup();
-    m_running = false;
-    thread_cancel();
-    wait_thread_finish();
+  }
+  m_nas_timers.clear();
+
+  for (int* fd : {&m_epoll_fd, &m_stop_fd, &m_tick_fd}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
   }
   return;
 }
@@ -102,14 +160,6 @@ void mme::run_thread()
     m_s1ap_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
     return;
   }
-  uint32_t                     sz  = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
-
-  struct sockaddr_in     enb_addr;
-  struct sctp_sndrcvinfo sri;
-  socklen_t              fromlen = sizeof(enb_addr);
-  bzero(&enb_addr, sizeof(enb_addr));
-  int rd_sz;
-  int msg_flags = 0;
 
   // Mark the thread as running
   m_running = true;
@@ -118,121 +168,303 @@ void mme::run_thread()
   int s1mme = m_s1ap->get_s1_mme();
   int s11   = m_mme_gtpc->get_s11();
 
+  const int          max_events = 16;
+  struct epoll_event events[max_events];
   while (m_running) {
-    pdu->clear();
-    int max_fd = std::max(s1mme, s11);
-
-    FD_ZERO(&m_set);
-    FD_SET(s1mme, &m_set);
-    FD_SET(s11, &m_set);
-
-    // Add timers to select
-    for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end(); ++it) {
-      FD_SET(it->fd, &m_set);
-      max_fd = std::max(max_fd, it->fd);
-      m_s1ap_logger.debug("Adding Timer fd %d to fd_set", it->fd);
-    }
-
     m_s1ap_logger.debug("Waiting for S1-MME or S11 Message");
-    int n = select(max_fd + 1, &m_set, NULL, NULL, NULL);
-    if (n == -1) {
-      m_s1ap_logger.error("Error from select");
-    } else if (n) {
-      // Handle S1-MME
-      if (FD_ISSET(s1mme, &m_set)) {
-        rd_sz = sctp_recvmsg(s1mme, pdu->msg, sz, (struct sockaddr*)&enb_addr, &fromlen, &sri, &msg_flags);
-        if (rd_sz == -1 && errno != EAGAIN) {
-          m_s1ap_logger.error("Error reading from SCTP socket: %s", strerror(errno));
-        } else if (rd_sz == -1 && errno == EAGAIN) {
-          m_s1ap_logger.debug("Socket timeout reached");
-        } else {
-          if (msg_flags & MSG_NOTIFICATION) {
-            // Received notification
-            union sctp_notification* notification = (union sctp_notification*)pdu->msg;
-            m_s1ap_logger.debug("SCTP Notification %d", notification->sn_header.sn_type);
-            if (notification->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
-              m_s1ap_logger.info("SCTP Association Shutdown. Association: %d", sri.sinfo_assoc_id);
-              srsran::console("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
-              m_s1ap->delete_enb_ctx(sri.sinfo_assoc_id);
-            }
-          } else {
-            // Received data
-            pdu->N_bytes = rd_sz;
-            m_s1ap_logger.info("Received S1AP msg. Size: %d", pdu->N_bytes);
-            m_s1ap->handle_s1ap_rx_pdu(pdu.get(), &sri);
-          }
-        }
+    int nof_events = epoll_wait(m_epoll_fd, events, max_events, -1);
+    if (nof_events == -1) {
+      if (errno != EINTR) {
+        m_s1ap_logger.error("Error from epoll_wait: %s", strerror(errno));
       }
-      // Handle S11
-      if (FD_ISSET(s11, &m_set)) {
-        pdu->N_bytes = recvfrom(s11, pdu->msg, sz, 0, NULL, NULL);
-        m_mme_gtpc->handle_s11_pdu(pdu.get());
+      continue;
+    }
+
+    for (int i = 0; i < nof_events; ++i) {
+      int fd = events[i].data.fd;
+      if (fd == s1mme) {
+        handle_s1_mme_rx(s1mme, pdu.get());
+      } else if (fd == s11) {
+        handle_s11_rx(s11, pdu.get());
+      } else if (fd == m_tick_fd) {
+        handle_timer_tick();
+      } else if (fd == m_stop_fd) {
+        m_running = false;
       }
-      // Handle NAS Timers
-      for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end();) {
-        if (FD_ISSET(it->fd, &m_set)) {
-          m_s1ap_logger.info("Timer expired");
-          uint64_t exp;
-          rd_sz = read(it->fd, &exp, sizeof(uint64_t));
-          m_s1ap->expire_nas_timer(it->type, it->imsi);
-          close(it->fd);
-          timers.erase(it);
-        } else {
-          ++it;
-        }
+    }
+  }
+  return;
+}
+
+void mme::handle_s1_mme_rx(int s1mme, srsran::byte_buffer_t* pdu)
+{
+  uint32_t               sz = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
+  struct sockaddr_in     enb_addr;
+  struct sctp_sndrcvinfo sri;
+  socklen_t              fromlen   = sizeof(enb_addr);
+  int                    msg_flags = 0;
+  bzero(&enb_addr, sizeof(enb_addr));
+
+  pdu->clear();
+  int                        rd_sz;
+  s1mme_transport_interface* transport = m_s1ap->get_s1mme_transport();
+  if (transport != nullptr) {
+    rd_sz = transport->recv_msg(pdu->msg, sz, &sri, &msg_flags);
+  } else {
+    rd_sz = sctp_recvmsg(s1mme, pdu->msg, sz, (struct sockaddr*)&enb_addr, &fromlen, &sri, &msg_flags);
+  }
+  if (rd_sz == -1 && errno != EAGAIN) {
+    m_s1ap_logger.error("Error reading from SCTP socket: %s", strerror(errno));
+  } else if (rd_sz == -1 && errno == EAGAIN) {
+    m_s1ap_logger.debug("Socket timeout reached");
+  } else {
+    if (msg_flags & MSG_NOTIFICATION) {
+      // Received notification
+      union sctp_notification* notification = (union sctp_notification*)pdu->msg;
+      m_s1ap_logger.debug("SCTP Notification %d", notification->sn_header.sn_type);
+      if (notification->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
+        m_s1ap_logger.info("SCTP Association Shutdown. Association: %d", sri.sinfo_assoc_id);
+        srsran::console("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
+        // The eNB UEs may belong to any shard, so the workers are drained before they are released
+        sync_workers();
+        m_s1ap->delete_enb_ctx(sri.sinfo_assoc_id);
       }
     } else {
-      m_s1ap_logger.debug("No data from select.");
+      // Received data
+      pdu->N_bytes = rd_sz;
+      m_s1ap_logger.info("Received S1AP msg. Size: %d", pdu->N_bytes);
+      if (m_workers.empty()) {
+        m_s1ap->handle_s1ap_rx_pdu(pdu, &sri);
+      } else {
+        dispatch_s1ap_rx_pdu(pdu, sri);
+      }
+    }
+  }
+}
+
+void mme::dispatch_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, const struct sctp_sndrcvinfo& sri)
+{
+  std::shared_ptr<s1ap_rx_msg_t> msg = std::make_shared<s1ap_rx_msg_t>();
+  msg->sri                           = sri;
+  if (!m_s1ap->unpack_s1ap_rx_pdu(pdu, &msg->pdu)) {
+    return;
+  }
+
+  // Non-UE-associated signalling, e.g. S1 Setup, is handled here, before any later UE message of the eNB
+  int shard = m_s1ap->get_rx_pdu_shard(msg->pdu, &msg->sri);
+  if (shard < 0) {
+    m_s1ap->handle_s1ap_rx_pdu(msg->pdu, &msg->sri);
+    return;
+  }
+  m_workers[shard]->push_task([this, msg]() { m_s1ap->handle_s1ap_rx_pdu(msg->pdu, &msg->sri); });
+}
+
+void mme::handle_s11_rx(int s11, srsran::byte_buffer_t* pdu)
+{
+  uint32_t sz = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
+
+  pdu->clear();
+  int rd_sz = recvfrom(s11, pdu->msg, sz, 0, NULL, NULL);
+  if (rd_sz < 0) {
+    m_s1ap_logger.error("Error reading from S11 socket: %s", strerror(errno));
+    return;
+  }
+  pdu->N_bytes = rd_sz;
+  if (m_workers.empty()) {
+    m_mme_gtpc->handle_s11_pdu(pdu);
+    return;
+  }
+
+  // S11 messages are addressed to the MME control TEID, which encodes the shard that created the session
+  std::shared_ptr<srsran::byte_buffer_t> msg(srsran::make_byte_buffer());
+  if (msg == nullptr) {
+    m_s1ap_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
+    return;
+  }
+  *msg           = *pdu;
+  uint32_t shard = m_mme_gtpc->get_rx_pdu_shard(*(srsran::gtpc_pdu*)msg->msg, m_workers.size());
+  m_workers[shard]->push_task([this, msg]() { m_mme_gtpc->handle_s11_pdu(msg.get()); });
+}
+
+void mme::sync_workers()
+{
+  // HSS answers are handled by the workers, and the workers may issue new HSS requests while they drain their
+  // queues, so both are drained until no HSS request is in flight
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_hss_mutex);
+      m_hss_cvar.wait(lock, [this]() { return m_nof_hss_requests == 0; });
+    }
+
+    std::vector<std::promise<void> > done(m_workers.size());
+    for (uint32_t i = 0; i < m_workers.size(); ++i) {
+      std::promise<void>* worker_done = &done[i];
+      m_workers[i]->push_task([worker_done]() { worker_done->set_value(); });
+    }
+    for (std::promise<void>& worker_done : done) {
+      worker_done.get_future().wait();
+    }
+
+    std::lock_guard<std::mutex> lock(m_hss_mutex);
+    if (m_nof_hss_requests == 0) {
+      return;
     }
   }
-  return;
 }
 
 /*
- * Timer Handling
+ * HSS Handling
  */
-bool mme::add_nas_timer(int timer_fd, nas_timer_type type, uint64_t imsi)
+void mme::defer_hss_request(srsran::move_task_t request, srsran::move_task_t response)
 {
-  m_s1ap_logger.debug("Adding NAS timer to MME. IMSI %" PRIu64 ", Type %d, Fd: %d", imsi, type, timer_fd);
+  if (m_hss_workers == nullptr) {
+    request();
+    response();
+    return;
+  }
+
+  // The response is handled by the shard that issued the request
+  struct hss_request_t {
+    srsran::move_task_t request;
+    srsran::move_task_t response;
+  };
+  std::shared_ptr<hss_request_t> req = std::make_shared<hss_request_t>();
+  req->request                       = std::move(request);
+  req->response                      = std::move(response);
+  srsran::task_worker* worker        = m_workers[s1ap::get_current_shard()].get();
+  {
+    std::lock_guard<std::mutex> lock(m_hss_mutex);
+    m_nof_hss_requests++;
+  }
+  m_hss_workers->push_task([this, req, worker]() {
+    req->request();
+    worker->push_task([req]() { req->response(); });
 
-  mme_timer_t timer;
-  timer.fd   = timer_fd;
-  timer.type = type;
-  timer.imsi = imsi;
+    // The request is no longer in flight once its answer is queued in the worker
+    std::lock_guard<std::mutex> lock(m_hss_mutex);
+    m_nof_hss_requests--;
+    m_hss_cvar.notify_all();
+  });
+}
 
-  timers.push_back(timer);
-  return true;
+void mme::defer_auth_info_request(uint64_t imsi, hss_auth_info_callback_t response)
+{
+  if (m_hss_workers == nullptr) {
+    hss_auth_info_t info = {};
+    info.imsi            = imsi;
+    m_hss->gen_auth_info_answers(&info, 1);
+    response(info);
+    return;
+  }
+
+  // Every request wakes up an HSS worker, which finds the queue empty if another worker batched the request already
+  {
+    std::lock_guard<std::mutex> lock(m_hss_mutex);
+    m_nof_hss_requests++;
+    m_pending_airs.push_back({imsi, std::move(response), m_workers[s1ap::get_current_shard()].get()});
+  }
+  m_hss_workers->push_task([this]() { handle_pending_airs(); });
 }
 
-bool mme::is_nas_timer_running(nas_timer_type type, uint64_t imsi)
+void mme::handle_pending_airs()
 {
-  std::vector<mme_timer_t>::iterator it;
-  for (it = timers.begin(); it != timers.end(); ++it) {
-    if (it->type == type && it->imsi == imsi) {
-      return true; // found timer
+  struct air_batch_t {
+    std::vector<air_request_t>   requests;
+    std::vector<hss_auth_info_t> infos;
+  };
+  std::shared_ptr<air_batch_t> batch = std::make_shared<air_batch_t>();
+  {
+    std::lock_guard<std::mutex> lock(m_hss_mutex);
+    while (not m_pending_airs.empty() and batch->requests.size() < MAX_AIR_BATCH) {
+      batch->requests.push_back(std::move(m_pending_airs.front()));
+      m_pending_airs.pop_front();
     }
   }
-  return false;
+  if (batch->requests.empty()) {
+    return;
+  }
+
+  batch->infos.resize(batch->requests.size());
+  for (uint32_t i = 0; i < batch->requests.size(); ++i) {
+    batch->infos[i]      = {};
+    batch->infos[i].imsi = batch->requests[i].imsi;
+  }
+  m_hss->gen_auth_info_answers(batch->infos.data(), batch->infos.size());
+
+  // The answers are handled by the shards that issued the requests
+  for (uint32_t i = 0; i < batch->requests.size(); ++i) {
+    batch->requests[i].worker->push_task([batch, i]() { batch->requests[i].response(batch->infos[i]); });
+  }
+  std::lock_guard<std::mutex> lock(m_hss_mutex);
+  m_nof_hss_requests -= batch->requests.size();
+  m_hss_cvar.notify_all();
 }
 
-bool mme::remove_nas_timer(nas_timer_type type, uint64_t imsi)
+/*
+ * Timer Handling
+ */
+void mme::handle_timer_tick()
 {
-  std::vector<mme_timer_t>::iterator it;
-  for (it = timers.begin(); it != timers.end(); ++it) {
-    if (it->type == type && it->imsi == imsi) {
-      break; // found timer to remove
+  uint64_t nof_ticks = 0;
+  if (read(m_tick_fd, &nof_ticks, sizeof(nof_ticks)) != sizeof(nof_ticks)) {
+    return;
+  }
+
+  // Expiries are handled once the wheel has settled, so the handlers are free to add or remove NAS timers
+  std::vector<nas_timer_wheel::expiry_t> expired = m_nas_timers.step(nof_ticks);
+  for (const nas_timer_wheel::expiry_t& exp : expired) {
+    nas_timer_wheel::key_t key = exp.key;
+    m_s1ap_logger.info("NAS timer expired. IMSI %" PRIu64 ", Type %d", key.first, key.second);
+    if (m_workers.empty()) {
+      m_s1ap->expire_nas_timer(key.second, key.first);
+    } else {
+      m_workers[exp.shard]->push_task([this, key]() {
+        // The shard may have started the timer again before this expiry got to it
+        if (is_nas_timer_running(key.second, key.first)) {
+          return;
+        }
+        m_s1ap->expire_nas_timer(key.second, key.first);
+      });
     }
   }
-  if (it == timers.end()) {
+}
+
+void mme::arm_timer_tick(bool arm)
+{
+  if (arm == m_tick_armed) {
+    return;
+  }
+  struct itimerspec t_value = {};
+  if (arm) {
+    t_value.it_value.tv_nsec    = nas_timer_wheel::TICK_MS * 1000000;
+    t_value.it_interval.tv_nsec = nas_timer_wheel::TICK_MS * 1000000;
+  }
+  if (timerfd_settime(m_tick_fd, 0, &t_value, NULL) == -1) {
+    m_s1ap_logger.error("Could not %s NAS timer tick: %s", arm ? "arm" : "disarm", strerror(errno));
+    return;
+  }
+  m_tick_armed = arm;
+}
+
+bool mme::add_nas_timer(uint32_t duration_ms, nas_timer_type type, uint64_t imsi)
+{
+  m_s1ap_logger.debug("Adding NAS timer to MME. IMSI %" PRIu64 ", Type %d, Duration: %d ms", imsi, type, duration_ms);
+  m_nas_timers.start(duration_ms, type, imsi, s1ap::get_current_shard());
+  return true;
+}
+
+bool mme::is_nas_timer_running(nas_timer_type type, uint64_t imsi)
+{
+  return m_nas_timers.is_running(type, imsi);
+}
+
+bool mme::remove_nas_timer(nas_timer_type type, uint64_t imsi)
+{
+  if (not m_nas_timers.stop(type, imsi)) {
     m_s1ap_logger.warning("Could not find timer to remove. IMSI %" PRIu64 ", Type %d", imsi, type);
     return false;
   }
-
-  // removing timer
-  m_s1ap_logger.debug("Removing NAS timer from MME. IMSI %" PRIu64 ", Type %d, Fd: %d", imsi, type, it->fd);
-  FD_CLR(it->fd, &m_set);
-  close(it->fd);
-  timers.erase(it);
+  m_s1ap_logger.debug("Removing NAS timer from MME. IMSI %" PRIu64 ", Type %d", imsi, type);
   return true;
 }
 
@@ -21,17 +21,19 @@
 
 #include "srsepc/hdr/mme/s1ap.h"
 #include "srsepc/hdr/mme/s1ap_nas_transport.h"
+#include "srsran/asn1/liblte_utils.h"
 #include "srsran/common/liblte_security.h"
 #include "srsran/common/security.h"
 #include <cmath>
 #include <inttypes.h> // for printing uint64_t
+#include <memory>
 #include <netinet/sctp.h>
-#include <sys/timerfd.h>
 #include <time.h>
 
 namespace srsepc {
 
 nas::nas(const nas_init_t& args, const nas_if_t& itf) :
+  m_shard(s1ap::get_current_shard()),
   m_gtpc(itf.gtpc),
   m_s1ap(itf.s1ap),
   m_hss(itf.hss),
@@ -91,7 +93,7 @@ bool nas::handle_attach_request(uint32_t                enb_ue_s1ap_id,
   gtpc_interface_nas* gtpc = itf.gtpc;
 
   // Get NAS Attach Request and PDN connectivity request messages
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_attach_request_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &attach_req);
+  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_attach_request_msg(srsran::liblte_unpack_msg(nas_rx).get(), &attach_req);
   if (err != LIBLTE_SUCCESS) {
     nas_logger.error("Error unpacking NAS attach request. Error: %s", liblte_error_text[err]);
     return false;
@@ -208,14 +210,11 @@ bool nas::handle_imsi_attach_request_unknown_ue(uint32_t
                                                 const nas_init_t&                                     args,
                                                 const nas_if_t&                                       itf)
 {
-  nas*                         nas_ctx;
-  srsran::unique_byte_buffer_t nas_tx;
-  auto&                        nas_logger = srslog::fetch_basic_logger("NAS");
+  nas* nas_ctx;
 
   // Interfaces
   s1ap_interface_nas* s1ap = itf.s1ap;
   hss_interface_nas*  hss  = itf.hss;
-  gtpc_interface_nas* gtpc = itf.gtpc;
 
   // Get IMSI
   uint64_t imsi = 0;
@@ -264,40 +263,14 @@ bool nas::handle_imsi_attach_request_unknown_ue(uint32_t
   // Save attach request type
   nas_ctx->m_emm_ctx.attach_type = attach_req.eps_attach_type;
 
-  // Get Authentication Vectors from HSS
-  if (!hss->gen_auth_info_answer(nas_ctx->m_emm_ctx.imsi,
-                                 nas_ctx->m_sec_ctx.k_asme,
-                                 nas_ctx->m_sec_ctx.autn,
-                                 nas_ctx->m_sec_ctx.rand,
-                                 nas_ctx->m_sec_ctx.xres)) {
-    srsran::console("User not found. IMSI %015" PRIu64 "\n", nas_ctx->m_emm_ctx.imsi);
-    nas_logger.info("User not found. IMSI %015" PRIu64 "", nas_ctx->m_emm_ctx.imsi);
-    return false;
-  }
-
-  // Allocate eKSI for this authentication vector
-  // Here we assume a new security context thus a new eKSI
-  nas_ctx->m_sec_ctx.eksi = 0;
-
-  // Save the UE context
+  // Save the UE context. This is done before the HSS is queried, so the context is already reachable while the
+  // authentication vectors are being generated.
   s1ap->add_nas_ctx_to_imsi_map(nas_ctx);
   s1ap->add_nas_ctx_to_mme_ue_s1ap_id_map(nas_ctx);
   s1ap->add_ue_to_enb_set(enb_sri->sinfo_assoc_id, nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
 
-  // Pack NAS Authentication Request in Downlink NAS Transport msg
-  nas_tx = srsran::make_byte_buffer();
-  if (nas_tx == nullptr) {
-    nas_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
-    return false;
-  }
-  nas_ctx->pack_authentication_request(nas_tx.get());
-
-  // Send reply to eNB
-  s1ap->send_downlink_nas_transport(
-      nas_ctx->m_ecm_ctx.enb_ue_s1ap_id, nas_ctx->m_ecm_ctx.mme_ue_s1ap_id, nas_tx.get(), nas_ctx->m_ecm_ctx.enb_sri);
-
-  nas_logger.info("Downlink NAS: Sending Authentication Request");
-  srsran::console("Downlink NAS: Sending Authentication Request\n");
+  // Get Authentication Vectors from HSS. The Authentication Request is sent once the answer is back.
+  nas_ctx->request_auth_info(AUTH_INFO_IMSI_ATTACH);
   return true;
 }
 
@@ -546,26 +519,8 @@ bool nas::handle_guti_attach_request_known_ue(nas*
     srsran::console("GUTI Attach request NAS integrity failed.\n");
     srsran::console("RE-starting authentication procedure.\n");
 
-    // Get Authentication Vectors from HSS
-    if (!hss->gen_auth_info_answer(emm_ctx->imsi, sec_ctx->k_asme, sec_ctx->autn, sec_ctx->rand, sec_ctx->xres)) {
-      srsran::console("User not found. IMSI %015" PRIu64 "\n", emm_ctx->imsi);
-      nas_logger.info("User not found. IMSI %015" PRIu64 "", emm_ctx->imsi);
-      return false;
-    }
-
-    // Restarting security context. Reseting eKSI to 0.
-    sec_ctx->eksi = 0;
-    nas_tx        = srsran::make_byte_buffer();
-    if (nas_tx == nullptr) {
-      nas_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
-      return false;
-    }
-    nas_ctx->pack_authentication_request(nas_tx.get());
-
-    // Send reply to eNB
-    s1ap->send_downlink_nas_transport(ecm_ctx->enb_ue_s1ap_id, ecm_ctx->mme_ue_s1ap_id, nas_tx.get(), *enb_sri);
-    nas_logger.info("Downlink NAS: Sent Authentication Request");
-    srsran::console("Downlink NAS: Sent Authentication Request\n");
+    // Get Authentication Vectors from HSS. The Authentication Request is sent once the answer is back.
+    nas_ctx->request_auth_info(AUTH_INFO_REAUTH);
     return true;
   }
 }
@@ -594,7 +549,7 @@ bool nas::handle_service_request(uint32_t                m_tmsi,
   gtpc_interface_nas* gtpc = itf.gtpc;
   mme_interface_nas*  mme  = itf.mme;
 
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_service_request_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &service_req);
+  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_service_request_msg(srsran::liblte_unpack_msg(nas_rx).get(), &service_req);
   if (err != LIBLTE_SUCCESS) {
     nas_logger.error("Could not unpack service request");
     return false;
@@ -751,7 +706,7 @@ bool nas::handle_detach_request(uint32_t                m_tmsi,
   hss_interface_nas*  hss  = itf.hss;
   gtpc_interface_nas* gtpc = itf.gtpc;
 
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_detach_request_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &detach_req);
+  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_detach_request_msg(srsran::liblte_unpack_msg(nas_rx).get(), &detach_req);
   if (err != LIBLTE_SUCCESS) {
     nas_logger.error("Could not unpack detach request");
     return false;
@@ -788,7 +743,7 @@ bool nas::handle_detach_request(uint32_t                m_tmsi,
     err                                               = liblte_mme_pack_detach_accept_msg(&detach_accept,
                                             LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS,
                                             sec_ctx->dl_nas_count,
-                                            (LIBLTE_BYTE_MSG_STRUCT*)nas_tx.get());
+                                            srsran::liblte_pack_msg(nas_tx.get()).get());
     if (err != LIBLTE_SUCCESS) {
       nas_logger.error("Error packing Detach Accept\n");
     }
@@ -870,7 +825,7 @@ bool nas::handle_attach_request(srsran::byte_buffer_t* nas_rx)
   LIBLTE_MME_PDN_CONNECTIVITY_REQUEST_MSG_STRUCT pdn_con_req = {};
 
   // Get NAS Attach Request and PDN connectivity request messages
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_attach_request_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &attach_req);
+  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_attach_request_msg(srsran::liblte_unpack_msg(nas_rx).get(), &attach_req);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error unpacking NAS attach request. Error: %s", liblte_error_text[err]);
     return false;
@@ -938,40 +893,114 @@ bool nas::handle_attach_request(srsran::byte_buffer_t* nas_rx)
     // Save attach request type
     m_emm_ctx.attach_type = attach_req.eps_attach_type;
 
-    // Get Authentication Vectors from HSS
-    if (!m_hss->gen_auth_info_answer(
-            m_emm_ctx.imsi, m_sec_ctx.k_asme, m_sec_ctx.autn, m_sec_ctx.rand, m_sec_ctx.xres)) {
+    // Get Authentication Vectors from HSS. The UE context is saved and the Authentication Request is sent once the
+    // answer is back.
+    request_auth_info(AUTH_INFO_IDENTITY);
+    return true;
+  } else {
+    m_logger.error("Attach request from known UE");
+  }
+  return true;
+}
+
+/*
+ * HSS requests
+ */
+void nas::request_auth_info(auth_info_proc_t proc, const uint8_t* auts)
+{
+  // The answer is applied to the context with the MME-UE-S1AP-Id of the request. Ids are not reused, so the answer
+  // is dropped if the context was released or replaced, e.g. by a retransmitted attach, while the HSS was busy.
+  s1ap_interface_nas* s1ap           = m_s1ap;
+  uint32_t            mme_ue_s1ap_id = m_ecm_ctx.mme_ue_s1ap_id;
+  auto                handle_answer  = [s1ap, mme_ue_s1ap_id, proc](const auth_info_answer_t& answer) {
+    nas* nas_ctx = s1ap->find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id);
+    if (nas_ctx == nullptr || nas_ctx->m_emm_ctx.imsi != answer.info.imsi) {
+      srslog::fetch_basic_logger("NAS").info("Dropping HSS answer for released UE context. IMSI %015" PRIu64 "",
+                                             answer.info.imsi);
+      return;
+    }
+    nas_ctx->handle_auth_info_answer(proc, answer);
+  };
+
+  // Plain requests may be generated in one batch with those of other UEs
+  if (proc != AUTH_INFO_RESYNC) {
+    m_mme->defer_auth_info_request(m_emm_ctx.imsi, [handle_answer](const hss_auth_info_t& info) {
+      auth_info_answer_t answer = {};
+      answer.info               = info;
+      handle_answer(answer);
+    });
+    return;
+  }
+
+  std::shared_ptr<auth_info_answer_t> answer = std::make_shared<auth_info_answer_t>();
+  answer->info.imsi                          = m_emm_ctx.imsi;
+  answer->info.user_found                    = false;
+  answer->resync_failed                      = false;
+  memcpy(answer->auts, auts, sizeof(answer->auts));
+  hss_interface_nas* hss = m_hss;
+  m_mme->defer_hss_request(
+      [hss, answer]() {
+        if (!hss->resync_sqn(answer->info.imsi, answer->auts)) {
+          answer->resync_failed = true;
+          return;
+        }
+        hss->gen_auth_info_answers(&answer->info, 1);
+      },
+      [handle_answer, answer]() { handle_answer(*answer); });
+}
+
+void nas::handle_auth_info_answer(auth_info_proc_t proc, const auth_info_answer_t& answer)
+{
+  if (!answer.info.user_found) {
+    if (answer.resync_failed) {
+      srsran::console("Resynchronization failed. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
+      m_logger.info("Resynchronization failed. IMSI %015" PRIu64 "", m_emm_ctx.imsi);
+    } else {
       srsran::console("User not found. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
       m_logger.info("User not found. IMSI %015" PRIu64 "", m_emm_ctx.imsi);
-      return false;
     }
+    if (proc == AUTH_INFO_IMSI_ATTACH) {
+      m_s1ap->delete_ue_ctx(m_emm_ctx.imsi);
+    }
+    return;
+  }
+  memcpy(m_sec_ctx.k_asme, answer.info.k_asme, sizeof(m_sec_ctx.k_asme));
+  memcpy(m_sec_ctx.autn, answer.info.autn, sizeof(m_sec_ctx.autn));
+  memcpy(m_sec_ctx.rand, answer.info.rand, sizeof(m_sec_ctx.rand));
+  memcpy(m_sec_ctx.xres, answer.info.xres, sizeof(m_sec_ctx.xres));
 
-    // Allocate eKSI for this authentication vector
+  if (proc == AUTH_INFO_RESYNC) {
+    // Making sure eKSI is different from previous eKSI.
+    m_sec_ctx.eksi = (m_sec_ctx.eksi + 1) % 6;
+  } else {
     // Here we assume a new security context thus a new eKSI
     m_sec_ctx.eksi = 0;
+  }
 
-    // Save the UE context
+  if (proc == AUTH_INFO_IDENTITY) {
+    // Make sure UE context was not previously stored in IMSI map
+    if (m_s1ap->find_nas_ctx_from_imsi(m_emm_ctx.imsi) != nullptr) {
+      m_logger.warning("UE context already exists.");
+      m_s1ap->delete_ue_ctx(m_emm_ctx.imsi);
+    }
+    // Store UE context im IMSI map
     m_s1ap->add_nas_ctx_to_imsi_map(this);
+  }
 
-    // Pack NAS Authentication Request in Downlink NAS Transport msg
-    srsran::unique_byte_buffer_t nas_tx = srsran::make_byte_buffer();
-    if (nas_tx == nullptr) {
-      m_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
-      return false;
-    }
-    pack_authentication_request(nas_tx.get());
+  // Pack NAS Authentication Request in Downlink NAS Transport msg
+  srsran::unique_byte_buffer_t nas_tx = srsran::make_byte_buffer();
+  if (nas_tx == nullptr) {
+    m_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
+    return;
+  }
+  pack_authentication_request(nas_tx.get());
 
-    // Send reply to eNB
-    m_s1ap->send_downlink_nas_transport(
-        m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx.get(), m_ecm_ctx.enb_sri);
+  // Send reply to eNB
+  m_s1ap->send_downlink_nas_transport(
+      m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx.get(), m_ecm_ctx.enb_sri);
 
-    m_logger.info("Downlink NAS: Sending Authentication Request");
-    srsran::console("Downlink NAS: Sending Authentication Request\n");
-    return true;
-  } else {
-    m_logger.error("Attach request from known UE");
-  }
-  return true;
+  m_logger.info("Downlink NAS: Sent Authentication Request");
+  srsran::console("Downlink NAS: Sent Authentication Request\n");
 }
 
 bool nas::handle_authentication_response(srsran::byte_buffer_t* nas_rx)
@@ -980,7 +1009,8 @@ bool nas::handle_authentication_response(srsran::byte_buffer_t* nas_rx)
   bool                                          ue_valid  = true;
 
   // Get NAS authentication response
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_authentication_response_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &auth_resp);
+  LIBLTE_ERROR_ENUM err =
+      liblte_mme_unpack_authentication_response_msg(srsran::liblte_unpack_msg(nas_rx).get(), &auth_resp);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error unpacking NAS authentication response. Error: %s", liblte_error_text[err]);
     return false;
@@ -1034,7 +1064,8 @@ bool nas::handle_security_mode_complete(srsran::byte_buffer_t* nas_rx)
   LIBLTE_MME_SECURITY_MODE_COMPLETE_MSG_STRUCT sm_comp = {};
 
   // Get NAS security mode complete
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_security_mode_complete_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &sm_comp);
+  LIBLTE_ERROR_ENUM err =
+      liblte_mme_unpack_security_mode_complete_msg(srsran::liblte_unpack_msg(nas_rx).get(), &sm_comp);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error unpacking NAS authentication response. Error: %s", liblte_error_text[err]);
     return false;
@@ -1079,7 +1110,7 @@ bool nas::handle_attach_complete(srsran::byte_buffer_t* nas_rx)
 
   // Get NAS authentication response
   std::memset(&attach_comp, 0, sizeof(attach_comp));
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_attach_complete_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &attach_comp);
+  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_attach_complete_msg(srsran::liblte_unpack_msg(nas_rx).get(), &attach_comp);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error unpacking NAS authentication response. Error: %s", liblte_error_text[err]);
     return false;
@@ -1128,7 +1159,7 @@ bool nas::handle_esm_information_response(srsran::byte_buffer_t* nas_rx)
 
   // Get NAS authentication response
   LIBLTE_ERROR_ENUM err =
-      srsran_mme_unpack_esm_information_response_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &esm_info_resp);
+      srsran_mme_unpack_esm_information_response_msg(srsran::liblte_unpack_msg(nas_rx).get(), &esm_info_resp);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error unpacking NAS authentication response. Error: %s", liblte_error_text[err]);
     return false;
@@ -1158,10 +1189,9 @@ bool nas::handle_esm_information_response(srsran::byte_buffer_t* nas_rx)
 
 bool nas::handle_identity_response(srsran::byte_buffer_t* nas_rx)
 {
-  srsran::unique_byte_buffer_t      nas_tx;
   LIBLTE_MME_ID_RESPONSE_MSG_STRUCT id_resp;
 
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_identity_response_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &id_resp);
+  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_identity_response_msg(srsran::liblte_unpack_msg(nas_rx).get(), &id_resp);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error unpacking NAS identity response. Error: %s", liblte_error_text[err]);
     return false;
@@ -1178,39 +1208,9 @@ bool nas::handle_identity_response(srsran::byte_buffer_t* nas_rx)
   // Set UE's IMSI
   m_emm_ctx.imsi = imsi;
 
-  // Get Authentication Vectors from HSS
-  if (!m_hss->gen_auth_info_answer(imsi, m_sec_ctx.k_asme, m_sec_ctx.autn, m_sec_ctx.rand, m_sec_ctx.xres)) {
-    srsran::console("User not found. IMSI %015" PRIu64 "\n", imsi);
-    m_logger.info("User not found. IMSI %015" PRIu64 "", imsi);
-    return false;
-  }
-  // Identity reponse from unknown GUTI atach. Assigning new eKSI.
-  m_sec_ctx.eksi = 0;
-
-  // Make sure UE context was not previously stored in IMSI map
-  nas* nas_ctx = m_s1ap->find_nas_ctx_from_imsi(imsi);
-  if (nas_ctx != nullptr) {
-    m_logger.warning("UE context already exists.");
-    m_s1ap->delete_ue_ctx(imsi);
-  }
-
-  // Store UE context im IMSI map
-  m_s1ap->add_nas_ctx_to_imsi_map(this);
-
-  // Pack NAS Authentication Request in Downlink NAS Transport msg
-  nas_tx = srsran::make_byte_buffer();
-  if (nas_tx == nullptr) {
-    m_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
-    return false;
-  }
-  pack_authentication_request(nas_tx.get());
-
-  // Send reply to eNB
-  m_s1ap->send_downlink_nas_transport(
-      m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx.get(), m_ecm_ctx.enb_sri);
-
-  m_logger.info("Downlink NAS: Sent Authentication Request");
-  srsran::console("Downlink NAS: Sent Authentication Request\n");
+  // Get Authentication Vectors from HSS. The UE context is saved and the Authentication Request is sent once the
+  // answer is back.
+  request_auth_info(AUTH_INFO_IDENTITY);
   return true;
 }
 
@@ -1241,11 +1241,10 @@ bool nas::handle_authentication_failure(srsran::byte_buffer_t* nas_rx)
 {
   m_logger.info("Received Authentication Failure");
 
-  srsran::unique_byte_buffer_t                 nas_tx;
   LIBLTE_MME_AUTHENTICATION_FAILURE_MSG_STRUCT auth_fail;
   LIBLTE_ERROR_ENUM                            err;
 
-  err = liblte_mme_unpack_authentication_failure_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &auth_fail);
+  err = liblte_mme_unpack_authentication_failure_msg(srsran::liblte_unpack_msg(nas_rx).get(), &auth_fail);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error unpacking NAS authentication failure. Error: %s", liblte_error_text[err]);
     return false;
@@ -1267,36 +1266,9 @@ bool nas::handle_authentication_failure(srsran::byte_buffer_t* nas_rx)
         m_logger.error("Missing fail parameter");
         return false;
       }
-      if (!m_hss->resync_sqn(m_emm_ctx.imsi, auth_fail.auth_fail_param)) {
-        srsran::console("Resynchronization failed. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-        m_logger.info("Resynchronization failed. IMSI %015" PRIu64 "", m_emm_ctx.imsi);
-        return false;
-      }
-      // Get Authentication Vectors from HSS
-      if (!m_hss->gen_auth_info_answer(
-              m_emm_ctx.imsi, m_sec_ctx.k_asme, m_sec_ctx.autn, m_sec_ctx.rand, m_sec_ctx.xres)) {
-        srsran::console("User not found. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-        m_logger.info("User not found. IMSI %015" PRIu64 "", m_emm_ctx.imsi);
-        return false;
-      }
-
-      // Making sure eKSI is different from previous eKSI.
-      m_sec_ctx.eksi = (m_sec_ctx.eksi + 1) % 6;
-
-      // Pack NAS Authentication Request in Downlink NAS Transport msg
-      nas_tx = srsran::make_byte_buffer();
-      if (nas_tx == nullptr) {
-        m_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
-        return false;
-      }
-      pack_authentication_request(nas_tx.get());
-
-      // Send reply to eNB
-      m_s1ap->send_downlink_nas_transport(
-          m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx.get(), m_ecm_ctx.enb_sri);
-
-      m_logger.info("Downlink NAS: Sent Authentication Request");
-      srsran::console("Downlink NAS: Sent Authentication Request\n");
+      // Resynchronize the SQN and get new Authentication Vectors from HSS. The Authentication Request is sent once
+      // the answer is back.
+      request_auth_info(AUTH_INFO_RESYNC, auth_fail.auth_fail_param);
       // TODO Start T3460 Timer!
       break;
   }
@@ -1309,7 +1281,7 @@ bool nas::handle_detach_request(srsran::byte_buffer_t* nas_msg)
   m_logger.info("Detach request -- IMSI %015" PRIu64 "", m_emm_ctx.imsi);
   LIBLTE_MME_DETACH_REQUEST_MSG_STRUCT detach_req;
 
-  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_detach_request_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_msg, &detach_req);
+  LIBLTE_ERROR_ENUM err = liblte_mme_unpack_detach_request_msg(srsran::liblte_unpack_msg(nas_msg).get(), &detach_req);
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Could not unpack detach request");
     return false;
@@ -1341,7 +1313,8 @@ bool nas::pack_authentication_request(srsran::byte_buffer_t* nas_buffer)
   auth_req.nas_ksi.tsc_flag = LIBLTE_MME_TYPE_OF_SECURITY_CONTEXT_FLAG_NATIVE;
   auth_req.nas_ksi.nas_ksi  = m_sec_ctx.eksi;
 
-  LIBLTE_ERROR_ENUM err = liblte_mme_pack_authentication_request_msg(&auth_req, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+  LIBLTE_ERROR_ENUM err =
+      liblte_mme_pack_authentication_request_msg(&auth_req, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error packing Authentication Request");
     srsran::console("Error packing Authentication Request\n");
@@ -1355,7 +1328,8 @@ bool nas::pack_authentication_reject(srsran::byte_buffer_t* nas_buffer)
   m_logger.info("Packing Authentication Reject");
 
   LIBLTE_MME_AUTHENTICATION_REJECT_MSG_STRUCT auth_rej;
-  LIBLTE_ERROR_ENUM err = liblte_mme_pack_authentication_reject_msg(&auth_rej, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+  LIBLTE_ERROR_ENUM err =
+      liblte_mme_pack_authentication_reject_msg(&auth_rej, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error packing Authentication Reject");
     srsran::console("Error packing Authentication Reject\n");
@@ -1400,7 +1374,7 @@ bool nas::pack_security_mode_command(srsran::byte_buffer_t* nas_buffer)
 
   uint8_t           sec_hdr_type = 3;
   LIBLTE_ERROR_ENUM err          = liblte_mme_pack_security_mode_command_msg(
-      &sm_cmd, sec_hdr_type, m_sec_ctx.dl_nas_count, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+      &sm_cmd, sec_hdr_type, m_sec_ctx.dl_nas_count, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     srsran::console("Error packing Authentication Request\n");
     return false;
@@ -1438,7 +1412,7 @@ bool nas::pack_esm_information_request(srsran::byte_buffer_t* nas_buffer)
 
   m_sec_ctx.dl_nas_count++;
   LIBLTE_ERROR_ENUM err = srsran_mme_pack_esm_information_request_msg(
-      &esm_info_req, sec_hdr_type, m_sec_ctx.dl_nas_count, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+      &esm_info_req, sec_hdr_type, m_sec_ctx.dl_nas_count, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error packing ESM information request");
     srsran::console("Error packing ESM information request\n");
@@ -1574,7 +1548,7 @@ bool nas::pack_attach_accept(srsran::byte_buffer_t* nas_buffer)
   liblte_mme_pack_activate_default_eps_bearer_context_request_msg(&act_def_eps_bearer_context_req,
                                                                   &attach_accept.esm_msg);
   liblte_mme_pack_attach_accept_msg(
-      &attach_accept, sec_hdr_type, m_sec_ctx.dl_nas_count, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+      &attach_accept, sec_hdr_type, m_sec_ctx.dl_nas_count, srsran::liblte_pack_msg(nas_buffer).get());
 
   // Encrypt NAS message
   cipher_encrypt(nas_buffer);
@@ -1595,7 +1569,7 @@ bool nas::pack_identity_request(srsran::byte_buffer_t* nas_buffer)
 
   LIBLTE_MME_ID_REQUEST_MSG_STRUCT id_req;
   id_req.id_type        = LIBLTE_MME_EPS_MOBILE_ID_TYPE_IMSI;
-  LIBLTE_ERROR_ENUM err = liblte_mme_pack_identity_request_msg(&id_req, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+  LIBLTE_ERROR_ENUM err = liblte_mme_pack_identity_request_msg(&id_req, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error packing Identity Request");
     srsran::console("Error packing Identity Request\n");
@@ -1638,7 +1612,7 @@ bool nas::pack_emm_information(srsran::byte_buffer_t* nas_buffer)
   uint8_t sec_hdr_type = LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY_AND_CIPHERED;
   m_sec_ctx.dl_nas_count++;
   LIBLTE_ERROR_ENUM err = liblte_mme_pack_emm_information_msg(
-      &emm_info, sec_hdr_type, m_sec_ctx.dl_nas_count, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+      &emm_info, sec_hdr_type, m_sec_ctx.dl_nas_count, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error packing EMM Information");
     srsran::console("Error packing EMM Information\n");
@@ -1668,7 +1642,7 @@ bool nas::pack_service_reject(srsran::byte_buffer_t* nas_buffer, uint8_t emm_cau
   service_rej.emm_cause     = emm_cause;
 
   LIBLTE_ERROR_ENUM err = liblte_mme_pack_service_reject_msg(
-      &service_rej, LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS, 0, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+      &service_rej, LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS, 0, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error packing Service Reject");
     srsran::console("Error packing Service Reject\n");
@@ -1690,7 +1664,7 @@ bool nas::pack_tracking_area_update_reject(srsran::byte_buffer_t* nas_buffer, ui
   }
 
   LIBLTE_ERROR_ENUM err = liblte_mme_pack_tracking_area_update_reject_msg(
-      &tau_rej, LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS, 0, (LIBLTE_BYTE_MSG_STRUCT*)nas_buffer);
+      &tau_rej, LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS, 0, srsran::liblte_pack_msg(nas_buffer).get());
   if (err != LIBLTE_SUCCESS) {
     m_logger.error("Error packing Tracking Area Update Reject");
     srsran::console("Error packing Tracking Area Update Reject\n");
@@ -1881,7 +1855,7 @@ void nas::integrity_generate(srsran::byte_buffer_t* pdu, uint8_t* mac)
 
 void nas::cipher_decrypt(srsran::byte_buffer_t* pdu)
 {
-  srsran::byte_buffer_t tmp_pdu;
+  srsran::byte_buffer_t tmp_pdu(pdu->N_bytes);
   switch (m_sec_ctx.cipher_algo) {
     case srsran::CIPHERING_ALGORITHM_ID_EEA0:
       break;
@@ -1926,7 +1900,7 @@ void nas::cipher_decrypt(srsran::byte_buffer_t* pdu)
 
 void nas::cipher_encrypt(srsran::byte_buffer_t* pdu)
 {
-  srsran::byte_buffer_t pdu_tmp;
+  srsran::byte_buffer_t pdu_tmp(pdu->N_bytes);
   switch (m_sec_ctx.cipher_algo) {
     case srsran::CIPHERING_ALGORITHM_ID_EEA0:
       break;
@@ -2011,24 +1985,7 @@ bool nas::start_t3413()
     return false;
   }
 
-  int fdt = timerfd_create(CLOCK_MONOTONIC, 0);
-  if (fdt < 0) {
-    m_logger.error("Error creating timer. %s", strerror(errno));
-    return false;
-  }
-  struct itimerspec t_value;
-  t_value.it_value.tv_sec     = m_t3413;
-  t_value.it_value.tv_nsec    = 0;
-  t_value.it_interval.tv_sec  = 0;
-  t_value.it_interval.tv_nsec = 0;
-
-  if (timerfd_settime(fdt, 0, &t_value, NULL) == -1) {
-    m_logger.error("Could not set timer");
-    close(fdt);
-    return false;
-  }
-
-  m_mme->add_nas_timer(fdt, T_3413, m_emm_ctx.imsi); // TODO timers without IMSI?
+  m_mme->add_nas_timer(m_t3413 * 1000, T_3413, m_emm_ctx.imsi); // TODO timers without IMSI?
   return true;
 }
 
@@ -0,0 +1,105 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsepc/hdr/mme/nas_timer_wheel.h"
+#include <algorithm>
+
+namespace srsepc {
+
+void nas_timer_wheel::start(uint32_t duration_ms, enum nas_timer_type type, uint64_t imsi, uint32_t shard)
+{
+  key_t                       key(imsi, type);
+  std::lock_guard<std::mutex> lock(mutex);
+  bool                        was_empty = nas_timers.empty();
+  nas_timer_t&                nas_timer = nas_timers[key];
+  if (not nas_timer.timer.is_valid()) {
+    nas_timer.timer = timers.get_unique_timer();
+  }
+  nas_timer.shard = shard;
+
+  uint32_t nof_ticks = std::max((duration_ms + TICK_MS - 1) / TICK_MS, 1U);
+  nas_timer.timer.set(nof_ticks, [this, key](uint32_t tid) { expired_keys.push_back(key); });
+  nas_timer.timer.run();
+  if (was_empty) {
+    arm_tick(true);
+  }
+}
+
+bool nas_timer_wheel::is_running(enum nas_timer_type type, uint64_t imsi)
+{
+  // Timers are removed from the map as soon as they expire, so the map tells whether they run
+  std::lock_guard<std::mutex> lock(mutex);
+  return nas_timers.count(key_t(imsi, type)) > 0;
+}
+
+bool nas_timer_wheel::stop(enum nas_timer_type type, uint64_t imsi)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  auto                        it = nas_timers.find(key_t(imsi, type));
+  if (it == nas_timers.end()) {
+    return false;
+  }
+  nas_timers.erase(it);
+  if (nas_timers.empty()) {
+    arm_tick(false);
+  }
+  return true;
+}
+
+void nas_timer_wheel::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (nas_timers.empty()) {
+    return;
+  }
+  nas_timers.clear();
+  expired_keys.clear();
+  arm_tick(false);
+}
+
+std::vector<nas_timer_wheel::expiry_t> nas_timer_wheel::step(uint64_t nof_ticks)
+{
+  std::vector<expiry_t>       expired;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (nas_timers.empty()) {
+    return expired;
+  }
+
+  // Catch up with the ticks missed while the owner was busy
+  for (uint64_t i = 0; i < nof_ticks; ++i) {
+    timers.step_all();
+  }
+  for (const key_t& key : expired_keys) {
+    std::map<key_t, nas_timer_t>::iterator it = nas_timers.find(key);
+    if (it != nas_timers.end()) {
+      expired.push_back({key, it->second.shard});
+      nas_timers.erase(it);
+    }
+  }
+  expired_keys.clear();
+
+  if (nas_timers.empty()) {
+    arm_tick(false);
+  }
+  return expired;
+}
+
+} // namespace srsepc
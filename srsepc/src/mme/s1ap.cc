@@ -22,6 +22,7 @@
 #include "srsepc/hdr/mme/s1ap.h"
 #include "srsran/asn1/gtpc.h"
 #include "srsran/common/bcd_helpers.h"
+#include "srsran/common/int_helpers.h"
 #include "srsran/common/liblte_security.h"
 #include "srsran/common/network_utils.h"
 #include <cmath>
@@ -30,10 +31,11 @@
 
 namespace srsepc {
 
-s1ap*           s1ap::m_instance    = NULL;
-pthread_mutex_t s1ap_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
+s1ap*                 s1ap::m_instance      = NULL;
+pthread_mutex_t       s1ap_instance_mutex   = PTHREAD_MUTEX_INITIALIZER;
+thread_local uint32_t s1ap::m_current_shard = 0;
 
-s1ap::s1ap() : m_s1mme(-1), m_next_mme_ue_s1ap_id(1), m_mme_gtpc(NULL) {}
+s1ap::s1ap() : m_s1mme(-1), m_mme_gtpc(NULL) {}
 
 s1ap::~s1ap()
 {
@@ -65,10 +67,15 @@ int s1ap::init(const s1ap_args_t& s1ap_args)
   m_s1ap_args = s1ap_args;
   srsran::s1ap_mccmnc_to_plmn(s1ap_args.mcc, s1ap_args.mnc, &m_plmn);
 
+  // Each shard allocates identifiers from its own counter, see get_next_mme_ue_s1ap_id() and allocate_m_tmsi()
   std::random_device                      rd;
   std::mt19937                            generator(rd());
-  std::uniform_int_distribution<uint32_t> distr(0, std::numeric_limits<uint32_t>::max());
-  m_next_m_tmsi = distr(generator);
+  std::uniform_int_distribution<uint32_t> distr(0, UINT32_MAX / m_nof_shards - 1);
+  m_next_mme_ue_s1ap_id.assign(m_nof_shards, 1);
+  m_next_m_tmsi.resize(m_nof_shards);
+  for (uint32_t& next_m_tmsi : m_next_m_tmsi) {
+    next_m_tmsi = distr(generator);
+  }
 
   // Get pointer to the HSS
   m_hss = hss::get_instance();
@@ -89,7 +96,7 @@ int s1ap::init(const s1ap_args_t& s1ap_args)
   m_mme_gtpc = mme_gtpc::get_instance();
 
   // Initialize S1-MME
-  m_s1mme = enb_listen();
+  m_s1mme = (m_s1mme_transport != nullptr) ? m_s1mme_transport->get_fd() : enb_listen();
   if (m_s1mme == SRSRAN_ERROR) {
     return SRSRAN_ERROR;
   }
@@ -105,7 +112,7 @@ int s1ap::init(const s1ap_args_t& s1ap_args)
 
 void s1ap::stop()
 {
-  if (m_s1mme != -1) {
+  if (m_s1mme != -1 && m_s1mme_transport == nullptr) {
     close(m_s1mme);
   }
   std::map<uint16_t, enb_ctx_t*>::iterator enb_it = m_active_enbs.begin();
@@ -116,12 +123,12 @@ void s1ap::stop()
     m_active_enbs.erase(enb_it++);
   }
 
-  std::map<uint64_t, nas*>::iterator ue_it = m_imsi_to_nas_ctx.begin();
+  std::unordered_map<uint64_t, nas*>::iterator ue_it = m_imsi_to_nas_ctx.begin();
   while (ue_it != m_imsi_to_nas_ctx.end()) {
     m_logger.info("Deleting UE EMM context. IMSI: %015" PRIu64 "", ue_it->first);
     srsran::console("Deleting UE EMM context. IMSI: %015" PRIu64 "\n", ue_it->first);
     delete ue_it->second;
-    m_imsi_to_nas_ctx.erase(ue_it++);
+    ue_it = m_imsi_to_nas_ctx.erase(ue_it);
   }
 
   // Cleanup message handlers
@@ -141,9 +148,20 @@ int s1ap::get_s1_mme()
   return m_s1mme;
 }
 
+void s1ap::set_nof_shards(uint32_t nof_shards)
+{
+  m_nof_shards = std::max(nof_shards, 1U);
+}
+
 uint32_t s1ap::get_next_mme_ue_s1ap_id()
 {
-  return m_next_mme_ue_s1ap_id++;
+  uint32_t& next           = m_next_mme_ue_s1ap_id[m_current_shard];
+  uint32_t  mme_ue_s1ap_id = next * m_nof_shards + m_current_shard;
+  next                     = (next + 1) % (UINT32_MAX / m_nof_shards);
+  if (next == 0) {
+    next = 1; // MME UE S1AP Id 0 flags a released ECM context
+  }
+  return mme_ue_s1ap_id;
 }
 
 int s1ap::enb_listen()
@@ -215,7 +233,9 @@ bool s1ap::s1ap_tx_pdu(const asn1::s1ap::s1ap_pdu_c& pdu, struct sctp_sndrcvinfo
   }
   buf->N_bytes = bref.distance_bytes();
 
-  ssize_t n_sent = sctp_send(m_s1mme, buf->msg, buf->N_bytes, enb_sri, MSG_NOSIGNAL);
+  ssize_t n_sent = (m_s1mme_transport != nullptr)
+                       ? m_s1mme_transport->send_msg(buf->msg, buf->N_bytes, enb_sri)
+                       : sctp_send(m_s1mme, buf->msg, buf->N_bytes, enb_sri, MSG_NOSIGNAL);
   if (n_sent == -1) {
     srsran::console("Failed to send S1AP PDU. Error: %s\n", strerror(errno));
     m_logger.error("Failed to send S1AP PDU. Error: %s ", strerror(errno));
@@ -223,6 +243,7 @@ bool s1ap::s1ap_tx_pdu(const asn1::s1ap::s1ap_pdu_c& pdu, struct sctp_sndrcvinfo
   }
 
   if (m_pcap_enable) {
+    std::lock_guard<std::mutex> lock(m_pcap_mutex);
     m_pcap.write_s1ap(buf->msg, buf->N_bytes);
   }
 
@@ -230,20 +251,32 @@ bool s1ap::s1ap_tx_pdu(const asn1::s1ap::s1ap_pdu_c& pdu, struct sctp_sndrcvinfo
 }
 
 void s1ap::handle_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, struct sctp_sndrcvinfo* enb_sri)
+{
+  s1ap_pdu_t rx_pdu;
+  if (unpack_s1ap_rx_pdu(pdu, &rx_pdu)) {
+    handle_s1ap_rx_pdu(rx_pdu, enb_sri);
+  }
+}
+
+bool s1ap::unpack_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, s1ap_pdu_t* rx_pdu)
 {
   // Save PCAP
   if (m_pcap_enable) {
+    std::lock_guard<std::mutex> lock(m_pcap_mutex);
     m_pcap.write_s1ap(pdu->msg, pdu->N_bytes);
   }
 
-  // Get PDU type
-  s1ap_pdu_t     rx_pdu;
   asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
-  if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
+  if (rx_pdu->unpack(bref) != asn1::SRSASN_SUCCESS) {
     m_logger.error("Failed to unpack received PDU");
-    return;
+    return false;
   }
+  return true;
+}
 
+void s1ap::handle_s1ap_rx_pdu(const s1ap_pdu_t& rx_pdu, struct sctp_sndrcvinfo* enb_sri)
+{
+  // Get PDU type
   switch (rx_pdu.type().value) {
     case s1ap_pdu_t::types_opts::init_msg:
       m_logger.info("Received Initiating PDU");
@@ -262,6 +295,117 @@ void s1ap::handle_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, struct sctp_sndrcvinfo
   }
 }
 
+/*
+ * Returns the shard that owns the UE a received PDU refers to, or -1 for non-UE-associated signalling.
+ * Messages carrying an MME-UE-S1AP-Id go to the shard that allocated it. Initial UE Messages go to the shard that
+ * owns the UE context, found by S-TMSI or by the identity in the NAS Attach Request, so that a UE context is only
+ * touched by one worker. New UEs are spread by their identity, and only UEs without a known identity are spread by
+ * eNB association and eNB-UE-S1AP-Id.
+ */
+int s1ap::get_rx_pdu_shard(const s1ap_pdu_t& rx_pdu, const struct sctp_sndrcvinfo* enb_sri)
+{
+  using init_msg_type_opts_t           = asn1::s1ap::s1ap_elem_procs_o::init_msg_c::types_opts;
+  using successful_outcome_type_opts_t = asn1::s1ap::s1ap_elem_procs_o::successful_outcome_c::types_opts;
+
+  if (rx_pdu.type().value == s1ap_pdu_t::types_opts::init_msg) {
+    const asn1::s1ap::init_msg_s& msg = rx_pdu.init_msg();
+    switch (msg.value.type().value) {
+      case init_msg_type_opts_t::init_ue_msg: {
+        const asn1::s1ap::init_ue_msg_ies_container& init_ue = msg.value.init_ue_msg().protocol_ies;
+        uint64_t                                     imsi    = 0;
+        uint32_t                                     m_tmsi  = 0;
+        if (init_ue.s_tmsi_present) {
+          srsran::uint8_to_uint32(init_ue.s_tmsi.value.m_tmsi.data(), &m_tmsi);
+        } else if (!get_attach_request_identity(init_ue.nas_pdu.value, &imsi, &m_tmsi)) {
+          uint32_t enb_ue_s1ap_id = init_ue.enb_ue_s1ap_id.value.value;
+          return (enb_ue_s1ap_id + (uint32_t)enb_sri->sinfo_assoc_id * 2654435761U) % m_nof_shards;
+        }
+        int shard = find_ue_shard(imsi, m_tmsi);
+        if (shard >= 0) {
+          return shard;
+        }
+        return imsi != 0 ? imsi % m_nof_shards : m_tmsi % m_nof_shards;
+      }
+      case init_msg_type_opts_t::ul_nas_transport:
+        return msg.value.ul_nas_transport().protocol_ies.mme_ue_s1ap_id.value.value % m_nof_shards;
+      case init_msg_type_opts_t::ue_context_release_request:
+        return msg.value.ue_context_release_request().protocol_ies.mme_ue_s1ap_id.value.value % m_nof_shards;
+      default:
+        return -1;
+    }
+  }
+  if (rx_pdu.type().value == s1ap_pdu_t::types_opts::successful_outcome) {
+    const asn1::s1ap::successful_outcome_s& msg = rx_pdu.successful_outcome();
+    switch (msg.value.type().value) {
+      case successful_outcome_type_opts_t::init_context_setup_resp:
+        return msg.value.init_context_setup_resp().protocol_ies.mme_ue_s1ap_id.value.value % m_nof_shards;
+      case successful_outcome_type_opts_t::ue_context_release_complete:
+        return msg.value.ue_context_release_complete().protocol_ies.mme_ue_s1ap_id.value.value % m_nof_shards;
+      default:
+        return -1;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Gets the IMSI or the M-TMSI of the GUTI identifying the UE in a NAS Attach Request.
+ * Returns false if the NAS PDU is not an Attach Request with one of these identities.
+ */
+bool s1ap::get_attach_request_identity(const asn1::unbounded_octstring<true>& nas_pdu, uint64_t* imsi, uint32_t* m_tmsi)
+{
+  if (nas_pdu.size() > LIBLTE_MAX_MSG_SIZE_BYTES) {
+    return false;
+  }
+  LIBLTE_BYTE_MSG_STRUCT nas_msg;
+  memcpy(nas_msg.msg, nas_pdu.data(), nas_pdu.size());
+  nas_msg.N_bytes = nas_pdu.size();
+
+  uint8_t pd, msg_type;
+  liblte_mme_parse_msg_header(&nas_msg, &pd, &msg_type);
+  if (msg_type != LIBLTE_MME_MSG_TYPE_ATTACH_REQUEST) {
+    return false;
+  }
+  LIBLTE_MME_ATTACH_REQUEST_MSG_STRUCT attach_req = {};
+  if (liblte_mme_unpack_attach_request_msg(&nas_msg, &attach_req) != LIBLTE_SUCCESS) {
+    return false;
+  }
+  if (attach_req.eps_mobile_id.type_of_id == LIBLTE_MME_EPS_MOBILE_ID_TYPE_IMSI) {
+    *imsi = 0;
+    for (int i = 0; i <= 14; i++) {
+      *imsi += attach_req.eps_mobile_id.imsi[i] * std::pow(10, 14 - i);
+    }
+    return true;
+  }
+  if (attach_req.eps_mobile_id.type_of_id == LIBLTE_MME_EPS_MOBILE_ID_TYPE_GUTI) {
+    *m_tmsi = attach_req.eps_mobile_id.guti.m_tmsi;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Returns the shard that owns the UE context of the given IMSI, or of the IMSI the M-TMSI was allocated to if the
+ * IMSI is 0. Returns -1 if there is no such UE context.
+ */
+int s1ap::find_ue_shard(uint64_t imsi, uint32_t m_tmsi)
+{
+  std::lock_guard<std::mutex> lock(m_ue_ctx_mutex);
+  if (imsi == 0) {
+    std::unordered_map<uint32_t, uint64_t>::iterator it = m_tmsi_to_imsi.find(m_tmsi);
+    if (it == m_tmsi_to_imsi.end()) {
+      return -1;
+    }
+    imsi = it->second;
+  }
+  // Contexts are removed from the map before being deleted, so the context can be read while the lock is held
+  std::unordered_map<uint64_t, nas*>::iterator it = m_imsi_to_nas_ctx.find(imsi);
+  if (it == m_imsi_to_nas_ctx.end()) {
+    return -1;
+  }
+  return it->second->m_shard;
+}
+
 void s1ap::handle_initiating_message(const asn1::s1ap::init_msg_s& msg, struct sctp_sndrcvinfo* enb_sri)
 {
   using init_msg_type_opts_t = asn1::s1ap::s1ap_elem_procs_o::init_msg_c::types_opts;
@@ -314,9 +458,10 @@ void s1ap::handle_successful_outcome(const asn1::s1ap::successful_outcome_s& msg
 void s1ap::add_new_enb_ctx(const enb_ctx_t& enb_ctx, const struct sctp_sndrcvinfo* enb_sri)
 {
   m_logger.info("Adding new eNB context. eNB ID %d", enb_ctx.enb_id);
-  std::set<uint32_t> ue_set;
-  enb_ctx_t*         enb_ptr = new enb_ctx_t;
-  *enb_ptr                   = enb_ctx;
+  std::set<uint32_t>          ue_set;
+  enb_ctx_t*                  enb_ptr = new enb_ctx_t;
+  *enb_ptr                            = enb_ctx;
+  std::lock_guard<std::mutex> lock(m_enb_mutex);
   m_active_enbs.insert(std::pair<uint16_t, enb_ctx_t*>(enb_ptr->enb_id, enb_ptr));
   m_sctp_to_enb_id.insert(std::pair<int32_t, uint16_t>(enb_sri->sinfo_assoc_id, enb_ptr->enb_id));
   m_enb_assoc_to_ue_ids.insert(std::pair<int32_t, std::set<uint32_t> >(enb_sri->sinfo_assoc_id, ue_set));
@@ -324,6 +469,7 @@ void s1ap::add_new_enb_ctx(const enb_ctx_t& enb_ctx, const struct sctp_sndrcvinf
 
 enb_ctx_t* s1ap::find_enb_ctx(uint16_t enb_id)
 {
+  std::lock_guard<std::mutex>              lock(m_enb_mutex);
   std::map<uint16_t, enb_ctx_t*>::iterator it = m_active_enbs.find(enb_id);
   if (it == m_active_enbs.end()) {
     return nullptr;
@@ -332,13 +478,31 @@ enb_ctx_t* s1ap::find_enb_ctx(uint16_t enb_id)
   }
 }
 
+std::vector<enb_ctx_t> s1ap::get_active_enbs()
+{
+  std::vector<enb_ctx_t>      enbs;
+  std::lock_guard<std::mutex> lock(m_enb_mutex);
+  enbs.reserve(m_active_enbs.size());
+  for (const std::pair<const uint16_t, enb_ctx_t*>& enb : m_active_enbs) {
+    enbs.push_back(*enb.second);
+  }
+  return enbs;
+}
+
 void s1ap::delete_enb_ctx(int32_t assoc_id)
 {
-  std::map<int32_t, uint16_t>::iterator it_assoc = m_sctp_to_enb_id.find(assoc_id);
-  uint16_t                              enb_id   = it_assoc->second;
+  // Delete connected UEs ctx
+  release_ues_ecm_ctx_in_enb(assoc_id);
 
+  std::lock_guard<std::mutex>           lock(m_enb_mutex);
+  std::map<int32_t, uint16_t>::iterator it_assoc = m_sctp_to_enb_id.find(assoc_id);
+  if (it_assoc == m_sctp_to_enb_id.end()) {
+    m_logger.error("Could not find eNB to delete. Association: %d", assoc_id);
+    return;
+  }
+  uint16_t                                 enb_id = it_assoc->second;
   std::map<uint16_t, enb_ctx_t*>::iterator it_ctx = m_active_enbs.find(enb_id);
-  if (it_ctx == m_active_enbs.end() || it_assoc == m_sctp_to_enb_id.end()) {
+  if (it_ctx == m_active_enbs.end()) {
     m_logger.error("Could not find eNB to delete. Association: %d", assoc_id);
     return;
   }
@@ -346,26 +510,26 @@ void s1ap::delete_enb_ctx(int32_t assoc_id)
   m_logger.info("Deleting eNB context. eNB Id: 0x%x", enb_id);
   srsran::console("Deleting eNB context. eNB Id: 0x%x\n", enb_id);
 
-  // Delete connected UEs ctx
-  release_ues_ecm_ctx_in_enb(assoc_id);
-
   // Delete eNB
   delete it_ctx->second;
   m_active_enbs.erase(it_ctx);
   m_sctp_to_enb_id.erase(it_assoc);
+  m_enb_assoc_to_ue_ids.erase(assoc_id);
   return;
 }
 
 // UE Context Management
 bool s1ap::add_nas_ctx_to_imsi_map(nas* nas_ctx)
 {
-  std::map<uint64_t, nas*>::iterator ctx_it = m_imsi_to_nas_ctx.find(nas_ctx->m_emm_ctx.imsi);
+  std::lock_guard<std::mutex>                  lock(m_ue_ctx_mutex);
+  std::unordered_map<uint64_t, nas*>::iterator ctx_it = m_imsi_to_nas_ctx.find(nas_ctx->m_emm_ctx.imsi);
   if (ctx_it != m_imsi_to_nas_ctx.end()) {
     m_logger.error("UE Context already exists. IMSI %015" PRIu64 "", nas_ctx->m_emm_ctx.imsi);
     return false;
   }
   if (nas_ctx->m_ecm_ctx.mme_ue_s1ap_id != 0) {
-    std::map<uint32_t, nas*>::iterator ctx_it2 = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
+    std::unordered_map<uint32_t, nas*>::iterator ctx_it2 =
+        m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
     if (ctx_it2 != m_mme_ue_s1ap_id_to_nas_ctx.end() && ctx_it2->second != nas_ctx) {
       m_logger.error("Context identified with IMSI does not match context identified by MME UE S1AP Id.");
       return false;
@@ -382,13 +546,16 @@ bool s1ap::add_nas_ctx_to_mme_ue_s1ap_id_map(nas* nas_ctx)
     m_logger.error("Could not add UE context to MME UE S1AP map. MME UE S1AP ID 0 is not valid.");
     return false;
   }
-  std::map<uint32_t, nas*>::iterator ctx_it = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
+  std::lock_guard<std::mutex>                  lock(m_ue_ctx_mutex);
+  std::unordered_map<uint32_t, nas*>::iterator ctx_it =
+      m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
   if (ctx_it != m_mme_ue_s1ap_id_to_nas_ctx.end()) {
     m_logger.error("UE Context already exists. MME UE S1AP Id %015" PRIu64 "", nas_ctx->m_emm_ctx.imsi);
     return false;
   }
   if (nas_ctx->m_emm_ctx.imsi != 0) {
-    std::map<uint32_t, nas*>::iterator ctx_it2 = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
+    std::unordered_map<uint32_t, nas*>::iterator ctx_it2 =
+        m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
     if (ctx_it2 != m_mme_ue_s1ap_id_to_nas_ctx.end() && ctx_it2->second != nas_ctx) {
       m_logger.error("Context identified with MME UE S1AP Id does not match context identified by IMSI.");
       return false;
@@ -401,6 +568,7 @@ bool s1ap::add_nas_ctx_to_mme_ue_s1ap_id_map(nas* nas_ctx)
 
 bool s1ap::add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id)
 {
+  std::lock_guard<std::mutex>                      lock(m_enb_mutex);
   std::map<int32_t, std::set<uint32_t> >::iterator ues_in_enb = m_enb_assoc_to_ue_ids.find(enb_assoc);
   if (ues_in_enb == m_enb_assoc_to_ue_ids.end()) {
     m_logger.error("Could not find eNB from eNB SCTP association %d", enb_assoc);
@@ -418,7 +586,8 @@ bool s1ap::add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id)
 
 nas* s1ap::find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id)
 {
-  std::map<uint32_t, nas*>::iterator it = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
+  std::lock_guard<std::mutex>                  lock(m_ue_ctx_mutex);
+  std::unordered_map<uint32_t, nas*>::iterator it = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
   if (it == m_mme_ue_s1ap_id_to_nas_ctx.end()) {
     return NULL;
   } else {
@@ -428,7 +597,8 @@ nas* s1ap::find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id)
 
 nas* s1ap::find_nas_ctx_from_imsi(uint64_t imsi)
 {
-  std::map<uint64_t, nas*>::iterator it = m_imsi_to_nas_ctx.find(imsi);
+  std::lock_guard<std::mutex>                  lock(m_ue_ctx_mutex);
+  std::unordered_map<uint64_t, nas*>::iterator it = m_imsi_to_nas_ctx.find(imsi);
   if (it == m_imsi_to_nas_ctx.end()) {
     return NULL;
   } else {
@@ -439,15 +609,24 @@ nas* s1ap::find_nas_ctx_from_imsi(uint64_t imsi)
 void s1ap::release_ues_ecm_ctx_in_enb(int32_t enb_assoc)
 {
   srsran::console("Releasing UEs context\n");
+  std::lock_guard<std::mutex>                      lock(m_enb_mutex);
   std::map<int32_t, std::set<uint32_t> >::iterator ues_in_enb = m_enb_assoc_to_ue_ids.find(enb_assoc);
-  std::set<uint32_t>::iterator                     ue_id      = ues_in_enb->second.begin();
+  if (ues_in_enb == m_enb_assoc_to_ue_ids.end()) {
+    m_logger.error("Could not find eNB from eNB SCTP association %d", enb_assoc);
+    return;
+  }
+  std::set<uint32_t>::iterator ue_id = ues_in_enb->second.begin();
   if (ue_id == ues_in_enb->second.end()) {
     srsran::console("No UEs to be released\n");
   } else {
     while (ue_id != ues_in_enb->second.end()) {
-      std::map<uint32_t, nas*>::iterator nas_ctx = m_mme_ue_s1ap_id_to_nas_ctx.find(*ue_id);
-      emm_ctx_t*                         emm_ctx = &nas_ctx->second->m_emm_ctx;
-      ecm_ctx_t*                         ecm_ctx = &nas_ctx->second->m_ecm_ctx;
+      nas* nas_ctx = find_nas_ctx_from_mme_ue_s1ap_id(*ue_id);
+      if (nas_ctx == NULL) {
+        ues_in_enb->second.erase(ue_id++);
+        continue;
+      }
+      emm_ctx_t* emm_ctx = &nas_ctx->m_emm_ctx;
+      ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
 
       m_logger.info(
           "Releasing UE context. IMSI: %015" PRIu64 ", UE-MME S1AP Id: %d", emm_ctx->imsi, ecm_ctx->mme_ue_s1ap_id);
@@ -474,21 +653,27 @@ bool s1ap::release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id)
   ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
 
   // Delete UE within eNB UE set
-  std::map<int32_t, uint16_t>::iterator it = m_sctp_to_enb_id.find(ecm_ctx->enb_sri.sinfo_assoc_id);
-  if (it == m_sctp_to_enb_id.end()) {
-    m_logger.error("Could not find eNB for UE release request.");
-    return false;
-  }
-  uint16_t                                         enb_id = it->second;
-  std::map<int32_t, std::set<uint32_t> >::iterator ue_set = m_enb_assoc_to_ue_ids.find(ecm_ctx->enb_sri.sinfo_assoc_id);
-  if (ue_set == m_enb_assoc_to_ue_ids.end()) {
-    m_logger.error("Could not find the eNB's UEs.");
-    return false;
+  {
+    std::lock_guard<std::mutex>           lock(m_enb_mutex);
+    std::map<int32_t, uint16_t>::iterator it = m_sctp_to_enb_id.find(ecm_ctx->enb_sri.sinfo_assoc_id);
+    if (it == m_sctp_to_enb_id.end()) {
+      m_logger.error("Could not find eNB for UE release request.");
+      return false;
+    }
+    std::map<int32_t, std::set<uint32_t> >::iterator ue_set =
+        m_enb_assoc_to_ue_ids.find(ecm_ctx->enb_sri.sinfo_assoc_id);
+    if (ue_set == m_enb_assoc_to_ue_ids.end()) {
+      m_logger.error("Could not find the eNB's UEs.");
+      return false;
+    }
+    ue_set->second.erase(mme_ue_s1ap_id);
   }
-  ue_set->second.erase(mme_ue_s1ap_id);
 
   // Release UE ECM context
-  m_mme_ue_s1ap_id_to_nas_ctx.erase(mme_ue_s1ap_id);
+  {
+    std::lock_guard<std::mutex> lock(m_ue_ctx_mutex);
+    m_mme_ue_s1ap_id_to_nas_ctx.erase(mme_ue_s1ap_id);
+  }
   ecm_ctx->state          = ECM_STATE_IDLE;
   ecm_ctx->mme_ue_s1ap_id = 0;
   ecm_ctx->enb_ue_s1ap_id = 0;
@@ -511,7 +696,10 @@ bool s1ap::delete_ue_ctx(uint64_t imsi)
   }
 
   // Delete UE context
-  m_imsi_to_nas_ctx.erase(imsi);
+  {
+    std::lock_guard<std::mutex> lock(m_ue_ctx_mutex);
+    m_imsi_to_nas_ctx.erase(imsi);
+  }
   delete nas_ctx;
   m_logger.info("Deleted UE Context.");
   return true;
@@ -520,21 +708,20 @@ bool s1ap::delete_ue_ctx(uint64_t imsi)
 // UE Bearer Managment
 void s1ap::activate_eps_bearer(uint64_t imsi, uint8_t ebi)
 {
-  std::map<uint64_t, nas*>::iterator ue_ctx_it = m_imsi_to_nas_ctx.find(imsi);
-  if (ue_ctx_it == m_imsi_to_nas_ctx.end()) {
+  nas* nas_ctx = find_nas_ctx_from_imsi(imsi);
+  if (nas_ctx == NULL) {
     m_logger.error("Could not activate EPS bearer: Could not find UE context");
     return;
   }
   // Make sure NAS is active
-  uint32_t                           mme_ue_s1ap_id = ue_ctx_it->second->m_ecm_ctx.mme_ue_s1ap_id;
-  std::map<uint32_t, nas*>::iterator it             = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
-  if (it == m_mme_ue_s1ap_id_to_nas_ctx.end()) {
+  uint32_t mme_ue_s1ap_id = nas_ctx->m_ecm_ctx.mme_ue_s1ap_id;
+  if (find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id) == NULL) {
     m_logger.error("Could not activate EPS bearer: ECM context seems to be missing");
     return;
   }
 
-  ecm_ctx_t* ecm_ctx = &ue_ctx_it->second->m_ecm_ctx;
-  esm_ctx_t* esm_ctx = &ue_ctx_it->second->m_esm_ctx[ebi];
+  ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
+  esm_ctx_t* esm_ctx = &nas_ctx->m_esm_ctx[ebi];
   if (esm_ctx->state != ERAB_CTX_SETUP) {
     m_logger.error(
         "Could not be activate EPS Bearer, bearer in wrong state: MME S1AP Id %d, EPS Bearer id %d, state %d",
@@ -557,9 +744,11 @@ void s1ap::activate_eps_bearer(uint64_t imsi, uint8_t ebi)
 
 uint32_t s1ap::allocate_m_tmsi(uint64_t imsi)
 {
-  uint32_t m_tmsi = m_next_m_tmsi;
-  m_next_m_tmsi   = (m_next_m_tmsi + 1) % UINT32_MAX;
+  uint32_t& next   = m_next_m_tmsi[m_current_shard];
+  uint32_t  m_tmsi = next * m_nof_shards + m_current_shard;
+  next             = (next + 1) % (UINT32_MAX / m_nof_shards);
 
+  std::lock_guard<std::mutex> lock(m_ue_ctx_mutex);
   m_tmsi_to_imsi.insert(std::pair<uint32_t, uint64_t>(m_tmsi, imsi));
   m_logger.debug("Allocated M-TMSI 0x%x to IMSI %015" PRIu64 ",", m_tmsi, imsi);
   return m_tmsi;
@@ -567,7 +756,8 @@ uint32_t s1ap::allocate_m_tmsi(uint64_t imsi)
 
 uint64_t s1ap::find_imsi_from_m_tmsi(uint32_t m_tmsi)
 {
-  std::map<uint32_t, uint64_t>::iterator it = m_tmsi_to_imsi.find(m_tmsi);
+  std::lock_guard<std::mutex>                      lock(m_ue_ctx_mutex);
+  std::unordered_map<uint32_t, uint64_t>::iterator it = m_tmsi_to_imsi.find(m_tmsi);
   if (it != m_tmsi_to_imsi.end()) {
     m_logger.debug("Found IMSI %015" PRIu64 " from M-TMSI 0x%x", it->second, m_tmsi);
     return it->second;
@@ -230,6 +230,10 @@ bool s1ap_ctx_mngmt_proc::handle_initial_context_setup_response(
     srsran::console("E-RAB Context -- eNB TEID 0x%x; eNB GTP-U Address %s\n", esm_ctx->enb_fteid.teid, enb_addr_str);
   }
 
+  // The eNB holds the UE context from now on, so it is released on detach even before the S-GW has answered the
+  // Modify Bearer Request
+  ecm_ctx->state = ECM_STATE_CONNECTED;
+
   if (emm_ctx->state == EMM_STATE_REGISTERED) {
     srsran::console("Initial Context Setup Response triggered from Service Request.\n");
     srsran::console("Sending Modify Bearer Request.\n");
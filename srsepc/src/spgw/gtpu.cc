@@ -23,6 +23,7 @@
 #include "srsepc/hdr/mme/mme_gtpc.h"
 #include "srsran/common/string_helpers.h"
 #include "srsran/common/network_utils.h"
+#include "srsran/common/rwlock_guard.h"
 #include "srsran/upper/gtpu.h"
 #include <algorithm>
 #include <arpa/inet.h>
@@ -46,11 +47,13 @@ namespace srsepc {
 
 spgw::gtpu::gtpu() : m_sgi_up(false), m_s1u_up(false)
 {
+  pthread_rwlock_init(&m_tunnel_rwlock, nullptr);
   return;
 }
 
 spgw::gtpu::~gtpu()
 {
+  pthread_rwlock_destroy(&m_tunnel_rwlock);
   return;
 }
 
@@ -76,6 +79,13 @@ int spgw::gtpu::init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc)
     return err;
   }
 
+  // Init data-plane workers, if configured
+  err = init_dp_workers(args);
+  if (err != SRSRAN_SUCCESS) {
+    srsran::console("Could not initialize the SPGW data-plane workers.\n");
+    return err;
+  }
+
   m_logger.info("SPGW GTP-U Initialized.");
   srsran::console("SPGW GTP-U Initialized.\n");
   return SRSRAN_SUCCESS;
@@ -83,13 +93,38 @@ int spgw::gtpu::init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc)
 
 void spgw::gtpu::stop()
 {
+  // Stop data-plane workers before closing their descriptors
+  for (auto& w : m_dp_workers) {
+    w->stop();
+    gtpu_dp_metrics_t m = w->get_metrics();
+    m_logger.info("DP worker stats: UL pkts=%" PRIu64 ", drops=%" PRIu64 ", unknown TEID=%" PRIu64 "; DL pkts=%" PRIu64
+                  ", drops=%" PRIu64 "; syscalls=%" PRIu64,
+                  m.ul_pkts,
+                  m.ul_drops,
+                  m.ul_unknown_teid,
+                  m.dl_pkts,
+                  m.dl_drops,
+                  m.nof_syscalls);
+  }
+  m_dp_workers.clear();
+
   // Clean up SGi interface
   if (m_sgi_up) {
-    close(m_sgi);
+    if (m_sgi_queues.empty()) {
+      close(m_sgi);
+    }
+    for (int fd : m_sgi_queues) {
+      close(fd);
+    }
   }
   // Clean up S1-U socket
   if (m_s1u_up) {
-    close(m_s1u);
+    if (m_s1u_socks.empty()) {
+      close(m_s1u);
+    }
+    for (int fd : m_s1u_socks) {
+      close(fd);
+    }
   }
 }
 
@@ -112,6 +147,10 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
 
   memset(&ifr, 0, sizeof(ifr));
   ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  if (args->nof_dp_workers > 0) {
+    // One queue per data-plane worker. The kernel spreads packets across queues by flow hash.
+    ifr.ifr_flags |= IFF_MULTI_QUEUE;
+  }
   strncpy(
       ifr.ifr_ifrn.ifrn_name, args->sgi_if_name.c_str(), std::min(args->sgi_if_name.length(), (size_t)(IFNAMSIZ - 1)));
   ifr.ifr_ifrn.ifrn_name[IFNAMSIZ - 1] = '\0';
@@ -122,6 +161,27 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
     return SRSRAN_ERROR_CANT_START;
   }
 
+  if (args->nof_dp_workers > 0) {
+    m_sgi_queues.push_back(m_sgi);
+    for (uint32_t i = 1; i < args->nof_dp_workers; ++i) {
+      int          queue     = open("/dev/net/tun", O_RDWR);
+      struct ifreq queue_ifr = ifr;
+      if (queue < 0 or ioctl(queue, TUNSETIFF, &queue_ifr) < 0) {
+        m_logger.error("Failed to open TUN queue %d: %s", i, strerror(errno));
+        if (queue >= 0) {
+          close(queue);
+        }
+        for (int fd : m_sgi_queues) {
+          close(fd);
+        }
+        m_sgi_queues.clear();
+        return SRSRAN_ERROR_CANT_START;
+      }
+      m_sgi_queues.push_back(queue);
+    }
+    m_logger.info("Opened %zd TUN queues", m_sgi_queues.size());
+  }
+
   // Bring up the interface
   sgi_sock = socket(AF_INET, SOCK_DGRAM, 0);
   if (ioctl(sgi_sock, SIOCGIFFLAGS, &ifr) < 0) {
@@ -175,6 +235,29 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
 
 int spgw::gtpu::init_s1u(spgw_args_t* args)
 {
+  if (args->nof_dp_workers > 0) {
+    // Open one S1-U socket per data-plane worker, all bound to the same address
+    m_s1u_addr.sin_family = AF_INET;
+    m_s1u_addr.sin_port   = htons(GTPU_RX_PORT);
+    if (inet_pton(m_s1u_addr.sin_family, args->gtpu_bind_addr.c_str(), &m_s1u_addr.sin_addr.s_addr) != 1) {
+      m_logger.error("Invalid gtpu_bind_addr: %s", args->gtpu_bind_addr.c_str());
+      srsran::console("Invalid gtpu_bind_addr: %s\n", args->gtpu_bind_addr.c_str());
+      return SRSRAN_ERROR_CANT_START;
+    }
+    int err  = gtpu_dp_open_s1u_sockets(m_s1u_addr, args->nof_dp_workers, m_s1u_socks);
+    m_s1u_up = not m_s1u_socks.empty();
+    if (err != SRSRAN_SUCCESS) {
+      return err;
+    }
+    m_s1u = m_s1u_socks[0];
+    m_logger.info("S1-U IP = %s, Port = %d, Sockets = %zd",
+                  inet_ntoa(m_s1u_addr.sin_addr),
+                  ntohs(m_s1u_addr.sin_port),
+                  m_s1u_socks.size());
+    m_logger.info("Initialized S1-U interface");
+    return SRSRAN_SUCCESS;
+  }
+
   // Open S1-U socket
   m_s1u = socket(AF_INET, SOCK_DGRAM, 0);
   if (m_s1u == -1) {
@@ -203,16 +286,32 @@ int spgw::gtpu::init_s1u(spgw_args_t* args)
   return SRSRAN_SUCCESS;
 }
 
+int spgw::gtpu::init_dp_workers(spgw_args_t* args)
+{
+  for (uint32_t i = 0; i < args->nof_dp_workers; ++i) {
+    std::unique_ptr<gtpu_dp_worker> w(new gtpu_dp_worker(i, this));
+    if (w->init(m_sgi_queues[i], m_s1u_socks[i], args->dp_batch_size) != SRSRAN_SUCCESS) {
+      m_logger.error("Failed to initialize data-plane worker %d", i);
+      return SRSRAN_ERROR_CANT_START;
+    }
+    if (not w->start_worker()) {
+      m_logger.error("Failed to start data-plane worker %d", i);
+      return SRSRAN_ERROR_CANT_START;
+    }
+    m_dp_workers.push_back(std::move(w));
+  }
+  if (not m_dp_workers.empty()) {
+    m_logger.info("Started %zd data-plane workers", m_dp_workers.size());
+    srsran::console("SPGW data-plane running on %zd workers.\n", m_dp_workers.size());
+  }
+  return SRSRAN_SUCCESS;
+}
+
 void spgw::gtpu::handle_sgi_pdu(srsran::unique_byte_buffer_t msg)
 {
-  bool usr_found = false;
-  bool ctr_found = false;
-
-  std::map<uint32_t, srsran::gtpc_f_teid_ie>::iterator gtpu_fteid_it;
-  std::map<in_addr_t, uint32_t>::iterator              gtpc_teid_it;
-  srsran::gtpc_f_teid_ie                               enb_fteid;
-  uint32_t                                             spgw_teid;
-  struct iphdr*                                        iph = (struct iphdr*)msg->msg;
+  srsran::gtpc_f_teid_ie enb_fteid;
+  uint32_t               spgw_teid;
+  struct iphdr*          iph = (struct iphdr*)msg->msg;
   m_logger.debug("Received SGi PDU. Bytes %d", msg->N_bytes);
 
   if (iph->version != 4) {
@@ -234,31 +333,62 @@ void spgw::gtpu::handle_sgi_pdu(srsran::unique_byte_buffer_t msg)
   m_logger.debug("SGi PDU -- IP dst addr %s", srsran::to_c_str(buffer));
 
   // Find user and control tunnel
-  gtpu_fteid_it = m_ip_to_usr_teid.find(iph->daddr);
-  if (gtpu_fteid_it != m_ip_to_usr_teid.end()) {
-    usr_found = true;
-    enb_fteid = gtpu_fteid_it->second;
+  switch (resolve_dl_tunnel(iph->daddr, &enb_fteid, &spgw_teid)) {
+    case dl_action::forward:
+      send_s1u_pdu(enb_fteid, msg.get());
+      break;
+    case dl_action::page:
+      handle_dl_paging(spgw_teid, std::move(msg));
+      break;
+    default:
+      break;
   }
-  gtpc_teid_it = m_ip_to_ctr_teid.find(iph->daddr);
-  if (gtpc_teid_it != m_ip_to_ctr_teid.end()) {
-    ctr_found = true;
-    spgw_teid = gtpc_teid_it->second;
+}
+
+bool spgw::gtpu::resolve_ul_tunnel(uint32_t spgw_usr_teid, in_addr_t* ue_ipv4)
+{
+  srsran::rwlock_read_guard lock(m_tunnel_rwlock);
+  const spgw_ul_tunnel_t*   ul = m_ul_tunnels.find_value(spgw_usr_teid);
+  if (ul == nullptr) {
+    return false;
   }
+  *ue_ipv4 = ul->ue_ipv4;
+  return true;
+}
+
+gtpu_dp_interface::dl_action
+spgw::gtpu::resolve_dl_tunnel(in_addr_t ue_ipv4, srsran::gtp_fteid_t* enb_fteid, uint32_t* spgw_ctr_teid)
+{
+  srsran::rwlock_read_guard lock(m_tunnel_rwlock);
+
+  const spgw_dl_tunnel_t* dl        = m_dl_tunnels.find_value(ue_ipv4);
+  bool                    usr_found = dl != nullptr and dl->usr_active;
+  bool                    ctr_found = dl != nullptr and dl->ctr_active;
 
-  // Handle SGi packet
   if (usr_found == false && ctr_found == false) {
     m_logger.debug("Packet for unknown UE.");
-  } else if (usr_found == false && ctr_found == true) {
+    return dl_action::drop;
+  }
+  if (usr_found == false && ctr_found == true) {
     m_logger.debug("Packet for attached UE that is not ECM connected.");
-    m_logger.debug("Triggering Donwlink Notification Requset.");
-    m_gtpc->send_downlink_data_notification(spgw_teid);
-    m_gtpc->queue_downlink_packet(spgw_teid, std::move(msg));
-    return;
-  } else if (usr_found == true && ctr_found == false) {
+    *spgw_ctr_teid = dl->spgw_ctr_teid;
+    return dl_action::page;
+  }
+  if (usr_found == true && ctr_found == false) {
     m_logger.error("User plane tunnel found without a control plane tunnel present.");
-  } else {
-    send_s1u_pdu(enb_fteid, msg.get());
+    return dl_action::drop;
   }
+  *enb_fteid = dl->enb_fteid;
+  return dl_action::forward;
+}
+
+void spgw::gtpu::handle_dl_paging(uint32_t spgw_ctr_teid, srsran::unique_byte_buffer_t msg)
+{
+  // GTP-C state is owned by the SPGW thread
+  std::lock_guard<std::mutex> lock(m_spgw->m_ctrl_mutex);
+  m_logger.debug("Triggering Donwlink Notification Requset.");
+  m_gtpc->send_downlink_data_notification(spgw_ctr_teid);
+  m_gtpc->queue_downlink_packet(spgw_ctr_teid, std::move(msg));
 }
 
 void spgw::gtpu::handle_s1u_pdu(srsran::byte_buffer_t* msg)
@@ -268,6 +398,10 @@ void spgw::gtpu::handle_s1u_pdu(srsran::byte_buffer_t* msg)
 
   m_logger.debug("Received PDU from S1-U. Bytes=%d", msg->N_bytes);
   m_logger.debug("TEID 0x%x. Bytes=%d", header.teid, msg->N_bytes);
+  in_addr_t ue_ipv4 = 0;
+  if (m_logger.debug.enabled() and not resolve_ul_tunnel(header.teid, &ue_ipv4)) {
+    m_logger.debug("TEID 0x%x does not belong to a known tunnel", header.teid);
+  }
   int n = write(m_sgi, msg->msg, msg->N_bytes);
   if (n < 0) {
     m_logger.error("Could not write to TUN interface.");
@@ -330,7 +464,10 @@ void spgw::gtpu::send_all_queued_packets(srsran::gtp_fteid_t
 /*
  * Tunnel managment
  */
-bool spgw::gtpu::modify_gtpu_tunnel(in_addr_t ue_ipv4, srsran::gtpc_f_teid_ie dw_user_fteid, uint32_t up_ctrl_teid)
+bool spgw::gtpu::modify_gtpu_tunnel(in_addr_t              ue_ipv4,
+                                    srsran::gtpc_f_teid_ie dw_user_fteid,
+                                    uint32_t               up_user_teid,
+                                    uint32_t               up_ctrl_teid)
 {
   m_logger.info("Modifying GTP-U Tunnel.");
   fmt::memory_buffer buffer;
@@ -339,33 +476,53 @@ bool spgw::gtpu::modify_gtpu_tunnel(in_addr_t ue_ipv4, srsran::gtpc_f_teid_ie dw
   buffer.clear();
   srsran::gtpu_ntoa(buffer, dw_user_fteid.ipv4);
   m_logger.info("Downlink eNB addr %s, U-TEID 0x%x", srsran::to_c_str(buffer), dw_user_fteid.teid);
-  m_logger.info("Uplink C-TEID: 0x%x", up_ctrl_teid);
-  m_ip_to_usr_teid[ue_ipv4] = dw_user_fteid;
-  m_ip_to_ctr_teid[ue_ipv4] = up_ctrl_teid;
+  m_logger.info("Uplink U-TEID: 0x%x, C-TEID: 0x%x", up_user_teid, up_ctrl_teid);
+  srsran::rwlock_write_guard lock(m_tunnel_rwlock);
+  spgw_dl_tunnel_t&          dl = m_dl_tunnels[ue_ipv4];
+  if (dl.usr_active and dl.spgw_usr_teid != up_user_teid) {
+    m_ul_tunnels.erase(dl.spgw_usr_teid);
+  }
+  dl.enb_fteid         = dw_user_fteid;
+  dl.spgw_ctr_teid     = up_ctrl_teid;
+  dl.spgw_usr_teid     = up_user_teid;
+  dl.usr_active        = true;
+  dl.ctr_active        = true;
+  spgw_ul_tunnel_t& ul = m_ul_tunnels[up_user_teid];
+  ul.ue_ipv4           = ue_ipv4;
+  ul.spgw_ctr_teid     = up_ctrl_teid;
   return true;
 }
 
 bool spgw::gtpu::delete_gtpu_tunnel(in_addr_t ue_ipv4)
 {
   // Remove GTP-U connections, if any.
-  if (m_ip_to_usr_teid.count(ue_ipv4)) {
-    m_ip_to_usr_teid.erase(ue_ipv4);
-  } else {
+  srsran::rwlock_write_guard lock(m_tunnel_rwlock);
+  spgw_dl_tunnel_t*          dl = m_dl_tunnels.find_value(ue_ipv4);
+  if (dl == nullptr or not dl->usr_active) {
     m_logger.error("Could not find GTP-U Tunnel to delete.");
     return false;
   }
+  m_ul_tunnels.erase(dl->spgw_usr_teid);
+  dl->usr_active = false;
+  if (not dl->ctr_active) {
+    m_dl_tunnels.erase(ue_ipv4);
+  }
   return true;
 }
 
 bool spgw::gtpu::delete_gtpc_tunnel(in_addr_t ue_ipv4)
 {
   // Remove Ctrl TEID from IP mapping.
-  if (m_ip_to_ctr_teid.count(ue_ipv4)) {
-    m_ip_to_ctr_teid.erase(ue_ipv4);
-  } else {
+  srsran::rwlock_write_guard lock(m_tunnel_rwlock);
+  spgw_dl_tunnel_t*          dl = m_dl_tunnels.find_value(ue_ipv4);
+  if (dl == nullptr or not dl->ctr_active) {
     m_logger.error("Could not find GTP-C Tunnel info to delete.");
     return false;
   }
+  dl->ctr_active = false;
+  if (not dl->usr_active) {
+    m_dl_tunnels.erase(ue_ipv4);
+  }
   return true;
 }
 
@@ -0,0 +1,405 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsepc/hdr/spgw/gtpu_dp.h"
+#include "srsepc/hdr/spgw/spgw.h"
+#include "srsran/upper/gtpu.h"
+#include <fcntl.h>
+#include <linux/filter.h>
+#include <linux/ip.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace srsepc {
+
+namespace {
+
+const size_t GTPU_DP_BUF_LEN = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
+
+int set_nonblocking(int fd)
+{
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0) {
+    return SRSRAN_ERROR;
+  }
+  return fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 ? SRSRAN_ERROR : SRSRAN_SUCCESS;
+}
+
+int add_epoll(int epoll_fd, int fd)
+{
+  struct epoll_event event = {};
+  event.events             = EPOLLIN;
+  event.data.fd            = fd;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0 ? SRSRAN_ERROR : SRSRAN_SUCCESS;
+}
+
+} // namespace
+
+/**************************************
+ *
+ * GTP-U data-plane worker
+ *
+ **************************************/
+
+gtpu_dp_worker::gtpu_dp_worker(uint32_t id_, gtpu_dp_interface* parent_) :
+  thread("SPGW_DP" + std::to_string(id_)), id(id_), parent(parent_)
+{}
+
+gtpu_dp_worker::~gtpu_dp_worker()
+{
+  stop();
+}
+
+int gtpu_dp_worker::init(int sgi_fd_, int s1u_fd_, uint32_t batch_size_)
+{
+  sgi_fd     = sgi_fd_;
+  s1u_fd     = s1u_fd_;
+  batch_size = std::max(batch_size_, 1u);
+
+  if (set_nonblocking(sgi_fd) != SRSRAN_SUCCESS or set_nonblocking(s1u_fd) != SRSRAN_SUCCESS) {
+    m_logger.error("DP worker %d: could not set non-blocking mode: %s", id, strerror(errno));
+    return SRSRAN_ERROR_CANT_START;
+  }
+
+  epoll_fd = epoll_create1(0);
+  stop_fd  = eventfd(0, EFD_NONBLOCK);
+  if (epoll_fd < 0 or stop_fd < 0) {
+    m_logger.error("DP worker %d: could not create epoll/eventfd: %s", id, strerror(errno));
+    return SRSRAN_ERROR_CANT_START;
+  }
+  if (add_epoll(epoll_fd, sgi_fd) != SRSRAN_SUCCESS or add_epoll(epoll_fd, s1u_fd) != SRSRAN_SUCCESS or
+      add_epoll(epoll_fd, stop_fd) != SRSRAN_SUCCESS) {
+    m_logger.error("DP worker %d: could not register descriptors in epoll: %s", id, strerror(errno));
+    return SRSRAN_ERROR_CANT_START;
+  }
+
+  bufs.resize(batch_size);
+  msgs.resize(batch_size);
+  iovs.resize(batch_size);
+  addrs.resize(batch_size);
+  if (not alloc_rx_buffers()) {
+    return SRSRAN_ERROR_CANT_START;
+  }
+
+  m_logger.info("DP worker %d initialized. SGi fd=%d, S1-U fd=%d, batch size=%d", id, sgi_fd, s1u_fd, batch_size);
+  return SRSRAN_SUCCESS;
+}
+
+bool gtpu_dp_worker::start_worker(int prio)
+{
+  running = true;
+  if (not start(prio)) {
+    running = false;
+    return false;
+  }
+  return true;
+}
+
+void gtpu_dp_worker::stop()
+{
+  if (running.exchange(false)) {
+    uint64_t one = 1;
+    if (write(stop_fd, &one, sizeof(one)) < 0) {
+      m_logger.error("DP worker %d: could not signal stop", id);
+    }
+    wait_thread_finish();
+  }
+  if (epoll_fd >= 0) {
+    close(epoll_fd);
+    epoll_fd = -1;
+  }
+  if (stop_fd >= 0) {
+    close(stop_fd);
+    stop_fd = -1;
+  }
+}
+
+gtpu_dp_metrics_t gtpu_dp_worker::get_metrics() const
+{
+  gtpu_dp_metrics_t m = {};
+  m.ul_pkts           = ul_pkts.load(std::memory_order_relaxed);
+  m.ul_bytes          = ul_bytes.load(std::memory_order_relaxed);
+  m.ul_drops          = ul_drops.load(std::memory_order_relaxed);
+  m.ul_unknown_teid   = ul_unknown_teid.load(std::memory_order_relaxed);
+  m.dl_pkts           = dl_pkts.load(std::memory_order_relaxed);
+  m.dl_bytes          = dl_bytes.load(std::memory_order_relaxed);
+  m.dl_drops          = dl_drops.load(std::memory_order_relaxed);
+  m.nof_syscalls      = nof_syscalls.load(std::memory_order_relaxed);
+  return m;
+}
+
+bool gtpu_dp_worker::realloc_rx_buffer(uint32_t idx)
+{
+  bufs[idx] = srsran::make_byte_buffer("gtpu_dp_worker::rx");
+  return bufs[idx] != nullptr;
+}
+
+bool gtpu_dp_worker::alloc_rx_buffers()
+{
+  // Buffers handed over for paging are replaced here if the pool was empty at the time
+  for (uint32_t i = 0; i < batch_size; ++i) {
+    if (bufs[i] == nullptr and not realloc_rx_buffer(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void gtpu_dp_worker::run_thread()
+{
+  const int          max_events = 3;
+  struct epoll_event events[max_events];
+  while (running.load(std::memory_order_relaxed)) {
+    int nof_events = epoll_wait(epoll_fd, events, max_events, -1);
+    if (nof_events < 0) {
+      if (errno != EINTR) {
+        m_logger.error("DP worker %d: error from epoll_wait: %s", id, strerror(errno));
+      }
+      continue;
+    }
+    for (int i = 0; i < nof_events; ++i) {
+      if (events[i].data.fd == s1u_fd) {
+        handle_s1u_batch();
+      } else if (events[i].data.fd == sgi_fd) {
+        handle_sgi_batch();
+      }
+    }
+  }
+}
+
+/*
+ * Uplink: drain the S1-U socket with recvmmsg, strip the GTP-U header and write the inner IP packets to the TUN
+ * queue. TUN has no batched write, so the writes remain one per packet.
+ */
+void gtpu_dp_worker::handle_s1u_batch()
+{
+  if (not alloc_rx_buffers()) {
+    return;
+  }
+  while (true) {
+    for (uint32_t i = 0; i < batch_size; ++i) {
+      bufs[i]->clear();
+      iovs[i].iov_base            = bufs[i]->msg;
+      iovs[i].iov_len             = GTPU_DP_BUF_LEN;
+      msgs[i].msg_hdr             = {};
+      msgs[i].msg_hdr.msg_iov     = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen  = 1;
+      msgs[i].msg_hdr.msg_name    = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      msgs[i].msg_len             = 0;
+    }
+
+    int n = recvmmsg(s1u_fd, msgs.data(), batch_size, MSG_DONTWAIT, nullptr);
+    nof_syscalls.fetch_add(1, std::memory_order_relaxed);
+    if (n <= 0) {
+      if (n < 0 and errno != EAGAIN and errno != EWOULDBLOCK) {
+        m_logger.error("DP worker %d: error receiving from S1-U: %s", id, strerror(errno));
+      }
+      return;
+    }
+
+    for (int i = 0; i < n; ++i) {
+      srsran::byte_buffer_t* msg = bufs[i].get();
+      msg->N_bytes               = msgs[i].msg_len;
+
+      srsran::gtpu_header_t header;
+      if (msg->N_bytes < GTPU_BASE_HEADER_LEN or not srsran::gtpu_read_header(msg, &header, m_logger)) {
+        ul_drops.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      m_logger.debug("DP worker %d: received PDU from S1-U. TEID 0x%x, Bytes=%d", id, header.teid, msg->N_bytes);
+      in_addr_t ue_ipv4 = 0;
+      if (not parent->resolve_ul_tunnel(header.teid, &ue_ipv4)) {
+        ul_unknown_teid.fetch_add(1, std::memory_order_relaxed);
+        m_logger.debug("DP worker %d: S1-U PDU for unknown TEID 0x%x", id, header.teid);
+      }
+
+      int nwritten = write(sgi_fd, msg->msg, msg->N_bytes);
+      nof_syscalls.fetch_add(1, std::memory_order_relaxed);
+      if (nwritten < 0) {
+        ul_drops.fetch_add(1, std::memory_order_relaxed);
+        m_logger.warning("DP worker %d: could not write to TUN interface: %s", id, strerror(errno));
+      } else {
+        ul_pkts.fetch_add(1, std::memory_order_relaxed);
+        ul_bytes.fetch_add(nwritten, std::memory_order_relaxed);
+      }
+    }
+
+    if ((uint32_t)n < batch_size) {
+      // Socket drained
+      return;
+    }
+  }
+}
+
+/*
+ * Downlink: read up to batch_size IP packets from the TUN queue, resolve their tunnels, prepend the GTP-U header in
+ * the buffer headroom and send all of them to the eNBs with a single sendmmsg.
+ */
+void gtpu_dp_worker::handle_sgi_batch()
+{
+  if (not alloc_rx_buffers()) {
+    return;
+  }
+  while (true) {
+    uint32_t nof_read = 0;
+    uint32_t nof_tx   = 0;
+    for (; nof_read < batch_size; ++nof_read) {
+      srsran::byte_buffer_t* msg = bufs[nof_read].get();
+      msg->clear();
+      int n = read(sgi_fd, msg->msg, GTPU_DP_BUF_LEN);
+      nof_syscalls.fetch_add(1, std::memory_order_relaxed);
+      if (n <= 0) {
+        if (n < 0 and errno != EAGAIN and errno != EWOULDBLOCK) {
+          m_logger.error("DP worker %d: error reading from TUN interface: %s", id, strerror(errno));
+        }
+        break;
+      }
+      msg->N_bytes = n;
+
+      struct iphdr* iph = (struct iphdr*)msg->msg;
+      if (msg->N_bytes < sizeof(struct iphdr) or iph->version != 4 or ntohs(iph->tot_len) < 20) {
+        dl_drops.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+
+      srsran::gtp_fteid_t enb_fteid = {};
+      uint32_t            ctr_teid  = 0;
+      switch (parent->resolve_dl_tunnel(iph->daddr, &enb_fteid, &ctr_teid)) {
+        case gtpu_dp_interface::dl_action::forward:
+          break;
+        case gtpu_dp_interface::dl_action::page:
+          parent->handle_dl_paging(ctr_teid, std::move(bufs[nof_read]));
+          if (not realloc_rx_buffer(nof_read)) {
+            send_s1u_batch(nof_tx);
+            return;
+          }
+          continue;
+        default:
+          dl_drops.fetch_add(1, std::memory_order_relaxed);
+          continue;
+      }
+
+      srsran::gtpu_header_t header = {};
+      header.flags                 = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
+      header.message_type          = GTPU_MSG_DATA_PDU;
+      header.length                = msg->N_bytes;
+      header.teid                  = enb_fteid.teid;
+      if (not srsran::gtpu_write_header(&header, msg, m_logger)) {
+        dl_drops.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+
+      addrs[nof_tx].sin_family         = AF_INET;
+      addrs[nof_tx].sin_port           = htons(GTPU_RX_PORT);
+      addrs[nof_tx].sin_addr.s_addr    = enb_fteid.ipv4;
+      iovs[nof_tx].iov_base            = msg->msg;
+      iovs[nof_tx].iov_len             = msg->N_bytes;
+      msgs[nof_tx].msg_hdr             = {};
+      msgs[nof_tx].msg_hdr.msg_iov     = &iovs[nof_tx];
+      msgs[nof_tx].msg_hdr.msg_iovlen  = 1;
+      msgs[nof_tx].msg_hdr.msg_name    = &addrs[nof_tx];
+      msgs[nof_tx].msg_hdr.msg_namelen = sizeof(addrs[nof_tx]);
+      nof_tx++;
+    }
+
+    send_s1u_batch(nof_tx);
+    if (nof_read < batch_size) {
+      // TUN queue drained
+      return;
+    }
+  }
+}
+
+void gtpu_dp_worker::send_s1u_batch(uint32_t nof_msgs)
+{
+  uint32_t nof_sent = 0;
+  while (nof_sent < nof_msgs) {
+    int n = sendmmsg(s1u_fd, &msgs[nof_sent], nof_msgs - nof_sent, 0);
+    nof_syscalls.fetch_add(1, std::memory_order_relaxed);
+    if (n < 0) {
+      if (errno == EAGAIN or errno == EWOULDBLOCK or errno == EINTR) {
+        continue;
+      }
+      m_logger.error("DP worker %d: error sending packets to eNB: %s", id, strerror(errno));
+      // Skip the offending packet and carry on with the rest of the batch
+      dl_drops.fetch_add(1, std::memory_order_relaxed);
+      nof_sent++;
+      continue;
+    }
+    for (int i = 0; i < n; ++i) {
+      dl_pkts.fetch_add(1, std::memory_order_relaxed);
+      dl_bytes.fetch_add(msgs[nof_sent + i].msg_len, std::memory_order_relaxed);
+    }
+    nof_sent += n;
+  }
+}
+
+/**************************************
+ *
+ * S1-U socket group helpers
+ *
+ **************************************/
+
+int gtpu_dp_open_s1u_sockets(const sockaddr_in& addr, uint32_t nof_socks, std::vector<int>& socks)
+{
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("GTPU");
+
+  socks.clear();
+  for (uint32_t i = 0; i < nof_socks; ++i) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+      logger.error("Failed to open S1-U socket: %s", strerror(errno));
+      return SRSRAN_ERROR_CANT_START;
+    }
+    socks.push_back(fd);
+
+    int enable = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+      logger.error("Failed to set SO_REUSEPORT on S1-U socket: %s", strerror(errno));
+      return SRSRAN_ERROR_CANT_START;
+    }
+    if (bind(fd, (const struct sockaddr*)&addr, sizeof(addr)) < 0) {
+      logger.error("Failed to bind S1-U socket: %s", strerror(errno));
+      return SRSRAN_ERROR_CANT_START;
+    }
+  }
+
+  if (nof_socks > 1) {
+    // Steer by TEID: with the UDP header pulled, the TEID sits at offset 4 of the GTP-U header.
+    struct sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, 4},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, nof_socks},
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    struct sock_fprog prog = {};
+    prog.len               = sizeof(code) / sizeof(code[0]);
+    prog.filter            = code;
+    if (setsockopt(socks[0], SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0) {
+      // The kernel then falls back to hashing the 4-tuple, which still keeps per-tunnel ordering.
+      logger.warning("Could not attach TEID steering program to S1-U sockets: %s", strerror(errno));
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsepc
@@ -117,6 +117,9 @@ void spgw::run_thread()
 
   size_t buf_len = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
 
+  // With data-plane workers, SGi and S1-U are served by the workers and this thread only handles S11
+  bool dp_workers = m_gtpu->has_dp_workers();
+
   fd_set set;
   int    max_fd = std::max(s1u, sgi);
   max_fd        = std::max(max_fd, s11);
@@ -125,8 +128,10 @@ void spgw::run_thread()
     s11_msg->clear();
 
     FD_ZERO(&set);
-    FD_SET(s1u, &set);
-    FD_SET(sgi, &set);
+    if (not dp_workers) {
+      FD_SET(s1u, &set);
+      FD_SET(sgi, &set);
+    }
     FD_SET(s11, &set);
 
     int n = select(max_fd + 1, &set, NULL, NULL, NULL);
@@ -157,6 +162,7 @@ void spgw::run_thread()
         m_logger.debug("Message received at SPGW: S11 Message");
         socklen_t addrlen = sizeof(src_addr_un);
         s11_msg->N_bytes  = recvfrom(s11, s11_msg->msg, buf_len, 0, (struct sockaddr*)&src_addr_un, &addrlen);
+        std::lock_guard<std::mutex> lock(m_ctrl_mutex);
         m_gtpc->handle_s11_pdu(s11_msg.get());
       }
     } else {
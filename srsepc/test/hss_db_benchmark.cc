@@ -0,0 +1,393 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Benchmark of the HSS subscriber databases. Compares the HSS startup and shutdown with a user_db.csv against the
+ * memory-mapped binary database, and measures IMSI lookups, journaled SQN updates and authentication vectors generated
+ * one by one or in batches. It also checks the batched vectors, that SQN updates survive a crash of the process and
+ * that a database exports back to the CSV it was imported from.
+ */
+
+#include "srsepc/hdr/hss/hss.h"
+#include "srsran/common/test_common.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <getopt.h>
+#include <map>
+#include <random>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using tp_t = std::chrono::high_resolution_clock::time_point;
+
+double elapsed_ms(tp_t start)
+{
+  auto dur = std::chrono::high_resolution_clock::now() - start;
+  return std::chrono::duration_cast<std::chrono::microseconds>(dur).count() / 1000.0;
+}
+
+double elapsed_ns(tp_t start, uint32_t nof_ops)
+{
+  auto dur = std::chrono::high_resolution_clock::now() - start;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count() / (double)nof_ops;
+}
+
+const uint64_t imsi_base = 1010000000001ULL; // 001010000000001
+
+std::vector<srsepc::hss_db_record_t> make_records(uint32_t nof_subscribers)
+{
+  std::vector<srsepc::hss_db_record_t> records(nof_subscribers);
+  for (uint32_t i = 0; i < nof_subscribers; ++i) {
+    srsepc::hss_db_record_t& rec = records[i];
+    snprintf(rec.name, sizeof(rec.name), "ue%u", i);
+    rec.imsi = imsi_base + i;
+    rec.algo = srsepc::HSS_ALGO_MILENAGE;
+    for (uint32_t j = 0; j < 16; ++j) {
+      rec.key[j] = (i >> (j % 4) * 8) ^ j;
+      rec.opc[j] = 0x63 + j;
+    }
+    rec.amf[0] = 0x80;
+    rec.sqn[5] = i & 0xff;
+    rec.qci    = 7;
+    // One subscriber in a thousand has a static IP
+    if (i % 1000 == 0) {
+      rec.static_ip = htonl(0xac100000 + i / 1000 + 2);
+    }
+  }
+  return records;
+}
+
+int64_t file_size(const std::string& filename)
+{
+  struct stat st;
+  return stat(filename.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+void cleanup_files(const std::string& prefix)
+{
+  for (const char* suffix : {".csv", ".db", ".db.journal", ".export.csv"}) {
+    unlink((prefix + suffix).c_str());
+  }
+}
+
+/// Checks the vectors of one batch of Authentication Information Requests against the Milenage functions of single
+/// subscribers. The batch mixes several UEs, a UE that appears twice and an unknown IMSI.
+int check_auth_info_answers(srsepc::hss*                                hss,
+                            const std::vector<srsepc::hss_db_record_t>& records,
+                            const srsepc::hss_args_t&                   hss_args)
+{
+  const uint32_t                       nof_ues = 8;
+  std::vector<srsepc::hss_auth_info_t> infos(nof_ues + 2);
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    infos[i].imsi = records[2 + i].imsi;
+  }
+  infos[nof_ues].imsi     = records[2].imsi;
+  infos[nof_ues + 1].imsi = imsi_base + records.size();
+  TESTASSERT(hss->gen_auth_info_answers(infos.data(), infos.size()) == nof_ues + 1);
+  TESTASSERT(not infos[nof_ues + 1].user_found);
+
+  uint8_t first_sqn[6] = {};
+  for (uint32_t i = 0; i <= nof_ues; ++i) {
+    const srsepc::hss_auth_info_t& info = infos[i];
+    srsepc::hss_db_record_t        rec  = records[2 + i % nof_ues];
+    TESTASSERT(info.user_found);
+
+    uint8_t res[8], ck[16], ik[16], ak[6], mac_a[8], k_asme[32];
+    TESTASSERT(srsran::security_milenage_f2345(rec.key, rec.opc, (uint8_t*)info.rand, res, ck, ik, ak) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(memcmp(info.xres, res, sizeof(res)) == 0);
+    uint8_t sqn[6];
+    for (uint32_t j = 0; j < 6; ++j) {
+      sqn[j] = info.autn[j] ^ ak[j];
+    }
+    TESTASSERT(memcmp(&info.autn[6], rec.amf, 2) == 0);
+    TESTASSERT(srsran::security_milenage_f1(rec.key, rec.opc, (uint8_t*)info.rand, sqn, rec.amf, mac_a) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(memcmp(&info.autn[8], mac_a, sizeof(mac_a)) == 0);
+    TESTASSERT(srsran::security_generate_k_asme(ck, ik, &info.autn[0], hss_args.mcc, hss_args.mnc, k_asme) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(memcmp(info.k_asme, k_asme, sizeof(k_asme)) == 0);
+
+    // The first vector of a UE uses the SQN of the database, and the second one in the batch the next SQN
+    if (i < nof_ues) {
+      TESTASSERT(memcmp(sqn, rec.sqn, 6) == 0);
+    }
+    if (i == 0) {
+      memcpy(first_sqn, sqn, 6);
+    }
+    if (i == nof_ues) {
+      TESTASSERT(memcmp(sqn, first_sqn, 6) > 0);
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/// Authentication vectors generated one request per call, and in batches of 64 requests as the MME HSS workers do.
+/// Returns the time per vector of both, in ns.
+int bench_auth_info_answers(srsepc::hss* hss, uint32_t nof_subscribers, uint32_t nof_airs, double* single, double* batch)
+{
+  const uint32_t                       batch_size = 64;
+  std::vector<srsepc::hss_auth_info_t> infos(nof_airs);
+  for (uint32_t i = 0; i < nof_airs; ++i) {
+    infos[i].imsi = imsi_base + i % nof_subscribers;
+  }
+
+  tp_t t0 = std::chrono::high_resolution_clock::now();
+  for (srsepc::hss_auth_info_t& info : infos) {
+    TESTASSERT(hss->gen_auth_info_answer(info.imsi, info.k_asme, info.autn, info.rand, info.xres));
+  }
+  *single = elapsed_ns(t0, nof_airs);
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_airs; i += batch_size) {
+    uint32_t n = std::min(batch_size, nof_airs - i);
+    TESTASSERT(hss->gen_auth_info_answers(&infos[i], n) == n);
+  }
+  *batch = elapsed_ns(t0, nof_airs);
+  return SRSRAN_SUCCESS;
+}
+
+int run_benchmark(uint32_t nof_subscribers, uint32_t nof_lookups, uint32_t nof_updates, uint32_t nof_airs)
+{
+  std::string csv_file = "/tmp/hss_db_benchmark_" + std::to_string(getpid());
+  std::string prefix   = csv_file;
+  std::string db_file  = prefix + ".db";
+  csv_file += ".csv";
+
+  std::vector<srsepc::hss_db_record_t> records = make_records(nof_subscribers);
+  TESTASSERT(srsepc::hss_db::write_csv(csv_file, records));
+
+  srsepc::hss_args_t hss_args = {};
+  hss_args.mcc                = 0xf001;
+  hss_args.mnc                = 0xff01;
+
+  // HSS startup and shutdown with the CSV file, which is parsed at init and rewritten at stop
+  hss_args.db_file = csv_file;
+  srsepc::hss* hss = srsepc::hss::get_instance();
+  tp_t         t0  = std::chrono::high_resolution_clock::now();
+  TESTASSERT(hss->init(&hss_args) == 0);
+  double csv_start = elapsed_ms(t0);
+  TESTASSERT(check_auth_info_answers(hss, records, hss_args) == SRSRAN_SUCCESS);
+  double csv_air = 0, csv_air_batch = 0;
+  TESTASSERT(bench_auth_info_answers(hss, nof_subscribers, nof_airs, &csv_air, &csv_air_batch) == SRSRAN_SUCCESS);
+  t0 = std::chrono::high_resolution_clock::now();
+  hss->stop();
+  double csv_stop = elapsed_ms(t0);
+  srsepc::hss::cleanup();
+
+  // Import
+  t0 = std::chrono::high_resolution_clock::now();
+  std::vector<srsepc::hss_db_record_t> imported;
+  TESTASSERT(srsepc::hss_db::read_csv(csv_file, imported));
+  TESTASSERT(imported.size() == nof_subscribers);
+  TESTASSERT(srsepc::hss_db::create(db_file, imported));
+  double import_time = elapsed_ms(t0);
+
+  // HSS startup and shutdown with the binary database. An authentication vector moves the SQN forward
+  hss_args.db_file = db_file;
+  hss              = srsepc::hss::get_instance();
+  t0               = std::chrono::high_resolution_clock::now();
+  TESTASSERT(hss->init(&hss_args) == 0);
+  double db_start = elapsed_ms(t0);
+  TESTASSERT(hss->get_ip_to_imsi().size() == (nof_subscribers + 999) / 1000);
+  TESTASSERT(check_auth_info_answers(hss, imported, hss_args) == SRSRAN_SUCCESS);
+  double db_air = 0, db_air_batch = 0;
+  TESTASSERT(bench_auth_info_answers(hss, nof_subscribers, nof_airs, &db_air, &db_air_batch) == SRSRAN_SUCCESS);
+  uint8_t k_asme[32], autn[16], rand[16], xres[16], qci = 0;
+  TESTASSERT(hss->gen_auth_info_answer(imsi_base, k_asme, autn, rand, xres));
+  TESTASSERT(hss->gen_update_loc_answer(imsi_base + nof_subscribers - 1, &qci) and qci == 7);
+  TESTASSERT(not hss->gen_update_loc_answer(imsi_base + nof_subscribers, &qci));
+  t0 = std::chrono::high_resolution_clock::now();
+  hss->stop();
+  double db_stop = elapsed_ms(t0);
+  srsepc::hss::cleanup();
+
+  srsepc::hss_db db;
+  TESTASSERT(db.open(db_file, false));
+  TESTASSERT(db.size() == nof_subscribers);
+  TESTASSERT(memcmp(db.find(imsi_base)->sqn, records[0].sqn, 6) != 0);
+  TESTASSERT(memcmp(db.find(imsi_base)->last_rand, rand, 16) == 0);
+
+  // Lookups of random IMSIs, against the ordered map the HSS uses for CSV files
+  std::mt19937                            rng(0);
+  std::uniform_int_distribution<uint32_t> dist(0, nof_subscribers - 1);
+  std::vector<uint64_t>                   lookup_imsis(nof_lookups);
+  for (uint64_t& imsi : lookup_imsis) {
+    imsi = imsi_base + dist(rng);
+  }
+  std::map<uint64_t, std::unique_ptr<srsepc::hss_db_record_t> > legacy;
+  for (const srsepc::hss_db_record_t& rec : records) {
+    legacy.insert(
+        std::make_pair(rec.imsi, std::unique_ptr<srsepc::hss_db_record_t>(new srsepc::hss_db_record_t(rec))));
+  }
+  uint64_t checksum_legacy = 0, checksum_db = 0;
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint64_t imsi : lookup_imsis) {
+    auto it = legacy.find(imsi);
+    if (it != legacy.end()) {
+      checksum_legacy += it->second->key[0];
+    }
+  }
+  double legacy_lookup = elapsed_ns(t0, nof_lookups);
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint64_t imsi : lookup_imsis) {
+    const srsepc::hss_db_record_t* rec = db.find(imsi);
+    if (rec != nullptr) {
+      checksum_db += rec->key[0];
+    }
+  }
+  double db_lookup = elapsed_ns(t0, nof_lookups);
+  TESTASSERT(checksum_legacy == checksum_db);
+
+  // Journaled SQN updates, without and with a disk flush per update
+  uint8_t sqn[6] = {}, last_rand[16] = {};
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_updates; ++i) {
+    sqn[5] = i;
+    TESTASSERT(db.update_sqn(lookup_imsis[i % nof_lookups], sqn, last_rand));
+  }
+  double update = elapsed_ns(t0, nof_updates);
+  db.close();
+
+  uint32_t nof_sync_updates = std::min(nof_updates, 200U);
+  TESTASSERT(db.open(db_file, true));
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_sync_updates; ++i) {
+    TESTASSERT(db.update_sqn(lookup_imsis[i % nof_lookups], sqn, last_rand));
+  }
+  double sync_update = elapsed_ns(t0, nof_sync_updates);
+  db.close();
+
+  // A process that dies after updating a SQN leaves it in the journal
+  uint8_t crash_sqn[6] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc};
+  pid_t   pid          = fork();
+  TESTASSERT(pid >= 0);
+  if (pid == 0) {
+    srsepc::hss_db child_db;
+    if (not child_db.open(db_file, false) or not child_db.update_sqn(imsi_base + 1, crash_sqn, last_rand)) {
+      _exit(1);
+    }
+    _exit(0);
+  }
+  int status = 0;
+  TESTASSERT(waitpid(pid, &status, 0) == pid and WIFEXITED(status) and WEXITSTATUS(status) == 0);
+  TESTASSERT(file_size(db_file + ".journal") > 0);
+  TESTASSERT(db.open(db_file, false));
+  TESTASSERT(memcmp(db.find(imsi_base + 1)->sqn, crash_sqn, 6) == 0);
+  TESTASSERT(file_size(db_file + ".journal") == 0);
+
+  // Export round trip. The last RAND is not part of the CSV format
+  std::string                          export_file = prefix + ".export.csv";
+  std::vector<srsepc::hss_db_record_t> db_records  = db.get_records();
+  std::vector<srsepc::hss_db_record_t> exported;
+  TESTASSERT(srsepc::hss_db::write_csv(export_file, db_records));
+  TESTASSERT(srsepc::hss_db::read_csv(export_file, exported));
+  TESTASSERT(exported.size() == db_records.size());
+  for (srsepc::hss_db_record_t& rec : db_records) {
+    memset(rec.last_rand, 0, sizeof(rec.last_rand));
+  }
+  TESTASSERT(memcmp(exported.data(), db_records.data(), exported.size() * sizeof(srsepc::hss_db_record_t)) == 0);
+  db.close();
+
+  fmt::print("Subscribers: {}, CSV {} kB, database {} kB\n",
+             nof_subscribers,
+             file_size(csv_file) / 1024,
+             file_size(db_file) / 1024);
+  fmt::print("{:>10}{:>12}{:>12}{:>12}{:>14}{:>14}{:>16}{:>10}{:>14}\n",
+             "",
+             "import[ms]",
+             "start[ms]",
+             "stop[ms]",
+             "lookup[ns]",
+             "update[ns]",
+             "sync update[us]",
+             "AIR[us]",
+             "AIR batch[us]");
+  fmt::print("{:>10}{:>12}{:>12.1f}{:>12.1f}{:>14.1f}{:>14}{:>16}{:>10.2f}{:>14.2f}\n",
+             "CSV",
+             "-",
+             csv_start,
+             csv_stop,
+             legacy_lookup,
+             "-",
+             "-",
+             csv_air / 1000,
+             csv_air_batch / 1000);
+  fmt::print("{:>10}{:>12.1f}{:>12.1f}{:>12.1f}{:>14.1f}{:>14.1f}{:>16.1f}{:>10.2f}{:>14.2f}\n",
+             "database",
+             import_time,
+             db_start,
+             db_stop,
+             db_lookup,
+             update,
+             sync_update / 1000,
+             db_air / 1000,
+             db_air_batch / 1000);
+
+  cleanup_files(prefix);
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t nof_subscribers = 100000;
+  uint32_t nof_lookups     = 1000000;
+  uint32_t nof_updates     = 100000;
+  uint32_t nof_airs        = 100000;
+  int      opt;
+  while ((opt = getopt(argc, argv, "n:l:u:a:")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_subscribers = strtoul(optarg, nullptr, 10);
+        break;
+      case 'l':
+        nof_lookups = strtoul(optarg, nullptr, 10);
+        break;
+      case 'u':
+        nof_updates = strtoul(optarg, nullptr, 10);
+        break;
+      case 'a':
+        nof_airs = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        fmt::print(
+            "Usage: {} [-n nof_subscribers] [-l nof_lookups] [-u nof_sqn_updates] [-a nof_auth_info_requests]\n",
+            argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+  TESTASSERT(nof_subscribers > 10 and nof_lookups > 0 and nof_updates > 0 and nof_airs > 0);
+
+  srslog::fetch_basic_logger("HSS").set_level(srslog::basic_levels::warning);
+  srslog::init();
+
+  TESTASSERT(run_benchmark(nof_subscribers, nof_lookups, nof_updates, nof_airs) == SRSRAN_SUCCESS);
+  srslog::flush();
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,264 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Attach-storm benchmark of the MME. Simulated eNBs connect over loopback SCTP, or with -l over in-process
+ * associations that leave the kernel SCTP stack out of the measurement, and run complete EPS attaches
+ * (authentication, NAS security mode and default bearer setup) for distinct IMSIs, keeping a window of attaches in
+ * flight each. With -d every UE switches off right after attaching, which adds the detach and the UE context release
+ * to each procedure. The S11 peer is a stub SP-GW that accepts every session.
+ */
+
+#include "mme_test_common.h"
+#include "srsepc/hdr/hss/hss.h"
+#include "srsran/common/test_common.h"
+#include <fcntl.h>
+#include <getopt.h>
+
+using namespace srsepc;
+
+namespace {
+
+struct bench_args_t {
+  uint32_t nof_enbs     = 4;
+  uint32_t nof_ues      = 1000;
+  uint32_t nof_inflight    = 16; // attaches in flight per eNB
+  uint32_t nof_workers     = 0;  // MME worker threads, 0 runs everything on the MME thread
+  uint32_t nof_hss_workers = 0;
+  bool     detach          = false;
+  bool     loopback        = false; // in-process S1-MME associations instead of SCTP
+  bool     verbose         = false;
+};
+
+struct bench_result_t {
+  uint32_t attached = 0;
+  uint32_t detached = 0;
+  uint32_t failed   = 0;
+  double   elapsed_s;
+  double   latency_sum_ms        = 0;
+  double   detach_latency_sum_ms = 0;
+};
+
+/// Runs the attach storm of one eNB, keeping up to nof_inflight attaches ongoing until all UEs are attached. With
+/// detach set, a UE stays in flight until it has detached again.
+void run_enb(enb_sim& enb, uint32_t nof_inflight, bool detach, bench_result_t& res)
+{
+  uint32_t next_ue  = 0;
+  uint32_t inflight = 0;
+  while (next_ue < enb.nof_ues() or inflight > 0) {
+    while (next_ue < enb.nof_ues() and inflight < nof_inflight) {
+      if (not enb.send_attach_request(next_ue)) {
+        res.failed++;
+      } else {
+        inflight++;
+      }
+      next_ue++;
+    }
+
+    s1ap_pdu_c pdu;
+    if (not enb.recv_s1ap(pdu)) {
+      // Timed out. Whatever is still in flight has failed
+      res.failed += inflight;
+      return;
+    }
+    ue_sim_t* ue = nullptr;
+    switch (enb.handle_rx_pdu(pdu, ue)) {
+      case enb_sim::ATTACHED: {
+        std::chrono::duration<double, std::milli> latency = sim_clock::now() - ue->tstart;
+        res.latency_sum_ms += latency.count();
+        res.attached++;
+        if (not detach) {
+          inflight--;
+        } else if (not enb.send_detach_request(*ue)) {
+          res.failed++;
+          inflight--;
+        }
+        break;
+      }
+      case enb_sim::RELEASED: {
+        std::chrono::duration<double, std::milli> latency = sim_clock::now() - ue->tdetach;
+        res.detach_latency_sum_ms += latency.count();
+        res.detached++;
+        inflight--;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+int run_storm(const bench_args_t& args, uint16_t mcc, uint16_t mnc, s1mme_loopback* loopback, bench_result_t& res)
+{
+  std::vector<std::unique_ptr<enb_sim> > enbs;
+  uint64_t                               next_imsi = imsi_base;
+  for (uint32_t i = 0; i < args.nof_enbs; ++i) {
+    uint32_t nof_ues = args.nof_ues / args.nof_enbs + (i < args.nof_ues % args.nof_enbs ? 1 : 0);
+    enbs.emplace_back(new enb_sim(i + 1, mcc, mnc, next_imsi, nof_ues, loopback));
+    next_imsi += nof_ues;
+    TESTASSERT(enbs.back()->connect() == SRSRAN_SUCCESS);
+  }
+
+  std::vector<bench_result_t> enb_res(args.nof_enbs);
+  std::vector<std::thread>    threads;
+  auto                        tstart = sim_clock::now();
+  for (uint32_t i = 0; i < args.nof_enbs; ++i) {
+    threads.emplace_back([&, i]() { run_enb(*enbs[i], args.nof_inflight, args.detach, enb_res[i]); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  res.elapsed_s = std::chrono::duration_cast<std::chrono::duration<double> >(sim_clock::now() - tstart).count();
+  for (const bench_result_t& r : enb_res) {
+    res.attached += r.attached;
+    res.detached += r.detached;
+    res.failed += r.failed;
+    res.latency_sum_ms += r.latency_sum_ms;
+    res.detach_latency_sum_ms += r.detach_latency_sum_ms;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  bench_args_t args;
+  int          opt;
+  while ((opt = getopt(argc, argv, "e:n:c:w:H:dlv")) != -1) {
+    switch (opt) {
+      case 'e':
+        args.nof_enbs = strtoul(optarg, nullptr, 10);
+        break;
+      case 'n':
+        args.nof_ues = strtoul(optarg, nullptr, 10);
+        break;
+      case 'c':
+        args.nof_inflight = strtoul(optarg, nullptr, 10);
+        break;
+      case 'w':
+        args.nof_workers = strtoul(optarg, nullptr, 10);
+        break;
+      case 'H':
+        args.nof_hss_workers = strtoul(optarg, nullptr, 10);
+        break;
+      case 'd':
+        args.detach = true;
+        break;
+      case 'l':
+        args.loopback = true;
+        break;
+      case 'v':
+        args.verbose = true;
+        break;
+      default:
+        fmt::print("Usage: {} [-e nof_enbs] [-n nof_ues] [-c attaches_in_flight_per_enb] [-w nof_mme_workers] "
+                   "[-H nof_hss_workers] [-d] [-l] [-v]\n",
+                   argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+  TESTASSERT(args.nof_enbs > 0 and args.nof_inflight > 0 and args.nof_ues >= args.nof_enbs);
+
+  srslog::basic_levels level = args.verbose ? srslog::basic_levels::info : srslog::basic_levels::warning;
+  for (const char* name : {"S1AP", "NAS", "MME GTPC", "HSS"}) {
+    srslog::fetch_basic_logger(name).set_level(level);
+  }
+  srslog::init();
+
+  srsepc::hss_args_t hss_args = {};
+  hss_args.db_file            = "/tmp/mme_attach_benchmark_user_db_" + std::to_string(getpid()) + ".csv";
+  TESTASSERT(srsran::string_to_mcc(mcc_str, &hss_args.mcc));
+  TESTASSERT(srsran::string_to_mnc(mnc_str, &hss_args.mnc));
+  TESTASSERT(write_user_db(hss_args.db_file, args.nof_ues) == SRSRAN_SUCCESS);
+
+  srsepc::mme_args_t mme_args;
+  mme_args.nof_workers     = args.nof_workers;
+  mme_args.nof_hss_workers = args.nof_hss_workers;
+  fill_s1ap_args(mme_args.s1ap_args, hss_args.mcc, hss_args.mnc);
+
+  // The MME reports every procedure step on the console. Keep it out of the results unless asked for
+  int stdout_fd = dup(STDOUT_FILENO);
+  if (not args.verbose) {
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+  }
+
+  spgw_stub spgw;
+  TESTASSERT(spgw.start() == SRSRAN_SUCCESS);
+  srsepc::hss* hss = srsepc::hss::get_instance();
+  TESTASSERT(hss->init(&hss_args) == SRSRAN_SUCCESS);
+  srsepc::s1mme_loopback loopback;
+  if (args.loopback) {
+    srsepc::s1ap::get_instance()->set_s1mme_transport(&loopback);
+  }
+  srsepc::mme* mme = srsepc::mme::get_instance();
+  TESTASSERT(mme->init(&mme_args) == SRSRAN_SUCCESS);
+  mme->start();
+
+  bench_result_t res;
+  int            ret = run_storm(args, hss_args.mcc, hss_args.mnc, args.loopback ? &loopback : nullptr, res);
+
+  mme->stop();
+  mme->cleanup();
+  spgw.stop();
+  hss->stop();
+  hss->cleanup();
+  unlink(hss_args.db_file.c_str());
+
+  fflush(stdout);
+  dup2(stdout_fd, STDOUT_FILENO);
+  close(stdout_fd);
+  TESTASSERT(ret == SRSRAN_SUCCESS);
+
+  fmt::print("{:>5}{:>9}{:>8}{:>10}{:>10}{:>10}{:>8}{:>10}{:>12}{:>13}{:>12}{:>13}\n",
+             "enbs",
+             "workers",
+             "ues",
+             "inflight",
+             "attached",
+             "detached",
+             "failed",
+             "time[s]",
+             "attaches/s",
+             "latency[ms]",
+             "detaches/s",
+             "latency[ms]");
+  fmt::print("{:>5d}{:>9d}{:>8d}{:>10d}{:>10d}{:>10d}{:>8d}{:>10.3f}{:>12.1f}{:>13.2f}{:>12.1f}{:>13.2f}\n",
+             args.nof_enbs,
+             args.nof_workers,
+             args.nof_ues,
+             args.nof_enbs * args.nof_inflight,
+             res.attached,
+             res.detached,
+             res.failed,
+             res.elapsed_s,
+             res.elapsed_s > 0 ? res.attached / res.elapsed_s : 0.0,
+             res.attached > 0 ? res.latency_sum_ms / res.attached : 0.0,
+             res.elapsed_s > 0 ? res.detached / res.elapsed_s : 0.0,
+             res.detached > 0 ? res.detach_latency_sum_ms / res.detached : 0.0);
+  TESTASSERT(res.attached == args.nof_ues);
+  TESTASSERT(not args.detach or res.detached == args.nof_ues);
+
+  srslog::flush();
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,267 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsepc/hdr/mme/nas_timer_wheel.h"
+#include "srsran/common/common.h"
+#include "srsran/support/srsran_test.h"
+#include <atomic>
+#include <thread>
+
+using namespace srsepc;
+
+namespace {
+
+const uint64_t imsi1 = 1010123456789;
+const uint64_t imsi2 = 1010123456790;
+
+// Records the tick requests of the wheel
+struct tick_state_t {
+  bool     armed      = false;
+  uint32_t nof_arms   = 0;
+  uint32_t nof_disarm = 0;
+
+  nas_timer_wheel::arm_tick_callback_t callback()
+  {
+    return [this](bool arm) {
+      armed = arm;
+      if (arm) {
+        nof_arms++;
+      } else {
+        nof_disarm++;
+      }
+    };
+  }
+};
+
+} // namespace
+
+int test_start_and_expire()
+{
+  tick_state_t    tick;
+  nas_timer_wheel wheel(tick.callback());
+
+  TESTASSERT(not wheel.is_running(T_3413, imsi1));
+  wheel.start(50, T_3413, imsi1, 2);
+  TESTASSERT(wheel.is_running(T_3413, imsi1));
+  TESTASSERT(tick.armed and tick.nof_arms == 1);
+
+  // 50 ms are 5 ticks
+  for (uint32_t i = 0; i < 4; ++i) {
+    TESTASSERT(wheel.step(1).empty());
+    TESTASSERT(wheel.is_running(T_3413, imsi1));
+  }
+  std::vector<nas_timer_wheel::expiry_t> expired = wheel.step(1);
+  TESTASSERT(expired.size() == 1);
+  TESTASSERT(expired[0].key.first == imsi1 and expired[0].key.second == T_3413);
+  TESTASSERT(expired[0].shard == 2);
+  TESTASSERT(not wheel.is_running(T_3413, imsi1));
+  TESTASSERT(not tick.armed and tick.nof_disarm == 1);
+
+  // A timer fires once
+  TESTASSERT(wheel.step(10).empty());
+  TESTASSERT(tick.nof_disarm == 1);
+  return SRSRAN_SUCCESS;
+}
+
+int test_duration_rounding()
+{
+  tick_state_t    tick;
+  nas_timer_wheel wheel(tick.callback());
+
+  // Durations are rounded up to whole ticks
+  wheel.start(15, T_3413, imsi1, 0);
+  TESTASSERT(wheel.step(1).empty());
+  TESTASSERT(wheel.step(1).size() == 1);
+
+  // A zero duration still waits for the next tick
+  wheel.start(0, T_3413, imsi1, 0);
+  TESTASSERT(wheel.is_running(T_3413, imsi1));
+  TESTASSERT(wheel.step(1).size() == 1);
+  return SRSRAN_SUCCESS;
+}
+
+int test_stop()
+{
+  tick_state_t    tick;
+  nas_timer_wheel wheel(tick.callback());
+
+  TESTASSERT(not wheel.stop(T_3413, imsi1));
+  TESTASSERT(tick.nof_arms == 0 and tick.nof_disarm == 0);
+
+  wheel.start(20, T_3413, imsi1, 0);
+  wheel.start(20, T_3413, imsi2, 1);
+  TESTASSERT(tick.nof_arms == 1);
+  TESTASSERT(wheel.stop(T_3413, imsi1));
+  TESTASSERT(not wheel.is_running(T_3413, imsi1));
+  TESTASSERT(tick.armed);
+  TESTASSERT(not wheel.stop(T_3413, imsi1));
+
+  // Only the timer left running expires, then the tick is no longer needed
+  std::vector<nas_timer_wheel::expiry_t> expired = wheel.step(2);
+  TESTASSERT(expired.size() == 1);
+  TESTASSERT(expired[0].key.first == imsi2 and expired[0].shard == 1);
+  TESTASSERT(not tick.armed and tick.nof_disarm == 1);
+
+  // Stopping the last timer disarms the tick
+  wheel.start(20, T_3413, imsi1, 0);
+  TESTASSERT(tick.armed and tick.nof_arms == 2);
+  TESTASSERT(wheel.stop(T_3413, imsi1));
+  TESTASSERT(not tick.armed and tick.nof_disarm == 2);
+  TESTASSERT(wheel.step(5).empty());
+  return SRSRAN_SUCCESS;
+}
+
+int test_restart_while_running()
+{
+  tick_state_t    tick;
+  nas_timer_wheel wheel(tick.callback());
+
+  wheel.start(30, T_3413, imsi1, 0);
+  TESTASSERT(wheel.step(2).empty());
+
+  // Restarting moves the deadline and the shard
+  wheel.start(30, T_3413, imsi1, 3);
+  TESTASSERT(tick.nof_arms == 1);
+  TESTASSERT(wheel.step(2).empty());
+  TESTASSERT(wheel.is_running(T_3413, imsi1));
+  std::vector<nas_timer_wheel::expiry_t> expired = wheel.step(1);
+  TESTASSERT(expired.size() == 1 and expired[0].shard == 3);
+  return SRSRAN_SUCCESS;
+}
+
+int test_restart_from_expiry()
+{
+  tick_state_t    tick;
+  nas_timer_wheel wheel(tick.callback());
+
+  wheel.start(10, T_3413, imsi1, 0);
+  wheel.start(40, T_3413, imsi2, 0);
+
+  // The expiry handler of imsi1 starts it again, as paging does when it retries
+  std::vector<nas_timer_wheel::expiry_t> expired = wheel.step(1);
+  TESTASSERT(expired.size() == 1 and expired[0].key.first == imsi1);
+  for (const nas_timer_wheel::expiry_t& exp : expired) {
+    TESTASSERT(not wheel.is_running(exp.key.second, exp.key.first));
+    wheel.start(20, exp.key.second, exp.key.first, exp.shard);
+  }
+  TESTASSERT(wheel.is_running(T_3413, imsi1));
+
+  // An expiry whose timer runs again is stale, which is how the shard workers drop it
+  TESTASSERT(wheel.is_running(expired[0].key.second, expired[0].key.first));
+
+  TESTASSERT(wheel.step(1).empty());
+  expired = wheel.step(1);
+  TESTASSERT(expired.size() == 1 and expired[0].key.first == imsi1);
+  expired = wheel.step(1);
+  TESTASSERT(expired.size() == 1 and expired[0].key.first == imsi2);
+  TESTASSERT(not tick.armed and tick.nof_arms == 1 and tick.nof_disarm == 1);
+  return SRSRAN_SUCCESS;
+}
+
+int test_catch_up()
+{
+  tick_state_t    tick;
+  nas_timer_wheel wheel(tick.callback());
+
+  // Ticks missed while the MME thread was busy expire every timer that was due, in one step
+  const uint32_t nof_timers = 16;
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    wheel.start(10 * (i + 1), T_3413, imsi1 + i, i % 4);
+  }
+  std::vector<nas_timer_wheel::expiry_t> expired = wheel.step(nof_timers / 2);
+  TESTASSERT(expired.size() == nof_timers / 2);
+  for (const nas_timer_wheel::expiry_t& exp : expired) {
+    TESTASSERT(exp.key.first < imsi1 + nof_timers / 2);
+    TESTASSERT(exp.shard == (exp.key.first - imsi1) % 4);
+  }
+  TESTASSERT(tick.armed);
+  TESTASSERT(wheel.step(nof_timers).size() == nof_timers / 2);
+  TESTASSERT(not tick.armed);
+
+  wheel.start(10, T_3413, imsi1, 0);
+  wheel.clear();
+  TESTASSERT(not wheel.is_running(T_3413, imsi1));
+  TESTASSERT(not tick.armed);
+  TESTASSERT(wheel.step(1).empty());
+  return SRSRAN_SUCCESS;
+}
+
+int test_concurrent_shards()
+{
+  std::atomic<int> armed{0};
+  nas_timer_wheel  wheel([&armed](bool arm) { armed = arm ? 1 : 0; });
+
+  // Shards start and stop their own timers while the MME thread steps the wheel
+  const uint32_t           nof_shards = 4, nof_iters = 2000;
+  std::atomic<bool>        running{true};
+  std::atomic<uint32_t>    nof_stopped{0};
+  std::vector<std::thread> shards;
+  for (uint32_t shard = 0; shard < nof_shards; ++shard) {
+    shards.emplace_back([&wheel, &nof_stopped, shard]() {
+      for (uint32_t i = 0; i < nof_iters; ++i) {
+        uint64_t imsi = imsi1 + shard * nof_iters + i;
+        wheel.start(10 * (i % 5), T_3413, imsi, shard);
+        // The timer may have expired already
+        if (i % 3 == 0 and wheel.stop(T_3413, imsi)) {
+          nof_stopped++;
+        }
+      }
+    });
+  }
+  uint32_t          nof_expired = 0;
+  std::atomic<bool> bad_shard{false};
+  std::thread       ticker([&]() {
+    while (running) {
+      for (const nas_timer_wheel::expiry_t& exp : wheel.step(1)) {
+        nof_expired++;
+        bad_shard = bad_shard or exp.shard != (exp.key.first - imsi1) / nof_iters;
+      }
+    }
+  });
+  for (std::thread& t : shards) {
+    t.join();
+  }
+  // Let every timer that was not stopped expire
+  for (uint32_t i = 0; i < 100 and armed; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  running = false;
+  ticker.join();
+
+  TESTASSERT(not bad_shard);
+  TESTASSERT(armed == 0);
+  // Every timer either expired once or was stopped
+  TESTASSERT(nof_expired + nof_stopped == nof_shards * nof_iters);
+  return SRSRAN_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_start_and_expire() == SRSRAN_SUCCESS);
+  TESTASSERT(test_duration_rounding() == SRSRAN_SUCCESS);
+  TESTASSERT(test_stop() == SRSRAN_SUCCESS);
+  TESTASSERT(test_restart_while_running() == SRSRAN_SUCCESS);
+  TESTASSERT(test_restart_from_expiry() == SRSRAN_SUCCESS);
+  TESTASSERT(test_catch_up() == SRSRAN_SUCCESS);
+  TESTASSERT(test_concurrent_shards() == SRSRAN_SUCCESS);
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
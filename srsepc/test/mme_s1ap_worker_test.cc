@@ -0,0 +1,246 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * S1AP handling of the MME with worker shards and an HSS pool, driven by simulated eNBs over in-process S1-MME
+ * associations.
+ */
+
+#include "mme_test_common.h"
+#include "srsepc/hdr/hss/hss.h"
+#include "srsran/common/test_common.h"
+
+using namespace srsepc;
+
+namespace {
+
+const uint32_t nof_workers     = 3;
+const uint32_t nof_hss_workers = 2;
+const uint32_t nof_routing_ues = 64;
+const uint32_t nof_order_ues   = 64;
+const uint32_t nof_stale_imsis = 32;
+const uint32_t nof_retx        = 4; // attach requests per IMSI in the stale answer test
+const uint32_t nof_db_ues      = nof_routing_ues + nof_order_ues + nof_stale_imsis;
+
+/// Answers the MME until done() holds. Returns false if the MME stops answering first.
+template <typename F>
+bool run_until(enb_sim& enb, F done)
+{
+  while (not done()) {
+    s1ap_pdu_c pdu;
+    if (not enb.recv_s1ap(pdu)) {
+      return false;
+    }
+    ue_sim_t* ue = nullptr;
+    if (enb.handle_rx_pdu(pdu, ue) == enb_sim::ATTACHED) {
+      // Switch off right after the attach
+      enb.send_detach_request(*ue);
+    }
+  }
+  return true;
+}
+
+bool all_released(enb_sim& enb)
+{
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    if (not enb.get_ue(i).released) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+/// Every message of a UE goes to the shard that owns its context, whichever the procedure
+int test_routing(s1mme_loopback& loopback, uint16_t mcc, uint16_t mnc)
+{
+  enb_sim enb(1, mcc, mnc, imsi_base, nof_routing_ues, &loopback);
+  TESTASSERT(enb.connect() == SRSRAN_SUCCESS);
+
+  // Attach all the UEs and keep them attached
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    TESTASSERT(enb.send_attach_request(i));
+  }
+  uint32_t nof_attached = 0;
+  while (nof_attached < enb.nof_ues()) {
+    s1ap_pdu_c pdu;
+    TESTASSERT(enb.recv_s1ap(pdu));
+    ue_sim_t* ue = nullptr;
+    if (enb.handle_rx_pdu(pdu, ue) == enb_sim::ATTACHED) {
+      nof_attached++;
+    }
+  }
+
+  s1ap*                  s1ap_ptr = s1ap::get_instance();
+  struct sctp_sndrcvinfo sri      = {};
+  std::vector<uint32_t>  nof_shard_ues(nof_workers);
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    const ue_sim_t& ue      = enb.get_ue(i);
+    nas*            nas_ctx = s1ap_ptr->find_nas_ctx_from_mme_ue_s1ap_id(ue.mme_ue_s1ap_id);
+    TESTASSERT(nas_ctx != nullptr);
+    TESTASSERT(nas_ctx->m_emm_ctx.imsi == ue.imsi);
+
+    // The shard that allocated the MME-UE-S1AP-ID owns the context
+    TESTASSERT(nas_ctx->m_shard == ue.mme_ue_s1ap_id % nof_workers);
+    nof_shard_ues[nas_ctx->m_shard]++;
+
+    s1ap_pdu_c pdu;
+    pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_UL_NAS_TRANSPORT);
+    pdu.init_msg().value.ul_nas_transport().protocol_ies.mme_ue_s1ap_id.value = ue.mme_ue_s1ap_id;
+    TESTASSERT(s1ap_ptr->get_rx_pdu_shard(pdu, &sri) == (int)nas_ctx->m_shard);
+    pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_UE_CONTEXT_RELEASE_REQUEST);
+    pdu.init_msg().value.ue_context_release_request().protocol_ies.mme_ue_s1ap_id.value = ue.mme_ue_s1ap_id;
+    TESTASSERT(s1ap_ptr->get_rx_pdu_shard(pdu, &sri) == (int)nas_ctx->m_shard);
+    pdu.set_successful_outcome().load_info_obj(ASN1_S1AP_ID_INIT_CONTEXT_SETUP);
+    pdu.successful_outcome().value.init_context_setup_resp().protocol_ies.mme_ue_s1ap_id.value = ue.mme_ue_s1ap_id;
+    TESTASSERT(s1ap_ptr->get_rx_pdu_shard(pdu, &sri) == (int)nas_ctx->m_shard);
+    pdu.set_successful_outcome().load_info_obj(ASN1_S1AP_ID_UE_CONTEXT_RELEASE);
+    pdu.successful_outcome().value.ue_context_release_complete().protocol_ies.mme_ue_s1ap_id.value =
+        ue.mme_ue_s1ap_id;
+    TESTASSERT(s1ap_ptr->get_rx_pdu_shard(pdu, &sri) == (int)nas_ctx->m_shard);
+  }
+  for (uint32_t shard = 0; shard < nof_workers; ++shard) {
+    TESTASSERT(nof_shard_ues[shard] > 0);
+  }
+
+  // Non-UE-associated signalling stays on the MME thread
+  s1ap_pdu_c pdu;
+  pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_S1_SETUP);
+  TESTASSERT(s1ap_ptr->get_rx_pdu_shard(pdu, &sri) < 0);
+
+  // Detach them all
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    TESTASSERT(enb.send_detach_request(enb.get_ue(i)));
+  }
+  TESTASSERT(run_until(enb, [&enb]() { return all_released(enb); }));
+  return SRSRAN_SUCCESS;
+}
+
+/// Messages of the MME thread and of the shards, and of one UE in several procedures, are handled in arrival order
+int test_ordering(s1mme_loopback& loopback, uint16_t mcc, uint16_t mnc)
+{
+  enb_sim enb(2, mcc, mnc, imsi_base + nof_routing_ues, nof_order_ues, &loopback);
+
+  // The attaches follow the S1 Setup Request without waiting for its response
+  TESTASSERT(enb.open());
+  TESTASSERT(enb.send_s1_setup_request());
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    TESTASSERT(enb.send_attach_request(i));
+  }
+
+  // Every UE detaches as soon as the Attach Complete is sent, racing the S11 Modify Bearer exchange
+  TESTASSERT(run_until(enb, [&enb]() { return all_released(enb); }));
+  TESTASSERT(enb.is_s1_setup_done());
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    TESTASSERT(enb.get_ue(i).done);
+    TESTASSERT(enb.get_ue(i).nof_auth_requests == 1);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/// HSS answers for a context that a retransmitted attach replaced while the HSS was busy are dropped. Only the last
+/// attach of each IMSI completes, and no earlier one gets more than the Authentication Request sent before the
+/// retransmission.
+int test_stale_hss_answers(s1mme_loopback& loopback, uint16_t mcc, uint16_t mnc)
+{
+  enb_sim  enb(3, mcc, mnc, 0, nof_stale_imsis * nof_retx, &loopback);
+  uint64_t first_imsi = imsi_base + nof_routing_ues + nof_order_ues;
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    enb.get_ue(i).imsi = first_imsi + i / nof_retx;
+  }
+  TESTASSERT(enb.connect() == SRSRAN_SUCCESS);
+
+  // All attempts of an IMSI are sent back to back
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    TESTASSERT(enb.send_attach_request(i));
+  }
+  auto last_attempts_released = [&enb]() {
+    for (uint32_t i = nof_retx - 1; i < enb.nof_ues(); i += nof_retx) {
+      if (not enb.get_ue(i).released) {
+        return false;
+      }
+    }
+    return true;
+  };
+  TESTASSERT(run_until(enb, last_attempts_released));
+
+  uint32_t nof_stale_auth_requests = 0;
+  for (uint32_t i = 0; i < enb.nof_ues(); ++i) {
+    const ue_sim_t& ue   = enb.get_ue(i);
+    bool            last = (i % nof_retx) == nof_retx - 1;
+    TESTASSERT(ue.done == last);
+    TESTASSERT(ue.nof_auth_requests <= 1);
+    if (not last) {
+      nof_stale_auth_requests += ue.nof_auth_requests;
+    }
+  }
+  uint32_t nof_dropped = nof_stale_imsis * (nof_retx - 1) - nof_stale_auth_requests;
+  printf("Dropped %d of %d HSS answers for replaced contexts\n", nof_dropped, nof_stale_imsis * (nof_retx - 1));
+  TESTASSERT(nof_dropped > 0);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srslog::init();
+
+  hss_args_t hss_args = {};
+  hss_args.db_file    = "/tmp/mme_s1ap_worker_test_user_db_" + std::to_string(getpid()) + ".csv";
+  TESTASSERT(srsran::string_to_mcc(mcc_str, &hss_args.mcc));
+  TESTASSERT(srsran::string_to_mnc(mnc_str, &hss_args.mnc));
+  TESTASSERT(write_user_db(hss_args.db_file, nof_db_ues) == SRSRAN_SUCCESS);
+
+  mme_args_t mme_args;
+  mme_args.nof_workers     = nof_workers;
+  mme_args.nof_hss_workers = nof_hss_workers;
+  fill_s1ap_args(mme_args.s1ap_args, hss_args.mcc, hss_args.mnc);
+
+  s1mme_loopback loopback;
+  spgw_stub      spgw;
+  TESTASSERT(spgw.start() == SRSRAN_SUCCESS);
+  hss* hss_ptr = hss::get_instance();
+  TESTASSERT(hss_ptr->init(&hss_args) == SRSRAN_SUCCESS);
+  s1ap::get_instance()->set_s1mme_transport(&loopback);
+  mme* mme_ptr = mme::get_instance();
+  TESTASSERT(mme_ptr->init(&mme_args) == SRSRAN_SUCCESS);
+  mme_ptr->start();
+
+  int ret = test_routing(loopback, hss_args.mcc, hss_args.mnc);
+  if (ret == SRSRAN_SUCCESS) {
+    ret = test_ordering(loopback, hss_args.mcc, hss_args.mnc);
+  }
+  if (ret == SRSRAN_SUCCESS) {
+    ret = test_stale_hss_answers(loopback, hss_args.mcc, hss_args.mnc);
+  }
+
+  mme_ptr->stop();
+  mme_ptr->cleanup();
+  spgw.stop();
+  hss_ptr->stop();
+  hss_ptr->cleanup();
+  unlink(hss_args.db_file.c_str());
+  TESTASSERT(ret == SRSRAN_SUCCESS);
+
+  srslog::flush();
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
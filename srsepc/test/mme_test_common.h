@@ -0,0 +1,609 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSEPC_TEST_MME_TEST_COMMON_H
+#define SRSEPC_TEST_MME_TEST_COMMON_H
+
+/*
+ * Simulated peers of the MME for its tests and benchmarks: eNBs with their UEs, which run EPS attaches and detaches
+ * over S1-MME, and a stub SP-GW on S11.
+ */
+
+#include "s1mme_loopback.h"
+#include "srsepc/hdr/mme/mme.h"
+#include "srsran/asn1/liblte_mme.h"
+#include "srsran/asn1/s1ap.h"
+#include "srsran/common/bcd_helpers.h"
+#include "srsran/common/network_utils.h"
+#include "srsran/common/security.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <netinet/sctp.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace srsepc {
+
+using namespace asn1::s1ap;
+using sim_clock = std::chrono::high_resolution_clock;
+
+const char* const mme_addr       = "127.0.1.100";
+const char* const enb_gtpu_addr  = "127.0.2.1";
+const char* const mcc_str        = "001";
+const char* const mnc_str        = "01";
+const uint16_t    tac            = 7;
+const uint64_t    imsi_base      = 1010000000001ULL; // 001010000000001
+const uint8_t     ue_key[16]     = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+const uint8_t     ue_opc[16]     = {0x63, 0xbf, 0xa5, 0x0e, 0xe6, 0x52, 0x33, 0x65,
+                                    0xff, 0x14, 0xc1, 0xf4, 0x5f, 0x88, 0x73, 0x7d};
+const int         rx_timeout_sec = 5;
+
+/// Stub SP-GW: accepts every Create Session and Modify Bearer Request received on S11. Delete Session Requests are
+/// dropped, the MME does not wait for their answer.
+class spgw_stub
+{
+public:
+  ~spgw_stub() { stop(); }
+
+  int start()
+  {
+    fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+      return SRSRAN_ERROR;
+    }
+    struct sockaddr_un addr = make_addr("@spgw_s11");
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+      return SRSRAN_ERROR;
+    }
+    struct timeval tv = {0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    mme_s11_addr = make_addr("@mme_s11");
+    running      = true;
+    t            = std::thread([this]() { run(); });
+    return SRSRAN_SUCCESS;
+  }
+
+  void stop()
+  {
+    running = false;
+    if (t.joinable()) {
+      t.join();
+    }
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+
+private:
+  static struct sockaddr_un make_addr(const char* name)
+  {
+    struct sockaddr_un addr = {};
+    addr.sun_family         = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", name);
+    addr.sun_path[0] = '\0';
+    return addr;
+  }
+
+  void run()
+  {
+    srsran::gtpc_pdu req, resp;
+    while (running) {
+      if (recv(fd, &req, sizeof(req), 0) != sizeof(req)) {
+        continue;
+      }
+      std::memset(&resp, 0, sizeof(resp));
+      resp.header.teid_present = true;
+      if (req.header.type == srsran::GTPC_MSG_TYPE_CREATE_SESSION_REQUEST) {
+        // The MME control TEID is reused as the SP-GW one
+        srsran::gtpc_create_session_response* cs_resp = &resp.choice.create_session_response;
+        resp.header.type                              = srsran::GTPC_MSG_TYPE_CREATE_SESSION_RESPONSE;
+        resp.header.teid                              = req.choice.create_session_request.sender_f_teid.teid;
+        cs_resp->cause.cause_value                    = srsran::GTPC_CAUSE_VALUE_REQUEST_ACCEPTED;
+        cs_resp->eps_bearer_context_created.ebi       = 5;
+        cs_resp->eps_bearer_context_created.s1_u_sgw_f_teid_present = true;
+        cs_resp->eps_bearer_context_created.s1_u_sgw_f_teid.teid    = resp.header.teid;
+        inet_pton(AF_INET, mme_addr, &cs_resp->eps_bearer_context_created.s1_u_sgw_f_teid.ipv4);
+        cs_resp->paa_present  = true;
+        cs_resp->paa.pdn_type = srsran::GTPC_PDN_TYPE_IPV4;
+        cs_resp->paa.ipv4     = htonl(0xac100000 + ++nof_sessions); // 172.16.0.0/12
+      } else if (req.header.type == srsran::GTPC_MSG_TYPE_MODIFY_BEARER_REQUEST) {
+        resp.header.type = srsran::GTPC_MSG_TYPE_MODIFY_BEARER_RESPONSE;
+        resp.header.teid = req.header.teid;
+        resp.choice.modify_bearer_response.cause.cause_value = srsran::GTPC_CAUSE_VALUE_REQUEST_ACCEPTED;
+        resp.choice.modify_bearer_response.eps_bearer_context_modified.ebi =
+            req.choice.modify_bearer_request.eps_bearer_context_to_modify.ebi;
+      } else {
+        continue;
+      }
+      sendto(fd, &resp, sizeof(resp), 0, (struct sockaddr*)&mme_s11_addr, sizeof(mme_s11_addr));
+    }
+  }
+
+  int                fd           = -1;
+  struct sockaddr_un mme_s11_addr = {};
+  uint32_t           nof_sessions = 0;
+  std::atomic<bool>  running{false};
+  std::thread        t;
+};
+
+/// Simulated UE: USIM keys and the NAS security context built during the attach.
+struct ue_sim_t {
+  uint64_t              imsi              = 0;
+  uint32_t              mme_ue_s1ap_id    = 0;
+  uint8_t               k_nas_enc[32]     = {};
+  uint8_t               k_nas_int[32]     = {};
+  uint32_t              ul_count          = 0;
+  uint32_t              nof_auth_requests = 0;
+  bool                  done              = false; // attached
+  bool                  released          = false; // detached and S1 context released
+  sim_clock::time_point tstart;
+  sim_clock::time_point tdetach;
+};
+
+/// Simulated eNB with its UEs. The UE index doubles as eNB-UE-S1AP-ID. The eNB answers the MME on behalf of its UEs
+/// in handle_rx_pdu(), so that callers only decide when UEs attach and detach.
+class enb_sim
+{
+public:
+  /// What a message of the MME did to one of the UEs
+  enum event_t { NONE, AUTH_REQUEST, ATTACHED, RELEASED };
+
+  enb_sim(uint32_t        enb_id_,
+          uint16_t        mcc_,
+          uint16_t        mnc_,
+          uint64_t        first_imsi,
+          uint32_t        nof_ues,
+          s1mme_loopback* loopback_ = nullptr) :
+    enb_id(enb_id_), mcc(mcc_), mnc(mnc_), loopback(loopback_), ues(nof_ues)
+  {
+    for (uint32_t i = 0; i < nof_ues; ++i) {
+      ues[i].imsi = first_imsi + i;
+    }
+    srsran::s1ap_mccmnc_to_plmn(mcc, mnc, &plmn);
+    plmn = htonl(plmn);
+  }
+
+  /// Opens the association and completes the S1 Setup
+  int connect()
+  {
+    if (not open() or not send_s1_setup_request()) {
+      return SRSRAN_ERROR;
+    }
+    s1ap_pdu_c pdu;
+    while (recv_s1ap(pdu)) {
+      ue_sim_t* ue = nullptr;
+      handle_rx_pdu(pdu, ue);
+      if (s1_setup_done) {
+        return SRSRAN_SUCCESS;
+      }
+    }
+    return SRSRAN_ERROR;
+  }
+
+  bool open()
+  {
+    using namespace srsran::net_utils;
+    if (loopback != nullptr) {
+      assoc_id = loopback->connect();
+      return true;
+    }
+    if (not sctp_init_socket(&sock, socket_type::seqpacket, "127.0.0.1", 0) or
+        not sock.connect_to(mme_addr, S1MME_PORT)) {
+      return false;
+    }
+    struct timeval tv = {rx_timeout_sec, 0};
+    setsockopt(sock.fd(), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return true;
+  }
+
+  bool send_s1_setup_request()
+  {
+    s1ap_pdu_c pdu;
+    pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_S1_SETUP);
+    s1_setup_request_ies_container& container = pdu.init_msg().value.s1_setup_request().protocol_ies;
+    set_plmn(container.global_enb_id.value.plm_nid.data());
+    container.global_enb_id.value.enb_id.set_macro_enb_id().from_number(enb_id);
+    container.supported_tas.value.resize(1);
+    uint16_t tmp16 = htons(tac);
+    memcpy(container.supported_tas.value[0].tac.data(), (uint8_t*)&tmp16, 2);
+    container.supported_tas.value[0].broadcast_plmns.resize(1);
+    set_plmn(container.supported_tas.value[0].broadcast_plmns[0].data());
+    container.default_paging_drx.value.value = paging_drx_opts::v128;
+    return send_s1ap(pdu);
+  }
+
+  /// Receives the next message of the MME. Returns false after rx_timeout_sec without one
+  bool recv_s1ap(s1ap_pdu_c& pdu)
+  {
+    uint8_t                buf[2048];
+    struct sctp_sndrcvinfo sri   = {};
+    int                    flags = 0;
+    while (true) {
+      int n = loopback != nullptr ? loopback->recv(assoc_id, buf, sizeof(buf), std::chrono::seconds(rx_timeout_sec))
+                                  : sctp_recvmsg(sock.fd(), buf, sizeof(buf), nullptr, nullptr, &sri, &flags);
+      if (n <= 0) {
+        return false;
+      }
+      if (flags & MSG_NOTIFICATION) {
+        continue;
+      }
+      asn1::cbit_ref bref(buf, n);
+      return pdu.unpack(bref) == asn1::SRSASN_SUCCESS;
+    }
+  }
+
+  /// Answers a message of the MME. Returns what it did to the UE it was addressed to, which is returned in ue.
+  event_t handle_rx_pdu(const s1ap_pdu_c& pdu, ue_sim_t*& ue)
+  {
+    ue = nullptr;
+    if (pdu.type().value == s1ap_pdu_c::types_opts::successful_outcome and
+        pdu.successful_outcome().value.type().value ==
+            s1ap_elem_procs_o::successful_outcome_c::types_opts::s1_setup_resp) {
+      s1_setup_done = true;
+      return NONE;
+    }
+    if (pdu.type().value != s1ap_pdu_c::types_opts::init_msg) {
+      return NONE;
+    }
+    const s1ap_elem_procs_o::init_msg_c& msg = pdu.init_msg().value;
+    if (msg.type().value == s1ap_elem_procs_o::init_msg_c::types_opts::dl_nas_transport) {
+      const dl_nas_transport_ies_container& c = msg.dl_nas_transport().protocol_ies;
+      ue                                      = find_ue(c.enb_ue_s1ap_id.value.value);
+      if (ue == nullptr or ue->done) {
+        return NONE;
+      }
+      ue->mme_ue_s1ap_id = c.mme_ue_s1ap_id.value.value;
+      return handle_dl_nas(*ue, c.nas_pdu.value.data(), c.nas_pdu.value.size());
+    }
+    if (msg.type().value == s1ap_elem_procs_o::init_msg_c::types_opts::ue_context_release_cmd) {
+      const ue_s1ap_ids_c& ids = msg.ue_context_release_cmd().protocol_ies.ue_s1ap_ids.value;
+      if (ids.type().value != ue_s1ap_ids_c::types_opts::ue_s1ap_id_pair) {
+        return NONE;
+      }
+      ue = find_ue(ids.ue_s1ap_id_pair().enb_ue_s1ap_id);
+      if (ue == nullptr) {
+        return NONE;
+      }
+      send_ue_context_release_complete(ids.ue_s1ap_id_pair().enb_ue_s1ap_id);
+      if (not ue->done or ue->released) {
+        return NONE;
+      }
+      ue->released = true;
+      return RELEASED;
+    }
+    if (msg.type().value == s1ap_elem_procs_o::init_msg_c::types_opts::init_context_setup_request) {
+      const init_context_setup_request_ies_container& c = msg.init_context_setup_request().protocol_ies;
+      ue                                                = find_ue(c.enb_ue_s1ap_id.value.value);
+      if (ue == nullptr or c.erab_to_be_setup_list_ctxt_su_req.value.size() == 0) {
+        return NONE;
+      }
+      const erab_to_be_setup_item_ctxt_su_req_s& erab =
+          c.erab_to_be_setup_list_ctxt_su_req.value[0].value.erab_to_be_setup_item_ctxt_su_req();
+      send_initial_context_setup_response(c.enb_ue_s1ap_id.value.value, erab.erab_id);
+      if (erab.nas_pdu_present) {
+        return handle_dl_nas(*ue, erab.nas_pdu.data(), erab.nas_pdu.size());
+      }
+    }
+    return NONE;
+  }
+
+  bool send_attach_request(uint32_t ue_idx)
+  {
+    ue_sim_t& ue = ues[ue_idx];
+    ue.tstart    = sim_clock::now();
+
+    LIBLTE_MME_ATTACH_REQUEST_MSG_STRUCT attach_req = {};
+    attach_req.eps_attach_type                      = LIBLTE_MME_EPS_ATTACH_TYPE_EPS_ATTACH;
+    for (uint32_t i = 0; i < 8; ++i) {
+      attach_req.ue_network_cap.eea[i] = i < 3;
+      attach_req.ue_network_cap.eia[i] = i < 3;
+    }
+    attach_req.eps_mobile_id.type_of_id = LIBLTE_MME_EPS_MOBILE_ID_TYPE_IMSI;
+    uint64_t imsi                       = ue.imsi;
+    for (int i = 14; i >= 0; --i) {
+      attach_req.eps_mobile_id.imsi[i] = imsi % 10;
+      imsi /= 10;
+    }
+    attach_req.nas_ksi.nas_ksi = LIBLTE_MME_NAS_KEY_SET_IDENTIFIER_NO_KEY_AVAILABLE;
+
+    LIBLTE_MME_PDN_CONNECTIVITY_REQUEST_MSG_STRUCT pdn_con_req = {};
+    pdn_con_req.eps_bearer_id                                  = 0;
+    pdn_con_req.proc_transaction_id                            = 1;
+    pdn_con_req.request_type                                   = LIBLTE_MME_REQUEST_TYPE_INITIAL_REQUEST;
+    pdn_con_req.pdn_type                                       = LIBLTE_MME_PDN_TYPE_IPV4;
+    liblte_mme_pack_pdn_connectivity_request_msg(&pdn_con_req, &attach_req.esm_msg);
+
+    LIBLTE_BYTE_MSG_STRUCT nas = {};
+    if (liblte_mme_pack_attach_request_msg(&attach_req, &nas) != LIBLTE_SUCCESS) {
+      return false;
+    }
+    return send_nas(ue_idx, nas, true);
+  }
+
+  /// Switch-off detach, the MME answers it with the UE Context Release Command only.
+  bool send_detach_request(ue_sim_t& ue)
+  {
+    ue.tdetach = sim_clock::now();
+
+    LIBLTE_MME_DETACH_REQUEST_MSG_STRUCT detach_req = {};
+    detach_req.detach_type.switch_off               = LIBLTE_MME_SO_FLAG_SWITCH_OFF;
+    detach_req.detach_type.type_of_detach           = LIBLTE_MME_TOD_UL_EPS_DETACH;
+    detach_req.nas_ksi.tsc_flag                     = LIBLTE_MME_TYPE_OF_SECURITY_CONTEXT_FLAG_NATIVE;
+    detach_req.nas_ksi.nas_ksi                      = 0;
+    detach_req.eps_mobile_id.type_of_id             = LIBLTE_MME_EPS_MOBILE_ID_TYPE_IMSI;
+    uint64_t imsi                                   = ue.imsi;
+    for (int i = 14; i >= 0; --i) {
+      detach_req.eps_mobile_id.imsi[i] = imsi % 10;
+      imsi /= 10;
+    }
+
+    LIBLTE_BYTE_MSG_STRUCT nas = {};
+    if (liblte_mme_pack_detach_request_msg(
+            &detach_req, LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY_AND_CIPHERED, ue.ul_count, &nas) != LIBLTE_SUCCESS) {
+      return false;
+    }
+    protect_nas(ue, nas);
+    return send_nas(&ue - &ues[0], nas, false);
+  }
+
+  ue_sim_t& get_ue(uint32_t enb_ue_s1ap_id) { return ues[enb_ue_s1ap_id]; }
+  uint32_t  nof_ues() const { return ues.size(); }
+  bool      is_s1_setup_done() const { return s1_setup_done; }
+
+private:
+  void set_plmn(uint8_t* plm_nid)
+  {
+    plm_nid[0] = ((uint8_t*)&plmn)[1];
+    plm_nid[1] = ((uint8_t*)&plmn)[2];
+    plm_nid[2] = ((uint8_t*)&plmn)[3];
+  }
+
+  ue_sim_t* find_ue(uint32_t enb_ue_s1ap_id) { return enb_ue_s1ap_id < ues.size() ? &ues[enb_ue_s1ap_id] : nullptr; }
+
+  bool send_s1ap(const s1ap_pdu_c& pdu)
+  {
+    uint8_t       buf[2048];
+    asn1::bit_ref bref(buf, sizeof(buf));
+    if (pdu.pack(bref) != asn1::SRSASN_SUCCESS) {
+      return false;
+    }
+    if (loopback != nullptr) {
+      return loopback->send(assoc_id, buf, bref.distance_bytes());
+    }
+    return sctp_sendmsg(sock.fd(),
+                        buf,
+                        bref.distance_bytes(),
+                        nullptr,
+                        0,
+                        htonl((uint32_t)srsran::net_utils::ppid_values::S1AP),
+                        0,
+                        0,
+                        0,
+                        0) > 0;
+  }
+
+  bool send_nas(uint32_t enb_ue_s1ap_id, const LIBLTE_BYTE_MSG_STRUCT& nas, bool initial)
+  {
+    s1ap_pdu_c pdu;
+    if (initial) {
+      pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_INIT_UE_MSG);
+      init_ue_msg_ies_container& c = pdu.init_msg().value.init_ue_msg().protocol_ies;
+      c.enb_ue_s1ap_id.value       = enb_ue_s1ap_id;
+      c.nas_pdu.value.resize(nas.N_bytes);
+      memcpy(c.nas_pdu.value.data(), nas.msg, nas.N_bytes);
+      fill_tai_cgi(c.tai.value, c.eutran_cgi.value);
+      c.rrc_establishment_cause.value = rrc_establishment_cause_opts::mo_sig;
+    } else {
+      pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_UL_NAS_TRANSPORT);
+      ul_nas_transport_ies_container& c = pdu.init_msg().value.ul_nas_transport().protocol_ies;
+      c.mme_ue_s1ap_id.value            = ues[enb_ue_s1ap_id].mme_ue_s1ap_id;
+      c.enb_ue_s1ap_id.value            = enb_ue_s1ap_id;
+      c.nas_pdu.value.resize(nas.N_bytes);
+      memcpy(c.nas_pdu.value.data(), nas.msg, nas.N_bytes);
+      fill_tai_cgi(c.tai.value, c.eutran_cgi.value);
+    }
+    return send_s1ap(pdu);
+  }
+
+  void fill_tai_cgi(tai_s& tai, eutran_cgi_s& cgi)
+  {
+    uint16_t tmp16 = htons(tac);
+    set_plmn(tai.plm_nid.data());
+    memcpy(tai.tac.data(), (uint8_t*)&tmp16, 2);
+    set_plmn(cgi.plm_nid.data());
+    cgi.cell_id.from_number(enb_id << 8U);
+  }
+
+  void send_initial_context_setup_response(uint32_t enb_ue_s1ap_id, uint8_t erab_id)
+  {
+    s1ap_pdu_c pdu;
+    pdu.set_successful_outcome().load_info_obj(ASN1_S1AP_ID_INIT_CONTEXT_SETUP);
+    init_context_setup_resp_ies_container& c = pdu.successful_outcome().value.init_context_setup_resp().protocol_ies;
+    c.mme_ue_s1ap_id.value                   = ues[enb_ue_s1ap_id].mme_ue_s1ap_id;
+    c.enb_ue_s1ap_id.value                   = enb_ue_s1ap_id;
+    c.erab_setup_list_ctxt_su_res.value.resize(1);
+    c.erab_setup_list_ctxt_su_res.value[0].load_info_obj(ASN1_S1AP_ID_ERAB_SETUP_ITEM_CTXT_SU_RES);
+    erab_setup_item_ctxt_su_res_s& item = c.erab_setup_list_ctxt_su_res.value[0].value.erab_setup_item_ctxt_su_res();
+    item.erab_id                        = erab_id;
+    in_addr_t addr;
+    inet_pton(AF_INET, enb_gtpu_addr, &addr);
+    item.transport_layer_address.resize(32);
+    asn1::bitstring_utils::from_number(item.transport_layer_address.data(), ntohl(addr), 32);
+    item.gtp_teid.from_number((enb_id << 16U) | enb_ue_s1ap_id);
+    send_s1ap(pdu);
+  }
+
+  void send_ue_context_release_complete(uint32_t enb_ue_s1ap_id)
+  {
+    s1ap_pdu_c pdu;
+    pdu.set_successful_outcome().load_info_obj(ASN1_S1AP_ID_UE_CONTEXT_RELEASE);
+    ue_context_release_complete_ies_container& c =
+        pdu.successful_outcome().value.ue_context_release_complete().protocol_ies;
+    c.mme_ue_s1ap_id.value = ues[enb_ue_s1ap_id].mme_ue_s1ap_id;
+    c.enb_ue_s1ap_id.value = enb_ue_s1ap_id;
+    send_s1ap(pdu);
+  }
+
+  /// Integrity protects an uplink NAS message packed with a security header and steps the uplink count.
+  void protect_nas(ue_sim_t& ue, LIBLTE_BYTE_MSG_STRUCT& nas)
+  {
+    srsran::security_128_eia2(&ue.k_nas_int[16],
+                              ue.ul_count,
+                              0,
+                              srsran::SECURITY_DIRECTION_UPLINK,
+                              &nas.msg[5],
+                              nas.N_bytes - 5,
+                              &nas.msg[1]);
+    ue.ul_count++;
+  }
+
+  event_t handle_dl_nas(ue_sim_t& ue, const uint8_t* data, uint32_t len)
+  {
+    LIBLTE_BYTE_MSG_STRUCT rx = {};
+    LIBLTE_BYTE_MSG_STRUCT tx = {};
+    uint8_t                pd, msg_type;
+    uint32_t               enb_ue_s1ap_id = &ue - &ues[0];
+    if (len > sizeof(rx.msg)) {
+      return NONE;
+    }
+    memcpy(rx.msg, data, len);
+    rx.N_bytes = len;
+    liblte_mme_parse_msg_header(&rx, &pd, &msg_type);
+
+    switch (msg_type) {
+      case LIBLTE_MME_MSG_TYPE_AUTHENTICATION_REQUEST: {
+        LIBLTE_MME_AUTHENTICATION_REQUEST_MSG_STRUCT auth_req = {};
+        if (liblte_mme_unpack_authentication_request_msg(&rx, &auth_req) != LIBLTE_SUCCESS) {
+          return NONE;
+        }
+        // USIM side of the AKA, same key derivation as the HSS
+        LIBLTE_MME_AUTHENTICATION_RESPONSE_MSG_STRUCT auth_resp = {};
+        uint8_t                                       k[16], opc[16], ck[16], ik[16], ak[6], k_asme[32];
+        memcpy(k, ue_key, sizeof(k));
+        memcpy(opc, ue_opc, sizeof(opc));
+        srsran::security_milenage_f2345(k, opc, auth_req.rand, auth_resp.res, ck, ik, ak);
+        srsran::security_generate_k_asme(ck, ik, auth_req.autn, mcc, mnc, k_asme);
+        srsran::security_generate_k_nas(k_asme,
+                                        srsran::CIPHERING_ALGORITHM_ID_EEA0,
+                                        srsran::INTEGRITY_ALGORITHM_ID_128_EIA2,
+                                        ue.k_nas_enc,
+                                        ue.k_nas_int);
+        auth_resp.res_len = 8;
+        liblte_mme_pack_authentication_response_msg(&auth_resp, LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS, 0, &tx);
+        send_nas(enb_ue_s1ap_id, tx, false);
+        ue.nof_auth_requests++;
+        return AUTH_REQUEST;
+      }
+      case LIBLTE_MME_MSG_TYPE_SECURITY_MODE_COMMAND: {
+        LIBLTE_MME_SECURITY_MODE_COMPLETE_MSG_STRUCT sm_comp = {};
+        ue.ul_count                                          = 0;
+        liblte_mme_pack_security_mode_complete_msg(
+            &sm_comp, LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY_AND_CIPHERED_WITH_NEW_EPS_SECURITY_CONTEXT, ue.ul_count, &tx);
+        protect_nas(ue, tx);
+        send_nas(enb_ue_s1ap_id, tx, false);
+        break;
+      }
+      case LIBLTE_MME_MSG_TYPE_ATTACH_ACCEPT: {
+        LIBLTE_MME_ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT_MSG_STRUCT act_bearer  = {};
+        LIBLTE_MME_ATTACH_COMPLETE_MSG_STRUCT                            attach_comp = {};
+        act_bearer.eps_bearer_id                                                     = 5;
+        act_bearer.proc_transaction_id                                               = 1;
+        liblte_mme_pack_activate_default_eps_bearer_context_accept_msg(&act_bearer, &attach_comp.esm_msg);
+        liblte_mme_pack_attach_complete_msg(
+            &attach_comp, LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY_AND_CIPHERED, ue.ul_count, &tx);
+        protect_nas(ue, tx);
+        send_nas(enb_ue_s1ap_id, tx, false);
+        break;
+      }
+      case LIBLTE_MME_MSG_TYPE_EMM_INFORMATION:
+        // Sent by the MME once the Attach Complete has been accepted
+        if (ue.done) {
+          return NONE;
+        }
+        ue.done = true;
+        return ATTACHED;
+      default:
+        break;
+    }
+    return NONE;
+  }
+
+  uint32_t              enb_id;
+  uint16_t              mcc;
+  uint16_t              mnc;
+  uint32_t              plmn          = 0;
+  s1mme_loopback*       loopback      = nullptr;
+  int                   assoc_id      = 0;
+  bool                  s1_setup_done = false;
+  srsran::unique_socket sock;
+  std::vector<ue_sim_t> ues;
+};
+
+
+/// MME configuration the simulated eNBs connect to
+inline void fill_s1ap_args(s1ap_args_t& s1ap, uint16_t mcc, uint16_t mnc)
+{
+  s1ap.mme_code        = 0x1a;
+  s1ap.mme_group       = 1;
+  s1ap.tac             = tac;
+  s1ap.mcc             = mcc;
+  s1ap.mnc             = mnc;
+  s1ap.paging_timer    = 2;
+  s1ap.mme_bind_addr   = mme_addr;
+  s1ap.mme_name        = "srsmme01";
+  s1ap.dns_addr        = "8.8.8.8";
+  s1ap.full_net_name   = "Software Radio Systems RAN";
+  s1ap.short_net_name  = "srsRAN";
+  s1ap.mme_apn         = "srsapn";
+  s1ap.pcap_enable     = false;
+  s1ap.encryption_algo = srsran::CIPHERING_ALGORITHM_ID_EEA0;
+  s1ap.integrity_algo  = srsran::INTEGRITY_ALGORITHM_ID_128_EIA2;
+  s1ap.request_imeisv  = false;
+}
+
+/// HSS user database with nof_ues subscribers from imsi_base on, all with the keys of the simulated UEs
+inline int write_user_db(const std::string& filename, uint32_t nof_ues)
+{
+  std::ofstream db(filename);
+  if (not db.is_open()) {
+    return SRSRAN_ERROR;
+  }
+  char key[33], opc[33];
+  for (uint32_t i = 0; i < 16; ++i) {
+    snprintf(&key[2 * i], 3, "%02x", ue_key[i]);
+    snprintf(&opc[2 * i], 3, "%02x", ue_opc[i]);
+  }
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    db << "ue" << i << ",mil," << std::setfill('0') << std::setw(15) << imsi_base + i << "," << key << ",opc," << opc
+       << ",8000,000000001234,7,dynamic\n";
+  }
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsepc
+
+#endif // SRSEPC_TEST_MME_TEST_COMMON_H
@@ -0,0 +1,184 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSEPC_TEST_S1MME_LOOPBACK_H
+#define SRSEPC_TEST_S1MME_LOOPBACK_H
+
+#include "srsepc/hdr/mme/s1ap_common.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+
+namespace srsepc {
+
+/// In-process S1-MME associations, so that the MME can be tested without kernel SCTP. Messages keep their order per
+/// direction and association, as on an SCTP stream. The eventfd counts the uplink messages the MME has not read yet.
+class s1mme_loopback : public s1mme_transport_interface
+{
+public:
+  s1mme_loopback() { efd = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK); }
+  ~s1mme_loopback()
+  {
+    if (efd >= 0) {
+      close(efd);
+    }
+  }
+  s1mme_loopback(const s1mme_loopback&) = delete;
+  s1mme_loopback& operator=(const s1mme_loopback&) = delete;
+
+  // MME side
+  int get_fd() override { return efd; }
+
+  int recv_msg(uint8_t* buf, uint32_t len, struct sctp_sndrcvinfo* sri, int* msg_flags) override
+  {
+    uint64_t count;
+    if (read(efd, &count, sizeof(count)) != sizeof(count)) {
+      errno = EAGAIN;
+      return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    msg_t                       msg = std::move(ul_msgs.front());
+    ul_msgs.pop_front();
+    uint32_t n = std::min(len, (uint32_t)msg.data.size());
+    memcpy(buf, msg.data.data(), n);
+    *sri                = {};
+    sri->sinfo_assoc_id = msg.assoc_id;
+    sri->sinfo_stream   = msg.stream;
+    *msg_flags          = msg.flags;
+    return n;
+  }
+
+  int send_msg(const uint8_t* buf, uint32_t len, const struct sctp_sndrcvinfo* sri) override
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto                        it = assocs.find(sri->sinfo_assoc_id);
+    if (it == assocs.end() or it->second.closed) {
+      errno = EPIPE;
+      return -1;
+    }
+    it->second.dl_msgs.emplace_back(buf, buf + len);
+    nof_dl_msgs++;
+    cvar.notify_all();
+    return len;
+  }
+
+  // eNB side. Returns the association id
+  int connect()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    int                         assoc_id = next_assoc_id++;
+    assocs[assoc_id];
+    return assoc_id;
+  }
+
+  bool send(int assoc_id, const uint8_t* buf, uint32_t len, uint16_t stream = 0)
+  {
+    return push_ul(assoc_id, std::vector<uint8_t>(buf, buf + len), stream, 0);
+  }
+
+  /// Receives the next downlink message of the association. Returns -1 after the timeout, or if the association is
+  /// shut down and drained.
+  int recv(int assoc_id, uint8_t* buf, uint32_t len, std::chrono::milliseconds timeout)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto                         it = assocs.find(assoc_id);
+    if (it == assocs.end()) {
+      return -1;
+    }
+    assoc_t& assoc = it->second;
+    if (not cvar.wait_for(lock, timeout, [&assoc]() { return not assoc.dl_msgs.empty() or assoc.closed; }) or
+        assoc.dl_msgs.empty()) {
+      return -1;
+    }
+    std::vector<uint8_t> msg = std::move(assoc.dl_msgs.front());
+    assoc.dl_msgs.pop_front();
+    uint32_t n = std::min(len, (uint32_t)msg.size());
+    memcpy(buf, msg.data(), n);
+    return n;
+  }
+
+  /// Shuts the association down. The MME gets the SCTP_SHUTDOWN_EVENT after the messages already sent.
+  void shutdown(int assoc_id)
+  {
+    union sctp_notification notification = {};
+    notification.sn_header.sn_type       = SCTP_SHUTDOWN_EVENT;
+    notification.sn_header.sn_length     = sizeof(notification.sn_shutdown_event);
+    const uint8_t* ptr                   = (const uint8_t*)&notification;
+    push_ul(assoc_id, std::vector<uint8_t>(ptr, ptr + sizeof(notification)), 0, MSG_NOTIFICATION);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    assocs[assoc_id].closed = true;
+    cvar.notify_all();
+  }
+
+  /// Number of downlink messages sent by the MME on all associations
+  uint64_t get_nof_dl_msgs()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nof_dl_msgs;
+  }
+
+private:
+  struct msg_t {
+    int                  assoc_id;
+    uint16_t             stream;
+    int                  flags;
+    std::vector<uint8_t> data;
+  };
+  struct assoc_t {
+    std::deque<std::vector<uint8_t> > dl_msgs;
+    bool                              closed = false;
+  };
+
+  bool push_ul(int assoc_id, std::vector<uint8_t> data, uint16_t stream, int flags)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto                        it = assocs.find(assoc_id);
+      if (it == assocs.end() or it->second.closed) {
+        return false;
+      }
+      ul_msgs.push_back({assoc_id, stream, flags, std::move(data)});
+    }
+    uint64_t one = 1;
+    return write(efd, &one, sizeof(one)) == sizeof(one);
+  }
+
+  int                     efd = -1;
+  std::mutex              mutex;
+  std::condition_variable cvar;
+  std::deque<msg_t>       ul_msgs;
+  std::map<int, assoc_t>  assocs;
+  int                     next_assoc_id = 1;
+  uint64_t                nof_dl_msgs   = 0;
+};
+
+} // namespace srsepc
+
+#endif // SRSEPC_TEST_S1MME_LOOPBACK_H
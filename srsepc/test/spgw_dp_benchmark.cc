@@ -0,0 +1,346 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Loopback throughput benchmark of the SP-GW data-plane workers. The SGi TUN queues are replaced by datagram
+ * socketpairs (same one-packet-per-read semantics), and the eNB is a UDP socket on the loopback interface.
+ */
+
+#include "srsepc/hdr/spgw/gtpu_dp.h"
+#include "srsepc/hdr/spgw/spgw.h"
+#include "srsran/common/test_common.h"
+#include "srsran/upper/gtpu.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <getopt.h>
+#include <linux/ip.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+const char*    spgw_addr  = "127.0.1.100";
+const char*    enb_addr   = "127.0.2.1";
+const uint32_t ue_ip_base = 0xac100000; // 172.16.0.0
+const uint32_t nof_ues    = 64;
+
+struct bench_args_t {
+  uint32_t nof_pkts = 20000;
+  uint32_t pkt_size = 1400;
+};
+
+struct bench_result_t {
+  uint32_t sent     = 0;
+  uint32_t received = 0;
+  uint64_t syscalls = 0;
+  double   elapsed_s;
+};
+
+/// Static tunnel table: UE i has TEID i + 1 towards the loopback eNB.
+class dummy_gtpu : public srsepc::gtpu_dp_interface
+{
+public:
+  bool resolve_ul_tunnel(uint32_t spgw_usr_teid, in_addr_t* ue_ipv4) override
+  {
+    if (spgw_usr_teid == 0 or spgw_usr_teid > nof_ues) {
+      return false;
+    }
+    *ue_ipv4 = htonl(ue_ip_base + spgw_usr_teid - 1);
+    return true;
+  }
+  dl_action resolve_dl_tunnel(in_addr_t ue_ipv4, srsran::gtp_fteid_t* enb_fteid, uint32_t* spgw_ctr_teid) override
+  {
+    uint32_t ue_idx = ntohl(ue_ipv4) - ue_ip_base;
+    if (ue_idx >= nof_ues) {
+      return dl_action::drop;
+    }
+    enb_fteid->teid = ue_idx + 1;
+    inet_pton(AF_INET, enb_addr, &enb_fteid->ipv4);
+    return dl_action::forward;
+  }
+  void handle_dl_paging(uint32_t spgw_ctr_teid, srsran::unique_byte_buffer_t msg) override { nof_paged++; }
+
+  std::atomic<uint32_t> nof_paged{0};
+};
+
+void fill_ip_pkt(uint8_t* pkt, uint32_t len, uint32_t ue_idx, uint32_t seq)
+{
+  memset(pkt, 0, len);
+  struct iphdr* iph = (struct iphdr*)pkt;
+  iph->version      = 4;
+  iph->ihl          = 5;
+  iph->tot_len      = htons(len);
+  iph->daddr        = htonl(ue_ip_base + ue_idx);
+  memcpy(pkt + sizeof(struct iphdr), &seq, sizeof(seq));
+}
+
+int open_udp_socket(const char* addr, uint16_t port)
+{
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int rcvbuf = 8 * 1024 * 1024;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  struct timeval tv = {1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  struct sockaddr_in sa = {};
+  sa.sin_family         = AF_INET;
+  sa.sin_port           = htons(port);
+  inet_pton(AF_INET, addr, &sa.sin_addr);
+  if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// Workers with their SGi socketpairs and S1-U socket group.
+struct dp_setup {
+  dummy_gtpu                                           gtpu;
+  std::vector<int>                                     sgi_fds;
+  std::vector<int>                                     sgi_peer;
+  std::vector<int>                                     s1u_socks;
+  std::vector<std::unique_ptr<srsepc::gtpu_dp_worker> > workers;
+
+  int init(uint32_t nof_workers, uint32_t batch_size)
+  {
+    struct sockaddr_in sa = {};
+    sa.sin_family         = AF_INET;
+    sa.sin_port           = htons(srsepc::GTPU_RX_PORT);
+    inet_pton(AF_INET, spgw_addr, &sa.sin_addr);
+    TESTASSERT(srsepc::gtpu_dp_open_s1u_sockets(sa, nof_workers, s1u_socks) == SRSRAN_SUCCESS);
+
+    for (uint32_t i = 0; i < nof_workers; ++i) {
+      int sv[2];
+      TESTASSERT(socketpair(AF_UNIX, SOCK_DGRAM, 0, sv) == 0);
+      struct timeval tv = {1, 0};
+      setsockopt(sv[1], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      sgi_fds.push_back(sv[0]);
+      sgi_peer.push_back(sv[1]);
+
+      std::unique_ptr<srsepc::gtpu_dp_worker> w(new srsepc::gtpu_dp_worker(i, &gtpu));
+      TESTASSERT(w->init(sv[0], s1u_socks[i], batch_size) == SRSRAN_SUCCESS);
+      TESTASSERT(w->start_worker());
+      workers.push_back(std::move(w));
+    }
+    return SRSRAN_SUCCESS;
+  }
+
+  uint64_t nof_syscalls() const
+  {
+    uint64_t n = 0;
+    for (const auto& w : workers) {
+      n += w->get_metrics().nof_syscalls;
+    }
+    return n;
+  }
+
+  ~dp_setup()
+  {
+    for (auto& w : workers) {
+      w->stop();
+    }
+    workers.clear();
+    for (int fd : s1u_socks) {
+      close(fd);
+    }
+    for (uint32_t i = 0; i < sgi_fds.size(); ++i) {
+      close(sgi_fds[i]);
+      close(sgi_peer[i]);
+    }
+  }
+};
+
+int run_dl(const bench_args_t& args, uint32_t nof_workers, uint32_t batch_size, bench_result_t& res)
+{
+  dp_setup setup;
+  TESTASSERT(setup.init(nof_workers, batch_size) == SRSRAN_SUCCESS);
+  int enb_fd = open_udp_socket(enb_addr, srsepc::GTPU_RX_PORT);
+  TESTASSERT(enb_fd >= 0);
+
+  std::vector<uint8_t> rx_buf(args.pkt_size + 64);
+  auto                 tstart = std::chrono::high_resolution_clock::now();
+  auto                 tend   = tstart;
+  std::thread          rx_thread([&]() {
+    while (res.received < args.nof_pkts) {
+      ssize_t n = recv(enb_fd, rx_buf.data(), rx_buf.size(), 0);
+      if (n <= 0) {
+        break;
+      }
+      // Check the tunnel the packet was sent through
+      uint32_t teid;
+      memcpy(&teid, &rx_buf[4], sizeof(teid));
+      struct iphdr* iph = (struct iphdr*)&rx_buf[GTPU_BASE_HEADER_LEN];
+      if (n != (ssize_t)(args.pkt_size + GTPU_BASE_HEADER_LEN) or
+          ntohl(teid) != ntohl(iph->daddr) - ue_ip_base + 1) {
+        srsran::console("Wrong DL packet received\n");
+        break;
+      }
+      res.received++;
+      tend = std::chrono::high_resolution_clock::now();
+    }
+  });
+
+  std::vector<uint8_t> pkt(args.pkt_size);
+  for (uint32_t i = 0; i < args.nof_pkts; ++i) {
+    fill_ip_pkt(pkt.data(), args.pkt_size, i % nof_ues, i);
+    if (write(setup.sgi_peer[i % nof_workers], pkt.data(), pkt.size()) == (ssize_t)pkt.size()) {
+      res.sent++;
+    }
+  }
+  rx_thread.join();
+  close(enb_fd);
+
+  res.elapsed_s = std::chrono::duration_cast<std::chrono::duration<double> >(tend - tstart).count();
+  res.syscalls  = setup.nof_syscalls();
+  return SRSRAN_SUCCESS;
+}
+
+int run_ul(const bench_args_t& args, uint32_t nof_workers, uint32_t batch_size, bench_result_t& res)
+{
+  dp_setup setup;
+  TESTASSERT(setup.init(nof_workers, batch_size) == SRSRAN_SUCCESS);
+  int enb_fd = open_udp_socket(enb_addr, 0);
+  TESTASSERT(enb_fd >= 0);
+
+  std::atomic<uint32_t>    received{0};
+  std::vector<std::thread> rx_threads;
+  auto                     tstart = std::chrono::high_resolution_clock::now();
+  std::vector<std::chrono::high_resolution_clock::time_point> tend(nof_workers, tstart);
+  for (uint32_t w = 0; w < nof_workers; ++w) {
+    rx_threads.emplace_back([&, w]() {
+      std::vector<uint8_t> rx_buf(args.pkt_size);
+      while (received < args.nof_pkts) {
+        ssize_t n = recv(setup.sgi_peer[w], rx_buf.data(), rx_buf.size(), 0);
+        if (n <= 0) {
+          break;
+        }
+        if (n == (ssize_t)args.pkt_size) {
+          received++;
+          tend[w] = std::chrono::high_resolution_clock::now();
+        }
+      }
+    });
+  }
+
+  struct sockaddr_in dst = {};
+  dst.sin_family         = AF_INET;
+  dst.sin_port           = htons(srsepc::GTPU_RX_PORT);
+  inet_pton(AF_INET, spgw_addr, &dst.sin_addr);
+
+  srsran::unique_byte_buffer_t pdu = srsran::make_byte_buffer();
+  TESTASSERT(pdu != nullptr);
+  auto& logger = srslog::fetch_basic_logger("GTPU");
+  for (uint32_t i = 0; i < args.nof_pkts; ++i) {
+    pdu->clear();
+    pdu->N_bytes = args.pkt_size;
+    fill_ip_pkt(pdu->msg, args.pkt_size, i % nof_ues, i);
+    srsran::gtpu_header_t header = {};
+    header.flags                 = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
+    header.message_type          = GTPU_MSG_DATA_PDU;
+    header.length                = pdu->N_bytes;
+    header.teid                  = i % nof_ues + 1;
+    TESTASSERT(srsran::gtpu_write_header(&header, pdu.get(), logger));
+    if (sendto(enb_fd, pdu->msg, pdu->N_bytes, 0, (struct sockaddr*)&dst, sizeof(dst)) > 0) {
+      res.sent++;
+    }
+  }
+  for (auto& t : rx_threads) {
+    t.join();
+  }
+  close(enb_fd);
+
+  res.received  = received;
+  res.elapsed_s = std::chrono::duration_cast<std::chrono::duration<double> >(
+                      *std::max_element(tend.begin(), tend.end()) - tstart)
+                      .count();
+  res.syscalls = setup.nof_syscalls();
+  return SRSRAN_SUCCESS;
+}
+
+void print_result(const char* dir, uint32_t nof_workers, uint32_t batch_size, const bench_result_t& r, uint32_t len)
+{
+  double mbps = r.elapsed_s > 0 ? r.received * len * 8 / r.elapsed_s / 1e6 : 0;
+  double kpps = r.elapsed_s > 0 ? r.received / r.elapsed_s / 1e3 : 0;
+  fmt::print("{:>3}{:>9d}{:>8d}{:>10d}{:>10d}{:>10.1f}{:>11.1f}{:>12.2f}\n",
+             dir,
+             nof_workers,
+             batch_size,
+             r.sent,
+             r.received,
+             kpps,
+             mbps,
+             r.received > 0 ? (double)r.syscalls / r.received : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  bench_args_t args;
+  int          opt;
+  while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch (opt) {
+      case 'n':
+        args.nof_pkts = strtoul(optarg, nullptr, 10);
+        break;
+      case 's':
+        args.pkt_size = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        fmt::print("Usage: {} [-n nof_pkts] [-s pkt_size]\n", argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+  TESTASSERT(args.pkt_size >= sizeof(struct iphdr) + sizeof(uint32_t));
+
+  srslog::fetch_basic_logger("GTPU").set_level(srslog::basic_levels::warning);
+  srslog::init();
+
+  fmt::print("{:>3}{:>9}{:>8}{:>10}{:>10}{:>10}{:>11}{:>13}\n",
+             "dir",
+             "workers",
+             "batch",
+             "sent",
+             "rcvd",
+             "kpps",
+             "Mbps",
+             "syscalls/pkt");
+  const uint32_t nof_workers_list[] = {1, 2, 4};
+  const uint32_t batch_size_list[]  = {1, srsepc::GTPU_DP_DEFAULT_BATCH_SIZE};
+  for (uint32_t nof_workers : nof_workers_list) {
+    for (uint32_t batch_size : batch_size_list) {
+      bench_result_t dl;
+      TESTASSERT(run_dl(args, nof_workers, batch_size, dl) == SRSRAN_SUCCESS);
+      print_result("DL", nof_workers, batch_size, dl, args.pkt_size);
+      TESTASSERT(dl.received > 0);
+
+      bench_result_t ul;
+      TESTASSERT(run_ul(args, nof_workers, batch_size, ul) == SRSRAN_SUCCESS);
+      print_result("UL", nof_workers, batch_size, ul, args.pkt_size);
+      TESTASSERT(ul.received > 0);
+    }
+  }
+
+  srslog::flush();
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Microbenchmark of the SP-GW tunnel lookups. Compares the flat DL/UL tunnel tables against the previous layout of
+ * two ordered maps keyed by UE IP (user-plane F-TEID and control TEID).
+ */
+
+#include "srsepc/hdr/spgw/gtpu.h"
+#include "srsran/common/test_common.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <getopt.h>
+#include <map>
+#include <random>
+
+namespace {
+
+using tp_t = std::chrono::high_resolution_clock::time_point;
+
+double elapsed_ns(tp_t start, uint32_t nof_ops)
+{
+  auto dur = std::chrono::high_resolution_clock::now() - start;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count() / (double)nof_ops;
+}
+
+struct legacy_tables {
+  std::map<in_addr_t, srsran::gtp_fteid_t> ip_to_usr_teid;
+  std::map<in_addr_t, uint32_t>            ip_to_ctr_teid;
+};
+
+struct flat_tables {
+  srsepc::spgw_dl_tunnel_map_t dl;
+  srsepc::spgw_ul_tunnel_map_t ul;
+};
+
+int run_benchmark(uint32_t nof_tunnels, uint32_t nof_lookups)
+{
+  std::mt19937 rng(0);
+
+  // UE IPs from 172.16.0.0/12 and TEIDs allocated sequentially, as done by the SP-GW
+  std::vector<in_addr_t> ue_ips(nof_tunnels);
+  for (uint32_t i = 0; i < nof_tunnels; ++i) {
+    ue_ips[i] = htonl(0xac100000 + i + 1);
+  }
+  std::vector<uint32_t> lookup_idx(nof_lookups);
+  std::uniform_int_distribution<uint32_t> dist(0, nof_tunnels - 1);
+  for (uint32_t& idx : lookup_idx) {
+    idx = dist(rng);
+  }
+
+  legacy_tables legacy;
+  flat_tables   flat;
+  uint64_t      checksum_legacy = 0, checksum_flat = 0;
+
+  // Insertion
+  tp_t t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_tunnels; ++i) {
+    srsran::gtp_fteid_t fteid        = {};
+    fteid.teid                       = i + 1;
+    legacy.ip_to_usr_teid[ue_ips[i]] = fteid;
+    legacy.ip_to_ctr_teid[ue_ips[i]] = i + 1;
+  }
+  double legacy_insert = elapsed_ns(t0, nof_tunnels);
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_tunnels; ++i) {
+    srsepc::spgw_dl_tunnel_t& dl = flat.dl[ue_ips[i]];
+    dl.enb_fteid.teid            = i + 1;
+    dl.spgw_ctr_teid             = i + 1;
+    dl.spgw_usr_teid             = i + 1;
+    dl.usr_active                = true;
+    dl.ctr_active                = true;
+    srsepc::spgw_ul_tunnel_t& ul = flat.ul[i + 1];
+    ul.ue_ipv4                   = ue_ips[i];
+    ul.spgw_ctr_teid             = i + 1;
+  }
+  double flat_insert = elapsed_ns(t0, nof_tunnels);
+
+  // Downlink lookups (hit)
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t idx : lookup_idx) {
+    auto usr_it = legacy.ip_to_usr_teid.find(ue_ips[idx]);
+    auto ctr_it = legacy.ip_to_ctr_teid.find(ue_ips[idx]);
+    if (usr_it != legacy.ip_to_usr_teid.end() and ctr_it != legacy.ip_to_ctr_teid.end()) {
+      checksum_legacy += usr_it->second.teid;
+    }
+  }
+  double legacy_dl = elapsed_ns(t0, nof_lookups);
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t idx : lookup_idx) {
+    const srsepc::spgw_dl_tunnel_t* dl = flat.dl.find_value(ue_ips[idx]);
+    if (dl != nullptr and dl->usr_active and dl->ctr_active) {
+      checksum_flat += dl->enb_fteid.teid;
+    }
+  }
+  double flat_dl = elapsed_ns(t0, nof_lookups);
+  TESTASSERT(checksum_legacy == checksum_flat);
+
+  // Downlink lookups (miss)
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t idx : lookup_idx) {
+    checksum_legacy += legacy.ip_to_usr_teid.count(htonl(0x0a000000 + idx));
+  }
+  double legacy_miss = elapsed_ns(t0, nof_lookups);
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t idx : lookup_idx) {
+    checksum_flat += flat.dl.count(htonl(0x0a000000 + idx));
+  }
+  double flat_miss = elapsed_ns(t0, nof_lookups);
+  TESTASSERT(checksum_legacy == checksum_flat);
+
+  // Uplink lookups by TEID. The previous layout had no uplink table
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t idx : lookup_idx) {
+    const srsepc::spgw_ul_tunnel_t* ul = flat.ul.find_value(idx + 1);
+    TESTASSERT(ul != nullptr);
+    checksum_flat += ul->ue_ipv4;
+  }
+  double flat_ul = elapsed_ns(t0, nof_lookups);
+
+  // Erasure
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_tunnels; ++i) {
+    legacy.ip_to_usr_teid.erase(ue_ips[i]);
+    legacy.ip_to_ctr_teid.erase(ue_ips[i]);
+  }
+  double legacy_erase = elapsed_ns(t0, nof_tunnels);
+
+  t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_tunnels; ++i) {
+    flat.dl.erase(ue_ips[i]);
+    flat.ul.erase(i + 1);
+  }
+  double flat_erase = elapsed_ns(t0, nof_tunnels);
+  TESTASSERT(flat.dl.empty() and flat.ul.empty());
+
+  fmt::print("Tunnels: {}, lookups: {}\n", nof_tunnels, nof_lookups);
+  fmt::print("{:>14}{:>12}{:>12}{:>12}{:>12}{:>12}\n", "[ns/op]", "insert", "DL hit", "DL miss", "UL hit", "erase");
+  fmt::print("{:>14}{:>12.1f}{:>12.1f}{:>12.1f}{:>12}{:>12.1f}\n",
+             "std::map",
+             legacy_insert,
+             legacy_dl,
+             legacy_miss,
+             "-",
+             legacy_erase);
+  fmt::print("{:>14}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}\n",
+             "flat_hash_map",
+             flat_insert,
+             flat_dl,
+             flat_miss,
+             flat_ul,
+             flat_erase);
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t nof_tunnels = 100000;
+  uint32_t nof_lookups = 1000000;
+  int      opt;
+  while ((opt = getopt(argc, argv, "t:l:")) != -1) {
+    switch (opt) {
+      case 't':
+        nof_tunnels = strtoul(optarg, nullptr, 10);
+        break;
+      case 'l':
+        nof_lookups = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        fmt::print("Usage: {} [-t nof_tunnels] [-l nof_lookups]\n", argv[0]);
+        return SRSRAN_ERROR;
+    }
+  }
+  TESTASSERT(nof_tunnels > 0);
+
+  TESTASSERT(run_benchmark(nof_tunnels, nof_lookups) == SRSRAN_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
@@ -28,6 +28,7 @@
 #include <unistd.h>
 
 #include "srsran/asn1/liblte_mme.h"
+#include "srsran/asn1/liblte_utils.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/interfaces/ue_gw_interfaces.h"
 #include "srsran/interfaces/ue_rrc_interfaces.h"
@@ -474,7 +475,7 @@ void nas::write_pdu(uint32_t lcid, unique_byte_buffer_t pdu)
   logger.info(pdu->msg, pdu->N_bytes, "DL %s PDU", rrc->get_rb_name(lcid));
 
   // Parse the message security header
-  liblte_mme_parse_msg_sec_header((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &pd, &sec_hdr_type);
+  liblte_mme_parse_msg_sec_header(liblte_unpack_msg(pdu.get()).get(), &pd, &sec_hdr_type);
   switch (sec_hdr_type) {
     case LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS:
     case LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY_WITH_NEW_EPS_SECURITY_CONTEXT:
@@ -504,7 +505,7 @@ void nas::write_pdu(uint32_t lcid, unique_byte_buffer_t pdu)
   }
 
   // Parse the message header
-  liblte_mme_parse_msg_header((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &pd, &msg_type);
+  liblte_mme_parse_msg_header(liblte_unpack_msg(pdu.get()).get(), &pd, &msg_type);
   logger.info(pdu->msg, pdu->N_bytes, "DL %s Decrypted PDU", rrc->get_rb_name(lcid));
 
   // drop messages if integrity protection isn't applied (see TS 24.301 Sec. 4.4.4.2)
@@ -779,7 +780,7 @@ void nas::parse_attach_accept(uint32_t lcid, unique_byte_buffer_t pdu)
   }
 
   LIBLTE_MME_ATTACH_ACCEPT_MSG_STRUCT attach_accept = {};
-  liblte_mme_unpack_attach_accept_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &attach_accept);
+  liblte_mme_unpack_attach_accept_msg(liblte_unpack_msg(pdu.get()).get(), &attach_accept);
 
   if (attach_accept.eps_attach_result == LIBLTE_MME_EPS_ATTACH_RESULT_EPS_ONLY) {
     // TODO: Handle t3412.unit
@@ -1032,7 +1033,7 @@ void nas::parse_attach_reject(uint32_t lcid, unique_byte_buffer_t pdu)
   LIBLTE_MME_ATTACH_REJECT_MSG_STRUCT attach_rej;
   ZERO_OBJECT(attach_rej);
 
-  liblte_mme_unpack_attach_reject_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &attach_rej);
+  liblte_mme_unpack_attach_reject_msg(liblte_unpack_msg(pdu.get()).get(), &attach_rej);
   logger.warning("Received Attach Reject. Cause= %02X", attach_rej.emm_cause);
   srsran::console("Received Attach Reject. Cause= %02X\n", attach_rej.emm_cause);
 
@@ -1077,7 +1078,7 @@ void nas::parse_authentication_request(uint32_t lcid, unique_byte_buffer_t pdu,
   LIBLTE_MME_AUTHENTICATION_REQUEST_MSG_STRUCT auth_req = {};
 
   logger.info("Received Authentication Request");
-  liblte_mme_unpack_authentication_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &auth_req);
+  liblte_mme_unpack_authentication_request_msg(liblte_unpack_msg(pdu.get()).get(), &auth_req);
 
   ctxt_base.rx_count++;
 
@@ -1132,7 +1133,7 @@ void nas::parse_authentication_reject(uint32_t lcid, unique_byte_buffer_t pdu)
 void nas::parse_identity_request(unique_byte_buffer_t pdu, const uint8_t sec_hdr_type)
 {
   LIBLTE_MME_ID_REQUEST_MSG_STRUCT id_req = {};
-  liblte_mme_unpack_identity_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &id_req);
+  liblte_mme_unpack_identity_request_msg(liblte_unpack_msg(pdu.get()).get(), &id_req);
 
   logger.info("Received Identity Request. ID type: %d", id_req.id_type);
   ctxt_base.rx_count++;
@@ -1160,7 +1161,7 @@ void nas::parse_security_mode_command(uint32_t lcid, unique_byte_buffer_t pdu)
   }
 
   LIBLTE_MME_SECURITY_MODE_COMMAND_MSG_STRUCT sec_mode_cmd = {};
-  liblte_mme_unpack_security_mode_command_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &sec_mode_cmd);
+  liblte_mme_unpack_security_mode_command_msg(liblte_unpack_msg(pdu.get()).get(), &sec_mode_cmd);
   logger.info("Received Security Mode Command ksi: %d, eea: %s, eia: %s",
               sec_mode_cmd.nas_ksi.nas_ksi,
               ciphering_algorithm_id_text[sec_mode_cmd.selected_nas_sec_algs.type_of_eea],
@@ -1244,7 +1245,7 @@ void nas::parse_security_mode_command(uint32_t lcid, unique_byte_buffer_t pdu)
   // Pack and send response
   pdu->clear();
   liblte_mme_pack_security_mode_complete_msg(
-      &sec_mode_comp, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get());
+      &sec_mode_comp, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get());
   if (pcap != nullptr) {
     pcap->write_nas(pdu->msg, pdu->N_bytes);
   }
@@ -1266,7 +1267,7 @@ void nas::parse_security_mode_command(uint32_t lcid, unique_byte_buffer_t pdu)
 void nas::parse_service_reject(uint32_t lcid, unique_byte_buffer_t pdu)
 {
   LIBLTE_MME_SERVICE_REJECT_MSG_STRUCT service_reject;
-  if (liblte_mme_unpack_service_reject_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &service_reject)) {
+  if (liblte_mme_unpack_service_reject_msg(liblte_unpack_msg(pdu.get()).get(), &service_reject)) {
     logger.error("Error unpacking service reject.");
     return;
   }
@@ -1291,7 +1292,7 @@ void nas::parse_service_reject(uint32_t lcid, unique_byte_buffer_t pdu)
 void nas::parse_esm_information_request(uint32_t lcid, unique_byte_buffer_t pdu)
 {
   LIBLTE_MME_ESM_INFORMATION_REQUEST_MSG_STRUCT esm_info_req;
-  liblte_mme_unpack_esm_information_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &esm_info_req);
+  liblte_mme_unpack_esm_information_request_msg(liblte_unpack_msg(pdu.get()).get(), &esm_info_req);
 
   logger.info("ESM information request received for beaser=%d, transaction_id=%d",
               esm_info_req.eps_bearer_id,
@@ -1305,7 +1306,7 @@ void nas::parse_esm_information_request(uint32_t lcid, unique_byte_buffer_t pdu)
 void nas::parse_emm_information(uint32_t lcid, unique_byte_buffer_t pdu)
 {
   LIBLTE_MME_EMM_INFORMATION_MSG_STRUCT emm_info = {};
-  liblte_mme_unpack_emm_information_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &emm_info);
+  liblte_mme_unpack_emm_information_msg(liblte_unpack_msg(pdu.get()).get(), &emm_info);
   std::string str = emm_info_str(&emm_info);
   logger.info("Received EMM Information: %s", str.c_str());
   srsran::console("%s\n", str.c_str());
@@ -1315,7 +1316,7 @@ void nas::parse_emm_information(uint32_t lcid, unique_byte_buffer_t pdu)
 void nas::parse_detach_request(uint32_t lcid, unique_byte_buffer_t pdu)
 {
   LIBLTE_MME_DETACH_REQUEST_MSG_STRUCT detach_request;
-  liblte_mme_unpack_detach_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &detach_request);
+  liblte_mme_unpack_detach_request_msg(liblte_unpack_msg(pdu.get()).get(), &detach_request);
   ctxt_base.rx_count++;
 
   logger.info("Received detach request (type=%d). NAS State: %s",
@@ -1349,7 +1350,7 @@ void nas::parse_detach_request(uint32_t lcid, unique_byte_buffer_t pdu)
 void nas::parse_activate_dedicated_eps_bearer_context_request(uint32_t lcid, unique_byte_buffer_t pdu)
 {
   LIBLTE_MME_ACTIVATE_DEDICATED_EPS_BEARER_CONTEXT_REQUEST_MSG_STRUCT request;
-  liblte_mme_unpack_activate_dedicated_eps_bearer_context_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &request);
+  liblte_mme_unpack_activate_dedicated_eps_bearer_context_request_msg(liblte_unpack_msg(pdu.get()).get(), &request);
 
   logger.info(
       "Received Activate Dedicated EPS bearer context request (eps_bearer_id=%d, linked_bearer_id=%d, proc_id=%d)",
@@ -1401,7 +1402,7 @@ void nas::parse_deactivate_eps_bearer_context_request(unique_byte_buffer_t pdu)
 {
   LIBLTE_MME_DEACTIVATE_EPS_BEARER_CONTEXT_REQUEST_MSG_STRUCT request;
 
-  liblte_mme_unpack_deactivate_eps_bearer_context_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &request);
+  liblte_mme_unpack_deactivate_eps_bearer_context_request_msg(liblte_unpack_msg(pdu.get()).get(), &request);
 
   logger.info("Received Deactivate EPS bearer context request (eps_bearer_id=%d, proc_id=%d, cause=0x%X)",
               request.eps_bearer_id,
@@ -1433,7 +1434,7 @@ void nas::parse_modify_eps_bearer_context_request(srsran::unique_byte_buffer_t p
 {
   LIBLTE_MME_MODIFY_EPS_BEARER_CONTEXT_REQUEST_MSG_STRUCT request;
 
-  liblte_mme_unpack_modify_eps_bearer_context_request_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &request);
+  liblte_mme_unpack_modify_eps_bearer_context_request_msg(liblte_unpack_msg(pdu.get()).get(), &request);
 
   logger.info("Received Modify EPS bearer context request (eps_bearer_id=%d, proc_id=%d)",
               request.eps_bearer_id,
@@ -1501,7 +1502,7 @@ void nas::parse_close_ue_test_loop(uint32_t lcid, unique_byte_buffer_t pdu)
 void nas::parse_emm_status(uint32_t lcid, unique_byte_buffer_t pdu)
 {
   LIBLTE_MME_EMM_STATUS_MSG_STRUCT emm_status;
-  liblte_mme_unpack_emm_status_msg((LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), &emm_status);
+  liblte_mme_unpack_emm_status_msg(liblte_unpack_msg(pdu.get()).get(), &emm_status);
   ctxt_base.rx_count++;
 
   switch (emm_status.emm_cause) {
@@ -1596,7 +1597,7 @@ void nas::gen_attach_request(srsran::unique_byte_buffer_t& msg)
 
     // According to Sec 4.4.5, the attach request is always unciphered, even if a context exists
     liblte_mme_pack_attach_request_msg(
-        &attach_req, LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)msg.get());
+        &attach_req, LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY, ctxt_base.tx_count, liblte_pack_msg(msg.get()).get());
 
     if (apply_security_config(msg, LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY)) {
       logger.error("Error applying NAS security.");
@@ -1608,7 +1609,7 @@ void nas::gen_attach_request(srsran::unique_byte_buffer_t& msg)
     attach_req.nas_ksi.nas_ksi          = LIBLTE_MME_NAS_KEY_SET_IDENTIFIER_NO_KEY_AVAILABLE;
     usim->get_imsi_vec(attach_req.eps_mobile_id.imsi, 15);
     logger.info("Requesting IMSI attach (IMSI=%s)", usim->get_imsi_str().c_str());
-    liblte_mme_pack_attach_request_msg(&attach_req, (LIBLTE_BYTE_MSG_STRUCT*)msg.get());
+    liblte_mme_pack_attach_request_msg(&attach_req, liblte_pack_msg(msg.get()).get());
   }
 
   if (pcap != nullptr) {
@@ -1721,7 +1722,7 @@ void nas::send_security_mode_reject(uint8_t cause)
 
   LIBLTE_MME_SECURITY_MODE_REJECT_MSG_STRUCT sec_mode_rej = {0};
   sec_mode_rej.emm_cause                                  = cause;
-  liblte_mme_pack_security_mode_reject_msg(&sec_mode_rej, (LIBLTE_BYTE_MSG_STRUCT*)msg.get());
+  liblte_mme_pack_security_mode_reject_msg(&sec_mode_rej, liblte_pack_msg(msg.get()).get());
   if (pcap != nullptr) {
     pcap->write_nas(msg->msg, msg->N_bytes);
   }
@@ -1771,7 +1772,7 @@ void nas::send_detach_request(bool switch_off)
     liblte_mme_pack_detach_request_msg(&detach_request,
                                        LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY,
                                        ctxt_base.tx_count,
-                                       (LIBLTE_BYTE_MSG_STRUCT*)pdu.get());
+                                       liblte_pack_msg(pdu.get()).get());
 
     if (pcap != nullptr) {
       pcap->write_nas(pdu->msg, pdu->N_bytes);
@@ -1788,7 +1789,7 @@ void nas::send_detach_request(bool switch_off)
     usim->get_imsi_vec(detach_request.eps_mobile_id.imsi, 15);
     logger.info("Sending detach request with IMSI");
     liblte_mme_pack_detach_request_msg(
-        &detach_request, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get());
+        &detach_request, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get());
 
     if (pcap != nullptr) {
       pcap->write_nas(pdu->msg, pdu->N_bytes);
@@ -1835,7 +1836,7 @@ void nas::send_attach_complete(const uint8_t& transaction_id_, const uint8_t& ep
     return;
   }
   liblte_mme_pack_attach_complete_msg(
-      &attach_complete, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get());
+      &attach_complete, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get());
   // Write NAS pcap
   if (pcap != nullptr) {
     pcap->write_nas(pdu->msg, pdu->N_bytes);
@@ -1865,7 +1866,7 @@ void nas::send_detach_accept()
   LIBLTE_MME_DETACH_ACCEPT_MSG_STRUCT detach_accept;
   bzero(&detach_accept, sizeof(detach_accept));
   liblte_mme_pack_detach_accept_msg(
-      &detach_accept, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get());
+      &detach_accept, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get());
 
   if (pcap != nullptr) {
     pcap->write_nas(pdu->msg, pdu->N_bytes);
@@ -1895,7 +1896,7 @@ void nas::send_authentication_response(const uint8_t* res, const size_t res_len)
   }
   auth_res.res_len = res_len;
   liblte_mme_pack_authentication_response_msg(
-      &auth_res, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get());
+      &auth_res, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get());
 
   if (pcap != nullptr) {
     pcap->write_nas(pdu->msg, pdu->N_bytes);
@@ -1929,7 +1930,7 @@ void nas::send_authentication_failure(const uint8_t cause, const uint8_t* auth_f
     auth_failure.auth_fail_param_present = false;
   }
 
-  liblte_mme_pack_authentication_failure_msg(&auth_failure, (LIBLTE_BYTE_MSG_STRUCT*)msg.get());
+  liblte_mme_pack_authentication_failure_msg(&auth_failure, liblte_pack_msg(msg.get()).get());
   if (pcap != nullptr) {
     pcap->write_nas(msg->msg, msg->N_bytes);
   }
@@ -1968,7 +1969,7 @@ void nas::send_identity_response(const uint8 id_type)
   }
 
   liblte_mme_pack_identity_response_msg(
-      &id_resp, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get());
+      &id_resp, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get());
 
   // add security if needed
   if (apply_security_config(pdu, current_sec_hdr)) {
@@ -2113,7 +2114,7 @@ void nas::send_esm_information_response(const uint8 proc_transaction_id)
   }
 
   if (liblte_mme_pack_esm_information_response_msg(
-          &esm_info_resp, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get()) != LIBLTE_SUCCESS) {
+          &esm_info_resp, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get()) != LIBLTE_SUCCESS) {
     logger.error("Error packing ESM information response.");
     return;
   }
@@ -2149,7 +2150,7 @@ void nas::send_activate_dedicated_eps_bearer_context_accept(const uint8_t& proc_
   accept.proc_transaction_id = proc_transaction_id;
 
   if (liblte_mme_pack_activate_dedicated_eps_bearer_context_accept_msg(
-          &accept, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get()) != LIBLTE_SUCCESS) {
+          &accept, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get()) != LIBLTE_SUCCESS) {
     logger.error("Error packing Activate Dedicated EPS Bearer context accept.");
     return;
   }
@@ -2187,7 +2188,7 @@ void nas::send_deactivate_eps_bearer_context_accept(const uint8_t& proc_transact
   accept.proc_transaction_id = proc_transaction_id;
 
   if (liblte_mme_pack_deactivate_eps_bearer_context_accept_msg(
-          &accept, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get()) != LIBLTE_SUCCESS) {
+          &accept, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get()) != LIBLTE_SUCCESS) {
     logger.error("Error packing Activate EPS Bearer context accept.");
     return;
   }
@@ -2225,7 +2226,7 @@ void nas::send_modify_eps_bearer_context_accept(const uint8_t& proc_transaction_
   accept.proc_transaction_id = proc_transaction_id;
 
   if (liblte_mme_pack_modify_eps_bearer_context_accept_msg(
-          &accept, current_sec_hdr, ctxt_base.tx_count, (LIBLTE_BYTE_MSG_STRUCT*)pdu.get()) != LIBLTE_SUCCESS) {
+          &accept, current_sec_hdr, ctxt_base.tx_count, liblte_pack_msg(pdu.get()).get()) != LIBLTE_SUCCESS) {
     logger.error("Error packing Modify EPS Bearer context accept.");
     return;
   }
@@ -2258,7 +2259,7 @@ void nas::send_activate_test_mode_complete()
   }
 
   if (liblte_mme_pack_activate_test_mode_complete_msg(
-          (LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), current_sec_hdr, ctxt_base.tx_count)) {
+          liblte_pack_msg(pdu.get()).get(), current_sec_hdr, ctxt_base.tx_count)) {
     logger.error("Error packing activate test mode complete.");
     return;
   }
@@ -2287,7 +2288,7 @@ void nas::send_close_ue_test_loop_complete()
   }
 
   if (liblte_mme_pack_close_ue_test_loop_complete_msg(
-          (LIBLTE_BYTE_MSG_STRUCT*)pdu.get(), current_sec_hdr, ctxt_base.tx_count)) {
+          liblte_pack_msg(pdu.get()).get(), current_sec_hdr, ctxt_base.tx_count)) {
     logger.error("Error packing close UE test loop complete.");
     return;
   }
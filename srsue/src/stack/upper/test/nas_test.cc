@@ -34,14 +34,8 @@
 using namespace srsue;
 using namespace srsran;
 
-static_assert(alignof(LIBLTE_BYTE_MSG_STRUCT) == alignof(byte_buffer_t),
-              "liblte buffer and byte buffer members misaligned");
-static_assert(offsetof(LIBLTE_BYTE_MSG_STRUCT, N_bytes) == offsetof(byte_buffer_t, N_bytes),
-              "liblte buffer and byte buffer members misaligned");
-static_assert(offsetof(LIBLTE_BYTE_MSG_STRUCT, header) == offsetof(byte_buffer_t, buffer),
-              "liblte buffer and byte buffer members misaligned");
-static_assert(sizeof(LIBLTE_BYTE_MSG_STRUCT) <= offsetof(byte_buffer_t, msg),
-              "liblte buffer and byte buffer members misaligned");
+static_assert(byte_buffer_class_payload(byte_buffer_class_t::large) >= LIBLTE_MAX_MSG_SIZE_BYTES,
+              "byte buffer too small for a liblte message");
 
 int mme_attach_request_test()
 {